@@ -800,6 +800,30 @@ enum aome_enc_control_id {
   /*!\brief Codec control function to set the path to the film grain parameters
    */
   AV1E_SET_FILM_GRAIN_TABLE,
+
+  /*!\brief Codec control function to enable row based multi-threading.
+   *
+   * The superblock rows of each tile are encoded in parallel, each row
+   * starting once the row above it is two superblocks ahead. The output does
+   * not depend on the number of threads, but differs from the output with
+   * this control off.
+   *
+   *            0 = off
+   *            1 = on
+   *
+   * By default, the value is 0, i.e. row based multi-threading is off.
+   */
+  AV1E_SET_ROW_MT,
+
+  /*!\brief Codec control function to set the number of threads used by the
+   * loop restoration filter.
+   *
+   * The value is capped by the number of threads set with g_threads. The
+   * output does not depend on it.
+   *
+   * By default, the value is 0, i.e. loop restoration uses g_threads.
+   */
+  AV1E_SET_LR_THREADS,
 };
 
 /*!\brief aom 1-D scaling mode
@@ -1095,6 +1119,12 @@ AOM_CTRL_USE_TYPE(AV1E_SET_FILM_GRAIN_TABLE, const char *)
 AOM_CTRL_USE_TYPE(AV1E_SET_CDF_UPDATE_MODE, int)
 #define AOM_CTRL_AV1E_SET_CDF_UPDATE_MODE
 
+AOM_CTRL_USE_TYPE(AV1E_SET_ROW_MT, unsigned int)
+#define AOM_CTRL_AV1E_SET_ROW_MT
+
+AOM_CTRL_USE_TYPE(AV1E_SET_LR_THREADS, unsigned int)
+#define AOM_CTRL_AV1E_SET_LR_THREADS
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
@@ -152,6 +152,24 @@ enum aom_dec_control_id {
    */
   AV1_SET_INSPECTION_CALLBACK,
 
+  /** control function to add the film grain into frame buffers obtained
+   * from the external frame buffer functions set with
+   * aom_codec_set_frame_buffer_functions(). When the value is nonzero, every
+   * output frame with grain holds one more frame buffer, which is released
+   * when the next frame is output. Otherwise the grain is added into an image
+   * the decoder reuses from frame to frame. The value is ignored when no
+   * external frame buffer functions are set. When compiled without
+   * --enable-film-grain, this returns AOM_CODEC_INCAPABLE. The default value
+   * is 0.
+   */
+  AV1_SET_FILM_GRAIN_EXT_FB,
+
+  /** control function to set the number of threads used by the loop
+   * restoration filter. The value is capped by the number of threads set in
+   * aom_codec_dec_cfg_t. The default value is 0, which uses that number.
+   */
+  AV1_SET_LR_THREADS,
+
   AOM_DECODER_CTRL_ID_MAX,
 };
 
@@ -189,6 +207,10 @@ AOM_CTRL_USE_TYPE(AV1_SET_TILE_MODE, unsigned int)
 #define AOM_CTRL_AV1_SET_TILE_MODE
 AOM_CTRL_USE_TYPE(AV1_SET_INSPECTION_CALLBACK, aom_inspect_init *)
 #define AOM_CTRL_AV1_SET_INSPECTION_CALLBACK
+AOM_CTRL_USE_TYPE(AV1_SET_FILM_GRAIN_EXT_FB, int)
+#define AOM_CTRL_AV1_SET_FILM_GRAIN_EXT_FB
+AOM_CTRL_USE_TYPE(AV1_SET_LR_THREADS, unsigned int)
+#define AOM_CTRL_AV1_SET_LR_THREADS
 /*!\endcond */
 /*! @} - end defgroup aom_decoder */
 
@@ -40,6 +40,9 @@ aom_codec_err_t aom_codec_dec_init_ver(aom_codec_ctx_t *ctx,
   else if ((flags & AOM_CODEC_USE_INPUT_FRAGMENTS) &&
            !(iface->caps & AOM_CODEC_CAP_INPUT_FRAGMENTS))
     res = AOM_CODEC_INCAPABLE;
+  else if ((flags & AOM_CODEC_USE_FRAME_THREADING) &&
+           !(iface->caps & AOM_CODEC_CAP_FRAME_THREADING))
+    res = AOM_CODEC_INCAPABLE;
   else if (!(iface->caps & AOM_CODEC_CAP_DECODER))
     res = AOM_CODEC_INCAPABLE;
   else {
@@ -72,6 +72,7 @@ set(AOM_DSP_COMMON_INTRIN_AVX2
     "${AOM_ROOT}/aom_dsp/x86/aom_subpixel_8t_intrin_avx2.c"
     "${AOM_ROOT}/aom_dsp/x86/intrapred_avx2.c"
     "${AOM_ROOT}/aom_dsp/x86/inv_txfm_avx2.c"
+    "${AOM_ROOT}/aom_dsp/x86/loopfilter_avx2.c"
     "${AOM_ROOT}/aom_dsp/x86/common_avx2.h"
     "${AOM_ROOT}/aom_dsp/x86/convolve_avx2.h"
     "${AOM_ROOT}/aom_dsp/x86/inv_txfm_common_avx2.h"
@@ -163,9 +164,14 @@ set(AOM_DSP_COMMON_INTRIN_MSA
       ${AOM_DSP_COMMON_INTRIN_SSSE3}
       "${AOM_ROOT}/aom_dsp/x86/highbd_convolve_ssse3.c")
 
+  set(AOM_DSP_COMMON_INTRIN_SSE4_1
+      ${AOM_DSP_COMMON_INTRIN_SSE4_1}
+      "${AOM_ROOT}/aom_dsp/x86/highbd_intrapred_sse4.c")
+
   set(AOM_DSP_COMMON_INTRIN_AVX2
       ${AOM_DSP_COMMON_INTRIN_AVX2}
       "${AOM_ROOT}/aom_dsp/x86/highbd_convolve_avx2.c"
+      "${AOM_ROOT}/aom_dsp/x86/highbd_intrapred_avx2.c"
       "${AOM_ROOT}/aom_dsp/x86/highbd_loopfilter_avx2.c")
 
 set(AOM_DSP_COMMON_SOURCES
@@ -209,6 +215,11 @@ if (CONFIG_AV1_DECODER)
       "${AOM_ROOT}/aom_dsp/grain_synthesis.c"
       "${AOM_ROOT}/aom_dsp/grain_synthesis.h")
 
+  set(AOM_DSP_DECODER_INTRIN_SSE4_1
+      "${AOM_ROOT}/aom_dsp/x86/grain_synthesis_sse4.c")
+
+  set(AOM_DSP_DECODER_INTRIN_AVX2
+      "${AOM_ROOT}/aom_dsp/x86/grain_synthesis_avx2.c")
 endif ()
 
 if (CONFIG_AV1_ENCODER)
@@ -422,6 +433,10 @@ function (setup_aom_dsp_targets)
   if (HAVE_SSE4_1)
     add_intrinsics_object_library("-msse4.1" "sse4_1" "aom_dsp_common"
                                   "AOM_DSP_COMMON_INTRIN_SSE4_1" "aom")
+    if (CONFIG_AV1_DECODER)
+      add_intrinsics_object_library("-msse4.1" "sse4_1" "aom_dsp_decoder"
+                                    "AOM_DSP_DECODER_INTRIN_SSE4_1" "aom")
+    endif ()
     if (CONFIG_AV1_ENCODER)
       if (AOM_DSP_ENCODER_INTRIN_SSE4_1)
         add_intrinsics_object_library("-msse4.1" "sse4_1" "aom_dsp_encoder"
@@ -442,6 +457,10 @@ function (setup_aom_dsp_targets)
   if (HAVE_AVX2)
     add_intrinsics_object_library("-mavx2" "avx2" "aom_dsp_common"
                                   "AOM_DSP_COMMON_INTRIN_AVX2" "aom")
+    if (CONFIG_AV1_DECODER)
+      add_intrinsics_object_library("-mavx2" "avx2" "aom_dsp_decoder"
+                                    "AOM_DSP_DECODER_INTRIN_AVX2" "aom")
+    endif ()
     if (CONFIG_AV1_ENCODER)
       add_intrinsics_object_library("-mavx2" "avx2" "aom_dsp_encoder"
                                     "AOM_DSP_ENCODER_INTRIN_AVX2" "aom")
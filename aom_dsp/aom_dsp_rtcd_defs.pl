@@ -19,6 +19,8 @@ print <<EOF
 #include "av1/common/enums.h"
 #include "av1/common/blockd.h"
 
+struct aom_grain_noise_params;
+
 EOF
 }
 forward_decls qw/aom_dsp_forward_decls/;
@@ -224,9 +226,11 @@ specialize qw/aom_dc_predictor_64x16 sse2 avx2/;
 
   specialize qw/aom_highbd_v_predictor_4x4 sse2/;
   specialize qw/aom_highbd_v_predictor_4x8 sse2/;
+  specialize qw/aom_highbd_v_predictor_4x16 sse2/;
   specialize qw/aom_highbd_v_predictor_8x4 sse2/;
   specialize qw/aom_highbd_v_predictor_8x8 sse2/;
   specialize qw/aom_highbd_v_predictor_8x16 sse2/;
+  specialize qw/aom_highbd_v_predictor_8x32 sse2/;
   specialize qw/aom_highbd_v_predictor_16x8 sse2/;
   specialize qw/aom_highbd_v_predictor_16x16 sse2/;
   specialize qw/aom_highbd_v_predictor_16x32 sse2/;
@@ -237,9 +241,11 @@ specialize qw/aom_dc_predictor_64x16 sse2 avx2/;
   # by multiply and shift.
   specialize qw/aom_highbd_dc_predictor_4x4 sse2/;
   specialize qw/aom_highbd_dc_predictor_4x8 sse2/;
+  specialize qw/aom_highbd_dc_predictor_4x16 sse2/;
   specialize qw/aom_highbd_dc_predictor_8x4 sse2/;;
   specialize qw/aom_highbd_dc_predictor_8x8 sse2/;;
   specialize qw/aom_highbd_dc_predictor_8x16 sse2/;;
+  specialize qw/aom_highbd_dc_predictor_8x32 sse2/;
   specialize qw/aom_highbd_dc_predictor_16x8 sse2/;
   specialize qw/aom_highbd_dc_predictor_16x16 sse2/;
   specialize qw/aom_highbd_dc_predictor_16x32 sse2/;
@@ -262,6 +268,9 @@ specialize qw/aom_dc_predictor_64x16 sse2 avx2/;
   specialize qw/aom_highbd_dc_left_predictor_4x8 sse2/;
   specialize qw/aom_highbd_dc_top_predictor_4x8 sse2/;
   specialize qw/aom_highbd_dc_128_predictor_4x8 sse2/;
+  specialize qw/aom_highbd_dc_left_predictor_4x16 sse2/;
+  specialize qw/aom_highbd_dc_top_predictor_4x16 sse2/;
+  specialize qw/aom_highbd_dc_128_predictor_4x16 sse2/;
   specialize qw/aom_highbd_dc_left_predictor_8x4 sse2/;
   specialize qw/aom_highbd_dc_top_predictor_8x4 sse2/;
   specialize qw/aom_highbd_dc_128_predictor_8x4 sse2/;
@@ -271,6 +280,9 @@ specialize qw/aom_dc_predictor_64x16 sse2 avx2/;
   specialize qw/aom_highbd_dc_left_predictor_8x16 sse2/;
   specialize qw/aom_highbd_dc_top_predictor_8x16 sse2/;
   specialize qw/aom_highbd_dc_128_predictor_8x16 sse2/;
+  specialize qw/aom_highbd_dc_left_predictor_8x32 sse2/;
+  specialize qw/aom_highbd_dc_top_predictor_8x32 sse2/;
+  specialize qw/aom_highbd_dc_128_predictor_8x32 sse2/;
   specialize qw/aom_highbd_dc_left_predictor_16x8 sse2/;
   specialize qw/aom_highbd_dc_top_predictor_16x8 sse2/;
   specialize qw/aom_highbd_dc_128_predictor_16x8 sse2/;
@@ -287,6 +299,18 @@ specialize qw/aom_dc_predictor_64x16 sse2 avx2/;
   specialize qw/aom_highbd_dc_top_predictor_32x32 sse2/;
   specialize qw/aom_highbd_dc_128_predictor_32x32 sse2/;
 
+  foreach (@tx_sizes) {
+    ($w, $h) = @$_;
+    foreach $pred_name (qw/paeth smooth smooth_v smooth_h/) {
+      specialize "aom_highbd_${pred_name}_predictor_${w}x${h}", qw/sse4_1/;
+    }
+    if ($w >= 16) {
+      foreach $pred_name (qw/dc dc_top dc_left dc_128 v paeth smooth smooth_v smooth_h/) {
+        specialize "aom_highbd_${pred_name}_predictor_${w}x${h}", qw/avx2/;
+      }
+    }
+  }
+
 #
 # Sub Pixel Filters
 #
@@ -323,38 +347,62 @@ specialize qw/aom_lpf_vertical_14 sse2/;
 add_proto qw/void aom_lpf_vertical_14_dual/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_vertical_14_dual sse2/;
 
+add_proto qw/void aom_lpf_vertical_14_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_vertical_14_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_vertical_6/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_vertical_6 sse2/;
 
+add_proto qw/void aom_lpf_vertical_6_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_vertical_6_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_vertical_8/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_vertical_8 sse2/;
 
 add_proto qw/void aom_lpf_vertical_8_dual/, "uint8_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1";
 
+add_proto qw/void aom_lpf_vertical_8_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_vertical_8_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_vertical_4/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_vertical_4 sse2/;
 
 add_proto qw/void aom_lpf_vertical_4_dual/, "uint8_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1";
 
+add_proto qw/void aom_lpf_vertical_4_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_vertical_4_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_horizontal_14/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_horizontal_14 sse2/;
 
 add_proto qw/void aom_lpf_horizontal_14_dual/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_horizontal_14_dual sse2/;
 
+add_proto qw/void aom_lpf_horizontal_14_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_horizontal_14_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_horizontal_6/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_horizontal_6 sse2/;
 
+add_proto qw/void aom_lpf_horizontal_6_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_horizontal_6_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_horizontal_8/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_horizontal_8 sse2/;
 
 add_proto qw/void aom_lpf_horizontal_8_dual/, "uint8_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1";
 
+add_proto qw/void aom_lpf_horizontal_8_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_horizontal_8_quad sse2 avx2/;
+
 add_proto qw/void aom_lpf_horizontal_4/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
 specialize qw/aom_lpf_horizontal_4 sse2/;
 
 add_proto qw/void aom_lpf_horizontal_4_dual/, "uint8_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1";
 
+add_proto qw/void aom_lpf_horizontal_4_quad/, "uint8_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh";
+specialize qw/aom_lpf_horizontal_4_quad sse2 avx2/;
+
 add_proto qw/void aom_highbd_lpf_vertical_14/, "uint16_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh, int bd";
 specialize qw/aom_highbd_lpf_vertical_14 sse2/;
 
@@ -367,6 +415,12 @@ specialize qw/aom_highbd_lpf_vertical_8 sse2/;
 add_proto qw/void aom_highbd_lpf_vertical_8_dual/, "uint16_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1, int bd";
 specialize qw/aom_highbd_lpf_vertical_8_dual sse2 avx2/;
 
+add_proto qw/void aom_highbd_lpf_vertical_6/, "uint16_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh, int bd";
+specialize qw/aom_highbd_lpf_vertical_6 sse2/;
+
+add_proto qw/void aom_highbd_lpf_vertical_6_dual/, "uint16_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1, int bd";
+specialize qw/aom_highbd_lpf_vertical_6_dual sse2/;
+
 add_proto qw/void aom_highbd_lpf_vertical_4/, "uint16_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh, int bd";
 specialize qw/aom_highbd_lpf_vertical_4 sse2/;
 
@@ -385,6 +439,12 @@ specialize qw/aom_highbd_lpf_horizontal_8 sse2/;
 add_proto qw/void aom_highbd_lpf_horizontal_8_dual/, "uint16_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1, int bd";
 specialize qw/aom_highbd_lpf_horizontal_8_dual sse2 avx2/;
 
+add_proto qw/void aom_highbd_lpf_horizontal_6/, "uint16_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh, int bd";
+specialize qw/aom_highbd_lpf_horizontal_6 sse2/;
+
+add_proto qw/void aom_highbd_lpf_horizontal_6_dual/, "uint16_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1, int bd";
+specialize qw/aom_highbd_lpf_horizontal_6_dual sse2/;
+
 add_proto qw/void aom_highbd_lpf_horizontal_4/, "uint16_t *s, int pitch, const uint8_t *blimit, const uint8_t *limit, const uint8_t *thresh, int bd";
 specialize qw/aom_highbd_lpf_horizontal_4 sse2/;
 
@@ -395,6 +455,26 @@ specialize qw/aom_highbd_lpf_horizontal_4_dual sse2 avx2/;
 add_proto qw/void av1_round_shift_array/, "int32_t *arr, int size, int bit";
 specialize "av1_round_shift_array", qw/sse4_1/;
 
+#
+# Film grain synthesis
+#
+if (aom_config("CONFIG_AV1_DECODER") eq "yes") {
+  add_proto qw/void aom_grain_ar_sum_above/, "int *wsum, const int *grain, int grain_stride, int width, const int *coeffs, int lag";
+  specialize qw/aom_grain_ar_sum_above sse4_1 avx2/;
+
+  add_proto qw/void aom_add_noise_luma/, "uint8_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, const struct aom_grain_noise_params *params";
+  specialize qw/aom_add_noise_luma sse4_1 avx2/;
+
+  add_proto qw/void aom_add_noise_chroma/, "uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, int plane, const struct aom_grain_noise_params *params";
+  specialize qw/aom_add_noise_chroma sse4_1 avx2/;
+
+  add_proto qw/void aom_highbd_add_noise_luma/, "uint16_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, const struct aom_grain_noise_params *params";
+  specialize qw/aom_highbd_add_noise_luma sse4_1 avx2/;
+
+  add_proto qw/void aom_highbd_add_noise_chroma/, "uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, int plane, const struct aom_grain_noise_params *params";
+  specialize qw/aom_highbd_add_noise_chroma sse4_1 avx2/;
+}  # CONFIG_AV1_DECODER
+
 #
 # Encoder functions.
 #
@@ -56,6 +56,14 @@ static INLINE int aom_stop_encode(aom_writer *bc) {
   return aom_daala_stop_encode(bc);
 }
 
+static INLINE int aom_finish_encode(aom_writer *bc, const uint8_t **data) {
+  return aom_daala_finish_encode(bc, data);
+}
+
+static INLINE void aom_clear_encode(aom_writer *bc) {
+  aom_daala_clear_encode(bc);
+}
+
 static INLINE void aom_write(aom_writer *br, int bit, int probability) {
   aom_daala_write(br, bit, probability);
 }
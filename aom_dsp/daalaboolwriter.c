@@ -20,12 +20,18 @@ void aom_daala_start_encode(daala_writer *br, uint8_t *source) {
 
 int aom_daala_stop_encode(daala_writer *br) {
   int nb_bits;
+  const uint8_t *daala_data;
+  nb_bits = aom_daala_finish_encode(br, &daala_data);
+  memcpy(br->buffer, daala_data, br->pos);
+  aom_daala_clear_encode(br);
+  return nb_bits;
+}
+
+int aom_daala_finish_encode(daala_writer *br, const uint8_t **data) {
   uint32_t daala_bytes;
-  unsigned char *daala_data;
-  daala_data = od_ec_enc_done(&br->ec, &daala_bytes);
-  nb_bits = od_ec_enc_tell(&br->ec);
-  memcpy(br->buffer, daala_data, daala_bytes);
+  *data = od_ec_enc_done(&br->ec, &daala_bytes);
   br->pos = daala_bytes;
-  od_ec_enc_clear(&br->ec);
-  return nb_bits;
+  return od_ec_enc_tell(&br->ec);
 }
+
+void aom_daala_clear_encode(daala_writer *br) { od_ec_enc_clear(&br->ec); }
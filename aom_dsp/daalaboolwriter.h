@@ -35,6 +35,11 @@ typedef struct daala_writer daala_writer;
 
 void aom_daala_start_encode(daala_writer *w, uint8_t *buffer);
 int aom_daala_stop_encode(daala_writer *w);
+// Ends the encoding like aom_daala_stop_encode(), but leaves the w->pos coded
+// bytes in the writer, at *data, instead of copying them to the buffer. They
+// stay valid until aom_daala_clear_encode().
+int aom_daala_finish_encode(daala_writer *w, const uint8_t **data);
+void aom_daala_clear_encode(daala_writer *w);
 
 static INLINE void aom_daala_write(daala_writer *w, int bit, int prob) {
   int p = (0x7FFFFF - (prob << 15) + prob) >> 8;
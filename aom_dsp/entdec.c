@@ -14,6 +14,7 @@
 #endif
 
 #include <assert.h>
+#include <string.h>
 #include "aom_dsp/entdec.h"
 #include "aom_dsp/prob.h"
 
@@ -77,9 +78,25 @@
   Even relatively modest values like 100 would work fine.*/
 #define OD_EC_LOTS_OF_BITS (0x4000)
 
+/*Reads 8 bytes as a big-endian value, with a single unaligned load.*/
+static uint64_t od_ec_dec_load_be64(const unsigned char *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+#if CONFIG_BIG_ENDIAN
+  return v;
+#elif defined(__GNUC__)
+  return __builtin_bswap64(v);
+#else
+  v = ((v & 0x00FF00FF00FF00FFULL) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFULL);
+  v = ((v & 0x0000FFFF0000FFFFULL) << 16) |
+      ((v >> 16) & 0x0000FFFF0000FFFFULL);
+  return (v << 32) | (v >> 32);
+#endif
+}
+
 static void od_ec_dec_refill(od_ec_dec *dec) {
   int s;
-  od_ec_window dif;
+  od_ec_dec_window dif;
   int16_t cnt;
   const unsigned char *bptr;
   const unsigned char *end;
@@ -87,10 +104,22 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   cnt = dec->cnt;
   bptr = dec->bptr;
   end = dec->end;
-  s = OD_EC_WINDOW_SIZE - 9 - (cnt + 15);
+  s = OD_EC_DEC_WINDOW_SIZE - 9 - (cnt + 15);
+  if (s >= 0 && end - bptr >= 8) {
+    /*Byte i goes at bit s - 8*i, as in the loop below, so the n bytes that
+       fit are the top of the big-endian load, shifted up by s & 7.*/
+    int n;
+    n = (s >> 3) + 1;
+    assert(n < 8);
+    dif ^= (od_ec_dec_window)(od_ec_dec_load_be64(bptr) >> ((8 - n) << 3))
+           << (s & 7);
+    cnt += n << 3;
+    bptr += n;
+    s -= n << 3;
+  }
   for (; s >= 0 && bptr < end; s -= 8, bptr++) {
-    assert(s <= OD_EC_WINDOW_SIZE - 8);
-    dif ^= (od_ec_window)bptr[0] << s;
+    assert(s <= OD_EC_DEC_WINDOW_SIZE - 8);
+    dif ^= (od_ec_dec_window)bptr[0] << s;
     cnt += 8;
   }
   if (bptr >= end) {
@@ -110,8 +139,8 @@ static void od_ec_dec_refill(od_ec_dec *dec) {
   ret: The value to return.
   Return: ret.
           This allows the compiler to jump to this function via a tail-call.*/
-static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_window dif, unsigned rng,
-                               int ret) {
+static int od_ec_dec_normalize(od_ec_dec *dec, od_ec_dec_window dif,
+                               unsigned rng, int ret) {
   int d;
   assert(rng <= 65535U);
   d = 16 - OD_ILOG_NZ(rng);
@@ -132,10 +161,12 @@ void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
   dec->eptr = buf + storage;
   dec->end_window = 0;
   dec->nend_bits = 0;
+  /*This uses the encoder window size: the first refill leaves cnt 15 below
+     the number of bits read, whatever the size of the decoder window.*/
   dec->tell_offs = 10 - (OD_EC_WINDOW_SIZE - 8);
   dec->end = buf + storage;
   dec->bptr = buf;
-  dec->dif = ((od_ec_window)1 << (OD_EC_WINDOW_SIZE - 1)) - 1;
+  dec->dif = ((od_ec_dec_window)1 << (OD_EC_DEC_WINDOW_SIZE - 1)) - 1;
   dec->rng = 0x8000;
   dec->cnt = -15;
   dec->error = 0;
@@ -146,8 +177,8 @@ void od_ec_dec_init(od_ec_dec *dec, const unsigned char *buf,
   f: The probability that the bit is one, scaled by 32768.
   Return: The value decoded (0 or 1).*/
 int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
-  od_ec_window dif;
-  od_ec_window vw;
+  od_ec_dec_window dif;
+  od_ec_dec_window vw;
   unsigned r;
   unsigned r_new;
   unsigned v;
@@ -156,11 +187,11 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
   assert(f < 32768U);
   dif = dec->dif;
   r = dec->rng;
-  assert(dif >> (OD_EC_WINDOW_SIZE - 16) < r);
+  assert(dif >> (OD_EC_DEC_WINDOW_SIZE - 16) < r);
   assert(32768U <= r);
   v = ((r >> 8) * (uint32_t)(f >> EC_PROB_SHIFT) >> (7 - EC_PROB_SHIFT));
   v += EC_MIN_PROB;
-  vw = (od_ec_window)v << (OD_EC_WINDOW_SIZE - 16);
+  vw = (od_ec_dec_window)v << (OD_EC_DEC_WINDOW_SIZE - 16);
   ret = 1;
   r_new = v;
   if (dif >= vw) {
@@ -171,6 +202,126 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
   return od_ec_dec_normalize(dec, dif, r_new, ret);
 }
 
+/*The decision threshold of symbol i: the decoded symbol is the first one whose
+   threshold is at or below the top 16 bits of the window.*/
+#define OD_EC_DEC_THRESHOLD(r, icdf, N, i)                    \
+  ((((r) >> 8) * (uint32_t)((icdf)[i] >> EC_PROB_SHIFT) >>    \
+    (7 - EC_PROB_SHIFT - CDF_SHIFT)) +                        \
+   EC_MIN_PROB * ((N) - (i)))
+
+#if CDF_USE_SSE2
+/*Returns a mask of the lanes whose threshold (see OD_EC_DEC_THRESHOLD) is
+   above c, given the 8 icdf entries of the symbols in index.
+  The thresholds fit in 16 bits, but the products before the shift take 17, so
+   they are put together from the low and high halves of the products.*/
+static INLINE int od_ec_dec_above_sse2(__m128i icdf, __m128i index, unsigned r,
+                                       unsigned c, int N) {
+  const __m128i sign = _mm_set1_epi16((int16_t)0x8000);
+  const __m128i scale = _mm_set1_epi16((int16_t)(r >> 8));
+  const __m128i p = _mm_srli_epi16(icdf, EC_PROB_SHIFT);
+  const __m128i lo = _mm_mullo_epi16(p, scale);
+  const __m128i hi = _mm_mulhi_epu16(p, scale);
+  const __m128i min_prob = _mm_mullo_epi16(
+      _mm_sub_epi16(_mm_set1_epi16((int16_t)N), index),
+      _mm_set1_epi16(EC_MIN_PROB));
+  __m128i v = _mm_or_si128(
+      _mm_srli_epi16(lo, 7 - EC_PROB_SHIFT - CDF_SHIFT),
+      _mm_slli_epi16(hi, 16 - (7 - EC_PROB_SHIFT - CDF_SHIFT)));
+  v = _mm_add_epi16(v, min_prob);
+  return _mm_movemask_epi8(
+      _mm_cmpgt_epi16(_mm_xor_si128(v, sign),
+                      _mm_xor_si128(_mm_set1_epi16((int16_t)c), sign)));
+}
+
+/*Returns the number of symbols among the first nsyms (4 <= nsyms <= 16) whose
+   threshold is above c, which is the decoded symbol.
+  The thresholds decrease with the symbol index, so the lanes above c are a
+   prefix of each vector and are counted from the position of the first lane
+   that is not.
+  The icdf array has only one more entry, the adaptation counter, so the
+   entries are covered by two overlapping loads: one from the start and one
+   ending at the last entry.*/
+static INLINE int od_ec_dec_find_symbol_sse2(const uint16_t *icdf, int nsyms,
+                                             unsigned r, unsigned c) {
+  const int N = nsyms - 1;
+  if (nsyms >= 8) {
+    const __m128i lanes = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    const int tail = nsyms - 8;
+    const int lo = od_ec_dec_above_sse2(_mm_loadu_si128((const __m128i *)icdf),
+                                        lanes, r, c, N);
+    const int hi = od_ec_dec_above_sse2(
+        _mm_loadu_si128((const __m128i *)(icdf + tail)),
+        _mm_add_epi16(lanes, _mm_set1_epi16((int16_t)tail)), r, c, N);
+    const int lo_count = get_msb(lo + 1) >> 1;
+    const int hi_count = get_msb(hi + 1) >> 1;
+    return lo_count == 8 ? tail + hi_count : lo_count;
+  } else {
+    const int tail = nsyms - 4;
+    const __m128i both =
+        _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i *)icdf),
+                           _mm_loadl_epi64((const __m128i *)(icdf + tail)));
+    const __m128i index =
+        _mm_setr_epi16(0, 1, 2, 3, tail, tail + 1, tail + 2, tail + 3);
+    const int mask = od_ec_dec_above_sse2(both, index, r, c, N);
+    const int lo_count = get_msb((mask & 0xFF) + 1) >> 1;
+    const int hi_count = get_msb((mask >> 8) + 1) >> 1;
+    return lo_count == 4 ? tail + hi_count : lo_count;
+  }
+}
+#endif  // CDF_USE_SSE2
+
+#if CDF_USE_NEON
+/*Returns the number of lanes whose threshold (see OD_EC_DEC_THRESHOLD) is
+   above c in each half of the 8 icdf entries of the symbols in index.
+  Unlike SSE2, NEON has widening multiplies and unsigned compares, so the
+   thresholds are computed and compared directly.*/
+static INLINE uint64x2_t od_ec_dec_above_neon(uint16x8_t icdf, uint16x8_t index,
+                                              unsigned r, unsigned c, int N) {
+  const uint16x4_t scale = vdup_n_u16((uint16_t)(r >> 8));
+  const uint16x8_t p = vshrq_n_u16(icdf, EC_PROB_SHIFT);
+  const uint16x8_t min_prob =
+      vmulq_n_u16(vsubq_u16(vdupq_n_u16((uint16_t)N), index), EC_MIN_PROB);
+  const uint16x8_t v = vaddq_u16(
+      vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(p), scale),
+                               7 - EC_PROB_SHIFT - CDF_SHIFT),
+                   vshrn_n_u32(vmull_u16(vget_high_u16(p), scale),
+                               7 - EC_PROB_SHIFT - CDF_SHIFT)),
+      min_prob);
+  const uint16x8_t above =
+      vshrq_n_u16(vcgtq_u16(v, vdupq_n_u16((uint16_t)c)), 15);
+  return vpaddlq_u32(vpaddlq_u16(above));
+}
+
+/*NEON version of od_ec_dec_find_symbol_sse2().*/
+static INLINE int od_ec_dec_find_symbol_neon(const uint16_t *icdf, int nsyms,
+                                             unsigned r, unsigned c) {
+  static const uint16_t lanes[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  const int N = nsyms - 1;
+  if (nsyms >= 8) {
+    const uint16x8_t index = vld1q_u16(lanes);
+    const int tail = nsyms - 8;
+    const uint64x2_t lo =
+        od_ec_dec_above_neon(vld1q_u16(icdf), index, r, c, N);
+    const uint64x2_t hi = od_ec_dec_above_neon(
+        vld1q_u16(icdf + tail), vaddq_u16(index, vdupq_n_u16((uint16_t)tail)),
+        r, c, N);
+    const int lo_count = (int)(vgetq_lane_u64(lo, 0) + vgetq_lane_u64(lo, 1));
+    const int hi_count = (int)(vgetq_lane_u64(hi, 0) + vgetq_lane_u64(hi, 1));
+    return lo_count == 8 ? tail + hi_count : lo_count;
+  } else {
+    const uint16x4_t index = vld1_u16(lanes);
+    const int tail = nsyms - 4;
+    const uint64x2_t counts = od_ec_dec_above_neon(
+        vcombine_u16(vld1_u16(icdf), vld1_u16(icdf + tail)),
+        vcombine_u16(index, vadd_u16(index, vdup_n_u16((uint16_t)tail))), r, c,
+        N);
+    const int lo_count = (int)vgetq_lane_u64(counts, 0);
+    const int hi_count = (int)vgetq_lane_u64(counts, 1);
+    return lo_count == 4 ? tail + hi_count : lo_count;
+  }
+}
+#endif  // CDF_USE_NEON
+
 /*Decodes a symbol given an inverse cumulative distribution function (CDF)
    table in Q15.
   icdf: CDF_PROB_TOP minus the CDF, such that symbol s falls in the range
@@ -181,7 +332,7 @@ int od_ec_decode_bool_q15(od_ec_dec *dec, unsigned f) {
          This should be at most 16.
   Return: The decoded symbol s.*/
 int od_ec_decode_cdf_q15(od_ec_dec *dec, const uint16_t *icdf, int nsyms) {
-  od_ec_window dif;
+  od_ec_dec_window dif;
   unsigned r;
   unsigned c;
   unsigned u;
@@ -192,23 +343,39 @@ int od_ec_decode_cdf_q15(od_ec_dec *dec, const uint16_t *icdf, int nsyms) {
   r = dec->rng;
   const int N = nsyms - 1;
 
-  assert(dif >> (OD_EC_WINDOW_SIZE - 16) < r);
+  assert(dif >> (OD_EC_DEC_WINDOW_SIZE - 16) < r);
   assert(icdf[nsyms - 1] == OD_ICDF(CDF_PROB_TOP));
   assert(32768U <= r);
   assert(7 - EC_PROB_SHIFT - CDF_SHIFT >= 0);
-  c = (unsigned)(dif >> (OD_EC_WINDOW_SIZE - 16));
-  v = r;
-  ret = -1;
-  do {
-    u = v;
-    v = ((r >> 8) * (uint32_t)(icdf[++ret] >> EC_PROB_SHIFT) >>
-         (7 - EC_PROB_SHIFT - CDF_SHIFT));
-    v += EC_MIN_PROB * (N - ret);
-  } while (c < v);
+  c = (unsigned)(dif >> (OD_EC_DEC_WINDOW_SIZE - 16));
+#if CDF_USE_SSE2
+  if (nsyms >= 4) {
+    assert(nsyms <= 16);
+    ret = od_ec_dec_find_symbol_sse2(icdf, nsyms, r, c);
+    u = ret > 0 ? OD_EC_DEC_THRESHOLD(r, icdf, N, ret - 1) : r;
+    v = OD_EC_DEC_THRESHOLD(r, icdf, N, ret);
+  } else
+#elif CDF_USE_NEON
+  if (nsyms >= 4) {
+    assert(nsyms <= 16);
+    ret = od_ec_dec_find_symbol_neon(icdf, nsyms, r, c);
+    u = ret > 0 ? OD_EC_DEC_THRESHOLD(r, icdf, N, ret - 1) : r;
+    v = OD_EC_DEC_THRESHOLD(r, icdf, N, ret);
+  } else
+#endif
+  {
+    v = r;
+    ret = -1;
+    do {
+      u = v;
+      ++ret;
+      v = OD_EC_DEC_THRESHOLD(r, icdf, N, ret);
+    } while (c < v);
+  }
   assert(v < u);
   assert(u <= r);
   r = u - v;
-  dif -= (od_ec_window)v << (OD_EC_WINDOW_SIZE - 16);
+  dif -= (od_ec_dec_window)v << (OD_EC_DEC_WINDOW_SIZE - 16);
   return od_ec_dec_normalize(dec, dif, r, ret);
 }
 
@@ -12,12 +12,25 @@
 #if !defined(_entdec_H)
 #define _entdec_H (1)
 #include <limits.h>
+#include "./aom_config.h"
 #include "aom_dsp/entcode.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*The decoder window only holds the next bits of the coded value, so it can be
+   wider than the encoder one.
+  A 64-bit window is refilled about half as often as a 32-bit one and takes up
+   to 7 bytes at a time from a single load.*/
+#if CONFIG_EC_WINDOW64
+typedef uint64_t od_ec_dec_window;
+#else
+typedef od_ec_window od_ec_dec_window;
+#endif
+
+#define OD_EC_DEC_WINDOW_SIZE ((int)sizeof(od_ec_dec_window) * CHAR_BIT)
+
 typedef struct od_ec_dec od_ec_dec;
 
 #if defined(OD_ACCOUNTING) && OD_ACCOUNTING
@@ -49,12 +62,12 @@ struct od_ec_dec {
   const unsigned char *bptr;
   /*The difference between the high end of the current range, (low + rng), and
      the coded value, minus 1.
-    This stores up to OD_EC_WINDOW_SIZE bits of that difference, but the
+    This stores up to OD_EC_DEC_WINDOW_SIZE bits of that difference, but the
      decoder only uses the top 16 bits of the window to decode the next symbol.
     As we shift up during renormalization, if we don't have enough bits left in
      the window to fill the top 16, we'll read in more bits of the coded
      value.*/
-  od_ec_window dif;
+  od_ec_dec_window dif;
   /*The number of values in the current range.*/
   uint16_t rng;
   /*The number of bits of data in the current value.*/
@@ -14,11 +14,15 @@
  *
  */
 
+#include <assert.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+
+#include "./aom_dsp_rtcd.h"
 #include "aom_dsp/grain_synthesis.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_util/aom_thread.h"
 
 // Samples with Gaussian distribution in the range of [-2048, 2047] (12 bits)
 // with zero mean and standard deviation of about 512.
@@ -215,11 +219,8 @@ static const int gaussian_sequence[2048] = {
 
 static const int gauss_bits = 11;
 
-static int luma_subblock_size_y = 32;
-static int luma_subblock_size_x = 32;
-
-static int chroma_subblock_size_y = 16;
-static int chroma_subblock_size_x = 16;
+static const int luma_subblock_size_y = 32;
+static const int luma_subblock_size_x = 32;
 
 static const int min_luma_legal_range = 16;
 static const int max_luma_legal_range = 235;
@@ -227,48 +228,92 @@ static const int max_luma_legal_range = 235;
 static const int min_chroma_legal_range = 16;
 static const int max_chroma_legal_range = 240;
 
-static int scaling_lut_y[256];
-static int scaling_lut_cb[256];
-static int scaling_lut_cr[256];
-
-static int grain_center;
-static int grain_min;
-static int grain_max;
-
-static uint16_t random_register = 0;  // random number generator register
-
-static void init_arrays(aom_film_grain_t *params, int luma_stride,
-                        int chroma_stride, int ***pred_pos_luma_p,
-                        int ***pred_pos_chroma_p, int **luma_grain_block,
-                        int **cb_grain_block, int **cr_grain_block,
-                        int **y_line_buf, int **cb_line_buf, int **cr_line_buf,
-                        int **y_col_buf, int **cb_col_buf, int **cr_col_buf,
-                        int luma_grain_samples, int chroma_grain_samples,
-                        int chroma_subsamp_y, int chroma_subsamp_x) {
-  memset(scaling_lut_y, 0, sizeof(*scaling_lut_y) * 256);
-  memset(scaling_lut_cb, 0, sizeof(*scaling_lut_cb) * 256);
-  memset(scaling_lut_cr, 0, sizeof(*scaling_lut_cr) * 256);
-
-  int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
-  int num_pos_chroma = num_pos_luma;
-  if (params->num_y_points > 0) ++num_pos_chroma;
-
-  int **pred_pos_luma;
-  int **pred_pos_chroma;
-
-  pred_pos_luma = (int **)aom_malloc(sizeof(*pred_pos_luma) * num_pos_luma);
-
-  for (int row = 0; row < num_pos_luma; row++) {
-    pred_pos_luma[row] = (int *)aom_malloc(sizeof(**pred_pos_luma) * 3);
-  }
-
-  pred_pos_chroma =
-      (int **)aom_malloc(sizeof(*pred_pos_chroma) * num_pos_chroma);
-
-  for (int row = 0; row < num_pos_chroma; row++) {
-    pred_pos_chroma[row] = (int *)aom_malloc(sizeof(**pred_pos_chroma) * 3);
-  }
+// Padding of the grain templates. Only a 64x64 luma and 32x32 chroma part of
+// a template is used for adding grain, the padding stabilizes the AR process.
+static const int left_pad = 3;
+static const int right_pad = 3;
+static const int top_pad = 3;
+static const int bottom_pad = 0;
+static const int ar_padding = 3;
+
+// Size of the luma grain template, which is also the largest chroma template
+// (4:4:4).
+#define GRAIN_BLOCK_SIZE_Y (3 + 2 * 3 + 2 * 32 + 0)
+#define GRAIN_BLOCK_SIZE_X (3 + 2 * 3 + 2 * 32 + 2 * 3 + 3)
+#define GRAIN_BLOCK_SAMPLES (GRAIN_BLOCK_SIZE_Y * GRAIN_BLOCK_SIZE_X)
+
+// Column buffer size for the overlap with the block to the left: two columns
+// of a 32 row block, plus the two rows of overlap with the block below.
+#define GRAIN_COL_BUF_SIZE ((32 + 2) * 2)
+
+#define MAX_AR_POS_LUMA 24
+#define MAX_AR_POS_CHROMA 25
+
+// Buffers for the overlap of the blocks of a 32 row stripe with the blocks to
+// their left and with the stripe above.
+typedef struct {
+  int *line_buf[3];
+  int col_buf[3][GRAIN_COL_BUF_SIZE];
+  uint16_t random_register;
+} GrainStripeBuffers;
+
+// Pixels the grain is added to, with strides in samples. The planes may be
+// those of the frame, in which case the grain is added in place.
+typedef struct {
+  const uint8_t *planes[3];
+  int stride[3];
+  int width[3];
+  int height[3];
+  int num_planes;
+} GrainSource;
+
+// Everything the stripes of a frame share. Read only while the stripes are
+// being processed.
+typedef struct {
+  const aom_film_grain_t *params;
+  GrainSource src;
+  aom_grain_noise_params_t noise;
+  int *grain_block[3];
+  int luma_grain_stride;
+  int chroma_grain_stride;
+  uint8_t *planes[3];
+  int luma_stride;
+  int chroma_stride;
+  int line_stride[3];
+  int height;
+  int width;
+  int use_high_bit_depth;
+  int chroma_subsamp_y;
+  int chroma_subsamp_x;
+  int chroma_subblock_size_y;
+  int chroma_subblock_size_x;
+  int grain_min;
+  int grain_max;
+} GrainFrame;
+
+typedef struct {
+  const GrainFrame *frame;
+  GrainStripeBuffers bufs;
+  int start_stripe;
+  int end_stripe;
+} GrainWorkerData;
+
+struct aom_film_grain_synth {
+  int grain_block[3][GRAIN_BLOCK_SAMPLES];
+  // Scaling functions for every pixel value of the frame bit depth.
+  int scaling_lut[3][256 << 4];
+  GrainFrame frame;
+  int num_threads;
+  // One set of stripe buffers per worker, each with line buffers of
+  // line_buf_size samples per plane.
+  GrainWorkerData *worker_data;
+  AVxWorker *workers;
+  int num_workers;
+  int line_buf_size;
+};
 
+static void init_pred_pos(const aom_film_grain_t *params,
+                          int pred_pos_luma[][3], int pred_pos_chroma[][3]) {
   int pos_ar_index = 0;
 
   for (int row = -params->ar_coeff_lag; row < 0; row++) {
@@ -302,102 +347,53 @@ static void init_arrays(aom_film_grain_t *params, int luma_stride,
     pred_pos_chroma[pos_ar_index][1] = 0;
     pred_pos_chroma[pos_ar_index][2] = 1;
   }
-
-  *pred_pos_luma_p = pred_pos_luma;
-  *pred_pos_chroma_p = pred_pos_chroma;
-
-  *y_line_buf = (int *)aom_malloc(sizeof(**y_line_buf) * luma_stride * 2);
-  *cb_line_buf = (int *)aom_malloc(sizeof(**cb_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-  *cr_line_buf = (int *)aom_malloc(sizeof(**cr_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-
-  *y_col_buf =
-      (int *)aom_malloc(sizeof(**y_col_buf) * (luma_subblock_size_y + 2) * 2);
-  *cb_col_buf =
-      (int *)aom_malloc(sizeof(**cb_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
-                        (2 >> chroma_subsamp_x));
-  *cr_col_buf =
-      (int *)aom_malloc(sizeof(**cr_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
-                        (2 >> chroma_subsamp_x));
-
-  *luma_grain_block =
-      (int *)aom_malloc(sizeof(**luma_grain_block) * luma_grain_samples);
-  *cb_grain_block =
-      (int *)aom_malloc(sizeof(**cb_grain_block) * chroma_grain_samples);
-  *cr_grain_block =
-      (int *)aom_malloc(sizeof(**cr_grain_block) * chroma_grain_samples);
-}
-
-static void dealloc_arrays(aom_film_grain_t *params, int ***pred_pos_luma,
-                           int ***pred_pos_chroma, int **luma_grain_block,
-                           int **cb_grain_block, int **cr_grain_block,
-                           int **y_line_buf, int **cb_line_buf,
-                           int **cr_line_buf, int **y_col_buf, int **cb_col_buf,
-                           int **cr_col_buf) {
-  int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
-  int num_pos_chroma = num_pos_luma + 1;
-
-  for (int row = 0; row < num_pos_luma; row++) {
-    aom_free((*pred_pos_luma)[row]);
-  }
-  aom_free(*pred_pos_luma);
-
-  for (int row = 0; row < num_pos_chroma; row++) {
-    aom_free((*pred_pos_chroma)[row]);
-  }
-  aom_free((*pred_pos_chroma));
-
-  aom_free(*y_line_buf);
-
-  aom_free(*cb_line_buf);
-
-  aom_free(*cr_line_buf);
-
-  aom_free(*y_col_buf);
-
-  aom_free(*cb_col_buf);
-
-  aom_free(*cr_col_buf);
-
-  aom_free(*luma_grain_block);
-
-  aom_free(*cb_grain_block);
-
-  aom_free(*cr_grain_block);
 }
 
 // get a number between 0 and 2^bits - 1
-static INLINE int get_random_number(int bits) {
+static INLINE int get_random_number(int bits, uint16_t *random_register) {
   uint16_t bit;
-  bit = ((random_register >> 0) ^ (random_register >> 1) ^
-         (random_register >> 3) ^ (random_register >> 12)) &
+  bit = ((*random_register >> 0) ^ (*random_register >> 1) ^
+         (*random_register >> 3) ^ (*random_register >> 12)) &
         1;
-  random_register = (random_register >> 1) | (bit << 15);
-  return (random_register >> (16 - bits)) & ((1 << bits) - 1);
+  *random_register = (*random_register >> 1) | (bit << 15);
+  return (*random_register >> (16 - bits)) & ((1 << bits) - 1);
 }
 
-static void init_random_generator(int luma_line, uint16_t seed) {
+static uint16_t init_random_generator(int luma_line, uint16_t seed) {
   // same for the picture
 
   uint16_t msb = (seed >> 8) & 255;
   uint16_t lsb = seed & 255;
 
-  random_register = (msb << 8) + lsb;
+  uint16_t random_register = (msb << 8) + lsb;
 
   //  changes for each row
   int luma_num = luma_line >> 5;
 
   random_register ^= ((luma_num * 37 + 178) & 255) << 8;
   random_register ^= ((luma_num * 173 + 105) & 255);
+  return random_register;
+}
+
+// Computes the part of the AR filter sums that comes from the lag rows above
+// the current one, for width samples starting at grain. The coefficients are
+// in the order of init_pred_pos(): row by row, left to right.
+void aom_grain_ar_sum_above_c(int *wsum, const int *grain, int grain_stride,
+                              int width, const int *coeffs, int lag) {
+  for (int j = 0; j < width; j++) {
+    int sum = 0;
+    int pos = 0;
+    for (int row = -lag; row < 0; row++)
+      for (int col = -lag; col <= lag; col++)
+        sum += coeffs[pos++] * grain[row * grain_stride + j + col];
+    wsum[j] = sum;
+  }
 }
 
 static void generate_luma_grain_block(
-    aom_film_grain_t *params, int **pred_pos_luma, int *luma_grain_block,
-    int luma_block_size_y, int luma_block_size_x, int luma_grain_stride,
-    int left_pad, int top_pad, int right_pad, int bottom_pad) {
+    const aom_film_grain_t *params, int pred_pos_luma[][3],
+    int *luma_grain_block, int luma_block_size_y, int luma_block_size_x,
+    int luma_grain_stride, int grain_min, int grain_max) {
   if (params->num_y_points == 0) return;
 
   int bit_depth = params->bit_depth;
@@ -405,83 +401,109 @@ static void generate_luma_grain_block(
 
   int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   int rounding_offset = (1 << (params->ar_coeff_shift - 1));
+  uint16_t random_register = params->random_seed;
 
   for (int i = 0; i < luma_block_size_y; i++)
     for (int j = 0; j < luma_block_size_x; j++)
       luma_grain_block[i * luma_grain_stride + j] =
-          (gaussian_sequence[get_random_number(gauss_bits)] +
+          (gaussian_sequence[get_random_number(gauss_bits,
+                                               &random_register)] +
            ((1 << gauss_sec_shift) >> 1)) >>
           gauss_sec_shift;
 
-  for (int i = top_pad; i < luma_block_size_y - bottom_pad; i++)
-    for (int j = left_pad; j < luma_block_size_x - right_pad; j++) {
-      int wsum = 0;
-      for (int pos = 0; pos < num_pos_luma; pos++) {
-        wsum = wsum + params->ar_coeffs_y[pos] *
-                          luma_grain_block[(i + pred_pos_luma[pos][0]) *
-                                               luma_grain_stride +
-                                           j + pred_pos_luma[pos][1]];
-      }
-      luma_grain_block[i * luma_grain_stride + j] =
-          clamp(luma_grain_block[i * luma_grain_stride + j] +
-                    ((wsum + rounding_offset) >> params->ar_coeff_shift),
-                grain_min, grain_max);
+  const int lag = params->ar_coeff_lag;
+  const int num_pos_above = lag * (2 * lag + 1);
+  const int width = luma_block_size_x - left_pad - right_pad;
+  int wsum_above[GRAIN_BLOCK_SIZE_X];
+
+  for (int i = top_pad; i < luma_block_size_y - bottom_pad; i++) {
+    int *const grain = luma_grain_block + i * luma_grain_stride + left_pad;
+    // The taps in the rows above only depend on finished rows, which leaves
+    // the taps to the left in the current row to be done serially.
+    aom_grain_ar_sum_above(wsum_above, grain, luma_grain_stride, width,
+                           params->ar_coeffs_y, lag);
+    for (int j = 0; j < width; j++) {
+      int wsum = wsum_above[j];
+      for (int pos = num_pos_above; pos < num_pos_luma; pos++)
+        wsum += params->ar_coeffs_y[pos] * grain[j + pred_pos_luma[pos][1]];
+      grain[j] = clamp(
+          grain[j] + ((wsum + rounding_offset) >> params->ar_coeff_shift),
+          grain_min, grain_max);
     }
+  }
 }
 
 static void generate_chroma_grain_blocks(
-    aom_film_grain_t *params,
-    //                                  int** pred_pos_luma,
-    int **pred_pos_chroma, int *luma_grain_block, int *cb_grain_block,
-    int *cr_grain_block, int luma_grain_stride, int chroma_block_size_y,
-    int chroma_block_size_x, int chroma_grain_stride, int left_pad, int top_pad,
-    int right_pad, int bottom_pad, int chroma_subsamp_y, int chroma_subsamp_x) {
+    const aom_film_grain_t *params, int pred_pos_chroma[][3],
+    const int *luma_grain_block, int *cb_grain_block, int *cr_grain_block,
+    int luma_grain_stride, int chroma_block_size_y, int chroma_block_size_x,
+    int chroma_grain_stride, int chroma_subsamp_y, int chroma_subsamp_x,
+    int grain_min, int grain_max) {
   int bit_depth = params->bit_depth;
   int gauss_sec_shift = 12 - bit_depth + params->grain_scale_shift;
 
   int num_pos_chroma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   if (params->num_y_points > 0) ++num_pos_chroma;
   int rounding_offset = (1 << (params->ar_coeff_shift - 1));
+  uint16_t random_register;
 
   if (params->num_cb_points || params->chroma_scaling_from_luma) {
-    init_random_generator(7 << 5, params->random_seed);
+    random_register = init_random_generator(7 << 5, params->random_seed);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cb_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(gauss_bits,
+                                                 &random_register)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   }
   if (params->num_cr_points || params->chroma_scaling_from_luma) {
-    init_random_generator(11 << 5, params->random_seed);
+    random_register = init_random_generator(11 << 5, params->random_seed);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cr_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(gauss_bits,
+                                                 &random_register)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   }
 
-  for (int i = top_pad; i < chroma_block_size_y - bottom_pad; i++)
-    for (int j = left_pad; j < chroma_block_size_x - right_pad; j++) {
-      int wsum_cb = 0;
-      int wsum_cr = 0;
-      for (int pos = 0; pos < num_pos_chroma; pos++) {
+  const int apply_cb =
+      params->num_cb_points || params->chroma_scaling_from_luma;
+  const int apply_cr =
+      params->num_cr_points || params->chroma_scaling_from_luma;
+  const int lag = params->ar_coeff_lag;
+  const int num_pos_above = lag * (2 * lag + 1);
+  const int width = chroma_block_size_x - left_pad - right_pad;
+  int wsum_cb_above[GRAIN_BLOCK_SIZE_X];
+  int wsum_cr_above[GRAIN_BLOCK_SIZE_X];
+
+  for (int i = top_pad; i < chroma_block_size_y - bottom_pad; i++) {
+    int *const cb_grain = cb_grain_block + i * chroma_grain_stride + left_pad;
+    int *const cr_grain = cr_grain_block + i * chroma_grain_stride + left_pad;
+    if (apply_cb)
+      aom_grain_ar_sum_above(wsum_cb_above, cb_grain, chroma_grain_stride,
+                             width, params->ar_coeffs_cb, lag);
+    if (apply_cr)
+      aom_grain_ar_sum_above(wsum_cr_above, cr_grain, chroma_grain_stride,
+                             width, params->ar_coeffs_cr, lag);
+    for (int j = 0; j < width; j++) {
+      int wsum_cb = apply_cb ? wsum_cb_above[j] : 0;
+      int wsum_cr = apply_cr ? wsum_cr_above[j] : 0;
+      for (int pos = num_pos_above; pos < num_pos_chroma; pos++) {
         if (pred_pos_chroma[pos][2] == 0) {
-          wsum_cb = wsum_cb + params->ar_coeffs_cb[pos] *
-                                  cb_grain_block[(i + pred_pos_chroma[pos][0]) *
-                                                     chroma_grain_stride +
-                                                 j + pred_pos_chroma[pos][1]];
-          wsum_cr = wsum_cr + params->ar_coeffs_cr[pos] *
-                                  cr_grain_block[(i + pred_pos_chroma[pos][0]) *
-                                                     chroma_grain_stride +
-                                                 j + pred_pos_chroma[pos][1]];
-        } else if (pred_pos_chroma[pos][2] == 1) {
+          if (apply_cb)
+            wsum_cb += params->ar_coeffs_cb[pos] *
+                       cb_grain[j + pred_pos_chroma[pos][1]];
+          if (apply_cr)
+            wsum_cr += params->ar_coeffs_cr[pos] *
+                       cr_grain[j + pred_pos_chroma[pos][1]];
+        } else {
           int av_luma = 0;
           int luma_coord_y = ((i - top_pad) << chroma_subsamp_y) + top_pad;
-          int luma_coord_x = ((j - left_pad) << chroma_subsamp_x) + left_pad;
+          int luma_coord_x = (j << chroma_subsamp_x) + left_pad;
 
           for (int k = luma_coord_y; k < luma_coord_y + chroma_subsamp_y + 1;
                k++)
@@ -493,30 +515,26 @@ static void generate_chroma_grain_blocks(
               (av_luma + ((1 << (chroma_subsamp_y + chroma_subsamp_x)) >> 1)) >>
               (chroma_subsamp_y + chroma_subsamp_x);
 
-          wsum_cb = wsum_cb + params->ar_coeffs_cb[pos] * av_luma;
-          wsum_cr = wsum_cr + params->ar_coeffs_cr[pos] * av_luma;
-        } else {
-          printf(
-              "Grain synthesis: prediction between two chroma components is "
-              "not supported!");
-          exit(1);
+          wsum_cb += params->ar_coeffs_cb[pos] * av_luma;
+          wsum_cr += params->ar_coeffs_cr[pos] * av_luma;
         }
       }
-      if (params->num_cb_points || params->chroma_scaling_from_luma)
-        cb_grain_block[i * chroma_grain_stride + j] =
-            clamp(cb_grain_block[i * chroma_grain_stride + j] +
+      if (apply_cb)
+        cb_grain[j] =
+            clamp(cb_grain[j] +
                       ((wsum_cb + rounding_offset) >> params->ar_coeff_shift),
                   grain_min, grain_max);
-      if (params->num_cr_points || params->chroma_scaling_from_luma)
-        cr_grain_block[i * chroma_grain_stride + j] =
-            clamp(cr_grain_block[i * chroma_grain_stride + j] +
+      if (apply_cr)
+        cr_grain[j] =
+            clamp(cr_grain[j] +
                       ((wsum_cr + rounding_offset) >> params->ar_coeff_shift),
                   grain_min, grain_max);
     }
+  }
 }
 
-static void init_scaling_function(int scaling_points[][2], int num_points,
-                                  int scaling_lut[]) {
+static void init_scaling_function(const int scaling_points[][2],
+                                  int num_points, int scaling_lut[]) {
   if (num_points == 0) return;
 
   for (int i = 0; i < scaling_points[0][0]; i++)
@@ -540,7 +558,7 @@ static void init_scaling_function(int scaling_points[][2], int num_points,
 
 // function that extracts samples from a LUT (and interpolates intemediate
 // frames for 10- and 12-bit video)
-static int scale_LUT(int *scaling_lut, int index, int bit_depth) {
+static int scale_LUT(const int *scaling_lut, int index, int bit_depth) {
   int x = index >> (bit_depth - 8);
 
   if (!(bit_depth - 8) || x == 255)
@@ -552,242 +570,245 @@ static int scale_LUT(int *scaling_lut, int index, int bit_depth) {
                              (bit_depth - 8));
 }
 
-static void add_noise_to_block(aom_film_grain_t *params, uint8_t *luma,
-                               uint8_t *cb, uint8_t *cr, int luma_stride,
-                               int chroma_stride, int *luma_grain,
-                               int *cb_grain, int *cr_grain,
-                               int luma_grain_stride, int chroma_grain_stride,
-                               int half_luma_height, int half_luma_width,
-                               int bit_depth, int chroma_subsamp_y,
-                               int chroma_subsamp_x) {
-  int cb_mult = params->cb_mult - 128;            // fixed scale
-  int cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
-  int cb_offset = params->cb_offset - 256;
-
-  int cr_mult = params->cr_mult - 128;            // fixed scale
-  int cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
-  int cr_offset = params->cr_offset - 256;
+// Expands the 8-bit scaling function of a plane to every pixel value of the
+// bit depth, so that the noise kernels only need a table lookup.
+static void expand_scaling_function(const int scaling_lut_8bit[],
+                                    int bit_depth, int scaling_lut[]) {
+  for (int i = 0; i < (256 << (bit_depth - 8)); i++)
+    scaling_lut[i] = scale_LUT(scaling_lut_8bit, i, bit_depth);
+}
 
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
-  int apply_y = params->num_y_points > 0 ? 1 : 0;
-  int apply_cb =
-      (params->num_cb_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
-  int apply_cr =
-      (params->num_cr_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
+static void init_noise_params(const aom_film_grain_t *params,
+                              int use_high_bit_depth, int chroma_subsamp_y,
+                              int chroma_subsamp_x, int scaling_lut[][256 << 4],
+                              aom_grain_noise_params_t *noise) {
+  const int bit_depth = use_high_bit_depth ? params->bit_depth : 8;
+  int scaling_lut_8bit[3][256];
 
+  memset(scaling_lut_8bit, 0, sizeof(scaling_lut_8bit));
+  init_scaling_function(params->scaling_points_y, params->num_y_points,
+                        scaling_lut_8bit[AOM_PLANE_Y]);
   if (params->chroma_scaling_from_luma) {
-    cb_mult = 0;        // fixed scale
-    cb_luma_mult = 64;  // fixed scale
-    cb_offset = 0;
+    memcpy(scaling_lut_8bit[AOM_PLANE_U], scaling_lut_8bit[AOM_PLANE_Y],
+           sizeof(scaling_lut_8bit[0]));
+    memcpy(scaling_lut_8bit[AOM_PLANE_V], scaling_lut_8bit[AOM_PLANE_Y],
+           sizeof(scaling_lut_8bit[0]));
+  } else {
+    init_scaling_function(params->scaling_points_cb, params->num_cb_points,
+                          scaling_lut_8bit[AOM_PLANE_U]);
+    init_scaling_function(params->scaling_points_cr, params->num_cr_points,
+                          scaling_lut_8bit[AOM_PLANE_V]);
+  }
 
-    cr_mult = 0;        // fixed scale
-    cr_luma_mult = 64;  // fixed scale
-    cr_offset = 0;
+  for (int plane = 0; plane < 3; plane++) {
+    expand_scaling_function(scaling_lut_8bit[plane], bit_depth,
+                            scaling_lut[plane]);
+    noise->scaling_lut[plane] = scaling_lut[plane];
   }
+  noise->scaling_shift = params->scaling_shift;
 
-  int min_luma, max_luma, min_chroma, max_chroma;
+  noise->luma_mult[AOM_PLANE_Y] = noise->mult[AOM_PLANE_Y] = 0;
+  noise->offset[AOM_PLANE_Y] = 0;
+  if (params->chroma_scaling_from_luma) {
+    for (int plane = AOM_PLANE_U; plane <= AOM_PLANE_V; plane++) {
+      noise->mult[plane] = 0;         // fixed scale
+      noise->luma_mult[plane] = 64;  // fixed scale
+      noise->offset[plane] = 0;
+    }
+  } else {
+    noise->mult[AOM_PLANE_U] = params->cb_mult - 128;
+    noise->luma_mult[AOM_PLANE_U] = params->cb_luma_mult - 128;
+    noise->mult[AOM_PLANE_V] = params->cr_mult - 128;
+    noise->luma_mult[AOM_PLANE_V] = params->cr_luma_mult - 128;
+    // offset value depends on the bit depth
+    noise->offset[AOM_PLANE_U] =
+        (params->cb_offset << (bit_depth - 8)) - (1 << bit_depth);
+    noise->offset[AOM_PLANE_V] =
+        (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
+  }
+  noise->max_pixel = (256 << (bit_depth - 8)) - 1;
 
   if (params->clip_to_restricted_range) {
-    min_luma = min_luma_legal_range;
-    max_luma = max_luma_legal_range;
-
-    min_chroma = min_chroma_legal_range;
-    max_chroma = max_chroma_legal_range;
+    noise->min_val[AOM_PLANE_Y] = min_luma_legal_range << (bit_depth - 8);
+    noise->max_val[AOM_PLANE_Y] = max_luma_legal_range << (bit_depth - 8);
+    for (int plane = AOM_PLANE_U; plane <= AOM_PLANE_V; plane++) {
+      noise->min_val[plane] = min_chroma_legal_range << (bit_depth - 8);
+      noise->max_val[plane] = max_chroma_legal_range << (bit_depth - 8);
+    }
   } else {
-    min_luma = min_chroma = 0;
-    max_luma = max_chroma = 255;
+    for (int plane = 0; plane < 3; plane++) {
+      noise->min_val[plane] = 0;
+      noise->max_val[plane] = noise->max_pixel;
+    }
   }
 
-  for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
-      int average_luma = 0;
-      if (chroma_subsamp_x) {
-        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x)] +
-                        luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x) + 1] +
-                        1) >>
-                       1;
-      } else {
-        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-      }
-
-      if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
+  noise->chroma_subsamp_y = chroma_subsamp_y;
+  noise->chroma_subsamp_x = chroma_subsamp_x;
+}
 
-      if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
+void aom_add_noise_luma_c(uint8_t *luma, int luma_stride, const int *grain,
+                          int grain_stride, int width, int height,
+                          const aom_grain_noise_params_t *params) {
+  const int *const scaling_lut = params->scaling_lut[AOM_PLANE_Y];
+  const int rounding_offset = (1 << (params->scaling_shift - 1));
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      luma[i * luma_stride + j] = clamp(
+          luma[i * luma_stride + j] +
+              ((scaling_lut[luma[i * luma_stride + j]] *
+                    grain[i * grain_stride + j] +
+                rounding_offset) >>
+               params->scaling_shift),
+          params->min_val[AOM_PLANE_Y], params->max_val[AOM_PLANE_Y]);
     }
   }
+}
 
-  if (apply_y) {
-    for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j], 8) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
-      }
+void aom_add_noise_chroma_c(uint8_t *chroma, int chroma_stride,
+                            const uint8_t *luma, int luma_stride,
+                            const int *grain, int grain_stride, int width,
+                            int height, int plane,
+                            const aom_grain_noise_params_t *params) {
+  const int *const scaling_lut = params->scaling_lut[plane];
+  const int rounding_offset = (1 << (params->scaling_shift - 1));
+  const int chroma_subsamp_x = params->chroma_subsamp_x;
+  const int chroma_subsamp_y = params->chroma_subsamp_y;
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      const uint8_t *const l = luma + (i << chroma_subsamp_y) * luma_stride +
+                               (j << chroma_subsamp_x);
+      const int average_luma = chroma_subsamp_x ? (l[0] + l[1] + 1) >> 1 : l[0];
+      const int merged =
+          clamp(((average_luma * params->luma_mult[plane] +
+                  params->mult[plane] * chroma[i * chroma_stride + j]) >>
+                 6) +
+                    params->offset[plane],
+                0, params->max_pixel);
+      chroma[i * chroma_stride + j] =
+          clamp(chroma[i * chroma_stride + j] +
+                    ((scaling_lut[merged] * grain[i * grain_stride + j] +
+                      rounding_offset) >>
+                     params->scaling_shift),
+                params->min_val[plane], params->max_val[plane]);
     }
   }
 }
 
-static void add_noise_to_block_hbd(
-    aom_film_grain_t *params, uint16_t *luma, uint16_t *cb, uint16_t *cr,
-    int luma_stride, int chroma_stride, int *luma_grain, int *cb_grain,
-    int *cr_grain, int luma_grain_stride, int chroma_grain_stride,
-    int half_luma_height, int half_luma_width, int bit_depth,
-    int chroma_subsamp_y, int chroma_subsamp_x) {
-  int cb_mult = params->cb_mult - 128;            // fixed scale
-  int cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
-  // offset value depends on the bit depth
-  int cb_offset = (params->cb_offset << (bit_depth - 8)) - (1 << bit_depth);
+void aom_highbd_add_noise_luma_c(uint16_t *luma, int luma_stride,
+                                 const int *grain, int grain_stride, int width,
+                                 int height,
+                                 const aom_grain_noise_params_t *params) {
+  const int *const scaling_lut = params->scaling_lut[AOM_PLANE_Y];
+  const int rounding_offset = (1 << (params->scaling_shift - 1));
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      luma[i * luma_stride + j] = clamp(
+          luma[i * luma_stride + j] +
+              ((scaling_lut[luma[i * luma_stride + j]] *
+                    grain[i * grain_stride + j] +
+                rounding_offset) >>
+               params->scaling_shift),
+          params->min_val[AOM_PLANE_Y], params->max_val[AOM_PLANE_Y]);
+    }
+  }
+}
 
-  int cr_mult = params->cr_mult - 128;            // fixed scale
-  int cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
-  // offset value depends on the bit depth
-  int cr_offset = (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
+void aom_highbd_add_noise_chroma_c(uint16_t *chroma, int chroma_stride,
+                                   const uint16_t *luma, int luma_stride,
+                                   const int *grain, int grain_stride,
+                                   int width, int height, int plane,
+                                   const aom_grain_noise_params_t *params) {
+  const int *const scaling_lut = params->scaling_lut[plane];
+  const int rounding_offset = (1 << (params->scaling_shift - 1));
+  const int chroma_subsamp_x = params->chroma_subsamp_x;
+  const int chroma_subsamp_y = params->chroma_subsamp_y;
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      const uint16_t *const l = luma + (i << chroma_subsamp_y) * luma_stride +
+                                (j << chroma_subsamp_x);
+      const int average_luma = chroma_subsamp_x ? (l[0] + l[1] + 1) >> 1 : l[0];
+      const int merged =
+          clamp(((average_luma * params->luma_mult[plane] +
+                  params->mult[plane] * chroma[i * chroma_stride + j]) >>
+                 6) +
+                    params->offset[plane],
+                0, params->max_pixel);
+      chroma[i * chroma_stride + j] =
+          clamp(chroma[i * chroma_stride + j] +
+                    ((scaling_lut[merged] * grain[i * grain_stride + j] +
+                      rounding_offset) >>
+                     params->scaling_shift),
+                params->min_val[plane], params->max_val[plane]);
+    }
+  }
+}
 
-  int rounding_offset = (1 << (params->scaling_shift - 1));
+// Adds noise to the block of half_luma_height x half_luma_width luma pixel
+// pairs at (half_y, half_x), in units of luma pixel pairs. The chroma noise
+// depends on the luma before noise, so it is added first.
+static void add_noise_to_block(const GrainFrame *f, int half_y, int half_x,
+                               const int *luma_grain, const int *cb_grain,
+                               const int *cr_grain, int luma_grain_stride,
+                               int chroma_grain_stride, int half_luma_height,
+                               int half_luma_width) {
+  const aom_film_grain_t *const params = f->params;
+  const int chroma_subsamp_y = f->chroma_subsamp_y;
+  const int chroma_subsamp_x = f->chroma_subsamp_x;
+  const int luma_offset = (half_y << 1) * f->luma_stride + (half_x << 1);
+  const int chroma_offset =
+      (half_y << (1 - chroma_subsamp_y)) * f->chroma_stride +
+      (half_x << (1 - chroma_subsamp_x));
+  const int chroma_height = half_luma_height << (1 - chroma_subsamp_y);
+  const int chroma_width = half_luma_width << (1 - chroma_subsamp_x);
 
   int apply_y = params->num_y_points > 0 ? 1 : 0;
   int apply_cb =
-      (params->num_cb_points > 0 || params->chroma_scaling_from_luma) > 0 ? 1
-                                                                          : 0;
+      (params->num_cb_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
   int apply_cr =
-      (params->num_cr_points > 0 || params->chroma_scaling_from_luma) > 0 ? 1
-                                                                          : 0;
-
-  if (params->chroma_scaling_from_luma) {
-    cb_mult = 0;        // fixed scale
-    cb_luma_mult = 64;  // fixed scale
-    cb_offset = 0;
-
-    cr_mult = 0;        // fixed scale
-    cr_luma_mult = 64;  // fixed scale
-    cr_offset = 0;
-  }
-
-  int min_luma, max_luma, min_chroma, max_chroma;
-
-  if (params->clip_to_restricted_range) {
-    min_luma = min_luma_legal_range << (bit_depth - 8);
-    max_luma = max_luma_legal_range << (bit_depth - 8);
+      (params->num_cr_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
 
-    min_chroma = min_chroma_legal_range << (bit_depth - 8);
-    max_chroma = max_chroma_legal_range << (bit_depth - 8);
+  if (half_luma_height <= 0 || half_luma_width <= 0) return;
+
+  if (f->use_high_bit_depth) {
+    uint16_t *const luma = (uint16_t *)f->planes[AOM_PLANE_Y] + luma_offset;
+    uint16_t *const cb = (uint16_t *)f->planes[AOM_PLANE_U] + chroma_offset;
+    uint16_t *const cr = (uint16_t *)f->planes[AOM_PLANE_V] + chroma_offset;
+    if (apply_cb)
+      aom_highbd_add_noise_chroma(cb, f->chroma_stride, luma, f->luma_stride,
+                                  cb_grain, chroma_grain_stride, chroma_width,
+                                  chroma_height, AOM_PLANE_U, &f->noise);
+    if (apply_cr)
+      aom_highbd_add_noise_chroma(cr, f->chroma_stride, luma, f->luma_stride,
+                                  cr_grain, chroma_grain_stride, chroma_width,
+                                  chroma_height, AOM_PLANE_V, &f->noise);
+    if (apply_y)
+      aom_highbd_add_noise_luma(luma, f->luma_stride, luma_grain,
+                                luma_grain_stride, half_luma_width << 1,
+                                half_luma_height << 1, &f->noise);
   } else {
-    min_luma = min_chroma = 0;
-    max_luma = max_chroma = (256 << (bit_depth - 8)) - 1;
-  }
-
-  for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
-      int average_luma = 0;
-      if (chroma_subsamp_x) {
-        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x)] +
-                        luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x) + 1] +
-                        1) >>
-                       1;
-      } else {
-        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-      }
-
-      if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-      if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-    }
-  }
-
-  if (apply_y) {
-    for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j],
-                                  bit_depth) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
-      }
-    }
+    uint8_t *const luma = f->planes[AOM_PLANE_Y] + luma_offset;
+    uint8_t *const cb = f->planes[AOM_PLANE_U] + chroma_offset;
+    uint8_t *const cr = f->planes[AOM_PLANE_V] + chroma_offset;
+    if (apply_cb)
+      aom_add_noise_chroma(cb, f->chroma_stride, luma, f->luma_stride,
+                           cb_grain, chroma_grain_stride, chroma_width,
+                           chroma_height, AOM_PLANE_U, &f->noise);
+    if (apply_cr)
+      aom_add_noise_chroma(cr, f->chroma_stride, luma, f->luma_stride,
+                           cr_grain, chroma_grain_stride, chroma_width,
+                           chroma_height, AOM_PLANE_V, &f->noise);
+    if (apply_y)
+      aom_add_noise_luma(luma, f->luma_stride, luma_grain, luma_grain_stride,
+                         half_luma_width << 1, half_luma_height << 1,
+                         &f->noise);
   }
 }
 
-static void copy_rect(uint8_t *src, int src_stride, uint8_t *dst,
-                      int dst_stride, int width, int height,
-                      int use_high_bit_depth) {
-  int hbd_coeff = use_high_bit_depth ? 2 : 1;
-  while (height) {
-    memcpy(dst, src, width * sizeof(uint8_t) * hbd_coeff);
-    src += src_stride;
-    dst += dst_stride;
-    --height;
-  }
-  return;
-}
-
-static void copy_area(int *src, int src_stride, int *dst, int dst_stride,
+static void copy_area(const int *src, int src_stride, int *dst, int dst_stride,
                       int width, int height) {
   while (height) {
     memcpy(dst, src, width * sizeof(*src));
@@ -798,37 +819,44 @@ static void copy_area(int *src, int src_stride, int *dst, int dst_stride,
   return;
 }
 
-static void extend_even(uint8_t *dst, int dst_stride, int width, int height,
-                        int use_high_bit_depth) {
-  if ((width & 1) == 0 && (height & 1) == 0) return;
-  if (use_high_bit_depth) {
-    uint16_t *dst16 = (uint16_t *)dst;
-    if (width & 1) {
-      for (int i = 0; i < height; ++i)
-        dst16[i * dst_stride + width] = dst16[i * dst_stride + width - 1];
-    }
-    width = (width + 1) & (~1);
-    if (height & 1) {
-      memcpy(&dst16[height * dst_stride], &dst16[(height - 1) * dst_stride],
-             sizeof(*dst16) * width);
-    }
-  } else {
-    if (width & 1) {
-      for (int i = 0; i < height; ++i)
-        dst[i * dst_stride + width] = dst[i * dst_stride + width - 1];
-    }
-    width = (width + 1) & (~1);
-    if (height & 1) {
-      memcpy(&dst[height * dst_stride], &dst[(height - 1) * dst_stride],
-             sizeof(*dst) * width);
+// Copies the source rows of the stripe starting at luma row (y << 1) to the
+// frame. The last column and row of a source of odd size are repeated up to
+// the even size of the frame.
+static void copy_stripe_source(const GrainFrame *f, int y) {
+  const GrainSource *const src = &f->src;
+  const int hbd = f->use_high_bit_depth;
+  const int luma_bottom = AOMMIN((y << 1) + luma_subblock_size_y, f->height);
+
+  for (int plane = 0; plane < src->num_planes; plane++) {
+    const int ss_x = plane ? f->chroma_subsamp_x : 0;
+    const int ss_y = plane ? f->chroma_subsamp_y : 0;
+    const int stride = plane ? f->chroma_stride : f->luma_stride;
+    const int width = f->width >> ss_x;
+    const int src_width = src->width[plane];
+    const int bottom = luma_bottom >> ss_y;
+
+    for (int row = (y << 1) >> ss_y; row < bottom; row++) {
+      const int src_row = AOMMIN(row, src->height[plane] - 1);
+      const uint8_t *const src_line =
+          src->planes[plane] + ((src_row * src->stride[plane]) << hbd);
+      uint8_t *const dst_line = f->planes[plane] + ((row * stride) << hbd);
+      if (dst_line != src_line) memcpy(dst_line, src_line, src_width << hbd);
+      if (hbd) {
+        aom_memset16((uint16_t *)dst_line + src_width,
+                     ((const uint16_t *)src_line)[src_width - 1],
+                     width - src_width);
+      } else {
+        memset(dst_line + src_width, src_line[src_width - 1],
+               width - src_width);
+      }
     }
   }
 }
 
-static void ver_boundary_overlap(int *left_block, int left_stride,
-                                 int *right_block, int right_stride,
+static void ver_boundary_overlap(const int *left_block, int left_stride,
+                                 const int *right_block, int right_stride,
                                  int *dst_block, int dst_stride, int width,
-                                 int height) {
+                                 int height, int grain_min, int grain_max) {
   if (width == 1) {
     while (height) {
       *dst_block = clamp((*left_block * 23 + *right_block * 22 + 16) >> 5,
@@ -854,10 +882,10 @@ static void ver_boundary_overlap(int *left_block, int left_stride,
   }
 }
 
-static void hor_boundary_overlap(int *top_block, int top_stride,
-                                 int *bottom_block, int bottom_stride,
+static void hor_boundary_overlap(const int *top_block, int top_stride,
+                                 const int *bottom_block, int bottom_stride,
                                  int *dst_block, int dst_stride, int width,
-                                 int height) {
+                                 int height, int grain_min, int grain_max) {
   if (height == 1) {
     while (width) {
       *dst_block = clamp((*top_block * 23 + *bottom_block * 22 + 16) >> 5,
@@ -885,8 +913,486 @@ static void hor_boundary_overlap(int *top_block, int top_stride,
   }
 }
 
-void av1_add_film_grain(aom_film_grain_t *params, aom_image_t *src,
-                        aom_image_t *dst) {
+// Adds grain to the stripe of 32 luma rows starting at luma row (y << 1). The
+// line buffers must hold the bottom grain rows of the stripe above, which the
+// stripe replaces with its own. When add_noise is 0 only the buffers are
+// updated, which lets a worker start in the middle of the frame.
+static void add_film_grain_stripe(const GrainFrame *f, GrainStripeBuffers *bufs,
+                                  int y, int add_noise) {
+  const aom_film_grain_t *const params = f->params;
+  const int overlap = params->overlap_flag;
+  const int height = f->height;
+  const int width = f->width;
+  const int chroma_subsamp_y = f->chroma_subsamp_y;
+  const int chroma_subsamp_x = f->chroma_subsamp_x;
+  const int chroma_subblock_size_y = f->chroma_subblock_size_y;
+  const int chroma_subblock_size_x = f->chroma_subblock_size_x;
+  const int luma_grain_stride = f->luma_grain_stride;
+  const int chroma_grain_stride = f->chroma_grain_stride;
+  const int luma_line_stride = f->line_stride[AOM_PLANE_Y];
+  const int chroma_line_stride = f->line_stride[AOM_PLANE_U];
+  const int grain_min = f->grain_min;
+  const int grain_max = f->grain_max;
+  const int *const luma_grain_block = f->grain_block[AOM_PLANE_Y];
+  const int *const cb_grain_block = f->grain_block[AOM_PLANE_U];
+  const int *const cr_grain_block = f->grain_block[AOM_PLANE_V];
+  int *const y_line_buf = bufs->line_buf[AOM_PLANE_Y];
+  int *const cb_line_buf = bufs->line_buf[AOM_PLANE_U];
+  int *const cr_line_buf = bufs->line_buf[AOM_PLANE_V];
+  int *const y_col_buf = bufs->col_buf[AOM_PLANE_Y];
+  int *const cb_col_buf = bufs->col_buf[AOM_PLANE_U];
+  int *const cr_col_buf = bufs->col_buf[AOM_PLANE_V];
+
+  bufs->random_register = init_random_generator(y * 2, params->random_seed);
+
+  for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
+    int offset_y = get_random_number(8, &bufs->random_register);
+    int offset_x = (offset_y >> 4) & 15;
+    offset_y &= 15;
+
+    int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
+    int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
+
+    int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                          offset_y * (2 >> chroma_subsamp_y);
+    int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                          offset_x * (2 >> chroma_subsamp_x);
+
+    if (overlap && x) {
+      ver_boundary_overlap(
+          y_col_buf, 2,
+          luma_grain_block + luma_offset_y * luma_grain_stride + luma_offset_x,
+          luma_grain_stride, y_col_buf, 2, 2,
+          AOMMIN(luma_subblock_size_y + 2, height - (y << 1)), grain_min,
+          grain_max);
+
+      ver_boundary_overlap(
+          cb_col_buf, 2 >> chroma_subsamp_x,
+          cb_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x,
+          chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+          2 >> chroma_subsamp_x,
+          AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                 (height - (y << 1)) >> chroma_subsamp_y),
+          grain_min, grain_max);
+
+      ver_boundary_overlap(
+          cr_col_buf, 2 >> chroma_subsamp_x,
+          cr_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x,
+          chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+          2 >> chroma_subsamp_x,
+          AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                 (height - (y << 1)) >> chroma_subsamp_y),
+          grain_min, grain_max);
+
+      int i = y ? 1 : 0;
+
+      if (add_noise) {
+        add_noise_to_block(
+            f, y + i, x, y_col_buf + i * 4,
+            cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+            cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
+            2, (2 - chroma_subsamp_x),
+            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1);
+      }
+    }
+
+    if (overlap && y) {
+      if (x) {
+        hor_boundary_overlap(y_line_buf + (x << 1), luma_line_stride, y_col_buf,
+                             2, y_line_buf + (x << 1), luma_line_stride, 2, 2,
+                             grain_min, grain_max);
+
+        hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_line_stride, cb_col_buf,
+                             2 >> chroma_subsamp_x,
+                             cb_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_line_stride, 2 >> chroma_subsamp_x,
+                             2 >> chroma_subsamp_y, grain_min, grain_max);
+
+        hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_line_stride, cr_col_buf,
+                             2 >> chroma_subsamp_x,
+                             cr_line_buf + x * (2 >> chroma_subsamp_x),
+                             chroma_line_stride, 2 >> chroma_subsamp_x,
+                             2 >> chroma_subsamp_y, grain_min, grain_max);
+      }
+
+      hor_boundary_overlap(
+          y_line_buf + ((x ? x + 1 : 0) << 1), luma_line_stride,
+          luma_grain_block + luma_offset_y * luma_grain_stride + luma_offset_x +
+              (x ? 2 : 0),
+          luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1),
+          luma_line_stride,
+          AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
+                 width - ((x ? x + 1 : 0) << 1)),
+          2, grain_min, grain_max);
+
+      hor_boundary_overlap(
+          cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_line_stride,
+          cb_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_line_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y, grain_min, grain_max);
+
+      hor_boundary_overlap(
+          cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_line_stride,
+          cr_grain_block + chroma_offset_y * chroma_grain_stride +
+              chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_line_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y, grain_min, grain_max);
+
+      if (add_noise) {
+        add_noise_to_block(f, y, x, y_line_buf + (x << 1),
+                           cb_line_buf + (x << (1 - chroma_subsamp_x)),
+                           cr_line_buf + (x << (1 - chroma_subsamp_x)),
+                           luma_line_stride, chroma_line_stride, 1,
+                           AOMMIN(luma_subblock_size_x >> 1, width / 2 - x));
+      }
+    }
+
+    int i = overlap && y ? 1 : 0;
+    int j = overlap && x ? 1 : 0;
+
+    if (add_noise) {
+      add_noise_to_block(
+          f, y + i, x + j,
+          luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
+              luma_offset_x + (j << 1),
+          cb_grain_block +
+              (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                  chroma_grain_stride +
+              chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+          cr_grain_block +
+              (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
+                  chroma_grain_stride +
+              chroma_offset_x + (j << (1 - chroma_subsamp_x)),
+          luma_grain_stride, chroma_grain_stride,
+          AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
+          AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j);
+    }
+
+    if (overlap) {
+      if (x) {
+        // Copy overlapped column bufer to line buffer
+        copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
+                  y_line_buf + (x << 1), luma_line_stride, 2, 2);
+
+        copy_area(
+            cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+            2 >> chroma_subsamp_x,
+            cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_line_stride,
+            2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+
+        copy_area(
+            cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+            2 >> chroma_subsamp_x,
+            cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_line_stride,
+            2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+      }
+
+      // Copy grain to the line buffer for overlap with a bottom block
+      copy_area(
+          luma_grain_block +
+              (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
+              luma_offset_x + ((x ? 2 : 0)),
+          luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1),
+          luma_line_stride,
+          AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
+
+      copy_area(cb_grain_block +
+                    (chroma_offset_y + chroma_subblock_size_y) *
+                        chroma_grain_stride +
+                    chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
+                chroma_grain_stride,
+                cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+                chroma_line_stride,
+                AOMMIN(chroma_subblock_size_x,
+                       ((width - (x << 1)) >> chroma_subsamp_x)) -
+                    (x ? 2 >> chroma_subsamp_x : 0),
+                2 >> chroma_subsamp_y);
+
+      copy_area(cr_grain_block +
+                    (chroma_offset_y + chroma_subblock_size_y) *
+                        chroma_grain_stride +
+                    chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
+                chroma_grain_stride,
+                cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+                chroma_line_stride,
+                AOMMIN(chroma_subblock_size_x,
+                       ((width - (x << 1)) >> chroma_subsamp_x)) -
+                    (x ? 2 >> chroma_subsamp_x : 0),
+                2 >> chroma_subsamp_y);
+
+      // Copy grain to the column buffer for overlap with the next block to
+      // the right
+
+      copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
+                    luma_offset_x + luma_subblock_size_x,
+                luma_grain_stride, y_col_buf, 2, 2,
+                AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
+
+      copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
+                    chroma_offset_x + chroma_subblock_size_x,
+                chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
+                2 >> chroma_subsamp_x,
+                AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                       (height - (y << 1)) >> chroma_subsamp_y));
+
+      copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
+                    chroma_offset_x + chroma_subblock_size_x,
+                chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
+                2 >> chroma_subsamp_x,
+                AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                       (height - (y << 1)) >> chroma_subsamp_y));
+    }
+  }
+}
+
+static int grain_stripe_worker_hook(void *arg1, void *unused) {
+  GrainWorkerData *const data = (GrainWorkerData *)arg1;
+  const GrainFrame *const f = data->frame;
+  const int stripe_height = luma_subblock_size_y >> 1;
+  (void)unused;
+
+  // The overlap with the stripe above needs its grain in the line buffers.
+  if (data->start_stripe > 0 && f->params->overlap_flag) {
+    add_film_grain_stripe(f, &data->bufs,
+                          (data->start_stripe - 1) * stripe_height, 0);
+  }
+  for (int stripe = data->start_stripe; stripe < data->end_stripe; stripe++) {
+    copy_stripe_source(f, stripe * stripe_height);
+    add_film_grain_stripe(f, &data->bufs, stripe * stripe_height, 1);
+  }
+  return 1;
+}
+
+static void free_stripe_buffers(GrainStripeBuffers *bufs) {
+  for (int plane = 0; plane < 3; plane++) {
+    aom_free(bufs->line_buf[plane]);
+    bufs->line_buf[plane] = NULL;
+  }
+}
+
+aom_film_grain_synth_t *av1_film_grain_synth_alloc(int num_threads) {
+  aom_film_grain_synth_t *const synth =
+      (aom_film_grain_synth_t *)aom_calloc(1, sizeof(*synth));
+  if (synth == NULL) return NULL;
+  synth->num_threads = AOMMAX(num_threads, 1);
+  return synth;
+}
+
+void av1_film_grain_synth_free(aom_film_grain_synth_t *synth) {
+  if (synth == NULL) return;
+  if (synth->workers != NULL) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < synth->num_workers; i++)
+      winterface->end(&synth->workers[i]);
+    aom_free(synth->workers);
+  }
+  if (synth->worker_data != NULL) {
+    for (int i = 0; i < synth->num_workers; i++)
+      free_stripe_buffers(&synth->worker_data[i].bufs);
+    aom_free(synth->worker_data);
+  }
+  aom_free(synth);
+}
+
+// Creates the workers on first use, the last of which runs on the calling
+// thread, and makes sure their line buffers can hold a line of the frame.
+static int alloc_grain_workers(aom_film_grain_synth_t *synth, int width) {
+  if (synth->worker_data == NULL) {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    const int num_workers = synth->num_threads;
+
+    synth->worker_data = (GrainWorkerData *)aom_calloc(
+        num_workers, sizeof(*synth->worker_data));
+    if (synth->worker_data == NULL) return -1;
+    synth->workers =
+        (AVxWorker *)aom_malloc(num_workers * sizeof(*synth->workers));
+    if (synth->workers == NULL) return -1;
+
+    for (int i = 0; i < num_workers; i++) {
+      AVxWorker *const worker = &synth->workers[i];
+      winterface->init(worker);
+      worker->hook = grain_stripe_worker_hook;
+      worker->data1 = &synth->worker_data[i];
+      worker->data2 = NULL;
+      ++synth->num_workers;
+      if (i < num_workers - 1 && !winterface->reset(worker)) return -1;
+    }
+  }
+
+  if (synth->line_buf_size < width) {
+    for (int i = 0; i < synth->num_workers; i++) {
+      GrainStripeBuffers *const bufs = &synth->worker_data[i].bufs;
+      free_stripe_buffers(bufs);
+      for (int plane = 0; plane < 3; plane++) {
+        // Two rows per plane. The chroma planes are at most as wide as luma.
+        bufs->line_buf[plane] =
+            (int *)aom_calloc(2 * width, sizeof(*bufs->line_buf[plane]));
+        if (bufs->line_buf[plane] == NULL) {
+          synth->line_buf_size = 0;
+          return -1;
+        }
+      }
+    }
+    synth->line_buf_size = width;
+  }
+  return 0;
+}
+
+// Adds grain to the frame of even size at luma, cb and cr, whose pixels are
+// copied from src a stripe at a time.
+static int add_film_grain_run(aom_film_grain_synth_t *synth,
+                              const aom_film_grain_t *params,
+                              const GrainSource *src, uint8_t *luma,
+                              uint8_t *cb, uint8_t *cr, int height, int width,
+                              int luma_stride, int chroma_stride,
+                              int use_high_bit_depth, int chroma_subsamp_y,
+                              int chroma_subsamp_x) {
+  int pred_pos_luma[MAX_AR_POS_LUMA][3];
+  int pred_pos_chroma[MAX_AR_POS_CHROMA][3];
+  aom_film_grain_synth_t *const own_synth =
+      synth == NULL ? av1_film_grain_synth_alloc(1) : NULL;
+  GrainFrame *f;
+  int res = 0;
+
+  if (synth == NULL) {
+    if (own_synth == NULL) return -1;
+    synth = own_synth;
+  }
+  f = &synth->frame;
+
+  f->chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
+  f->chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
+
+  int luma_block_size_y =
+      top_pad + 2 * ar_padding + luma_subblock_size_y * 2 + bottom_pad;
+  int luma_block_size_x = left_pad + 2 * ar_padding + luma_subblock_size_x * 2 +
+                          2 * ar_padding + right_pad;
+
+  int chroma_block_size_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                            f->chroma_subblock_size_y * 2 + bottom_pad;
+  int chroma_block_size_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                            f->chroma_subblock_size_x * 2 +
+                            (2 >> chroma_subsamp_x) * ar_padding + right_pad;
+
+  assert(luma_block_size_y * luma_block_size_x == GRAIN_BLOCK_SAMPLES);
+  assert(chroma_block_size_y * chroma_block_size_x <= GRAIN_BLOCK_SAMPLES);
+
+  int bit_depth = params->bit_depth;
+  int grain_center = 128 << (bit_depth - 8);
+
+  f->params = params;
+  f->src = *src;
+  f->grain_min = 0 - grain_center;
+  f->grain_max = (256 << (bit_depth - 8)) - 1 - grain_center;
+  f->luma_grain_stride = luma_block_size_x;
+  f->chroma_grain_stride = chroma_block_size_x;
+  for (int plane = 0; plane < 3; plane++)
+    f->grain_block[plane] = synth->grain_block[plane];
+  f->planes[AOM_PLANE_Y] = luma;
+  f->planes[AOM_PLANE_U] = cb;
+  f->planes[AOM_PLANE_V] = cr;
+  f->luma_stride = luma_stride;
+  f->chroma_stride = chroma_stride;
+  f->line_stride[AOM_PLANE_Y] = width;
+  f->line_stride[AOM_PLANE_U] = f->line_stride[AOM_PLANE_V] =
+      width >> chroma_subsamp_x;
+  f->height = height;
+  f->width = width;
+  f->use_high_bit_depth = use_high_bit_depth;
+  f->chroma_subsamp_y = chroma_subsamp_y;
+  f->chroma_subsamp_x = chroma_subsamp_x;
+
+  init_pred_pos(params, pred_pos_luma, pred_pos_chroma);
+
+  generate_luma_grain_block(params, pred_pos_luma,
+                            f->grain_block[AOM_PLANE_Y], luma_block_size_y,
+                            luma_block_size_x, f->luma_grain_stride,
+                            f->grain_min, f->grain_max);
+
+  generate_chroma_grain_blocks(
+      params, pred_pos_chroma, f->grain_block[AOM_PLANE_Y],
+      f->grain_block[AOM_PLANE_U], f->grain_block[AOM_PLANE_V],
+      f->luma_grain_stride, chroma_block_size_y, chroma_block_size_x,
+      f->chroma_grain_stride, chroma_subsamp_y, chroma_subsamp_x, f->grain_min,
+      f->grain_max);
+
+  init_noise_params(params, use_high_bit_depth, chroma_subsamp_y,
+                    chroma_subsamp_x, synth->scaling_lut, &f->noise);
+
+  if (alloc_grain_workers(synth, width)) {
+    res = -1;
+  } else {
+    // Each worker takes a run of consecutive stripes.
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    const int num_stripes =
+        (height / 2 + (luma_subblock_size_y >> 1) - 1) /
+        (luma_subblock_size_y >> 1);
+    const int num_workers = AOMMIN(synth->num_workers, num_stripes);
+
+    for (int i = 0; i < num_workers; i++) {
+      AVxWorker *const worker =
+          &synth->workers[i < num_workers - 1 ? i : synth->num_workers - 1];
+      GrainWorkerData *const data = (GrainWorkerData *)worker->data1;
+      data->frame = f;
+      data->start_stripe = num_stripes * i / num_workers;
+      data->end_stripe = num_stripes * (i + 1) / num_workers;
+      if (i == num_workers - 1)
+        winterface->execute(worker);
+      else
+        winterface->launch(worker);
+    }
+    for (int i = 0; i < num_workers; i++) {
+      AVxWorker *const worker =
+          &synth->workers[i < num_workers - 1 ? i : synth->num_workers - 1];
+      winterface->sync(worker);
+    }
+  }
+
+  av1_film_grain_synth_free(own_synth);
+  return res;
+}
+
+int av1_add_film_grain_run(aom_film_grain_synth_t *synth,
+                           const aom_film_grain_t *params, uint8_t *luma,
+                           uint8_t *cb, uint8_t *cr, int height, int width,
+                           int luma_stride, int chroma_stride,
+                           int use_high_bit_depth, int chroma_subsamp_y,
+                           int chroma_subsamp_x) {
+  const GrainSource source = {
+    { luma, cb, cr },
+    { luma_stride, chroma_stride, chroma_stride },
+    { width, width >> chroma_subsamp_x, width >> chroma_subsamp_x },
+    { height, height >> chroma_subsamp_y, height >> chroma_subsamp_y },
+    3
+  };
+  return add_film_grain_run(synth, params, &source, luma, cb, cr, height,
+                            width, luma_stride, chroma_stride,
+                            use_high_bit_depth, chroma_subsamp_y,
+                            chroma_subsamp_x);
+}
+
+int av1_add_film_grain(aom_film_grain_synth_t *synth,
+                       const aom_film_grain_t *params, const aom_image_t *src,
+                       aom_image_t *dst) {
+  aom_film_grain_t frame_params;
+  GrainSource source;
   uint8_t *luma, *cb, *cr;
   int height, width, luma_stride, chroma_stride;
   int use_high_bit_depth = 0;
@@ -927,8 +1433,7 @@ void av1_add_film_grain(aom_film_grain_t *params, aom_image_t *src,
       chroma_subsamp_y = 0;
       break;
     default:  // unknown input format
-      printf("Film grain error: input format is not supported!");
-      exit(1);
+      return -1;
   }
 
   dst->r_w = src->r_w;
@@ -939,23 +1444,14 @@ void av1_add_film_grain(aom_film_grain_t *params, aom_image_t *src,
   width = src->d_w % 2 ? src->d_w + 1 : src->d_w;
   height = src->d_h % 2 ? src->d_h + 1 : src->d_h;
 
-  copy_rect(src->planes[AOM_PLANE_Y], src->stride[AOM_PLANE_Y],
-            dst->planes[AOM_PLANE_Y], dst->stride[AOM_PLANE_Y], src->d_w,
-            src->d_h, use_high_bit_depth);
-  // Note that dst is already assumed to be aligned to even.
-  extend_even(dst->planes[AOM_PLANE_Y], dst->stride[AOM_PLANE_Y], src->d_w,
-              src->d_h, use_high_bit_depth);
-
-  if (!src->monochrome) {
-    copy_rect(src->planes[AOM_PLANE_U], src->stride[AOM_PLANE_U],
-              dst->planes[AOM_PLANE_U], dst->stride[AOM_PLANE_U],
-              width >> chroma_subsamp_x, height >> chroma_subsamp_y,
-              use_high_bit_depth);
-
-    copy_rect(src->planes[AOM_PLANE_V], src->stride[AOM_PLANE_V],
-              dst->planes[AOM_PLANE_V], dst->stride[AOM_PLANE_V],
-              width >> chroma_subsamp_x, height >> chroma_subsamp_y,
-              use_high_bit_depth);
+  source.num_planes = src->monochrome ? 1 : 3;
+  for (int plane = 0; plane < source.num_planes; plane++) {
+    const int ss_x = plane ? chroma_subsamp_x : 0;
+    const int ss_y = plane ? chroma_subsamp_y : 0;
+    source.planes[plane] = src->planes[plane];
+    source.stride[plane] = src->stride[plane] >> use_high_bit_depth;
+    source.width[plane] = (src->d_w + ss_x) >> ss_x;
+    source.height[plane] = (src->d_h + ss_y) >> ss_y;
   }
 
   luma = dst->planes[AOM_PLANE_Y];
@@ -966,394 +1462,11 @@ void av1_add_film_grain(aom_film_grain_t *params, aom_image_t *src,
   luma_stride = dst->stride[AOM_PLANE_Y] >> use_high_bit_depth;
   chroma_stride = dst->stride[AOM_PLANE_U] >> use_high_bit_depth;
 
-  params->bit_depth = dst->bit_depth;
-
-  av1_add_film_grain_run(params, luma, cb, cr, height, width, luma_stride,
-                         chroma_stride, use_high_bit_depth, chroma_subsamp_y,
-                         chroma_subsamp_x);
-  return;
-}
-
-void av1_add_film_grain_run(aom_film_grain_t *params, uint8_t *luma,
-                            uint8_t *cb, uint8_t *cr, int height, int width,
-                            int luma_stride, int chroma_stride,
-                            int use_high_bit_depth, int chroma_subsamp_y,
-                            int chroma_subsamp_x) {
-  int **pred_pos_luma;
-  int **pred_pos_chroma;
-  int *luma_grain_block;
-  int *cb_grain_block;
-  int *cr_grain_block;
-
-  int *y_line_buf;
-  int *cb_line_buf;
-  int *cr_line_buf;
-
-  int *y_col_buf;
-  int *cb_col_buf;
-  int *cr_col_buf;
-
-  random_register = params->random_seed;
-
-  int left_pad = 3;
-  int right_pad = 3;  // padding to offset for AR coefficients
-  int top_pad = 3;
-  int bottom_pad = 0;
-
-  int ar_padding = 3;  // maximum lag used for stabilization of AR coefficients
-
-  luma_subblock_size_y = 32;
-  luma_subblock_size_x = 32;
-
-  chroma_subblock_size_y = luma_subblock_size_y >> chroma_subsamp_y;
-  chroma_subblock_size_x = luma_subblock_size_x >> chroma_subsamp_x;
-
-  // Initial padding is only needed for generation of
-  // film grain templates (to stabilize the AR process)
-  // Only a 64x64 luma and 32x32 chroma part of a template
-  // is used later for adding grain, padding can be discarded
-
-  int luma_block_size_y =
-      top_pad + 2 * ar_padding + luma_subblock_size_y * 2 + bottom_pad;
-  int luma_block_size_x = left_pad + 2 * ar_padding + luma_subblock_size_x * 2 +
-                          2 * ar_padding + right_pad;
-
-  int chroma_block_size_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            chroma_subblock_size_y * 2 + bottom_pad;
-  int chroma_block_size_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            chroma_subblock_size_x * 2 +
-                            (2 >> chroma_subsamp_x) * ar_padding + right_pad;
-
-  int luma_grain_stride = luma_block_size_x;
-  int chroma_grain_stride = chroma_block_size_x;
-
-  int overlap = params->overlap_flag;
-  int bit_depth = params->bit_depth;
-
-  grain_center = 128 << (bit_depth - 8);
-  grain_min = 0 - grain_center;
-  grain_max = (256 << (bit_depth - 8)) - 1 - grain_center;
-
-  init_arrays(params, luma_stride, chroma_stride, &pred_pos_luma,
-              &pred_pos_chroma, &luma_grain_block, &cb_grain_block,
-              &cr_grain_block, &y_line_buf, &cb_line_buf, &cr_line_buf,
-              &y_col_buf, &cb_col_buf, &cr_col_buf,
-              luma_block_size_y * luma_block_size_x,
-              chroma_block_size_y * chroma_block_size_x, chroma_subsamp_y,
-              chroma_subsamp_x);
-
-  generate_luma_grain_block(params, pred_pos_luma, luma_grain_block,
-                            luma_block_size_y, luma_block_size_x,
-                            luma_grain_stride, left_pad, top_pad, right_pad,
-                            bottom_pad);
-
-  generate_chroma_grain_blocks(
-      params,
-      //                               pred_pos_luma,
-      pred_pos_chroma, luma_grain_block, cb_grain_block, cr_grain_block,
-      luma_grain_stride, chroma_block_size_y, chroma_block_size_x,
-      chroma_grain_stride, left_pad, top_pad, right_pad, bottom_pad,
-      chroma_subsamp_y, chroma_subsamp_x);
-
-  init_scaling_function(params->scaling_points_y, params->num_y_points,
-                        scaling_lut_y);
-
-  if (params->chroma_scaling_from_luma) {
-    memcpy(scaling_lut_cb, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-    memcpy(scaling_lut_cr, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-  } else {
-    init_scaling_function(params->scaling_points_cb, params->num_cb_points,
-                          scaling_lut_cb);
-    init_scaling_function(params->scaling_points_cr, params->num_cr_points,
-                          scaling_lut_cr);
-  }
-  for (int y = 0; y < height / 2; y += (luma_subblock_size_y >> 1)) {
-    init_random_generator(y * 2, params->random_seed);
-
-    for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
-      int offset_y = get_random_number(8);
-      int offset_x = (offset_y >> 4) & 15;
-      offset_y &= 15;
-
-      int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
-      int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
-
-      int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            offset_y * (2 >> chroma_subsamp_y);
-      int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            offset_x * (2 >> chroma_subsamp_x);
-
-      if (overlap && x) {
-        ver_boundary_overlap(
-            y_col_buf, 2,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x,
-            luma_grain_stride, y_col_buf, 2, 2,
-            AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        ver_boundary_overlap(
-            cb_col_buf, 2 >> chroma_subsamp_x,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        ver_boundary_overlap(
-            cr_col_buf, 2 >> chroma_subsamp_x,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        int i = y ? 1 : 0;
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params,
-              (uint16_t *)luma + ((y + i) << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              (uint16_t *)cr +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x);
-        } else {
-          add_noise_to_block(
-              params, luma + ((y + i) << 1) * luma_stride + (x << 1),
-              cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x);
-        }
-      }
-
-      if (overlap && y) {
-        if (x) {
-          hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
-                               y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                               cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-
-          hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                               cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-        }
-
-        hor_boundary_overlap(
-            y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x + (x ? 2 : 0),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
-                   width - ((x ? x + 1 : 0) << 1)),
-            2);
-
-        hor_boundary_overlap(
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        hor_boundary_overlap(
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params, (uint16_t *)luma + (y << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              (uint16_t *)cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x);
-        } else {
-          add_noise_to_block(
-              params, luma + (y << 1) * luma_stride + (x << 1),
-              cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x);
-        }
-      }
-
-      int i = overlap && y ? 1 : 0;
-      int j = overlap && x ? 1 : 0;
-
-      if (use_high_bit_depth) {
-        add_noise_to_block_hbd(
-            params,
-            (uint16_t *)luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            (uint16_t *)cb +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            (uint16_t *)cr +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x);
-      } else {
-        add_noise_to_block(
-            params, luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x);
-      }
-
-      if (overlap) {
-        if (x) {
-          // Copy overlapped column bufer to line buffer
-          copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
-                    y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          copy_area(
-              cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-
-          copy_area(
-              cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-        }
-
-        // Copy grain to the line buffer for overlap with a bottom block
-        copy_area(
-            luma_grain_block +
-                (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
-                luma_offset_x + ((x ? 2 : 0)),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
-
-        copy_area(cb_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        copy_area(cr_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        // Copy grain to the column buffer for overlap with the next block to
-        // the right
-
-        copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
-                      luma_offset_x + luma_subblock_size_x,
-                  luma_grain_stride, y_col_buf, 2, 2,
-                  AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-
-        copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-      }
-    }
-  }
+  frame_params = *params;
+  frame_params.bit_depth = dst->bit_depth;
 
-  dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &luma_grain_block,
-                 &cb_grain_block, &cr_grain_block, &y_line_buf, &cb_line_buf,
-                 &cr_line_buf, &y_col_buf, &cb_col_buf, &cr_col_buf);
+  return add_film_grain_run(synth, &frame_params, &source, luma, cb, cr,
+                            height, width, luma_stride, chroma_stride,
+                            use_high_bit_depth, chroma_subsamp_y,
+                            chroma_subsamp_x);
 }
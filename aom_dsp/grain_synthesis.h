@@ -81,10 +81,54 @@ typedef struct {
   uint16_t random_seed;
 } aom_film_grain_t;
 
+/*!\brief Noise parameters of a frame, as used by the noise kernels
+ *
+ * The scaling functions cover every pixel value of the bit depth. The
+ * multipliers and the offset are those of the chroma planes, luma has no
+ * chroma dependency.
+ */
+typedef struct aom_grain_noise_params {
+  const int *scaling_lut[3];
+  int scaling_shift;
+  int luma_mult[3];
+  int mult[3];
+  int offset[3];
+  int max_pixel;
+  int min_val[3];
+  int max_val[3];
+  int chroma_subsamp_x;
+  int chroma_subsamp_y;
+} aom_grain_noise_params_t;
+
+/*!\brief Film grain synthesizer
+ *
+ * Holds the grain templates, the scaling functions, the overlap buffers and
+ * the worker threads of the synthesis, so that they are allocated once and
+ * reused from frame to frame. A synthesizer can only process one frame at a
+ * time, separate synthesizers can be used concurrently.
+ */
+typedef struct aom_film_grain_synth aom_film_grain_synth_t;
+
+/*!\brief Allocate a film grain synthesizer
+ *
+ * \param[in]    num_threads      Number of threads adding the grain, the
+ *                                calling thread included
+ *
+ * \return Returns the synthesizer, or NULL on allocation failure.
+ */
+aom_film_grain_synth_t *av1_film_grain_synth_alloc(int num_threads);
+
+/*!\brief Free a film grain synthesizer
+ *
+ * \param[in]    synth            Synthesizer to free, may be NULL
+ */
+void av1_film_grain_synth_free(aom_film_grain_synth_t *synth);
+
 /*!\brief Add film grain
  *
  * Add film grain to an image
  *
+ * \param[in]    synth            Synthesizer, or NULL for a temporary one
  * \param[in]    grain_params     Grain parameters
  * \param[in]    luma             luma plane
  * \param[in]    cb               cb plane
@@ -93,23 +137,37 @@ typedef struct {
  * \param[in]    width            luma plane width
  * \param[in]    luma_stride      luma plane stride
  * \param[in]    chroma_stride    chroma plane stride
+ *
+ * \return Returns 0 on success, -1 on allocation failure.
  */
-void av1_add_film_grain_run(aom_film_grain_t *grain_params, uint8_t *luma,
-                            uint8_t *cb, uint8_t *cr, int height, int width,
-                            int luma_stride, int chroma_stride,
-                            int use_high_bit_depth, int chroma_subsamp_y,
-                            int chroma_subsamp_x);
+int av1_add_film_grain_run(aom_film_grain_synth_t *synth,
+                           const aom_film_grain_t *grain_params, uint8_t *luma,
+                           uint8_t *cb, uint8_t *cr, int height, int width,
+                           int luma_stride, int chroma_stride,
+                           int use_high_bit_depth, int chroma_subsamp_y,
+                           int chroma_subsamp_x);
 
 /*!\brief Add film grain
  *
  * Add film grain to an image
  *
+ * \param[in]    synth            Synthesizer, or NULL for a temporary one
  * \param[in]    grain_params     Grain parameters
  * \param[in]    src              Source image
- * \param[in]    dst              Resulting image with grain
+ * \param[in]    dst              Resulting image with grain, which may be src
+ *                                to add the grain in place
+ *
+ * The source pixels are copied to dst while the grain is added, stripe by
+ * stripe. dst must be allocated with even width and height, and when the
+ * grain is added in place src must have room for one more column and row if
+ * its size is odd.
+ *
+ * \return Returns 0 on success, -1 on an unsupported image format or an
+ * allocation failure.
  */
-void av1_add_film_grain(aom_film_grain_t *grain_params, aom_image_t *src,
-                        aom_image_t *dst);
+int av1_add_film_grain(aom_film_grain_synth_t *synth,
+                       const aom_film_grain_t *grain_params,
+                       const aom_image_t *src, aom_image_t *dst);
 
 #ifdef __cplusplus
 }  // extern "C"
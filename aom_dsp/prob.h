@@ -23,6 +23,25 @@
 
 #include "aom_dsp/entcode.h"
 
+// The CDF search and adaptation run once per coded symbol, so they use SSE2
+// or NEON directly when the compiler targets it rather than through run-time
+// CPU detection, which would cost more than it saves.
+#if HAVE_SSE2 && (defined(__SSE2__) || defined(_M_X64) || \
+                  (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CDF_USE_SSE2 1
+#include <emmintrin.h>
+#else
+#define CDF_USE_SSE2 0
+#endif
+
+#if !CDF_USE_SSE2 && HAVE_NEON && \
+    (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define CDF_USE_NEON 1
+#include <arm_neon.h>
+#else
+#define CDF_USE_NEON 0
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -642,6 +661,97 @@ static INLINE uint8_t get_prob(unsigned int num, unsigned int den) {
   }
 }
 
+#if CDF_USE_SSE2
+// Adapts the CDF entries in 'cdf' whose symbol indices are in 'index'.
+// Entries below the coded symbol 'val' move towards AOM_ICDF(0) and the
+// others towards 0, exactly as the scalar loop in update_cdf() does.
+static INLINE __m128i update_cdf_lanes_sse2(__m128i cdf, __m128i index,
+                                            __m128i val, __m128i rate) {
+  const __m128i top = _mm_set1_epi16((int16_t)AOM_ICDF(0));
+  const __m128i below = _mm_cmpgt_epi16(val, index);
+  const __m128i up =
+      _mm_add_epi16(cdf, _mm_srl_epi16(_mm_sub_epi16(top, cdf), rate));
+  const __m128i down = _mm_sub_epi16(cdf, _mm_srl_epi16(cdf, rate));
+  return _mm_or_si128(_mm_and_si128(below, up), _mm_andnot_si128(below, down));
+}
+
+// Adapts the first 'nsymbs' entries of 'cdf' (4 <= nsymbs <= 16). The CDF
+// array has only one more entry, the counter, so the entries are covered by
+// two overlapping loads: one from the start and one ending at the last
+// entry. The overlapping lanes get the same values in both halves.
+static INLINE void update_cdf_sse2(aom_cdf_prob *cdf, int val, int nsymbs,
+                                   int rate) {
+  const __m128i rate_v = _mm_cvtsi32_si128(rate);
+  const __m128i val_v = _mm_set1_epi16((int16_t)val);
+  if (nsymbs >= 8) {
+    const int tail = nsymbs - 8;
+    const __m128i index = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i lo = _mm_loadu_si128((const __m128i *)cdf);
+    const __m128i hi = _mm_loadu_si128((const __m128i *)(cdf + tail));
+    _mm_storeu_si128(
+        (__m128i *)(cdf + tail),
+        update_cdf_lanes_sse2(
+            hi, _mm_add_epi16(index, _mm_set1_epi16((int16_t)tail)), val_v,
+            rate_v));
+    _mm_storeu_si128((__m128i *)cdf,
+                     update_cdf_lanes_sse2(lo, index, val_v, rate_v));
+  } else {
+    const int tail = nsymbs - 4;
+    const __m128i index = _mm_setr_epi16(0, 1, 2, 3, tail, tail + 1, tail + 2,
+                                         tail + 3);
+    const __m128i both = _mm_unpacklo_epi64(
+        _mm_loadl_epi64((const __m128i *)cdf),
+        _mm_loadl_epi64((const __m128i *)(cdf + tail)));
+    const __m128i res = update_cdf_lanes_sse2(both, index, val_v, rate_v);
+    _mm_storel_epi64((__m128i *)(cdf + tail), _mm_srli_si128(res, 8));
+    _mm_storel_epi64((__m128i *)cdf, res);
+  }
+}
+#endif  // CDF_USE_SSE2
+
+#if CDF_USE_NEON
+// NEON version of update_cdf_lanes_sse2().
+static INLINE uint16x8_t update_cdf_lanes_neon(uint16x8_t cdf, uint16x8_t index,
+                                               uint16x8_t val,
+                                               int16x8_t neg_rate) {
+  const uint16x8_t top = vdupq_n_u16((uint16_t)AOM_ICDF(0));
+  const uint16x8_t below = vcgtq_u16(val, index);
+  const uint16x8_t up =
+      vaddq_u16(cdf, vshlq_u16(vsubq_u16(top, cdf), neg_rate));
+  const uint16x8_t down = vsubq_u16(cdf, vshlq_u16(cdf, neg_rate));
+  return vbslq_u16(below, up, down);
+}
+
+// NEON version of update_cdf_sse2().
+static INLINE void update_cdf_neon(aom_cdf_prob *cdf, int val, int nsymbs,
+                                   int rate) {
+  static const uint16_t lanes[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+  const int16x8_t neg_rate = vdupq_n_s16((int16_t)-rate);
+  const uint16x8_t val_v = vdupq_n_u16((uint16_t)val);
+  if (nsymbs >= 8) {
+    const int tail = nsymbs - 8;
+    const uint16x8_t index = vld1q_u16(lanes);
+    const uint16x8_t lo = vld1q_u16(cdf);
+    const uint16x8_t hi = vld1q_u16(cdf + tail);
+    vst1q_u16(cdf + tail,
+              update_cdf_lanes_neon(
+                  hi, vaddq_u16(index, vdupq_n_u16((uint16_t)tail)), val_v,
+                  neg_rate));
+    vst1q_u16(cdf, update_cdf_lanes_neon(lo, index, val_v, neg_rate));
+  } else {
+    const int tail = nsymbs - 4;
+    const uint16x4_t index = vld1_u16(lanes);
+    const uint16x8_t both = vcombine_u16(vld1_u16(cdf), vld1_u16(cdf + tail));
+    const uint16x8_t res = update_cdf_lanes_neon(
+        both,
+        vcombine_u16(index, vadd_u16(index, vdup_n_u16((uint16_t)tail))),
+        val_v, neg_rate);
+    vst1_u16(cdf + tail, vget_high_u16(res));
+    vst1_u16(cdf, vget_low_u16(res));
+  }
+}
+#endif  // CDF_USE_NEON
+
 static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
   int rate;
   int i, tmp;
@@ -653,6 +763,20 @@ static INLINE void update_cdf(aom_cdf_prob *cdf, int val, int nsymbs) {
          nsymbs2speed[nsymbs];  // + get_msb(nsymbs);
   tmp = AOM_ICDF(0);
 
+#if CDF_USE_SSE2
+  if (nsymbs >= 4) {
+    update_cdf_sse2(cdf, val, nsymbs, rate);
+    cdf[nsymbs] += (cdf[nsymbs] < 32);
+    return;
+  }
+#elif CDF_USE_NEON
+  if (nsymbs >= 4) {
+    update_cdf_neon(cdf, val, nsymbs, rate);
+    cdf[nsymbs] += (cdf[nsymbs] < 32);
+    return;
+  }
+#endif
+
   // Single loop (faster)
   for (i = 0; i < nsymbs - 1; ++i) {
     tmp = (i == val) ? 0 : tmp;
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/grain_synthesis.h"
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_dsp/x86/synonyms_avx2.h"
+
+// The noise is computed on 32-bit lanes, 8 pixels at a time, with gathers
+// from the scaling function.
+
+static INLINE __m256i load_pixels(const void *p, int highbd) {
+  if (highbd) return _mm256_cvtepu16_epi32(xx_loadu_128(p));
+  return _mm256_cvtepu8_epi32(xx_loadl_64(p));
+}
+
+static INLINE void store_pixels(void *p, __m256i v, int highbd) {
+  // The packing works within 128-bit lanes, the permute gathers the results
+  // of both lanes in the low half.
+  const __m256i v16 =
+      _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+  const __m128i lo = _mm256_castsi256_si128(v16);
+  if (highbd)
+    xx_storeu_128(p, lo);
+  else
+    xx_storel_64(p, _mm_packus_epi16(lo, lo));
+}
+
+// Returns the average of the luma pixels collocated with 8 chroma pixels.
+static INLINE __m256i load_average_luma(const void *p, int subsamp_x,
+                                        int highbd) {
+  if (!subsamp_x) return load_pixels(p, highbd);
+  const __m256i l =
+      highbd ? yy_loadu_256(p) : _mm256_cvtepu8_epi16(xx_loadu_128(p));
+  const __m256i sum = _mm256_madd_epi16(l, _mm256_set1_epi16(1));
+  return _mm256_srai_epi32(_mm256_add_epi32(sum, _mm256_set1_epi32(1)), 1);
+}
+
+// Returns the pixels with the scaled grain added, clamped to the legal range.
+static INLINE __m256i add_scaled_grain(__m256i pixels, __m256i scale,
+                                       const int *grain, __m256i rounding,
+                                       __m128i shift, __m256i min_val,
+                                       __m256i max_val) {
+  const __m256i g = yy_loadu_256(grain);
+  const __m256i noise = _mm256_sra_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(scale, g), rounding), shift);
+  return _mm256_min_epi32(
+      _mm256_max_epi32(_mm256_add_epi32(pixels, noise), min_val), max_val);
+}
+
+static INLINE void add_noise_luma(void *luma, int luma_stride,
+                                  const int *grain, int grain_stride,
+                                  int width, int height,
+                                  const aom_grain_noise_params_t *params,
+                                  int highbd) {
+  const int *const lut = params->scaling_lut[AOM_PLANE_Y];
+  const __m256i rounding = _mm256_set1_epi32(1 << (params->scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(params->scaling_shift);
+  const __m256i min_val = _mm256_set1_epi32(params->min_val[AOM_PLANE_Y]);
+  const __m256i max_val = _mm256_set1_epi32(params->max_val[AOM_PLANE_Y]);
+  const int w8 = width & ~7;
+
+  for (int i = 0; i < height; i++) {
+    uint8_t *const row = (uint8_t *)luma + ((i * luma_stride) << highbd);
+    const int *const grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      uint8_t *const p = row + (j << highbd);
+      const __m256i pixels = load_pixels(p, highbd);
+      const __m256i scale = _mm256_i32gather_epi32(lut, pixels, 4);
+      store_pixels(p,
+                   add_scaled_grain(pixels, scale, grain_row + j, rounding,
+                                    shift, min_val, max_val),
+                   highbd);
+    }
+  }
+
+  if (w8 == width) return;
+  if (highbd)
+    aom_highbd_add_noise_luma_c((uint16_t *)luma + w8, luma_stride, grain + w8,
+                                grain_stride, width - w8, height, params);
+  else
+    aom_add_noise_luma_c((uint8_t *)luma + w8, luma_stride, grain + w8,
+                         grain_stride, width - w8, height, params);
+}
+
+static INLINE void add_noise_chroma(void *chroma, int chroma_stride,
+                                    const void *luma, int luma_stride,
+                                    const int *grain, int grain_stride,
+                                    int width, int height, int plane,
+                                    const aom_grain_noise_params_t *params,
+                                    int highbd) {
+  const int *const lut = params->scaling_lut[plane];
+  const int subsamp_x = params->chroma_subsamp_x;
+  const int subsamp_y = params->chroma_subsamp_y;
+  const __m256i rounding = _mm256_set1_epi32(1 << (params->scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(params->scaling_shift);
+  const __m256i min_val = _mm256_set1_epi32(params->min_val[plane]);
+  const __m256i max_val = _mm256_set1_epi32(params->max_val[plane]);
+  const __m256i luma_mult = _mm256_set1_epi32(params->luma_mult[plane]);
+  const __m256i mult = _mm256_set1_epi32(params->mult[plane]);
+  const __m256i offset = _mm256_set1_epi32(params->offset[plane]);
+  const __m256i max_pixel = _mm256_set1_epi32(params->max_pixel);
+  const int w8 = width & ~7;
+
+  for (int i = 0; i < height; i++) {
+    uint8_t *const row = (uint8_t *)chroma + ((i * chroma_stride) << highbd);
+    const uint8_t *const luma_row =
+        (const uint8_t *)luma + (((i << subsamp_y) * luma_stride) << highbd);
+    const int *const grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w8; j += 8) {
+      uint8_t *const p = row + (j << highbd);
+      const __m256i pixels = load_pixels(p, highbd);
+      const __m256i average_luma = load_average_luma(
+          luma_row + ((j << subsamp_x) << highbd), subsamp_x, highbd);
+      const __m256i combined =
+          _mm256_add_epi32(_mm256_mullo_epi32(average_luma, luma_mult),
+                           _mm256_mullo_epi32(pixels, mult));
+      const __m256i merged = _mm256_min_epi32(
+          _mm256_max_epi32(
+              _mm256_add_epi32(_mm256_srai_epi32(combined, 6), offset),
+              _mm256_setzero_si256()),
+          max_pixel);
+      const __m256i scale = _mm256_i32gather_epi32(lut, merged, 4);
+      store_pixels(p,
+                   add_scaled_grain(pixels, scale, grain_row + j, rounding,
+                                    shift, min_val, max_val),
+                   highbd);
+    }
+  }
+
+  if (w8 == width) return;
+  if (highbd)
+    aom_highbd_add_noise_chroma_c(
+        (uint16_t *)chroma + w8, chroma_stride,
+        (const uint16_t *)luma + (w8 << subsamp_x), luma_stride, grain + w8,
+        grain_stride, width - w8, height, plane, params);
+  else
+    aom_add_noise_chroma_c((uint8_t *)chroma + w8, chroma_stride,
+                           (const uint8_t *)luma + (w8 << subsamp_x),
+                           luma_stride, grain + w8, grain_stride, width - w8,
+                           height, plane, params);
+}
+
+void aom_add_noise_luma_avx2(uint8_t *luma, int luma_stride, const int *grain,
+                             int grain_stride, int width, int height,
+                             const aom_grain_noise_params_t *params) {
+  add_noise_luma(luma, luma_stride, grain, grain_stride, width, height, params,
+                 0);
+}
+
+void aom_add_noise_chroma_avx2(uint8_t *chroma, int chroma_stride,
+                               const uint8_t *luma, int luma_stride,
+                               const int *grain, int grain_stride, int width,
+                               int height, int plane,
+                               const aom_grain_noise_params_t *params) {
+  add_noise_chroma(chroma, chroma_stride, luma, luma_stride, grain,
+                   grain_stride, width, height, plane, params, 0);
+}
+
+void aom_highbd_add_noise_luma_avx2(uint16_t *luma, int luma_stride,
+                                    const int *grain, int grain_stride,
+                                    int width, int height,
+                                    const aom_grain_noise_params_t *params) {
+  add_noise_luma(luma, luma_stride, grain, grain_stride, width, height, params,
+                 1);
+}
+
+void aom_highbd_add_noise_chroma_avx2(uint16_t *chroma, int chroma_stride,
+                                      const uint16_t *luma, int luma_stride,
+                                      const int *grain, int grain_stride,
+                                      int width, int height, int plane,
+                                      const aom_grain_noise_params_t *params) {
+  add_noise_chroma(chroma, chroma_stride, luma, luma_stride, grain,
+                   grain_stride, width, height, plane, params, 1);
+}
+
+void aom_grain_ar_sum_above_avx2(int *wsum, const int *grain,
+                                 int grain_stride, int width,
+                                 const int *coeffs, int lag) {
+  // Up to 3 rows of 7 taps, broadcast once for the whole row.
+  __m256i c[3 * 7];
+  const int num_pos = lag * (2 * lag + 1);
+  const int w8 = width & ~7;
+
+  for (int pos = 0; pos < num_pos; pos++)
+    c[pos] = _mm256_set1_epi32(coeffs[pos]);
+
+  for (int j = 0; j < w8; j += 8) {
+    __m256i sum = _mm256_setzero_si256();
+    int pos = 0;
+    for (int row = -lag; row < 0; row++) {
+      const int *const g = grain + row * grain_stride + j;
+      for (int col = -lag; col <= lag; col++)
+        sum = _mm256_add_epi32(
+            sum, _mm256_mullo_epi32(c[pos++], yy_loadu_256(g + col)));
+    }
+    yy_storeu_256(wsum + j, sum);
+  }
+
+  if (w8 == width) return;
+  aom_grain_ar_sum_above_c(wsum + w8, grain + w8, grain_stride, width - w8,
+                           coeffs, lag);
+}
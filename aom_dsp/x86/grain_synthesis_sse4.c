@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/grain_synthesis.h"
+#include "aom_dsp/x86/synonyms.h"
+
+// The noise is computed on 32-bit lanes, 4 pixels at a time. The scaling
+// function has no vector lookup before AVX2 and is read lane by lane.
+
+static INLINE __m128i load_pixels(const void *p, int highbd) {
+  if (highbd) return _mm_cvtepu16_epi32(xx_loadl_64(p));
+  return _mm_cvtepu8_epi32(xx_loadl_32(p));
+}
+
+static INLINE void store_pixels(void *p, __m128i v, int highbd) {
+  const __m128i v16 = _mm_packus_epi32(v, v);
+  if (highbd)
+    xx_storel_64(p, v16);
+  else
+    xx_storel_32(p, _mm_packus_epi16(v16, v16));
+}
+
+// Returns the average of the luma pixels collocated with 4 chroma pixels.
+static INLINE __m128i load_average_luma(const void *p, int subsamp_x,
+                                        int highbd) {
+  if (!subsamp_x) return load_pixels(p, highbd);
+  const __m128i l =
+      highbd ? xx_loadu_128(p) : _mm_cvtepu8_epi16(xx_loadl_64(p));
+  const __m128i sum = _mm_madd_epi16(l, _mm_set1_epi16(1));
+  return _mm_srai_epi32(_mm_add_epi32(sum, _mm_set1_epi32(1)), 1);
+}
+
+static INLINE __m128i scaling_lookup(const int *lut, __m128i idx) {
+  return _mm_setr_epi32(lut[_mm_extract_epi32(idx, 0)],
+                        lut[_mm_extract_epi32(idx, 1)],
+                        lut[_mm_extract_epi32(idx, 2)],
+                        lut[_mm_extract_epi32(idx, 3)]);
+}
+
+// Returns the pixels with the scaled grain added, clamped to the legal range.
+static INLINE __m128i add_scaled_grain(__m128i pixels, __m128i scale,
+                                       const int *grain, __m128i rounding,
+                                       __m128i shift, __m128i min_val,
+                                       __m128i max_val) {
+  const __m128i g = xx_loadu_128(grain);
+  const __m128i noise =
+      _mm_sra_epi32(_mm_add_epi32(_mm_mullo_epi32(scale, g), rounding), shift);
+  return _mm_min_epi32(_mm_max_epi32(_mm_add_epi32(pixels, noise), min_val),
+                       max_val);
+}
+
+static INLINE void add_noise_luma(void *luma, int luma_stride,
+                                  const int *grain, int grain_stride,
+                                  int width, int height,
+                                  const aom_grain_noise_params_t *params,
+                                  int highbd) {
+  const int *const lut = params->scaling_lut[AOM_PLANE_Y];
+  const __m128i rounding = _mm_set1_epi32(1 << (params->scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(params->scaling_shift);
+  const __m128i min_val = _mm_set1_epi32(params->min_val[AOM_PLANE_Y]);
+  const __m128i max_val = _mm_set1_epi32(params->max_val[AOM_PLANE_Y]);
+  const int w4 = width & ~3;
+
+  for (int i = 0; i < height; i++) {
+    uint8_t *const row = (uint8_t *)luma + ((i * luma_stride) << highbd);
+    const int *const grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w4; j += 4) {
+      uint8_t *const p = row + (j << highbd);
+      const __m128i pixels = load_pixels(p, highbd);
+      store_pixels(p,
+                   add_scaled_grain(pixels, scaling_lookup(lut, pixels),
+                                    grain_row + j, rounding, shift, min_val,
+                                    max_val),
+                   highbd);
+    }
+  }
+
+  if (w4 == width) return;
+  if (highbd)
+    aom_highbd_add_noise_luma_c((uint16_t *)luma + w4, luma_stride, grain + w4,
+                                grain_stride, width - w4, height, params);
+  else
+    aom_add_noise_luma_c((uint8_t *)luma + w4, luma_stride, grain + w4,
+                         grain_stride, width - w4, height, params);
+}
+
+static INLINE void add_noise_chroma(void *chroma, int chroma_stride,
+                                    const void *luma, int luma_stride,
+                                    const int *grain, int grain_stride,
+                                    int width, int height, int plane,
+                                    const aom_grain_noise_params_t *params,
+                                    int highbd) {
+  const int *const lut = params->scaling_lut[plane];
+  const int subsamp_x = params->chroma_subsamp_x;
+  const int subsamp_y = params->chroma_subsamp_y;
+  const __m128i rounding = _mm_set1_epi32(1 << (params->scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(params->scaling_shift);
+  const __m128i min_val = _mm_set1_epi32(params->min_val[plane]);
+  const __m128i max_val = _mm_set1_epi32(params->max_val[plane]);
+  const __m128i luma_mult = _mm_set1_epi32(params->luma_mult[plane]);
+  const __m128i mult = _mm_set1_epi32(params->mult[plane]);
+  const __m128i offset = _mm_set1_epi32(params->offset[plane]);
+  const __m128i max_pixel = _mm_set1_epi32(params->max_pixel);
+  const int w4 = width & ~3;
+
+  for (int i = 0; i < height; i++) {
+    uint8_t *const row = (uint8_t *)chroma + ((i * chroma_stride) << highbd);
+    const uint8_t *const luma_row =
+        (const uint8_t *)luma + (((i << subsamp_y) * luma_stride) << highbd);
+    const int *const grain_row = grain + i * grain_stride;
+    for (int j = 0; j < w4; j += 4) {
+      uint8_t *const p = row + (j << highbd);
+      const __m128i pixels = load_pixels(p, highbd);
+      const __m128i average_luma = load_average_luma(
+          luma_row + ((j << subsamp_x) << highbd), subsamp_x, highbd);
+      const __m128i combined =
+          _mm_add_epi32(_mm_mullo_epi32(average_luma, luma_mult),
+                        _mm_mullo_epi32(pixels, mult));
+      const __m128i merged = _mm_min_epi32(
+          _mm_max_epi32(_mm_add_epi32(_mm_srai_epi32(combined, 6), offset),
+                        _mm_setzero_si128()),
+          max_pixel);
+      store_pixels(p,
+                   add_scaled_grain(pixels, scaling_lookup(lut, merged),
+                                    grain_row + j, rounding, shift, min_val,
+                                    max_val),
+                   highbd);
+    }
+  }
+
+  if (w4 == width) return;
+  if (highbd)
+    aom_highbd_add_noise_chroma_c(
+        (uint16_t *)chroma + w4, chroma_stride,
+        (const uint16_t *)luma + (w4 << subsamp_x), luma_stride, grain + w4,
+        grain_stride, width - w4, height, plane, params);
+  else
+    aom_add_noise_chroma_c((uint8_t *)chroma + w4, chroma_stride,
+                           (const uint8_t *)luma + (w4 << subsamp_x),
+                           luma_stride, grain + w4, grain_stride, width - w4,
+                           height, plane, params);
+}
+
+void aom_add_noise_luma_sse4_1(uint8_t *luma, int luma_stride,
+                               const int *grain, int grain_stride, int width,
+                               int height,
+                               const aom_grain_noise_params_t *params) {
+  add_noise_luma(luma, luma_stride, grain, grain_stride, width, height, params,
+                 0);
+}
+
+void aom_add_noise_chroma_sse4_1(uint8_t *chroma, int chroma_stride,
+                                 const uint8_t *luma, int luma_stride,
+                                 const int *grain, int grain_stride, int width,
+                                 int height, int plane,
+                                 const aom_grain_noise_params_t *params) {
+  add_noise_chroma(chroma, chroma_stride, luma, luma_stride, grain,
+                   grain_stride, width, height, plane, params, 0);
+}
+
+void aom_highbd_add_noise_luma_sse4_1(uint16_t *luma, int luma_stride,
+                                      const int *grain, int grain_stride,
+                                      int width, int height,
+                                      const aom_grain_noise_params_t *params) {
+  add_noise_luma(luma, luma_stride, grain, grain_stride, width, height, params,
+                 1);
+}
+
+void aom_highbd_add_noise_chroma_sse4_1(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height, int plane,
+    const aom_grain_noise_params_t *params) {
+  add_noise_chroma(chroma, chroma_stride, luma, luma_stride, grain,
+                   grain_stride, width, height, plane, params, 1);
+}
+
+void aom_grain_ar_sum_above_sse4_1(int *wsum, const int *grain,
+                                   int grain_stride, int width,
+                                   const int *coeffs, int lag) {
+  // Up to 3 rows of 7 taps, broadcast once for the whole row.
+  __m128i c[3 * 7];
+  const int num_pos = lag * (2 * lag + 1);
+  const int w4 = width & ~3;
+
+  for (int pos = 0; pos < num_pos; pos++) c[pos] = _mm_set1_epi32(coeffs[pos]);
+
+  for (int j = 0; j < w4; j += 4) {
+    __m128i sum = _mm_setzero_si128();
+    int pos = 0;
+    for (int row = -lag; row < 0; row++) {
+      const int *const g = grain + row * grain_stride + j;
+      for (int col = -lag; col <= lag; col++)
+        sum = _mm_add_epi32(sum,
+                            _mm_mullo_epi32(c[pos++], xx_loadu_128(g + col)));
+    }
+    xx_storeu_128(wsum + j, sum);
+  }
+
+  if (w4 == width) return;
+  aom_grain_ar_sum_above_c(wsum + w4, grain + w4, grain_stride, width - w4,
+                           coeffs, lag);
+}
@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/intrapred_common.h"
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_dsp/x86/synonyms_avx2.h"
+
+// All predictors work on 16 columns at a time, so they are only provided for
+// the blocks that are at least 16 pixels wide.
+
+// -----------------------------------------------------------------------------
+// DC_PRED, DC_TOP_PRED, DC_LEFT_PRED, DC_128_PRED
+
+// Returns the sum of n pixels. The sum of 64 12-bit pixels needs more than 16
+// bits, so the pixels are accumulated on 32 bits.
+static INLINE int dc_sum(const uint16_t *ref, int n) {
+  __m128i sum;
+  if (n == 4) {
+    sum = _mm_madd_epi16(xx_loadl_64(ref), _mm_set1_epi16(1));
+  } else if (n == 8) {
+    sum = _mm_madd_epi16(xx_loadu_128(ref), _mm_set1_epi16(1));
+  } else {
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i sum_256 = _mm256_madd_epi16(yy_loadu_256(ref), one);
+    for (int i = 16; i < n; i += 16) {
+      sum_256 = _mm256_add_epi32(sum_256,
+                                 _mm256_madd_epi16(yy_loadu_256(ref + i), one));
+    }
+    sum = _mm_add_epi32(_mm256_castsi256_si128(sum_256),
+                        _mm256_extracti128_si256(sum_256, 1));
+  }
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+  sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+  return _mm_cvtsi128_si32(sum);
+}
+
+static INLINE void dc_store(uint16_t *dst, ptrdiff_t stride, int bw, int bh,
+                            int dc) {
+  const __m256i row = _mm256_set1_epi16(dc);
+  for (int r = 0; r < bh; ++r, dst += stride) {
+    for (int c = 0; c < bw; c += 16) yy_storeu_256(dst + c, row);
+  }
+}
+
+static INLINE void highbd_dc_predictor(uint16_t *dst, ptrdiff_t stride, int bw,
+                                       int bh, const uint16_t *above,
+                                       const uint16_t *left, int bd) {
+  const int count = bw + bh;
+  const int sum = dc_sum(above, bw) + dc_sum(left, bh);
+  (void)bd;
+  dc_store(dst, stride, bw, bh, (sum + (count >> 1)) / count);
+}
+
+static INLINE void highbd_dc_top_predictor(uint16_t *dst, ptrdiff_t stride,
+                                           int bw, int bh,
+                                           const uint16_t *above,
+                                           const uint16_t *left, int bd) {
+  (void)left;
+  (void)bd;
+  dc_store(dst, stride, bw, bh, (dc_sum(above, bw) + (bw >> 1)) / bw);
+}
+
+static INLINE void highbd_dc_left_predictor(uint16_t *dst, ptrdiff_t stride,
+                                            int bw, int bh,
+                                            const uint16_t *above,
+                                            const uint16_t *left, int bd) {
+  (void)above;
+  (void)bd;
+  dc_store(dst, stride, bw, bh, (dc_sum(left, bh) + (bh >> 1)) / bh);
+}
+
+static INLINE void highbd_dc_128_predictor(uint16_t *dst, ptrdiff_t stride,
+                                           int bw, int bh,
+                                           const uint16_t *above,
+                                           const uint16_t *left, int bd) {
+  (void)above;
+  (void)left;
+  dc_store(dst, stride, bw, bh, 1 << (bd - 1));
+}
+
+// -----------------------------------------------------------------------------
+// V_PRED
+
+static INLINE void highbd_v_predictor(uint16_t *dst, ptrdiff_t stride, int bw,
+                                      int bh, const uint16_t *above,
+                                      const uint16_t *left, int bd) {
+  __m256i row[4];
+  (void)left;
+  (void)bd;
+  for (int c = 0; c < bw; c += 16) row[c >> 4] = yy_loadu_256(above + c);
+  for (int r = 0; r < bh; ++r, dst += stride) {
+    for (int c = 0; c < bw; c += 16) yy_storeu_256(dst + c, row[c >> 4]);
+  }
+}
+
+// -----------------------------------------------------------------------------
+// PAETH_PRED
+
+// See highbd_intrapred_sse4.c for the derivation of the distances.
+static INLINE void highbd_paeth_predictor(uint16_t *dst, ptrdiff_t stride,
+                                          int bw, int bh,
+                                          const uint16_t *above,
+                                          const uint16_t *left, int bd) {
+  const __m256i tl = _mm256_set1_epi16(above[-1]);
+  (void)bd;
+
+  for (int c = 0; c < bw; c += 16) {
+    const __m256i top = yy_loadu_256(above + c);
+    const __m256i t = _mm256_sub_epi16(top, tl);
+    const __m256i p_left = _mm256_abs_epi16(t);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m256i l = _mm256_set1_epi16(left[r]);
+      const __m256i lt = _mm256_sub_epi16(l, tl);
+      const __m256i p_top = _mm256_abs_epi16(lt);
+      const __m256i p_tl = _mm256_abs_epi16(_mm256_add_epi16(t, lt));
+      const __m256i not_left =
+          _mm256_or_si256(_mm256_cmpgt_epi16(p_left, p_top),
+                          _mm256_cmpgt_epi16(p_left, p_tl));
+      const __m256i top_or_tl =
+          _mm256_blendv_epi8(top, tl, _mm256_cmpgt_epi16(p_top, p_tl));
+      yy_storeu_256(d, _mm256_blendv_epi8(l, top_or_tl, not_left));
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// SMOOTH_PRED, SMOOTH_V_PRED, SMOOTH_H_PRED
+
+// The unpacks interleave the pixels and weights within each 128-bit lane, so
+// the low and high halves hold columns 0-3, 8-11 and 4-7, 12-15 respectively.
+// _mm256_packus_epi32() also works within lanes and restores the order.
+
+static INLINE void load_col_weights(const uint8_t *weights, __m256i *lo,
+                                    __m256i *hi) {
+  const __m256i w = _mm256_cvtepu8_epi16(xx_loadu_128(weights));
+  const __m256i w_inv =
+      _mm256_sub_epi16(_mm256_set1_epi16(1 << sm_weight_log2_scale), w);
+  *lo = _mm256_unpacklo_epi16(w, w_inv);
+  *hi = _mm256_unpackhi_epi16(w, w_inv);
+}
+
+static INLINE __m256i row_weight(uint8_t w) {
+  return _mm256_set1_epi32(w | (((1 << sm_weight_log2_scale) - w) << 16));
+}
+
+static INLINE __m256i pixel_pair(uint16_t a, uint16_t b) {
+  return _mm256_set1_epi32(a | (b << 16));
+}
+
+static INLINE __m256i round_pack(__m256i lo, __m256i hi, int bits) {
+  const __m256i round = _mm256_set1_epi32(1 << (bits - 1));
+  lo = _mm256_srli_epi32(_mm256_add_epi32(lo, round), bits);
+  hi = _mm256_srli_epi32(_mm256_add_epi32(hi, round), bits);
+  return _mm256_packus_epi32(lo, hi);
+}
+
+static INLINE void highbd_smooth_predictor(uint16_t *dst, ptrdiff_t stride,
+                                           int bw, int bh,
+                                           const uint16_t *above,
+                                           const uint16_t *left, int bd) {
+  const uint8_t *const weights_w = sm_weight_arrays + bw;
+  const uint8_t *const weights_h = sm_weight_arrays + bh;
+  const __m256i below = _mm256_set1_epi16(left[bh - 1]);
+  const uint16_t right = above[bw - 1];
+  (void)bd;
+
+  for (int c = 0; c < bw; c += 16) {
+    const __m256i top = yy_loadu_256(above + c);
+    const __m256i top_lo = _mm256_unpacklo_epi16(top, below);
+    const __m256i top_hi = _mm256_unpackhi_epi16(top, below);
+    __m256i w_lo, w_hi;
+    load_col_weights(weights_w + c, &w_lo, &w_hi);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m256i wh = row_weight(weights_h[r]);
+      const __m256i lr = pixel_pair(left[r], right);
+      const __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(top_lo, wh),
+                                          _mm256_madd_epi16(w_lo, lr));
+      const __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(top_hi, wh),
+                                          _mm256_madd_epi16(w_hi, lr));
+      yy_storeu_256(d, round_pack(lo, hi, 1 + sm_weight_log2_scale));
+    }
+  }
+}
+
+static INLINE void highbd_smooth_v_predictor(uint16_t *dst, ptrdiff_t stride,
+                                             int bw, int bh,
+                                             const uint16_t *above,
+                                             const uint16_t *left, int bd) {
+  const uint8_t *const weights = sm_weight_arrays + bh;
+  const __m256i below = _mm256_set1_epi16(left[bh - 1]);
+  (void)bd;
+
+  for (int c = 0; c < bw; c += 16) {
+    const __m256i top = yy_loadu_256(above + c);
+    const __m256i top_lo = _mm256_unpacklo_epi16(top, below);
+    const __m256i top_hi = _mm256_unpackhi_epi16(top, below);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m256i w = row_weight(weights[r]);
+      yy_storeu_256(d, round_pack(_mm256_madd_epi16(top_lo, w),
+                                  _mm256_madd_epi16(top_hi, w),
+                                  sm_weight_log2_scale));
+    }
+  }
+}
+
+static INLINE void highbd_smooth_h_predictor(uint16_t *dst, ptrdiff_t stride,
+                                             int bw, int bh,
+                                             const uint16_t *above,
+                                             const uint16_t *left, int bd) {
+  const uint8_t *const weights = sm_weight_arrays + bw;
+  const uint16_t right = above[bw - 1];
+  (void)bd;
+
+  for (int c = 0; c < bw; c += 16) {
+    __m256i w_lo, w_hi;
+    load_col_weights(weights + c, &w_lo, &w_hi);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m256i lr = pixel_pair(left[r], right);
+      yy_storeu_256(d, round_pack(_mm256_madd_epi16(w_lo, lr),
+                                  _mm256_madd_epi16(w_hi, lr),
+                                  sm_weight_log2_scale));
+    }
+  }
+}
+
+#define HIGHBD_INTRA_PRED_AVX2(type, width, height)                          \
+  void aom_highbd_##type##_predictor_##width##x##height##_avx2(              \
+      uint16_t *dst, ptrdiff_t stride, const uint16_t *above,                \
+      const uint16_t *left, int bd) {                                        \
+    highbd_##type##_predictor(dst, stride, width, height, above, left, bd); \
+  }
+
+#define HIGHBD_INTRA_PRED_AVX2_ALLSIZES(type) \
+  HIGHBD_INTRA_PRED_AVX2(type, 16, 4)         \
+  HIGHBD_INTRA_PRED_AVX2(type, 16, 8)         \
+  HIGHBD_INTRA_PRED_AVX2(type, 16, 16)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 16, 32)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 16, 64)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 32, 8)         \
+  HIGHBD_INTRA_PRED_AVX2(type, 32, 16)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 32, 32)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 32, 64)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 64, 16)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 64, 32)        \
+  HIGHBD_INTRA_PRED_AVX2(type, 64, 64)
+
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(dc)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(dc_top)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(dc_left)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(dc_128)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(v)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(paeth)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(smooth)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(smooth_v)
+HIGHBD_INTRA_PRED_AVX2_ALLSIZES(smooth_h)
@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>
+
+#include "./aom_dsp_rtcd.h"
+#include "aom_dsp/intrapred_common.h"
+#include "aom_dsp/x86/synonyms.h"
+
+// All predictors work on 8 columns at a time, or on 4 columns for the 4xh
+// block sizes.
+
+static INLINE __m128i load_cols(const uint16_t *p, int bw) {
+  return bw == 4 ? xx_loadl_64(p) : xx_loadu_128(p);
+}
+
+static INLINE void store_cols(uint16_t *p, __m128i v, int bw) {
+  if (bw == 4)
+    xx_storel_64(p, v);
+  else
+    xx_storeu_128(p, v);
+}
+
+// -----------------------------------------------------------------------------
+// PAETH_PRED
+
+// The Paeth distances never exceed 2 * 4095 so they are computed on 16 bits:
+// with t = top - topleft and l = left - topleft, the distances to left, top
+// and topleft of the base top + left - topleft are |t|, |l| and |t + l|.
+static INLINE void highbd_paeth_predictor(uint16_t *dst, ptrdiff_t stride,
+                                          int bw, int bh,
+                                          const uint16_t *above,
+                                          const uint16_t *left) {
+  const __m128i tl = _mm_set1_epi16(above[-1]);
+
+  for (int c = 0; c < bw; c += 8) {
+    const __m128i top = load_cols(above + c, bw);
+    const __m128i t = _mm_sub_epi16(top, tl);
+    const __m128i p_left = _mm_abs_epi16(t);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m128i l = _mm_set1_epi16(left[r]);
+      const __m128i lt = _mm_sub_epi16(l, tl);
+      const __m128i p_top = _mm_abs_epi16(lt);
+      const __m128i p_tl = _mm_abs_epi16(_mm_add_epi16(t, lt));
+      const __m128i not_left = _mm_or_si128(_mm_cmpgt_epi16(p_left, p_top),
+                                            _mm_cmpgt_epi16(p_left, p_tl));
+      const __m128i top_or_tl =
+          _mm_blendv_epi8(top, tl, _mm_cmpgt_epi16(p_top, p_tl));
+      store_cols(d, _mm_blendv_epi8(l, top_or_tl, not_left), bw);
+    }
+  }
+}
+
+// -----------------------------------------------------------------------------
+// SMOOTH_PRED, SMOOTH_V_PRED, SMOOTH_H_PRED
+
+// The weighted sums are formed with _mm_madd_epi16() on (pixel, pixel) pairs
+// interleaved with (weight, scale - weight) pairs, which gives 32-bit sums.
+
+// Returns the (w, scale - w) pairs of 8 column weights, low and high halves.
+static INLINE void load_col_weights(const uint8_t *weights, __m128i *lo,
+                                    __m128i *hi) {
+  const __m128i w = _mm_cvtepu8_epi16(xx_loadl_64(weights));
+  const __m128i w_inv =
+      _mm_sub_epi16(_mm_set1_epi16(1 << sm_weight_log2_scale), w);
+  *lo = _mm_unpacklo_epi16(w, w_inv);
+  *hi = _mm_unpackhi_epi16(w, w_inv);
+}
+
+// Returns (w, scale - w) in every 32-bit lane.
+static INLINE __m128i row_weight(uint8_t w) {
+  return _mm_set1_epi32(w | (((1 << sm_weight_log2_scale) - w) << 16));
+}
+
+// Returns (a, b) in every 32-bit lane.
+static INLINE __m128i pixel_pair(uint16_t a, uint16_t b) {
+  return _mm_set1_epi32(a | (b << 16));
+}
+
+static INLINE __m128i round_pack(__m128i lo, __m128i hi, int bits) {
+  const __m128i round = _mm_set1_epi32(1 << (bits - 1));
+  lo = _mm_srli_epi32(_mm_add_epi32(lo, round), bits);
+  hi = _mm_srli_epi32(_mm_add_epi32(hi, round), bits);
+  return _mm_packus_epi32(lo, hi);
+}
+
+static INLINE void highbd_smooth_predictor(uint16_t *dst, ptrdiff_t stride,
+                                           int bw, int bh,
+                                           const uint16_t *above,
+                                           const uint16_t *left) {
+  const uint8_t *const weights_w = sm_weight_arrays + bw;
+  const uint8_t *const weights_h = sm_weight_arrays + bh;
+  const __m128i below = _mm_set1_epi16(left[bh - 1]);
+  const uint16_t right = above[bw - 1];
+
+  for (int c = 0; c < bw; c += 8) {
+    const __m128i top = load_cols(above + c, bw);
+    const __m128i top_lo = _mm_unpacklo_epi16(top, below);
+    const __m128i top_hi = _mm_unpackhi_epi16(top, below);
+    __m128i w_lo, w_hi;
+    load_col_weights(weights_w + c, &w_lo, &w_hi);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m128i wh = row_weight(weights_h[r]);
+      const __m128i lr = pixel_pair(left[r], right);
+      const __m128i lo = _mm_add_epi32(_mm_madd_epi16(top_lo, wh),
+                                       _mm_madd_epi16(w_lo, lr));
+      const __m128i hi = _mm_add_epi32(_mm_madd_epi16(top_hi, wh),
+                                       _mm_madd_epi16(w_hi, lr));
+      store_cols(d, round_pack(lo, hi, 1 + sm_weight_log2_scale), bw);
+    }
+  }
+}
+
+static INLINE void highbd_smooth_v_predictor(uint16_t *dst, ptrdiff_t stride,
+                                             int bw, int bh,
+                                             const uint16_t *above,
+                                             const uint16_t *left) {
+  const uint8_t *const weights = sm_weight_arrays + bh;
+  const __m128i below = _mm_set1_epi16(left[bh - 1]);
+
+  for (int c = 0; c < bw; c += 8) {
+    const __m128i top = load_cols(above + c, bw);
+    const __m128i top_lo = _mm_unpacklo_epi16(top, below);
+    const __m128i top_hi = _mm_unpackhi_epi16(top, below);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m128i w = row_weight(weights[r]);
+      store_cols(d,
+                 round_pack(_mm_madd_epi16(top_lo, w),
+                            _mm_madd_epi16(top_hi, w), sm_weight_log2_scale),
+                 bw);
+    }
+  }
+}
+
+static INLINE void highbd_smooth_h_predictor(uint16_t *dst, ptrdiff_t stride,
+                                             int bw, int bh,
+                                             const uint16_t *above,
+                                             const uint16_t *left) {
+  const uint8_t *const weights = sm_weight_arrays + bw;
+  const uint16_t right = above[bw - 1];
+
+  for (int c = 0; c < bw; c += 8) {
+    __m128i w_lo, w_hi;
+    load_col_weights(weights + c, &w_lo, &w_hi);
+    uint16_t *d = dst + c;
+
+    for (int r = 0; r < bh; ++r, d += stride) {
+      const __m128i lr = pixel_pair(left[r], right);
+      store_cols(d,
+                 round_pack(_mm_madd_epi16(w_lo, lr), _mm_madd_epi16(w_hi, lr),
+                            sm_weight_log2_scale),
+                 bw);
+    }
+  }
+}
+
+#define HIGHBD_INTRA_PRED_SSE4_1(type, width, height)                     \
+  void aom_highbd_##type##_predictor_##width##x##height##_sse4_1(         \
+      uint16_t *dst, ptrdiff_t stride, const uint16_t *above,             \
+      const uint16_t *left, int bd) {                                     \
+    (void)bd;                                                             \
+    highbd_##type##_predictor(dst, stride, width, height, above, left);   \
+  }
+
+#define HIGHBD_INTRA_PRED_SSE4_1_ALLSIZES(type) \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 4, 4)          \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 4, 8)          \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 4, 16)         \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 8, 4)          \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 8, 8)          \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 8, 16)         \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 8, 32)         \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 16, 4)         \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 16, 8)         \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 16, 16)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 16, 32)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 16, 64)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 32, 8)         \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 32, 16)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 32, 32)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 32, 64)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 64, 16)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 64, 32)        \
+  HIGHBD_INTRA_PRED_SSE4_1(type, 64, 64)
+
+HIGHBD_INTRA_PRED_SSE4_1_ALLSIZES(paeth)
+HIGHBD_INTRA_PRED_SSE4_1_ALLSIZES(smooth)
+HIGHBD_INTRA_PRED_SSE4_1_ALLSIZES(smooth_v)
+HIGHBD_INTRA_PRED_SSE4_1_ALLSIZES(smooth_h)
@@ -70,9 +70,9 @@ static INLINE void highbd_hev_mask(const __m128i *p, const __m128i *q,
   *hev = _mm_xor_si128(_mm_cmpeq_epi16(h, zero), ffff);
 }
 
-static INLINE void highbd_filter_mask(const __m128i *p, const __m128i *q,
-                                      const __m128i *l, const __m128i *bl,
-                                      __m128i *mask) {
+static INLINE void filter_mask_internal(const __m128i *p, const __m128i *q,
+                                        const __m128i *l, const __m128i *bl,
+                                        int size, __m128i *mask) {
   __m128i abs_p0q0 =
       _mm_or_si128(_mm_subs_epu16(p[0], q[0]), _mm_subs_epu16(q[0], p[0]));
   __m128i abs_p1q1 =
@@ -88,7 +88,7 @@ static INLINE void highbd_filter_mask(const __m128i *p, const __m128i *q,
   max = _mm_and_si128(max, _mm_adds_epu16(*l, one));
 
   int i;
-  for (i = 1; i < 4; ++i) {
+  for (i = 1; i < size; ++i) {
     max = _mm_max_epi16(max, _mm_or_si128(_mm_subs_epu16(p[i], p[i - 1]),
                                           _mm_subs_epu16(p[i - 1], p[i])));
     max = _mm_max_epi16(max, _mm_or_si128(_mm_subs_epu16(q[i], q[i - 1]),
@@ -98,6 +98,24 @@ static INLINE void highbd_filter_mask(const __m128i *p, const __m128i *q,
   *mask = _mm_cmpeq_epi16(max, zero);  // return ~mask
 }
 
+// Note:
+//  Access p[3-0], and q[3-0]
+static INLINE void highbd_filter_mask(const __m128i *p, const __m128i *q,
+                                      const __m128i *l, const __m128i *bl,
+                                      __m128i *mask) {
+  filter_mask_internal(p, q, l, bl, 4, mask);
+}
+
+// Note:
+//  Access p[2-0], and q[2-0]
+static INLINE void highbd_filter_mask3_chroma(const __m128i *p,
+                                              const __m128i *q,
+                                              const __m128i *l,
+                                              const __m128i *bl,
+                                              __m128i *mask) {
+  filter_mask_internal(p, q, l, bl, 3, mask);
+}
+
 static INLINE void flat_mask_internal(const __m128i *th, const __m128i *p,
                                       const __m128i *q, int bd, int start,
                                       int end, __m128i *flat) {
@@ -130,6 +148,14 @@ static INLINE void highbd_flat_mask4(const __m128i *th, const __m128i *p,
   flat_mask_internal(th, p, q, bd, 1, 4, flat);
 }
 
+// Note:
+//  Access p[2-1], p[0], and q[2-1], q[0]
+static INLINE void highbd_flat_mask3_chroma(const __m128i *th, const __m128i *p,
+                                            const __m128i *q, __m128i *flat,
+                                            int bd) {
+  flat_mask_internal(th, p, q, bd, 1, 3, flat);
+}
+
 // Note:
 //  access p[6-4], p[0], and q[6-4], q[0]
 static INLINE void highbd_flat_mask4_13(const __m128i *th, const __m128i *p,
@@ -687,6 +713,106 @@ void aom_highbd_lpf_horizontal_8_dual_sse2(
   aom_highbd_lpf_horizontal_8_sse2(s + 4, p, _blimit1, _limit1, _thresh1, bd);
 }
 
+// Filters 4 or 8 pixels of a chroma edge like aom_highbd_lpf_horizontal_6_c().
+// blimit, limit and thresh hold the thresholds of each pixel.
+static INLINE void highbd_lpf_horz_6_internal(uint16_t *s, int pitch,
+                                              const __m128i *blimit,
+                                              const __m128i *limit,
+                                              const __m128i *thresh, int bd,
+                                              PixelOutput pixel_output) {
+  __m128i p[3], q[3];
+  int i;
+  for (i = 0; i < 3; i++) {
+    if (pixel_output == FOUR_PIXELS) {
+      p[i] = _mm_loadl_epi64((__m128i *)(s - (i + 1) * pitch));
+      q[i] = _mm_loadl_epi64((__m128i *)(s + i * pitch));
+    } else {
+      p[i] = _mm_loadu_si128((__m128i *)(s - (i + 1) * pitch));
+      q[i] = _mm_loadu_si128((__m128i *)(s + i * pitch));
+    }
+  }
+
+  __m128i mask;
+  highbd_filter_mask3_chroma(p, q, limit, blimit, &mask);
+
+  __m128i flat;
+  const __m128i one = _mm_set1_epi16(1);
+  highbd_flat_mask3_chroma(&one, p, q, &flat, bd);
+  flat = _mm_and_si128(flat, mask);
+
+  __m128i ps[2], qs[2];
+  highbd_filter4(p, q, &mask, thresh, bd, ps, qs);
+
+  // 5-tap filter [1, 2, 2, 2, 1]
+  __m128i flat_p[2], flat_q[2];
+  {
+    const __m128i four = _mm_set1_epi16(4);
+    const __m128i sum_p1p0 = _mm_add_epi16(p[1], p[0]);
+    const __m128i sum_q1q0 = _mm_add_epi16(q[1], q[0]);
+    const __m128i sum_p =
+        _mm_add_epi16(_mm_add_epi16(sum_p1p0, sum_p1p0), four);
+    const __m128i sum_q =
+        _mm_add_epi16(_mm_add_epi16(sum_q1q0, sum_q1q0), four);
+    const __m128i p2x3 = _mm_add_epi16(_mm_add_epi16(p[2], p[2]), p[2]);
+    const __m128i q2x3 = _mm_add_epi16(_mm_add_epi16(q[2], q[2]), q[2]);
+
+    flat_p[1] =
+        _mm_srli_epi16(_mm_add_epi16(sum_p, _mm_add_epi16(p2x3, q[0])), 3);
+    flat_p[0] = _mm_srli_epi16(
+        _mm_add_epi16(sum_p, _mm_add_epi16(_mm_add_epi16(p[2], q[1]),
+                                           _mm_add_epi16(q[0], q[0]))),
+        3);
+    flat_q[0] = _mm_srli_epi16(
+        _mm_add_epi16(sum_q, _mm_add_epi16(_mm_add_epi16(q[2], p[1]),
+                                           _mm_add_epi16(p[0], p[0]))),
+        3);
+    flat_q[1] =
+        _mm_srli_epi16(_mm_add_epi16(sum_q, _mm_add_epi16(q2x3, p[0])), 3);
+  }
+
+  // highbd_filter6: p2 and q2 are left unchanged.
+  for (i = 1; i >= 0; i--) {
+    p[i] = _mm_or_si128(_mm_andnot_si128(flat, ps[i]),
+                        _mm_and_si128(flat, flat_p[i]));
+    q[i] = _mm_or_si128(_mm_andnot_si128(flat, qs[i]),
+                        _mm_and_si128(flat, flat_q[i]));
+    if (pixel_output == FOUR_PIXELS) {
+      _mm_storel_epi64((__m128i *)(s - (i + 1) * pitch), p[i]);
+      _mm_storel_epi64((__m128i *)(s + i * pitch), q[i]);
+    } else {
+      _mm_storeu_si128((__m128i *)(s - (i + 1) * pitch), p[i]);
+      _mm_storeu_si128((__m128i *)(s + i * pitch), q[i]);
+    }
+  }
+}
+
+void aom_highbd_lpf_horizontal_6_sse2(uint16_t *s, int p,
+                                      const uint8_t *_blimit,
+                                      const uint8_t *_limit,
+                                      const uint8_t *_thresh, int bd) {
+  __m128i blimit, limit, thresh;
+  get_limit(_blimit, _limit, _thresh, bd, &blimit, &limit, &thresh);
+  highbd_lpf_horz_6_internal(s, p, &blimit, &limit, &thresh, bd, FOUR_PIXELS);
+}
+
+void aom_highbd_lpf_horizontal_6_dual_sse2(
+    uint16_t *s, int p, const uint8_t *_blimit0, const uint8_t *_limit0,
+    const uint8_t *_thresh0, const uint8_t *_blimit1, const uint8_t *_limit1,
+    const uint8_t *_thresh1, int bd) {
+  __m128i blimit0, limit0, thresh0;
+  __m128i blimit1, limit1, thresh1;
+  get_limit(_blimit0, _limit0, _thresh0, bd, &blimit0, &limit0, &thresh0);
+  get_limit(_blimit1, _limit1, _thresh1, bd, &blimit1, &limit1, &thresh1);
+
+  // Both edges are filtered at once, the first 4 pixels with the thresholds
+  // of the first edge and the last 4 with those of the second.
+  blimit0 = _mm_unpacklo_epi64(blimit0, blimit1);
+  limit0 = _mm_unpacklo_epi64(limit0, limit1);
+  thresh0 = _mm_unpacklo_epi64(thresh0, thresh1);
+  highbd_lpf_horz_6_internal(s, p, &blimit0, &limit0, &thresh0, bd,
+                             EIGHT_PIXELS);
+}
+
 void aom_highbd_lpf_horizontal_4_sse2(uint16_t *s, int p,
                                       const uint8_t *_blimit,
                                       const uint8_t *_limit,
@@ -905,6 +1031,52 @@ void aom_highbd_lpf_vertical_4_dual_sse2(
   highbd_transpose(src, 16, dst, p, 2);
 }
 
+void aom_highbd_lpf_vertical_6_sse2(uint16_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit, const uint8_t *thresh,
+                                    int bd) {
+  DECLARE_ALIGNED(16, uint16_t, t_dst[8 * 8]);
+  uint16_t *src[1];
+  uint16_t *dst[1];
+
+  // Transpose 8x8
+  src[0] = s - 4;
+  dst[0] = t_dst;
+
+  highbd_transpose(src, p, dst, 8, 1);
+
+  // Loop filtering
+  aom_highbd_lpf_horizontal_6_sse2(t_dst + 4 * 8, 8, blimit, limit, thresh, bd);
+
+  src[0] = t_dst;
+  dst[0] = s - 4;
+
+  // Transpose back
+  highbd_transpose(src, 8, dst, p, 1);
+}
+
+void aom_highbd_lpf_vertical_6_dual_sse2(
+    uint16_t *s, int p, const uint8_t *blimit0, const uint8_t *limit0,
+    const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1,
+    const uint8_t *thresh1, int bd) {
+  DECLARE_ALIGNED(16, uint16_t, t_dst[16 * 8]);
+  uint16_t *src[2];
+  uint16_t *dst[2];
+
+  // Transpose 8x16
+  highbd_transpose8x16(s - 4, s - 4 + p * 8, p, t_dst, 16);
+
+  // Loop filtering
+  aom_highbd_lpf_horizontal_6_dual_sse2(t_dst + 4 * 16, 16, blimit0, limit0,
+                                        thresh0, blimit1, limit1, thresh1, bd);
+  src[0] = t_dst;
+  src[1] = t_dst + 8;
+  dst[0] = s - 4;
+  dst[1] = s - 4 + p * 8;
+
+  // Transpose back
+  highbd_transpose(src, 16, dst, p, 2);
+}
+
 void aom_highbd_lpf_vertical_8_sse2(uint16_t *s, int p, const uint8_t *blimit,
                                     const uint8_t *limit, const uint8_t *thresh,
                                     int bd) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
  *
  * This source code is subject to the terms of the BSD 2 Clause License and
  * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
@@ -9,907 +9,359 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
-#include <immintrin.h> /* AVX2 */
+#include <immintrin.h>
 
 #include "./aom_dsp_rtcd.h"
-#include "aom_ports/mem.h"
-
-void aom_lpf_horizontal_16_avx2(unsigned char *s, int p,
-                                const unsigned char *_blimit,
-                                const unsigned char *_limit,
-                                const unsigned char *_thresh) {
-  __m128i mask, hev, flat, flat2;
-  const __m128i zero = _mm_set1_epi16(0);
-  const __m128i one = _mm_set1_epi8(1);
-  __m128i q7p7, q6p6, q5p5, q4p4, q3p3, q2p2, q1p1, q0p0, p0q0, p1q1;
-  __m128i abs_p1p0;
-
-  const __m128i thresh =
-      _mm_broadcastb_epi8(_mm_cvtsi32_si128((int)_thresh[0]));
-  const __m128i limit = _mm_broadcastb_epi8(_mm_cvtsi32_si128((int)_limit[0]));
-  const __m128i blimit =
-      _mm_broadcastb_epi8(_mm_cvtsi32_si128((int)_blimit[0]));
-
-  q4p4 = _mm_loadl_epi64((__m128i *)(s - 5 * p));
-  q4p4 = _mm_castps_si128(
-      _mm_loadh_pi(_mm_castsi128_ps(q4p4), (__m64 *)(s + 4 * p)));
-  q3p3 = _mm_loadl_epi64((__m128i *)(s - 4 * p));
-  q3p3 = _mm_castps_si128(
-      _mm_loadh_pi(_mm_castsi128_ps(q3p3), (__m64 *)(s + 3 * p)));
-  q2p2 = _mm_loadl_epi64((__m128i *)(s - 3 * p));
-  q2p2 = _mm_castps_si128(
-      _mm_loadh_pi(_mm_castsi128_ps(q2p2), (__m64 *)(s + 2 * p)));
-  q1p1 = _mm_loadl_epi64((__m128i *)(s - 2 * p));
-  q1p1 = _mm_castps_si128(
-      _mm_loadh_pi(_mm_castsi128_ps(q1p1), (__m64 *)(s + 1 * p)));
-  p1q1 = _mm_shuffle_epi32(q1p1, 78);
-  q0p0 = _mm_loadl_epi64((__m128i *)(s - 1 * p));
-  q0p0 = _mm_castps_si128(
-      _mm_loadh_pi(_mm_castsi128_ps(q0p0), (__m64 *)(s - 0 * p)));
-  p0q0 = _mm_shuffle_epi32(q0p0, 78);
-
-  {
-    __m128i abs_p1q1, abs_p0q0, abs_q1q0, fe, ff, work;
-    abs_p1p0 =
-        _mm_or_si128(_mm_subs_epu8(q1p1, q0p0), _mm_subs_epu8(q0p0, q1p1));
-    abs_q1q0 = _mm_srli_si128(abs_p1p0, 8);
-    fe = _mm_set1_epi8(0xfe);
-    ff = _mm_cmpeq_epi8(abs_p1p0, abs_p1p0);
-    abs_p0q0 =
-        _mm_or_si128(_mm_subs_epu8(q0p0, p0q0), _mm_subs_epu8(p0q0, q0p0));
-    abs_p1q1 =
-        _mm_or_si128(_mm_subs_epu8(q1p1, p1q1), _mm_subs_epu8(p1q1, q1p1));
-    flat = _mm_max_epu8(abs_p1p0, abs_q1q0);
-    hev = _mm_subs_epu8(flat, thresh);
-    hev = _mm_xor_si128(_mm_cmpeq_epi8(hev, zero), ff);
-
-    abs_p0q0 = _mm_adds_epu8(abs_p0q0, abs_p0q0);
-    abs_p1q1 = _mm_srli_epi16(_mm_and_si128(abs_p1q1, fe), 1);
-    mask = _mm_subs_epu8(_mm_adds_epu8(abs_p0q0, abs_p1q1), blimit);
-    mask = _mm_xor_si128(_mm_cmpeq_epi8(mask, zero), ff);
-    // mask |= (abs(p0 - q0) * 2 + abs(p1 - q1) / 2  > blimit) * -1;
-    mask = _mm_max_epu8(abs_p1p0, mask);
-    // mask |= (abs(p1 - p0) > limit) * -1;
-    // mask |= (abs(q1 - q0) > limit) * -1;
-
-    work = _mm_max_epu8(
-        _mm_or_si128(_mm_subs_epu8(q2p2, q1p1), _mm_subs_epu8(q1p1, q2p2)),
-        _mm_or_si128(_mm_subs_epu8(q3p3, q2p2), _mm_subs_epu8(q2p2, q3p3)));
-    mask = _mm_max_epu8(work, mask);
-    mask = _mm_max_epu8(mask, _mm_srli_si128(mask, 8));
-    mask = _mm_subs_epu8(mask, limit);
-    mask = _mm_cmpeq_epi8(mask, zero);
-  }
-
-  // lp filter
-  {
-    const __m128i t4 = _mm_set1_epi8(4);
-    const __m128i t3 = _mm_set1_epi8(3);
-    const __m128i t80 = _mm_set1_epi8(0x80);
-    const __m128i t1 = _mm_set1_epi16(0x1);
-    __m128i qs1ps1 = _mm_xor_si128(q1p1, t80);
-    __m128i qs0ps0 = _mm_xor_si128(q0p0, t80);
-    __m128i qs0 = _mm_xor_si128(p0q0, t80);
-    __m128i qs1 = _mm_xor_si128(p1q1, t80);
-    __m128i filt;
-    __m128i work_a;
-    __m128i filter1, filter2;
-    __m128i flat2_q6p6, flat2_q5p5, flat2_q4p4, flat2_q3p3, flat2_q2p2;
-    __m128i flat2_q1p1, flat2_q0p0, flat_q2p2, flat_q1p1, flat_q0p0;
-
-    filt = _mm_and_si128(_mm_subs_epi8(qs1ps1, qs1), hev);
-    work_a = _mm_subs_epi8(qs0, qs0ps0);
-    filt = _mm_adds_epi8(filt, work_a);
-    filt = _mm_adds_epi8(filt, work_a);
-    filt = _mm_adds_epi8(filt, work_a);
-    /* (aom_filter + 3 * (qs0 - ps0)) & mask */
-    filt = _mm_and_si128(filt, mask);
-
-    filter1 = _mm_adds_epi8(filt, t4);
-    filter2 = _mm_adds_epi8(filt, t3);
-
-    filter1 = _mm_unpacklo_epi8(zero, filter1);
-    filter1 = _mm_srai_epi16(filter1, 0xB);
-    filter2 = _mm_unpacklo_epi8(zero, filter2);
-    filter2 = _mm_srai_epi16(filter2, 0xB);
-
-    /* Filter1 >> 3 */
-    filt = _mm_packs_epi16(filter2, _mm_subs_epi16(zero, filter1));
-    qs0ps0 = _mm_xor_si128(_mm_adds_epi8(qs0ps0, filt), t80);
-
-    /* filt >> 1 */
-    filt = _mm_adds_epi16(filter1, t1);
-    filt = _mm_srai_epi16(filt, 1);
-    filt = _mm_andnot_si128(_mm_srai_epi16(_mm_unpacklo_epi8(zero, hev), 0x8),
-                            filt);
-    filt = _mm_packs_epi16(filt, _mm_subs_epi16(zero, filt));
-    qs1ps1 = _mm_xor_si128(_mm_adds_epi8(qs1ps1, filt), t80);
-    // loopfilter done
-
-    {
-      __m128i work;
-      flat = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(q2p2, q0p0), _mm_subs_epu8(q0p0, q2p2)),
-          _mm_or_si128(_mm_subs_epu8(q3p3, q0p0), _mm_subs_epu8(q0p0, q3p3)));
-      flat = _mm_max_epu8(abs_p1p0, flat);
-      flat = _mm_max_epu8(flat, _mm_srli_si128(flat, 8));
-      flat = _mm_subs_epu8(flat, one);
-      flat = _mm_cmpeq_epi8(flat, zero);
-      flat = _mm_and_si128(flat, mask);
-
-      q5p5 = _mm_loadl_epi64((__m128i *)(s - 6 * p));
-      q5p5 = _mm_castps_si128(
-          _mm_loadh_pi(_mm_castsi128_ps(q5p5), (__m64 *)(s + 5 * p)));
-
-      q6p6 = _mm_loadl_epi64((__m128i *)(s - 7 * p));
-      q6p6 = _mm_castps_si128(
-          _mm_loadh_pi(_mm_castsi128_ps(q6p6), (__m64 *)(s + 6 * p)));
-
-      flat2 = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(q4p4, q0p0), _mm_subs_epu8(q0p0, q4p4)),
-          _mm_or_si128(_mm_subs_epu8(q5p5, q0p0), _mm_subs_epu8(q0p0, q5p5)));
-
-      q7p7 = _mm_loadl_epi64((__m128i *)(s - 8 * p));
-      q7p7 = _mm_castps_si128(
-          _mm_loadh_pi(_mm_castsi128_ps(q7p7), (__m64 *)(s + 7 * p)));
-
-      work = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(q6p6, q0p0), _mm_subs_epu8(q0p0, q6p6)),
-          _mm_or_si128(_mm_subs_epu8(q7p7, q0p0), _mm_subs_epu8(q0p0, q7p7)));
-
-      flat2 = _mm_max_epu8(work, flat2);
-      flat2 = _mm_max_epu8(flat2, _mm_srli_si128(flat2, 8));
-      flat2 = _mm_subs_epu8(flat2, one);
-      flat2 = _mm_cmpeq_epi8(flat2, zero);
-      flat2 = _mm_and_si128(flat2, flat);  // flat2 & flat & mask
-    }
-
-    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-    // flat and wide flat calculations
-    {
-      const __m128i eight = _mm_set1_epi16(8);
-      const __m128i four = _mm_set1_epi16(4);
-      __m128i p7_16, p6_16, p5_16, p4_16, p3_16, p2_16, p1_16, p0_16;
-      __m128i q7_16, q6_16, q5_16, q4_16, q3_16, q2_16, q1_16, q0_16;
-      __m128i pixelFilter_p, pixelFilter_q;
-      __m128i pixetFilter_p2p1p0, pixetFilter_q2q1q0;
-      __m128i sum_p7, sum_q7, sum_p3, sum_q3, res_p, res_q;
-
-      p7_16 = _mm_unpacklo_epi8(q7p7, zero);
-      p6_16 = _mm_unpacklo_epi8(q6p6, zero);
-      p5_16 = _mm_unpacklo_epi8(q5p5, zero);
-      p4_16 = _mm_unpacklo_epi8(q4p4, zero);
-      p3_16 = _mm_unpacklo_epi8(q3p3, zero);
-      p2_16 = _mm_unpacklo_epi8(q2p2, zero);
-      p1_16 = _mm_unpacklo_epi8(q1p1, zero);
-      p0_16 = _mm_unpacklo_epi8(q0p0, zero);
-      q0_16 = _mm_unpackhi_epi8(q0p0, zero);
-      q1_16 = _mm_unpackhi_epi8(q1p1, zero);
-      q2_16 = _mm_unpackhi_epi8(q2p2, zero);
-      q3_16 = _mm_unpackhi_epi8(q3p3, zero);
-      q4_16 = _mm_unpackhi_epi8(q4p4, zero);
-      q5_16 = _mm_unpackhi_epi8(q5p5, zero);
-      q6_16 = _mm_unpackhi_epi8(q6p6, zero);
-      q7_16 = _mm_unpackhi_epi8(q7p7, zero);
-
-      pixelFilter_p = _mm_add_epi16(_mm_add_epi16(p6_16, p5_16),
-                                    _mm_add_epi16(p4_16, p3_16));
-      pixelFilter_q = _mm_add_epi16(_mm_add_epi16(q6_16, q5_16),
-                                    _mm_add_epi16(q4_16, q3_16));
-
-      pixetFilter_p2p1p0 = _mm_add_epi16(p0_16, _mm_add_epi16(p2_16, p1_16));
-      pixelFilter_p = _mm_add_epi16(pixelFilter_p, pixetFilter_p2p1p0);
-
-      pixetFilter_q2q1q0 = _mm_add_epi16(q0_16, _mm_add_epi16(q2_16, q1_16));
-      pixelFilter_q = _mm_add_epi16(pixelFilter_q, pixetFilter_q2q1q0);
-      pixelFilter_p =
-          _mm_add_epi16(eight, _mm_add_epi16(pixelFilter_p, pixelFilter_q));
-      pixetFilter_p2p1p0 = _mm_add_epi16(
-          four, _mm_add_epi16(pixetFilter_p2p1p0, pixetFilter_q2q1q0));
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(p7_16, p0_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(q7_16, q0_16)), 4);
-      flat2_q0p0 = _mm_packus_epi16(res_p, res_q);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixetFilter_p2p1p0, _mm_add_epi16(p3_16, p0_16)), 3);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixetFilter_p2p1p0, _mm_add_epi16(q3_16, q0_16)), 3);
-
-      flat_q0p0 = _mm_packus_epi16(res_p, res_q);
-
-      sum_p7 = _mm_add_epi16(p7_16, p7_16);
-      sum_q7 = _mm_add_epi16(q7_16, q7_16);
-      sum_p3 = _mm_add_epi16(p3_16, p3_16);
-      sum_q3 = _mm_add_epi16(q3_16, q3_16);
-
-      pixelFilter_q = _mm_sub_epi16(pixelFilter_p, p6_16);
-      pixelFilter_p = _mm_sub_epi16(pixelFilter_p, q6_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(sum_p7, p1_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_q, _mm_add_epi16(sum_q7, q1_16)), 4);
-      flat2_q1p1 = _mm_packus_epi16(res_p, res_q);
-
-      pixetFilter_q2q1q0 = _mm_sub_epi16(pixetFilter_p2p1p0, p2_16);
-      pixetFilter_p2p1p0 = _mm_sub_epi16(pixetFilter_p2p1p0, q2_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixetFilter_p2p1p0, _mm_add_epi16(sum_p3, p1_16)), 3);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixetFilter_q2q1q0, _mm_add_epi16(sum_q3, q1_16)), 3);
-      flat_q1p1 = _mm_packus_epi16(res_p, res_q);
-
-      sum_p7 = _mm_add_epi16(sum_p7, p7_16);
-      sum_q7 = _mm_add_epi16(sum_q7, q7_16);
-      sum_p3 = _mm_add_epi16(sum_p3, p3_16);
-      sum_q3 = _mm_add_epi16(sum_q3, q3_16);
-
-      pixelFilter_p = _mm_sub_epi16(pixelFilter_p, q5_16);
-      pixelFilter_q = _mm_sub_epi16(pixelFilter_q, p5_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(sum_p7, p2_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_q, _mm_add_epi16(sum_q7, q2_16)), 4);
-      flat2_q2p2 = _mm_packus_epi16(res_p, res_q);
-
-      pixetFilter_p2p1p0 = _mm_sub_epi16(pixetFilter_p2p1p0, q1_16);
-      pixetFilter_q2q1q0 = _mm_sub_epi16(pixetFilter_q2q1q0, p1_16);
-
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixetFilter_p2p1p0, _mm_add_epi16(sum_p3, p2_16)), 3);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixetFilter_q2q1q0, _mm_add_epi16(sum_q3, q2_16)), 3);
-      flat_q2p2 = _mm_packus_epi16(res_p, res_q);
-
-      sum_p7 = _mm_add_epi16(sum_p7, p7_16);
-      sum_q7 = _mm_add_epi16(sum_q7, q7_16);
-      pixelFilter_p = _mm_sub_epi16(pixelFilter_p, q4_16);
-      pixelFilter_q = _mm_sub_epi16(pixelFilter_q, p4_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(sum_p7, p3_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_q, _mm_add_epi16(sum_q7, q3_16)), 4);
-      flat2_q3p3 = _mm_packus_epi16(res_p, res_q);
-
-      sum_p7 = _mm_add_epi16(sum_p7, p7_16);
-      sum_q7 = _mm_add_epi16(sum_q7, q7_16);
-      pixelFilter_p = _mm_sub_epi16(pixelFilter_p, q3_16);
-      pixelFilter_q = _mm_sub_epi16(pixelFilter_q, p3_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(sum_p7, p4_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_q, _mm_add_epi16(sum_q7, q4_16)), 4);
-      flat2_q4p4 = _mm_packus_epi16(res_p, res_q);
-
-      sum_p7 = _mm_add_epi16(sum_p7, p7_16);
-      sum_q7 = _mm_add_epi16(sum_q7, q7_16);
-      pixelFilter_p = _mm_sub_epi16(pixelFilter_p, q2_16);
-      pixelFilter_q = _mm_sub_epi16(pixelFilter_q, p2_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(sum_p7, p5_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_q, _mm_add_epi16(sum_q7, q5_16)), 4);
-      flat2_q5p5 = _mm_packus_epi16(res_p, res_q);
-
-      sum_p7 = _mm_add_epi16(sum_p7, p7_16);
-      sum_q7 = _mm_add_epi16(sum_q7, q7_16);
-      pixelFilter_p = _mm_sub_epi16(pixelFilter_p, q1_16);
-      pixelFilter_q = _mm_sub_epi16(pixelFilter_q, p1_16);
-      res_p = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_p, _mm_add_epi16(sum_p7, p6_16)), 4);
-      res_q = _mm_srli_epi16(
-          _mm_add_epi16(pixelFilter_q, _mm_add_epi16(sum_q7, q6_16)), 4);
-      flat2_q6p6 = _mm_packus_epi16(res_p, res_q);
-    }
-    // wide flat
-    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-
-    flat = _mm_shuffle_epi32(flat, 68);
-    flat2 = _mm_shuffle_epi32(flat2, 68);
-
-    q2p2 = _mm_andnot_si128(flat, q2p2);
-    flat_q2p2 = _mm_and_si128(flat, flat_q2p2);
-    q2p2 = _mm_or_si128(q2p2, flat_q2p2);
-
-    qs1ps1 = _mm_andnot_si128(flat, qs1ps1);
-    flat_q1p1 = _mm_and_si128(flat, flat_q1p1);
-    q1p1 = _mm_or_si128(qs1ps1, flat_q1p1);
-
-    qs0ps0 = _mm_andnot_si128(flat, qs0ps0);
-    flat_q0p0 = _mm_and_si128(flat, flat_q0p0);
-    q0p0 = _mm_or_si128(qs0ps0, flat_q0p0);
-
-    q6p6 = _mm_andnot_si128(flat2, q6p6);
-    flat2_q6p6 = _mm_and_si128(flat2, flat2_q6p6);
-    q6p6 = _mm_or_si128(q6p6, flat2_q6p6);
-    _mm_storel_epi64((__m128i *)(s - 7 * p), q6p6);
-    _mm_storeh_pi((__m64 *)(s + 6 * p), _mm_castsi128_ps(q6p6));
-
-    q5p5 = _mm_andnot_si128(flat2, q5p5);
-    flat2_q5p5 = _mm_and_si128(flat2, flat2_q5p5);
-    q5p5 = _mm_or_si128(q5p5, flat2_q5p5);
-    _mm_storel_epi64((__m128i *)(s - 6 * p), q5p5);
-    _mm_storeh_pi((__m64 *)(s + 5 * p), _mm_castsi128_ps(q5p5));
-
-    q4p4 = _mm_andnot_si128(flat2, q4p4);
-    flat2_q4p4 = _mm_and_si128(flat2, flat2_q4p4);
-    q4p4 = _mm_or_si128(q4p4, flat2_q4p4);
-    _mm_storel_epi64((__m128i *)(s - 5 * p), q4p4);
-    _mm_storeh_pi((__m64 *)(s + 4 * p), _mm_castsi128_ps(q4p4));
-
-    q3p3 = _mm_andnot_si128(flat2, q3p3);
-    flat2_q3p3 = _mm_and_si128(flat2, flat2_q3p3);
-    q3p3 = _mm_or_si128(q3p3, flat2_q3p3);
-    _mm_storel_epi64((__m128i *)(s - 4 * p), q3p3);
-    _mm_storeh_pi((__m64 *)(s + 3 * p), _mm_castsi128_ps(q3p3));
-
-    q2p2 = _mm_andnot_si128(flat2, q2p2);
-    flat2_q2p2 = _mm_and_si128(flat2, flat2_q2p2);
-    q2p2 = _mm_or_si128(q2p2, flat2_q2p2);
-    _mm_storel_epi64((__m128i *)(s - 3 * p), q2p2);
-    _mm_storeh_pi((__m64 *)(s + 2 * p), _mm_castsi128_ps(q2p2));
-
-    q1p1 = _mm_andnot_si128(flat2, q1p1);
-    flat2_q1p1 = _mm_and_si128(flat2, flat2_q1p1);
-    q1p1 = _mm_or_si128(q1p1, flat2_q1p1);
-    _mm_storel_epi64((__m128i *)(s - 2 * p), q1p1);
-    _mm_storeh_pi((__m64 *)(s + 1 * p), _mm_castsi128_ps(q1p1));
-
-    q0p0 = _mm_andnot_si128(flat2, q0p0);
-    flat2_q0p0 = _mm_and_si128(flat2, flat2_q0p0);
-    q0p0 = _mm_or_si128(q0p0, flat2_q0p0);
-    _mm_storel_epi64((__m128i *)(s - 1 * p), q0p0);
-    _mm_storeh_pi((__m64 *)(s - 0 * p), _mm_castsi128_ps(q0p0));
-  }
-}
-
-DECLARE_ALIGNED(32, static const uint8_t, filt_loopfilter_avx2[32]) = {
-  0, 128, 1, 128, 2,  128, 3,  128, 4,  128, 5,  128, 6,  128, 7,  128,
-  8, 128, 9, 128, 10, 128, 11, 128, 12, 128, 13, 128, 14, 128, 15, 128
-};
-
-void aom_lpf_horizontal_16_dual_avx2(unsigned char *s, int p,
-                                     const unsigned char *_blimit,
-                                     const unsigned char *_limit,
-                                     const unsigned char *_thresh) {
-  __m128i mask, hev, flat, flat2;
-  const __m128i zero = _mm_set1_epi16(0);
-  const __m128i one = _mm_set1_epi8(1);
-  __m128i p7, p6, p5;
-  __m128i p4, p3, p2, p1, p0, q0, q1, q2, q3, q4;
-  __m128i q5, q6, q7;
-  __m256i p256_7, q256_7, p256_6, q256_6, p256_5, q256_5, p256_4, q256_4,
-      p256_3, q256_3, p256_2, q256_2, p256_1, q256_1, p256_0, q256_0;
-
-  const __m128i thresh =
-      _mm_broadcastb_epi8(_mm_cvtsi32_si128((int)_thresh[0]));
-  const __m128i limit = _mm_broadcastb_epi8(_mm_cvtsi32_si128((int)_limit[0]));
-  const __m128i blimit =
-      _mm_broadcastb_epi8(_mm_cvtsi32_si128((int)_blimit[0]));
-
-  p256_4 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s - 5 * p)));
-  p256_3 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s - 4 * p)));
-  p256_2 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s - 3 * p)));
-  p256_1 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s - 2 * p)));
-  p256_0 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s - 1 * p)));
-  q256_0 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s - 0 * p)));
-  q256_1 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s + 1 * p)));
-  q256_2 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s + 2 * p)));
-  q256_3 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s + 3 * p)));
-  q256_4 =
-      _mm256_castpd_si256(_mm256_broadcast_pd((__m128d const *)(s + 4 * p)));
-
-  p4 = _mm256_castsi256_si128(p256_4);
-  p3 = _mm256_castsi256_si128(p256_3);
-  p2 = _mm256_castsi256_si128(p256_2);
-  p1 = _mm256_castsi256_si128(p256_1);
-  p0 = _mm256_castsi256_si128(p256_0);
-  q0 = _mm256_castsi256_si128(q256_0);
-  q1 = _mm256_castsi256_si128(q256_1);
-  q2 = _mm256_castsi256_si128(q256_2);
-  q3 = _mm256_castsi256_si128(q256_3);
-  q4 = _mm256_castsi256_si128(q256_4);
-
-  {
-    const __m128i abs_p1p0 =
-        _mm_or_si128(_mm_subs_epu8(p1, p0), _mm_subs_epu8(p0, p1));
-    const __m128i abs_q1q0 =
-        _mm_or_si128(_mm_subs_epu8(q1, q0), _mm_subs_epu8(q0, q1));
-    const __m128i fe = _mm_set1_epi8(0xfe);
-    const __m128i ff = _mm_cmpeq_epi8(abs_p1p0, abs_p1p0);
-    __m128i abs_p0q0 =
-        _mm_or_si128(_mm_subs_epu8(p0, q0), _mm_subs_epu8(q0, p0));
-    __m128i abs_p1q1 =
-        _mm_or_si128(_mm_subs_epu8(p1, q1), _mm_subs_epu8(q1, p1));
-    __m128i work;
-    flat = _mm_max_epu8(abs_p1p0, abs_q1q0);
-    hev = _mm_subs_epu8(flat, thresh);
-    hev = _mm_xor_si128(_mm_cmpeq_epi8(hev, zero), ff);
-
-    abs_p0q0 = _mm_adds_epu8(abs_p0q0, abs_p0q0);
-    abs_p1q1 = _mm_srli_epi16(_mm_and_si128(abs_p1q1, fe), 1);
-    mask = _mm_subs_epu8(_mm_adds_epu8(abs_p0q0, abs_p1q1), blimit);
-    mask = _mm_xor_si128(_mm_cmpeq_epi8(mask, zero), ff);
-    // mask |= (abs(p0 - q0) * 2 + abs(p1 - q1) / 2  > blimit) * -1;
-    mask = _mm_max_epu8(flat, mask);
-    // mask |= (abs(p1 - p0) > limit) * -1;
-    // mask |= (abs(q1 - q0) > limit) * -1;
-    work = _mm_max_epu8(
-        _mm_or_si128(_mm_subs_epu8(p2, p1), _mm_subs_epu8(p1, p2)),
-        _mm_or_si128(_mm_subs_epu8(p3, p2), _mm_subs_epu8(p2, p3)));
-    mask = _mm_max_epu8(work, mask);
-    work = _mm_max_epu8(
-        _mm_or_si128(_mm_subs_epu8(q2, q1), _mm_subs_epu8(q1, q2)),
-        _mm_or_si128(_mm_subs_epu8(q3, q2), _mm_subs_epu8(q2, q3)));
-    mask = _mm_max_epu8(work, mask);
-    mask = _mm_subs_epu8(mask, limit);
-    mask = _mm_cmpeq_epi8(mask, zero);
-  }
-
-  // lp filter
-  {
-    const __m128i t4 = _mm_set1_epi8(4);
-    const __m128i t3 = _mm_set1_epi8(3);
-    const __m128i t80 = _mm_set1_epi8(0x80);
-    const __m128i te0 = _mm_set1_epi8(0xe0);
-    const __m128i t1f = _mm_set1_epi8(0x1f);
-    const __m128i t1 = _mm_set1_epi8(0x1);
-    const __m128i t7f = _mm_set1_epi8(0x7f);
-
-    __m128i ps1 = _mm_xor_si128(p1, t80);
-    __m128i ps0 = _mm_xor_si128(p0, t80);
-    __m128i qs0 = _mm_xor_si128(q0, t80);
-    __m128i qs1 = _mm_xor_si128(q1, t80);
-    __m128i filt;
-    __m128i work_a;
-    __m128i filter1, filter2;
-    __m128i flat2_p6, flat2_p5, flat2_p4, flat2_p3, flat2_p2, flat2_p1,
-        flat2_p0, flat2_q0, flat2_q1, flat2_q2, flat2_q3, flat2_q4, flat2_q5,
-        flat2_q6, flat_p2, flat_p1, flat_p0, flat_q0, flat_q1, flat_q2;
-
-    filt = _mm_and_si128(_mm_subs_epi8(ps1, qs1), hev);
-    work_a = _mm_subs_epi8(qs0, ps0);
-    filt = _mm_adds_epi8(filt, work_a);
-    filt = _mm_adds_epi8(filt, work_a);
-    filt = _mm_adds_epi8(filt, work_a);
-    /* (aom_filter + 3 * (qs0 - ps0)) & mask */
-    filt = _mm_and_si128(filt, mask);
-
-    filter1 = _mm_adds_epi8(filt, t4);
-    filter2 = _mm_adds_epi8(filt, t3);
-
-    /* Filter1 >> 3 */
-    work_a = _mm_cmpgt_epi8(zero, filter1);
-    filter1 = _mm_srli_epi16(filter1, 3);
-    work_a = _mm_and_si128(work_a, te0);
-    filter1 = _mm_and_si128(filter1, t1f);
-    filter1 = _mm_or_si128(filter1, work_a);
-    qs0 = _mm_xor_si128(_mm_subs_epi8(qs0, filter1), t80);
-
-    /* Filter2 >> 3 */
-    work_a = _mm_cmpgt_epi8(zero, filter2);
-    filter2 = _mm_srli_epi16(filter2, 3);
-    work_a = _mm_and_si128(work_a, te0);
-    filter2 = _mm_and_si128(filter2, t1f);
-    filter2 = _mm_or_si128(filter2, work_a);
-    ps0 = _mm_xor_si128(_mm_adds_epi8(ps0, filter2), t80);
-
-    /* filt >> 1 */
-    filt = _mm_adds_epi8(filter1, t1);
-    work_a = _mm_cmpgt_epi8(zero, filt);
-    filt = _mm_srli_epi16(filt, 1);
-    work_a = _mm_and_si128(work_a, t80);
-    filt = _mm_and_si128(filt, t7f);
-    filt = _mm_or_si128(filt, work_a);
-    filt = _mm_andnot_si128(hev, filt);
-    ps1 = _mm_xor_si128(_mm_adds_epi8(ps1, filt), t80);
-    qs1 = _mm_xor_si128(_mm_subs_epi8(qs1, filt), t80);
-    // loopfilter done
-
-    {
-      __m128i work;
-      work = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(p2, p0), _mm_subs_epu8(p0, p2)),
-          _mm_or_si128(_mm_subs_epu8(q2, q0), _mm_subs_epu8(q0, q2)));
-      flat = _mm_max_epu8(work, flat);
-      work = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(p3, p0), _mm_subs_epu8(p0, p3)),
-          _mm_or_si128(_mm_subs_epu8(q3, q0), _mm_subs_epu8(q0, q3)));
-      flat = _mm_max_epu8(work, flat);
-      work = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(p4, p0), _mm_subs_epu8(p0, p4)),
-          _mm_or_si128(_mm_subs_epu8(q4, q0), _mm_subs_epu8(q0, q4)));
-      flat = _mm_subs_epu8(flat, one);
-      flat = _mm_cmpeq_epi8(flat, zero);
-      flat = _mm_and_si128(flat, mask);
-
-      p256_5 = _mm256_castpd_si256(
-          _mm256_broadcast_pd((__m128d const *)(s - 6 * p)));
-      q256_5 = _mm256_castpd_si256(
-          _mm256_broadcast_pd((__m128d const *)(s + 5 * p)));
-      p5 = _mm256_castsi256_si128(p256_5);
-      q5 = _mm256_castsi256_si128(q256_5);
-      flat2 = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(p5, p0), _mm_subs_epu8(p0, p5)),
-          _mm_or_si128(_mm_subs_epu8(q5, q0), _mm_subs_epu8(q0, q5)));
-
-      flat2 = _mm_max_epu8(work, flat2);
-      p256_6 = _mm256_castpd_si256(
-          _mm256_broadcast_pd((__m128d const *)(s - 7 * p)));
-      q256_6 = _mm256_castpd_si256(
-          _mm256_broadcast_pd((__m128d const *)(s + 6 * p)));
-      p6 = _mm256_castsi256_si128(p256_6);
-      q6 = _mm256_castsi256_si128(q256_6);
-      work = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(p6, p0), _mm_subs_epu8(p0, p6)),
-          _mm_or_si128(_mm_subs_epu8(q6, q0), _mm_subs_epu8(q0, q6)));
-
-      flat2 = _mm_max_epu8(work, flat2);
-
-      p256_7 = _mm256_castpd_si256(
-          _mm256_broadcast_pd((__m128d const *)(s - 8 * p)));
-      q256_7 = _mm256_castpd_si256(
-          _mm256_broadcast_pd((__m128d const *)(s + 7 * p)));
-      p7 = _mm256_castsi256_si128(p256_7);
-      q7 = _mm256_castsi256_si128(q256_7);
-      work = _mm_max_epu8(
-          _mm_or_si128(_mm_subs_epu8(p7, p0), _mm_subs_epu8(p0, p7)),
-          _mm_or_si128(_mm_subs_epu8(q7, q0), _mm_subs_epu8(q0, q7)));
-
-      flat2 = _mm_max_epu8(work, flat2);
-      flat2 = _mm_subs_epu8(flat2, one);
-      flat2 = _mm_cmpeq_epi8(flat2, zero);
-      flat2 = _mm_and_si128(flat2, flat);  // flat2 & flat & mask
-    }
-
-    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-    // flat and wide flat calculations
-    {
-      const __m256i eight = _mm256_set1_epi16(8);
-      const __m256i four = _mm256_set1_epi16(4);
-      __m256i pixelFilter_p, pixelFilter_q, pixetFilter_p2p1p0,
-          pixetFilter_q2q1q0, sum_p7, sum_q7, sum_p3, sum_q3, res_p, res_q;
-
-      const __m256i filter =
-          _mm256_load_si256((__m256i const *)filt_loopfilter_avx2);
-      p256_7 = _mm256_shuffle_epi8(p256_7, filter);
-      p256_6 = _mm256_shuffle_epi8(p256_6, filter);
-      p256_5 = _mm256_shuffle_epi8(p256_5, filter);
-      p256_4 = _mm256_shuffle_epi8(p256_4, filter);
-      p256_3 = _mm256_shuffle_epi8(p256_3, filter);
-      p256_2 = _mm256_shuffle_epi8(p256_2, filter);
-      p256_1 = _mm256_shuffle_epi8(p256_1, filter);
-      p256_0 = _mm256_shuffle_epi8(p256_0, filter);
-      q256_0 = _mm256_shuffle_epi8(q256_0, filter);
-      q256_1 = _mm256_shuffle_epi8(q256_1, filter);
-      q256_2 = _mm256_shuffle_epi8(q256_2, filter);
-      q256_3 = _mm256_shuffle_epi8(q256_3, filter);
-      q256_4 = _mm256_shuffle_epi8(q256_4, filter);
-      q256_5 = _mm256_shuffle_epi8(q256_5, filter);
-      q256_6 = _mm256_shuffle_epi8(q256_6, filter);
-      q256_7 = _mm256_shuffle_epi8(q256_7, filter);
-
-      pixelFilter_p = _mm256_add_epi16(_mm256_add_epi16(p256_6, p256_5),
-                                       _mm256_add_epi16(p256_4, p256_3));
-      pixelFilter_q = _mm256_add_epi16(_mm256_add_epi16(q256_6, q256_5),
-                                       _mm256_add_epi16(q256_4, q256_3));
-
-      pixetFilter_p2p1p0 =
-          _mm256_add_epi16(p256_0, _mm256_add_epi16(p256_2, p256_1));
-      pixelFilter_p = _mm256_add_epi16(pixelFilter_p, pixetFilter_p2p1p0);
-
-      pixetFilter_q2q1q0 =
-          _mm256_add_epi16(q256_0, _mm256_add_epi16(q256_2, q256_1));
-      pixelFilter_q = _mm256_add_epi16(pixelFilter_q, pixetFilter_q2q1q0);
-
-      pixelFilter_p = _mm256_add_epi16(
-          eight, _mm256_add_epi16(pixelFilter_p, pixelFilter_q));
-
-      pixetFilter_p2p1p0 = _mm256_add_epi16(
-          four, _mm256_add_epi16(pixetFilter_p2p1p0, pixetFilter_q2q1q0));
-
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(p256_7, p256_0)), 4);
-
-      flat2_p0 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(q256_7, q256_0)), 4);
-
-      flat2_q0 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      res_p =
-          _mm256_srli_epi16(_mm256_add_epi16(pixetFilter_p2p1p0,
-                                             _mm256_add_epi16(p256_3, p256_0)),
-                            3);
-
-      flat_p0 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q =
-          _mm256_srli_epi16(_mm256_add_epi16(pixetFilter_p2p1p0,
-                                             _mm256_add_epi16(q256_3, q256_0)),
-                            3);
-
-      flat_q0 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      sum_p7 = _mm256_add_epi16(p256_7, p256_7);
-
-      sum_q7 = _mm256_add_epi16(q256_7, q256_7);
-
-      sum_p3 = _mm256_add_epi16(p256_3, p256_3);
-
-      sum_q3 = _mm256_add_epi16(q256_3, q256_3);
-
-      pixelFilter_q = _mm256_sub_epi16(pixelFilter_p, p256_6);
-
-      pixelFilter_p = _mm256_sub_epi16(pixelFilter_p, q256_6);
-
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(sum_p7, p256_1)), 4);
-
-      flat2_p1 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_q, _mm256_add_epi16(sum_q7, q256_1)), 4);
-
-      flat2_q1 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      pixetFilter_q2q1q0 = _mm256_sub_epi16(pixetFilter_p2p1p0, p256_2);
-
-      pixetFilter_p2p1p0 = _mm256_sub_epi16(pixetFilter_p2p1p0, q256_2);
-
-      res_p =
-          _mm256_srli_epi16(_mm256_add_epi16(pixetFilter_p2p1p0,
-                                             _mm256_add_epi16(sum_p3, p256_1)),
-                            3);
-
-      flat_p1 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q =
-          _mm256_srli_epi16(_mm256_add_epi16(pixetFilter_q2q1q0,
-                                             _mm256_add_epi16(sum_q3, q256_1)),
-                            3);
-
-      flat_q1 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      sum_p7 = _mm256_add_epi16(sum_p7, p256_7);
-
-      sum_q7 = _mm256_add_epi16(sum_q7, q256_7);
-
-      sum_p3 = _mm256_add_epi16(sum_p3, p256_3);
-
-      sum_q3 = _mm256_add_epi16(sum_q3, q256_3);
-
-      pixelFilter_p = _mm256_sub_epi16(pixelFilter_p, q256_5);
-
-      pixelFilter_q = _mm256_sub_epi16(pixelFilter_q, p256_5);
-
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(sum_p7, p256_2)), 4);
-
-      flat2_p2 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_q, _mm256_add_epi16(sum_q7, q256_2)), 4);
-
-      flat2_q2 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      pixetFilter_p2p1p0 = _mm256_sub_epi16(pixetFilter_p2p1p0, q256_1);
-
-      pixetFilter_q2q1q0 = _mm256_sub_epi16(pixetFilter_q2q1q0, p256_1);
-
-      res_p =
-          _mm256_srli_epi16(_mm256_add_epi16(pixetFilter_p2p1p0,
-                                             _mm256_add_epi16(sum_p3, p256_2)),
-                            3);
-
-      flat_p2 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q =
-          _mm256_srli_epi16(_mm256_add_epi16(pixetFilter_q2q1q0,
-                                             _mm256_add_epi16(sum_q3, q256_2)),
-                            3);
-
-      flat_q2 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      sum_p7 = _mm256_add_epi16(sum_p7, p256_7);
-
-      sum_q7 = _mm256_add_epi16(sum_q7, q256_7);
-
-      pixelFilter_p = _mm256_sub_epi16(pixelFilter_p, q256_4);
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_dsp/x86/transpose_sse2.h"
 
-      pixelFilter_q = _mm256_sub_epi16(pixelFilter_q, p256_4);
+// The quad filters process four adjacent 4-pixel edge segments sharing the
+// same filter level, i.e. 16 pixels along the edge, on 16-bit lanes. In the
+// filter functions c points to the q0 line, c[-1] is p0, c[-2] is p1, etc.
 
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(sum_p7, p256_3)), 4);
-
-      flat2_p3 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_q, _mm256_add_epi16(sum_q7, q256_3)), 4);
-
-      flat2_q3 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      sum_p7 = _mm256_add_epi16(sum_p7, p256_7);
-
-      sum_q7 = _mm256_add_epi16(sum_q7, q256_7);
-
-      pixelFilter_p = _mm256_sub_epi16(pixelFilter_p, q256_3);
-
-      pixelFilter_q = _mm256_sub_epi16(pixelFilter_q, p256_3);
-
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(sum_p7, p256_4)), 4);
-
-      flat2_p4 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
-
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_q, _mm256_add_epi16(sum_q7, q256_4)), 4);
-
-      flat2_q4 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-
-      sum_p7 = _mm256_add_epi16(sum_p7, p256_7);
-
-      sum_q7 = _mm256_add_epi16(sum_q7, q256_7);
-
-      pixelFilter_p = _mm256_sub_epi16(pixelFilter_p, q256_2);
-
-      pixelFilter_q = _mm256_sub_epi16(pixelFilter_q, p256_2);
-
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(sum_p7, p256_5)), 4);
+static INLINE __m256i abs_diff(__m256i a, __m256i b) {
+  return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
 
-      flat2_p5 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
+// Returns all ones where max_diff <= limit and
+// |p0 - q0| * 2 + |p1 - q1| / 2 <= blimit.
+static INLINE __m256i filter_mask(const __m256i *c, __m256i max_diff,
+                                  const uint8_t *blimit,
+                                  const uint8_t *limit) {
+  const __m256i edge = _mm256_add_epi16(
+      _mm256_slli_epi16(abs_diff(c[-1], c[0]), 1),
+      _mm256_srli_epi16(abs_diff(c[-2], c[1]), 1));
+  return _mm256_and_si256(
+      _mm256_cmpgt_epi16(_mm256_set1_epi16(*limit + 1), max_diff),
+      _mm256_cmpgt_epi16(_mm256_set1_epi16(*blimit + 1), edge));
+}
 
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_q, _mm256_add_epi16(sum_q7, q256_5)), 4);
+// Returns all ones where max_diff <= 1.
+static INLINE __m256i flat_mask(__m256i max_diff) {
+  return _mm256_cmpgt_epi16(_mm256_set1_epi16(2), max_diff);
+}
 
-      flat2_q5 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
+static INLINE __m256i signed_char_clamp(__m256i v) {
+  return _mm256_min_epi16(_mm256_max_epi16(v, _mm256_set1_epi16(-128)),
+                          _mm256_set1_epi16(127));
+}
 
-      sum_p7 = _mm256_add_epi16(sum_p7, p256_7);
+// Applies the 4-tap filter to p1, p0, q0 and q1 in place. The pixels are
+// offset by -128 so that the clamps match the int8_t arithmetic of the C code.
+static INLINE void filter4(__m256i *c, __m256i mask, __m256i hev) {
+  const __m256i c128 = _mm256_set1_epi16(128);
+  const __m256i ps1 = _mm256_sub_epi16(c[-2], c128);
+  const __m256i ps0 = _mm256_sub_epi16(c[-1], c128);
+  const __m256i qs0 = _mm256_sub_epi16(c[0], c128);
+  const __m256i qs1 = _mm256_sub_epi16(c[1], c128);
+  const __m256i diff = _mm256_sub_epi16(qs0, ps0);
+  __m256i filter, filter1, filter2;
+
+  filter = _mm256_and_si256(signed_char_clamp(_mm256_sub_epi16(ps1, qs1)), hev);
+  filter = _mm256_add_epi16(filter, _mm256_add_epi16(diff, diff));
+  filter = _mm256_and_si256(signed_char_clamp(_mm256_add_epi16(filter, diff)),
+                            mask);
+
+  filter1 = _mm256_srai_epi16(
+      signed_char_clamp(_mm256_add_epi16(filter, _mm256_set1_epi16(4))), 3);
+  filter2 = _mm256_srai_epi16(
+      signed_char_clamp(_mm256_add_epi16(filter, _mm256_set1_epi16(3))), 3);
+  c[0] = _mm256_add_epi16(signed_char_clamp(_mm256_sub_epi16(qs0, filter1)),
+                          c128);
+  c[-1] = _mm256_add_epi16(signed_char_clamp(_mm256_add_epi16(ps0, filter2)),
+                           c128);
+
+  filter = _mm256_andnot_si256(
+      hev, _mm256_srai_epi16(_mm256_add_epi16(filter1, _mm256_set1_epi16(1)),
+                             1));
+  c[1] = _mm256_add_epi16(signed_char_clamp(_mm256_sub_epi16(qs1, filter)),
+                          c128);
+  c[-2] = _mm256_add_epi16(signed_char_clamp(_mm256_add_epi16(ps1, filter)),
+                           c128);
+}
 
-      sum_q7 = _mm256_add_epi16(sum_q7, q256_7);
+// The flat filters keep a running sum of the taps, with the rounding offset
+// included: each output removes two taps and adds two.
+static INLINE __m256i update_sum(__m256i sum, __m256i out0, __m256i out1,
+                                 __m256i in0, __m256i in1) {
+  return _mm256_add_epi16(
+      sum, _mm256_sub_epi16(_mm256_add_epi16(in0, in1),
+                            _mm256_add_epi16(out0, out1)));
+}
 
-      pixelFilter_p = _mm256_sub_epi16(pixelFilter_p, q256_1);
+// Computes the 5-tap [1, 2, 2, 2, 1] outputs op1, op0, oq0 and oq1.
+static INLINE void filter6_flat(const __m256i *c, __m256i *out) {
+  const __m256i p2 = c[-3], p1 = c[-2], p0 = c[-1];
+  const __m256i q0 = c[0], q1 = c[1], q2 = c[2];
+  __m256i sum = _mm256_add_epi16(
+      _mm256_add_epi16(_mm256_add_epi16(p2, p2), _mm256_add_epi16(p2, q0)),
+      _mm256_add_epi16(_mm256_slli_epi16(_mm256_add_epi16(p1, p0), 1),
+                       _mm256_set1_epi16(4)));
+  out[0] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p2, p2, q0, q1);
+  out[1] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p2, p1, q1, q2);
+  out[2] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p1, p0, q2, q2);
+  out[3] = _mm256_srli_epi16(sum, 3);
+}
 
-      pixelFilter_q = _mm256_sub_epi16(pixelFilter_q, p256_1);
+// Computes the 7-tap [1, 1, 1, 2, 1, 1, 1] outputs op2 to oq2.
+static INLINE void filter8_flat(const __m256i *c, __m256i *out) {
+  const __m256i p3 = c[-4], p2 = c[-3], p1 = c[-2], p0 = c[-1];
+  const __m256i q0 = c[0], q1 = c[1], q2 = c[2], q3 = c[3];
+  __m256i sum = _mm256_add_epi16(
+      _mm256_add_epi16(_mm256_add_epi16(p3, p3), _mm256_add_epi16(p3, p2)),
+      _mm256_add_epi16(_mm256_add_epi16(p2, p1),
+                       _mm256_add_epi16(_mm256_add_epi16(p0, q0),
+                                        _mm256_set1_epi16(4))));
+  out[0] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p3, p2, p1, q1);
+  out[1] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p3, p1, p0, q2);
+  out[2] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p3, p0, q0, q3);
+  out[3] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p2, q0, q1, q3);
+  out[4] = _mm256_srli_epi16(sum, 3);
+  sum = update_sum(sum, p1, q1, q2, q3);
+  out[5] = _mm256_srli_epi16(sum, 3);
+}
 
-      res_p = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_p, _mm256_add_epi16(sum_p7, p256_6)), 4);
+// Computes the 13-tap [1, 1, 1, 1, 1, 2, 2, 2, 1, 1, 1, 1, 1] outputs op5 to
+// oq5.
+static INLINE void filter14_flat(const __m256i *c, __m256i *out) {
+  const __m256i p6 = c[-7], p5 = c[-6], p4 = c[-5], p3 = c[-4], p2 = c[-3],
+                p1 = c[-2], p0 = c[-1];
+  const __m256i q0 = c[0], q1 = c[1], q2 = c[2], q3 = c[3], q4 = c[4],
+                q5 = c[5], q6 = c[6];
+  __m256i sum = _mm256_add_epi16(
+      _mm256_sub_epi16(_mm256_slli_epi16(p6, 3), p6),
+      _mm256_add_epi16(_mm256_slli_epi16(_mm256_add_epi16(p5, p4), 1),
+                       _mm256_set1_epi16(8)));
+  sum = _mm256_add_epi16(
+      sum, _mm256_add_epi16(_mm256_add_epi16(p3, p2),
+                            _mm256_add_epi16(_mm256_add_epi16(p1, p0), q0)));
+  out[0] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p6, p6, p3, q1);
+  out[1] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p6, p5, p2, q2);
+  out[2] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p6, p4, p1, q3);
+  out[3] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p6, p3, p0, q4);
+  out[4] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p6, p2, q0, q5);
+  out[5] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p6, p1, q1, q6);
+  out[6] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p5, p0, q2, q6);
+  out[7] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p4, q0, q3, q6);
+  out[8] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p3, q1, q4, q6);
+  out[9] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p2, q2, q5, q6);
+  out[10] = _mm256_srli_epi16(sum, 4);
+  sum = update_sum(sum, p1, q3, q6, q6);
+  out[11] = _mm256_srli_epi16(sum, 4);
+}
 
-      flat2_p6 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_p, res_p), 168));
+static INLINE void blend(__m256i *c, const __m256i *flat_out, int n,
+                         __m256i flat) {
+  for (int i = 0; i < n; ++i)
+    c[i] = _mm256_blendv_epi8(c[i], flat_out[i], flat);
+}
 
-      res_q = _mm256_srli_epi16(
-          _mm256_add_epi16(pixelFilter_q, _mm256_add_epi16(sum_q7, q256_6)), 4);
+static INLINE void lpf4(__m256i *c, const uint8_t *blimit,
+                        const uint8_t *limit, const uint8_t *thresh) {
+  const __m256i d1 =
+      _mm256_max_epi16(abs_diff(c[-2], c[-1]), abs_diff(c[1], c[0]));
+  const __m256i hev = _mm256_cmpgt_epi16(d1, _mm256_set1_epi16(*thresh));
+  filter4(c, filter_mask(c, d1, blimit, limit), hev);
+}
 
-      flat2_q6 = _mm256_castsi256_si128(
-          _mm256_permute4x64_epi64(_mm256_packus_epi16(res_q, res_q), 168));
-    }
+static INLINE void lpf6(__m256i *c, const uint8_t *blimit,
+                        const uint8_t *limit, const uint8_t *thresh) {
+  const __m256i d1 =
+      _mm256_max_epi16(abs_diff(c[-2], c[-1]), abs_diff(c[1], c[0]));
+  const __m256i hev = _mm256_cmpgt_epi16(d1, _mm256_set1_epi16(*thresh));
+  const __m256i d2 =
+      _mm256_max_epi16(abs_diff(c[-3], c[-2]), abs_diff(c[2], c[1]));
+  const __m256i mask =
+      filter_mask(c, _mm256_max_epi16(d1, d2), blimit, limit);
+  const __m256i flat = _mm256_and_si256(
+      mask, flat_mask(_mm256_max_epi16(
+                d1, _mm256_max_epi16(abs_diff(c[-3], c[-1]),
+                                     abs_diff(c[2], c[0])))));
+  __m256i flat_out[4];
+  const int any_flat = !_mm256_testz_si256(flat, flat);
+
+  if (any_flat) filter6_flat(c, flat_out);
+  filter4(c, mask, hev);
+  if (any_flat) blend(c - 2, flat_out, 4, flat);
+}
 
-    // wide flat
-    // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Computes the filter and flat masks shared by the 8 and 14-tap filters.
+static INLINE void filter8_masks(const __m256i *c, const uint8_t *blimit,
+                                 const uint8_t *limit, const uint8_t *thresh,
+                                 __m256i *mask, __m256i *hev, __m256i *flat) {
+  const __m256i d1 =
+      _mm256_max_epi16(abs_diff(c[-2], c[-1]), abs_diff(c[1], c[0]));
+  const __m256i d2 = _mm256_max_epi16(
+      _mm256_max_epi16(abs_diff(c[-3], c[-2]), abs_diff(c[2], c[1])),
+      _mm256_max_epi16(abs_diff(c[-4], c[-3]), abs_diff(c[3], c[2])));
+  const __m256i d3 = _mm256_max_epi16(
+      _mm256_max_epi16(abs_diff(c[-3], c[-1]), abs_diff(c[2], c[0])),
+      _mm256_max_epi16(abs_diff(c[-4], c[-1]), abs_diff(c[3], c[0])));
+  *hev = _mm256_cmpgt_epi16(d1, _mm256_set1_epi16(*thresh));
+  *mask = filter_mask(c, _mm256_max_epi16(d1, d2), blimit, limit);
+  *flat = _mm256_and_si256(*mask, flat_mask(_mm256_max_epi16(d1, d3)));
+}
 
-    p2 = _mm_andnot_si128(flat, p2);
-    flat_p2 = _mm_and_si128(flat, flat_p2);
-    p2 = _mm_or_si128(flat_p2, p2);
+static INLINE void lpf8(__m256i *c, const uint8_t *blimit,
+                        const uint8_t *limit, const uint8_t *thresh) {
+  __m256i mask, hev, flat, flat_out[6];
+  filter8_masks(c, blimit, limit, thresh, &mask, &hev, &flat);
+  const int any_flat = !_mm256_testz_si256(flat, flat);
 
-    p1 = _mm_andnot_si128(flat, ps1);
-    flat_p1 = _mm_and_si128(flat, flat_p1);
-    p1 = _mm_or_si128(flat_p1, p1);
+  if (any_flat) filter8_flat(c, flat_out);
+  filter4(c, mask, hev);
+  if (any_flat) blend(c - 3, flat_out, 6, flat);
+}
 
-    p0 = _mm_andnot_si128(flat, ps0);
-    flat_p0 = _mm_and_si128(flat, flat_p0);
-    p0 = _mm_or_si128(flat_p0, p0);
+static INLINE void lpf14(__m256i *c, const uint8_t *blimit,
+                         const uint8_t *limit, const uint8_t *thresh) {
+  __m256i mask, hev, flat, flat8_out[6], flat14_out[12];
+  filter8_masks(c, blimit, limit, thresh, &mask, &hev, &flat);
+  const int any_flat = !_mm256_testz_si256(flat, flat);
+  __m256i flat2 = _mm256_setzero_si256();
+  int any_flat2 = 0;
+
+  if (any_flat) {
+    const __m256i d = _mm256_max_epi16(
+        _mm256_max_epi16(
+            _mm256_max_epi16(abs_diff(c[-5], c[-1]), abs_diff(c[4], c[0])),
+            _mm256_max_epi16(abs_diff(c[-6], c[-1]), abs_diff(c[5], c[0]))),
+        _mm256_max_epi16(abs_diff(c[-7], c[-1]), abs_diff(c[6], c[0])));
+    flat2 = _mm256_and_si256(flat, flat_mask(d));
+    any_flat2 = !_mm256_testz_si256(flat2, flat2);
+    filter8_flat(c, flat8_out);
+    if (any_flat2) filter14_flat(c, flat14_out);
+  }
+  filter4(c, mask, hev);
+  if (any_flat) blend(c - 3, flat8_out, 6, flat);
+  if (any_flat2) blend(c - 6, flat14_out, 12, flat2);
+}
 
-    q0 = _mm_andnot_si128(flat, qs0);
-    flat_q0 = _mm_and_si128(flat, flat_q0);
-    q0 = _mm_or_si128(flat_q0, q0);
+// Loads n rows of 16 pixels.
+static INLINE void load_rows(const uint8_t *s, int p, int n, __m256i *rows) {
+  for (int i = 0; i < n; ++i)
+    rows[i] = _mm256_cvtepu8_epi16(xx_loadu_128(s + i * p));
+}
 
-    q1 = _mm_andnot_si128(flat, qs1);
-    flat_q1 = _mm_and_si128(flat, flat_q1);
-    q1 = _mm_or_si128(flat_q1, q1);
+static INLINE __m128i pack_pixels(__m256i v) {
+  return _mm_packus_epi16(_mm256_castsi256_si128(v),
+                          _mm256_extracti128_si256(v, 1));
+}
 
-    q2 = _mm_andnot_si128(flat, q2);
-    flat_q2 = _mm_and_si128(flat, flat_q2);
-    q2 = _mm_or_si128(flat_q2, q2);
+static INLINE void store_rows(uint8_t *s, int p, int n, const __m256i *rows) {
+  for (int i = 0; i < n; ++i) xx_storeu_128(s + i * p, pack_pixels(rows[i]));
+}
 
-    p6 = _mm_andnot_si128(flat2, p6);
-    flat2_p6 = _mm_and_si128(flat2, flat2_p6);
-    p6 = _mm_or_si128(flat2_p6, p6);
-    _mm_storeu_si128((__m128i *)(s - 7 * p), p6);
+// Loads the n columns (n = 8 or 16) of 16 rows, transposed.
+static INLINE void load_cols(const uint8_t *s, int p, int n, __m256i *cols) {
+  for (int j = 0; j < n; j += 8) {
+    __m128i rows[16], lo[8], hi[8];
+    for (int i = 0; i < 16; ++i) rows[i] = xx_loadl_64(s + i * p + j);
+    transpose_8bit_8x8(rows, lo);
+    transpose_8bit_8x8(rows + 8, hi);
+    for (int k = 0; k < 8; ++k)
+      cols[j + k] = _mm256_cvtepu8_epi16(_mm_unpacklo_epi64(lo[k], hi[k]));
+  }
+}
 
-    p5 = _mm_andnot_si128(flat2, p5);
-    flat2_p5 = _mm_and_si128(flat2, flat2_p5);
-    p5 = _mm_or_si128(flat2_p5, p5);
-    _mm_storeu_si128((__m128i *)(s - 6 * p), p5);
+static INLINE void store_cols(uint8_t *s, int p, int n, const __m256i *cols) {
+  for (int j = 0; j < n; j += 8) {
+    __m128i packed[8], rows[16];
+    for (int k = 0; k < 8; ++k) packed[k] = pack_pixels(cols[j + k]);
+    transpose_8bit_8x8(packed, rows);
+    for (int k = 0; k < 8; ++k) packed[k] = _mm_srli_si128(packed[k], 8);
+    transpose_8bit_8x8(packed, rows + 8);
+    for (int i = 0; i < 16; ++i) xx_storel_64(s + i * p + j, rows[i]);
+  }
+}
 
-    p4 = _mm_andnot_si128(flat2, p4);
-    flat2_p4 = _mm_and_si128(flat2, flat2_p4);
-    p4 = _mm_or_si128(flat2_p4, p4);
-    _mm_storeu_si128((__m128i *)(s - 5 * p), p4);
+void aom_lpf_horizontal_4_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit,
+                                    const uint8_t *thresh) {
+  __m256i px[4];
+  load_rows(s - 2 * p, p, 4, px);
+  lpf4(px + 2, blimit, limit, thresh);
+  store_rows(s - 2 * p, p, 4, px);
+}
 
-    p3 = _mm_andnot_si128(flat2, p3);
-    flat2_p3 = _mm_and_si128(flat2, flat2_p3);
-    p3 = _mm_or_si128(flat2_p3, p3);
-    _mm_storeu_si128((__m128i *)(s - 4 * p), p3);
+void aom_lpf_horizontal_6_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit,
+                                    const uint8_t *thresh) {
+  __m256i px[6];
+  load_rows(s - 3 * p, p, 6, px);
+  lpf6(px + 3, blimit, limit, thresh);
+  store_rows(s - 2 * p, p, 4, px + 1);
+}
 
-    p2 = _mm_andnot_si128(flat2, p2);
-    flat2_p2 = _mm_and_si128(flat2, flat2_p2);
-    p2 = _mm_or_si128(flat2_p2, p2);
-    _mm_storeu_si128((__m128i *)(s - 3 * p), p2);
+void aom_lpf_horizontal_8_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit,
+                                    const uint8_t *thresh) {
+  __m256i px[8];
+  load_rows(s - 4 * p, p, 8, px);
+  lpf8(px + 4, blimit, limit, thresh);
+  store_rows(s - 3 * p, p, 6, px + 1);
+}
 
-    p1 = _mm_andnot_si128(flat2, p1);
-    flat2_p1 = _mm_and_si128(flat2, flat2_p1);
-    p1 = _mm_or_si128(flat2_p1, p1);
-    _mm_storeu_si128((__m128i *)(s - 2 * p), p1);
+void aom_lpf_horizontal_14_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                     const uint8_t *limit,
+                                     const uint8_t *thresh) {
+  __m256i px[14];
+  load_rows(s - 7 * p, p, 14, px);
+  lpf14(px + 7, blimit, limit, thresh);
+  store_rows(s - 6 * p, p, 12, px + 1);
+}
 
-    p0 = _mm_andnot_si128(flat2, p0);
-    flat2_p0 = _mm_and_si128(flat2, flat2_p0);
-    p0 = _mm_or_si128(flat2_p0, p0);
-    _mm_storeu_si128((__m128i *)(s - 1 * p), p0);
+// The vertical filters transpose the 8 (or 16 for the 14-tap filter) pixels
+// around the edge, so the unmodified outer columns are stored back as is.
+void aom_lpf_vertical_4_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                  const uint8_t *limit,
+                                  const uint8_t *thresh) {
+  __m256i px[8];
+  load_cols(s - 4, p, 8, px);
+  lpf4(px + 4, blimit, limit, thresh);
+  store_cols(s - 4, p, 8, px);
+}
 
-    q0 = _mm_andnot_si128(flat2, q0);
-    flat2_q0 = _mm_and_si128(flat2, flat2_q0);
-    q0 = _mm_or_si128(flat2_q0, q0);
-    _mm_storeu_si128((__m128i *)(s - 0 * p), q0);
+void aom_lpf_vertical_6_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                  const uint8_t *limit,
+                                  const uint8_t *thresh) {
+  __m256i px[8];
+  load_cols(s - 4, p, 8, px);
+  lpf6(px + 4, blimit, limit, thresh);
+  store_cols(s - 4, p, 8, px);
+}
 
-    q1 = _mm_andnot_si128(flat2, q1);
-    flat2_q1 = _mm_and_si128(flat2, flat2_q1);
-    q1 = _mm_or_si128(flat2_q1, q1);
-    _mm_storeu_si128((__m128i *)(s + 1 * p), q1);
+void aom_lpf_vertical_8_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                  const uint8_t *limit,
+                                  const uint8_t *thresh) {
+  __m256i px[8];
+  load_cols(s - 4, p, 8, px);
+  lpf8(px + 4, blimit, limit, thresh);
+  store_cols(s - 4, p, 8, px);
+}
 
-    q2 = _mm_andnot_si128(flat2, q2);
-    flat2_q2 = _mm_and_si128(flat2, flat2_q2);
-    q2 = _mm_or_si128(flat2_q2, q2);
-    _mm_storeu_si128((__m128i *)(s + 2 * p), q2);
-
-    q3 = _mm_andnot_si128(flat2, q3);
-    flat2_q3 = _mm_and_si128(flat2, flat2_q3);
-    q3 = _mm_or_si128(flat2_q3, q3);
-    _mm_storeu_si128((__m128i *)(s + 3 * p), q3);
-
-    q4 = _mm_andnot_si128(flat2, q4);
-    flat2_q4 = _mm_and_si128(flat2, flat2_q4);
-    q4 = _mm_or_si128(flat2_q4, q4);
-    _mm_storeu_si128((__m128i *)(s + 4 * p), q4);
-
-    q5 = _mm_andnot_si128(flat2, q5);
-    flat2_q5 = _mm_and_si128(flat2, flat2_q5);
-    q5 = _mm_or_si128(flat2_q5, q5);
-    _mm_storeu_si128((__m128i *)(s + 5 * p), q5);
-
-    q6 = _mm_andnot_si128(flat2, q6);
-    flat2_q6 = _mm_and_si128(flat2, flat2_q6);
-    q6 = _mm_or_si128(flat2_q6, q6);
-    _mm_storeu_si128((__m128i *)(s + 6 * p), q6);
-  }
-  _mm256_zeroupper();
+void aom_lpf_vertical_14_quad_avx2(uint8_t *s, int p, const uint8_t *blimit,
+                                   const uint8_t *limit,
+                                   const uint8_t *thresh) {
+  __m256i px[16];
+  load_cols(s - 8, p, 16, px);
+  lpf14(px + 8, blimit, limit, thresh);
+  store_cols(s - 8, p, 16, px);
 }
@@ -1679,3 +1679,62 @@ void aom_lpf_vertical_14_dual_sse2(unsigned char *s, int p,
   transpose8x16(t_dst, t_dst + 8 * 16, 16, s - 8, p);
   transpose8x16(t_dst + 8, t_dst + 8 + 8 * 16, 16, s - 8 + 8 * p, p);
 }
+
+// The quad filters cover four adjacent 4-pixel edge segments with the same
+// filter parameters.
+
+void aom_lpf_horizontal_4_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit,
+                                    const uint8_t *thresh) {
+  for (int i = 0; i < 4; ++i)
+    aom_lpf_horizontal_4_sse2(s + 4 * i, p, blimit, limit, thresh);
+}
+
+void aom_lpf_horizontal_6_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit,
+                                    const uint8_t *thresh) {
+  for (int i = 0; i < 4; ++i)
+    aom_lpf_horizontal_6_sse2(s + 4 * i, p, blimit, limit, thresh);
+}
+
+void aom_lpf_horizontal_8_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                    const uint8_t *limit,
+                                    const uint8_t *thresh) {
+  for (int i = 0; i < 4; ++i)
+    aom_lpf_horizontal_8_sse2(s + 4 * i, p, blimit, limit, thresh);
+}
+
+void aom_lpf_horizontal_14_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                     const uint8_t *limit,
+                                     const uint8_t *thresh) {
+  aom_lpf_horizontal_14_dual_sse2(s, p, blimit, limit, thresh);
+  aom_lpf_horizontal_14_dual_sse2(s + 8, p, blimit, limit, thresh);
+}
+
+void aom_lpf_vertical_4_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                  const uint8_t *limit,
+                                  const uint8_t *thresh) {
+  for (int i = 0; i < 4; ++i)
+    aom_lpf_vertical_4_sse2(s + 4 * i * p, p, blimit, limit, thresh);
+}
+
+void aom_lpf_vertical_6_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                  const uint8_t *limit,
+                                  const uint8_t *thresh) {
+  for (int i = 0; i < 4; ++i)
+    aom_lpf_vertical_6_sse2(s + 4 * i * p, p, blimit, limit, thresh);
+}
+
+void aom_lpf_vertical_8_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                  const uint8_t *limit,
+                                  const uint8_t *thresh) {
+  for (int i = 0; i < 4; ++i)
+    aom_lpf_vertical_8_sse2(s + 4 * i * p, p, blimit, limit, thresh);
+}
+
+void aom_lpf_vertical_14_quad_sse2(uint8_t *s, int p, const uint8_t *blimit,
+                                   const uint8_t *limit,
+                                   const uint8_t *thresh) {
+  aom_lpf_vertical_14_dual_sse2(s, p, blimit, limit, thresh);
+  aom_lpf_vertical_14_dual_sse2(s + 8 * p, p, blimit, limit, thresh);
+}
@@ -169,6 +169,44 @@ void aom_extend_frame_borders_c(YV12_BUFFER_CONFIG *ybf, const int num_planes) {
   extend_frame(ybf, ybf->border, num_planes);
 }
 
+void aom_extend_frame_borders_rows_c(YV12_BUFFER_CONFIG *ybf, int row_start,
+                                     int row_end, const int num_planes) {
+  const int ss_x = ybf->uv_width < ybf->y_width;
+  const int ss_y = ybf->uv_height < ybf->y_height;
+  const int ext_size = ybf->border;
+
+  assert(row_start >= 0 && row_start <= row_end);
+  assert(row_end <= ybf->y_crop_height);
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    const int is_uv = plane > 0;
+    const int crop_height = ybf->crop_heights[is_uv];
+    const int start = row_start >> (is_uv ? ss_y : 0);
+    // The last chroma row of an odd height frame has no luma row of its own.
+    const int end = (row_end == ybf->y_crop_height)
+                        ? crop_height
+                        : row_end >> (is_uv ? ss_y : 0);
+    if (end <= start) continue;
+    // The rows above and below the plane are copies of its first and last
+    // rows, so they can only be extended together with those.
+    const int top = (start == 0) ? ext_size >> (is_uv ? ss_y : 0) : 0;
+    const int left = ext_size >> (is_uv ? ss_x : 0);
+    const int bottom =
+        (end == crop_height) ? (ext_size >> (is_uv ? ss_y : 0)) +
+                                   ybf->heights[is_uv] - crop_height
+                             : 0;
+    const int right = left + ybf->widths[is_uv] - ybf->crop_widths[is_uv];
+    uint8_t *const buf = ybf->buffers[plane] + start * ybf->strides[is_uv];
+    if (ybf->flags & YV12_FLAG_HIGHBITDEPTH) {
+      extend_plane_high(buf, ybf->strides[is_uv], ybf->crop_widths[is_uv],
+                        end - start, top, left, bottom, right);
+    } else {
+      extend_plane(buf, ybf->strides[is_uv], ybf->crop_widths[is_uv],
+                   end - start, top, left, bottom, right);
+    }
+  }
+}
+
 void aom_extend_frame_inner_borders_c(YV12_BUFFER_CONFIG *ybf,
                                       const int num_planes) {
   const int inner_bw = (ybf->border > AOMINNERBORDERINPIXELS)
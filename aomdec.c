@@ -88,6 +88,11 @@ static const arg_def_t outputfile =
     ARG_DEF("o", "output", 1, "Output file name pattern (see below)");
 static const arg_def_t threadsarg =
     ARG_DEF("t", "threads", 1, "Max threads to use");
+static const arg_def_t lrthreadsarg =
+    ARG_DEF(NULL, "lr-threads", 1,
+            "Max threads of the loop restoration filter (0: use --threads)");
+static const arg_def_t frameparallelarg =
+    ARG_DEF(NULL, "frame-parallel", 0, "Frame parallel decode");
 static const arg_def_t verbosearg =
     ARG_DEF("v", "verbose", 0, "Show version string");
 static const arg_def_t scalearg =
@@ -117,7 +122,8 @@ static const arg_def_t *all_args[] = {
   &rawvideo,       &noblitarg,  &progressarg, &limitarg,      &skiparg,
   &postprocarg,    &summaryarg, &outputfile,  &threadsarg,    &verbosearg,
   &scalearg,       &fb_arg,     &md5arg,      &framestatsarg, &continuearg,
-  &outbitdeptharg, &tilem,      &tiler,       &tilec,         NULL
+  &outbitdeptharg, &tilem,      &tiler,       &tilec,
+  &frameparallelarg, &lrthreadsarg, NULL
 };
 
 #if CONFIG_LIBYUV
@@ -507,8 +513,10 @@ static int main_loop(int argc, const char **argv_) {
   unsigned int tile_mode = 0;
   int tile_row = -1;
   int tile_col = -1;
+  unsigned int lr_threads = 0;
   int frames_corrupted = 0;
   int dec_flags = 0;
+  int frame_parallel = 0;
   int do_scale = 0;
   aom_image_t *scaled_img = NULL;
   aom_image_t *img_shifted = NULL;
@@ -597,6 +605,8 @@ static int main_loop(int argc, const char **argv_) {
       summary = 1;
     } else if (arg_match(&arg, &threadsarg, argi)) {
       cfg.threads = arg_parse_uint(&arg);
+    } else if (arg_match(&arg, &frameparallelarg, argi)) {
+      frame_parallel = 1;
     } else if (arg_match(&arg, &verbosearg, argi)) {
       quiet = 0;
     } else if (arg_match(&arg, &scalearg, argi)) {
@@ -613,6 +623,8 @@ static int main_loop(int argc, const char **argv_) {
       tile_row = arg_parse_int(&arg);
     } else if (arg_match(&arg, &tilec, argi)) {
       tile_col = arg_parse_int(&arg);
+    } else if (arg_match(&arg, &lrthreadsarg, argi)) {
+      lr_threads = arg_parse_uint(&arg);
     } else {
       argj++;
     }
@@ -706,7 +718,8 @@ static int main_loop(int argc, const char **argv_) {
 
   if (!interface) interface = get_aom_decoder_by_index(0);
 
-  dec_flags = (postproc ? AOM_CODEC_USE_POSTPROC : 0);
+  dec_flags = (postproc ? AOM_CODEC_USE_POSTPROC : 0) |
+              (frame_parallel ? AOM_CODEC_USE_FRAME_THREADING : 0);
   if (aom_codec_dec_init(&decoder, interface->codec_interface(), &cfg,
                          dec_flags)) {
     fprintf(stderr, "Failed to initialize decoder: %s\n",
@@ -734,6 +747,12 @@ static int main_loop(int argc, const char **argv_) {
             aom_codec_error(&decoder));
     goto fail;
   }
+
+  if (aom_codec_control(&decoder, AV1_SET_LR_THREADS, lr_threads)) {
+    fprintf(stderr, "Failed to set lr_threads: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
 #endif
 
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
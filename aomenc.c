@@ -424,6 +424,14 @@ static const arg_def_t tile_cols =
 static const arg_def_t tile_rows =
     ARG_DEF(NULL, "tile-rows", 1,
             "Number of tile rows to use, log2 (set to 0 while threads > 1)");
+static const arg_def_t row_mt =
+    ARG_DEF(NULL, "row-mt", 1,
+            "Encode the superblock rows of a tile in parallel (0: off "
+            "(default), 1: on)");
+static const arg_def_t lr_threads =
+    ARG_DEF(NULL, "lr-threads", 1,
+            "Max threads of the loop restoration filter (0: use --threads "
+            "(default))");
 static const arg_def_t tile_width =
     ARG_DEF(NULL, "tile-width", 1, "Tile widths (comma separated)");
 static const arg_def_t tile_height =
@@ -623,6 +631,8 @@ static const arg_def_t *av1_args[] = { &cpu_used_av1,
                                        &single_tile_decoding,
                                        &tile_cols,
                                        &tile_rows,
+                                       &row_mt,
+                                       &lr_threads,
                                        &arnr_maxframes,
                                        &arnr_strength,
                                        &tune_metric,
@@ -678,6 +688,8 @@ static const int av1_arg_ctrl_map[] = { AOME_SET_CPUUSED,
                                         AV1E_SET_SINGLE_TILE_DECODING,
                                         AV1E_SET_TILE_COLUMNS,
                                         AV1E_SET_TILE_ROWS,
+                                        AV1E_SET_ROW_MT,
+                                        AV1E_SET_LR_THREADS,
                                         AOME_SET_ARNR_MAXFRAMES,
                                         AOME_SET_ARNR_STRENGTH,
                                         AOME_SET_TUNING,
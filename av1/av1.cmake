@@ -158,6 +158,7 @@ set(AOM_AV1_COMMON_INTRIN_SSE2
     "${AOM_ROOT}/av1/common/x86/av1_txfm_sse2.h")
 
 set(AOM_AV1_COMMON_INTRIN_SSSE3
+    "${AOM_ROOT}/av1/common/x86/av1_inv_txfm_eob.h"
     "${AOM_ROOT}/av1/common/x86/av1_inv_txfm_ssse3.h"
     "${AOM_ROOT}/av1/common/x86/av1_inv_txfm_ssse3.c")
 
@@ -179,8 +180,7 @@ set(AOM_AV1_COMMON_INTRIN_MSA
 
 set(AOM_AV1_ENCODER_ASM_SSE2
     "${AOM_ROOT}/av1/encoder/x86/dct_sse2.asm"
-    "${AOM_ROOT}/av1/encoder/x86/error_sse2.asm"
-    "${AOM_ROOT}/av1/encoder/x86/temporal_filter_apply_sse2.asm")
+    "${AOM_ROOT}/av1/encoder/x86/error_sse2.asm")
 
 set(AOM_AV1_ENCODER_INTRIN_SSE2
     "${AOM_ROOT}/av1/encoder/x86/av1_fwd_txfm_sse2.c"
@@ -196,13 +196,17 @@ set(AOM_AV1_ENCODER_INTRIN_SSE4_1
     "${AOM_ROOT}/av1/encoder/x86/av1_fwd_txfm1d_sse4.c"
     "${AOM_ROOT}/av1/encoder/x86/av1_fwd_txfm2d_sse4.c"
     "${AOM_ROOT}/av1/encoder/x86/av1_highbd_quantize_sse4.c"
-    "${AOM_ROOT}/av1/encoder/x86/highbd_fwd_txfm_sse4.c")
+    "${AOM_ROOT}/av1/encoder/x86/highbd_fwd_txfm_sse4.c"
+    "${AOM_ROOT}/av1/encoder/x86/highbd_temporal_filter_sse4.c"
+    "${AOM_ROOT}/av1/encoder/x86/pickrst_sse4.c")
 
 set(AOM_AV1_ENCODER_INTRIN_AVX2
     "${AOM_ROOT}/av1/encoder/x86/av1_quantize_avx2.c"
     "${AOM_ROOT}/av1/encoder/x86/av1_highbd_quantize_avx2.c"
     "${AOM_ROOT}/av1/encoder/x86/error_intrin_avx2.c"
-    "${AOM_ROOT}/av1/encoder/x86/hybrid_fwd_txfm_avx2.c")
+    "${AOM_ROOT}/av1/encoder/x86/hybrid_fwd_txfm_avx2.c"
+    "${AOM_ROOT}/av1/encoder/x86/pickrst_avx2.c"
+    "${AOM_ROOT}/av1/encoder/x86/temporal_filter_avx2.c")
 
 set(AOM_AV1_ENCODER_INTRIN_NEON
     "${AOM_ROOT}/av1/encoder/arm/neon/quantize_neon.c")
@@ -212,8 +216,7 @@ set(AOM_AV1_ENCODER_INTRIN_MSA
     "${AOM_ROOT}/av1/encoder/mips/msa/fdct16x16_msa.c"
     "${AOM_ROOT}/av1/encoder/mips/msa/fdct4x4_msa.c"
     "${AOM_ROOT}/av1/encoder/mips/msa/fdct8x8_msa.c"
-    "${AOM_ROOT}/av1/encoder/mips/msa/fdct_msa.h"
-    "${AOM_ROOT}/av1/encoder/mips/msa/temporal_filter_msa.c")
+    "${AOM_ROOT}/av1/encoder/mips/msa/fdct_msa.h")
 
 
   set(AOM_AV1_COMMON_INTRIN_SSE4_1
@@ -420,6 +423,8 @@ set(AOM_AV1_COMMON_INTRIN_NEON
 
 set(AOM_AV1_COMMON_SOURCES
     ${AOM_AV1_COMMON_SOURCES}
+    "${AOM_ROOT}/av1/common/postfilter.c"
+    "${AOM_ROOT}/av1/common/postfilter.h"
     "${AOM_ROOT}/av1/common/restoration.c"
     "${AOM_ROOT}/av1/common/restoration.h")
 
@@ -438,7 +443,13 @@ set(AOM_AV1_ENCODER_SOURCES
 
 set(AOM_AV1_COMMON_INTRIN_SSE4_1
     ${AOM_AV1_COMMON_INTRIN_SSE4_1}
-    "${AOM_ROOT}/av1/common/x86/intra_edge_sse4.c")
+    "${AOM_ROOT}/av1/common/x86/intra_edge_sse4.c"
+    "${AOM_ROOT}/av1/common/x86/reconintra_sse4.c"
+    "${AOM_ROOT}/av1/common/x86/reconintra_sse4.h")
+
+set(AOM_AV1_COMMON_INTRIN_AVX2
+    ${AOM_AV1_COMMON_INTRIN_AVX2}
+    "${AOM_ROOT}/av1/common/x86/reconintra_avx2.c")
 
 set(AOM_AV1_COMMON_INTRIN_SSE4_1
     ${AOM_AV1_COMMON_INTRIN_SSE4_1}
@@ -457,13 +468,23 @@ set(AOM_AV1_COMMON_INTRIN_SSE4_1
       ${AOM_AV1_COMMON_INTRIN_SSE4_1}
       "${AOM_ROOT}/av1/common/x86/highbd_warp_plane_sse4.c")
 
+if (CONFIG_LOWPRECISION_BLEND)
+  set(AOM_AV1_COMMON_INTRIN_AVX2
+      ${AOM_AV1_COMMON_INTRIN_AVX2}
+      "${AOM_ROOT}/av1/common/x86/warp_plane_avx2.c"
+      "${AOM_ROOT}/av1/common/x86/warp_plane_avx2.h"
+      "${AOM_ROOT}/av1/common/x86/highbd_warp_plane_avx2.c")
+endif ()
+
 if (CONFIG_HASH_ME)
   set(AOM_AV1_ENCODER_SOURCES
       ${AOM_AV1_ENCODER_SOURCES}
       "${AOM_ROOT}/av1/encoder/hash_motion.h"
-      "${AOM_ROOT}/av1/encoder/hash_motion.c"
-      "${AOM_ROOT}/third_party/vector/vector.h"
-      "${AOM_ROOT}/third_party/vector/vector.c")
+      "${AOM_ROOT}/av1/encoder/hash_motion.c")
+
+  set(AOM_AV1_ENCODER_INTRIN_SSE4_2
+      ${AOM_AV1_ENCODER_INTRIN_SSE4_2}
+      "${AOM_ROOT}/av1/encoder/x86/hash_motion_sse42.c")
 endif ()
 
   set(AOM_AV1_COMMON_SOURCES
@@ -37,6 +37,10 @@
 // TODO(hkuang): Remove this limit after implementing ondemand framebuffers.
 #define FRAME_CACHE_SIZE 6  // Cache maximum 6 decoded frames.
 
+// A frame is started once the tiles of the previous one are decoded, so few
+// frames are ever in flight at once, and each worker holds a frame buffer.
+#define MAX_FRAME_PARALLEL_WORKERS 3
+
 typedef struct cache_frame {
   int fb_idx;
   aom_image_t img;
@@ -61,7 +65,9 @@ struct aom_codec_alg_priv {
   int decode_tile_row;
   int decode_tile_col;
   unsigned int tile_mode;
+  unsigned int lr_threads;
 
+  int frame_parallel_decode;  // frame-based threading.
   AVxWorker *frame_workers;
   int num_frame_workers;
   int next_submit_worker_id;
@@ -71,6 +77,12 @@ struct aom_codec_alg_priv {
   cache_frame frame_cache[FRAME_CACHE_SIZE];
 #if CONFIG_FILM_GRAIN
   aom_image_t *image_with_grain;
+  aom_film_grain_synth_t *grain_synth;
+  // Whether the grain is added into external frame buffers, and the one
+  // holding the last output frame.
+  int grain_in_ext_fb;
+  aom_image_t grain_ext_img;
+  aom_codec_frame_buffer_t grain_ext_fb;
 #endif
   int frame_cache_write;
   int frame_cache_read;
@@ -122,6 +134,15 @@ static aom_codec_err_t decoder_init(aom_codec_ctx_t *ctx,
   return AOM_CODEC_OK;
 }
 
+#if CONFIG_FILM_GRAIN
+static void release_grain_ext_fb(aom_codec_alg_priv_t *ctx) {
+  if (ctx->grain_ext_fb.data != NULL) {
+    ctx->release_ext_fb_cb(ctx->ext_priv, &ctx->grain_ext_fb);
+    memset(&ctx->grain_ext_fb, 0, sizeof(ctx->grain_ext_fb));
+  }
+}
+#endif
+
 static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
   if (ctx->frame_workers != NULL) {
     int i;
@@ -156,6 +177,8 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
   aom_free(ctx->buffer_pool);
 #if CONFIG_FILM_GRAIN
   if (ctx->image_with_grain) aom_img_free(ctx->image_with_grain);
+  release_grain_ext_fb(ctx);
+  av1_film_grain_synth_free(ctx->grain_synth);
 #endif
   aom_free(ctx);
   return AOM_CODEC_OK;
@@ -253,34 +276,37 @@ static aom_codec_err_t update_error_state(
   return error->error_code;
 }
 
-static void init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
+static aom_codec_err_t init_buffer_callbacks(aom_codec_alg_priv_t *ctx) {
+  BufferPool *const pool = ctx->buffer_pool;
   int i;
 
   for (i = 0; i < ctx->num_frame_workers; ++i) {
     AVxWorker *const worker = &ctx->frame_workers[i];
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
     AV1_COMMON *const cm = &frame_worker_data->pbi->common;
-    BufferPool *const pool = cm->buffer_pool;
 
     cm->new_fb_idx = INVALID_IDX;
     cm->byte_alignment = ctx->byte_alignment;
     cm->skip_loop_filter = ctx->skip_loop_filter;
+  }
 
-    if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
-      pool->get_fb_cb = ctx->get_ext_fb_cb;
-      pool->release_fb_cb = ctx->release_ext_fb_cb;
-      pool->cb_priv = ctx->ext_priv;
-    } else {
-      pool->get_fb_cb = av1_get_frame_buffer;
-      pool->release_fb_cb = av1_release_frame_buffer;
-
-      if (av1_alloc_internal_frame_buffers(&pool->int_frame_buffers))
-        aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
-                           "Failed to initialize internal frame buffers");
+  // The buffer pool is shared by all the frame workers.
+  if (ctx->get_ext_fb_cb != NULL && ctx->release_ext_fb_cb != NULL) {
+    pool->get_fb_cb = ctx->get_ext_fb_cb;
+    pool->release_fb_cb = ctx->release_ext_fb_cb;
+    pool->cb_priv = ctx->ext_priv;
+  } else {
+    pool->get_fb_cb = av1_get_frame_buffer;
+    pool->release_fb_cb = av1_release_frame_buffer;
 
-      pool->cb_priv = &pool->int_frame_buffers;
+    if (av1_alloc_internal_frame_buffers(&pool->int_frame_buffers)) {
+      set_error_detail(ctx, "Failed to initialize internal frame buffers");
+      return AOM_CODEC_MEM_ERROR;
     }
+
+    pool->cb_priv = &pool->int_frame_buffers;
   }
+  return AOM_CODEC_OK;
 }
 
 static void set_default_ppflags(aom_postproc_cfg_t *cfg) {
@@ -291,19 +317,34 @@ static void set_default_ppflags(aom_postproc_cfg_t *cfg) {
 
 static int frame_worker_hook(void *arg1, void *arg2) {
   FrameWorkerData *const frame_worker_data = (FrameWorkerData *)arg1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
   const uint8_t *data = frame_worker_data->data;
+  int result;
   (void)arg2;
 
-  frame_worker_data->result = av1_receive_compressed_data(
-      frame_worker_data->pbi, frame_worker_data->data_size, &data);
-  frame_worker_data->data_end = data;
+  result =
+      av1_receive_compressed_data(pbi, frame_worker_data->data_size, &data);
 
-  if (frame_worker_data->result != 0) {
+  if (result != 0) {
     // Check decode result in serial decode.
-    frame_worker_data->pbi->cur_buf->buf.corrupted = 1;
-    frame_worker_data->pbi->need_resync = 1;
+    pbi->cur_buf->buf.corrupted = 1;
+    pbi->need_resync = 1;
+  }
+
+  if (pbi->frame_parallel_decode) {
+    // A frame which failed to decode never made its context ready. Wake up
+    // the threads waiting for it, or for its rows.
+    AVxWorker *const worker = pbi->frame_worker_owner;
+    av1_frameworker_lock_stats(worker);
+    frame_worker_data->result = result;
+    frame_worker_data->frame_context_ready = 1;
+    av1_frameworker_signal_stats(worker);
+    av1_frameworker_unlock_stats(worker);
+  } else {
+    frame_worker_data->result = result;
+    frame_worker_data->data_end = data;
   }
-  return !frame_worker_data->result;
+  return !result;
 }
 
 static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
@@ -318,7 +359,18 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   ctx->frame_cache_write = 0;
   ctx->num_cache_frames = 0;
   ctx->need_resync = 1;
-  ctx->num_frame_workers = 1;
+#if CONFIG_MULTITHREAD
+  // Large scale tile coding is always decoded serially.
+  ctx->frame_parallel_decode =
+      (ctx->base.init_flags & AOM_CODEC_USE_FRAME_THREADING) &&
+      ctx->cfg.threads > 1 && !ctx->tile_mode;
+#else
+  ctx->frame_parallel_decode = 0;
+#endif
+  ctx->num_frame_workers =
+      ctx->frame_parallel_decode
+          ? AOMMIN(ctx->cfg.threads, MAX_FRAME_PARALLEL_WORKERS)
+          : 1;
   if (ctx->num_frame_workers > MAX_DECODE_THREADS)
     ctx->num_frame_workers = MAX_DECODE_THREADS;
   ctx->available_threads = ctx->num_frame_workers;
@@ -375,10 +427,13 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
     }
 #endif
     frame_worker_data->pbi->allow_lowbitdepth = ctx->cfg.allow_lowbitdepth;
+    frame_worker_data->pbi->frame_parallel_decode = ctx->frame_parallel_decode;
 
     // If decoding in serial mode, FrameWorker thread could create tile worker
     // thread or loopfilter thread.
-    frame_worker_data->pbi->max_threads = ctx->cfg.threads;
+    frame_worker_data->pbi->max_threads =
+        ctx->frame_parallel_decode ? 1 : ctx->cfg.threads;
+    frame_worker_data->pbi->lr_threads = ctx->lr_threads;
     frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
     frame_worker_data->pbi->common.large_scale_tile = ctx->tile_mode;
     frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
@@ -395,9 +450,7 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   if (!ctx->postproc_cfg_set && (ctx->base.init_flags & AOM_CODEC_USE_POSTPROC))
     set_default_ppflags(&ctx->postproc_cfg);
 
-  init_buffer_callbacks(ctx);
-
-  return AOM_CODEC_OK;
+  return init_buffer_callbacks(ctx);
 }
 
 static INLINE void check_resync(aom_codec_alg_priv_t *const ctx,
@@ -408,6 +461,36 @@ static INLINE void check_resync(aom_codec_alg_priv_t *const ctx,
     ctx->need_resync = 0;
 }
 
+static void wait_worker_and_cache_frame(aom_codec_alg_priv_t *ctx) {
+  YV12_BUFFER_CONFIG sd;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  ctx->next_output_worker_id =
+      (ctx->next_output_worker_id + 1) % ctx->num_frame_workers;
+  // A frame which failed to decode is skipped, as in decoder_get_frame().
+  if (!winterface->sync(worker)) ctx->need_resync = 1;
+  frame_worker_data->received_frame = 0;
+  ++ctx->available_threads;
+
+  check_resync(ctx, frame_worker_data->pbi);
+
+  if (!worker->had_error &&
+      av1_get_raw_frame(frame_worker_data->pbi, &sd) == 0) {
+    AV1_COMMON *const cm = &frame_worker_data->pbi->common;
+    RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+    cache_frame *const cache = &ctx->frame_cache[ctx->frame_cache_write];
+    cache->fb_idx = cm->new_fb_idx;
+    yuvconfig2image(&cache->img, &sd, frame_worker_data->user_priv);
+    cache->img.fb_priv = frame_bufs[cm->new_fb_idx].raw_frame_buffer.priv;
+#if CONFIG_FILM_GRAIN
+    cache->film_grain_params = cm->film_grain_params;
+#endif
+    ctx->frame_cache_write = (ctx->frame_cache_write + 1) % FRAME_CACHE_SIZE;
+    ++ctx->num_cache_frames;
+  }
+}
+
 static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
                                   const uint8_t **data, unsigned int data_sz,
                                   void *user_priv) {
@@ -425,32 +508,107 @@ static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
     if (!ctx->si.is_kf && !is_intra_only) return AOM_CODEC_ERROR;
   }
 
-  AVxWorker *const worker = ctx->frame_workers;
-  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-  frame_worker_data->data = *data;
-  frame_worker_data->data_size = data_sz;
-  frame_worker_data->user_priv = user_priv;
-  frame_worker_data->received_frame = 1;
+  if (!ctx->frame_parallel_decode) {
+    AVxWorker *const worker = ctx->frame_workers;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    frame_worker_data->data = *data;
+    frame_worker_data->data_size = data_sz;
+    frame_worker_data->user_priv = user_priv;
+    frame_worker_data->received_frame = 1;
 
 #if CONFIG_INSPECTION
-  frame_worker_data->pbi->inspect_cb = ctx->inspect_cb;
-  frame_worker_data->pbi->inspect_ctx = ctx->inspect_ctx;
+    frame_worker_data->pbi->inspect_cb = ctx->inspect_cb;
+    frame_worker_data->pbi->inspect_ctx = ctx->inspect_ctx;
 #endif
 
-  frame_worker_data->pbi->common.large_scale_tile = ctx->tile_mode;
-  frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
-  frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
+    frame_worker_data->pbi->common.large_scale_tile = ctx->tile_mode;
+    frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
+    frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
 
-  worker->had_error = 0;
-  winterface->execute(worker);
+    worker->had_error = 0;
+    winterface->execute(worker);
 
-  // Update data pointer after decode.
-  *data = frame_worker_data->data_end;
+    // Update data pointer after decode.
+    *data = frame_worker_data->data_end;
 
-  if (worker->had_error)
-    return update_error_state(ctx, &frame_worker_data->pbi->common.error);
+    if (worker->had_error)
+      return update_error_state(ctx, &frame_worker_data->pbi->common.error);
 
-  check_resync(ctx, frame_worker_data->pbi);
+    check_resync(ctx, frame_worker_data->pbi);
+  } else {
+    // Decode in frame parallel mode. The end of the frame in the temporal
+    // unit is only known once its tiles have been decoded, so the worker is
+    // given a copy of the rest of the temporal unit and the next frame is
+    // submitted once the context of this one is ready.
+    AVxWorker *const worker = &ctx->frame_workers[ctx->next_submit_worker_id];
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+    const uint8_t *data_end;
+    int result;
+
+    if (ctx->available_threads == 0) {
+      // No more threads for decoding. Wait until the next output worker
+      // finishes decoding. Then copy the decoded frame into cache.
+      if (ctx->num_cache_frames < FRAME_CACHE_SIZE) {
+        wait_worker_and_cache_frame(ctx);
+      } else {
+        set_error_detail(ctx, "Frame output cache is full.");
+        return AOM_CODEC_ERROR;
+      }
+    }
+
+    // Copy context from last worker thread to next worker thread.
+    if (ctx->next_submit_worker_id != ctx->last_submit_worker_id)
+      av1_frameworker_copy_context(
+          worker, &ctx->frame_workers[ctx->last_submit_worker_id]);
+
+    frame_worker_data->pbi->ready_for_new_data = 0;
+    // Copy the compressed data into worker's internal buffer.
+    if (frame_worker_data->scratch_buffer_size < data_sz) {
+      aom_free(frame_worker_data->scratch_buffer);
+      frame_worker_data->scratch_buffer = (uint8_t *)aom_malloc(data_sz);
+      if (frame_worker_data->scratch_buffer == NULL) {
+        frame_worker_data->scratch_buffer_size = 0;
+        set_error_detail(ctx, "Failed to reallocate scratch buffer");
+        return AOM_CODEC_MEM_ERROR;
+      }
+      frame_worker_data->scratch_buffer_size = data_sz;
+    }
+    memcpy(frame_worker_data->scratch_buffer, *data, data_sz);
+    frame_worker_data->data = frame_worker_data->scratch_buffer;
+    frame_worker_data->data_end = frame_worker_data->scratch_buffer;
+    frame_worker_data->data_size = data_sz;
+    frame_worker_data->user_priv = user_priv;
+    frame_worker_data->result = 0;
+    frame_worker_data->frame_context_ready = 0;
+    frame_worker_data->received_frame = 1;
+
+    frame_worker_data->pbi->common.large_scale_tile = ctx->tile_mode;
+    frame_worker_data->pbi->dec_tile_row = ctx->decode_tile_row;
+    frame_worker_data->pbi->dec_tile_col = ctx->decode_tile_col;
+
+    if (ctx->next_submit_worker_id != ctx->last_submit_worker_id)
+      ctx->last_submit_worker_id =
+          (ctx->last_submit_worker_id + 1) % ctx->num_frame_workers;
+
+    ctx->next_submit_worker_id =
+        (ctx->next_submit_worker_id + 1) % ctx->num_frame_workers;
+    --ctx->available_threads;
+    worker->had_error = 0;
+    winterface->launch(worker);
+
+    av1_frameworker_wait_context_ready(worker);
+    av1_frameworker_lock_stats(worker);
+    result = frame_worker_data->result;
+    data_end = frame_worker_data->data_end;
+    av1_frameworker_unlock_stats(worker);
+
+    // The worker is released when its output is collected.
+    if (result != 0)
+      return update_error_state(ctx, &frame_worker_data->pbi->common.error);
+
+    // Update data pointer after decode.
+    *data += data_end - frame_worker_data->scratch_buffer;
+  }
 
   return AOM_CODEC_OK;
 }
@@ -513,49 +671,128 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
 }
 
 #if CONFIG_FILM_GRAIN
-aom_image_t *add_grain_if_needed(aom_image_t *img, aom_image_t *grain_img_buf,
-                                 aom_film_grain_t *grain_params) {
-  if (!grain_params->apply_grain) return img;
+// Returns an image of the format of img, with even width and height, from a
+// frame buffer of the application.
+static aom_image_t *get_grain_ext_image(aom_codec_alg_priv_t *ctx,
+                                        const aom_image_t *img,
+                                        unsigned int w_even,
+                                        unsigned int h_even) {
+  // Same layout as aom_img_wrap() with a stride alignment of 16.
+  const int use_hbd = (img->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 1 : 0;
+  const size_t stride = (size_t)((w_even + 15) & ~15) << use_hbd;
+  const size_t chroma_size =
+      (stride >> img->x_chroma_shift) * (h_even >> img->y_chroma_shift);
+  const size_t size = stride * h_even + 2 * chroma_size;
+
+  if (ctx->get_ext_fb_cb(ctx->ext_priv, size, &ctx->grain_ext_fb) < 0 ||
+      ctx->grain_ext_fb.data == NULL || ctx->grain_ext_fb.size < size) {
+    memset(&ctx->grain_ext_fb, 0, sizeof(ctx->grain_ext_fb));
+    return NULL;
+  }
+  if (!aom_img_wrap(&ctx->grain_ext_img, img->fmt, w_even, h_even, 16,
+                    ctx->grain_ext_fb.data)) {
+    release_grain_ext_fb(ctx);
+    return NULL;
+  }
+  ctx->grain_ext_img.fb_priv = ctx->grain_ext_fb.priv;
+  return &ctx->grain_ext_img;
+}
 
-  if (grain_img_buf &&
-      (img->d_w != grain_img_buf->d_w || img->d_h != grain_img_buf->d_h ||
-       img->fmt != grain_img_buf->fmt || !(img->d_h % 2) || !(img->d_w % 2))) {
-    aom_img_free(grain_img_buf);
-    grain_img_buf = NULL;
+// Returns an image of the format of img, with even width and height. The
+// image is kept from frame to frame while the format and the size do not
+// change.
+static aom_image_t *get_grain_image(aom_codec_alg_priv_t *ctx,
+                                    const aom_image_t *img,
+                                    unsigned int w_even, unsigned int h_even) {
+  aom_image_t *grain_img = ctx->image_with_grain;
+
+  if (grain_img && (img->fmt != grain_img->fmt || w_even != grain_img->w ||
+                    h_even != grain_img->h)) {
+    aom_img_free(grain_img);
+    grain_img = NULL;
   }
-  if (!grain_img_buf) {
-    int w_even = img->d_w % 2 ? img->d_w + 1 : img->d_w;
-    int h_even = img->d_h % 2 ? img->d_h + 1 : img->d_h;
-    grain_img_buf = aom_img_alloc(NULL, img->fmt, w_even, h_even, 16);
-    grain_img_buf->bit_depth = img->bit_depth;
+  if (!grain_img) grain_img = aom_img_alloc(NULL, img->fmt, w_even, h_even, 16);
+  ctx->image_with_grain = grain_img;
+  return grain_img;
+}
+
+static aom_image_t *add_grain_if_needed(aom_codec_alg_priv_t *ctx,
+                                        aom_image_t *img,
+                                        aom_film_grain_t *grain_params) {
+  const unsigned int w_even = (img->d_w + 1) & ~1;
+  const unsigned int h_even = (img->d_h + 1) & ~1;
+  aom_image_t *grain_img;
+
+  // The previous output frame is no longer used.
+  release_grain_ext_fb(ctx);
+
+  if (!grain_params->apply_grain) return img;
+
+  // The synthesizer keeps its buffers and threads from frame to frame.
+  if (!ctx->grain_synth) {
+    ctx->grain_synth = av1_film_grain_synth_alloc(ctx->cfg.threads);
+    if (!ctx->grain_synth) return NULL;
   }
 
-  av1_add_film_grain(grain_params, img, grain_img_buf);
+  if (ctx->grain_in_ext_fb && ctx->get_ext_fb_cb != NULL)
+    grain_img = get_grain_ext_image(ctx, img, w_even, h_even);
+  else
+    grain_img = get_grain_image(ctx, img, w_even, h_even);
+  if (!grain_img) return NULL;
 
-  return grain_img_buf;
+  grain_img->bit_depth = img->bit_depth;
+  grain_img->monochrome = img->monochrome;
+  grain_img->cs = img->cs;
+  grain_img->range = img->range;
+  grain_img->user_priv = img->user_priv;
+  grain_img->temporal_id = img->temporal_id;
+  grain_img->enhancement_id = img->enhancement_id;
+
+  if (av1_add_film_grain(ctx->grain_synth, grain_params, img, grain_img))
+    return NULL;
+
+  return grain_img;
 }
 #endif
 
+static void release_last_output_frame(aom_codec_alg_priv_t *ctx) {
+  RefCntBuffer *const frame_bufs = ctx->buffer_pool->frame_bufs;
+  // Decrease reference count of the last output frame in frame parallel mode.
+  if (ctx->frame_parallel_decode && ctx->last_show_frame >= 0) {
+    BufferPool *const pool = ctx->buffer_pool;
+    lock_buffer_pool(pool);
+    decrease_ref_count(ctx->last_show_frame, frame_bufs, pool);
+    unlock_buffer_pool(pool);
+  }
+}
+
 static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
                                       aom_codec_iter_t *iter) {
   aom_image_t *img = NULL;
 
   // Output the frames in the cache first.
   if (ctx->num_cache_frames > 0) {
-    ctx->last_show_frame = ctx->frame_cache[ctx->frame_cache_read].fb_idx;
+    cache_frame *const cache = &ctx->frame_cache[ctx->frame_cache_read];
+    release_last_output_frame(ctx);
+    ctx->last_show_frame = cache->fb_idx;
     if (ctx->need_resync) return NULL;
-    img = &ctx->frame_cache[ctx->frame_cache_read].img;
+    img = &cache->img;
     ctx->frame_cache_read = (ctx->frame_cache_read + 1) % FRAME_CACHE_SIZE;
     --ctx->num_cache_frames;
 #if CONFIG_FILM_GRAIN
-    return add_grain_if_needed(
-        img, ctx->image_with_grain,
-        &ctx->frame_cache[ctx->frame_cache_read].film_grain_params);
+    return add_grain_if_needed(ctx, img, &cache->film_grain_params);
 #else
     return img;
 #endif
   }
 
+  // In frame parallel mode, frames are only output once all the workers are
+  // busy, or when the decoder is flushed, so that decoding never waits for
+  // the output of a frame.
+  if (ctx->frame_parallel_decode && ctx->available_threads > 0 &&
+      !ctx->flushed)
+    return NULL;
+
   // iter acts as a flip flop, so an image is only returned on the first
   // call to get_frame.
   if (*iter == NULL && ctx->frame_workers != NULL) {
@@ -578,6 +815,7 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
         if (av1_get_raw_frame(frame_worker_data->pbi, &sd) == 0) {
           AV1_COMMON *const cm = &frame_worker_data->pbi->common;
           RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+          release_last_output_frame(ctx);
           ctx->last_show_frame = frame_worker_data->pbi->common.new_fb_idx;
           if (ctx->need_resync) return NULL;
           yuvconfig2image(&ctx->img, &sd, frame_worker_data->user_priv);
@@ -626,8 +864,7 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
 #endif
 #if CONFIG_FILM_GRAIN
           return add_grain_if_needed(
-              img, ctx->image_with_grain,
-              &frame_worker_data->pbi->common.film_grain_params);
+              ctx, img, &frame_worker_data->pbi->common.film_grain_params);
 #else
           return img;
 #endif
@@ -665,6 +902,12 @@ static aom_codec_err_t ctrl_set_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   av1_ref_frame_t *const data = va_arg(args, av1_ref_frame_t *);
 
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return AOM_CODEC_INCAPABLE;
+  }
+
   if (data) {
     av1_ref_frame_t *const frame = data;
     YV12_BUFFER_CONFIG sd;
@@ -681,6 +924,13 @@ static aom_codec_err_t ctrl_set_reference(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_copy_reference(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   const av1_ref_frame_t *const frame = va_arg(args, av1_ref_frame_t *);
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return AOM_CODEC_INCAPABLE;
+  }
+
   if (frame) {
     YV12_BUFFER_CONFIG sd;
     AVxWorker *const worker = ctx->frame_workers;
@@ -695,6 +945,13 @@ static aom_codec_err_t ctrl_copy_reference(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   av1_ref_frame_t *data = va_arg(args, av1_ref_frame_t *);
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return AOM_CODEC_INCAPABLE;
+  }
+
   if (data) {
     YV12_BUFFER_CONFIG *fb;
     AVxWorker *const worker = ctx->frame_workers;
@@ -711,6 +968,13 @@ static aom_codec_err_t ctrl_get_reference(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_new_frame_image(aom_codec_alg_priv_t *ctx,
                                                 va_list args) {
   aom_image_t *new_img = va_arg(args, aom_image_t *);
+
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return AOM_CODEC_INCAPABLE;
+  }
+
   if (new_img) {
     YV12_BUFFER_CONFIG new_frame;
     AVxWorker *const worker = ctx->frame_workers;
@@ -745,6 +1009,12 @@ static aom_codec_err_t ctrl_get_last_ref_updates(aom_codec_alg_priv_t *ctx,
                                                  va_list args) {
   int *const update_info = va_arg(args, int *);
 
+  // Only support this function in serial decode.
+  if (ctx->frame_parallel_decode) {
+    set_error_detail(ctx, "Not supported in frame parallel decode");
+    return AOM_CODEC_INCAPABLE;
+  }
+
   if (update_info) {
     if (ctx->frame_workers) {
       AVxWorker *const worker = ctx->frame_workers;
@@ -876,9 +1146,13 @@ static aom_codec_err_t ctrl_set_byte_alignment(aom_codec_alg_priv_t *ctx,
 
   ctx->byte_alignment = byte_alignment;
   if (ctx->frame_workers) {
-    AVxWorker *const worker = ctx->frame_workers;
-    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-    frame_worker_data->pbi->common.byte_alignment = byte_alignment;
+    int i;
+    for (i = 0; i < ctx->num_frame_workers; ++i) {
+      AVxWorker *const worker = &ctx->frame_workers[i];
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)worker->data1;
+      frame_worker_data->pbi->common.byte_alignment = byte_alignment;
+    }
   }
   return AOM_CODEC_OK;
 }
@@ -888,9 +1162,13 @@ static aom_codec_err_t ctrl_set_skip_loop_filter(aom_codec_alg_priv_t *ctx,
   ctx->skip_loop_filter = va_arg(args, int);
 
   if (ctx->frame_workers) {
-    AVxWorker *const worker = ctx->frame_workers;
-    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
-    frame_worker_data->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+    int i;
+    for (i = 0; i < ctx->num_frame_workers; ++i) {
+      AVxWorker *const worker = &ctx->frame_workers[i];
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)worker->data1;
+      frame_worker_data->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+    }
   }
 
   return AOM_CODEC_OK;
@@ -932,6 +1210,21 @@ static aom_codec_err_t ctrl_set_tile_mode(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_lr_threads(aom_codec_alg_priv_t *ctx,
+                                           va_list args) {
+  ctx->lr_threads = va_arg(args, unsigned int);
+  if (ctx->frame_workers) {
+    int i;
+    for (i = 0; i < ctx->num_frame_workers; ++i) {
+      AVxWorker *const worker = &ctx->frame_workers[i];
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)worker->data1;
+      frame_worker_data->pbi->lr_threads = ctx->lr_threads;
+    }
+  }
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_set_inspection_callback(aom_codec_alg_priv_t *ctx,
                                                     va_list args) {
 #if !CONFIG_INSPECTION
@@ -946,6 +1239,18 @@ static aom_codec_err_t ctrl_set_inspection_callback(aom_codec_alg_priv_t *ctx,
 #endif
 }
 
+static aom_codec_err_t ctrl_set_film_grain_ext_fb(aom_codec_alg_priv_t *ctx,
+                                                 va_list args) {
+#if !CONFIG_FILM_GRAIN
+  (void)ctx;
+  (void)args;
+  return AOM_CODEC_INCAPABLE;
+#else
+  ctx->grain_in_ext_fb = va_arg(args, int);
+  return AOM_CODEC_OK;
+#endif
+}
+
 static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -963,6 +1268,8 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_SET_DECODE_TILE_COL, ctrl_set_decode_tile_col },
   { AV1_SET_TILE_MODE, ctrl_set_tile_mode },
   { AV1_SET_INSPECTION_CALLBACK, ctrl_set_inspection_callback },
+  { AV1_SET_FILM_GRAIN_EXT_FB, ctrl_set_film_grain_ext_fb },
+  { AV1_SET_LR_THREADS, ctrl_set_lr_threads },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -984,7 +1291,7 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
 CODEC_INTERFACE(aom_codec_av1_dx) = {
   "AOMedia Project AV1 Decoder" VERSION_STRING,
   AOM_CODEC_INTERNAL_ABI_VERSION,
-  AOM_CODEC_CAP_DECODER |
+  AOM_CODEC_CAP_DECODER | AOM_CODEC_CAP_FRAME_THREADING |
       AOM_CODEC_CAP_EXTERNAL_FRAME_BUFFER,  // aom_codec_caps_t
   decoder_init,                             // aom_codec_init_fn_t
   decoder_destroy,                          // aom_codec_destroy_fn_t
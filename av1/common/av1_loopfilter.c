@@ -35,16 +35,6 @@ static const int delta_lf_id_lut[MAX_MB_PLANE][2] = {
 
 typedef enum EDGE_DIR { VERT_EDGE = 0, HORZ_EDGE = 1, NUM_EDGE_DIRS } EDGE_DIR;
 
-extern void aom_highbd_lpf_horizontal_6_c(uint16_t *s, int p,
-                                          const uint8_t *blimit,
-                                          const uint8_t *limit,
-                                          const uint8_t *thresh, int bd);
-
-extern void aom_highbd_lpf_vertical_6_c(uint16_t *s, int pitch,
-                                        const uint8_t *blimit,
-                                        const uint8_t *limit,
-                                        const uint8_t *thresh, int bd);
-
 // 64 bit masks for left transform size. Each 1 represents a position where
 // we should apply a loop filter across the left border of an 8x8 block
 // boundary.
@@ -579,15 +569,16 @@ static uint8_t get_filter_level(const AV1_COMMON *cm,
     }
     return lvl_seg;
   } else {
-    return lfi_n
-        ->lvl[segment_id][dir_idx][mbmi->ref_frame[0]][mode_lf_lut[mbmi->mode]];
+    return lfi_n->lvl[plane][segment_id][dir_idx][mbmi->ref_frame[0]]
+                     [mode_lf_lut[mbmi->mode]];
   }
 }
 #else
-static uint8_t get_filter_level(const loop_filter_info_n *lfi_n,
+static uint8_t get_filter_level(const loop_filter_info_n *lfi_n, int plane,
                                 const MB_MODE_INFO *mbmi) {
   const int segment_id = mbmi->segment_id;
-  return lfi_n->lvl[segment_id][mbmi->ref_frame[0]][mode_lf_lut[mbmi->mode]];
+  return lfi_n
+      ->lvl[plane][segment_id][mbmi->ref_frame[0]][mode_lf_lut[mbmi->mode]];
 }
 #endif
 
@@ -631,19 +622,20 @@ void av1_loop_filter_frame_init(AV1_COMMON *cm, int default_filt_lvl,
       if (!lf->mode_ref_delta_enabled) {
         // we could get rid of this if we assume that deltas are set to
         // zero when not in use; encoder always uses deltas
-        memset(lfi->lvl[seg_id][dir], lvl_seg, sizeof(lfi->lvl[seg_id][dir]));
+        memset(lfi->lvl[plane][seg_id][dir], lvl_seg,
+               sizeof(lfi->lvl[plane][seg_id][dir]));
       } else {
         int ref, mode;
         const int scale = 1 << (lvl_seg >> 5);
         const int intra_lvl = lvl_seg + lf->ref_deltas[INTRA_FRAME] * scale;
-        lfi->lvl[seg_id][dir][INTRA_FRAME][0] =
+        lfi->lvl[plane][seg_id][dir][INTRA_FRAME][0] =
             clamp(intra_lvl, 0, MAX_LOOP_FILTER);
 
         for (ref = LAST_FRAME; ref < TOTAL_REFS_PER_FRAME; ++ref) {
           for (mode = 0; mode < MAX_MODE_LF_DELTAS; ++mode) {
             const int inter_lvl = lvl_seg + lf->ref_deltas[ref] * scale +
                                   lf->mode_deltas[mode] * scale;
-            lfi->lvl[seg_id][dir][ref][mode] =
+            lfi->lvl[plane][seg_id][dir][ref][mode] =
                 clamp(inter_lvl, 0, MAX_LOOP_FILTER);
           }
         }
@@ -804,8 +796,8 @@ static void setup_masks(AV1_COMMON *const cm, int mi_row, int mi_col, int plane,
     const uint8_t level_prev =
         get_filter_level(cm, &cm->lf_info, dir, plane, mbmi_prev);
 #else
-    const uint8_t level = get_filter_level(&cm->lf_info, mbmi);
-    const uint8_t level_prev = get_filter_level(&cm->lf_info, mbmi_prev);
+    const uint8_t level = get_filter_level(&cm->lf_info, plane, mbmi);
+    const uint8_t level_prev = get_filter_level(&cm->lf_info, plane, mbmi_prev);
 #endif  // CONFIG_EXT_DELTA_Q
     const int prev_skip = mbmi_prev->skip && is_inter_block(mbmi_prev);
     const BLOCK_SIZE bsize =
@@ -1093,7 +1085,7 @@ static void build_masks(AV1_COMMON *const cm,
 #if CONFIG_EXT_DELTA_Q
   const int filter_level = get_filter_level(cm, lfi_n, 0, 0, mbmi);
 #else
-  const int filter_level = get_filter_level(lfi_n, mbmi);
+  const int filter_level = get_filter_level(lfi_n, 0, mbmi);
   (void)cm;
 #endif
   uint64_t *const left_y = &lfm->left_y[tx_size_y_left];
@@ -1179,7 +1171,7 @@ static void build_y_mask(AV1_COMMON *const cm,
 #if CONFIG_EXT_DELTA_Q
   const int filter_level = get_filter_level(cm, lfi_n, 0, 0, mbmi);
 #else
-  const int filter_level = get_filter_level(lfi_n, mbmi);
+  const int filter_level = get_filter_level(lfi_n, 0, mbmi);
   (void)cm;
 #endif
   uint64_t *const left_y = &lfm->left_y[tx_size_y_left];
@@ -1598,7 +1590,7 @@ static TX_SIZE set_lpf_parameters(
       const uint32_t curr_level =
           get_filter_level(cm, &cm->lf_info, edge_dir, plane, mbmi);
 #else
-      const uint32_t curr_level = get_filter_level(&cm->lf_info, mbmi);
+      const uint32_t curr_level = get_filter_level(&cm->lf_info, plane, mbmi);
 #endif  // CONFIG_EXT_DELTA_Q
 
       const int curr_skipped = mbmi->skip && is_inter_block(mbmi);
@@ -1618,7 +1610,7 @@ static TX_SIZE set_lpf_parameters(
                                                    plane, &mi_prev->mbmi);
 #else
           const uint32_t pv_lvl =
-              get_filter_level(&cm->lf_info, &mi_prev->mbmi);
+              get_filter_level(&cm->lf_info, plane, &mi_prev->mbmi);
 #endif  // CONFIG_EXT_DELTA_Q
 
           const int pv_skip =
@@ -1668,164 +1660,250 @@ static TX_SIZE set_lpf_parameters(
   return ts;
 }
 
-static void filter_block_plane_vert(const AV1_COMMON *const cm, const int plane,
-                                    const MACROBLOCKD_PLANE *const plane_ptr,
-                                    const uint32_t mi_row,
-                                    const uint32_t mi_col) {
-  const int row_step = MI_SIZE >> MI_SIZE_LOG2;
+// Number of consecutive 4-pixel edge segments filtered by the quad filters.
+#define LF_QUAD_UNITS 4
+
+static void filter_vert_edge(const AV1_COMMON *const cm, const int plane,
+                             uint8_t *p, const int dst_stride,
+                             const AV1_DEBLOCKING_PARAMETERS *const params) {
+  switch (params->filter_length) {
+    // apply 4-tap filtering
+    case 4:
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_vertical_4(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                  params->mblim, params->lim, params->hev_thr,
+                                  cm->bit_depth);
+      else
+        aom_lpf_vertical_4(p, dst_stride, params->mblim, params->lim,
+                           params->hev_thr);
+      break;
+    case 6:  // apply 6-tap filter for chroma plane only
+      assert(plane != 0);
+      (void)plane;
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_vertical_6(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                  params->mblim, params->lim, params->hev_thr,
+                                  cm->bit_depth);
+      else
+        aom_lpf_vertical_6(p, dst_stride, params->mblim, params->lim,
+                           params->hev_thr);
+      break;
+    // apply 8-tap filtering
+    case 8:
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_vertical_8(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                  params->mblim, params->lim, params->hev_thr,
+                                  cm->bit_depth);
+      else
+        aom_lpf_vertical_8(p, dst_stride, params->mblim, params->lim,
+                           params->hev_thr);
+      break;
+    // apply 14-tap filtering
+    case 14:
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_vertical_14(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                   params->mblim, params->lim, params->hev_thr,
+                                   cm->bit_depth);
+      else
+        aom_lpf_vertical_14(p, dst_stride, params->mblim, params->lim,
+                            params->hev_thr);
+      break;
+    // no filtering
+    default: break;
+  }
+}
+
+static void filter_horz_edge(const AV1_COMMON *const cm, const int plane,
+                             uint8_t *p, const int dst_stride,
+                             const AV1_DEBLOCKING_PARAMETERS *const params) {
+  switch (params->filter_length) {
+    // apply 4-tap filtering
+    case 4:
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_horizontal_4(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                    params->mblim, params->lim,
+                                    params->hev_thr, cm->bit_depth);
+      else
+        aom_lpf_horizontal_4(p, dst_stride, params->mblim, params->lim,
+                             params->hev_thr);
+      break;
+    // apply 6-tap filtering
+    case 6:
+      assert(plane != 0);
+      (void)plane;
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_horizontal_6(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                    params->mblim, params->lim,
+                                    params->hev_thr, cm->bit_depth);
+      else
+        aom_lpf_horizontal_6(p, dst_stride, params->mblim, params->lim,
+                             params->hev_thr);
+      break;
+    // apply 8-tap filtering
+    case 8:
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_horizontal_8(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                    params->mblim, params->lim,
+                                    params->hev_thr, cm->bit_depth);
+      else
+        aom_lpf_horizontal_8(p, dst_stride, params->mblim, params->lim,
+                             params->hev_thr);
+      break;
+    // apply 14-tap filtering
+    case 14:
+      if (cm->use_highbitdepth)
+        aom_highbd_lpf_horizontal_14(CONVERT_TO_SHORTPTR(p), dst_stride,
+                                     params->mblim, params->lim,
+                                     params->hev_thr, cm->bit_depth);
+      else
+        aom_lpf_horizontal_14(p, dst_stride, params->mblim, params->lim,
+                              params->hev_thr);
+      break;
+    // no filtering
+    default: break;
+  }
+}
+
+// Returns 1 if the LF_QUAD_UNITS edge segments at idx can be filtered with a
+// single quad call: same filter length and same filter level, which the
+// pointer into lfthr identifies.
+static INLINE int can_filter_quad(
+    const AV1_COMMON *const cm,
+    AV1_DEBLOCKING_PARAMETERS params[LF_QUAD_UNITS][MAX_MIB_SIZE],
+    const int idx) {
+  if (cm->use_highbitdepth || !params[0][idx].filter_length) return 0;
+  for (int i = 1; i < LF_QUAD_UNITS; ++i) {
+    if (params[i][idx].filter_length != params[0][idx].filter_length ||
+        params[i][idx].mblim != params[0][idx].mblim)
+      return 0;
+  }
+  return 1;
+}
+
+void av1_filter_block_plane_vert(const AV1_COMMON *const cm, const int plane,
+                                 const MACROBLOCKD_PLANE *const plane_ptr,
+                                 const uint32_t mi_row, const uint32_t mi_col) {
   const uint32_t scale_horz = plane_ptr->subsampling_x;
   const uint32_t scale_vert = plane_ptr->subsampling_y;
   uint8_t *const dst_ptr = plane_ptr->dst.buf;
   const int dst_stride = plane_ptr->dst.stride;
   const int y_range = (MAX_MIB_SIZE >> scale_vert);
   const int x_range = (MAX_MIB_SIZE >> scale_horz);
-  for (int y = 0; y < y_range; y += row_step) {
+  // The edges of LF_QUAD_UNITS rows are gathered first so that runs of
+  // identical edges in a column can be filtered together.
+  AV1_DEBLOCKING_PARAMETERS params[LF_QUAD_UNITS][MAX_MIB_SIZE];
+  assert(y_range % LF_QUAD_UNITS == 0);
+  for (int y = 0; y < y_range; y += LF_QUAD_UNITS) {
+    memset(params, 0, sizeof(params));
+    for (int i = 0; i < LF_QUAD_UNITS; ++i) {
+      for (int x = 0; x < x_range;) {
+        // inner loop always filter vertical edges in a MI block. If MI size
+        // is 8x8, it will filter the vertical edge aligned with a 8x8 block.
+        // If 4x4 trasnform is used, it will then filter the internal edge
+        //  aligned with a 4x4 block
+        const uint32_t curr_x =
+            ((mi_col * MI_SIZE) >> scale_horz) + x * MI_SIZE;
+        const uint32_t curr_y =
+            ((mi_row * MI_SIZE) >> scale_vert) + (y + i) * MI_SIZE;
+        const TX_SIZE tx_size = set_lpf_parameters(
+            &params[i][x], ((ptrdiff_t)1 << scale_horz), cm, VERT_EDGE,
+            curr_x, curr_y, plane, plane_ptr);
+        x += tx_size_wide_unit[tx_size];
+      }
+    }
+
     uint8_t *p = dst_ptr + y * MI_SIZE * dst_stride;
-    for (int x = 0; x < x_range;) {
-      // inner loop always filter vertical edges in a MI block. If MI size
-      // is 8x8, it will filter the vertical edge aligned with a 8x8 block.
-      // If 4x4 trasnform is used, it will then filter the internal edge
-      //  aligned with a 4x4 block
-      const uint32_t curr_x = ((mi_col * MI_SIZE) >> scale_horz) + x * MI_SIZE;
-      const uint32_t curr_y = ((mi_row * MI_SIZE) >> scale_vert) + y * MI_SIZE;
-      uint32_t advance_units;
-      TX_SIZE tx_size;
-      AV1_DEBLOCKING_PARAMETERS params;
-      memset(&params, 0, sizeof(params));
-
-      tx_size = set_lpf_parameters(&params, ((ptrdiff_t)1 << scale_horz), cm,
-                                   VERT_EDGE, curr_x, curr_y, plane, plane_ptr);
-
-      switch (params.filter_length) {
-        // apply 4-tap filtering
-        case 4:
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_vertical_4(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                      params.mblim, params.lim, params.hev_thr,
-                                      cm->bit_depth);
-          else
-            aom_lpf_vertical_4(p, dst_stride, params.mblim, params.lim,
-                               params.hev_thr);
-          break;
-        case 6:  // apply 6-tap filter for chroma plane only
-          assert(plane != 0);
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_vertical_6_c(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                        params.mblim, params.lim,
-                                        params.hev_thr, cm->bit_depth);
-          else
-            aom_lpf_vertical_6(p, dst_stride, params.mblim, params.lim,
-                               params.hev_thr);
-          break;
-        // apply 8-tap filtering
-        case 8:
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_vertical_8(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                      params.mblim, params.lim, params.hev_thr,
-                                      cm->bit_depth);
-          else
-            aom_lpf_vertical_8(p, dst_stride, params.mblim, params.lim,
-                               params.hev_thr);
-          break;
-        // apply 14-tap filtering
-        case 14:
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_vertical_14(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                       params.mblim, params.lim, params.hev_thr,
-                                       cm->bit_depth);
-          else
-            aom_lpf_vertical_14(p, dst_stride, params.mblim, params.lim,
-                                params.hev_thr);
-          break;
-        // no filtering
-        default: break;
+    for (int x = 0; x < x_range; ++x, p += MI_SIZE) {
+      const AV1_DEBLOCKING_PARAMETERS *const quad = &params[0][x];
+      if (can_filter_quad(cm, params, x)) {
+        switch (quad->filter_length) {
+          case 4:
+            aom_lpf_vertical_4_quad(p, dst_stride, quad->mblim, quad->lim,
+                                    quad->hev_thr);
+            break;
+          case 6:
+            aom_lpf_vertical_6_quad(p, dst_stride, quad->mblim, quad->lim,
+                                    quad->hev_thr);
+            break;
+          case 8:
+            aom_lpf_vertical_8_quad(p, dst_stride, quad->mblim, quad->lim,
+                                    quad->hev_thr);
+            break;
+          case 14:
+            aom_lpf_vertical_14_quad(p, dst_stride, quad->mblim, quad->lim,
+                                     quad->hev_thr);
+            break;
+          default: assert(0);
+        }
+      } else {
+        for (int i = 0; i < LF_QUAD_UNITS; ++i)
+          filter_vert_edge(cm, plane, p + i * MI_SIZE * dst_stride,
+                           dst_stride, &params[i][x]);
       }
-      // advance the destination pointer
-      advance_units = tx_size_wide_unit[tx_size];
-      x += advance_units;
-      p += advance_units * MI_SIZE;
     }
   }
 }
 
-static void filter_block_plane_horz(const AV1_COMMON *const cm, const int plane,
-                                    const MACROBLOCKD_PLANE *const plane_ptr,
-                                    const uint32_t mi_row,
-                                    const uint32_t mi_col) {
-  const int col_step = MI_SIZE >> MI_SIZE_LOG2;
+void av1_filter_block_plane_horz(const AV1_COMMON *const cm, const int plane,
+                                 const MACROBLOCKD_PLANE *const plane_ptr,
+                                 const uint32_t mi_row, const uint32_t mi_col) {
   const uint32_t scale_horz = plane_ptr->subsampling_x;
   const uint32_t scale_vert = plane_ptr->subsampling_y;
   uint8_t *const dst_ptr = plane_ptr->dst.buf;
   const int dst_stride = plane_ptr->dst.stride;
   const int y_range = (MAX_MIB_SIZE >> scale_vert);
   const int x_range = (MAX_MIB_SIZE >> scale_horz);
-  for (int x = 0; x < x_range; x += col_step) {
-    uint8_t *p = dst_ptr + x * MI_SIZE;
-    for (int y = 0; y < y_range;) {
-      // inner loop always filter vertical edges in a MI block. If MI size
-      // is 8x8, it will first filter the vertical edge aligned with a 8x8
-      // block. If 4x4 trasnform is used, it will then filter the internal
-      // edge aligned with a 4x4 block
-      const uint32_t curr_x = ((mi_col * MI_SIZE) >> scale_horz) + x * MI_SIZE;
-      const uint32_t curr_y = ((mi_row * MI_SIZE) >> scale_vert) + y * MI_SIZE;
-      uint32_t advance_units;
-      TX_SIZE tx_size;
-      AV1_DEBLOCKING_PARAMETERS params;
-      memset(&params, 0, sizeof(params));
-
-      tx_size = set_lpf_parameters(&params, (cm->mi_stride << scale_vert), cm,
-                                   HORZ_EDGE, curr_x, curr_y, plane, plane_ptr);
-
-      switch (params.filter_length) {
-        // apply 4-tap filtering
-        case 4:
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_horizontal_4(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                        params.mblim, params.lim,
-                                        params.hev_thr, cm->bit_depth);
-          else
-            aom_lpf_horizontal_4(p, dst_stride, params.mblim, params.lim,
-                                 params.hev_thr);
-          break;
-        // apply 6-tap filtering
-        case 6:
-          assert(plane != 0);
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_horizontal_6_c(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                          params.mblim, params.lim,
-                                          params.hev_thr, cm->bit_depth);
-          else
-            aom_lpf_horizontal_6(p, dst_stride, params.mblim, params.lim,
-                                 params.hev_thr);
-          break;
-        // apply 8-tap filtering
-        case 8:
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_horizontal_8(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                        params.mblim, params.lim,
-                                        params.hev_thr, cm->bit_depth);
-          else
-            aom_lpf_horizontal_8(p, dst_stride, params.mblim, params.lim,
-                                 params.hev_thr);
-          break;
-        // apply 14-tap filtering
-        case 14:
-          if (cm->use_highbitdepth)
-            aom_highbd_lpf_horizontal_14(CONVERT_TO_SHORTPTR(p), dst_stride,
-                                         params.mblim, params.lim,
-                                         params.hev_thr, cm->bit_depth);
-          else
-            aom_lpf_horizontal_14(p, dst_stride, params.mblim, params.lim,
-                                  params.hev_thr);
-          break;
-        // no filtering
-        default: break;
+  // The edges of LF_QUAD_UNITS columns are gathered first so that runs of
+  // identical edges in a row can be filtered together.
+  AV1_DEBLOCKING_PARAMETERS params[LF_QUAD_UNITS][MAX_MIB_SIZE];
+  assert(x_range % LF_QUAD_UNITS == 0);
+  for (int x = 0; x < x_range; x += LF_QUAD_UNITS) {
+    memset(params, 0, sizeof(params));
+    for (int i = 0; i < LF_QUAD_UNITS; ++i) {
+      for (int y = 0; y < y_range;) {
+        // inner loop always filter vertical edges in a MI block. If MI size
+        // is 8x8, it will first filter the vertical edge aligned with a 8x8
+        // block. If 4x4 trasnform is used, it will then filter the internal
+        // edge aligned with a 4x4 block
+        const uint32_t curr_x =
+            ((mi_col * MI_SIZE) >> scale_horz) + (x + i) * MI_SIZE;
+        const uint32_t curr_y =
+            ((mi_row * MI_SIZE) >> scale_vert) + y * MI_SIZE;
+        const TX_SIZE tx_size = set_lpf_parameters(
+            &params[i][y], (cm->mi_stride << scale_vert), cm, HORZ_EDGE,
+            curr_x, curr_y, plane, plane_ptr);
+        y += tx_size_high_unit[tx_size];
       }
+    }
 
-      // advance the destination pointer
-      advance_units = tx_size_high_unit[tx_size];
-      y += advance_units;
-      p += advance_units * dst_stride * MI_SIZE;
+    uint8_t *p = dst_ptr + x * MI_SIZE;
+    for (int y = 0; y < y_range; ++y, p += MI_SIZE * dst_stride) {
+      const AV1_DEBLOCKING_PARAMETERS *const quad = &params[0][y];
+      if (can_filter_quad(cm, params, y)) {
+        switch (quad->filter_length) {
+          case 4:
+            aom_lpf_horizontal_4_quad(p, dst_stride, quad->mblim, quad->lim,
+                                      quad->hev_thr);
+            break;
+          case 6:
+            aom_lpf_horizontal_6_quad(p, dst_stride, quad->mblim, quad->lim,
+                                      quad->hev_thr);
+            break;
+          case 8:
+            aom_lpf_horizontal_8_quad(p, dst_stride, quad->mblim, quad->lim,
+                                      quad->hev_thr);
+            break;
+          case 14:
+            aom_lpf_horizontal_14_quad(p, dst_stride, quad->mblim, quad->lim,
+                                       quad->hev_thr);
+            break;
+          default: assert(0);
+        }
+      } else {
+        for (int i = 0; i < LF_QUAD_UNITS; ++i)
+          filter_horz_edge(cm, plane, p + i * MI_SIZE, dst_stride,
+                           &params[i][y]);
+      }
     }
   }
 }
@@ -1937,7 +2015,7 @@ void av1_loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer, AV1_COMMON *cm,
       av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer, mi_row,
                            mi_col, num_planes);
       for (plane = plane_start; plane < plane_end; ++plane) {
-        filter_block_plane_vert(cm, plane, &planes[plane], mi_row, mi_col);
+        av1_filter_block_plane_vert(cm, plane, &planes[plane], mi_row, mi_col);
       }
     }
   }
@@ -1948,7 +2026,7 @@ void av1_loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer, AV1_COMMON *cm,
       av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer, mi_row,
                            mi_col, num_planes);
       for (plane = plane_start; plane < plane_end; ++plane) {
-        filter_block_plane_horz(cm, plane, &planes[plane], mi_row, mi_col);
+        av1_filter_block_plane_horz(cm, plane, &planes[plane], mi_row, mi_col);
       }
     }
   }
@@ -149,7 +149,8 @@ typedef struct {
 
 typedef struct {
   loop_filter_thresh lfthr[MAX_LOOP_FILTER + 1];
-  uint8_t lvl[MAX_SEGMENTS][2][TOTAL_REFS_PER_FRAME][MAX_MODE_LF_DELTAS];
+  uint8_t lvl[MAX_MB_PLANE][MAX_SEGMENTS][2][TOTAL_REFS_PER_FRAME]
+             [MAX_MODE_LF_DELTAS];
 } loop_filter_info_n;
 
 // This structure holds bit masks for all 8x8 blocks in a 64x64 region.
@@ -203,6 +204,19 @@ void av1_loop_filter_rows(YV12_BUFFER_CONFIG *frame_buffer,
                           struct macroblockd_plane *planes, int start, int stop,
                           int y_only);
 
+// Filter the vertical / horizontal edges of one plane of the superblock at
+// (mi_row, mi_col). All vertical edges touching a superblock must be filtered
+// before its horizontal edges.
+void av1_filter_block_plane_vert(
+    const struct AV1Common *const cm, const int plane,
+    const struct macroblockd_plane *const plane_ptr, const uint32_t mi_row,
+    const uint32_t mi_col);
+
+void av1_filter_block_plane_horz(
+    const struct AV1Common *const cm, const int plane,
+    const struct macroblockd_plane *const plane_ptr, const uint32_t mi_row,
+    const uint32_t mi_col);
+
 typedef struct LoopFilterWorkerData {
   YV12_BUFFER_CONFIG *frame_buffer;
   struct AV1Common *cm;
@@ -592,6 +592,10 @@ typedef struct macroblockd {
 #endif
   struct aom_internal_error_info *error_info;
   const WarpedMotionParams *global_motion;
+  // CDEF strength already coded for each 64x64 unit of the current
+  // superblock, or -1 if not yet coded. Kept per MACROBLOCKD so that tiles
+  // can be coded concurrently.
+  int cdef_preset[4];
   int prev_qindex;
   int delta_qindex;
   int current_qindex;
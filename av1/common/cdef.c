@@ -106,9 +106,9 @@ void copy_rect8_16bit_to_16bit_c(uint16_t *dst, int dstride,
   }
 }
 
-static void copy_sb8_16(AOM_UNUSED AV1_COMMON *cm, uint16_t *dst, int dstride,
-                        const uint8_t *src, int src_voffset, int src_hoffset,
-                        int sstride, int vsize, int hsize) {
+static void copy_sb8_16(AOM_UNUSED const AV1_COMMON *cm, uint16_t *dst,
+                        int dstride, const uint8_t *src, int src_voffset,
+                        int src_hoffset, int sstride, int vsize, int hsize) {
   if (cm->use_highbitdepth) {
     const uint16_t *base =
         &CONVERT_TO_SHORTPTR(src)[src_voffset * sstride + src_hoffset];
@@ -137,17 +137,56 @@ static INLINE void copy_rect(uint16_t *dst, int dstride, const uint16_t *src,
   }
 }
 
-void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
-                    MACROBLOCKD *xd) {
+void av1_cdef_alloc_linebuf(AV1_COMMON *cm, CdefLineBuf *lb) {
   const int num_planes = av1_num_planes(cm);
-  DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
-  uint16_t *linebuf[3];
-  uint16_t *colbuf[3];
-  cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
-  unsigned char *row_cdef, *prev_row_cdef, *curr_row_cdef;
+  const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  lb->stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
+  for (int pli = 0; pli < num_planes; pli++) {
+    CHECK_MEM_ERROR(cm, lb->buf[pli],
+                    aom_malloc(sizeof(*lb->buf[pli]) * nvfb * 2 *
+                               CDEF_VBORDER * lb->stride));
+  }
+}
+
+void av1_cdef_free_linebuf(CdefLineBuf *lb) {
+  for (int pli = 0; pli < MAX_MB_PLANE; pli++) {
+    aom_free(lb->buf[pli]);
+    lb->buf[pli] = NULL;
+  }
+}
+
+void av1_cdef_save_linebuf_row(const AV1_COMMON *cm,
+                               const struct macroblockd_plane *planes,
+                               CdefLineBuf *lb, int fbr) {
+  const int num_planes = av1_num_planes(cm);
+  assert(fbr > 0);
+  for (int pli = 0; pli < num_planes; pli++) {
+    const int mi_wide_l2 = MI_SIZE_LOG2 - planes[pli].subsampling_x;
+    const int mi_high_l2 = MI_SIZE_LOG2 - planes[pli].subsampling_y;
+    const int hsize = cm->mi_cols << mi_wide_l2;
+    // Boundary fbr holds the CDEF_VBORDER rows on either side of the top
+    // edge of filter block row fbr.
+    copy_sb8_16(cm, cdef_linebuf_row(lb, pli, fbr, -CDEF_VBORDER), lb->stride,
+                planes[pli].dst.buf,
+                (MI_SIZE_64X64 << mi_high_l2) * fbr - CDEF_VBORDER, 0,
+                planes[pli].dst.stride, 2 * CDEF_VBORDER, hsize);
+  }
+}
+
+void av1_cdef_save_linebuf(const AV1_COMMON *cm,
+                           const struct macroblockd_plane *planes,
+                           CdefLineBuf *lb) {
+  const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  for (int fbr = 1; fbr < nvfb; fbr++)
+    av1_cdef_save_linebuf_row(cm, planes, lb, fbr);
+}
+
+void av1_cdef_fb_row(const AV1_COMMON *cm,
+                     const struct macroblockd_plane *planes,
+                     const CdefLineBuf *lb, CdefBlockData *bd, int fbr) {
+  const int num_planes = av1_num_planes(cm);
+  uint16_t *const src = bd->src;
   int cdef_count;
-  int dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
-  int var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
   int mi_wide_l2[3];
   int mi_high_l2[3];
   int xdec[3];
@@ -155,260 +194,240 @@ void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
   int coeff_shift = AOMMAX(cm->bit_depth - 8, 0);
   const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
   const int nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
-  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0,
-                       num_planes);
-  row_cdef = aom_malloc(sizeof(*row_cdef) * (nhfb + 2) * 2);
-  memset(row_cdef, 1, sizeof(*row_cdef) * (nhfb + 2) * 2);
-  prev_row_cdef = row_cdef + 1;
-  curr_row_cdef = prev_row_cdef + nhfb + 2;
   for (int pli = 0; pli < num_planes; pli++) {
-    xdec[pli] = xd->plane[pli].subsampling_x;
-    ydec[pli] = xd->plane[pli].subsampling_y;
-    mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
-    mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
+    xdec[pli] = planes[pli].subsampling_x;
+    ydec[pli] = planes[pli].subsampling_y;
+    mi_wide_l2[pli] = MI_SIZE_LOG2 - planes[pli].subsampling_x;
+    mi_high_l2[pli] = MI_SIZE_LOG2 - planes[pli].subsampling_y;
   }
-  const int stride = (cm->mi_cols << MI_SIZE_LOG2) + 2 * CDEF_HBORDER;
   for (int pli = 0; pli < num_planes; pli++) {
-    linebuf[pli] = aom_malloc(sizeof(*linebuf) * CDEF_VBORDER * stride);
-    colbuf[pli] =
-        aom_malloc(sizeof(*colbuf) *
-                   ((CDEF_BLOCKSIZE << mi_high_l2[pli]) + 2 * CDEF_VBORDER) *
-                   CDEF_HBORDER);
+    const int block_height =
+        (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
+    fill_rect(bd->colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
+              CDEF_VERY_LARGE);
   }
-  for (int fbr = 0; fbr < nvfb; fbr++) {
-    for (int pli = 0; pli < num_planes; pli++) {
-      const int block_height =
-          (MI_SIZE_64X64 << mi_high_l2[pli]) + 2 * CDEF_VBORDER;
-      fill_rect(colbuf[pli], CDEF_HBORDER, block_height, CDEF_HBORDER,
-                CDEF_VERY_LARGE);
+  int cdef_left = 1;
+  for (int fbc = 0; fbc < nhfb; fbc++) {
+    int level, sec_strength;
+    int uv_level, uv_sec_strength;
+    int nhb, nvb;
+    int cstart = 0;
+    if (cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc] == NULL ||
+        cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc]
+                ->mbmi.cdef_strength == -1) {
+      cdef_left = 0;
+      continue;
     }
-    int cdef_left = 1;
-    for (int fbc = 0; fbc < nhfb; fbc++) {
-      int level, sec_strength;
-      int uv_level, uv_sec_strength;
-      int nhb, nvb;
-      int cstart = 0;
-      curr_row_cdef[fbc] = 0;
-      if (cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
-                              MI_SIZE_64X64 * fbc] == NULL ||
-          cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
-                              MI_SIZE_64X64 * fbc]
-                  ->mbmi.cdef_strength == -1) {
-        cdef_left = 0;
-        continue;
+    if (!cdef_left) cstart = -CDEF_HBORDER;
+    nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
+    nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
+    int tile_top, tile_left, tile_bottom, tile_right;
+
+    int mi_row = MI_SIZE_64X64 * fbr;
+    int mi_col = MI_SIZE_64X64 * fbc;
+    int mi_idx_tl = mi_row * cm->mi_stride + mi_col;
+    int mi_idx_tr = mi_row * cm->mi_stride + (mi_col + MI_SIZE_64X64 - 1);
+    int mi_idx_bl = (mi_row + MI_SIZE_64X64 - 1) * cm->mi_stride + mi_col;
+    // for the current filter block, it's top left corner mi structure (mi_tl)
+    // is first accessed to check whether the top and left boundaries are
+    // tile boundaries. Then bottom-left and top-right mi structures are
+    // accessed to check whether the bottom and right boundaries
+    // (respectively) are tile boundaries.
+    //
+    // Note that we can't just check the bottom-right mi structure - eg. if
+    // we're at the right-hand edge of the frame but not the bottom, then
+    // the bottom-right mi is NULL but the bottom-left is not.
+    //
+    // We assume the boundary information is set correctly based on the
+    // loop_filter_across_tiles_enabled flag, i.e, if this flag is set to 1,
+    // then boundary_info should not be treated as tile boundaries. Also
+    // assume CDEF filter block size is 64x64.
+    BOUNDARY_TYPE *const bi_tl = cm->boundary_info + mi_idx_tl;
+    BOUNDARY_TYPE *const bi_tr = cm->boundary_info + mi_idx_tr;
+    BOUNDARY_TYPE *const bi_bl = cm->boundary_info + mi_idx_bl;
+    BOUNDARY_TYPE boundary_tl = *bi_tl;
+    tile_top = boundary_tl & TILE_ABOVE_BOUNDARY;
+    tile_left = boundary_tl & TILE_LEFT_BOUNDARY;
+
+    if (fbr != nvfb - 1 && bi_bl)
+      tile_bottom = *bi_bl & TILE_BOTTOM_BOUNDARY;
+    else
+      tile_bottom = 1;
+
+    if (fbc != nhfb - 1 && bi_tr)
+      tile_right = *bi_tr & TILE_RIGHT_BOUNDARY;
+    else
+      tile_right = 1;
+
+    const int mbmi_cdef_strength =
+        cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc]
+            ->mbmi.cdef_strength;
+    level = cm->cdef_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+    sec_strength = cm->cdef_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+    sec_strength += sec_strength == 3;
+    uv_level = cm->cdef_uv_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
+    uv_sec_strength =
+        cm->cdef_uv_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
+    uv_sec_strength += uv_sec_strength == 3;
+    if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
+         uv_sec_strength == 0) ||
+        (cdef_count = sb_compute_cdef_list(cm, fbr * MI_SIZE_64X64,
+                                           fbc * MI_SIZE_64X64, bd->dlist,
+                                           BLOCK_64X64)) == 0) {
+      cdef_left = 0;
+      continue;
+    }
+
+    for (int pli = 0; pli < num_planes; pli++) {
+      int coffset;
+      int rend, cend;
+      int pri_damping = cm->cdef_pri_damping;
+      int sec_damping = cm->cdef_sec_damping;
+      int hsize = nhb << mi_wide_l2[pli];
+      int vsize = nvb << mi_high_l2[pli];
+
+      if (pli) {
+        level = uv_level;
+        sec_strength = uv_sec_strength;
       }
-      if (!cdef_left) cstart = -CDEF_HBORDER;
-      nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
-      nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
-      int tile_top, tile_left, tile_bottom, tile_right;
-
-      int mi_row = MI_SIZE_64X64 * fbr;
-      int mi_col = MI_SIZE_64X64 * fbc;
-      int mi_idx_tl = mi_row * cm->mi_stride + mi_col;
-      int mi_idx_tr = mi_row * cm->mi_stride + (mi_col + MI_SIZE_64X64 - 1);
-      int mi_idx_bl = (mi_row + MI_SIZE_64X64 - 1) * cm->mi_stride + mi_col;
-      // for the current filter block, it's top left corner mi structure (mi_tl)
-      // is first accessed to check whether the top and left boundaries are
-      // tile boundaries. Then bottom-left and top-right mi structures are
-      // accessed to check whether the bottom and right boundaries
-      // (respectively) are tile boundaries.
-      //
-      // Note that we can't just check the bottom-right mi structure - eg. if
-      // we're at the right-hand edge of the frame but not the bottom, then
-      // the bottom-right mi is NULL but the bottom-left is not.
-      //
-      // We assume the boundary information is set correctly based on the
-      // loop_filter_across_tiles_enabled flag, i.e, if this flag is set to 1,
-      // then boundary_info should not be treated as tile boundaries. Also
-      // assume CDEF filter block size is 64x64.
-      BOUNDARY_TYPE *const bi_tl = cm->boundary_info + mi_idx_tl;
-      BOUNDARY_TYPE *const bi_tr = cm->boundary_info + mi_idx_tr;
-      BOUNDARY_TYPE *const bi_bl = cm->boundary_info + mi_idx_bl;
-      BOUNDARY_TYPE boundary_tl = *bi_tl;
-      tile_top = boundary_tl & TILE_ABOVE_BOUNDARY;
-      tile_left = boundary_tl & TILE_LEFT_BOUNDARY;
-
-      if (fbr != nvfb - 1 && bi_bl)
-        tile_bottom = *bi_bl & TILE_BOTTOM_BOUNDARY;
+
+      if (fbc == nhfb - 1)
+        cend = hsize;
       else
-        tile_bottom = 1;
+        cend = hsize + CDEF_HBORDER;
 
-      if (fbc != nhfb - 1 && bi_tr)
-        tile_right = *bi_tr & TILE_RIGHT_BOUNDARY;
+      if (fbr == nvfb - 1)
+        rend = vsize;
       else
-        tile_right = 1;
-
-      const int mbmi_cdef_strength =
-          cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
-                              MI_SIZE_64X64 * fbc]
-              ->mbmi.cdef_strength;
-      level = cm->cdef_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-      sec_strength =
-          cm->cdef_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-      sec_strength += sec_strength == 3;
-      uv_level = cm->cdef_uv_strengths[mbmi_cdef_strength] / CDEF_SEC_STRENGTHS;
-      uv_sec_strength =
-          cm->cdef_uv_strengths[mbmi_cdef_strength] % CDEF_SEC_STRENGTHS;
-      uv_sec_strength += uv_sec_strength == 3;
-      if ((level == 0 && sec_strength == 0 && uv_level == 0 &&
-           uv_sec_strength == 0) ||
-          (cdef_count = sb_compute_cdef_list(cm, fbr * MI_SIZE_64X64,
-                                             fbc * MI_SIZE_64X64, dlist,
-                                             BLOCK_64X64)) == 0) {
-        cdef_left = 0;
-        continue;
-      }
+        rend = vsize + CDEF_VBORDER;
 
-      curr_row_cdef[fbc] = 1;
-      for (int pli = 0; pli < num_planes; pli++) {
-        int coffset;
-        int rend, cend;
-        int pri_damping = cm->cdef_pri_damping;
-        int sec_damping = cm->cdef_sec_damping;
-        int hsize = nhb << mi_wide_l2[pli];
-        int vsize = nvb << mi_high_l2[pli];
-
-        if (pli) {
-          level = uv_level;
-          sec_strength = uv_sec_strength;
-        }
-
-        if (fbc == nhfb - 1)
-          cend = hsize;
-        else
-          cend = hsize + CDEF_HBORDER;
-
-        if (fbr == nvfb - 1)
-          rend = vsize;
-        else
-          rend = vsize + CDEF_VBORDER;
-
-        coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-        if (fbc == nhfb - 1) {
-          /* On the last superblock column, fill in the right border with
-             CDEF_VERY_LARGE to avoid filtering with the outside. */
-          fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
-                    rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
-                    CDEF_VERY_LARGE);
-        }
-        if (fbr == nvfb - 1) {
-          /* On the last superblock row, fill in the bottom border with
-             CDEF_VERY_LARGE to avoid filtering with the outside. */
-          fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        /* Copy in the pixels we need from the current superblock for
-           deringing.*/
-        copy_sb8_16(cm,
-                    &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
-                    CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                    (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
-                    xd->plane[pli].dst.stride, rend, cend - cstart);
-        if (!prev_row_cdef[fbc]) {
-          copy_sb8_16(cm, &src[CDEF_HBORDER], CDEF_BSTRIDE,
-                      xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset, xd->plane[pli].dst.stride, CDEF_VBORDER, hsize);
-        } else if (fbr > 0) {
-          copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, &linebuf[pli][coffset],
-                    stride, CDEF_VBORDER, hsize);
-        } else {
-          fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
-                    CDEF_VERY_LARGE);
-        }
-        if (!prev_row_cdef[fbc - 1]) {
-          copy_sb8_16(cm, src, CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset - CDEF_HBORDER, xd->plane[pli].dst.stride,
-                      CDEF_VBORDER, CDEF_HBORDER);
-        } else if (fbr > 0 && fbc > 0) {
-          copy_rect(src, CDEF_BSTRIDE, &linebuf[pli][coffset - CDEF_HBORDER],
-                    stride, CDEF_VBORDER, CDEF_HBORDER);
-        } else {
-          fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (!prev_row_cdef[fbc + 1]) {
-          copy_sb8_16(cm, &src[CDEF_HBORDER + (nhb << mi_wide_l2[pli])],
-                      CDEF_BSTRIDE, xd->plane[pli].dst.buf,
-                      (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr - CDEF_VBORDER,
-                      coffset + hsize, xd->plane[pli].dst.stride, CDEF_VBORDER,
-                      CDEF_HBORDER);
-        } else if (fbr > 0 && fbc < nhfb - 1) {
-          copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                    &linebuf[pli][coffset + hsize], stride, CDEF_VBORDER,
-                    CDEF_HBORDER);
-        } else {
-          fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
-                    CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        if (cdef_left) {
-          /* If we deringed the superblock on the left then we need to copy in
-             saved pixels. */
-          copy_rect(src, CDEF_BSTRIDE, colbuf[pli], CDEF_HBORDER,
-                    rend + CDEF_VBORDER, CDEF_HBORDER);
-        }
-        /* Saving pixels in case we need to dering the superblock on the
-            right. */
-        copy_rect(colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+      coffset = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
+      if (fbc == nhfb - 1) {
+        /* On the last superblock column, fill in the right border with
+           CDEF_VERY_LARGE to avoid filtering with the outside. */
+        fill_rect(&src[cend + CDEF_HBORDER], CDEF_BSTRIDE,
+                  rend + CDEF_VBORDER, hsize + CDEF_HBORDER - cend,
+                  CDEF_VERY_LARGE);
+      }
+      if (fbr == nvfb - 1) {
+        /* On the last superblock row, fill in the bottom border with
+           CDEF_VERY_LARGE to avoid filtering with the outside. */
+        fill_rect(&src[(rend + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                  CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      /* Copy in the pixels we need from the current superblock for
+         deringing. The rows below it come from the saved lines, as the next
+         filter block row may already have been filtered. */
+      copy_sb8_16(cm, &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER + cstart],
+                  CDEF_BSTRIDE, planes[pli].dst.buf,
+                  (MI_SIZE_64X64 << mi_high_l2[pli]) * fbr, coffset + cstart,
+                  planes[pli].dst.stride, vsize, cend - cstart);
+      if (fbr < nvfb - 1) {
+        copy_rect(&src[(CDEF_VBORDER + vsize) * CDEF_BSTRIDE + CDEF_HBORDER +
+                       cstart],
+                  CDEF_BSTRIDE,
+                  cdef_linebuf_row(lb, pli, fbr + 1, 0) + coffset + cstart,
+                  lb->stride, CDEF_VBORDER, cend - cstart);
+      }
+      if (fbr > 0) {
+        copy_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE,
+                  cdef_linebuf_row(lb, pli, fbr, -CDEF_VBORDER) + coffset,
+                  lb->stride, CDEF_VBORDER, hsize);
+      } else {
+        fill_rect(&src[CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER, hsize,
+                  CDEF_VERY_LARGE);
+      }
+      if (fbr > 0 && fbc > 0) {
+        copy_rect(src, CDEF_BSTRIDE,
+                  cdef_linebuf_row(lb, pli, fbr, -CDEF_VBORDER) + coffset -
+                      CDEF_HBORDER,
+                  lb->stride, CDEF_VBORDER, CDEF_HBORDER);
+      } else {
+        fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (fbr > 0 && fbc < nhfb - 1) {
+        copy_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                  cdef_linebuf_row(lb, pli, fbr, -CDEF_VBORDER) + coffset +
+                      hsize,
+                  lb->stride, CDEF_VBORDER, CDEF_HBORDER);
+      } else {
+        fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE, CDEF_VBORDER,
+                  CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      if (cdef_left) {
+        /* If we deringed the superblock on the left then we need to copy in
+           saved pixels. */
+        copy_rect(src, CDEF_BSTRIDE, bd->colbuf[pli], CDEF_HBORDER,
                   rend + CDEF_VBORDER, CDEF_HBORDER);
-        copy_sb8_16(
-            cm, &linebuf[pli][coffset], stride, xd->plane[pli].dst.buf,
-            (MI_SIZE_64X64 << mi_high_l2[pli]) * (fbr + 1) - CDEF_VBORDER,
-            coffset, xd->plane[pli].dst.stride, CDEF_VBORDER, hsize);
-
-        if (tile_top) {
-          fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (tile_left) {
-          fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
-                    CDEF_VERY_LARGE);
-        }
-        if (tile_bottom) {
-          fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
-                    CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-        if (tile_right) {
-          fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
-                    vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
-        }
-
-        if (cm->use_highbitdepth) {
-          cdef_filter_fb(
-              NULL,
-              &CONVERT_TO_SHORTPTR(
-                  xd->plane[pli]
-                      .dst.buf)[xd->plane[pli].dst.stride *
-                                    (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                                (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-              xd->plane[pli].dst.stride,
-              &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-              ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-              sec_strength, pri_damping, sec_damping, coeff_shift);
-        } else {
-          cdef_filter_fb(
-              &xd->plane[pli]
-                   .dst.buf[xd->plane[pli].dst.stride *
-                                (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
-                            (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
-              NULL, xd->plane[pli].dst.stride,
-              &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
-              ydec[pli], dir, NULL, var, pli, dlist, cdef_count, level,
-              sec_strength, pri_damping, sec_damping, coeff_shift);
-        }
       }
-      cdef_left = 1;
-    }
-    {
-      unsigned char *tmp = prev_row_cdef;
-      prev_row_cdef = curr_row_cdef;
-      curr_row_cdef = tmp;
+      /* Saving pixels in case we need to dering the superblock on the
+          right. */
+      copy_rect(bd->colbuf[pli], CDEF_HBORDER, src + hsize, CDEF_BSTRIDE,
+                rend + CDEF_VBORDER, CDEF_HBORDER);
+
+      if (tile_top) {
+        fill_rect(src, CDEF_BSTRIDE, CDEF_VBORDER, hsize + 2 * CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (tile_left) {
+        fill_rect(src, CDEF_BSTRIDE, vsize + 2 * CDEF_VBORDER, CDEF_HBORDER,
+                  CDEF_VERY_LARGE);
+      }
+      if (tile_bottom) {
+        fill_rect(&src[(vsize + CDEF_VBORDER) * CDEF_BSTRIDE], CDEF_BSTRIDE,
+                  CDEF_VBORDER, hsize + 2 * CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+      if (tile_right) {
+        fill_rect(&src[hsize + CDEF_HBORDER], CDEF_BSTRIDE,
+                  vsize + 2 * CDEF_VBORDER, CDEF_HBORDER, CDEF_VERY_LARGE);
+      }
+
+      if (cm->use_highbitdepth) {
+        cdef_filter_fb(
+            NULL,
+            &CONVERT_TO_SHORTPTR(
+                planes[pli].dst.buf)[planes[pli].dst.stride *
+                                         (MI_SIZE_64X64 * fbr
+                                          << mi_high_l2[pli]) +
+                                     (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+            planes[pli].dst.stride,
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+            ydec[pli], bd->dir, NULL, bd->var, pli, bd->dlist, cdef_count,
+            level, sec_strength, pri_damping, sec_damping, coeff_shift);
+      } else {
+        cdef_filter_fb(
+            &planes[pli].dst.buf[planes[pli].dst.stride *
+                                     (MI_SIZE_64X64 * fbr << mi_high_l2[pli]) +
+                                 (fbc * MI_SIZE_64X64 << mi_wide_l2[pli])],
+            NULL, planes[pli].dst.stride,
+            &src[CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER], xdec[pli],
+            ydec[pli], bd->dir, NULL, bd->var, pli, bd->dlist, cdef_count,
+            level, sec_strength, pri_damping, sec_damping, coeff_shift);
+      }
     }
+    cdef_left = 1;
   }
-  aom_free(row_cdef);
-  for (int pli = 0; pli < num_planes; pli++) {
-    aom_free(linebuf[pli]);
-    aom_free(colbuf[pli]);
+}
+
+void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                    MACROBLOCKD *xd) {
+  const int num_planes = av1_num_planes(cm);
+  const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  CdefLineBuf lb;
+  CdefBlockData bd;
+  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0,
+                       num_planes);
+  av1_zero(lb);
+  av1_zero(bd.dir);
+  av1_zero(bd.var);
+  av1_cdef_alloc_linebuf(cm, &lb);
+  av1_cdef_save_linebuf(cm, xd->plane, &lb);
+  for (int fbr = 0; fbr < nvfb; fbr++) {
+    av1_cdef_fb_row(cm, xd->plane, &lb, &bd, fbr);
   }
+  av1_cdef_free_linebuf(&lb);
 }
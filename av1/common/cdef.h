@@ -36,11 +36,53 @@ static INLINE int constrain(int diff, int threshold, int damping) {
 extern "C" {
 #endif
 
+// Pre-CDEF copy of the CDEF_VBORDER rows on either side of the top edge of
+// every 64x64 filter block row, so that the rows can be filtered in any order.
+typedef struct CdefLineBuf {
+  uint16_t *buf[MAX_MB_PLANE];
+  int stride;
+} CdefLineBuf;
+
+// Scratch buffers of one thread filtering 64x64 filter block rows.
+typedef struct CdefBlockData {
+  DECLARE_ALIGNED(16, uint16_t, src[CDEF_INBUF_SIZE]);
+  uint16_t colbuf[MAX_MB_PLANE]
+                 [(CDEF_BLOCKSIZE + 2 * CDEF_VBORDER) * CDEF_HBORDER];
+  cdef_list dlist[MI_SIZE_64X64 * MI_SIZE_64X64];
+  int dir[CDEF_NBLOCKS][CDEF_NBLOCKS];
+  int var[CDEF_NBLOCKS][CDEF_NBLOCKS];
+} CdefBlockData;
+
+// Returns row 'offset' (in [-CDEF_VBORDER, CDEF_VBORDER)) relative to the top
+// edge of filter block row fbr.
+static INLINE uint16_t *cdef_linebuf_row(const CdefLineBuf *lb, int pli,
+                                         int fbr, int offset) {
+  return lb->buf[pli] +
+         ((2 * fbr - 1) * CDEF_VBORDER + offset) * lb->stride;
+}
+
 int sb_all_skip(const AV1_COMMON *const cm, int mi_row, int mi_col);
 int sb_compute_cdef_list(const AV1_COMMON *const cm, int mi_row, int mi_col,
                          cdef_list *dlist, BLOCK_SIZE bsize);
 void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, MACROBLOCKD *xd);
 
+void av1_cdef_alloc_linebuf(AV1_COMMON *cm, CdefLineBuf *lb);
+void av1_cdef_free_linebuf(CdefLineBuf *lb);
+// Saves the lines around each filter block row boundary. Must be called
+// before any filter block row is filtered.
+void av1_cdef_save_linebuf(const AV1_COMMON *cm,
+                           const struct macroblockd_plane *planes,
+                           CdefLineBuf *lb);
+// Saves the lines around the top edge of filter block row fbr (fbr > 0).
+// Must be called before filter block row fbr - 1 or fbr is filtered.
+void av1_cdef_save_linebuf_row(const AV1_COMMON *cm,
+                               const struct macroblockd_plane *planes,
+                               CdefLineBuf *lb, int fbr);
+// Filters filter block row fbr of the frame set up in planes.
+void av1_cdef_fb_row(const AV1_COMMON *cm,
+                     const struct macroblockd_plane *planes,
+                     const CdefLineBuf *lb, CdefBlockData *bd, int fbr);
+
 void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
                      AV1_COMMON *cm, MACROBLOCKD *xd, int fast);
 
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <limits.h>
+
+#include "./aom_config.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "av1/common/av1_loopfilter.h"
+#include "av1/common/postfilter.h"
+#include "av1/common/reconinter.h"
+#include "av1/common/resize.h"
+
+// The top edges of a superblock row are deblocked together with that row,
+// and may modify up to 6 luma rows of the superblock row above.
+#define LF_PENDING_ROWS 8
+
+int av1_post_filter_supported(const AV1_COMMON *cm) {
+#if LOOP_FILTER_BITMASK
+  (void)cm;
+  return 0;
+#else
+  return av1_superres_unscaled(cm) && !cm->large_scale_tile;
+#endif  // LOOP_FILTER_BITMASK
+}
+
+void av1_post_filter_init(AV1PostFilter *pf, YV12_BUFFER_CONFIG *frame,
+                          AV1_COMMON *cm) {
+  const int num_planes = av1_num_planes(cm);
+  const struct loopfilter *const lf = &cm->lf;
+  int do_lr = 0;
+
+  assert(av1_post_filter_supported(cm));
+  pf->frame = frame;
+
+  av1_zero(pf->lf_plane);
+  if (lf->filter_level[0] || lf->filter_level[1]) {
+    pf->lf_plane[0] = 1;
+    av1_loop_filter_frame_init(cm, lf->filter_level[0], lf->filter_level[1],
+                               0);
+    if (num_planes > 1 && lf->filter_level_u) {
+      pf->lf_plane[1] = 1;
+      av1_loop_filter_frame_init(cm, lf->filter_level_u, lf->filter_level_u,
+                                 1);
+    }
+    if (num_planes > 1 && lf->filter_level_v) {
+      pf->lf_plane[2] = 1;
+      av1_loop_filter_frame_init(cm, lf->filter_level_v, lf->filter_level_v,
+                                 2);
+    }
+  }
+
+  pf->do_cdef =
+      !cm->skip_loop_filter && !cm->all_lossless &&
+      (cm->cdef_bits || cm->cdef_strengths[0] || cm->cdef_uv_strengths[0]);
+
+  for (int plane = 0; plane < MAX_MB_PLANE; ++plane) {
+    pf->lr_plane[plane] =
+        plane < num_planes &&
+        cm->rst_info[plane].frame_restoration_type != RESTORE_NONE;
+    do_lr |= pf->lr_plane[plane];
+    pf->cdef_rows[plane] = 0;
+    pf->lr_tile_row[plane] = 0;
+    pf->lr_tile_unit_row[plane] = 0;
+    pf->lr_y0[plane] = 0;
+    pf->lr_copied_rows[plane] = 0;
+  }
+  pf->lf_mi_row = 0;
+  pf->fbr = 0;
+
+  av1_cdef_free_linebuf(&pf->cdef_linebuf);
+  if (pf->do_cdef) {
+    av1_cdef_alloc_linebuf(cm, &pf->cdef_linebuf);
+    av1_zero(pf->cdef_data.dir);
+    av1_zero(pf->cdef_data.var);
+  }
+  // The planes are extended a few rows at a time, as they become final.
+  if (do_lr) av1_loop_restoration_filter_frame_init(&pf->lr_ctxt, frame, cm, 0);
+}
+
+void av1_post_filter_free(AV1PostFilter *pf) {
+  av1_cdef_free_linebuf(&pf->cdef_linebuf);
+}
+
+static void deblock_sb_row(const AV1PostFilter *pf, const AV1_COMMON *cm,
+                           struct macroblockd_plane *planes, int mi_row) {
+  const int num_planes = av1_num_planes(cm);
+
+  if (!pf->lf_plane[0]) return;
+
+  // All vertical edges of the row must be filtered before the horizontal
+  // ones.
+  for (int dir = 0; dir < 2; ++dir) {
+    for (int mi_col = 0; mi_col < cm->mi_cols; mi_col += MAX_MIB_SIZE) {
+      av1_setup_dst_planes(planes, cm->seq_params.sb_size, pf->frame, mi_row,
+                           mi_col, num_planes);
+      for (int plane = 0; plane < num_planes; ++plane) {
+        if (!pf->lf_plane[plane]) continue;
+        if (dir == 0)
+          av1_filter_block_plane_vert(cm, plane, &planes[plane], mi_row,
+                                      mi_col);
+        else
+          av1_filter_block_plane_horz(cm, plane, &planes[plane], mi_row,
+                                      mi_col);
+      }
+    }
+  }
+}
+
+static void filter_fb_row(AV1PostFilter *pf, AV1_COMMON *cm,
+                          struct macroblockd_plane *planes, int fbr,
+                          int nvfb) {
+  const int num_planes = av1_num_planes(cm);
+  const int last = fbr == nvfb - 1;
+  YV12_BUFFER_CONFIG *const frame = pf->frame;
+  const int luma_start = fbr * MI_SIZE_64X64 << MI_SIZE_LOG2;
+  const int luma_end = (fbr + 1) * MI_SIZE_64X64 << MI_SIZE_LOG2;
+  int row_start[MAX_MB_PLANE], row_end[MAX_MB_PLANE];
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    const int ss_y = plane > 0 && cm->subsampling_y;
+    row_start[plane] = luma_start >> ss_y;
+    row_end[plane] = last ? INT_MAX : luma_end >> ss_y;
+  }
+
+  // Save the deblocked lines CDEF and loop restoration need from this row
+  // before CDEF overwrites them.
+  if (pf->do_cdef) {
+    av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame, 0, 0,
+                         num_planes);
+    if (!last)
+      av1_cdef_save_linebuf_row(cm, planes, &pf->cdef_linebuf, fbr + 1);
+  }
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (!pf->lr_plane[plane]) continue;
+    av1_loop_restoration_save_boundary_lines_rows(
+        frame, cm, plane, row_start[plane], row_end[plane], 0);
+  }
+
+  if (pf->do_cdef)
+    av1_cdef_fb_row(cm, planes, &pf->cdef_linebuf, &pf->cdef_data, fbr);
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (!pf->lr_plane[plane]) continue;
+    const int is_uv = plane > 0;
+    const int plane_height = frame->crop_heights[is_uv];
+
+    av1_loop_restoration_save_boundary_lines_rows(
+        frame, cm, plane, row_start[plane], row_end[plane], 1);
+    av1_extend_frame_rows(frame->buffers[plane], frame->crop_widths[is_uv],
+                          plane_height, frame->strides[is_uv],
+                          RESTORATION_BORDER, RESTORATION_BORDER,
+                          AOMMIN(row_start[plane], plane_height),
+                          AOMMIN(row_end[plane], plane_height),
+                          cm->use_highbitdepth);
+    pf->cdef_rows[plane] = row_end[plane];
+  }
+}
+
+static void filter_unit(const RestorationTileLimits *limits,
+                        const AV1PixelRect *tile_rect, int rest_unit_idx,
+                        void *priv) {
+  const FilterFrameCtxt *const ctxt = (const FilterFrameCtxt *)priv;
+  const RestorationInfo *const rsi = ctxt->rsi;
+
+  av1_loop_restoration_filter_unit(
+      limits, &rsi->unit_info[rest_unit_idx], &rsi->boundaries, ctxt->rlbs,
+      tile_rect, ctxt->tile_stripe0, ctxt->ss_x, ctxt->ss_y, ctxt->highbd,
+      ctxt->bit_depth, ctxt->data8, ctxt->data_stride, ctxt->dst8,
+      ctxt->dst_stride, ctxt->tmpbuf);
+}
+
+static void restore_unit_rows(AV1PostFilter *pf, const AV1_COMMON *cm,
+                              int plane) {
+  const RestorationInfo *const rsi = &cm->rst_info[plane];
+  const int is_uv = plane > 0;
+  const int ss_y = is_uv && cm->subsampling_y;
+  const int unit_size = rsi->restoration_unit_size;
+  const int ext_size = unit_size * 3 / 2;
+  const int voffset = RESTORATION_UNIT_OFFSET >> ss_y;
+  FilterFrameCtxt *const ctxt = &pf->lr_ctxt.ctxt[plane];
+  TileInfo tile_info;
+
+  while (pf->lr_tile_row[plane] < cm->tile_rows) {
+    const int tile_row = pf->lr_tile_row[plane];
+    av1_tile_set_row(&tile_info, cm, tile_row);
+    av1_tile_set_col(&tile_info, cm, 0);
+    const AV1PixelRect row_rect = av1_get_tile_rect(&tile_info, cm, is_uv);
+    const int tile_h = row_rect.bottom - row_rect.top;
+    const int y0 = pf->lr_y0[plane];
+
+    if (y0 >= tile_h) {
+      ++pf->lr_tile_row[plane];
+      pf->lr_tile_unit_row[plane] = 0;
+      pf->lr_y0[plane] = 0;
+      continue;
+    }
+
+    const int remaining_h = tile_h - y0;
+    const int h = (remaining_h < ext_size) ? remaining_h : unit_size;
+    RestorationTileLimits limits;
+    limits.v_start = AOMMAX(row_rect.top, row_rect.top + y0 - voffset);
+    limits.v_end = row_rect.top + y0 + h;
+    if (limits.v_end < row_rect.bottom) limits.v_end -= voffset;
+
+    // The stripes of the unit row read RESTORATION_BORDER rows below it.
+    if (limits.v_end + RESTORATION_BORDER > pf->cdef_rows[plane]) break;
+
+    ctxt->tile_stripe0 = (tile_row == 0) ? 0 : cm->rst_end_stripe[tile_row - 1];
+    for (int tile_col = 0; tile_col < cm->tile_cols; ++tile_col) {
+      av1_tile_set_col(&tile_info, cm, tile_col);
+      const AV1PixelRect tile_rect = av1_get_tile_rect(&tile_info, cm, is_uv);
+      const int tile_idx = tile_col + tile_row * cm->tile_cols;
+      const int unit_idx0 =
+          tile_idx * rsi->units_per_tile +
+          pf->lr_tile_unit_row[plane] * rsi->horz_units_per_tile;
+      av1_foreach_rest_unit_in_row(&limits, &tile_rect, unit_idx0, unit_size,
+                                   filter_unit, ctxt);
+    }
+
+    // The first unit row of the next tile row reads the unfiltered
+    // RESTORATION_BORDER rows above it, so hold those back.
+    const int copy_end = limits.v_end - RESTORATION_BORDER;
+    av1_loop_restoration_copy_rows(&pf->lr_ctxt, plane,
+                                   pf->lr_copied_rows[plane], copy_end);
+    pf->lr_copied_rows[plane] = AOMMAX(pf->lr_copied_rows[plane], copy_end);
+
+    pf->lr_y0[plane] += h;
+    ++pf->lr_tile_unit_row[plane];
+  }
+
+  if (pf->lr_tile_row[plane] == cm->tile_rows) {
+    av1_loop_restoration_copy_rows(&pf->lr_ctxt, plane,
+                                   pf->lr_copied_rows[plane], INT_MAX);
+    pf->lr_copied_rows[plane] = INT_MAX;
+  }
+}
+
+// Returns the number of luma rows which deblocking will not change anymore.
+static int deblocked_rows(const AV1PostFilter *pf, const AV1_COMMON *cm) {
+  return (pf->lf_mi_row >= cm->mi_rows)
+             ? INT_MAX
+             : (pf->lf_mi_row << MI_SIZE_LOG2) - LF_PENDING_ROWS;
+}
+
+void av1_post_filter_rows(AV1PostFilter *pf, AV1_COMMON *cm,
+                          struct macroblockd *xd, int decoded_mi_rows) {
+  const int num_planes = av1_num_planes(cm);
+  const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+
+  // Deblocking changes the bottom line of a superblock row, which intra
+  // prediction in the next superblock row reads, so it has to wait for the
+  // next row to be decoded.
+  while (pf->lf_mi_row < cm->mi_rows) {
+    const int mi_row_end = pf->lf_mi_row + MAX_MIB_SIZE;
+    if (AOMMIN(mi_row_end + cm->seq_params.mib_size, cm->mi_rows) >
+        decoded_mi_rows)
+      break;
+    deblock_sb_row(pf, cm, xd->plane, pf->lf_mi_row);
+    pf->lf_mi_row = mi_row_end;
+  }
+  const int lf_rows = deblocked_rows(pf, cm);
+
+  // CDEF of a filter block row reads CDEF_VBORDER rows below it (twice as
+  // many luma rows for subsampled chroma).
+  while (pf->fbr < nvfb) {
+    const int rows_needed =
+        (pf->fbr == nvfb - 1)
+            ? INT_MAX
+            : ((pf->fbr + 1) * MI_SIZE_64X64 << MI_SIZE_LOG2) +
+                  2 * CDEF_VBORDER;
+    if (rows_needed > lf_rows) break;
+    filter_fb_row(pf, cm, xd->plane, pf->fbr, nvfb);
+    ++pf->fbr;
+  }
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (pf->lr_plane[plane]) restore_unit_rows(pf, cm, plane);
+  }
+}
+
+int av1_post_filter_final_rows(const AV1PostFilter *pf, const AV1_COMMON *cm) {
+  const int num_planes = av1_num_planes(cm);
+  const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  int rows = INT_MAX;
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    const int ss_y = plane > 0 && cm->subsampling_y;
+    int plane_rows;
+    if (pf->lr_plane[plane]) {
+      plane_rows = pf->lr_copied_rows[plane];
+      if (plane_rows != INT_MAX) plane_rows <<= ss_y;
+    } else if (pf->do_cdef) {
+      plane_rows = (pf->fbr >= nvfb)
+                       ? INT_MAX
+                       : pf->fbr * MI_SIZE_64X64 << MI_SIZE_LOG2;
+    } else {
+      plane_rows = deblocked_rows(pf, cm);
+    }
+    rows = AOMMIN(rows, plane_rows);
+  }
+  return AOMMAX(rows, 0);
+}
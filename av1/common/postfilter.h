@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AV1_COMMON_POSTFILTER_H_
+#define AV1_COMMON_POSTFILTER_H_
+
+#include "./aom_config.h"
+#include "av1/common/cdef.h"
+#include "av1/common/onyxc_int.h"
+#include "av1/common/restoration.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Row-pipelined post-processing of a frame. Instead of deblocking, CDEF and
+// loop restoration each making a pass over the whole frame, the three filters
+// are run on a sliding window of superblock rows which trails the decoded
+// rows, so that each row is still in cache when the next filter reaches it.
+// The output is identical to running the three filters one after the other.
+//
+// Superres is not supported, since it needs the whole frame to be upscaled
+// between CDEF and loop restoration.
+typedef struct AV1PostFilter {
+  YV12_BUFFER_CONFIG *frame;
+  int lf_plane[MAX_MB_PLANE];  // Set for the planes which are deblocked.
+  int do_cdef;
+  int lr_plane[MAX_MB_PLANE];  // Set for the planes which use restoration.
+
+  // Next superblock row (in mi units) to deblock.
+  int lf_mi_row;
+  // Next 64x64 filter block row to run CDEF on.
+  int fbr;
+  // Number of rows of each plane which are final after CDEF.
+  int cdef_rows[MAX_MB_PLANE];
+  // Position of the next restoration unit row of each plane.
+  int lr_tile_row[MAX_MB_PLANE];
+  int lr_tile_unit_row[MAX_MB_PLANE];
+  int lr_y0[MAX_MB_PLANE];
+  // Number of rows of each plane copied back from the restoration output.
+  int lr_copied_rows[MAX_MB_PLANE];
+
+  CdefLineBuf cdef_linebuf;
+  CdefBlockData cdef_data;
+  AV1LrStruct lr_ctxt;
+} AV1PostFilter;
+
+// Returns 1 if the post-processing of the current frame can be pipelined.
+int av1_post_filter_supported(const AV1_COMMON *cm);
+// Prepares pf for filtering frame. Must be called once the frame header has
+// been read and before any row is filtered.
+void av1_post_filter_init(AV1PostFilter *pf, YV12_BUFFER_CONFIG *frame,
+                          AV1_COMMON *cm);
+// Filters as many rows as possible once the superblock rows above
+// decoded_mi_rows are fully decoded. Passing cm->mi_rows finishes the frame.
+void av1_post_filter_rows(AV1PostFilter *pf, AV1_COMMON *cm,
+                          struct macroblockd *xd, int decoded_mi_rows);
+// Returns the number of luma rows at the top of the frame which no filter
+// will change anymore, or INT_MAX once the whole frame has been filtered.
+int av1_post_filter_final_rows(const AV1PostFilter *pf, const AV1_COMMON *cm);
+void av1_post_filter_free(AV1PostFilter *pf);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif  // AV1_COMMON_POSTFILTER_H_
@@ -10,6 +10,7 @@
  *
  */
 
+#include <limits.h>
 #include <math.h>
 
 #include "./aom_config.h"
@@ -130,51 +131,69 @@ static void GenSgrprojVtable() {
 void av1_loop_restoration_precal() { GenSgrprojVtable(); }
 
 static void extend_frame_lowbd(uint8_t *data, int width, int height, int stride,
-                               int border_horz, int border_vert) {
+                               int border_horz, int border_vert, int row_start,
+                               int row_end) {
   uint8_t *data_p;
   int i;
-  for (i = 0; i < height; ++i) {
+  for (i = row_start; i < row_end; ++i) {
     data_p = data + i * stride;
     memset(data_p - border_horz, data_p[0], border_horz);
     memset(data_p + width, data_p[width - 1], border_horz);
   }
   data_p = data - border_horz;
-  for (i = -border_vert; i < 0; ++i) {
-    memcpy(data_p + i * stride, data_p, width + 2 * border_horz);
+  if (row_start == 0) {
+    for (i = -border_vert; i < 0; ++i) {
+      memcpy(data_p + i * stride, data_p, width + 2 * border_horz);
+    }
   }
-  for (i = height; i < height + border_vert; ++i) {
-    memcpy(data_p + i * stride, data_p + (height - 1) * stride,
-           width + 2 * border_horz);
+  if (row_end == height) {
+    for (i = height; i < height + border_vert; ++i) {
+      memcpy(data_p + i * stride, data_p + (height - 1) * stride,
+             width + 2 * border_horz);
+    }
   }
 }
 
 static void extend_frame_highbd(uint16_t *data, int width, int height,
-                                int stride, int border_horz, int border_vert) {
+                                int stride, int border_horz, int border_vert,
+                                int row_start, int row_end) {
   uint16_t *data_p;
   int i, j;
-  for (i = 0; i < height; ++i) {
+  for (i = row_start; i < row_end; ++i) {
     data_p = data + i * stride;
     for (j = -border_horz; j < 0; ++j) data_p[j] = data_p[0];
     for (j = width; j < width + border_horz; ++j) data_p[j] = data_p[width - 1];
   }
   data_p = data - border_horz;
-  for (i = -border_vert; i < 0; ++i) {
-    memcpy(data_p + i * stride, data_p,
-           (width + 2 * border_horz) * sizeof(uint16_t));
+  if (row_start == 0) {
+    for (i = -border_vert; i < 0; ++i) {
+      memcpy(data_p + i * stride, data_p,
+             (width + 2 * border_horz) * sizeof(uint16_t));
+    }
   }
-  for (i = height; i < height + border_vert; ++i) {
-    memcpy(data_p + i * stride, data_p + (height - 1) * stride,
-           (width + 2 * border_horz) * sizeof(uint16_t));
+  if (row_end == height) {
+    for (i = height; i < height + border_vert; ++i) {
+      memcpy(data_p + i * stride, data_p + (height - 1) * stride,
+             (width + 2 * border_horz) * sizeof(uint16_t));
+    }
   }
 }
 
-void extend_frame(uint8_t *data, int width, int height, int stride,
-                  int border_horz, int border_vert, int highbd) {
+void av1_extend_frame_rows(uint8_t *data, int width, int height, int stride,
+                           int border_horz, int border_vert, int row_start,
+                           int row_end, int highbd) {
   if (highbd)
     extend_frame_highbd(CONVERT_TO_SHORTPTR(data), width, height, stride,
-                        border_horz, border_vert);
+                        border_horz, border_vert, row_start, row_end);
   else
-    extend_frame_lowbd(data, width, height, stride, border_horz, border_vert);
+    extend_frame_lowbd(data, width, height, stride, border_horz, border_vert,
+                       row_start, row_end);
+}
+
+void extend_frame(uint8_t *data, int width, int height, int stride,
+                  int border_horz, int border_vert, int highbd) {
+  av1_extend_frame_rows(data, width, height, stride, border_horz, border_vert,
+                        0, height, highbd);
 }
 
 static void copy_tile_lowbd(int width, int height, const uint8_t *src,
@@ -1101,18 +1120,6 @@ void av1_loop_restoration_filter_unit(
   }
 }
 
-typedef struct {
-  const RestorationInfo *rsi;
-  RestorationLineBuffers *rlbs;
-  const AV1_COMMON *cm;
-  int tile_stripe0;
-  int ss_x, ss_y;
-  int highbd, bit_depth;
-  uint8_t *data8, *dst8;
-  int data_stride, dst_stride;
-  int32_t *tmpbuf;
-} FilterFrameCtxt;
-
 static void filter_frame_on_tile(int tile_row, int tile_col, void *priv) {
   (void)tile_col;
   FilterFrameCtxt *ctxt = (FilterFrameCtxt *)priv;
@@ -1133,15 +1140,10 @@ static void filter_frame_on_unit(const RestorationTileLimits *limits,
       ctxt->dst_stride, ctxt->tmpbuf);
 }
 
-void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
-                                       AV1_COMMON *cm) {
-  assert(!cm->all_lossless);
+void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
+                                            YV12_BUFFER_CONFIG *frame,
+                                            AV1_COMMON *cm, int do_extend) {
   const int num_planes = av1_num_planes(cm);
-  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src,
-                           YV12_BUFFER_CONFIG *dst);
-  static const copy_fun copy_funs[3] = { aom_yv12_copy_y, aom_yv12_copy_u,
-                                         aom_yv12_copy_v };
-
   YV12_BUFFER_CONFIG *dst = &cm->rst_frame;
 
   const int frame_width = frame->crop_widths[0];
@@ -1153,7 +1155,9 @@ void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
     aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
                        "Failed to allocate restoration dst buffer");
 
-  RestorationLineBuffers rlbs;
+  lr_ctxt->frame = frame;
+  lr_ctxt->dst = dst;
+
   const int bit_depth = cm->bit_depth;
   const int highbd = cm->use_highbitdepth;
 
@@ -1168,28 +1172,95 @@ void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
     const int plane_width = frame->crop_widths[is_uv];
     const int plane_height = frame->crop_heights[is_uv];
 
-    extend_frame(frame->buffers[plane], plane_width, plane_height,
-                 frame->strides[is_uv], RESTORATION_BORDER, RESTORATION_BORDER,
-                 highbd);
-
-    FilterFrameCtxt ctxt;
-    ctxt.rsi = rsi;
-    ctxt.rlbs = &rlbs;
-    ctxt.cm = cm;
-    ctxt.ss_x = is_uv && cm->subsampling_x;
-    ctxt.ss_y = is_uv && cm->subsampling_y;
-    ctxt.highbd = highbd;
-    ctxt.bit_depth = bit_depth;
-    ctxt.data8 = frame->buffers[plane];
-    ctxt.dst8 = dst->buffers[plane];
-    ctxt.data_stride = frame->strides[is_uv];
-    ctxt.dst_stride = dst->strides[is_uv];
-    ctxt.tmpbuf = cm->rst_tmpbuf;
+    if (do_extend)
+      extend_frame(frame->buffers[plane], plane_width, plane_height,
+                   frame->strides[is_uv], RESTORATION_BORDER,
+                   RESTORATION_BORDER, highbd);
+
+    FilterFrameCtxt *ctxt = &lr_ctxt->ctxt[plane];
+    ctxt->rsi = rsi;
+    ctxt->rlbs = &lr_ctxt->rlbs;
+    ctxt->cm = cm;
+    ctxt->ss_x = is_uv && cm->subsampling_x;
+    ctxt->ss_y = is_uv && cm->subsampling_y;
+    ctxt->highbd = highbd;
+    ctxt->bit_depth = bit_depth;
+    ctxt->data8 = frame->buffers[plane];
+    ctxt->dst8 = dst->buffers[plane];
+    ctxt->data_stride = frame->strides[is_uv];
+    ctxt->dst_stride = dst->strides[is_uv];
+    ctxt->tmpbuf = cm->rst_tmpbuf;
+  }
+}
+
+void av1_loop_restoration_copy_planes(AV1LrStruct *lr_ctxt, AV1_COMMON *cm) {
+  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src,
+                           YV12_BUFFER_CONFIG *dst);
+  static const copy_fun copy_funs[3] = { aom_yv12_copy_y, aom_yv12_copy_u,
+                                         aom_yv12_copy_v };
+  const int num_planes = av1_num_planes(cm);
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+    copy_funs[plane](lr_ctxt->dst, lr_ctxt->frame);
+  }
+}
+
+void av1_loop_restoration_copy_rows(AV1LrStruct *lr_ctxt, int plane,
+                                    int row_start, int row_end) {
+  const YV12_BUFFER_CONFIG *const dst = lr_ctxt->dst;
+  YV12_BUFFER_CONFIG *const frame = lr_ctxt->frame;
+  const int is_uv = plane > 0;
+  const int highbd = lr_ctxt->ctxt[plane].highbd;
+  const int src_stride = dst->strides[is_uv];
+  const int dst_stride = frame->strides[is_uv];
+
+  row_end = AOMMIN(row_end, frame->crop_heights[is_uv]);
+  if (row_start >= row_end) return;
+  copy_tile(frame->crop_widths[is_uv], row_end - row_start,
+            dst->buffers[plane] + row_start * src_stride, src_stride,
+            frame->buffers[plane] + row_start * dst_stride, dst_stride, highbd);
+}
+
+void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
+                                       AV1_COMMON *cm) {
+  assert(!cm->all_lossless);
+  const int num_planes = av1_num_planes(cm);
+  AV1LrStruct lr_ctxt;
+
+  av1_loop_restoration_filter_frame_init(&lr_ctxt, frame, cm, 1);
+
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
 
     av1_foreach_rest_unit_in_frame(cm, plane, filter_frame_on_tile,
-                                   filter_frame_on_unit, &ctxt);
+                                   filter_frame_on_unit, &lr_ctxt.ctxt[plane]);
+  }
 
-    copy_funs[plane](dst, frame);
+  av1_loop_restoration_copy_planes(&lr_ctxt, cm);
+}
+
+void av1_foreach_rest_unit_in_row(RestorationTileLimits *limits,
+                                  const AV1PixelRect *tile_rect, int unit_idx0,
+                                  int unit_size,
+                                  rest_unit_visitor_t on_rest_unit,
+                                  void *priv) {
+  const int tile_w = tile_rect->right - tile_rect->left;
+  const int ext_size = unit_size * 3 / 2;
+  int x0 = 0, j = 0;
+  while (x0 < tile_w) {
+    int remaining_w = tile_w - x0;
+    int w = (remaining_w < ext_size) ? remaining_w : unit_size;
+
+    limits->h_start = tile_rect->left + x0;
+    limits->h_end = tile_rect->left + x0 + w;
+    assert(limits->h_end <= tile_rect->right);
+
+    const int unit_idx = unit_idx0 + j;
+    on_rest_unit(limits, tile_rect, unit_idx, priv);
+
+    x0 += w;
+    ++j;
   }
 }
 
@@ -1199,7 +1270,6 @@ static void foreach_rest_unit_in_tile(const AV1PixelRect *tile_rect,
                                       int unit_size, int ss_y,
                                       rest_unit_visitor_t on_rest_unit,
                                       void *priv) {
-  const int tile_w = tile_rect->right - tile_rect->left;
   const int tile_h = tile_rect->bottom - tile_rect->top;
   const int ext_size = unit_size * 3 / 2;
 
@@ -1220,21 +1290,9 @@ static void foreach_rest_unit_in_tile(const AV1PixelRect *tile_rect,
     limits.v_start = AOMMAX(tile_rect->top, limits.v_start - voffset);
     if (limits.v_end < tile_rect->bottom) limits.v_end -= voffset;
 
-    int x0 = 0, j = 0;
-    while (x0 < tile_w) {
-      int remaining_w = tile_w - x0;
-      int w = (remaining_w < ext_size) ? remaining_w : unit_size;
-
-      limits.h_start = tile_rect->left + x0;
-      limits.h_end = tile_rect->left + x0 + w;
-      assert(limits.h_end <= tile_rect->right);
-
-      const int unit_idx = unit_idx0 + i * hunits_per_tile + j;
-      on_rest_unit(&limits, tile_rect, unit_idx, priv);
-
-      x0 += w;
-      ++j;
-    }
+    av1_foreach_rest_unit_in_row(&limits, tile_rect,
+                                 unit_idx0 + i * hunits_per_tile, unit_size,
+                                 on_rest_unit, priv);
 
     y0 += h;
     ++i;
@@ -1483,11 +1541,14 @@ static void save_cdef_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                RESTORATION_EXTRA_HORZ, use_highbd);
 }
 
+// Only the boundaries whose first saved line is in [row_start, row_end) are
+// saved.
 static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                          int tile_row,
                                          const TileInfo *tile_info,
                                          int use_highbd, int plane,
-                                         AV1_COMMON *cm, int after_cdef) {
+                                         AV1_COMMON *cm, int after_cdef,
+                                         int row_start, int row_end) {
   const int is_uv = plane > 0;
   const int ss_y = is_uv && cm->subsampling_y;
   const int stripe_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
@@ -1523,11 +1584,12 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
 
     if (!after_cdef) {
       // Save deblocked context where needed.
-      if (use_deblock_above) {
-        save_deblock_boundary_lines(frame, cm, plane, y0 - RESTORATION_CTX_VERT,
-                                    frame_stripe, use_highbd, 1, boundaries);
+      const int above_row = y0 - RESTORATION_CTX_VERT;
+      if (use_deblock_above && above_row >= row_start && above_row < row_end) {
+        save_deblock_boundary_lines(frame, cm, plane, above_row, frame_stripe,
+                                    use_highbd, 1, boundaries);
       }
-      if (use_deblock_below) {
+      if (use_deblock_below && y1 >= row_start && y1 < row_end) {
         save_deblock_boundary_lines(frame, cm, plane, y1, frame_stripe,
                                     use_highbd, 0, boundaries);
       }
@@ -1538,11 +1600,11 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
       //
       // In addition, we need to save copies of the outermost line within
       // the tile, rather than using data from outside the tile.
-      if (!use_deblock_above) {
+      if (!use_deblock_above && y0 >= row_start && y0 < row_end) {
         save_cdef_boundary_lines(frame, cm, plane, y0, frame_stripe, use_highbd,
                                  1, boundaries);
       }
-      if (!use_deblock_below) {
+      if (!use_deblock_below && y1 - 1 >= row_start && y1 - 1 < row_end) {
         save_cdef_boundary_lines(frame, cm, plane, y1 - 1, frame_stripe,
                                  use_highbd, 0, boundaries);
       }
@@ -1556,13 +1618,20 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               AV1_COMMON *cm, int after_cdef) {
   const int num_planes = av1_num_planes(cm);
-  const int use_highbd = cm->use_highbitdepth;
   for (int p = 0; p < num_planes; ++p) {
-    TileInfo tile_info;
-    for (int tile_row = 0; tile_row < cm->tile_rows; ++tile_row) {
-      av1_tile_init(&tile_info, cm, tile_row, 0);
-      save_tile_row_boundary_lines(frame, tile_row, &tile_info, use_highbd, p,
-                                   cm, after_cdef);
-    }
+    av1_loop_restoration_save_boundary_lines_rows(frame, cm, p, 0, INT_MAX,
+                                                  after_cdef);
+  }
+}
+
+void av1_loop_restoration_save_boundary_lines_rows(
+    const YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, int plane, int row_start,
+    int row_end, int after_cdef) {
+  const int use_highbd = cm->use_highbitdepth;
+  TileInfo tile_info;
+  for (int tile_row = 0; tile_row < cm->tile_rows; ++tile_row) {
+    av1_tile_init(&tile_info, cm, tile_row, 0);
+    save_tile_row_boundary_lines(frame, tile_row, &tile_info, use_highbd,
+                                 plane, cm, after_cdef, row_start, row_end);
   }
 }
@@ -260,6 +260,12 @@ void av1_free_restoration_struct(RestorationInfo *rst_info);
 
 void extend_frame(uint8_t *data, int width, int height, int stride,
                   int border_horz, int border_vert, int highbd);
+// Like extend_frame(), but only extends rows [row_start, row_end) to the left
+// and right. The rows above and below the frame are only filled in when
+// row_start is 0 and row_end is height respectively.
+void av1_extend_frame_rows(uint8_t *data, int width, int height, int stride,
+                           int border_horz, int border_vert, int row_start,
+                           int row_end, int highbd);
 #if CONFIG_SKIP_SGR
 void decode_xq(const int *xqd, int *xq, const sgr_params_type *params);
 #else   // CONFIG_SKIP_SGR
@@ -292,8 +298,41 @@ void av1_loop_restoration_filter_unit(
     int highbd, int bit_depth, uint8_t *data8, int stride, uint8_t *dst8,
     int dst_stride, int32_t *tmpbuf);
 
+typedef struct {
+  const RestorationInfo *rsi;
+  RestorationLineBuffers *rlbs;
+  const struct AV1Common *cm;
+  int tile_stripe0;
+  int ss_x, ss_y;
+  int highbd, bit_depth;
+  uint8_t *data8, *dst8;
+  int data_stride, dst_stride;
+  int32_t *tmpbuf;
+} FilterFrameCtxt;
+
+// Per-frame state of the loop restoration filter. The filtered planes are
+// written to dst and copied back to frame once every unit is done.
+typedef struct AV1LrStruct {
+  FilterFrameCtxt ctxt[MAX_MB_PLANE];
+  RestorationLineBuffers rlbs;
+  YV12_BUFFER_CONFIG *frame;
+  YV12_BUFFER_CONFIG *dst;
+} AV1LrStruct;
+
 void av1_loop_restoration_filter_frame(YV12_BUFFER_CONFIG *frame,
                                        struct AV1Common *cm);
+// Set up lr_ctxt for filtering frame. If do_extend is set, also extend the
+// borders of the planes which use restoration.
+void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
+                                            YV12_BUFFER_CONFIG *frame,
+                                            struct AV1Common *cm,
+                                            int do_extend);
+// Copy the filtered planes back into the frame.
+void av1_loop_restoration_copy_planes(AV1LrStruct *lr_ctxt,
+                                      struct AV1Common *cm);
+// Copy rows [row_start, row_end) of one filtered plane back into the frame.
+void av1_loop_restoration_copy_rows(AV1LrStruct *lr_ctxt, int plane,
+                                    int row_start, int row_end);
 void av1_loop_restoration_precal();
 
 typedef void (*rest_unit_visitor_t)(const RestorationTileLimits *limits,
@@ -303,6 +342,14 @@ typedef void (*rest_unit_visitor_t)(const RestorationTileLimits *limits,
 typedef void (*rest_tile_start_visitor_t)(int tile_row, int tile_col,
                                           void *priv);
 
+// Call on_rest_unit for each loop restoration unit in one row of units of a
+// tile. limits->v_start and limits->v_end give the vertical extent of the row
+// and unit_idx0 is the index of its first unit.
+void av1_foreach_rest_unit_in_row(RestorationTileLimits *limits,
+                                  const AV1PixelRect *tile_rect, int unit_idx0,
+                                  int unit_size,
+                                  rest_unit_visitor_t on_rest_unit, void *priv);
+
 // Call on_rest_unit for each loop restoration unit in the frame. At the start
 // of each tile, call on_tile.
 void av1_foreach_rest_unit_in_frame(const struct AV1Common *cm, int plane,
@@ -327,6 +374,11 @@ int av1_loop_restoration_corners_in_sb(const struct AV1Common *cm, int plane,
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               struct AV1Common *cm,
                                               int after_cdef);
+// Saves the boundary lines of one plane whose first line is in
+// [row_start, row_end), so that the frame can be saved a few rows at a time.
+void av1_loop_restoration_save_boundary_lines_rows(
+    const YV12_BUFFER_CONFIG *frame, struct AV1Common *cm, int plane,
+    int row_start, int row_end, int after_cdef);
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -9,13 +9,132 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <limits.h>
+
 #include "./aom_config.h"
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
+#include "av1/common/cdef.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/reconinter.h"
 
+#if CONFIG_MULTITHREAD
+static INLINE void sync_read(AV1LfSync *const lf_sync, int r, int c) {
+  const int nsync = lf_sync->sync_range;
+
+  if (r && !(c & (nsync - 1))) {
+    pthread_mutex_t *const mutex = &lf_sync->mutex_[r - 1];
+    pthread_mutex_lock(mutex);
+
+    while (c > lf_sync->cur_sb_col[r - 1] - nsync) {
+      pthread_cond_wait(&lf_sync->cond_[r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+}
+
+static INLINE void sync_write(AV1LfSync *const lf_sync, int r, int c,
+                              const int sb_cols) {
+  const int nsync = lf_sync->sync_range;
+  int cur;
+  // Only signal when there are enough filtered SB for next row to run.
+  int sig = 1;
+
+  if (c < sb_cols - 1) {
+    cur = c;
+    if (c % nsync) sig = 0;
+  } else {
+    cur = sb_cols + nsync;
+  }
+
+  if (sig) {
+    pthread_mutex_lock(&lf_sync->mutex_[r]);
+
+    lf_sync->cur_sb_col[r] = cur;
+
+    // Both the horizontal pass of this row and of the row below may be
+    // waiting on this row.
+    pthread_cond_broadcast(&lf_sync->cond_[r]);
+    pthread_mutex_unlock(&lf_sync->mutex_[r]);
+  }
+}
+#else
+static INLINE void sync_read(AV1LfSync *const lf_sync, int r, int c) {
+  (void)lf_sync;
+  (void)r;
+  (void)c;
+}
+
+static INLINE void sync_write(AV1LfSync *const lf_sync, int r, int c,
+                              const int sb_cols) {
+  (void)lf_sync;
+  (void)r;
+  (void)c;
+  (void)sb_cols;
+}
+#endif  // CONFIG_MULTITHREAD
+
+// Set up nsync by width.
+static INLINE int get_sync_range(int width) {
+  // nsync numbers are picked by testing. For example, for 4k
+  // video, using 4 gives best performance.
+  if (width < 640)
+    return 1;
+  else if (width <= 1280)
+    return 2;
+  else if (width <= 4096)
+    return 4;
+  else
+    return 8;
+}
+
+// Allocate memory for lf row synchronization
+void av1_loop_filter_alloc(AV1LfSync *lf_sync, AV1_COMMON *cm, int rows,
+                           int width, int num_workers) {
+  lf_sync->rows = rows;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, lf_sync->mutex_,
+                    aom_malloc(sizeof(*lf_sync->mutex_) * rows));
+    if (lf_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&lf_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, lf_sync->cond_,
+                    aom_malloc(sizeof(*lf_sync->cond_) * rows));
+    if (lf_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&lf_sync->cond_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, lf_sync->job_mutex,
+                    aom_malloc(sizeof(*lf_sync->job_mutex)));
+    if (lf_sync->job_mutex) {
+      pthread_mutex_init(lf_sync->job_mutex, NULL);
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, lf_sync->lfdata,
+                  aom_malloc(num_workers * sizeof(*lf_sync->lfdata)));
+  lf_sync->num_workers = num_workers;
+
+  CHECK_MEM_ERROR(cm, lf_sync->cur_sb_col,
+                  aom_malloc(sizeof(*lf_sync->cur_sb_col) * rows));
+
+  // Each row is queued once for vertical and once for horizontal edges.
+  CHECK_MEM_ERROR(cm, lf_sync->job_queue,
+                  aom_malloc(sizeof(*lf_sync->job_queue) * rows * 2));
+
+  // Set up nsync.
+  lf_sync->sync_range = get_sync_range(width);
+}
+
 // Deallocate lf synchronization related mutex and data
 void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
   if (lf_sync != NULL) {
@@ -34,15 +153,698 @@ void av1_loop_filter_dealloc(AV1LfSync *lf_sync) {
       }
       aom_free(lf_sync->cond_);
     }
+    if (lf_sync->job_mutex != NULL) {
+      pthread_mutex_destroy(lf_sync->job_mutex);
+      aom_free(lf_sync->job_mutex);
+    }
 #endif  // CONFIG_MULTITHREAD
     aom_free(lf_sync->lfdata);
     aom_free(lf_sync->cur_sb_col);
+    aom_free(lf_sync->job_queue);
     // clear the structure as the source of this call may be a resize in which
     // case this call will be followed by an _alloc() which may fail.
     av1_zero(*lf_sync);
   }
 }
 
+static void enqueue_lf_jobs(AV1LfSync *lf_sync, int start, int stop) {
+  AV1LfMTInfo *lf_job_queue = lf_sync->job_queue;
+
+  lf_sync->jobs_enqueued = 0;
+  lf_sync->jobs_dequeued = 0;
+
+  // Vertical edge jobs never wait, so queueing all of them first guarantees
+  // that the horizontal edge jobs waiting on them always make progress.
+  for (int dir = 0; dir < 2; ++dir) {
+    for (int mi_row = start; mi_row < stop; mi_row += MAX_MIB_SIZE) {
+      lf_job_queue->mi_row = mi_row;
+      lf_job_queue->dir = dir;
+      ++lf_job_queue;
+      ++lf_sync->jobs_enqueued;
+    }
+  }
+}
+
+static AV1LfMTInfo *get_lf_job_info(AV1LfSync *lf_sync) {
+  AV1LfMTInfo *cur_job_info = NULL;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(lf_sync->job_mutex);
+#endif
+
+  if (lf_sync->jobs_dequeued < lf_sync->jobs_enqueued) {
+    cur_job_info = lf_sync->job_queue + lf_sync->jobs_dequeued;
+    ++lf_sync->jobs_dequeued;
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(lf_sync->job_mutex);
+#endif
+
+  return cur_job_info;
+}
+
+// Implement row loopfiltering for each thread.
+static void thread_loop_filter_rows(YV12_BUFFER_CONFIG *const frame_buffer,
+                                    AV1_COMMON *const cm,
+                                    struct macroblockd_plane *planes,
+                                    int plane, int start,
+                                    AV1LfSync *const lf_sync) {
+  const int num_planes = av1_num_planes(cm);
+  const int sb_cols =
+      (cm->mi_cols + MAX_MIB_SIZE - 1) >> MAX_MIB_SIZE_LOG2;
+  AV1LfMTInfo *cur_job_info;
+
+  while ((cur_job_info = get_lf_job_info(lf_sync)) != NULL) {
+    const int mi_row = cur_job_info->mi_row;
+    const int r = (mi_row - start) >> MAX_MIB_SIZE_LOG2;
+    int mi_col, c;
+
+    if (cur_job_info->dir == 0) {
+      for (mi_col = 0, c = 0; mi_col < cm->mi_cols;
+           mi_col += MAX_MIB_SIZE, ++c) {
+        av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer,
+                             mi_row, mi_col, num_planes);
+        av1_filter_block_plane_vert(cm, plane, &planes[plane], mi_row,
+                                    mi_col);
+        sync_write(lf_sync, r, c, sb_cols);
+      }
+    } else {
+      for (mi_col = 0, c = 0; mi_col < cm->mi_cols;
+           mi_col += MAX_MIB_SIZE, ++c) {
+        // The horizontal edges of this superblock touch pixels that the
+        // vertical edges of the above-right and right superblocks modify.
+        sync_read(lf_sync, r, c);
+        sync_read(lf_sync, r + 1, c);
+        av1_setup_dst_planes(planes, cm->seq_params.sb_size, frame_buffer,
+                             mi_row, mi_col, num_planes);
+        av1_filter_block_plane_horz(cm, plane, &planes[plane], mi_row,
+                                    mi_col);
+      }
+    }
+  }
+}
+
+// Row-based multi-threaded loopfilter hook
+static int loop_filter_row_worker(AV1LfSync *const lf_sync,
+                                  LFWorkerData *const lf_data) {
+  thread_loop_filter_rows(lf_data->frame_buffer, lf_data->cm, lf_data->planes,
+                          lf_data->y_only, lf_data->start, lf_sync);
+  return 1;
+}
+
+static void loop_filter_rows_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                                struct macroblockd_plane *planes, int start,
+                                int stop, int plane, AVxWorker *workers,
+                                int nworkers, AV1LfSync *lf_sync) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  // Number of superblock rows
+  const int sb_rows = (stop - start + MAX_MIB_SIZE - 1) >> MAX_MIB_SIZE_LOG2;
+  // Decoder may allocate more threads than number of tiles based on user's
+  // input.
+  const int num_workers = nworkers;
+  int i;
+
+  if (!lf_sync->sync_range || sb_rows != lf_sync->rows ||
+      num_workers > lf_sync->num_workers) {
+    av1_loop_filter_dealloc(lf_sync);
+    av1_loop_filter_alloc(lf_sync, cm, sb_rows, cm->width, num_workers);
+  }
+
+  // Initialize cur_sb_col to -1 for all SB rows.
+  for (i = 0; i < sb_rows; ++i) lf_sync->cur_sb_col[i] = -1;
+
+  enqueue_lf_jobs(lf_sync, start, stop);
+
+  // Set up loopfilter thread data.
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    LFWorkerData *const lf_data = &lf_sync->lfdata[i];
+
+    worker->hook = (AVxWorkerHook)loop_filter_row_worker;
+    worker->data1 = lf_sync;
+    worker->data2 = lf_data;
+
+    // Loopfilter data
+    lf_data->frame_buffer = frame;
+    lf_data->cm = cm;
+    memcpy(lf_data->planes, planes, sizeof(lf_data->planes));
+    lf_data->start = start;
+    lf_data->stop = stop;
+    lf_data->y_only = plane;
+
+    // Start loopfiltering
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+}
+
+void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                              MACROBLOCKD *xd, int frame_filter_level,
+                              int frame_filter_level_r, int plane,
+                              int partial_frame, AVxWorker *workers,
+                              int num_workers, AV1LfSync *lf_sync) {
+  int start_mi_row, end_mi_row, mi_rows_to_filter;
+#if CONFIG_EXT_DELTA_Q
+  int orig_filter_level[2] = { cm->lf.filter_level[0], cm->lf.filter_level[1] };
+#endif
+
+#if LOOP_FILTER_BITMASK
+  // The bitmask path carries neighbor state from one superblock to the next
+  // and can only run serially.
+  num_workers = 1;
+#endif
+  if (num_workers <= 1) {
+    av1_loop_filter_frame(frame, cm, xd, frame_filter_level,
+                          frame_filter_level_r, plane, partial_frame);
+    return;
+  }
+
+  if (!frame_filter_level && !frame_filter_level_r) return;
+  start_mi_row = 0;
+  mi_rows_to_filter = cm->mi_rows;
+  if (partial_frame && cm->mi_rows > 8) {
+    start_mi_row = cm->mi_rows >> 1;
+    start_mi_row &= 0xfffffff8;
+    mi_rows_to_filter = AOMMAX(cm->mi_rows / 8, 8);
+  }
+  end_mi_row = start_mi_row + mi_rows_to_filter;
+  av1_loop_filter_frame_init(cm, frame_filter_level, frame_filter_level_r,
+                             plane);
+
+#if CONFIG_EXT_DELTA_Q
+  cm->lf.filter_level[0] = frame_filter_level;
+  cm->lf.filter_level[1] = frame_filter_level_r;
+#endif
+
+  loop_filter_rows_mt(frame, cm, xd->plane, start_mi_row, end_mi_row, plane,
+                      workers, num_workers, lf_sync);
+
+#if CONFIG_EXT_DELTA_Q
+  cm->lf.filter_level[0] = orig_filter_level[0];
+  cm->lf.filter_level[1] = orig_filter_level[1];
+#endif
+}
+
+static void cdef_sync_alloc(AV1CdefSync *cdef_sync, AV1_COMMON *cm,
+                            int num_workers) {
+#if CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, cdef_sync->mutex_,
+                  aom_malloc(sizeof(*cdef_sync->mutex_)));
+  if (cdef_sync->mutex_) pthread_mutex_init(cdef_sync->mutex_, NULL);
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, cdef_sync->cdef_data,
+                  aom_malloc(num_workers * sizeof(*cdef_sync->cdef_data)));
+  CHECK_MEM_ERROR(cm, cdef_sync->bd,
+                  aom_memalign(32, num_workers * sizeof(*cdef_sync->bd)));
+  memset(cdef_sync->bd, 0, num_workers * sizeof(*cdef_sync->bd));
+  cdef_sync->num_workers = num_workers;
+}
+
+void av1_cdef_sync_dealloc(AV1CdefSync *cdef_sync) {
+  if (cdef_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    if (cdef_sync->mutex_ != NULL) {
+      pthread_mutex_destroy(cdef_sync->mutex_);
+      aom_free(cdef_sync->mutex_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(cdef_sync->cdef_data);
+    aom_free(cdef_sync->bd);
+    av1_zero(*cdef_sync);
+  }
+}
+
+static int get_next_cdef_fb_row(AV1CdefSync *cdef_sync) {
+  int fbr;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(cdef_sync->mutex_);
+#endif
+  fbr = cdef_sync->fbr;
+  if (fbr < cdef_sync->nvfb) ++cdef_sync->fbr;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(cdef_sync->mutex_);
+#endif
+  return fbr;
+}
+
+static int cdef_row_worker(AV1CdefWorkerData *const cdef_data, void *unused) {
+  AV1CdefSync *const cdef_sync = cdef_data->cdef_sync;
+  int fbr;
+  (void)unused;
+
+  while ((fbr = get_next_cdef_fb_row(cdef_sync)) < cdef_sync->nvfb) {
+    av1_cdef_fb_row(cdef_data->cm, cdef_data->planes, cdef_data->lb,
+                    cdef_data->bd, fbr);
+  }
+  return 1;
+}
+
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                       MACROBLOCKD *xd, AVxWorker *workers, int num_workers,
+                       AV1CdefSync *cdef_sync) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_planes = av1_num_planes(cm);
+  CdefLineBuf lb;
+  int i;
+
+  if (num_workers <= 1) {
+    av1_cdef_frame(frame, cm, xd);
+    return;
+  }
+
+  if (num_workers > cdef_sync->num_workers) {
+    av1_cdef_sync_dealloc(cdef_sync);
+    cdef_sync_alloc(cdef_sync, cm, num_workers);
+  }
+
+  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0,
+                       num_planes);
+  // The rows around each filter block row boundary are saved before any
+  // filtering, so every row sees the same input as in av1_cdef_frame().
+  av1_zero(lb);
+  av1_cdef_alloc_linebuf(cm, &lb);
+  av1_cdef_save_linebuf(cm, xd->plane, &lb);
+
+  cdef_sync->fbr = 0;
+  cdef_sync->nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    AV1CdefWorkerData *const cdef_data = &cdef_sync->cdef_data[i];
+
+    cdef_data->cm = cm;
+    cdef_data->planes = xd->plane;
+    cdef_data->lb = &lb;
+    cdef_data->bd = &cdef_sync->bd[i];
+    cdef_data->cdef_sync = cdef_sync;
+
+    worker->hook = (AVxWorkerHook)cdef_row_worker;
+    worker->data1 = cdef_data;
+    worker->data2 = NULL;
+
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+
+  av1_cdef_free_linebuf(&lb);
+}
+
+#if CONFIG_MULTITHREAD
+static INLINE void lr_sync_read(AV1LrSync *const lr_sync, int r, int c,
+                                int plane) {
+  const int nsync = lr_sync->sync_range;
+
+  if (r && !(c & (nsync - 1))) {
+    pthread_mutex_t *const mutex = &lr_sync->mutex_[plane][r - 1];
+    pthread_mutex_lock(mutex);
+
+    while (c > lr_sync->cur_sb_col[plane][r - 1] - nsync) {
+      pthread_cond_wait(&lr_sync->cond_[plane][r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+}
+
+static INLINE void lr_sync_write(AV1LrSync *const lr_sync, int r, int c,
+                                 int plane) {
+  pthread_mutex_lock(&lr_sync->mutex_[plane][r]);
+
+  lr_sync->cur_sb_col[plane][r] = c;
+
+  pthread_cond_broadcast(&lr_sync->cond_[plane][r]);
+  pthread_mutex_unlock(&lr_sync->mutex_[plane][r]);
+}
+#else
+static INLINE void lr_sync_read(AV1LrSync *const lr_sync, int r, int c,
+                                int plane) {
+  (void)lr_sync;
+  (void)r;
+  (void)c;
+  (void)plane;
+}
+
+static INLINE void lr_sync_write(AV1LrSync *const lr_sync, int r, int c,
+                                 int plane) {
+  (void)lr_sync;
+  (void)r;
+  (void)c;
+  (void)plane;
+}
+#endif  // CONFIG_MULTITHREAD
+
+// Allocate memory for loop restoration row synchronization
+void av1_loop_restoration_alloc(AV1LrSync *lr_sync, AV1_COMMON *cm,
+                                int num_workers, int num_rows_lr,
+                                int num_planes, int width) {
+  lr_sync->rows = num_rows_lr;
+  lr_sync->num_planes = num_planes;
+#if CONFIG_MULTITHREAD
+  {
+    int i, j;
+
+    for (j = 0; j < num_planes; j++) {
+      CHECK_MEM_ERROR(cm, lr_sync->mutex_[j],
+                      aom_malloc(sizeof(*(lr_sync->mutex_[j])) * num_rows_lr));
+      if (lr_sync->mutex_[j]) {
+        for (i = 0; i < num_rows_lr; ++i) {
+          pthread_mutex_init(&lr_sync->mutex_[j][i], NULL);
+        }
+      }
+
+      CHECK_MEM_ERROR(cm, lr_sync->cond_[j],
+                      aom_malloc(sizeof(*(lr_sync->cond_[j])) * num_rows_lr));
+      if (lr_sync->cond_[j]) {
+        for (i = 0; i < num_rows_lr; ++i) {
+          pthread_cond_init(&lr_sync->cond_[j][i], NULL);
+        }
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, lr_sync->job_mutex,
+                    aom_malloc(sizeof(*(lr_sync->job_mutex))));
+    if (lr_sync->job_mutex) {
+      pthread_mutex_init(lr_sync->job_mutex, NULL);
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, lr_sync->lrworkerdata,
+                  aom_calloc(num_workers, sizeof(*(lr_sync->lrworkerdata))));
+  lr_sync->num_workers = num_workers;
+
+  for (int worker_idx = 0; worker_idx < num_workers; ++worker_idx) {
+    LRWorkerData *const workerdata = &lr_sync->lrworkerdata[worker_idx];
+
+    CHECK_MEM_ERROR(cm, workerdata->rst_tmpbuf,
+                    (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+    CHECK_MEM_ERROR(cm, workerdata->rlbs,
+                    aom_malloc(sizeof(*workerdata->rlbs)));
+  }
+
+  for (int j = 0; j < num_planes; j++) {
+    CHECK_MEM_ERROR(
+        cm, lr_sync->cur_sb_col[j],
+        aom_malloc(sizeof(*(lr_sync->cur_sb_col[j])) * num_rows_lr));
+  }
+  CHECK_MEM_ERROR(
+      cm, lr_sync->job_queue,
+      aom_malloc(sizeof(*(lr_sync->job_queue)) * num_rows_lr * num_planes));
+  // Set up nsync.
+  lr_sync->sync_range = get_sync_range(width);
+}
+
+// Deallocate loop restoration synchronization related mutex and data
+void av1_loop_restoration_dealloc(AV1LrSync *lr_sync) {
+  if (lr_sync != NULL) {
+    int j;
+#if CONFIG_MULTITHREAD
+    int i;
+    for (j = 0; j < MAX_MB_PLANE; j++) {
+      if (lr_sync->mutex_[j] != NULL) {
+        for (i = 0; i < lr_sync->rows; ++i) {
+          pthread_mutex_destroy(&lr_sync->mutex_[j][i]);
+        }
+        aom_free(lr_sync->mutex_[j]);
+      }
+      if (lr_sync->cond_[j] != NULL) {
+        for (i = 0; i < lr_sync->rows; ++i) {
+          pthread_cond_destroy(&lr_sync->cond_[j][i]);
+        }
+        aom_free(lr_sync->cond_[j]);
+      }
+    }
+    if (lr_sync->job_mutex != NULL) {
+      pthread_mutex_destroy(lr_sync->job_mutex);
+      aom_free(lr_sync->job_mutex);
+    }
+#endif  // CONFIG_MULTITHREAD
+    for (j = 0; j < MAX_MB_PLANE; j++) {
+      aom_free(lr_sync->cur_sb_col[j]);
+    }
+
+    aom_free(lr_sync->job_queue);
+
+    if (lr_sync->lrworkerdata) {
+      for (int worker_idx = 0; worker_idx < lr_sync->num_workers;
+           worker_idx++) {
+        LRWorkerData *const workerdata_data =
+            lr_sync->lrworkerdata + worker_idx;
+
+        aom_free(workerdata_data->rst_tmpbuf);
+        aom_free(workerdata_data->rlbs);
+      }
+      aom_free(lr_sync->lrworkerdata);
+    }
+
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*lr_sync);
+  }
+}
+
+// Walks the restoration unit rows of every plane which uses restoration, in
+// the same order as av1_foreach_rest_unit_in_frame(). If lr_sync is NULL, the
+// rows are only counted. Returns the largest number of rows in a plane.
+static int enqueue_lr_jobs(AV1LrSync *lr_sync, AV1_COMMON *cm) {
+  const int num_planes = av1_num_planes(cm);
+  AV1LrMTInfo *lr_job_queue = lr_sync ? lr_sync->job_queue : NULL;
+  int max_rows = 0;
+
+  if (lr_sync) {
+    lr_sync->jobs_enqueued = 0;
+    lr_sync->jobs_dequeued = 0;
+  }
+
+  for (int plane = 0; plane < num_planes; plane++) {
+    const RestorationInfo *rsi = &cm->rst_info[plane];
+    if (rsi->frame_restoration_type == RESTORE_NONE) continue;
+
+    const int is_uv = plane > 0;
+    const int ss_y = is_uv && cm->subsampling_y;
+    const int unit_size = rsi->restoration_unit_size;
+    const int ext_size = unit_size * 3 / 2;
+    int lr_unit_row = 0;
+    TileInfo tile_info;
+
+    for (int tile_row = 0; tile_row < cm->tile_rows; tile_row++) {
+      av1_tile_init(&tile_info, cm, tile_row, 0);
+      const AV1PixelRect tile_rect = av1_get_tile_rect(&tile_info, cm, is_uv);
+      const int tile_h = tile_rect.bottom - tile_rect.top;
+
+      int y0 = 0, i = 0;
+      while (y0 < tile_h) {
+        int remaining_h = tile_h - y0;
+        int h = (remaining_h < ext_size) ? remaining_h : unit_size;
+
+        if (lr_job_queue) {
+          RestorationTileLimits limits;
+          limits.v_start = tile_rect.top + y0;
+          limits.v_end = tile_rect.top + y0 + h;
+          assert(limits.v_end <= tile_rect.bottom);
+          // Offset the tile upwards to align with the restoration processing
+          // stripe
+          const int voffset = RESTORATION_UNIT_OFFSET >> ss_y;
+          limits.v_start = AOMMAX(tile_rect.top, limits.v_start - voffset);
+          if (limits.v_end < tile_rect.bottom) limits.v_end -= voffset;
+
+          lr_job_queue->lr_unit_row = lr_unit_row;
+          lr_job_queue->plane = plane;
+          lr_job_queue->tile_row = tile_row;
+          lr_job_queue->tile_unit_row = i;
+          lr_job_queue->v_start = limits.v_start;
+          lr_job_queue->v_end = limits.v_end;
+          ++lr_job_queue;
+          ++lr_sync->jobs_enqueued;
+        }
+
+        y0 += h;
+        ++i;
+        ++lr_unit_row;
+      }
+    }
+    max_rows = AOMMAX(max_rows, lr_unit_row);
+  }
+  return max_rows;
+}
+
+static AV1LrMTInfo *get_lr_job_info(AV1LrSync *lr_sync) {
+  AV1LrMTInfo *cur_job_info = NULL;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(lr_sync->job_mutex);
+#endif
+
+  if (lr_sync->jobs_dequeued < lr_sync->jobs_enqueued) {
+    cur_job_info = lr_sync->job_queue + lr_sync->jobs_dequeued;
+    ++lr_sync->jobs_dequeued;
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(lr_sync->job_mutex);
+#endif
+
+  return cur_job_info;
+}
+
+typedef struct {
+  FilterFrameCtxt ctxt;
+  AV1LrSync *lr_sync;
+  int lr_unit_row;
+  int plane;
+  // Index of the current unit in the row, counted over all tile columns.
+  int col;
+} LRRowCtxt;
+
+static void filter_unit_mt(const RestorationTileLimits *limits,
+                           const AV1PixelRect *tile_rect, int rest_unit_idx,
+                           void *priv) {
+  LRRowCtxt *const row_ctxt = (LRRowCtxt *)priv;
+  const FilterFrameCtxt *const ctxt = &row_ctxt->ctxt;
+  const RestorationInfo *const rsi = ctxt->rsi;
+
+  // Filtering a unit temporarily overwrites the rows just outside its
+  // stripes, which the units above and below read. Wait until the row above
+  // is done with the units overlapping this one.
+  lr_sync_read(row_ctxt->lr_sync, row_ctxt->lr_unit_row, row_ctxt->col,
+               row_ctxt->plane);
+
+  av1_loop_restoration_filter_unit(
+      limits, &rsi->unit_info[rest_unit_idx], &rsi->boundaries, ctxt->rlbs,
+      tile_rect, ctxt->tile_stripe0, ctxt->ss_x, ctxt->ss_y, ctxt->highbd,
+      ctxt->bit_depth, ctxt->data8, ctxt->data_stride, ctxt->dst8,
+      ctxt->dst_stride, ctxt->tmpbuf);
+
+  if (!(row_ctxt->col & (row_ctxt->lr_sync->sync_range - 1)))
+    lr_sync_write(row_ctxt->lr_sync, row_ctxt->lr_unit_row, row_ctxt->col,
+                  row_ctxt->plane);
+  ++row_ctxt->col;
+}
+
+// Implement row loop restoration for each thread.
+static int loop_restoration_row_worker(AV1LrSync *const lr_sync,
+                                       LRWorkerData *const lrworkerdata) {
+  AV1LrStruct *const lr_ctxt = (AV1LrStruct *)lrworkerdata->lr_ctxt;
+  AV1LrMTInfo *cur_job_info;
+
+  while ((cur_job_info = get_lr_job_info(lr_sync)) != NULL) {
+    const int plane = cur_job_info->plane;
+    const int tile_row = cur_job_info->tile_row;
+    // Only the contexts of planes which use restoration are set up.
+    const AV1_COMMON *const cm = lr_ctxt->ctxt[plane].cm;
+    const RestorationInfo *const rsi = &cm->rst_info[plane];
+    LRRowCtxt row_ctxt;
+    TileInfo tile_info;
+
+    row_ctxt.ctxt = lr_ctxt->ctxt[plane];
+    row_ctxt.ctxt.rlbs = lrworkerdata->rlbs;
+    row_ctxt.ctxt.tmpbuf = lrworkerdata->rst_tmpbuf;
+    row_ctxt.ctxt.tile_stripe0 =
+        (tile_row == 0) ? 0 : cm->rst_end_stripe[tile_row - 1];
+    row_ctxt.lr_sync = lr_sync;
+    row_ctxt.lr_unit_row = cur_job_info->lr_unit_row;
+    row_ctxt.plane = plane;
+    row_ctxt.col = 0;
+
+    av1_tile_set_row(&tile_info, cm, tile_row);
+    for (int tile_col = 0; tile_col < cm->tile_cols; tile_col++) {
+      av1_tile_set_col(&tile_info, cm, tile_col);
+      const AV1PixelRect tile_rect =
+          av1_get_tile_rect(&tile_info, cm, plane > 0);
+      const int tile_idx = tile_col + tile_row * cm->tile_cols;
+      const int unit_idx0 = tile_idx * rsi->units_per_tile +
+                            cur_job_info->tile_unit_row *
+                                rsi->horz_units_per_tile;
+      RestorationTileLimits limits;
+      limits.v_start = cur_job_info->v_start;
+      limits.v_end = cur_job_info->v_end;
+
+      av1_foreach_rest_unit_in_row(&limits, &tile_rect, unit_idx0,
+                                   rsi->restoration_unit_size, filter_unit_mt,
+                                   &row_ctxt);
+    }
+    // Release any row waiting on the last units of this one.
+    lr_sync_write(lr_sync, cur_job_info->lr_unit_row, INT_MAX, plane);
+  }
+  return 1;
+}
+
+static void foreach_rest_unit_in_planes_mt(AV1LrStruct *lr_ctxt,
+                                           AVxWorker *workers, int nworkers,
+                                           AV1LrSync *lr_sync, AV1_COMMON *cm) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_planes = av1_num_planes(cm);
+  const int num_rows_lr = enqueue_lr_jobs(NULL, cm);
+  int i;
+
+  if (!lr_sync->sync_range || num_rows_lr > lr_sync->rows ||
+      num_planes > lr_sync->num_planes || nworkers > lr_sync->num_workers) {
+    av1_loop_restoration_dealloc(lr_sync);
+    av1_loop_restoration_alloc(lr_sync, cm, nworkers, num_rows_lr, num_planes,
+                               cm->width);
+  }
+
+  // Initialize cur_sb_col to -1 for all rows.
+  for (i = 0; i < num_planes; i++) {
+    memset(lr_sync->cur_sb_col[i], -1,
+           sizeof(*(lr_sync->cur_sb_col[i])) * num_rows_lr);
+  }
+
+  enqueue_lr_jobs(lr_sync, cm);
+
+  for (i = 0; i < nworkers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    lr_sync->lrworkerdata[i].lr_ctxt = lr_ctxt;
+    worker->hook = (AVxWorkerHook)loop_restoration_row_worker;
+    worker->data1 = lr_sync;
+    worker->data2 = &lr_sync->lrworkerdata[i];
+
+    // Start loop restoration
+    if (i == nworkers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (i = 0; i < nworkers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+}
+
+void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
+                                          AV1_COMMON *cm, AVxWorker *workers,
+                                          int num_workers, AV1LrSync *lr_sync) {
+  AV1LrStruct lr_ctxt;
+
+  assert(!cm->all_lossless);
+
+  if (num_workers <= 1) {
+    av1_loop_restoration_filter_frame(frame, cm);
+    return;
+  }
+
+  av1_loop_restoration_filter_frame_init(&lr_ctxt, frame, cm, 1);
+
+  foreach_rest_unit_in_planes_mt(&lr_ctxt, workers, num_workers, lr_sync, cm);
+
+  av1_loop_restoration_copy_planes(&lr_ctxt, cm);
+}
+
 // Accumulate frame counts. FRAME_COUNTS consist solely of 'unsigned int'
 // members, so we treat it as an array, and sum over the whole length.
 void av1_accumulate_frame_counts(FRAME_COUNTS *acc_counts,
@@ -13,6 +13,7 @@
 #define AV1_COMMON_LOOPFILTER_THREAD_H_
 #include "./aom_config.h"
 #include "av1/common/av1_loopfilter.h"
+#include "av1/common/restoration.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -21,6 +22,16 @@ extern "C" {
 
 struct AV1Common;
 struct FRAME_COUNTS;
+struct macroblockd;
+struct CdefLineBuf;
+struct CdefBlockData;
+
+// One unit of loop filter work: all vertical (dir == 0) or all horizontal
+// (dir == 1) edges of one superblock row.
+typedef struct AV1LfMTInfo {
+  int mi_row;
+  int dir;
+} AV1LfMTInfo;
 
 // Loopfilter row synchronization
 typedef struct AV1LfSyncData {
@@ -38,11 +49,115 @@ typedef struct AV1LfSyncData {
   // Row-based parallel loopfilter data
   LFWorkerData *lfdata;
   int num_workers;
+
+  // Queue of superblock rows still to be filtered. All vertical edge jobs are
+  // queued before any horizontal edge job.
+  AV1LfMTInfo *job_queue;
+  int jobs_enqueued;
+  int jobs_dequeued;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif
 } AV1LfSync;
 
+// Allocate memory for loopfilter row synchronization.
+void av1_loop_filter_alloc(AV1LfSync *lf_sync, struct AV1Common *cm, int rows,
+                           int width, int num_workers);
+
 // Deallocate loopfilter synchronization related mutex and data.
 void av1_loop_filter_dealloc(AV1LfSync *lf_sync);
 
+// Multi-threaded version of av1_loop_filter_frame(). Superblock rows are
+// shared between the workers; the last worker runs on the calling thread.
+void av1_loop_filter_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                              struct macroblockd *mbd, int frame_filter_level,
+                              int frame_filter_level_r, int plane,
+                              int partial_frame, AVxWorker *workers,
+                              int num_workers, AV1LfSync *lf_sync);
+
+typedef struct AV1CdefWorkerData {
+  struct AV1Common *cm;
+  struct macroblockd_plane *planes;
+  const struct CdefLineBuf *lb;
+  struct CdefBlockData *bd;
+  struct AV1CdefSyncData *cdef_sync;
+} AV1CdefWorkerData;
+
+// CDEF filter block row distribution
+typedef struct AV1CdefSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+#endif
+  // Next 64x64 filter block row to be filtered, and the number of rows.
+  int fbr;
+  int nvfb;
+
+  AV1CdefWorkerData *cdef_data;
+  // Scratch buffers of each worker.
+  struct CdefBlockData *bd;
+  int num_workers;
+} AV1CdefSync;
+
+void av1_cdef_sync_dealloc(AV1CdefSync *cdef_sync);
+
+// Multi-threaded version of av1_cdef_frame(). Workers take whole 64x64
+// filter block rows; the last worker runs on the calling thread.
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                       struct macroblockd *xd, AVxWorker *workers,
+                       int num_workers, AV1CdefSync *cdef_sync);
+
+// One unit of loop restoration work: one row of restoration units spanning
+// all tile columns of a plane.
+typedef struct AV1LrMTInfo {
+  int v_start;
+  int v_end;
+  int lr_unit_row;
+  int plane;
+  int tile_row;
+  int tile_unit_row;  // Row of the units within the tile.
+} AV1LrMTInfo;
+
+typedef struct LoopRestorationWorkerData {
+  int32_t *rst_tmpbuf;
+  RestorationLineBuffers *rlbs;
+  void *lr_ctxt;
+} LRWorkerData;
+
+// Loop restoration row synchronization
+typedef struct AV1LrSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_[MAX_MB_PLANE];
+  pthread_cond_t *cond_[MAX_MB_PLANE];
+  pthread_mutex_t *job_mutex;
+#endif
+  // Index of the last restoration unit filtered in each row, per plane.
+  int *cur_sb_col[MAX_MB_PLANE];
+  // See AV1LfSync::sync_range.
+  int sync_range;
+  int rows;
+  int num_planes;
+
+  int num_workers;
+  LRWorkerData *lrworkerdata;
+
+  AV1LrMTInfo *job_queue;
+  int jobs_enqueued;
+  int jobs_dequeued;
+} AV1LrSync;
+
+void av1_loop_restoration_alloc(AV1LrSync *lr_sync, struct AV1Common *cm,
+                                int num_workers, int num_rows_lr,
+                                int num_planes, int width);
+void av1_loop_restoration_dealloc(AV1LrSync *lr_sync);
+
+// Multi-threaded version of av1_loop_restoration_filter_frame(). The caller
+// chooses num_workers, so that e.g. the encoder and the decoder can run
+// restoration with different thread counts.
+void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
+                                          struct AV1Common *cm,
+                                          AVxWorker *workers, int num_workers,
+                                          AV1LrSync *lr_sync);
+
 void av1_accumulate_frame_counts(struct FRAME_COUNTS *acc_counts,
                                  struct FRAME_COUNTS *counts);
 
@@ -33,6 +33,12 @@
 
 extern const int16_t warped_filter[WARPEDPIXEL_PREC_SHIFTS * 3 + 1][8];
 
+#if HAVE_SSE4_1
+// warped_filter with 8-bit taps in the column order 0, 2, 4, 6, 1, 3, 5, 7,
+// defined in x86/warp_plane_sse4.c.
+extern const int8_t av1_filter_8bit[WARPEDPIXEL_PREC_SHIFTS * 3 + 1][8];
+#endif
+
 void project_points_affine(const int32_t *mat, int *points, int *proj,
                            const int n, const int stride_points,
                            const int stride_proj, const int subsampling_x,
@@ -784,6 +784,36 @@ static void idct64_low32_new_avx2(const __m256i *input, __m256i *output,
   btf_16_adds_subs_out_avx2(x1[31], x1[32], output[31], output[32]);
 }
 
+// Only input[0] is nonzero, so every output of the DCT is the DC term
+// scaled by cospi[32].
+static INLINE void idct_low1_avx2(const __m256i *input, __m256i *output,
+                                  int size) {
+  const int32_t *cospi = cospi_arr(INV_COS_BIT);
+  const __m256i scale = _mm256_set1_epi16(cospi[32] * 8);
+  const __m256i x = _mm256_mulhrs_epi16(input[0], scale);
+  for (int i = 0; i < size; ++i) {
+    output[i] = x;
+  }
+}
+
+static void idct16_low1_new_avx2(const __m256i *input, __m256i *output,
+                                 int8_t cos_bit) {
+  (void)cos_bit;
+  idct_low1_avx2(input, output, 16);
+}
+
+static void idct32_low1_new_avx2(const __m256i *input, __m256i *output,
+                                 int8_t cos_bit) {
+  (void)cos_bit;
+  idct_low1_avx2(input, output, 32);
+}
+
+static void idct64_low1_new_avx2(const __m256i *input, __m256i *output,
+                                 int8_t cos_bit) {
+  (void)cos_bit;
+  idct_low1_avx2(input, output, 64);
+}
+
 // 1D functions process 16 pixels at one time.
 static const transform_1d_avx2
     lowbd_txfm_all_1d_w16_arr[TX_SIZES][ITX_TYPES_1D] = {
@@ -794,13 +824,27 @@ static const transform_1d_avx2
       { idct64_low32_new_avx2, NULL, NULL },
     };
 
+// DCT variants for the case where only the first input is nonzero.
+static const transform_1d_avx2 lowbd_txfm_idct_low1_w16_arr[TX_SIZES] = {
+  NULL, NULL, idct16_low1_new_avx2, idct32_low1_new_avx2, idct64_low1_new_avx2,
+};
+
+static INLINE transform_1d_avx2 lowbd_get_txfm_1d_w16(int tx_idx,
+                                                      ITX_TYPE_1D itx_type,
+                                                      int eob_1d) {
+  if (eob_1d == 0 && itx_type == IDCT_1D) {
+    return lowbd_txfm_idct_low1_w16_arr[tx_idx];
+  }
+  return lowbd_txfm_all_1d_w16_arr[tx_idx][itx_type];
+}
+
 // only process w >= 16 h >= 16
-static INLINE void lowbd_inv_txfm2d_add_no_identity_avx2(const int32_t *input,
-                                                         uint8_t *output,
-                                                         int stride,
-                                                         TX_TYPE tx_type,
-                                                         TX_SIZE tx_size) {
+static INLINE void lowbd_inv_txfm2d_add_no_identity_avx2(
+    const int32_t *input, uint8_t *output, int stride, TX_TYPE tx_type,
+    TX_SIZE tx_size, int eob) {
   __m256i buf1[64 * 16];
+  int eobx, eoby;
+  get_eobx_eoby_scan_default(&eobx, &eoby, tx_size, eob);
   const int8_t *shift = inv_txfm_shift_ls[tx_size];
   const int txw_idx = get_txw_idx(tx_size);
   const int txh_idx = get_txh_idx(tx_size);
@@ -812,26 +856,34 @@ static INLINE void lowbd_inv_txfm2d_add_no_identity_avx2(const int32_t *input,
   const int buf_size_h = AOMMIN(32, txfm_size_row);
   const int input_stride = AOMMIN(32, txfm_size_col);
   const int rect_type = get_rect_tx_log_ratio(txfm_size_col, txfm_size_row);
+  // Coefficients beyond these bounds are zero: their rows skip the row
+  // transform and their columns are not loaded.
+  const int buf_size_nonzero_w = (eobx + 16) & ~15;
+  const int buf_size_nonzero_h = (eoby + 16) & ~15;
+  const __m256i zero = _mm256_setzero_si256();
 
   const transform_1d_avx2 row_txfm =
-      lowbd_txfm_all_1d_w16_arr[txw_idx][hitx_1d_tab[tx_type]];
+      lowbd_get_txfm_1d_w16(txw_idx, hitx_1d_tab[tx_type], eobx);
   const transform_1d_avx2 col_txfm =
-      lowbd_txfm_all_1d_w16_arr[txh_idx][vitx_1d_tab[tx_type]];
+      lowbd_get_txfm_1d_w16(txh_idx, vitx_1d_tab[tx_type], eoby);
 
   assert(col_txfm != NULL);
   assert(row_txfm != NULL);
   int ud_flip, lr_flip;
   get_flip_cfg(tx_type, &ud_flip, &lr_flip);
-  for (int i = 0; i < buf_size_h; i += 16) {
+  for (int i = 0; i < buf_size_nonzero_h; i += 16) {
     __m256i buf0[64];
     const int32_t *input_row = input + i * input_stride;
-    for (int j = 0; j < AOMMIN(2, buf_size_w_div16); ++j) {
+    for (int j = 0; j < buf_size_nonzero_w >> 4; ++j) {
       __m256i *buf0_cur = buf0 + j * 16;
       const int32_t *input_cur = input_row + j * 16;
       load_buffer_32bit_to_16bit_w16_avx2(input_cur, input_stride, buf0_cur,
                                           16);
       transpose_16bit_16x16_avx2(buf0_cur, buf0_cur);
     }
+    for (int j = buf_size_nonzero_w; j < input_stride; ++j) {
+      buf0[j] = zero;
+    }
     if (rect_type == 1 || rect_type == -1) {
       round_shift_avx2(buf0, buf0, input_stride);  // rect special code
     }
@@ -854,6 +906,9 @@ static INLINE void lowbd_inv_txfm2d_add_no_identity_avx2(const int32_t *input,
   }
   for (int i = 0; i < buf_size_w_div16; i++) {
     __m256i *buf1_cur = buf1 + i * txfm_size_row;
+    for (int j = buf_size_nonzero_h; j < buf_size_h; ++j) {
+      buf1_cur[j] = zero;
+    }
     col_txfm(buf1_cur, buf1_cur, cos_bit_col);
     round_shift_16bit_w16_avx2(buf1_cur, txfm_size_row, shift[1]);
   }
@@ -1046,7 +1101,6 @@ static INLINE void lowbd_inv_txfm2d_add_v_identity_avx2(const int32_t *input,
 static INLINE void lowbd_inv_txfm2d_add_universe_avx2(
     const int32_t *input, uint8_t *output, int stride, TX_TYPE tx_type,
     TX_SIZE tx_size, int eob) {
-  (void)eob;
   switch (tx_type) {
     case DCT_DCT:
     case ADST_DCT:   // ADST in vertical, DCT in horizontal
@@ -1058,7 +1112,7 @@ static INLINE void lowbd_inv_txfm2d_add_universe_avx2(
     case ADST_FLIPADST:
     case FLIPADST_ADST:
       lowbd_inv_txfm2d_add_no_identity_avx2(input, output, stride, tx_type,
-                                            tx_size);
+                                            tx_size, eob);
       break;
     case IDTX:
       lowbd_inv_txfm2d_add_idtx_avx2(input, output, stride, tx_size);
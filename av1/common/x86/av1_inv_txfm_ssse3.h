@@ -19,6 +19,7 @@
 #include "aom/aom_integer.h"
 #include "aom_dsp/x86/transpose_sse2.h"
 #include "aom_dsp/x86/txfm_common_sse2.h"
+#include "av1/common/x86/av1_inv_txfm_eob.h"
 
 #ifdef __cplusplus
 extern "C" {
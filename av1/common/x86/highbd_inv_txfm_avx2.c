@@ -13,7 +13,10 @@
 
 #include "./av1_rtcd.h"
 #include "./aom_config.h"
+#include "aom_ports/mem.h"
+#include "av1/common/av1_inv_txfm1d.h"
 #include "av1/common/av1_inv_txfm1d_cfg.h"
+#include "av1/common/x86/av1_inv_txfm_eob.h"
 
 // Note:
 //  Total 32x4 registers to represent 32x32 block coefficients.
@@ -618,3 +621,730 @@ void av1_inv_txfm2d_add_32x32_avx2(const int32_t *coeff, uint16_t *output,
     default: assert(0);
   }
 }
+
+// The 1D transforms below process eight independent columns at a time, one
+// per 32-bit lane, where in[i] holds the i-th input of each column. The
+// intermediate sums are clamped to 'range' bits like clamp_value() does in
+// the C transforms. The butterflies add their products in 32 bits where
+// half_btf() uses int64_t, so the results are bit-exact only for conformant
+// coefficient ranges, i.e. the inputs the CONFIG_COEFFICIENT_RANGE_CHECKING
+// checks accept.
+
+static INLINE __m256i half_btf_0_avx2(const __m256i *w0, const __m256i *n0,
+                                      const __m256i *rounding, int bit) {
+  __m256i x = _mm256_mullo_epi32(*w0, *n0);
+  x = _mm256_add_epi32(x, *rounding);
+  return _mm256_srai_epi32(x, bit);
+}
+
+// Computes *x0 = half_btf(w0, *x0, w1, *x1) and *x1 = half_btf(w2, *x0, w3,
+// *x1).
+static INLINE void btf_avx2(const __m256i *w0, const __m256i *w1,
+                            const __m256i *w2, const __m256i *w3, __m256i *x0,
+                            __m256i *x1, const __m256i *rounding, int bit) {
+  const __m256i in0 = *x0;
+  const __m256i in1 = *x1;
+  *x0 = half_btf_avx2(w0, &in0, w1, &in1, rounding, bit);
+  *x1 = half_btf_avx2(w2, &in0, w3, &in1, rounding, bit);
+}
+
+// Computes *out0 = in0 + in1 and *out1 = in0 - in1, clamped to the range
+// [*clamp_lo, *clamp_hi].
+static INLINE void addsub_avx2(const __m256i in0, const __m256i in1,
+                               __m256i *out0, __m256i *out1,
+                               const __m256i *clamp_lo,
+                               const __m256i *clamp_hi) {
+  __m256i a0 = _mm256_add_epi32(in0, in1);
+  __m256i a1 = _mm256_sub_epi32(in0, in1);
+
+  a0 = _mm256_max_epi32(a0, *clamp_lo);
+  a0 = _mm256_min_epi32(a0, *clamp_hi);
+  a1 = _mm256_max_epi32(a1, *clamp_lo);
+  a1 = _mm256_min_epi32(a1, *clamp_hi);
+
+  *out0 = a0;
+  *out1 = a1;
+}
+
+static void idct16_x8_avx2(const __m256i *in, __m256i *out, int bit,
+                           int range) {
+  const int32_t *cospi = cospi_arr(bit);
+  const __m256i cospi60 = _mm256_set1_epi32(cospi[60]);
+  const __m256i cospim4 = _mm256_set1_epi32(-cospi[4]);
+  const __m256i cospi4 = _mm256_set1_epi32(cospi[4]);
+  const __m256i cospi28 = _mm256_set1_epi32(cospi[28]);
+  const __m256i cospim36 = _mm256_set1_epi32(-cospi[36]);
+  const __m256i cospi36 = _mm256_set1_epi32(cospi[36]);
+  const __m256i cospi44 = _mm256_set1_epi32(cospi[44]);
+  const __m256i cospim20 = _mm256_set1_epi32(-cospi[20]);
+  const __m256i cospi20 = _mm256_set1_epi32(cospi[20]);
+  const __m256i cospi12 = _mm256_set1_epi32(cospi[12]);
+  const __m256i cospim52 = _mm256_set1_epi32(-cospi[52]);
+  const __m256i cospi52 = _mm256_set1_epi32(cospi[52]);
+  const __m256i cospi56 = _mm256_set1_epi32(cospi[56]);
+  const __m256i cospim8 = _mm256_set1_epi32(-cospi[8]);
+  const __m256i cospi8 = _mm256_set1_epi32(cospi[8]);
+  const __m256i cospi24 = _mm256_set1_epi32(cospi[24]);
+  const __m256i cospim40 = _mm256_set1_epi32(-cospi[40]);
+  const __m256i cospi40 = _mm256_set1_epi32(cospi[40]);
+  const __m256i cospi32 = _mm256_set1_epi32(cospi[32]);
+  const __m256i cospim32 = _mm256_set1_epi32(-cospi[32]);
+  const __m256i cospi48 = _mm256_set1_epi32(cospi[48]);
+  const __m256i cospim48 = _mm256_set1_epi32(-cospi[48]);
+  const __m256i cospi16 = _mm256_set1_epi32(cospi[16]);
+  const __m256i cospim16 = _mm256_set1_epi32(-cospi[16]);
+  const __m256i rounding = _mm256_set1_epi32(1 << (bit - 1));
+  const __m256i clamp_lo = _mm256_set1_epi32(-(1 << (range - 1)));
+  const __m256i clamp_hi = _mm256_set1_epi32((1 << (range - 1)) - 1);
+  __m256i x[16];
+  int i;
+
+  // stage 1
+  x[0] = in[0];
+  x[1] = in[8];
+  x[2] = in[4];
+  x[3] = in[12];
+  x[4] = in[2];
+  x[5] = in[10];
+  x[6] = in[6];
+  x[7] = in[14];
+  x[8] = in[1];
+  x[9] = in[9];
+  x[10] = in[5];
+  x[11] = in[13];
+  x[12] = in[3];
+  x[13] = in[11];
+  x[14] = in[7];
+  x[15] = in[15];
+
+  // stage 2
+  btf_avx2(&cospi60, &cospim4, &cospi4, &cospi60, &x[8], &x[15], &rounding,
+           bit);
+  btf_avx2(&cospi28, &cospim36, &cospi36, &cospi28, &x[9], &x[14], &rounding,
+           bit);
+  btf_avx2(&cospi44, &cospim20, &cospi20, &cospi44, &x[10], &x[13], &rounding,
+           bit);
+  btf_avx2(&cospi12, &cospim52, &cospi52, &cospi12, &x[11], &x[12], &rounding,
+           bit);
+
+  // stage 3
+  btf_avx2(&cospi56, &cospim8, &cospi8, &cospi56, &x[4], &x[7], &rounding,
+           bit);
+  btf_avx2(&cospi24, &cospim40, &cospi40, &cospi24, &x[5], &x[6], &rounding,
+           bit);
+  addsub_avx2(x[8], x[9], &x[8], &x[9], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[11], x[10], &x[11], &x[10], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[12], x[13], &x[12], &x[13], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[15], x[14], &x[15], &x[14], &clamp_lo, &clamp_hi);
+
+  // stage 4
+  btf_avx2(&cospi32, &cospi32, &cospi32, &cospim32, &x[0], &x[1], &rounding,
+           bit);
+  btf_avx2(&cospi48, &cospim16, &cospi16, &cospi48, &x[2], &x[3], &rounding,
+           bit);
+  addsub_avx2(x[4], x[5], &x[4], &x[5], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[7], x[6], &x[7], &x[6], &clamp_lo, &clamp_hi);
+  btf_avx2(&cospim16, &cospi48, &cospi48, &cospi16, &x[9], &x[14], &rounding,
+           bit);
+  btf_avx2(&cospim48, &cospim16, &cospim16, &cospi48, &x[10], &x[13],
+           &rounding, bit);
+
+  // stage 5
+  addsub_avx2(x[0], x[3], &x[0], &x[3], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[1], x[2], &x[1], &x[2], &clamp_lo, &clamp_hi);
+  btf_avx2(&cospim32, &cospi32, &cospi32, &cospi32, &x[5], &x[6], &rounding,
+           bit);
+  addsub_avx2(x[8], x[11], &x[8], &x[11], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[9], x[10], &x[9], &x[10], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[15], x[12], &x[15], &x[12], &clamp_lo, &clamp_hi);
+  addsub_avx2(x[14], x[13], &x[14], &x[13], &clamp_lo, &clamp_hi);
+
+  // stage 6
+  for (i = 0; i < 4; ++i) {
+    addsub_avx2(x[i], x[7 - i], &x[i], &x[7 - i], &clamp_lo, &clamp_hi);
+  }
+  btf_avx2(&cospim32, &cospi32, &cospi32, &cospi32, &x[10], &x[13], &rounding,
+           bit);
+  btf_avx2(&cospim32, &cospi32, &cospi32, &cospi32, &x[11], &x[12], &rounding,
+           bit);
+
+  // stage 7
+  for (i = 0; i < 8; ++i) {
+    addsub_avx2(x[i], x[15 - i], &out[i], &out[15 - i], &clamp_lo, &clamp_hi);
+  }
+}
+
+// The even half of the 32-point DCT is the 16-point DCT of the even inputs.
+static void idct32_x8_avx2(const __m256i *in, __m256i *out, int bit,
+                           int range) {
+  const int32_t *cospi = cospi_arr(bit);
+  const __m256i cospi62 = _mm256_set1_epi32(cospi[62]);
+  const __m256i cospim2 = _mm256_set1_epi32(-cospi[2]);
+  const __m256i cospi2 = _mm256_set1_epi32(cospi[2]);
+  const __m256i cospi30 = _mm256_set1_epi32(cospi[30]);
+  const __m256i cospim34 = _mm256_set1_epi32(-cospi[34]);
+  const __m256i cospi34 = _mm256_set1_epi32(cospi[34]);
+  const __m256i cospi46 = _mm256_set1_epi32(cospi[46]);
+  const __m256i cospim18 = _mm256_set1_epi32(-cospi[18]);
+  const __m256i cospi18 = _mm256_set1_epi32(cospi[18]);
+  const __m256i cospi14 = _mm256_set1_epi32(cospi[14]);
+  const __m256i cospim50 = _mm256_set1_epi32(-cospi[50]);
+  const __m256i cospi50 = _mm256_set1_epi32(cospi[50]);
+  const __m256i cospi54 = _mm256_set1_epi32(cospi[54]);
+  const __m256i cospim10 = _mm256_set1_epi32(-cospi[10]);
+  const __m256i cospi10 = _mm256_set1_epi32(cospi[10]);
+  const __m256i cospi22 = _mm256_set1_epi32(cospi[22]);
+  const __m256i cospim42 = _mm256_set1_epi32(-cospi[42]);
+  const __m256i cospi42 = _mm256_set1_epi32(cospi[42]);
+  const __m256i cospi38 = _mm256_set1_epi32(cospi[38]);
+  const __m256i cospim26 = _mm256_set1_epi32(-cospi[26]);
+  const __m256i cospi26 = _mm256_set1_epi32(cospi[26]);
+  const __m256i cospi6 = _mm256_set1_epi32(cospi[6]);
+  const __m256i cospim58 = _mm256_set1_epi32(-cospi[58]);
+  const __m256i cospi58 = _mm256_set1_epi32(cospi[58]);
+  const __m256i cospi56 = _mm256_set1_epi32(cospi[56]);
+  const __m256i cospim56 = _mm256_set1_epi32(-cospi[56]);
+  const __m256i cospi8 = _mm256_set1_epi32(cospi[8]);
+  const __m256i cospim8 = _mm256_set1_epi32(-cospi[8]);
+  const __m256i cospi24 = _mm256_set1_epi32(cospi[24]);
+  const __m256i cospim24 = _mm256_set1_epi32(-cospi[24]);
+  const __m256i cospi40 = _mm256_set1_epi32(cospi[40]);
+  const __m256i cospim40 = _mm256_set1_epi32(-cospi[40]);
+  const __m256i cospi48 = _mm256_set1_epi32(cospi[48]);
+  const __m256i cospim48 = _mm256_set1_epi32(-cospi[48]);
+  const __m256i cospi16 = _mm256_set1_epi32(cospi[16]);
+  const __m256i cospim16 = _mm256_set1_epi32(-cospi[16]);
+  const __m256i cospi32 = _mm256_set1_epi32(cospi[32]);
+  const __m256i cospim32 = _mm256_set1_epi32(-cospi[32]);
+  const __m256i rounding = _mm256_set1_epi32(1 << (bit - 1));
+  const __m256i clamp_lo = _mm256_set1_epi32(-(1 << (range - 1)));
+  const __m256i clamp_hi = _mm256_set1_epi32((1 << (range - 1)) - 1);
+  __m256i even[16], x[32];
+  int i;
+
+  for (i = 0; i < 16; ++i) even[i] = in[2 * i];
+  idct16_x8_avx2(even, x, bit, range);
+
+  // stage 1
+  x[16] = in[1];
+  x[17] = in[17];
+  x[18] = in[9];
+  x[19] = in[25];
+  x[20] = in[5];
+  x[21] = in[21];
+  x[22] = in[13];
+  x[23] = in[29];
+  x[24] = in[3];
+  x[25] = in[19];
+  x[26] = in[11];
+  x[27] = in[27];
+  x[28] = in[7];
+  x[29] = in[23];
+  x[30] = in[15];
+  x[31] = in[31];
+
+  // stage 2
+  btf_avx2(&cospi62, &cospim2, &cospi2, &cospi62, &x[16], &x[31], &rounding,
+           bit);
+  btf_avx2(&cospi30, &cospim34, &cospi34, &cospi30, &x[17], &x[30], &rounding,
+           bit);
+  btf_avx2(&cospi46, &cospim18, &cospi18, &cospi46, &x[18], &x[29], &rounding,
+           bit);
+  btf_avx2(&cospi14, &cospim50, &cospi50, &cospi14, &x[19], &x[28], &rounding,
+           bit);
+  btf_avx2(&cospi54, &cospim10, &cospi10, &cospi54, &x[20], &x[27], &rounding,
+           bit);
+  btf_avx2(&cospi22, &cospim42, &cospi42, &cospi22, &x[21], &x[26], &rounding,
+           bit);
+  btf_avx2(&cospi38, &cospim26, &cospi26, &cospi38, &x[22], &x[25], &rounding,
+           bit);
+  btf_avx2(&cospi6, &cospim58, &cospi58, &cospi6, &x[23], &x[24], &rounding,
+           bit);
+
+  // stage 3
+  for (i = 16; i < 32; i += 4) {
+    addsub_avx2(x[i], x[i + 1], &x[i], &x[i + 1], &clamp_lo, &clamp_hi);
+    addsub_avx2(x[i + 3], x[i + 2], &x[i + 3], &x[i + 2], &clamp_lo,
+                &clamp_hi);
+  }
+
+  // stage 4
+  btf_avx2(&cospim8, &cospi56, &cospi56, &cospi8, &x[17], &x[30], &rounding,
+           bit);
+  btf_avx2(&cospim56, &cospim8, &cospim8, &cospi56, &x[18], &x[29], &rounding,
+           bit);
+  btf_avx2(&cospim40, &cospi24, &cospi24, &cospi40, &x[21], &x[26], &rounding,
+           bit);
+  btf_avx2(&cospim24, &cospim40, &cospim40, &cospi24, &x[22], &x[25],
+           &rounding, bit);
+
+  // stage 5
+  for (i = 16; i < 32; i += 8) {
+    addsub_avx2(x[i], x[i + 3], &x[i], &x[i + 3], &clamp_lo, &clamp_hi);
+    addsub_avx2(x[i + 1], x[i + 2], &x[i + 1], &x[i + 2], &clamp_lo,
+                &clamp_hi);
+    addsub_avx2(x[i + 7], x[i + 4], &x[i + 7], &x[i + 4], &clamp_lo,
+                &clamp_hi);
+    addsub_avx2(x[i + 6], x[i + 5], &x[i + 6], &x[i + 5], &clamp_lo,
+                &clamp_hi);
+  }
+
+  // stage 6
+  btf_avx2(&cospim16, &cospi48, &cospi48, &cospi16, &x[18], &x[29], &rounding,
+           bit);
+  btf_avx2(&cospim16, &cospi48, &cospi48, &cospi16, &x[19], &x[28], &rounding,
+           bit);
+  btf_avx2(&cospim48, &cospim16, &cospim16, &cospi48, &x[20], &x[27],
+           &rounding, bit);
+  btf_avx2(&cospim48, &cospim16, &cospim16, &cospi48, &x[21], &x[26],
+           &rounding, bit);
+
+  // stage 7
+  for (i = 0; i < 4; ++i) {
+    addsub_avx2(x[16 + i], x[23 - i], &x[16 + i], &x[23 - i], &clamp_lo,
+                &clamp_hi);
+    addsub_avx2(x[31 - i], x[24 + i], &x[31 - i], &x[24 + i], &clamp_lo,
+                &clamp_hi);
+  }
+
+  // stage 8
+  for (i = 0; i < 4; ++i) {
+    btf_avx2(&cospim32, &cospi32, &cospi32, &cospi32, &x[20 + i], &x[27 - i],
+             &rounding, bit);
+  }
+
+  // stage 9
+  for (i = 0; i < 16; ++i) {
+    addsub_avx2(x[i], x[31 - i], &out[i], &out[31 - i], &clamp_lo, &clamp_hi);
+  }
+}
+
+// Only the first 32 inputs of the 64-point DCT can be nonzero. The even half
+// is the 32-point DCT of the even inputs.
+static void idct64_x8_avx2(const __m256i *in, __m256i *out, int bit,
+                           int range) {
+  const int32_t *cospi = cospi_arr(bit);
+  const __m256i cospi1 = _mm256_set1_epi32(cospi[1]);
+  const __m256i cospi3 = _mm256_set1_epi32(cospi[3]);
+  const __m256i cospi4 = _mm256_set1_epi32(cospi[4]);
+  const __m256i cospi5 = _mm256_set1_epi32(cospi[5]);
+  const __m256i cospi7 = _mm256_set1_epi32(cospi[7]);
+  const __m256i cospi8 = _mm256_set1_epi32(cospi[8]);
+  const __m256i cospi9 = _mm256_set1_epi32(cospi[9]);
+  const __m256i cospi11 = _mm256_set1_epi32(cospi[11]);
+  const __m256i cospi12 = _mm256_set1_epi32(cospi[12]);
+  const __m256i cospi13 = _mm256_set1_epi32(cospi[13]);
+  const __m256i cospi15 = _mm256_set1_epi32(cospi[15]);
+  const __m256i cospi16 = _mm256_set1_epi32(cospi[16]);
+  const __m256i cospi17 = _mm256_set1_epi32(cospi[17]);
+  const __m256i cospi19 = _mm256_set1_epi32(cospi[19]);
+  const __m256i cospi20 = _mm256_set1_epi32(cospi[20]);
+  const __m256i cospi21 = _mm256_set1_epi32(cospi[21]);
+  const __m256i cospi23 = _mm256_set1_epi32(cospi[23]);
+  const __m256i cospi24 = _mm256_set1_epi32(cospi[24]);
+  const __m256i cospi25 = _mm256_set1_epi32(cospi[25]);
+  const __m256i cospi27 = _mm256_set1_epi32(cospi[27]);
+  const __m256i cospi28 = _mm256_set1_epi32(cospi[28]);
+  const __m256i cospi29 = _mm256_set1_epi32(cospi[29]);
+  const __m256i cospi31 = _mm256_set1_epi32(cospi[31]);
+  const __m256i cospi32 = _mm256_set1_epi32(cospi[32]);
+  const __m256i cospi35 = _mm256_set1_epi32(cospi[35]);
+  const __m256i cospi36 = _mm256_set1_epi32(cospi[36]);
+  const __m256i cospi39 = _mm256_set1_epi32(cospi[39]);
+  const __m256i cospi40 = _mm256_set1_epi32(cospi[40]);
+  const __m256i cospi43 = _mm256_set1_epi32(cospi[43]);
+  const __m256i cospi44 = _mm256_set1_epi32(cospi[44]);
+  const __m256i cospi47 = _mm256_set1_epi32(cospi[47]);
+  const __m256i cospi48 = _mm256_set1_epi32(cospi[48]);
+  const __m256i cospi51 = _mm256_set1_epi32(cospi[51]);
+  const __m256i cospi52 = _mm256_set1_epi32(cospi[52]);
+  const __m256i cospi55 = _mm256_set1_epi32(cospi[55]);
+  const __m256i cospi56 = _mm256_set1_epi32(cospi[56]);
+  const __m256i cospi59 = _mm256_set1_epi32(cospi[59]);
+  const __m256i cospi60 = _mm256_set1_epi32(cospi[60]);
+  const __m256i cospi63 = _mm256_set1_epi32(cospi[63]);
+  const __m256i cospim4 = _mm256_set1_epi32(-cospi[4]);
+  const __m256i cospim8 = _mm256_set1_epi32(-cospi[8]);
+  const __m256i cospim12 = _mm256_set1_epi32(-cospi[12]);
+  const __m256i cospim16 = _mm256_set1_epi32(-cospi[16]);
+  const __m256i cospim20 = _mm256_set1_epi32(-cospi[20]);
+  const __m256i cospim24 = _mm256_set1_epi32(-cospi[24]);
+  const __m256i cospim28 = _mm256_set1_epi32(-cospi[28]);
+  const __m256i cospim32 = _mm256_set1_epi32(-cospi[32]);
+  const __m256i cospim33 = _mm256_set1_epi32(-cospi[33]);
+  const __m256i cospim36 = _mm256_set1_epi32(-cospi[36]);
+  const __m256i cospim37 = _mm256_set1_epi32(-cospi[37]);
+  const __m256i cospim40 = _mm256_set1_epi32(-cospi[40]);
+  const __m256i cospim41 = _mm256_set1_epi32(-cospi[41]);
+  const __m256i cospim44 = _mm256_set1_epi32(-cospi[44]);
+  const __m256i cospim45 = _mm256_set1_epi32(-cospi[45]);
+  const __m256i cospim48 = _mm256_set1_epi32(-cospi[48]);
+  const __m256i cospim49 = _mm256_set1_epi32(-cospi[49]);
+  const __m256i cospim52 = _mm256_set1_epi32(-cospi[52]);
+  const __m256i cospim53 = _mm256_set1_epi32(-cospi[53]);
+  const __m256i cospim56 = _mm256_set1_epi32(-cospi[56]);
+  const __m256i cospim57 = _mm256_set1_epi32(-cospi[57]);
+  const __m256i cospim60 = _mm256_set1_epi32(-cospi[60]);
+  const __m256i cospim61 = _mm256_set1_epi32(-cospi[61]);
+  const __m256i rounding = _mm256_set1_epi32(1 << (bit - 1));
+  const __m256i clamp_lo = _mm256_set1_epi32(-(1 << (range - 1)));
+  const __m256i clamp_hi = _mm256_set1_epi32((1 << (range - 1)) - 1);
+  const __m256i zero = _mm256_setzero_si256();
+  __m256i even[32], x[64];
+  int i, j;
+
+  for (i = 0; i < 16; ++i) even[i] = in[2 * i];
+  for (i = 16; i < 32; ++i) even[i] = zero;
+  idct32_x8_avx2(even, x, bit, range);
+
+  // stages 1 and 2
+  x[32] = half_btf_0_avx2(&cospi63, &in[1], &rounding, bit);
+  x[33] = half_btf_0_avx2(&cospim33, &in[31], &rounding, bit);
+  x[34] = half_btf_0_avx2(&cospi47, &in[17], &rounding, bit);
+  x[35] = half_btf_0_avx2(&cospim49, &in[15], &rounding, bit);
+  x[36] = half_btf_0_avx2(&cospi55, &in[9], &rounding, bit);
+  x[37] = half_btf_0_avx2(&cospim41, &in[23], &rounding, bit);
+  x[38] = half_btf_0_avx2(&cospi39, &in[25], &rounding, bit);
+  x[39] = half_btf_0_avx2(&cospim57, &in[7], &rounding, bit);
+  x[40] = half_btf_0_avx2(&cospi59, &in[5], &rounding, bit);
+  x[41] = half_btf_0_avx2(&cospim37, &in[27], &rounding, bit);
+  x[42] = half_btf_0_avx2(&cospi43, &in[21], &rounding, bit);
+  x[43] = half_btf_0_avx2(&cospim53, &in[11], &rounding, bit);
+  x[44] = half_btf_0_avx2(&cospi51, &in[13], &rounding, bit);
+  x[45] = half_btf_0_avx2(&cospim45, &in[19], &rounding, bit);
+  x[46] = half_btf_0_avx2(&cospi35, &in[29], &rounding, bit);
+  x[47] = half_btf_0_avx2(&cospim61, &in[3], &rounding, bit);
+  x[48] = half_btf_0_avx2(&cospi3, &in[3], &rounding, bit);
+  x[49] = half_btf_0_avx2(&cospi29, &in[29], &rounding, bit);
+  x[50] = half_btf_0_avx2(&cospi19, &in[19], &rounding, bit);
+  x[51] = half_btf_0_avx2(&cospi13, &in[13], &rounding, bit);
+  x[52] = half_btf_0_avx2(&cospi11, &in[11], &rounding, bit);
+  x[53] = half_btf_0_avx2(&cospi21, &in[21], &rounding, bit);
+  x[54] = half_btf_0_avx2(&cospi27, &in[27], &rounding, bit);
+  x[55] = half_btf_0_avx2(&cospi5, &in[5], &rounding, bit);
+  x[56] = half_btf_0_avx2(&cospi7, &in[7], &rounding, bit);
+  x[57] = half_btf_0_avx2(&cospi25, &in[25], &rounding, bit);
+  x[58] = half_btf_0_avx2(&cospi23, &in[23], &rounding, bit);
+  x[59] = half_btf_0_avx2(&cospi9, &in[9], &rounding, bit);
+  x[60] = half_btf_0_avx2(&cospi15, &in[15], &rounding, bit);
+  x[61] = half_btf_0_avx2(&cospi17, &in[17], &rounding, bit);
+  x[62] = half_btf_0_avx2(&cospi31, &in[31], &rounding, bit);
+  x[63] = half_btf_0_avx2(&cospi1, &in[1], &rounding, bit);
+
+  // stage 3
+  for (i = 32; i < 64; i += 4) {
+    addsub_avx2(x[i], x[i + 1], &x[i], &x[i + 1], &clamp_lo, &clamp_hi);
+    addsub_avx2(x[i + 3], x[i + 2], &x[i + 3], &x[i + 2], &clamp_lo,
+                &clamp_hi);
+  }
+
+  // stage 4
+  btf_avx2(&cospim4, &cospi60, &cospi60, &cospi4, &x[33], &x[62], &rounding,
+           bit);
+  btf_avx2(&cospim60, &cospim4, &cospim4, &cospi60, &x[34], &x[61], &rounding,
+           bit);
+  btf_avx2(&cospim36, &cospi28, &cospi28, &cospi36, &x[37], &x[58], &rounding,
+           bit);
+  btf_avx2(&cospim28, &cospim36, &cospim36, &cospi28, &x[38], &x[57],
+           &rounding, bit);
+  btf_avx2(&cospim20, &cospi44, &cospi44, &cospi20, &x[41], &x[54], &rounding,
+           bit);
+  btf_avx2(&cospim44, &cospim20, &cospim20, &cospi44, &x[42], &x[53],
+           &rounding, bit);
+  btf_avx2(&cospim52, &cospi12, &cospi12, &cospi52, &x[45], &x[50], &rounding,
+           bit);
+  btf_avx2(&cospim12, &cospim52, &cospim52, &cospi12, &x[46], &x[49],
+           &rounding, bit);
+
+  // stage 5
+  for (i = 32; i < 64; i += 8) {
+    addsub_avx2(x[i], x[i + 3], &x[i], &x[i + 3], &clamp_lo, &clamp_hi);
+    addsub_avx2(x[i + 1], x[i + 2], &x[i + 1], &x[i + 2], &clamp_lo,
+                &clamp_hi);
+    addsub_avx2(x[i + 7], x[i + 4], &x[i + 7], &x[i + 4], &clamp_lo,
+                &clamp_hi);
+    addsub_avx2(x[i + 6], x[i + 5], &x[i + 6], &x[i + 5], &clamp_lo,
+                &clamp_hi);
+  }
+
+  // stage 6
+  btf_avx2(&cospim8, &cospi56, &cospi56, &cospi8, &x[34], &x[61], &rounding,
+           bit);
+  btf_avx2(&cospim8, &cospi56, &cospi56, &cospi8, &x[35], &x[60], &rounding,
+           bit);
+  btf_avx2(&cospim56, &cospim8, &cospim8, &cospi56, &x[36], &x[59], &rounding,
+           bit);
+  btf_avx2(&cospim56, &cospim8, &cospim8, &cospi56, &x[37], &x[58], &rounding,
+           bit);
+  btf_avx2(&cospim40, &cospi24, &cospi24, &cospi40, &x[42], &x[53], &rounding,
+           bit);
+  btf_avx2(&cospim40, &cospi24, &cospi24, &cospi40, &x[43], &x[52], &rounding,
+           bit);
+  btf_avx2(&cospim24, &cospim40, &cospim40, &cospi24, &x[44], &x[51],
+           &rounding, bit);
+  btf_avx2(&cospim24, &cospim40, &cospim40, &cospi24, &x[45], &x[50],
+           &rounding, bit);
+
+  // stage 7
+  for (i = 32; i < 64; i += 16) {
+    for (j = i; j < i + 4; ++j) {
+      addsub_avx2(x[j], x[j ^ 7], &x[j], &x[j ^ 7], &clamp_lo, &clamp_hi);
+      addsub_avx2(x[j ^ 15], x[j ^ 8], &x[j ^ 15], &x[j ^ 8], &clamp_lo,
+                  &clamp_hi);
+    }
+  }
+
+  // stage 8
+  for (i = 0; i < 4; ++i) {
+    btf_avx2(&cospim16, &cospi48, &cospi48, &cospi16, &x[36 + i], &x[59 - i],
+             &rounding, bit);
+    btf_avx2(&cospim48, &cospim16, &cospim16, &cospi48, &x[40 + i],
+             &x[55 - i], &rounding, bit);
+  }
+
+  // stage 9
+  for (i = 32; i < 40; ++i) {
+    addsub_avx2(x[i], x[i ^ 15], &x[i], &x[i ^ 15], &clamp_lo, &clamp_hi);
+  }
+  for (i = 48; i < 56; ++i) {
+    addsub_avx2(x[i ^ 15], x[i], &x[i ^ 15], &x[i], &clamp_lo, &clamp_hi);
+  }
+
+  // stage 10
+  for (i = 0; i < 8; ++i) {
+    btf_avx2(&cospim32, &cospi32, &cospi32, &cospi32, &x[40 + i], &x[55 - i],
+             &rounding, bit);
+  }
+
+  // stage 11
+  for (i = 0; i < 32; ++i) {
+    addsub_avx2(x[i], x[63 - i], &out[i], &out[63 - i], &clamp_lo, &clamp_hi);
+  }
+}
+
+typedef void (*highbd_transform_1d_avx2)(const __m256i *in, __m256i *out,
+                                         int bit, int range);
+
+// Indexed by the log2 of the transform length minus 2.
+static const highbd_transform_1d_avx2 highbd_idct_x8_arr[TX_SIZES] = {
+  NULL, NULL, idct16_x8_avx2, idct32_x8_avx2, idct64_x8_avx2,
+};
+
+static INLINE void transpose_8x8_avx2(const __m256i *in, __m256i *out) {
+  const __m256i u0 = _mm256_unpacklo_epi32(in[0], in[1]);
+  const __m256i u1 = _mm256_unpackhi_epi32(in[0], in[1]);
+  const __m256i u2 = _mm256_unpacklo_epi32(in[2], in[3]);
+  const __m256i u3 = _mm256_unpackhi_epi32(in[2], in[3]);
+  const __m256i u4 = _mm256_unpacklo_epi32(in[4], in[5]);
+  const __m256i u5 = _mm256_unpackhi_epi32(in[4], in[5]);
+  const __m256i u6 = _mm256_unpacklo_epi32(in[6], in[7]);
+  const __m256i u7 = _mm256_unpackhi_epi32(in[6], in[7]);
+  __m256i x0, x1;
+
+  x0 = _mm256_unpacklo_epi64(u0, u2);
+  x1 = _mm256_unpacklo_epi64(u4, u6);
+  out[0] = _mm256_permute2x128_si256(x0, x1, 0x20);
+  out[4] = _mm256_permute2x128_si256(x0, x1, 0x31);
+
+  x0 = _mm256_unpackhi_epi64(u0, u2);
+  x1 = _mm256_unpackhi_epi64(u4, u6);
+  out[1] = _mm256_permute2x128_si256(x0, x1, 0x20);
+  out[5] = _mm256_permute2x128_si256(x0, x1, 0x31);
+
+  x0 = _mm256_unpacklo_epi64(u1, u3);
+  x1 = _mm256_unpacklo_epi64(u5, u7);
+  out[2] = _mm256_permute2x128_si256(x0, x1, 0x20);
+  out[6] = _mm256_permute2x128_si256(x0, x1, 0x31);
+
+  x0 = _mm256_unpackhi_epi64(u1, u3);
+  x1 = _mm256_unpackhi_epi64(u5, u7);
+  out[3] = _mm256_permute2x128_si256(x0, x1, 0x20);
+  out[7] = _mm256_permute2x128_si256(x0, x1, 0x31);
+}
+
+static INLINE void round_shift_x8_avx2(__m256i *in, int size, int bit) {
+  if (bit <= 0) return;
+  const __m256i rounding = _mm256_set1_epi32(1 << (bit - 1));
+  for (int i = 0; i < size; ++i) {
+    in[i] = _mm256_srai_epi32(_mm256_add_epi32(in[i], rounding), bit);
+  }
+}
+
+static INLINE void round_shift_clamp_x8_avx2(__m256i *in, int size, int bit,
+                                             int range) {
+  const __m256i clamp_lo = _mm256_set1_epi32(-(1 << (range - 1)));
+  const __m256i clamp_hi = _mm256_set1_epi32((1 << (range - 1)) - 1);
+  round_shift_x8_avx2(in, size, bit);
+  for (int i = 0; i < size; ++i) {
+    in[i] = _mm256_min_epi32(_mm256_max_epi32(in[i], clamp_lo), clamp_hi);
+  }
+}
+
+// Adds the residuals in[0] to in[height - 1], one row of eight pixels each, to
+// the predictor in output.
+static INLINE void highbd_write_buffer_8xn_avx2(const __m256i *in,
+                                                uint16_t *output, int stride,
+                                                int height, int bd) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max = _mm256_set1_epi32((1 << bd) - 1);
+  for (int i = 0; i < height; ++i) {
+    const __m128i pred = _mm_loadu_si128((const __m128i *)(output));
+    __m256i res = _mm256_add_epi32(_mm256_cvtepu16_epi32(pred), in[i]);
+    res = _mm256_max_epi32(res, zero);
+    res = _mm256_min_epi32(res, max);
+    res = _mm256_packus_epi32(res, res);
+    res = _mm256_permute4x64_epi64(res, 0x08);
+    _mm_storeu_si128((__m128i *)(output), _mm256_castsi256_si128(res));
+    output += stride;
+  }
+}
+
+// Only the DC coefficient is nonzero, so the residual is the same for every
+// pixel. It is computed with the C arithmetic of the row and column DCTs.
+static void highbd_inv_txfm2d_add_dc_avx2(const int32_t *input,
+                                          uint16_t *output, int stride,
+                                          TX_SIZE tx_size, int bd) {
+  const int8_t *shift = inv_txfm_shift_ls[tx_size];
+  const int txw_idx = get_txw_idx(tx_size);
+  const int txh_idx = get_txh_idx(tx_size);
+  const int cos_bit_col = inv_cos_bit_col[txw_idx][txh_idx];
+  const int cos_bit_row = inv_cos_bit_row[txw_idx][txh_idx];
+  const int txfm_size_col = tx_size_wide[tx_size];
+  const int txfm_size_row = tx_size_high[tx_size];
+  const int rect_type = get_rect_tx_log_ratio(txfm_size_col, txfm_size_row);
+  int32_t dc = input[0];
+
+  if (rect_type == 1 || rect_type == -1) {
+    dc = round_shift((int64_t)dc * NewInvSqrt2, NewSqrt2Bits);
+  }
+  dc = clamp_value(dc, bd + 8);
+  dc = round_shift((int64_t)dc * cospi_arr(cos_bit_row)[32], cos_bit_row);
+  dc = round_shift(dc, -shift[0]);
+  dc = clamp_value(dc, AOMMAX(bd + 6, 16));
+  dc = round_shift((int64_t)dc * cospi_arr(cos_bit_col)[32], cos_bit_col);
+  dc = round_shift(dc, -shift[1]);
+
+  const __m256i res = _mm256_set1_epi32(dc);
+  for (int i = 0; i < txfm_size_col; i += 8) {
+    __m256i buf[64];
+    for (int j = 0; j < txfm_size_row; ++j) buf[j] = res;
+    highbd_write_buffer_8xn_avx2(buf, output + i, stride, txfm_size_row, bd);
+  }
+}
+
+// DCT_DCT for the sizes with a 64-point dimension. Only the coefficients
+// within the bounds given by eob are loaded, and rows of the row transform
+// input that are all zero are skipped.
+static void highbd_inv_txfm2d_add_idct64_avx2(const int32_t *input,
+                                              uint16_t *output, int stride,
+                                              TX_SIZE tx_size, int eob,
+                                              int bd) {
+  if (eob == 1) {
+    highbd_inv_txfm2d_add_dc_avx2(input, output, stride, tx_size, bd);
+    return;
+  }
+
+  __m256i buf[64 * 8];
+  int eobx, eoby;
+  get_eobx_eoby_scan_default(&eobx, &eoby, tx_size, eob);
+  const int8_t *shift = inv_txfm_shift_ls[tx_size];
+  const int txw_idx = get_txw_idx(tx_size);
+  const int txh_idx = get_txh_idx(tx_size);
+  const int cos_bit_col = inv_cos_bit_col[txw_idx][txh_idx];
+  const int cos_bit_row = inv_cos_bit_row[txw_idx][txh_idx];
+  const int txfm_size_col = tx_size_wide[tx_size];
+  const int txfm_size_row = tx_size_high[tx_size];
+  const int buf_size_w_div8 = txfm_size_col >> 3;
+  const int buf_size_h = AOMMIN(32, txfm_size_row);
+  const int input_stride = AOMMIN(32, txfm_size_col);
+  const int buf_size_nonzero_w = (eobx + 8) & ~7;
+  const int buf_size_nonzero_h = (eoby + 8) & ~7;
+  const int rect_type = get_rect_tx_log_ratio(txfm_size_col, txfm_size_row);
+  const int range_row = bd + 8;
+  const int range_col = AOMMAX(bd + 6, 16);
+  const highbd_transform_1d_avx2 row_txfm = highbd_idct_x8_arr[txw_idx];
+  const highbd_transform_1d_avx2 col_txfm = highbd_idct_x8_arr[txh_idx];
+  const __m256i zero = _mm256_setzero_si256();
+
+  assert(row_txfm != NULL);
+  assert(col_txfm != NULL);
+
+  // Rows, eight at a time
+  for (int i = 0; i < buf_size_nonzero_h; i += 8) {
+    __m256i buf0[64], buf1[64];
+    const int32_t *input_row = input + i * input_stride;
+    for (int j = 0; j < buf_size_nonzero_w; j += 8) {
+      __m256i temp[8];
+      for (int k = 0; k < 8; ++k) {
+        temp[k] = _mm256_loadu_si256(
+            (const __m256i *)(input_row + k * input_stride + j));
+      }
+      transpose_8x8_avx2(temp, buf0 + j);
+    }
+    if (rect_type == 1 || rect_type == -1) {
+      const __m256i scale = _mm256_set1_epi32(NewInvSqrt2);
+      const __m256i rounding = _mm256_set1_epi32(1 << (NewSqrt2Bits - 1));
+      for (int j = 0; j < buf_size_nonzero_w; ++j) {
+        buf0[j] = half_btf_0_avx2(&scale, &buf0[j], &rounding, NewSqrt2Bits);
+      }
+    }
+    round_shift_clamp_x8_avx2(buf0, buf_size_nonzero_w, 0, range_row);
+    for (int j = buf_size_nonzero_w; j < input_stride; ++j) buf0[j] = zero;
+
+    row_txfm(buf0, buf1, cos_bit_row, range_row);
+    round_shift_clamp_x8_avx2(buf1, txfm_size_col, -shift[0], range_col);
+
+    for (int j = 0; j < buf_size_w_div8; ++j) {
+      transpose_8x8_avx2(buf1 + 8 * j, buf + j * txfm_size_row + i);
+    }
+  }
+
+  // Columns, eight at a time
+  for (int i = 0; i < buf_size_w_div8; ++i) {
+    __m256i *buf_cur = buf + i * txfm_size_row;
+    __m256i out[64];
+    for (int j = buf_size_nonzero_h; j < buf_size_h; ++j) buf_cur[j] = zero;
+
+    col_txfm(buf_cur, out, cos_bit_col, range_col);
+    round_shift_x8_avx2(out, txfm_size_row, -shift[1]);
+    highbd_write_buffer_8xn_avx2(out, output + 8 * i, stride, txfm_size_row,
+                                 bd);
+  }
+}
+
+void av1_inv_txfm2d_add_64x64_avx2(const int32_t *coeff, uint16_t *output,
+                                   int stride, TX_TYPE tx_type, int bd) {
+  switch (tx_type) {
+    case DCT_DCT:
+      // Only the top-left 32x32 coefficients can be nonzero.
+      highbd_inv_txfm2d_add_idct64_avx2(coeff, output, stride, TX_64X64,
+                                        32 * 32, bd);
+      break;
+    default:
+      av1_inv_txfm2d_add_64x64_c(coeff, output, stride, tx_type, bd);
+      break;
+  }
+}
+
+void av1_highbd_inv_txfm_add_avx2(const tran_low_t *input, uint8_t *dest,
+                                  int stride, const TxfmParam *txfm_param) {
+  const TX_SIZE tx_size = txfm_param->tx_size;
+  switch (tx_size) {
+    case TX_64X64:
+    case TX_32X64:
+    case TX_64X32:
+    case TX_16X64:
+    case TX_64X16:
+      if (txfm_param->tx_type == DCT_DCT) {
+        highbd_inv_txfm2d_add_idct64_avx2(
+            input, CONVERT_TO_SHORTPTR(dest), stride, tx_size,
+            txfm_param->eob, txfm_param->bd);
+        break;
+      }
+      av1_highbd_inv_txfm_add_c(input, dest, stride, txfm_param);
+      break;
+    default:
+      av1_highbd_inv_txfm_add_c(input, dest, stride, txfm_param);
+      break;
+  }
+}
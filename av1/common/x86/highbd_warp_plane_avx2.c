@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/warped_motion.h"
+#include "av1/common/x86/warp_plane_avx2.h"
+
+// Filters one row of both blocks, reading 16 pixels from src for the low lane
+// and from src_hi for the high lane.
+static INLINE __m256i highbd_horiz_filter(const uint16_t *src_lo,
+                                          const uint16_t *src_hi, int sx,
+                                          int sx_hi, int16_t alpha,
+                                          __m256i round_const, __m128i shift) {
+  const __m256i src =
+      yy_set_m128i(xx_loadu_128(src_hi), xx_loadu_128(src_lo));
+  const __m256i src2 =
+      yy_set_m128i(xx_loadu_128(src_hi + 8), xx_loadu_128(src_lo + 8));
+
+  // Filter even-index pixels
+  const __m256i tmp_0 = warp_load_filter(sx + 0 * alpha, sx_hi + 0 * alpha);
+  const __m256i tmp_2 = warp_load_filter(sx + 2 * alpha, sx_hi + 2 * alpha);
+  const __m256i tmp_4 = warp_load_filter(sx + 4 * alpha, sx_hi + 4 * alpha);
+  const __m256i tmp_6 = warp_load_filter(sx + 6 * alpha, sx_hi + 6 * alpha);
+
+  // coeffs 0 1 0 1 2 3 2 3 for pixels 0, 2
+  const __m256i tmp_8 = _mm256_unpacklo_epi32(tmp_0, tmp_2);
+  // coeffs 0 1 0 1 2 3 2 3 for pixels 4, 6
+  const __m256i tmp_10 = _mm256_unpacklo_epi32(tmp_4, tmp_6);
+  // coeffs 4 5 4 5 6 7 6 7 for pixels 0, 2
+  const __m256i tmp_12 = _mm256_unpackhi_epi32(tmp_0, tmp_2);
+  // coeffs 4 5 4 5 6 7 6 7 for pixels 4, 6
+  const __m256i tmp_14 = _mm256_unpackhi_epi32(tmp_4, tmp_6);
+
+  // coeffs 0 1 0 1 0 1 0 1 for pixels 0, 2, 4, 6
+  const __m256i coeff_0 = _mm256_unpacklo_epi64(tmp_8, tmp_10);
+  // coeffs 2 3 2 3 2 3 2 3 for pixels 0, 2, 4, 6
+  const __m256i coeff_2 = _mm256_unpackhi_epi64(tmp_8, tmp_10);
+  // coeffs 4 5 4 5 4 5 4 5 for pixels 0, 2, 4, 6
+  const __m256i coeff_4 = _mm256_unpacklo_epi64(tmp_12, tmp_14);
+  // coeffs 6 7 6 7 6 7 6 7 for pixels 0, 2, 4, 6
+  const __m256i coeff_6 = _mm256_unpackhi_epi64(tmp_12, tmp_14);
+
+  const __m256i res_0 = _mm256_madd_epi16(src, coeff_0);
+  const __m256i res_2 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 4), coeff_2);
+  const __m256i res_4 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 8), coeff_4);
+  const __m256i res_6 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 12), coeff_6);
+
+  __m256i res_even = _mm256_add_epi32(_mm256_add_epi32(res_0, res_4),
+                                      _mm256_add_epi32(res_2, res_6));
+  res_even =
+      _mm256_sra_epi32(_mm256_add_epi32(res_even, round_const), shift);
+
+  // Filter odd-index pixels
+  const __m256i tmp_1 = warp_load_filter(sx + 1 * alpha, sx_hi + 1 * alpha);
+  const __m256i tmp_3 = warp_load_filter(sx + 3 * alpha, sx_hi + 3 * alpha);
+  const __m256i tmp_5 = warp_load_filter(sx + 5 * alpha, sx_hi + 5 * alpha);
+  const __m256i tmp_7 = warp_load_filter(sx + 7 * alpha, sx_hi + 7 * alpha);
+
+  const __m256i tmp_9 = _mm256_unpacklo_epi32(tmp_1, tmp_3);
+  const __m256i tmp_11 = _mm256_unpacklo_epi32(tmp_5, tmp_7);
+  const __m256i tmp_13 = _mm256_unpackhi_epi32(tmp_1, tmp_3);
+  const __m256i tmp_15 = _mm256_unpackhi_epi32(tmp_5, tmp_7);
+
+  const __m256i coeff_1 = _mm256_unpacklo_epi64(tmp_9, tmp_11);
+  const __m256i coeff_3 = _mm256_unpackhi_epi64(tmp_9, tmp_11);
+  const __m256i coeff_5 = _mm256_unpacklo_epi64(tmp_13, tmp_15);
+  const __m256i coeff_7 = _mm256_unpackhi_epi64(tmp_13, tmp_15);
+
+  const __m256i res_1 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 2), coeff_1);
+  const __m256i res_3 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 6), coeff_3);
+  const __m256i res_5 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 10), coeff_5);
+  const __m256i res_7 =
+      _mm256_madd_epi16(_mm256_alignr_epi8(src2, src, 14), coeff_7);
+
+  __m256i res_odd = _mm256_add_epi32(_mm256_add_epi32(res_1, res_5),
+                                     _mm256_add_epi32(res_3, res_7));
+  res_odd = _mm256_sra_epi32(_mm256_add_epi32(res_odd, round_const), shift);
+
+  // Combine results into one register, in the column order
+  // 0, 2, 4, 6, 1, 3, 5, 7 used by the vertical filter.
+  return _mm256_packs_epi32(res_even, res_odd);
+}
+
+void av1_highbd_warp_affine_avx2(const int32_t *mat, const uint16_t *ref,
+                                 int width, int height, int stride,
+                                 uint16_t *pred, int p_col, int p_row,
+                                 int p_width, int p_height, int p_stride,
+                                 int subsampling_x, int subsampling_y, int bd,
+                                 ConvolveParams *conv_params, int16_t alpha,
+                                 int16_t beta, int16_t gamma, int16_t delta) {
+  // Blocks are filtered in pairs, so narrower predictions are left to the
+  // SSE4.1 version.
+  if (p_width & 15) {
+    av1_highbd_warp_affine_sse4_1(mat, ref, width, height, stride, pred, p_col,
+                                  p_row, p_width, p_height, p_stride,
+                                  subsampling_x, subsampling_y, bd,
+                                  conv_params, alpha, beta, gamma, delta);
+    return;
+  }
+
+  const int comp_avg = conv_params->do_average;
+  __m256i tmp[15];
+  const int reduce_bits_horiz =
+      conv_params->round_0 +
+      AOMMAX(bd + FILTER_BITS - conv_params->round_0 - 14, 0);
+  const int reduce_bits_vert = conv_params->is_compound
+                                   ? conv_params->round_1
+                                   : 2 * FILTER_BITS - reduce_bits_horiz;
+  const int offset_bits_horiz = bd + FILTER_BITS - 1;
+  assert(IMPLIES(conv_params->is_compound, conv_params->dst != NULL));
+  assert(!(bd == 12 && reduce_bits_horiz < 5));
+
+  const __m256i horiz_round_const = _mm256_set1_epi32(
+      (1 << offset_bits_horiz) + ((1 << reduce_bits_horiz) >> 1));
+  const __m128i horiz_shift = _mm_cvtsi32_si128(reduce_bits_horiz);
+
+  const int offset_bits_vert = bd + 2 * FILTER_BITS - reduce_bits_horiz;
+  const __m256i clip_pixel = _mm256_set1_epi16((1 << bd) - 1);
+  const __m128i reduce_bits_vert_shift = _mm_cvtsi32_si128(reduce_bits_vert);
+  const __m256i reduce_bits_vert_const =
+      _mm256_set1_epi32(((1 << reduce_bits_vert) >> 1));
+  const __m256i res_add_const = _mm256_set1_epi32(1 << offset_bits_vert);
+  const int round_bits =
+      2 * FILTER_BITS - conv_params->round_0 - conv_params->round_1;
+  const int offset_bits = bd + 2 * FILTER_BITS - conv_params->round_0;
+  const __m256i res_sub_const =
+      _mm256_set1_epi32(-(1 << (offset_bits - conv_params->round_1)) -
+                        (1 << (offset_bits - conv_params->round_1 - 1)));
+  const __m128i round_bits_shift = _mm_cvtsi32_si128(round_bits);
+  const __m256i round_bits_const = _mm256_set1_epi32(((1 << round_bits) >> 1));
+  const __m256i vert_round_const = _mm256_set1_epi32(
+      -(1 << (bd + reduce_bits_vert - 1)) + ((1 << reduce_bits_vert) >> 1));
+
+  const __m256i wt0 = _mm256_set1_epi32(conv_params->fwd_offset);
+  const __m256i wt1 = _mm256_set1_epi32(conv_params->bck_offset);
+  const __m256i zero = _mm256_setzero_si256();
+
+  for (int i = 0; i < p_height; i += 8) {
+    for (int j = 0; j < p_width; j += 16) {
+      WarpBlockPos pos[2];
+      warp_block_pos(mat, p_col + j, p_row + i, subsampling_x, subsampling_y,
+                     alpha, beta, gamma, delta, &pos[0]);
+      warp_block_pos(mat, p_col + j + 8, p_row + i, subsampling_x,
+                     subsampling_y, alpha, beta, gamma, delta, &pos[1]);
+      const int edge_lo = warp_is_edge_block(pos[0].ix4, width);
+      const int edge_hi = warp_is_edge_block(pos[1].ix4, width);
+      const uint16_t *const src_lo =
+          ref + warp_horiz_offset(pos[0].ix4, width);
+      const uint16_t *const src_hi =
+          ref + warp_horiz_offset(pos[1].ix4, width);
+      const int edge_col_lo = pos[0].ix4 <= -7 ? 0 : width - 1;
+      const int edge_col_hi = pos[1].ix4 <= -7 ? 0 : width - 1;
+
+      // Horizontal filter. Each block whose samples would all be taken from
+      // the leftmost/rightmost column gets the constant result of the C code
+      // instead.
+      for (int k = -7; k < AOMMIN(8, p_height - i); ++k) {
+        const int iy = clamp(pos[0].iy4 + k, 0, height - 1);
+        const int iy_hi = clamp(pos[1].iy4 + k, 0, height - 1);
+        const int sx = pos[0].sx4 + beta * (k + 4);
+        const int sx_hi = pos[1].sx4 + beta * (k + 4);
+        __m256i res = edge_lo && edge_hi
+                          ? _mm256_setzero_si256()
+                          : highbd_horiz_filter(
+                                src_lo + iy * stride, src_hi + iy_hi * stride,
+                                sx, sx_hi, alpha, horiz_round_const,
+                                horiz_shift);
+        if (edge_lo) {
+          const int16_t v = warp_edge_value(ref[iy * stride + edge_col_lo], bd,
+                                            reduce_bits_horiz);
+          res = _mm256_blend_epi32(res, _mm256_set1_epi16(v), 0x0F);
+        }
+        if (edge_hi) {
+          const int16_t v = warp_edge_value(
+              ref[iy_hi * stride + edge_col_hi], bd, reduce_bits_horiz);
+          res = _mm256_blend_epi32(res, _mm256_set1_epi16(v), 0xF0);
+        }
+        tmp[k + 7] = res;
+      }
+
+      // Vertical filter
+      for (int k = -4; k < AOMMIN(4, p_height - i - 4); ++k) {
+        const int sy = pos[0].sy4 + delta * (k + 4);
+        const int sy_hi = pos[1].sy4 + delta * (k + 4);
+        uint16_t *const p = &pred[(i + k + 4) * p_stride + j];
+        __m256i res_lo, res_hi;
+        warp_vert_filter(tmp + (k + 4), sy, sy_hi, gamma, &res_lo, &res_hi);
+
+        if (conv_params->is_compound) {
+          CONV_BUF_TYPE *const dst =
+              &conv_params->dst[(i + k + 4) * conv_params->dst_stride + j];
+          res_lo = _mm256_add_epi32(res_lo, res_add_const);
+          res_lo = _mm256_sra_epi32(
+              _mm256_add_epi32(res_lo, reduce_bits_vert_const),
+              reduce_bits_vert_shift);
+          res_hi = _mm256_add_epi32(res_hi, res_add_const);
+          res_hi = _mm256_sra_epi32(
+              _mm256_add_epi32(res_hi, reduce_bits_vert_const),
+              reduce_bits_vert_shift);
+
+          if (conv_params->do_average) {
+            const __m256i p_16 = yy_loadu_256(dst);
+            const __m256i p_lo = _mm256_unpacklo_epi16(p_16, zero);
+            const __m256i p_hi = _mm256_unpackhi_epi16(p_16, zero);
+
+            if (conv_params->use_jnt_comp_avg) {
+              res_lo = _mm256_add_epi32(_mm256_mullo_epi32(p_lo, wt0),
+                                        _mm256_mullo_epi32(res_lo, wt1));
+              res_lo = _mm256_srai_epi32(res_lo, DIST_PRECISION_BITS);
+              res_hi = _mm256_add_epi32(_mm256_mullo_epi32(p_hi, wt0),
+                                        _mm256_mullo_epi32(res_hi, wt1));
+              res_hi = _mm256_srai_epi32(res_hi, DIST_PRECISION_BITS);
+            } else {
+              res_lo = _mm256_srai_epi32(_mm256_add_epi32(p_lo, res_lo), 1);
+              res_hi = _mm256_srai_epi32(_mm256_add_epi32(p_hi, res_hi), 1);
+            }
+
+            res_lo = _mm256_add_epi32(res_lo, res_sub_const);
+            res_lo = _mm256_sra_epi32(
+                _mm256_add_epi32(res_lo, round_bits_const), round_bits_shift);
+            res_hi = _mm256_add_epi32(res_hi, res_sub_const);
+            res_hi = _mm256_sra_epi32(
+                _mm256_add_epi32(res_hi, round_bits_const), round_bits_shift);
+
+            const __m256i res_16 = _mm256_packus_epi32(res_lo, res_hi);
+            yy_storeu_256(p, _mm256_min_epi16(res_16, clip_pixel));
+          } else {
+            yy_storeu_256(dst, _mm256_packus_epi32(res_lo, res_hi));
+          }
+        } else {
+          // Round and pack into 16 bits
+          const __m256i res_lo_round = _mm256_sra_epi32(
+              _mm256_add_epi32(res_lo, vert_round_const),
+              reduce_bits_vert_shift);
+          const __m256i res_hi_round = _mm256_sra_epi32(
+              _mm256_add_epi32(res_hi, vert_round_const),
+              reduce_bits_vert_shift);
+          __m256i res_16bit = _mm256_packs_epi32(res_lo_round, res_hi_round);
+          // Clamp res_16bit to the range [0, 2^bd - 1]
+          res_16bit =
+              _mm256_max_epi16(_mm256_min_epi16(res_16bit, clip_pixel), zero);
+
+          // Store, blending with 'pred' if needed
+          if (comp_avg)
+            res_16bit = _mm256_avg_epu16(res_16bit, yy_loadu_256(p));
+          yy_storeu_256(p, res_16bit);
+        }
+      }
+    }
+  }
+}
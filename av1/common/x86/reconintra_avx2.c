@@ -0,0 +1,264 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+#include "av1/common/x86/reconintra_sse4.h"
+
+static INLINE __m256i dr_interp(__m256i a, __m256i b, __m256i shift_q10) {
+  const __m256i diff = _mm256_sub_epi16(b, a);
+  return _mm256_add_epi16(a, _mm256_mulhrs_epi16(diff, shift_q10));
+}
+
+// Loads the pixels at edge[2 * i] to a and edge[2 * i + 1] to b, for an
+// upsampled edge.
+static INLINE void dr_load_upsampled(const uint16_t *edge, __m256i *a,
+                                     __m256i *b) {
+  const __m256i even_odd = _mm256_setr_epi8(
+      0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8, 9,
+      12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+  const __m256i v0 = _mm256_shuffle_epi8(
+      _mm256_loadu_si256((const __m256i *)edge), even_odd);
+  const __m256i v1 = _mm256_shuffle_epi8(
+      _mm256_loadu_si256((const __m256i *)(edge + 16)), even_odd);
+  // The 64-bit blocks are in the order 0, 2, 1, 3 after the unpack.
+  *a = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(v0, v1), 0xd8);
+  *b = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(v0, v1), 0xd8);
+}
+
+// Stores the first n (4, 8 or 16) 16-bit lanes of v to dst, as 16-bit pixels
+// if store16 is set and as 8-bit pixels otherwise.
+static INLINE void dr_store(void *dst, ptrdiff_t offset, __m256i v, int n,
+                            int store16) {
+  const __m128i lo = _mm256_castsi256_si128(v);
+  if (store16) {
+    uint16_t *const dst16 = (uint16_t *)dst + offset;
+    if (n == 4)
+      _mm_storel_epi64((__m128i *)dst16, lo);
+    else if (n == 8)
+      _mm_storeu_si128((__m128i *)dst16, lo);
+    else
+      _mm256_storeu_si256((__m256i *)dst16, v);
+  } else {
+    uint8_t *const dst8 = (uint8_t *)dst + offset;
+    const __m128i v8 = _mm_packus_epi16(lo, _mm256_extracti128_si256(v, 1));
+    if (n == 4)
+      *(uint32_t *)dst8 = (uint32_t)_mm_cvtsi128_si32(v8);
+    else if (n == 8)
+      _mm_storel_epi64((__m128i *)dst8, v8);
+    else
+      _mm_storeu_si128((__m128i *)dst8, v8);
+  }
+}
+
+// Zone 1 prediction of bh rows of bw pixels from the extended edge. Zone 3 is
+// the same prediction along the left edge, with rows and columns swapped.
+static INLINE void dr_prediction_z1_avx2(void *dst, ptrdiff_t stride, int bw,
+                                         int bh, const uint16_t *edge,
+                                         int upsample, int dx, int max_base,
+                                         int store16) {
+  const int frac_bits = 6 - upsample;
+  const int n = AOMMIN(bw, 16);
+  int r, c, x;
+
+  x = dx;
+  for (r = 0; r < bh; ++r, x += dx) {
+    const int base = x >> frac_bits;
+    const int shift = ((x << upsample) & 0x3F) >> 1;
+    const __m256i shift_q10 = _mm256_set1_epi16(shift << 10);
+
+    if (base >= max_base) {
+      const __m256i last = _mm256_set1_epi16(edge[max_base]);
+      for (; r < bh; ++r)
+        for (c = 0; c < bw; c += 16)
+          dr_store(dst, r * stride + c, last, n, store16);
+      return;
+    }
+
+    for (c = 0; c < bw; c += 16) {
+      __m256i a, b;
+      if (upsample) {
+        dr_load_upsampled(edge + base + 2 * c, &a, &b);
+      } else {
+        a = _mm256_loadu_si256((const __m256i *)(edge + base + c));
+        b = _mm256_loadu_si256((const __m256i *)(edge + base + c + 1));
+      }
+      dr_store(dst, r * stride + c, dr_interp(a, b, shift_q10), n, store16);
+    }
+  }
+}
+
+static INLINE void dr_prediction_z2_avx2(void *dst, ptrdiff_t stride, int bw,
+                                         int bh, const void *above,
+                                         const void *left, int upsample_above,
+                                         int upsample_left, int dx, int dy,
+                                         int highbd) {
+  DECLARE_ALIGNED(32, uint16_t, above_ext[DR_EDGE_SIZE]);
+  DECLARE_ALIGNED(32, uint16_t, pred_left[MAX_TX_SQUARE]);
+  const int min_base_x = -(1 << upsample_above);
+  const int max_base_x = (bw - 1) << upsample_above;
+  const int frac_bits_x = 6 - upsample_above;
+  const int n = AOMMIN(bw, 16);
+  const uint16_t *const ext = above_ext + DR_Z2_EDGE_OFFSET;
+  const __m256i lane =
+      _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  int r, c;
+
+  assert(dx > 0);
+  assert(dy > 0);
+
+  // Only the pixels from min_base_x to max_base_x are used. The rest of the
+  // vectors is discarded.
+  memset(above_ext, 0, sizeof(above_ext));
+  dr_copy_edge(above_ext + DR_Z2_EDGE_OFFSET + min_base_x, above, min_base_x,
+               max_base_x - min_base_x + 1, highbd);
+  dr_z2_predict_left(pred_left, left, bw, bh, upsample_above, upsample_left,
+                     dx, dy, highbd);
+
+  for (r = 0; r < bh; ++r) {
+    const int x = -dx * (r + 1);
+    const int base_x = x >> frac_bits_x;
+    const int shift_x = ((x * (1 << upsample_above)) & 0x3F) >> 1;
+    const __m256i shift_x_q10 = _mm256_set1_epi16(shift_x << 10);
+    const int left_cols =
+        dr_z2_left_cols(base_x, min_base_x, upsample_above, bw);
+
+    for (c = 0; c < bw; c += 16) {
+      const int num_left = AOMMIN(AOMMAX(left_cols - c, 0), 16);
+      const uint16_t *const l = pred_left + r * MAX_TX_SIZE + c;
+      __m256i pred = _mm256_setzero_si256();
+
+      if (num_left < 16) {
+        __m256i a, b;
+        if (upsample_above) {
+          dr_load_upsampled(ext + base_x + 2 * c, &a, &b);
+        } else {
+          a = _mm256_loadu_si256((const __m256i *)(ext + base_x + c));
+          b = _mm256_loadu_si256((const __m256i *)(ext + base_x + c + 1));
+        }
+        pred = dr_interp(a, b, shift_x_q10);
+      }
+      if (num_left > 0) {
+        const __m256i use_left =
+            _mm256_cmpgt_epi16(_mm256_set1_epi16(num_left), lane);
+        // The second 8 columns are only written when one of them is used.
+        const __m256i left_pred =
+            num_left > 8
+                ? _mm256_load_si256((const __m256i *)l)
+                : _mm256_inserti128_si256(
+                      _mm256_setzero_si256(),
+                      _mm_load_si128((const __m128i *)l), 0);
+        pred = _mm256_blendv_epi8(pred, left_pred, use_left);
+      }
+      dr_store(dst, r * stride + c, pred, n, highbd);
+    }
+  }
+}
+
+void av1_dr_prediction_z1_avx2(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                               const uint8_t *above, const uint8_t *left,
+                               int upsample_above, int dx, int dy) {
+  DECLARE_ALIGNED(32, uint16_t, above_ext[DR_EDGE_SIZE]);
+  const int max_base_x = ((bw + bh) - 1) << upsample_above;
+  (void)left;
+  (void)dy;
+  assert(dy == 1);
+  assert(dx > 0);
+
+  dr_extend_edge(above_ext, above, max_base_x, 0);
+  dr_prediction_z1_avx2(dst, stride, bw, bh, above_ext, upsample_above, dx,
+                        max_base_x, 0);
+}
+
+void av1_dr_prediction_z2_avx2(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                               const uint8_t *above, const uint8_t *left,
+                               int upsample_above, int upsample_left, int dx,
+                               int dy) {
+  // The setup of the edges costs more than it saves for the smallest blocks.
+  if (bw + bh < 16) {
+    av1_dr_prediction_z2_c(dst, stride, bw, bh, above, left, upsample_above,
+                           upsample_left, dx, dy);
+    return;
+  }
+  dr_prediction_z2_avx2(dst, stride, bw, bh, above, left, upsample_above,
+                        upsample_left, dx, dy, 0);
+}
+
+void av1_dr_prediction_z3_avx2(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                               const uint8_t *above, const uint8_t *left,
+                               int upsample_left, int dx, int dy) {
+  DECLARE_ALIGNED(32, uint16_t, left_ext[DR_EDGE_SIZE]);
+  DECLARE_ALIGNED(32, uint16_t, tmp[MAX_TX_SQUARE]);
+  const int max_base_y = (bw + bh - 1) << upsample_left;
+  (void)above;
+  (void)dx;
+  assert(dx == 1);
+  assert(dy > 0);
+
+  dr_extend_edge(left_ext, left, max_base_y, 0);
+  dr_prediction_z1_avx2(tmp, MAX_TX_SIZE, bh, bw, left_ext, upsample_left, dy,
+                        max_base_y, 1);
+  dr_store_transposed(dst, stride, tmp, MAX_TX_SIZE, bw, bh, 0);
+}
+
+void av1_highbd_dr_prediction_z1_avx2(uint16_t *dst, ptrdiff_t stride, int bw,
+                                      int bh, const uint16_t *above,
+                                      const uint16_t *left, int upsample_above,
+                                      int dx, int dy, int bd) {
+  DECLARE_ALIGNED(32, uint16_t, above_ext[DR_EDGE_SIZE]);
+  const int max_base_x = ((bw + bh) - 1) << upsample_above;
+  (void)left;
+  (void)dy;
+  (void)bd;
+  assert(dy == 1);
+  assert(dx > 0);
+
+  dr_extend_edge(above_ext, above, max_base_x, 1);
+  dr_prediction_z1_avx2(dst, stride, bw, bh, above_ext, upsample_above, dx,
+                        max_base_x, 1);
+}
+
+void av1_highbd_dr_prediction_z2_avx2(uint16_t *dst, ptrdiff_t stride, int bw,
+                                      int bh, const uint16_t *above,
+                                      const uint16_t *left, int upsample_above,
+                                      int upsample_left, int dx, int dy,
+                                      int bd) {
+  if (bw + bh < 16) {
+    av1_highbd_dr_prediction_z2_c(dst, stride, bw, bh, above, left,
+                                  upsample_above, upsample_left, dx, dy, bd);
+    return;
+  }
+  dr_prediction_z2_avx2(dst, stride, bw, bh, above, left, upsample_above,
+                        upsample_left, dx, dy, 1);
+}
+
+void av1_highbd_dr_prediction_z3_avx2(uint16_t *dst, ptrdiff_t stride, int bw,
+                                      int bh, const uint16_t *above,
+                                      const uint16_t *left, int upsample_left,
+                                      int dx, int dy, int bd) {
+  DECLARE_ALIGNED(32, uint16_t, left_ext[DR_EDGE_SIZE]);
+  DECLARE_ALIGNED(32, uint16_t, tmp[MAX_TX_SQUARE]);
+  const int max_base_y = (bw + bh - 1) << upsample_left;
+  (void)above;
+  (void)dx;
+  (void)bd;
+  assert(dx == 1);
+  assert(dy > 0);
+
+  dr_extend_edge(left_ext, left, max_base_y, 1);
+  dr_prediction_z1_avx2(tmp, MAX_TX_SIZE, bh, bw, left_ext, upsample_left, dy,
+                        max_base_y, 1);
+  dr_store_transposed(dst, stride, tmp, MAX_TX_SIZE, bw, bh, 1);
+}
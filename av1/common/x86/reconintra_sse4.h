@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AV1_COMMON_X86_RECONINTRA_SSE4_H_
+#define AV1_COMMON_X86_RECONINTRA_SSE4_H_
+
+#include <smmintrin.h>
+
+#include "aom_dsp/x86/transpose_sse2.h"
+#include "aom_mem/aom_mem.h"
+#include "av1/common/enums.h"
+
+// Helpers shared by the SSE4.1 and AVX2 directional predictors. Both bit
+// depths are predicted from 16-bit copies of the edges, padded so that whole
+// vectors can be loaded, and the interpolation
+//   (a * (32 - shift) + b * shift + 16) >> 5
+// is computed as a + mulhrs(b - a, shift << 10), which is exact for pixels of
+// up to 15 bits.
+
+// Size of the edge copies. Zone 1 and 3 read at most MAX_TX_SIZE pixels plus a
+// vector past the last edge pixel, at index 2 * MAX_TX_SIZE - 1.
+#define DR_EDGE_SIZE (3 * MAX_TX_SIZE + 32)
+// Zone 2 reads up to a vector of pixels before the top-left pixel.
+#define DR_Z2_EDGE_OFFSET 40
+
+// Copies count pixels of edge, from index start on, to ext.
+static INLINE void dr_copy_edge(uint16_t *ext, const void *edge, int start,
+                                int count, int highbd) {
+  int i = 0;
+  if (highbd) {
+    memcpy(ext, (const uint16_t *)edge + start, count * sizeof(*ext));
+  } else {
+    const uint8_t *const edge8 = (const uint8_t *)edge + start;
+    for (; i + 8 <= count; i += 8)
+      _mm_storeu_si128((__m128i *)(ext + i),
+                       _mm_cvtepu8_epi16(_mm_loadl_epi64(
+                           (const __m128i *)(edge8 + i))));
+    for (; i < count; ++i) ext[i] = edge8[i];
+  }
+}
+
+// Copies the edge of zone 1 or 3, up to max_base, and repeats the last pixel
+// over the rest of ext. Interpolating past max_base then gives edge[max_base],
+// as the C code does.
+static INLINE void dr_extend_edge(uint16_t *ext, const void *edge,
+                                  int max_base, int highbd) {
+  const int last = highbd ? ((const uint16_t *)edge)[max_base]
+                          : ((const uint8_t *)edge)[max_base];
+  const __m128i last_v = _mm_set1_epi16(last);
+  int i;
+  dr_copy_edge(ext, edge, 0, max_base + 1, highbd);
+  for (i = max_base + 1; i + 8 <= DR_EDGE_SIZE; i += 8)
+    _mm_storeu_si128((__m128i *)(ext + i), last_v);
+  for (; i < DR_EDGE_SIZE; ++i) ext[i] = last;
+}
+
+// Number of the first columns of a zone 2 row that are predicted from the
+// left edge, when the above edge starts at base.
+static INLINE int dr_z2_left_cols(int base, int min_base, int upsample,
+                                  int bw) {
+  if (base >= min_base) return 0;
+  return AOMMIN(bw, (min_base - base + (1 << upsample) - 1) >> upsample);
+}
+
+// Predicts the pixels of a zone 2 block that come from the left edge, to
+// pred with a stride of MAX_TX_SIZE. Along a column the left edge is read at
+// consecutive positions with the same shift, so the columns are predicted
+// like the rows of zone 1 and transposed. Only the 8x8 blocks that have
+// pixels predicted from the left edge are written.
+static INLINE void dr_z2_predict_left(uint16_t *pred, const void *left, int bw,
+                                      int bh, int upsample_above,
+                                      int upsample_left, int dx, int dy,
+                                      int highbd) {
+  DECLARE_ALIGNED(16, uint16_t, left_ext[DR_EDGE_SIZE]);
+  DECLARE_ALIGNED(16, uint16_t, cols[MAX_TX_SQUARE]);
+  const int min_base_x = -(1 << upsample_above);
+  const int frac_bits_x = 6 - upsample_above;
+  const int min_base_y = -(1 << upsample_left);
+  const int max_base_y = (bh - 1) << upsample_left;
+  const int frac_bits_y = 6 - upsample_left;
+  const int bh8 = (bh + 7) & ~7;
+  const uint16_t *const ext = left_ext + DR_Z2_EDGE_OFFSET;
+  int r = 0, c, cb, i;
+
+  memset(left_ext, 0, sizeof(left_ext));
+  dr_copy_edge(left_ext + DR_Z2_EDGE_OFFSET + min_base_y, left, min_base_y,
+               max_base_y - min_base_y + 1, highbd);
+
+  for (cb = 0; cb < bw; cb += 8) {
+    // The first row with a pixel of this block of columns from the left edge.
+    // It only moves down for the blocks to the right.
+    while (r < bh &&
+           dr_z2_left_cols((-dx * (r + 1)) >> frac_bits_x, min_base_x,
+                           upsample_above, bw) <= cb)
+      ++r;
+    if (r == bh) break;
+    const int r0 = r & ~7;
+
+    for (c = cb; c < cb + 8; ++c) {
+      const int y = -(c + 1) * dy;
+      const int base = y >> frac_bits_y;
+      const int shift = ((y * (1 << upsample_left)) & 0x3F) >> 1;
+      const __m128i shift_q10 = _mm_set1_epi16(shift << 10);
+      int rr;
+      for (rr = r0; rr < bh8; rr += 8) {
+        const int first = base + (rr << upsample_left);
+        __m128i a, b;
+        // The whole vector is predicted from the above edge. Its loads could
+        // go past the start of left_ext.
+        if (first + (7 << upsample_left) < min_base_y) {
+          _mm_storeu_si128((__m128i *)(cols + c * MAX_TX_SIZE + rr),
+                           _mm_setzero_si128());
+          continue;
+        }
+        if (upsample_left) {
+          const __m128i even_odd = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2,
+                                                 3, 6, 7, 10, 11, 14, 15);
+          const __m128i v0 = _mm_shuffle_epi8(
+              _mm_loadu_si128((const __m128i *)(ext + first)), even_odd);
+          const __m128i v1 = _mm_shuffle_epi8(
+              _mm_loadu_si128((const __m128i *)(ext + first + 8)), even_odd);
+          a = _mm_unpacklo_epi64(v0, v1);
+          b = _mm_unpackhi_epi64(v0, v1);
+        } else {
+          a = _mm_loadu_si128((const __m128i *)(ext + first));
+          b = _mm_loadu_si128((const __m128i *)(ext + first + 1));
+        }
+        _mm_storeu_si128(
+            (__m128i *)(cols + c * MAX_TX_SIZE + rr),
+            _mm_add_epi16(a, _mm_mulhrs_epi16(_mm_sub_epi16(b, a), shift_q10)));
+      }
+    }
+
+    for (i = r0; i < bh8; i += 8) {
+      __m128i in[8], out[8];
+      for (c = 0; c < 8; ++c)
+        in[c] = _mm_loadu_si128(
+            (const __m128i *)(cols + (cb + c) * MAX_TX_SIZE + i));
+      transpose_16bit_8x8(in, out);
+      for (c = 0; c < 8; ++c)
+        _mm_storeu_si128((__m128i *)(pred + (i + c) * MAX_TX_SIZE + cb),
+                         out[c]);
+    }
+  }
+}
+
+// Stores the 16-bit rows of tmp to dst with rows and columns swapped: the bw
+// rows of bh pixels in tmp become bh rows of bw pixels in dst.
+static INLINE void dr_store_transposed(void *dst, ptrdiff_t stride,
+                                       const uint16_t *tmp, int tmp_stride,
+                                       int bw, int bh, int highbd) {
+  int r, c, i;
+  if ((bw & 7) || (bh & 7)) {
+    for (r = 0; r < bh; ++r) {
+      for (c = 0; c < bw; ++c) {
+        if (highbd)
+          ((uint16_t *)dst)[r * stride + c] = tmp[c * tmp_stride + r];
+        else
+          ((uint8_t *)dst)[r * stride + c] = (uint8_t)tmp[c * tmp_stride + r];
+      }
+    }
+    return;
+  }
+  for (c = 0; c < bw; c += 8) {
+    for (r = 0; r < bh; r += 8) {
+      __m128i in[8], out[8];
+      for (i = 0; i < 8; ++i)
+        in[i] = _mm_loadu_si128(
+            (const __m128i *)(tmp + (c + i) * tmp_stride + r));
+      transpose_16bit_8x8(in, out);
+      for (i = 0; i < 8; ++i) {
+        if (highbd)
+          _mm_storeu_si128(
+              (__m128i *)((uint16_t *)dst + (r + i) * stride + c), out[i]);
+        else
+          _mm_storel_epi64((__m128i *)((uint8_t *)dst + (r + i) * stride + c),
+                           _mm_packus_epi16(out[i], out[i]));
+      }
+    }
+  }
+}
+
+#endif  // AV1_COMMON_X86_RECONINTRA_SSE4_H_
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "av1/common/warped_motion.h"
+#include "av1/common/x86/warp_plane_avx2.h"
+
+// Shuffle masks: we want to convert a sequence of bytes 0, 1, 2, ..., 15
+// in each lane into two sequences:
+// 0, 2, 2, 4, ..., 12, 12, 14, <don't care>
+// 1, 3, 3, 5, ..., 13, 13, 15, <don't care>
+static const uint8_t even_mask[32] = { 0, 2,  2,  4,  4,  6,  6,  8,
+                                       8, 10, 10, 12, 12, 14, 14, 0,
+                                       0, 2,  2,  4,  4,  6,  6,  8,
+                                       8, 10, 10, 12, 12, 14, 14, 0 };
+static const uint8_t odd_mask[32] = { 1, 3,  3,  5,  5,  7,  7,  9,
+                                      9, 11, 11, 13, 13, 15, 15, 0,
+                                      1, 3,  3,  5,  5,  7,  7,  9,
+                                      9, 11, 11, 13, 13, 15, 15, 0 };
+
+static INLINE __m256i load_filter_8bit(int sx, int sx_hi) {
+  const __m128i lo = xx_loadl_64(av1_filter_8bit[sx >> WARPEDDIFF_PREC_BITS]);
+  const __m128i hi =
+      xx_loadl_64(av1_filter_8bit[sx_hi >> WARPEDDIFF_PREC_BITS]);
+  return yy_set_m128i(hi, lo);
+}
+
+// Filters one row of both blocks, reading 16 pixels from src for the low lane
+// and from src_hi for the high lane.
+static INLINE __m256i horiz_filter(const uint8_t *src_lo, const uint8_t *src_hi,
+                                   int sx, int sx_hi, int16_t alpha,
+                                   __m256i round_const, __m128i shift) {
+  const __m256i src = yy_set_m128i(xx_loadu_128(src_hi), xx_loadu_128(src_lo));
+  const __m256i src_even = _mm256_shuffle_epi8(src, yy_loadu_256(even_mask));
+  const __m256i src_odd = _mm256_shuffle_epi8(src, yy_loadu_256(odd_mask));
+
+  const __m256i tmp_0 = load_filter_8bit(sx + 0 * alpha, sx_hi + 0 * alpha);
+  const __m256i tmp_1 = load_filter_8bit(sx + 1 * alpha, sx_hi + 1 * alpha);
+  const __m256i tmp_2 = load_filter_8bit(sx + 2 * alpha, sx_hi + 2 * alpha);
+  const __m256i tmp_3 = load_filter_8bit(sx + 3 * alpha, sx_hi + 3 * alpha);
+  const __m256i tmp_4 = load_filter_8bit(sx + 4 * alpha, sx_hi + 4 * alpha);
+  const __m256i tmp_5 = load_filter_8bit(sx + 5 * alpha, sx_hi + 5 * alpha);
+  const __m256i tmp_6 = load_filter_8bit(sx + 6 * alpha, sx_hi + 6 * alpha);
+  const __m256i tmp_7 = load_filter_8bit(sx + 7 * alpha, sx_hi + 7 * alpha);
+
+  // Coeffs 0 2 0 2 4 6 4 6 1 3 1 3 5 7 5 7 for pixels 0 2
+  const __m256i tmp_8 = _mm256_unpacklo_epi16(tmp_0, tmp_2);
+  // Coeffs 0 2 0 2 4 6 4 6 1 3 1 3 5 7 5 7 for pixels 1 3
+  const __m256i tmp_9 = _mm256_unpacklo_epi16(tmp_1, tmp_3);
+  // Coeffs 0 2 0 2 4 6 4 6 1 3 1 3 5 7 5 7 for pixels 4 6
+  const __m256i tmp_10 = _mm256_unpacklo_epi16(tmp_4, tmp_6);
+  // Coeffs 0 2 0 2 4 6 4 6 1 3 1 3 5 7 5 7 for pixels 5 7
+  const __m256i tmp_11 = _mm256_unpacklo_epi16(tmp_5, tmp_7);
+
+  // Coeffs 0 2 0 2 0 2 0 2 4 6 4 6 4 6 4 6 for pixels 0 2 4 6
+  const __m256i tmp_12 = _mm256_unpacklo_epi32(tmp_8, tmp_10);
+  // Coeffs 1 3 1 3 1 3 1 3 5 7 5 7 5 7 5 7 for pixels 0 2 4 6
+  const __m256i tmp_13 = _mm256_unpackhi_epi32(tmp_8, tmp_10);
+  // Coeffs 0 2 0 2 0 2 0 2 4 6 4 6 4 6 4 6 for pixels 1 3 5 7
+  const __m256i tmp_14 = _mm256_unpacklo_epi32(tmp_9, tmp_11);
+  // Coeffs 1 3 1 3 1 3 1 3 5 7 5 7 5 7 5 7 for pixels 1 3 5 7
+  const __m256i tmp_15 = _mm256_unpackhi_epi32(tmp_9, tmp_11);
+
+  // Coeffs 0 2 for pixels 0 2 4 6 1 3 5 7
+  const __m256i coeff_02 = _mm256_unpacklo_epi64(tmp_12, tmp_14);
+  // Coeffs 4 6 for pixels 0 2 4 6 1 3 5 7
+  const __m256i coeff_46 = _mm256_unpackhi_epi64(tmp_12, tmp_14);
+  // Coeffs 1 3 for pixels 0 2 4 6 1 3 5 7
+  const __m256i coeff_13 = _mm256_unpacklo_epi64(tmp_13, tmp_15);
+  // Coeffs 5 7 for pixels 0 2 4 6 1 3 5 7
+  const __m256i coeff_57 = _mm256_unpackhi_epi64(tmp_13, tmp_15);
+
+  // The pixel order we need for 'src' is:
+  // 0 2 2 4 4 6 6 8 1 3 3 5 5 7 7 9
+  const __m256i src_02 = _mm256_unpacklo_epi64(src_even, src_odd);
+  const __m256i res_02 = _mm256_maddubs_epi16(src_02, coeff_02);
+  // 4 6 6 8 8 10 10 12 5 7 7 9 9 11 11 13
+  const __m256i src_46 = _mm256_unpacklo_epi64(_mm256_srli_si256(src_even, 4),
+                                               _mm256_srli_si256(src_odd, 4));
+  const __m256i res_46 = _mm256_maddubs_epi16(src_46, coeff_46);
+  // 1 3 3 5 5 7 7 9 2 4 4 6 6 8 8 10
+  const __m256i src_13 =
+      _mm256_unpacklo_epi64(src_odd, _mm256_srli_si256(src_even, 2));
+  const __m256i res_13 = _mm256_maddubs_epi16(src_13, coeff_13);
+  // 5 7 7 9 9 11 11 13 6 8 8 10 10 12 12 14
+  const __m256i src_57 = _mm256_unpacklo_epi64(_mm256_srli_si256(src_odd, 4),
+                                               _mm256_srli_si256(src_even, 6));
+  const __m256i res_57 = _mm256_maddubs_epi16(src_57, coeff_57);
+
+  // As in the SSE4.1 version, the sum of all four products only fits into
+  // a uint16 once round_const has been added, which relies on the wrapping
+  // behaviour of _mm256_add_epi16().
+  const __m256i res_even = _mm256_add_epi16(res_02, res_46);
+  const __m256i res_odd = _mm256_add_epi16(res_13, res_57);
+  const __m256i res =
+      _mm256_add_epi16(_mm256_add_epi16(res_even, res_odd), round_const);
+  return _mm256_srl_epi16(res, shift);
+}
+
+void av1_warp_affine_avx2(const int32_t *mat, const uint8_t *ref, int width,
+                          int height, int stride, uint8_t *pred, int p_col,
+                          int p_row, int p_width, int p_height, int p_stride,
+                          int subsampling_x, int subsampling_y,
+                          ConvolveParams *conv_params, int16_t alpha,
+                          int16_t beta, int16_t gamma, int16_t delta) {
+  // Blocks are filtered in pairs, so narrower predictions are left to the
+  // SSE4.1 version.
+  if (p_width & 15) {
+    av1_warp_affine_sse4_1(mat, ref, width, height, stride, pred, p_col, p_row,
+                           p_width, p_height, p_stride, subsampling_x,
+                           subsampling_y, conv_params, alpha, beta, gamma,
+                           delta);
+    return;
+  }
+
+  const int comp_avg = conv_params->do_average;
+  __m256i tmp[15];
+  const int bd = 8;
+  const int reduce_bits_horiz = conv_params->round_0;
+  const int reduce_bits_vert = conv_params->is_compound
+                                   ? conv_params->round_1
+                                   : 2 * FILTER_BITS - reduce_bits_horiz;
+  const int offset_bits_horiz = bd + FILTER_BITS - 1;
+  assert(IMPLIES(conv_params->is_compound, conv_params->dst != NULL));
+
+  const __m256i horiz_round_const = _mm256_set1_epi16(
+      (1 << offset_bits_horiz) + ((1 << reduce_bits_horiz) >> 1));
+  const __m128i horiz_shift = _mm_cvtsi32_si128(reduce_bits_horiz);
+
+  const int offset_bits_vert = bd + 2 * FILTER_BITS - reduce_bits_horiz;
+  const __m128i reduce_bits_vert_shift = _mm_cvtsi32_si128(reduce_bits_vert);
+  const __m256i reduce_bits_vert_const =
+      _mm256_set1_epi32(((1 << reduce_bits_vert) >> 1));
+  const __m256i res_add_const = _mm256_set1_epi32(1 << offset_bits_vert);
+  const int round_bits =
+      2 * FILTER_BITS - conv_params->round_0 - conv_params->round_1;
+  const int offset_bits = bd + 2 * FILTER_BITS - conv_params->round_0;
+  const __m256i res_sub_const =
+      _mm256_set1_epi16(-(1 << (offset_bits - conv_params->round_1)) -
+                        (1 << (offset_bits - conv_params->round_1 - 1)));
+  const __m128i round_bits_shift = _mm_cvtsi32_si128(round_bits);
+  const __m256i round_bits_const = _mm256_set1_epi16(((1 << round_bits) >> 1));
+  const __m256i vert_round_const = _mm256_set1_epi32(
+      -(1 << (bd + reduce_bits_vert - 1)) + ((1 << reduce_bits_vert) >> 1));
+
+  const __m256i wt = _mm256_set1_epi32(
+      (uint16_t)conv_params->fwd_offset | (conv_params->bck_offset << 16));
+
+  for (int i = 0; i < p_height; i += 8) {
+    for (int j = 0; j < p_width; j += 16) {
+      WarpBlockPos pos[2];
+      warp_block_pos(mat, p_col + j, p_row + i, subsampling_x, subsampling_y,
+                     alpha, beta, gamma, delta, &pos[0]);
+      warp_block_pos(mat, p_col + j + 8, p_row + i, subsampling_x,
+                     subsampling_y, alpha, beta, gamma, delta, &pos[1]);
+      const int edge_lo = warp_is_edge_block(pos[0].ix4, width);
+      const int edge_hi = warp_is_edge_block(pos[1].ix4, width);
+      const uint8_t *const src_lo = ref + warp_horiz_offset(pos[0].ix4, width);
+      const uint8_t *const src_hi = ref + warp_horiz_offset(pos[1].ix4, width);
+      const int edge_col_lo = pos[0].ix4 <= -7 ? 0 : width - 1;
+      const int edge_col_hi = pos[1].ix4 <= -7 ? 0 : width - 1;
+
+      // Horizontal filter. Each block whose samples would all be taken from
+      // the leftmost/rightmost column gets the constant result of the C code
+      // instead.
+      for (int k = -7; k < AOMMIN(8, p_height - i); ++k) {
+        const int iy = clamp(pos[0].iy4 + k, 0, height - 1);
+        const int iy_hi = clamp(pos[1].iy4 + k, 0, height - 1);
+        const int sx = pos[0].sx4 + beta * (k + 4);
+        const int sx_hi = pos[1].sx4 + beta * (k + 4);
+        __m256i res =
+            edge_lo && edge_hi
+                ? _mm256_setzero_si256()
+                : horiz_filter(src_lo + iy * stride, src_hi + iy_hi * stride,
+                               sx, sx_hi, alpha, horiz_round_const,
+                               horiz_shift);
+        if (edge_lo) {
+          const int16_t v = warp_edge_value(ref[iy * stride + edge_col_lo], bd,
+                                            reduce_bits_horiz);
+          res = _mm256_blend_epi32(res, _mm256_set1_epi16(v), 0x0F);
+        }
+        if (edge_hi) {
+          const int16_t v = warp_edge_value(
+              ref[iy_hi * stride + edge_col_hi], bd, reduce_bits_horiz);
+          res = _mm256_blend_epi32(res, _mm256_set1_epi16(v), 0xF0);
+        }
+        tmp[k + 7] = res;
+      }
+
+      // Vertical filter
+      for (int k = -4; k < AOMMIN(4, p_height - i - 4); ++k) {
+        const int sy = pos[0].sy4 + delta * (k + 4);
+        const int sy_hi = pos[1].sy4 + delta * (k + 4);
+        uint8_t *const p = &pred[(i + k + 4) * p_stride + j];
+        __m256i res_lo, res_hi;
+        warp_vert_filter(tmp + (k + 4), sy, sy_hi, gamma, &res_lo, &res_hi);
+
+        if (conv_params->is_compound) {
+          CONV_BUF_TYPE *const dst =
+              &conv_params->dst[(i + k + 4) * conv_params->dst_stride + j];
+          res_lo = _mm256_add_epi32(res_lo, res_add_const);
+          res_lo = _mm256_sra_epi32(
+              _mm256_add_epi32(res_lo, reduce_bits_vert_const),
+              reduce_bits_vert_shift);
+          res_hi = _mm256_add_epi32(res_hi, res_add_const);
+          res_hi = _mm256_sra_epi32(
+              _mm256_add_epi32(res_hi, reduce_bits_vert_const),
+              reduce_bits_vert_shift);
+          const __m256i res_16 = _mm256_packus_epi32(res_lo, res_hi);
+
+          if (conv_params->do_average) {
+            const __m256i p_16 = yy_loadu_256(dst);
+            __m256i avg_16;
+
+            if (conv_params->use_jnt_comp_avg) {
+              const __m256i wt_res_lo =
+                  _mm256_madd_epi16(_mm256_unpacklo_epi16(p_16, res_16), wt);
+              const __m256i wt_res_hi =
+                  _mm256_madd_epi16(_mm256_unpackhi_epi16(p_16, res_16), wt);
+              avg_16 = _mm256_packus_epi32(
+                  _mm256_srai_epi32(wt_res_lo, DIST_PRECISION_BITS),
+                  _mm256_srai_epi32(wt_res_hi, DIST_PRECISION_BITS));
+            } else {
+              avg_16 = _mm256_srai_epi16(_mm256_add_epi16(p_16, res_16), 1);
+            }
+
+            avg_16 = _mm256_add_epi16(avg_16, res_sub_const);
+            avg_16 = _mm256_sra_epi16(
+                _mm256_add_epi16(avg_16, round_bits_const), round_bits_shift);
+            // Each lane holds the 8 pixels of its block twice.
+            const __m256i res_8 = _mm256_permute4x64_epi64(
+                _mm256_packus_epi16(avg_16, avg_16), 0x08);
+            xx_storeu_128(p, _mm256_castsi256_si128(res_8));
+          } else {
+            yy_storeu_256(dst, res_16);
+          }
+        } else {
+          // Round and pack into 8 bits
+          const __m256i res_lo_round = _mm256_sra_epi32(
+              _mm256_add_epi32(res_lo, vert_round_const),
+              reduce_bits_vert_shift);
+          const __m256i res_hi_round = _mm256_sra_epi32(
+              _mm256_add_epi32(res_hi, vert_round_const),
+              reduce_bits_vert_shift);
+          const __m256i res_16bit =
+              _mm256_packs_epi32(res_lo_round, res_hi_round);
+          const __m256i res_8 = _mm256_permute4x64_epi64(
+              _mm256_packus_epi16(res_16bit, res_16bit), 0x08);
+          __m128i res_8bit = _mm256_castsi256_si128(res_8);
+
+          // Store, blending with 'pred' if needed
+          if (comp_avg) res_8bit = _mm_avg_epu8(res_8bit, xx_loadu_128(p));
+          xx_storeu_128(p, res_8bit);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#ifndef AV1_COMMON_X86_WARP_PLANE_AVX2_H_
+#define AV1_COMMON_X86_WARP_PLANE_AVX2_H_
+
+#include <immintrin.h>
+
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_dsp/x86/synonyms_avx2.h"
+#include "av1/common/warped_motion.h"
+
+// Helpers shared by the 8-bit and high bitdepth AVX2 warp filters. Both filter
+// two horizontally adjacent 8x8 blocks at once, the left block in the low
+// 128-bit lane and the right block in the high lane. Every step after the
+// per-block setup is the lane-wise equivalent of the SSE4.1 code, so the
+// intermediate rows hold the columns in the order 0, 2, 4, 6, 1, 3, 5, 7.
+
+// Position of one 8x8 block in the reference frame, as computed at the top of
+// the block loop of av1_warp_affine_c().
+typedef struct {
+  int32_t ix4, iy4;
+  int32_t sx4, sy4;
+} WarpBlockPos;
+
+static INLINE void warp_block_pos(const int32_t *mat, int p_col, int p_row,
+                                  int subsampling_x, int subsampling_y,
+                                  int16_t alpha, int16_t beta, int16_t gamma,
+                                  int16_t delta, WarpBlockPos *pos) {
+  const int32_t src_x = (p_col + 4) << subsampling_x;
+  const int32_t src_y = (p_row + 4) << subsampling_y;
+  const int32_t dst_x = mat[2] * src_x + mat[3] * src_y + mat[0];
+  const int32_t dst_y = mat[4] * src_x + mat[5] * src_y + mat[1];
+  const int32_t x4 = dst_x >> subsampling_x;
+  const int32_t y4 = dst_y >> subsampling_y;
+
+  pos->ix4 = x4 >> WARPEDMODEL_PREC_BITS;
+  pos->iy4 = y4 >> WARPEDMODEL_PREC_BITS;
+  pos->sx4 = x4 & ((1 << WARPEDMODEL_PREC_BITS) - 1);
+  pos->sy4 = y4 & ((1 << WARPEDMODEL_PREC_BITS) - 1);
+
+  // Add in all the constant terms, including rounding and offset
+  pos->sx4 += alpha * (-4) + beta * (-4) + (1 << (WARPEDDIFF_PREC_BITS - 1)) +
+              (WARPEDPIXEL_PREC_SHIFTS << WARPEDDIFF_PREC_BITS);
+  pos->sy4 += gamma * (-4) + delta * (-4) + (1 << (WARPEDDIFF_PREC_BITS - 1)) +
+              (WARPEDPIXEL_PREC_SHIFTS << WARPEDDIFF_PREC_BITS);
+
+  pos->sx4 &= ~((1 << WARP_PARAM_REDUCE_BITS) - 1);
+  pos->sy4 &= ~((1 << WARP_PARAM_REDUCE_BITS) - 1);
+}
+
+// Returns 1 if, after clamping, every sample of the block would be taken from
+// the leftmost or rightmost column, so the horizontal filter is a constant.
+static INLINE int warp_is_edge_block(int32_t ix4, int width) {
+  return ix4 <= -7 || ix4 >= width + 6;
+}
+
+// Returns the offset of the first pixel read by the horizontal filter. For
+// edge blocks the position is clamped so that the (discarded) filter output
+// stays within the 13 pixel frame border.
+static INLINE int warp_horiz_offset(int32_t ix4, int width) {
+  return clamp(ix4, -6, width + 5) - 7;
+}
+
+// Returns the horizontal filter output of an edge block for a row whose edge
+// pixel is 'pixel'.
+static INLINE int16_t warp_edge_value(int pixel, int bd,
+                                      int reduce_bits_horiz) {
+  return (1 << (bd + FILTER_BITS - reduce_bits_horiz - 1)) +
+         pixel * (1 << (FILTER_BITS - reduce_bits_horiz));
+}
+
+// Returns the warped_filter taps for the position sx of the low lane block
+// and sx_hi of the high lane block.
+static INLINE __m256i warp_load_filter(int sx, int sx_hi) {
+  const __m128i lo = xx_loadu_128(warped_filter[sx >> WARPEDDIFF_PREC_BITS]);
+  const __m128i hi = xx_loadu_128(warped_filter[sx_hi >> WARPEDDIFF_PREC_BITS]);
+  return yy_set_m128i(hi, lo);
+}
+
+// Applies the vertical filter to the intermediate rows src[0] to src[7] and
+// returns the 32-bit sums of columns 0 to 3 in *res_lo and of columns 4 to 7
+// in *res_hi.
+static INLINE void warp_vert_filter(const __m256i *src, int sy, int sy_hi,
+                                    int16_t gamma, __m256i *res_lo,
+                                    __m256i *res_hi) {
+  // Rearrange pairs of consecutive rows into the column order
+  // 0 0 2 2 4 4 6 6; 1 1 3 3 5 5 7 7
+  const __m256i src_0 = _mm256_unpacklo_epi16(src[0], src[1]);
+  const __m256i src_2 = _mm256_unpacklo_epi16(src[2], src[3]);
+  const __m256i src_4 = _mm256_unpacklo_epi16(src[4], src[5]);
+  const __m256i src_6 = _mm256_unpacklo_epi16(src[6], src[7]);
+  const __m256i src_1 = _mm256_unpackhi_epi16(src[0], src[1]);
+  const __m256i src_3 = _mm256_unpackhi_epi16(src[2], src[3]);
+  const __m256i src_5 = _mm256_unpackhi_epi16(src[4], src[5]);
+  const __m256i src_7 = _mm256_unpackhi_epi16(src[6], src[7]);
+
+  // Filter even-index pixels
+  const __m256i tmp_0 = warp_load_filter(sy + 0 * gamma, sy_hi + 0 * gamma);
+  const __m256i tmp_2 = warp_load_filter(sy + 2 * gamma, sy_hi + 2 * gamma);
+  const __m256i tmp_4 = warp_load_filter(sy + 4 * gamma, sy_hi + 4 * gamma);
+  const __m256i tmp_6 = warp_load_filter(sy + 6 * gamma, sy_hi + 6 * gamma);
+
+  const __m256i tmp_8 = _mm256_unpacklo_epi32(tmp_0, tmp_2);
+  const __m256i tmp_10 = _mm256_unpacklo_epi32(tmp_4, tmp_6);
+  const __m256i tmp_12 = _mm256_unpackhi_epi32(tmp_0, tmp_2);
+  const __m256i tmp_14 = _mm256_unpackhi_epi32(tmp_4, tmp_6);
+
+  const __m256i coeff_0 = _mm256_unpacklo_epi64(tmp_8, tmp_10);
+  const __m256i coeff_2 = _mm256_unpackhi_epi64(tmp_8, tmp_10);
+  const __m256i coeff_4 = _mm256_unpacklo_epi64(tmp_12, tmp_14);
+  const __m256i coeff_6 = _mm256_unpackhi_epi64(tmp_12, tmp_14);
+
+  const __m256i res_even =
+      _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(src_0, coeff_0),
+                                        _mm256_madd_epi16(src_2, coeff_2)),
+                       _mm256_add_epi32(_mm256_madd_epi16(src_4, coeff_4),
+                                        _mm256_madd_epi16(src_6, coeff_6)));
+
+  // Filter odd-index pixels
+  const __m256i tmp_1 = warp_load_filter(sy + 1 * gamma, sy_hi + 1 * gamma);
+  const __m256i tmp_3 = warp_load_filter(sy + 3 * gamma, sy_hi + 3 * gamma);
+  const __m256i tmp_5 = warp_load_filter(sy + 5 * gamma, sy_hi + 5 * gamma);
+  const __m256i tmp_7 = warp_load_filter(sy + 7 * gamma, sy_hi + 7 * gamma);
+
+  const __m256i tmp_9 = _mm256_unpacklo_epi32(tmp_1, tmp_3);
+  const __m256i tmp_11 = _mm256_unpacklo_epi32(tmp_5, tmp_7);
+  const __m256i tmp_13 = _mm256_unpackhi_epi32(tmp_1, tmp_3);
+  const __m256i tmp_15 = _mm256_unpackhi_epi32(tmp_5, tmp_7);
+
+  const __m256i coeff_1 = _mm256_unpacklo_epi64(tmp_9, tmp_11);
+  const __m256i coeff_3 = _mm256_unpackhi_epi64(tmp_9, tmp_11);
+  const __m256i coeff_5 = _mm256_unpacklo_epi64(tmp_13, tmp_15);
+  const __m256i coeff_7 = _mm256_unpackhi_epi64(tmp_13, tmp_15);
+
+  const __m256i res_odd =
+      _mm256_add_epi32(_mm256_add_epi32(_mm256_madd_epi16(src_1, coeff_1),
+                                        _mm256_madd_epi16(src_3, coeff_3)),
+                       _mm256_add_epi32(_mm256_madd_epi16(src_5, coeff_5),
+                                        _mm256_madd_epi16(src_7, coeff_7)));
+
+  // Rearrange pixels back into the order 0 ... 7
+  *res_lo = _mm256_unpacklo_epi32(res_even, res_odd);
+  *res_hi = _mm256_unpackhi_epi32(res_even, res_odd);
+}
+
+#endif  // AV1_COMMON_X86_WARP_PLANE_AVX2_H_
@@ -10,6 +10,7 @@
  */
 
 #include <assert.h>
+#include <limits.h>
 
 #include "./aom_config.h"
 #include "./aom_dsp_rtcd.h"
@@ -334,6 +335,93 @@ static void decode_mbmi_block(AV1Decoder *const pbi, MACROBLOCKD *const xd,
   aom_merge_corrupted_flag(&xd->corrupted, reader_corrupted_flag);
 }
 
+// Luma rows below the ones a motion vector points to which the interpolation
+// filters may read, rounded up generously.
+#define REF_ROWS_MARGIN (AOM_INTERP_EXTEND << 2)
+
+// Returns the lowest row of the reference which the warped prediction of the
+// pixels [x0, x1) x [y0, y1) projects to.
+static int64_t warp_bottom_row(const WarpedMotionParams *wm, int x0, int x1,
+                               int y0, int y1) {
+  const int32_t *const mat = wm->wmmat;
+  const int64_t dy_x = AOMMAX((int64_t)mat[4] * x0, (int64_t)mat[4] * x1);
+  const int64_t dy_y = AOMMAX((int64_t)mat[5] * y0, (int64_t)mat[5] * y1);
+  return (dy_x + dy_y + mat[1]) >> WARPEDMODEL_PREC_BITS;
+}
+
+// Raises ref_rows[] to the number of rows of each reference frame which the
+// prediction of the pixels [x0, x1) x [y0, y1) with the motion of mi reads.
+static void update_ref_rows(const AV1_COMMON *cm, const MODE_INFO *mi, int x0,
+                            int x1, int y0, int y1, int *ref_rows) {
+  const MB_MODE_INFO *const mbmi = &mi->mbmi;
+
+  for (int ref = 0; ref < 1 + has_second_ref(mbmi); ++ref) {
+    const MV_REFERENCE_FRAME frame = mbmi->ref_frame[ref];
+    if (frame < LAST_FRAME) continue;
+    const RefBuffer *const ref_buf = &cm->frame_refs[frame - LAST_FRAME];
+    int64_t bottom = y1 + (mbmi->mv[ref].as_mv.row >> 3);
+
+    if (av1_is_scaled(&ref_buf->sf)) {
+      bottom = INT_MAX;
+    } else if (mbmi->motion_mode == WARPED_CAUSAL) {
+      bottom = AOMMAX(bottom,
+                      warp_bottom_row(&mbmi->wm_params[0], x0, x1, y0, y1));
+    } else if (is_global_mv_block(mi, cm->global_motion[frame].wmtype)) {
+      bottom = AOMMAX(
+          bottom, warp_bottom_row(&cm->global_motion[frame], x0, x1, y0, y1));
+    }
+    bottom = clamp64(bottom + REF_ROWS_MARGIN, 1, INT_MAX);
+    ref_rows[frame - LAST_FRAME] =
+        AOMMAX(ref_rows[frame - LAST_FRAME], (int)bottom);
+  }
+}
+
+// Waits until the frame workers decoding the reference frames of an inter
+// block have filtered all the rows its prediction reads.
+static void wait_for_ref_rows(AV1Decoder *const pbi, MACROBLOCKD *const xd,
+                              int mi_row, int mi_col, BLOCK_SIZE bsize) {
+  AV1_COMMON *const cm = &pbi->common;
+  RefCntBuffer *const frame_bufs = cm->buffer_pool->frame_bufs;
+  const MODE_INFO *const mi = xd->mi[0];
+  const int bw = mi_size_wide[bsize];
+  const int bh = mi_size_high[bsize];
+  // Sub8x8 blocks are predicted as 8x8 in the chroma planes.
+  const int x0 = mi_col * MI_SIZE;
+  const int x1 = (mi_col + AOMMAX(bw, 2)) * MI_SIZE;
+  const int y0 = mi_row * MI_SIZE;
+  const int y1 = (mi_row + AOMMAX(bh, 2)) * MI_SIZE;
+  int ref_rows[INTER_REFS_PER_FRAME] = { 0 };
+
+  update_ref_rows(cm, mi, x0, x1, y0, y1, ref_rows);
+
+  // OBMC blends in predictions made with the motion of the blocks above and
+  // to the left, and the chroma of sub8x8 blocks is predicted with the motion
+  // of their neighbours.
+  if (mi->mbmi.motion_mode == OBMC_CAUSAL || bw < 2 || bh < 2) {
+    if (xd->up_available) {
+      const int cols = AOMMIN(bw, cm->mi_cols - mi_col);
+      for (int i = 0; i < cols; ++i)
+        update_ref_rows(cm, xd->mi[-xd->mi_stride + i], x0, x1, y0, y1,
+                        ref_rows);
+    }
+    if (xd->left_available) {
+      const int rows = AOMMIN(bh, cm->mi_rows - mi_row);
+      for (int i = 0; i < rows; ++i)
+        update_ref_rows(cm, xd->mi[i * xd->mi_stride - 1], x0, x1, y0, y1,
+                        ref_rows);
+    }
+    if (xd->up_available && xd->left_available)
+      update_ref_rows(cm, xd->mi[-xd->mi_stride - 1], x0, x1, y0, y1,
+                      ref_rows);
+  }
+
+  for (int i = 0; i < INTER_REFS_PER_FRAME; ++i) {
+    if (ref_rows[i] == 0) continue;
+    av1_frameworker_wait(pbi->frame_worker_owner,
+                         &frame_bufs[cm->frame_refs[i].idx], ref_rows[i]);
+  }
+}
+
 static void decode_token_and_recon_block(AV1Decoder *const pbi,
                                          MACROBLOCKD *const xd, int mi_row,
                                          int mi_col, aom_reader *r,
@@ -434,6 +522,9 @@ static void decode_token_and_recon_block(AV1Decoder *const pbi,
       }
     }
 
+    if (pbi->frame_parallel_decode)
+      wait_for_ref_rows(pbi, xd, mi_row, mi_col, bsize);
+
     av1_build_inter_predictors_sb(cm, xd, mi_row, mi_col, NULL, bsize);
     if (mbmi->motion_mode == OBMC_CAUSAL)
       av1_build_obmc_inter_predictors_sb(cm, xd, mi_row, mi_col);
@@ -737,7 +828,7 @@ static void decode_partition(AV1Decoder *const pbi, MACROBLOCKD *const xd,
   // chroma planes, subsize must subsample to a valid block size.
   const struct macroblockd_plane *const pd_u = &xd->plane[1];
   if (get_plane_block_size(subsize, pd_u) == BLOCK_INVALID) {
-    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
+    aom_internal_error(xd->error_info, AOM_CODEC_CORRUPT_FRAME,
                        "Block size %dx%d invalid with this subsampling mode",
                        block_size_wide[subsize], block_size_high[subsize]);
   }
@@ -1846,6 +1937,151 @@ static void get_tile_buffers(AV1Decoder *pbi, const uint8_t *data,
   }
 }
 
+static void decode_tile(AV1Decoder *pbi, TileData *const td, int tile_row,
+                        int tile_col) {
+  AV1_COMMON *const cm = &pbi->common;
+  const int num_planes = av1_num_planes(cm);
+  TileInfo tile_info;
+
+  av1_tile_set_row(&tile_info, cm, tile_row);
+  av1_tile_set_col(&tile_info, cm, tile_col);
+
+  av1_zero_above_context(cm, tile_info.mi_col_start, tile_info.mi_col_end);
+  av1_reset_loop_restoration(&td->xd, num_planes);
+
+  for (int mi_row = tile_info.mi_row_start; mi_row < tile_info.mi_row_end;
+       mi_row += cm->seq_params.mib_size) {
+    av1_zero_left_context(&td->xd);
+
+    for (int mi_col = tile_info.mi_col_start; mi_col < tile_info.mi_col_end;
+         mi_col += cm->seq_params.mib_size) {
+      decode_partition(pbi, &td->xd, mi_row, mi_col, &td->bit_reader,
+                       cm->seq_params.sb_size);
+    }
+    if (td->xd.corrupted)
+      aom_internal_error(td->xd.error_info, AOM_CODEC_CORRUPT_FRAME,
+                         "Failed to decode tile data");
+    // With a single tile column, every superblock row is complete as soon as
+    // it has been decoded.
+    if (pbi->pipeline_post_filter && !pbi->frame_parallel_decode &&
+        cm->tile_cols == 1)
+      av1_post_filter_rows(&pbi->post_filter, cm, &pbi->mb,
+                           mi_row + cm->seq_params.mib_size);
+  }
+}
+
+static int tile_worker_hook(TileWorkerData *const tile_data, void *unused) {
+  AV1Decoder *const pbi = tile_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  const int tile_cols = cm->tile_cols;
+  const int tile_rows = cm->tile_rows;
+  (void)unused;
+
+  if (setjmp(tile_data->error_info.jmp)) {
+    tile_data->error_info.setjmp = 0;
+    return 0;
+  }
+  tile_data->error_info.setjmp = 1;
+
+  // Tiles in the same column share the above context, so each worker decodes
+  // its tile columns top to bottom.
+  for (int tile_col = tile_data->start; tile_col < tile_cols;
+       tile_col += tile_data->step) {
+    for (int tile_row = 0; tile_row < tile_rows; ++tile_row) {
+      const int tile_idx = tile_row * tile_cols + tile_col;
+      TileData *const td = pbi->tile_data + tile_idx;
+
+      if (tile_idx < tile_data->tile_start || tile_idx > tile_data->tile_end)
+        continue;
+
+      td->xd.error_info = &tile_data->error_info;
+      decode_tile(pbi, td, tile_row, tile_col);
+    }
+  }
+
+  tile_data->error_info.setjmp = 0;
+  return 1;
+}
+
+// Create the pool of pbi->max_threads workers shared by tile decoding and the
+// loop filter. Only runs once; the last worker has no thread of its own and
+// is always run on the calling thread.
+static void create_tile_workers(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_threads = pbi->max_threads;
+  int i;
+
+  if (pbi->num_tile_workers != 0) return;
+
+  CHECK_MEM_ERROR(cm, pbi->tile_workers,
+                  aom_malloc(num_threads * sizeof(*pbi->tile_workers)));
+  CHECK_MEM_ERROR(cm, pbi->tile_worker_data,
+                  aom_calloc(num_threads, sizeof(*pbi->tile_worker_data)));
+  for (i = 0; i < num_threads; ++i) {
+    AVxWorker *const worker = &pbi->tile_workers[i];
+    ++pbi->num_tile_workers;
+
+    winterface->init(worker);
+    // The main thread acts as the last worker.
+    if (i < num_threads - 1 && !winterface->reset(worker))
+      aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                         "Tile decoder thread creation failed");
+  }
+}
+
+static void decode_tiles_mt(AV1Decoder *pbi, int startTile, int endTile) {
+  AV1_COMMON *const cm = &pbi->common;
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_workers = AOMMIN(pbi->max_threads, cm->tile_cols);
+  const struct aom_internal_error_info *error_info = NULL;
+  int corrupted = 0;
+  int i;
+
+  create_tile_workers(pbi);
+
+  for (i = 0; i < num_workers; ++i) {
+    // Workers [0, num_workers - 1) run on their own threads; the main thread
+    // takes the last slot of the pool.
+    const int worker_idx =
+        i < num_workers - 1 ? i : pbi->num_tile_workers - 1;
+    AVxWorker *const worker = &pbi->tile_workers[worker_idx];
+    TileWorkerData *const tile_data = &pbi->tile_worker_data[worker_idx];
+
+    tile_data->pbi = pbi;
+    tile_data->start = i;
+    tile_data->step = num_workers;
+    tile_data->tile_start = startTile;
+    tile_data->tile_end = endTile;
+
+    worker->hook = (AVxWorkerHook)tile_worker_hook;
+    worker->data1 = tile_data;
+    worker->data2 = NULL;
+    worker->had_error = 0;
+
+    if (i == num_workers - 1)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    const int worker_idx =
+        i < num_workers - 1 ? i : pbi->num_tile_workers - 1;
+    if (!winterface->sync(&pbi->tile_workers[worker_idx]) && !corrupted) {
+      // Keep the error of the first worker that failed.
+      error_info = &pbi->tile_worker_data[worker_idx].error_info;
+      corrupted = 1;
+    }
+  }
+
+  aom_merge_corrupted_flag(&pbi->mb.corrupted, corrupted);
+  if (corrupted)
+    aom_internal_error(&cm->error, error_info->error_code,
+                       error_info->has_detail ? "%s" : NULL,
+                       error_info->detail);
+}
+
 static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end, int startTile,
                                    int endTile) {
@@ -1890,6 +2126,15 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
   if (tile_rows_end <= tile_rows_start || tile_cols_end <= tile_cols_start)
     return data;
 
+  // Tile columns are decoded in parallel when more than one thread is
+  // available. Bit accounting collects into a single shared structure, so it
+  // keeps the serial path.
+  int use_tile_workers =
+      pbi->max_threads > 1 && tile_cols > 1 && !cm->large_scale_tile;
+#if CONFIG_ACCOUNTING
+  use_tile_workers &= !pbi->acct_enabled;
+#endif
+
 #if CONFIG_CDF_UPDATE_MODE
   allow_update_cdf = allow_update_cdf && !cm->disable_cdf_update;
 #endif  // CONFIG_CDF_UPDATE_MODE
@@ -1948,64 +2193,77 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     }
   }
 
-  for (tile_row = tile_rows_start; tile_row < tile_rows_end; ++tile_row) {
-    const int row = inv_row_order ? tile_rows - 1 - tile_row : tile_row;
-    int mi_row = 0;
-    TileInfo tile_info;
+  if (use_tile_workers) {
+    decode_tiles_mt(pbi, startTile, endTile);
+  } else {
+    for (tile_row = tile_rows_start; tile_row < tile_rows_end; ++tile_row) {
+      const int row = inv_row_order ? tile_rows - 1 - tile_row : tile_row;
 
-    av1_tile_set_row(&tile_info, cm, row);
+      for (tile_col = tile_cols_start; tile_col < tile_cols_end; ++tile_col) {
+        const int col = inv_col_order ? tile_cols - 1 - tile_col : tile_col;
+        TileData *const td = pbi->tile_data + tile_cols * row + col;
 
-    for (tile_col = tile_cols_start; tile_col < tile_cols_end; ++tile_col) {
-      const int col = inv_col_order ? tile_cols - 1 - tile_col : tile_col;
-      TileData *const td = pbi->tile_data + tile_cols * row + col;
-
-      if (tile_row * cm->tile_cols + tile_col < startTile ||
-          tile_row * cm->tile_cols + tile_col > endTile)
-        continue;
+        if (tile_row * cm->tile_cols + tile_col < startTile ||
+            tile_row * cm->tile_cols + tile_col > endTile)
+          continue;
 
 #if CONFIG_ACCOUNTING
-      if (pbi->acct_enabled) {
-        td->bit_reader.accounting->last_tell_frac =
-            aom_reader_tell_frac(&td->bit_reader);
-      }
+        if (pbi->acct_enabled) {
+          td->bit_reader.accounting->last_tell_frac =
+              aom_reader_tell_frac(&td->bit_reader);
+        }
 #endif
 
-      av1_tile_set_col(&tile_info, cm, col);
-
-      av1_zero_above_context(cm, tile_info.mi_col_start, tile_info.mi_col_end);
-      av1_reset_loop_restoration(&td->xd, num_planes);
-
-      for (mi_row = tile_info.mi_row_start; mi_row < tile_info.mi_row_end;
-           mi_row += cm->seq_params.mib_size) {
-        av1_zero_left_context(&td->xd);
-
-        for (int mi_col = tile_info.mi_col_start; mi_col < tile_info.mi_col_end;
-             mi_col += cm->seq_params.mib_size) {
-          decode_partition(pbi, &td->xd, mi_row, mi_col, &td->bit_reader,
-                           cm->seq_params.sb_size);
-        }
+        decode_tile(pbi, td, row, col);
         aom_merge_corrupted_flag(&pbi->mb.corrupted, td->xd.corrupted);
-        if (pbi->mb.corrupted)
-          aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
-                             "Failed to decode tile data");
+      }
+
+      // Filter the rows completed by the last tile of the tile row.
+      if (pbi->pipeline_post_filter && !pbi->frame_parallel_decode &&
+          tile_cols > 1 && (row + 1) * tile_cols - 1 <= endTile) {
+        TileInfo tile_info;
+        av1_tile_set_row(&tile_info, cm, row);
+        av1_post_filter_rows(&pbi->post_filter, cm, &pbi->mb,
+                             tile_info.mi_row_end);
       }
     }
   }
 
-  if (!(cm->allow_intrabc && NO_FILTER_FOR_IBC)) {
+  if (!(cm->allow_intrabc && NO_FILTER_FOR_IBC) && !pbi->pipeline_post_filter) {
     // Loopfilter the whole frame.
     if (endTile == cm->tile_rows * cm->tile_cols - 1)
       if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
-        av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                              cm->lf.filter_level[0], cm->lf.filter_level[1], 0,
-                              0);
-        if (num_planes > 1) {
-          av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                                cm->lf.filter_level_u, cm->lf.filter_level_u, 1,
-                                0);
+        if (pbi->max_threads > 1) {
+          create_tile_workers(pbi);
+          av1_loop_filter_frame_mt(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                   cm->lf.filter_level[0],
+                                   cm->lf.filter_level[1], 0, 0,
+                                   pbi->tile_workers, pbi->num_tile_workers,
+                                   &pbi->lf_row_sync);
+          if (num_planes > 1) {
+            av1_loop_filter_frame_mt(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                     cm->lf.filter_level_u,
+                                     cm->lf.filter_level_u, 1, 0,
+                                     pbi->tile_workers, pbi->num_tile_workers,
+                                     &pbi->lf_row_sync);
+            av1_loop_filter_frame_mt(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                     cm->lf.filter_level_v,
+                                     cm->lf.filter_level_v, 2, 0,
+                                     pbi->tile_workers, pbi->num_tile_workers,
+                                     &pbi->lf_row_sync);
+          }
+        } else {
           av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
-                                cm->lf.filter_level_v, cm->lf.filter_level_v, 2,
-                                0);
+                                cm->lf.filter_level[0], cm->lf.filter_level[1],
+                                0, 0);
+          if (num_planes > 1) {
+            av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                  cm->lf.filter_level_u, cm->lf.filter_level_u,
+                                  1, 0);
+            av1_loop_filter_frame(get_frame_new_buffer(cm), cm, &pbi->mb,
+                                  cm->lf.filter_level_v, cm->lf.filter_level_v,
+                                  2, 0);
+          }
         }
       }
   }
@@ -3355,7 +3613,17 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
   AV1_COMMON *const cm = &pbi->common;
   MACROBLOCKD *const xd = &pbi->mb;
 
-  if (initialize_flag) setup_frame_info(pbi);
+  if (initialize_flag) {
+    setup_frame_info(pbi);
+    // The filters are run behind the decoding of the superblock rows unless
+    // they are multi-threaded themselves.
+    pbi->pipeline_post_filter = pbi->max_threads <= 1 &&
+                                !pbi->inv_tile_order &&
+                                !(cm->allow_intrabc && NO_FILTER_FOR_IBC) &&
+                                av1_post_filter_supported(cm);
+    if (pbi->pipeline_post_filter)
+      av1_post_filter_init(&pbi->post_filter, &pbi->cur_buf->buf, cm);
+  }
 
   *p_data_end = decode_tiles(pbi, data, data_end, startTile, endTile);
 
@@ -3367,7 +3635,12 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     return;
   }
 
-  if (!(cm->allow_intrabc && NO_FILTER_FOR_IBC)) {
+  if (pbi->pipeline_post_filter) {
+    // In frame parallel mode the frame is filtered once the next frame has
+    // been started.
+    if (!pbi->frame_parallel_decode)
+      av1_post_filter_rows(&pbi->post_filter, cm, xd, cm->mi_rows);
+  } else if (!(cm->allow_intrabc && NO_FILTER_FOR_IBC)) {
     if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
@@ -3376,7 +3649,13 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
 
     if (!cm->skip_loop_filter && !cm->all_lossless &&
         (cm->cdef_bits || cm->cdef_strengths[0] || cm->cdef_uv_strengths[0])) {
-      av1_cdef_frame(&pbi->cur_buf->buf, cm, &pbi->mb);
+      if (pbi->max_threads > 1) {
+        create_tile_workers(pbi);
+        av1_cdef_frame_mt(&pbi->cur_buf->buf, cm, &pbi->mb, pbi->tile_workers,
+                          pbi->num_tile_workers, &pbi->cdef_sync);
+      } else {
+        av1_cdef_frame(&pbi->cur_buf->buf, cm, &pbi->mb);
+      }
     }
 
     superres_post_decode(pbi);
@@ -3384,8 +3663,19 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
+      const int lr_threads = pbi->lr_threads > 0
+                                 ? AOMMIN(pbi->lr_threads, pbi->max_threads)
+                                 : pbi->max_threads;
       av1_loop_restoration_save_boundary_lines(&pbi->cur_buf->buf, cm, 1);
-      av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf, cm);
+      if (lr_threads > 1) {
+        create_tile_workers(pbi);
+        av1_loop_restoration_filter_frame_mt(
+            (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, pbi->tile_workers,
+            AOMMIN(lr_threads, pbi->num_tile_workers), &pbi->lr_row_sync);
+      } else {
+        av1_loop_restoration_filter_frame((YV12_BUFFER_CONFIG *)xd->cur_buf,
+                                          cm);
+      }
     }
   }
 
@@ -145,8 +145,12 @@ void av1_decoder_remove(AV1Decoder *pbi) {
     AVxWorker *const worker = &pbi->tile_workers[i];
     aom_get_worker_interface()->end(worker);
   }
-  aom_free(pbi->tile_worker_info);
+  aom_free(pbi->tile_worker_data);
   aom_free(pbi->tile_workers);
+  av1_loop_filter_dealloc(&pbi->lf_row_sync);
+  av1_cdef_sync_dealloc(&pbi->cdef_sync);
+  av1_loop_restoration_dealloc(&pbi->lr_row_sync);
+  av1_post_filter_free(&pbi->post_filter);
 
 #if CONFIG_ACCOUNTING
   aom_accounting_clear(&pbi->accounting);
@@ -238,7 +242,14 @@ static void swap_frame_buffers(AV1Decoder *pbi) {
   cm->frame_to_show = get_frame_new_buffer(cm);
 
   lock_buffer_pool(pool);
-  --frame_bufs[cm->new_fb_idx].ref_count;
+  if (!pbi->frame_parallel_decode) {
+    --frame_bufs[cm->new_fb_idx].ref_count;
+  } else if (!cm->show_frame) {
+    // In frame parallel mode a shown frame is held until it has been output,
+    // and the buffer of any other frame may be reused by another worker as
+    // soon as it is released.
+    decrease_ref_count(cm->new_fb_idx, frame_bufs, pool);
+  }
   unlock_buffer_pool(pool);
 
   // Invalidate these references until the next frame starts.
@@ -248,6 +259,35 @@ static void swap_frame_buffers(AV1Decoder *pbi) {
   }
 }
 
+// Runs the post-processing filters of a frame whose tiles have all been
+// decoded, a superblock row at a time, and reports the rows which are final
+// to the frame workers predicting from them.
+static void filter_frame_parallel(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  YV12_BUFFER_CONFIG *const buf = &pbi->cur_buf->buf;
+  const int num_planes = av1_num_planes(cm);
+  const int height = buf->y_crop_height;
+  int extended_rows = 0;
+
+  // The frames which can not be filtered a row at a time have been filtered
+  // before their context was made ready.
+  if (pbi->pipeline_post_filter) {
+    for (int mi_row = 0; mi_row < cm->mi_rows;) {
+      mi_row = AOMMIN(mi_row + cm->seq_params.mib_size, cm->mi_rows);
+      av1_post_filter_rows(&pbi->post_filter, cm, &pbi->mb, mi_row);
+      const int rows =
+          AOMMIN(av1_post_filter_final_rows(&pbi->post_filter, cm), height);
+      // The bottom rows are reported once the bottom border is extended.
+      if (rows > extended_rows && rows < height) {
+        aom_extend_frame_borders_rows(buf, extended_rows, rows, num_planes);
+        extended_rows = rows;
+        av1_frameworker_broadcast(pbi->cur_buf, extended_rows);
+      }
+    }
+  }
+  aom_extend_frame_borders_rows(buf, extended_rows, height, num_planes);
+}
+
 int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
                                 const uint8_t **psource) {
   AV1_COMMON *volatile const cm = &pbi->common;
@@ -279,7 +319,8 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 
   // Check if the previous frame was a frame without any references to it.
   // Release frame buffer if not decoding in frame parallel mode.
-  if (cm->new_fb_idx >= 0 && frame_bufs[cm->new_fb_idx].ref_count == 0)
+  if (!pbi->frame_parallel_decode && cm->new_fb_idx >= 0 &&
+      frame_bufs[cm->new_fb_idx].ref_count == 0)
     pool->release_fb_cb(pool->cb_priv,
                         &frame_bufs[cm->new_fb_idx].raw_frame_buffer);
 
@@ -291,7 +332,18 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   cm->cur_frame = &pool->frame_bufs[cm->new_fb_idx];
 
   pbi->hold_ref_buf = 0;
-  pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
+  if (pbi->frame_parallel_decode) {
+    AVxWorker *const worker = pbi->frame_worker_owner;
+    av1_frameworker_lock_stats(worker);
+    frame_bufs[cm->new_fb_idx].frame_worker_owner = worker;
+    // Reset decoding progress.
+    pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
+    pbi->cur_buf->row = -1;
+    pbi->cur_buf->col = -1;
+    av1_frameworker_unlock_stats(worker);
+  } else {
+    pbi->cur_buf = &frame_bufs[cm->new_fb_idx];
+  }
 
   if (setjmp(cm->error.jmp)) {
     const AVxWorkerInterface *const winterface = aom_get_worker_interface();
@@ -355,19 +407,6 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   cm->txb_count = 0;
 #endif
 
-  swap_frame_buffers(pbi);
-
-  // For now, we only extend the frame borders when the whole frame is decoded.
-  // Later, if needed, extend the border for the decoded tile on the frame
-  // border.
-  if (pbi->dec_tile_row == -1 && pbi->dec_tile_col == -1)
-    // TODO(debargha): Fix encoder side mv range, so that we can use the
-    // inner border extension. As of now use the larger extension.
-    // aom_extend_frame_inner_borders(cm->frame_to_show, num_planes);
-    aom_extend_frame_borders(cm->frame_to_show, num_planes);
-
-  aom_clear_system_state();
-
   if (!cm->show_existing_frame) {
     cm->last_show_frame = cm->show_frame;
 
@@ -392,6 +431,38 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   }
 #endif  // CONFIG_EXPLICIT_ORDER_HINT
 
+  if (pbi->frame_parallel_decode) {
+    AVxWorker *const worker = pbi->frame_worker_owner;
+    FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+
+    // Everything the next frame needs from this one is known, so let it
+    // start while this frame is being filtered.
+    av1_frameworker_lock_stats(worker);
+    frame_worker_data->data_end = *psource;
+    frame_worker_data->frame_context_ready = 1;
+    av1_frameworker_signal_stats(worker);
+    av1_frameworker_unlock_stats(worker);
+
+    if (!cm->show_existing_frame) {
+      filter_frame_parallel(pbi);
+      av1_frameworker_broadcast(pbi->cur_buf, INT_MAX);
+    }
+    swap_frame_buffers(pbi);
+  } else {
+    swap_frame_buffers(pbi);
+
+    // For now, we only extend the frame borders when the whole frame is
+    // decoded. Later, if needed, extend the border for the decoded tile on
+    // the frame border.
+    if (pbi->dec_tile_row == -1 && pbi->dec_tile_col == -1)
+      // TODO(debargha): Fix encoder side mv range, so that we can use the
+      // inner border extension. As of now use the larger extension.
+      // aom_extend_frame_inner_borders(cm->frame_to_show, num_planes);
+      aom_extend_frame_borders(cm->frame_to_show, num_planes);
+  }
+
+  aom_clear_system_state();
+
   cm->error.setjmp = 0;
   return 0;
 }
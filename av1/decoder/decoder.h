@@ -21,6 +21,7 @@
 
 #include "av1/common/thread_common.h"
 #include "av1/common/onyxc_int.h"
+#include "av1/common/postfilter.h"
 #include "av1/decoder/dthread.h"
 #if CONFIG_ACCOUNTING
 #include "av1/decoder/accounting.h"
@@ -43,6 +44,18 @@ typedef struct TileData {
   DECLARE_ALIGNED(16, uint8_t, color_index_map[2][MAX_PALETTE_SQUARE]);
 } TileData;
 
+// Per-worker state for multi-threaded tile decoding. Each worker decodes
+// whole tile columns, so that tiles sharing an above context are always
+// decoded in order by the same thread.
+typedef struct TileWorkerData {
+  struct AV1Decoder *pbi;
+  int start;       // First tile column decoded by this worker.
+  int step;        // Distance between tile columns decoded by this worker.
+  int tile_start;  // Index of the first tile in the current tile group.
+  int tile_end;    // Index of the last tile in the current tile group.
+  struct aom_internal_error_info error_info;
+} TileWorkerData;
+
 typedef struct TileBufferDec {
   const uint8_t *data;
   size_t size;
@@ -65,10 +78,20 @@ typedef struct AV1Decoder {
   RefCntBuffer *cur_buf;  //  Current decoding frame buffer.
 
   AVxWorker *frame_worker_owner;  // frame_worker that owns this pbi.
+  // Set when frames are decoded by several frame workers at once. The next
+  // frame is started as soon as all the tiles of this one have been decoded.
+  int frame_parallel_decode;
   AVxWorker lf_worker;
   AVxWorker *tile_workers;
-  TileInfo *tile_worker_info;
+  TileWorkerData *tile_worker_data;
   int num_tile_workers;
+  AV1LfSync lf_row_sync;
+  AV1CdefSync cdef_sync;
+  AV1LrSync lr_row_sync;
+  // Set when the post-processing filters of the current frame run a few
+  // superblock rows behind tile decoding, rather than after it.
+  int pipeline_post_filter;
+  AV1PostFilter post_filter;
 
   TileData *tile_data;
   int allocated_tiles;
@@ -77,6 +100,8 @@ typedef struct AV1Decoder {
 
   int allow_lowbitdepth;
   int max_threads;
+  // Threads of the loop restoration filter, 0 for max_threads.
+  int lr_threads;
   int inv_tile_order;
   int need_resync;   // wait for key/intra-only frame.
   int hold_ref_buf;  // hold the reference buffer.
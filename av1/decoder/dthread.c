@@ -75,6 +75,7 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
     // Find the worker thread that owns the reference frame. If the reference
     // frame has been fully decoded, it may not have owner.
     AVxWorker *const ref_worker = ref_buf->frame_worker_owner;
+    if (!ref_worker) return;
     FrameWorkerData *const ref_worker_data =
         (FrameWorkerData *)ref_worker->data1;
     const AV1Decoder *const pbi = ref_worker_data->pbi;
@@ -134,14 +135,30 @@ void av1_frameworker_broadcast(RefCntBuffer *const buf, int row) {
 #endif  // CONFIG_MULTITHREAD
 }
 
+void av1_frameworker_wait_context_ready(AVxWorker *const worker) {
+#if CONFIG_MULTITHREAD
+  FrameWorkerData *const worker_data = (FrameWorkerData *)worker->data1;
+
+  av1_frameworker_lock_stats(worker);
+  while (!worker_data->frame_context_ready) {
+    pthread_cond_wait(&worker_data->stats_cond, &worker_data->stats_mutex);
+  }
+  av1_frameworker_unlock_stats(worker);
+#else
+  (void)worker;
+#endif  // CONFIG_MULTITHREAD
+}
+
 void av1_frameworker_copy_context(AVxWorker *const dst_worker,
                                   AVxWorker *const src_worker) {
 #if CONFIG_MULTITHREAD
   FrameWorkerData *const src_worker_data = (FrameWorkerData *)src_worker->data1;
   FrameWorkerData *const dst_worker_data = (FrameWorkerData *)dst_worker->data1;
-  AV1_COMMON *const src_cm = &src_worker_data->pbi->common;
-  AV1_COMMON *const dst_cm = &dst_worker_data->pbi->common;
-  int i;
+  AV1Decoder *const src_pbi = src_worker_data->pbi;
+  AV1Decoder *const dst_pbi = dst_worker_data->pbi;
+  AV1_COMMON *const src_cm = &src_pbi->common;
+  AV1_COMMON *const dst_cm = &dst_pbi->common;
+  int src_failed;
 
   // Wait until source frame's context is ready.
   av1_frameworker_lock_stats(src_worker);
@@ -149,36 +166,75 @@ void av1_frameworker_copy_context(AVxWorker *const dst_worker,
     pthread_cond_wait(&src_worker_data->stats_cond,
                       &src_worker_data->stats_mutex);
   }
-
-  dst_cm->last_frame_seg_map = src_cm->seg.enabled
-                                   ? src_cm->current_frame_seg_map
-                                   : src_cm->last_frame_seg_map;
-  dst_worker_data->pbi->need_resync = src_worker_data->pbi->need_resync;
+  dst_pbi->need_resync = src_pbi->need_resync;
+  src_failed = src_worker_data->result != 0;
   av1_frameworker_unlock_stats(src_worker);
 
+  // Sequence header.
+  dst_pbi->sequence_header_ready = src_pbi->sequence_header_ready;
+#if CONFIG_OPERATING_POINTS
+  dst_pbi->current_operating_point = src_pbi->current_operating_point;
+#endif
+  dst_cm->seq_params = src_cm->seq_params;
+  dst_cm->profile = src_cm->profile;
   dst_cm->bit_depth = src_cm->bit_depth;
   dst_cm->use_highbitdepth = src_cm->use_highbitdepth;
-  // TODO(zoeliu): To handle parallel decoding
-  dst_cm->prev_frame =
-      src_cm->show_existing_frame ? src_cm->prev_frame : src_cm->cur_frame;
-  dst_cm->last_width =
-      !src_cm->show_existing_frame ? src_cm->width : src_cm->last_width;
-  dst_cm->last_height =
-      !src_cm->show_existing_frame ? src_cm->height : src_cm->last_height;
   dst_cm->subsampling_x = src_cm->subsampling_x;
   dst_cm->subsampling_y = src_cm->subsampling_y;
+  dst_cm->color_primaries = src_cm->color_primaries;
+  dst_cm->transfer_characteristics = src_cm->transfer_characteristics;
+  dst_cm->matrix_coefficients = src_cm->matrix_coefficients;
+  dst_cm->chroma_sample_position = src_cm->chroma_sample_position;
+  dst_cm->color_range = src_cm->color_range;
+  dst_cm->separate_uv_delta_q = src_cm->separate_uv_delta_q;
+  dst_cm->timing_info_present = src_cm->timing_info_present;
+  dst_cm->num_units_in_tick = src_cm->num_units_in_tick;
+  dst_cm->time_scale = src_cm->time_scale;
+  dst_cm->equal_picture_interval = src_cm->equal_picture_interval;
+  dst_cm->num_ticks_per_picture = src_cm->num_ticks_per_picture;
+#if CONFIG_FILM_GRAIN
+  dst_cm->film_grain_params_present = src_cm->film_grain_params_present;
+  dst_cm->film_grain_params = src_cm->film_grain_params;
+#endif
+#if CONFIG_SCALABILITY
+  dst_cm->enhancement_layers_cnt = src_cm->enhancement_layers_cnt;
+#endif
+
+  // State carried over from the previous frame.
   dst_cm->frame_type = src_cm->frame_type;
-  dst_cm->last_show_frame = !src_cm->show_existing_frame
-                                ? src_cm->show_frame
-                                : src_cm->last_show_frame;
-  for (i = 0; i < REF_FRAMES; ++i)
-    dst_cm->ref_frame_map[i] = src_cm->next_ref_frame_map[i];
+  dst_cm->intra_only = src_cm->intra_only;
+  dst_cm->last_width = src_cm->last_width;
+  dst_cm->last_height = src_cm->last_height;
+  dst_cm->last_show_frame = src_cm->last_show_frame;
+  dst_cm->last_tile_cols = src_cm->last_tile_cols;
+  dst_cm->last_tile_rows = src_cm->last_tile_rows;
+  dst_cm->current_video_frame = src_cm->current_video_frame;
+  dst_cm->frame_offset = src_cm->frame_offset;
+  dst_cm->current_frame_id = src_cm->current_frame_id;
+  memcpy(dst_cm->ref_frame_id, src_cm->ref_frame_id,
+         sizeof(dst_cm->ref_frame_id));
+  memcpy(dst_cm->valid_for_referencing, src_cm->valid_for_referencing,
+         sizeof(dst_cm->valid_for_referencing));
+
+  // A frame which failed to decode or showed an existing frame without
+  // resetting the decoder leaves the reference buffers unchanged. Otherwise
+  // the source worker is about to make next_ref_frame_map current.
+  if (src_failed ||
+      (src_cm->show_existing_frame && !src_cm->reset_decoder_state)) {
+    memcpy(dst_cm->ref_frame_map, src_cm->ref_frame_map,
+           sizeof(dst_cm->ref_frame_map));
+  } else {
+    memcpy(dst_cm->ref_frame_map, src_cm->next_ref_frame_map,
+           sizeof(dst_cm->ref_frame_map));
+  }
 
   memcpy(dst_cm->lf_info.lfthr, src_cm->lf_info.lfthr,
          (MAX_LOOP_FILTER + 1) * sizeof(loop_filter_thresh));
   dst_cm->lf.sharpness_level = src_cm->lf.sharpness_level;
   dst_cm->lf.filter_level[0] = src_cm->lf.filter_level[0];
   dst_cm->lf.filter_level[1] = src_cm->lf.filter_level[1];
+  dst_cm->lf.filter_level_u = src_cm->lf.filter_level_u;
+  dst_cm->lf.filter_level_v = src_cm->lf.filter_level_v;
   memcpy(dst_cm->lf.ref_deltas, src_cm->lf.ref_deltas, TOTAL_REFS_PER_FRAME);
   memcpy(dst_cm->lf.mode_deltas, src_cm->lf.mode_deltas, MAX_MODE_LF_DELTAS);
   dst_cm->seg = src_cm->seg;
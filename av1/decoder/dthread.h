@@ -64,6 +64,10 @@ void av1_frameworker_wait(AVxWorker *const worker, RefCntBuffer *const ref_buf,
 // waiting on it can resume decoding.
 void av1_frameworker_broadcast(RefCntBuffer *const buf, int row);
 
+// Wait until the worker has decoded its frame far enough for the context of
+// the next frame to be copied from it.
+void av1_frameworker_wait_context_ready(AVxWorker *const worker);
+
 // Copy necessary decoding context from src worker to dst worker.
 void av1_frameworker_copy_context(AVxWorker *const dst_worker,
                                   AVxWorker *const src_worker);
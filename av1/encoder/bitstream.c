@@ -35,12 +35,14 @@
 #include "av1/common/reconinter.h"
 #include "av1/common/reconintra.h"
 #include "av1/common/seg_common.h"
+#include "av1/common/thread_common.h"
 #include "av1/common/tile_common.h"
 
 #include "av1/encoder/bitstream.h"
 #include "av1/encoder/cost.h"
 #include "av1/encoder/encodemv.h"
 #include "av1/encoder/encodetxb.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/mcomp.h"
 #include "av1/encoder/palette.h"
 #include "av1/encoder/segmentation.h"
@@ -440,14 +442,14 @@ int av1_neg_interleave(int x, int ref, int max) {
   }
 }
 
-static void write_segment_id(AV1_COMP *cpi, const MB_MODE_INFO *const mbmi,
-                             aom_writer *w, const struct segmentation *seg,
+static void write_segment_id(AV1_COMP *cpi, MACROBLOCKD *const xd,
+                             const MB_MODE_INFO *const mbmi, aom_writer *w,
+                             const struct segmentation *seg,
                              struct segmentation_probs *segp, int mi_row,
                              int mi_col, int skip) {
   if (!seg->enabled || !seg->update_map) return;
 
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
   int cdf_num;
   const int pred = av1_get_spatial_seg_pred(cm, xd, mi_row, mi_col, &cdf_num);
 
@@ -611,8 +613,8 @@ static void write_angle_delta(aom_writer *w, int angle_delta,
                    2 * MAX_ANGLE_DELTA + 1);
 }
 
-static void write_mb_interp_filter(AV1_COMP *cpi, const MACROBLOCKD *xd,
-                                   aom_writer *w) {
+static void write_mb_interp_filter(AV1_COMP *cpi, ThreadData *td,
+                                   const MACROBLOCKD *xd, aom_writer *w) {
   AV1_COMMON *const cm = &cpi->common;
   const MB_MODE_INFO *const mbmi = &xd->mi[0]->mbmi;
   FRAME_CONTEXT *ec_ctx = xd->tile_ctx;
@@ -631,7 +633,7 @@ static void write_mb_interp_filter(AV1_COMP *cpi, const MACROBLOCKD *xd,
           av1_extract_interp_filter(mbmi->interp_filters, dir);
       aom_write_symbol(w, filter, ec_ctx->switchable_interp_cdf[ctx],
                        SWITCHABLE_FILTERS);
-      ++cpi->interp_filter_selected[0][filter];
+      ++td->interp_filter_selected[filter];
       if (cm->seq_params.enable_dual_filter == 0) return;
     }
   }
@@ -870,16 +872,10 @@ static void write_cfl_alphas(FRAME_CONTEXT *const ec_ctx, int idx,
   }
 }
 
-static void write_cdef(AV1_COMMON *cm, aom_writer *w, int skip, int mi_col,
-                       int mi_row) {
-  if (cm->all_lossless || (cm->allow_intrabc && NO_FILTER_FOR_IBC)) {
-    // Initialize to indicate no CDEF for safety.
-    cm->cdef_bits = 0;
-    cm->cdef_strengths[0] = 0;
-    cm->nb_cdef_strengths = 1;
-    cm->cdef_uv_strengths[0] = 0;
-    return;
-  }
+static void write_cdef(const AV1_COMMON *cm, MACROBLOCKD *const xd,
+                       aom_writer *w, int skip, int mi_col, int mi_row) {
+  // The CDEF parameters are then reset by write_tiles_in_tg_obus().
+  if (cm->all_lossless || (cm->allow_intrabc && NO_FILTER_FOR_IBC)) return;
 
   const int m = ~((1 << (6 - MI_SIZE_LOG2)) - 1);
   const MB_MODE_INFO *mbmi =
@@ -887,8 +883,8 @@ static void write_cdef(AV1_COMMON *cm, aom_writer *w, int skip, int mi_col,
   // Initialise when at top left part of the superblock
   if (!(mi_row & (cm->seq_params.mib_size - 1)) &&
       !(mi_col & (cm->seq_params.mib_size - 1))) {  // Top left?
-    cm->cdef_preset[0] = cm->cdef_preset[1] = cm->cdef_preset[2] =
-        cm->cdef_preset[3] = -1;
+    xd->cdef_preset[0] = xd->cdef_preset[1] = xd->cdef_preset[2] =
+        xd->cdef_preset[3] = -1;
   }
 
   // Emit CDEF param at first non-skip coding block
@@ -896,18 +892,18 @@ static void write_cdef(AV1_COMMON *cm, aom_writer *w, int skip, int mi_col,
   const int index = cm->seq_params.sb_size == BLOCK_128X128
                         ? !!(mi_col & mask) + 2 * !!(mi_row & mask)
                         : 0;
-  if (cm->cdef_preset[index] == -1 && !skip) {
+  if (xd->cdef_preset[index] == -1 && !skip) {
     aom_write_literal(w, mbmi->cdef_strength, cm->cdef_bits);
-    cm->cdef_preset[index] = mbmi->cdef_strength;
+    xd->cdef_preset[index] = mbmi->cdef_strength;
   }
 }
 
-static void write_inter_segment_id(AV1_COMP *cpi, aom_writer *w,
+static void write_inter_segment_id(AV1_COMP *cpi, MACROBLOCKD *const xd,
+                                   aom_writer *w,
                                    const struct segmentation *const seg,
                                    struct segmentation_probs *const segp,
                                    int mi_row, int mi_col, int skip,
                                    int preskip) {
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
   const MODE_INFO *mi = xd->mi[0];
   const MB_MODE_INFO *const mbmi = &mi->mbmi;
 #if CONFIG_SPATIAL_SEGMENTATION
@@ -926,7 +922,7 @@ static void write_inter_segment_id(AV1_COMP *cpi, aom_writer *w,
     } else {
       if (seg->preskip_segid) return;
       if (skip) {
-        write_segment_id(cpi, mbmi, w, seg, segp, mi_row, mi_col, 1);
+        write_segment_id(cpi, xd, mbmi, w, seg, segp, mi_row, mi_col, 1);
         if (seg->temporal_update) ((MB_MODE_INFO *)mbmi)->seg_id_predicted = 0;
         return;
       }
@@ -938,7 +934,7 @@ static void write_inter_segment_id(AV1_COMP *cpi, aom_writer *w,
       aom_write_symbol(w, pred_flag, pred_cdf, 2);
       if (!pred_flag) {
 #if CONFIG_SPATIAL_SEGMENTATION
-        write_segment_id(cpi, mbmi, w, seg, segp, mi_row, mi_col, 0);
+        write_segment_id(cpi, xd, mbmi, w, seg, segp, mi_row, mi_col, 0);
 #else
         write_segment_id(w, seg, segp, mbmi->segment_id);
 #endif
@@ -951,7 +947,7 @@ static void write_inter_segment_id(AV1_COMP *cpi, aom_writer *w,
 #endif
     } else {
 #if CONFIG_SPATIAL_SEGMENTATION
-      write_segment_id(cpi, mbmi, w, seg, segp, mi_row, mi_col, 0);
+      write_segment_id(cpi, xd, mbmi, w, seg, segp, mi_row, mi_col, 0);
 #else
       write_segment_id(w, seg, segp, mbmi->segment_id);
 #endif
@@ -959,10 +955,11 @@ static void write_inter_segment_id(AV1_COMP *cpi, aom_writer *w,
   }
 }
 
-static void pack_inter_mode_mvs(AV1_COMP *cpi, const int mi_row,
-                                const int mi_col, aom_writer *w) {
+static void pack_inter_mode_mvs(AV1_COMP *cpi, ThreadData *const td,
+                                const int mi_row, const int mi_col,
+                                aom_writer *w) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCK *const x = &cpi->td.mb;
+  MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   FRAME_CONTEXT *ec_ctx = xd->tile_ctx;
   const MODE_INFO *mi = xd->mi[0];
@@ -981,7 +978,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const int mi_row,
   (void)mi_row;
   (void)mi_col;
 
-  write_inter_segment_id(cpi, w, seg, segp, mi_row, mi_col, 0, 1);
+  write_inter_segment_id(cpi, xd, w, seg, segp, mi_row, mi_col, 0, 1);
 
   write_skip_mode(cm, xd, segment_id, mi, w);
 
@@ -989,10 +986,10 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const int mi_row,
   skip = mbmi->skip_mode ? 1 : write_skip(cm, xd, segment_id, mi, w);
 
 #if CONFIG_SPATIAL_SEGMENTATION
-  write_inter_segment_id(cpi, w, seg, segp, mi_row, mi_col, skip, 0);
+  write_inter_segment_id(cpi, xd, w, seg, segp, mi_row, mi_col, skip, 0);
 #endif
 
-  write_cdef(cm, w, skip, mi_col, mi_row);
+  write_cdef(cm, xd, w, skip, mi_col, mi_row);
 
   if (cm->delta_q_present_flag) {
     int super_block_upper_left =
@@ -1087,17 +1084,17 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const int mi_row,
       for (ref = 0; ref < 1 + is_compound; ++ref) {
         nmv_context *nmvc = &ec_ctx->nmvc;
         ref_mv = mbmi_ext->ref_mvs[mbmi->ref_frame[ref]][0];
-        av1_encode_mv(cpi, w, &mbmi->mv[ref].as_mv, &ref_mv.as_mv, nmvc,
+        av1_encode_mv(cpi, w, td, &mbmi->mv[ref].as_mv, &ref_mv.as_mv, nmvc,
                       allow_hp);
       }
     } else if (mode == NEAREST_NEWMV || mode == NEAR_NEWMV) {
       nmv_context *nmvc = &ec_ctx->nmvc;
-      av1_encode_mv(cpi, w, &mbmi->mv[1].as_mv,
+      av1_encode_mv(cpi, w, td, &mbmi->mv[1].as_mv,
                     &mbmi_ext->ref_mvs[mbmi->ref_frame[1]][0].as_mv, nmvc,
                     allow_hp);
     } else if (mode == NEW_NEARESTMV || mode == NEW_NEARMV) {
       nmv_context *nmvc = &ec_ctx->nmvc;
-      av1_encode_mv(cpi, w, &mbmi->mv[0].as_mv,
+      av1_encode_mv(cpi, w, td, &mbmi->mv[0].as_mv,
                     &mbmi_ext->ref_mvs[mbmi->ref_frame[0]][0].as_mv, nmvc,
                     allow_hp);
     }
@@ -1186,7 +1183,7 @@ static void pack_inter_mode_mvs(AV1_COMP *cpi, const int mi_row,
       }
     }
 
-    write_mb_interp_filter(cpi, xd, w);
+    write_mb_interp_filter(cpi, td, xd, w);
   }
 }
 
@@ -1223,7 +1220,7 @@ static void write_mb_modes_kf(AV1_COMP *cpi, MACROBLOCKD *xd,
 
 #if CONFIG_SPATIAL_SEGMENTATION
   if (seg->preskip_segid && seg->update_map)
-    write_segment_id(cpi, mbmi, w, seg, segp, mi_row, mi_col, 0);
+    write_segment_id(cpi, xd, mbmi, w, seg, segp, mi_row, mi_col, 0);
 #else
   if (seg->update_map) write_segment_id(w, seg, segp, mbmi->segment_id);
 #endif
@@ -1232,10 +1229,10 @@ static void write_mb_modes_kf(AV1_COMP *cpi, MACROBLOCKD *xd,
 
 #if CONFIG_SPATIAL_SEGMENTATION
   if (!seg->preskip_segid && seg->update_map)
-    write_segment_id(cpi, mbmi, w, seg, segp, mi_row, mi_col, skip);
+    write_segment_id(cpi, xd, mbmi, w, seg, segp, mi_row, mi_col, skip);
 #endif
 
-  write_cdef(cm, w, skip, mi_col, mi_row);
+  write_cdef(cm, xd, w, skip, mi_col, mi_row);
 
   if (cm->delta_q_present_flag) {
     int super_block_upper_left =
@@ -1340,9 +1337,10 @@ static int rd_token_stats_mismatch(RD_STATS *rd_stats, TOKEN_STATS *token_stats,
 #endif
 
 #if ENC_MISMATCH_DEBUG
-static void enc_dump_logs(AV1_COMP *cpi, int mi_row, int mi_col) {
+static void enc_dump_logs(AV1_COMP *cpi, MACROBLOCK *const x, int mi_row,
+                          int mi_col) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO *m;
   xd->mi = cm->mi_grid_visible + (mi_row * cm->mi_stride + mi_col);
   m = xd->mi[0];
@@ -1363,7 +1361,6 @@ static void enc_dump_logs(AV1_COMP *cpi, int mi_row, int mi_col) {
         mv[1].as_int = 0;
       }
 
-      MACROBLOCK *const x = &cpi->td.mb;
       const MB_MODE_INFO_EXT *const mbmi_ext = x->mbmi_ext;
       const int16_t mode_ctx =
           is_comp_ref ? mbmi_ext->compound_mode_context[mbmi->ref_frame[0]]
@@ -1396,10 +1393,12 @@ static void enc_dump_logs(AV1_COMP *cpi, int mi_row, int mi_col) {
 }
 #endif  // ENC_MISMATCH_DEBUG
 
-static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
-                         aom_writer *w, int mi_row, int mi_col) {
+static void write_mbmi_b(AV1_COMP *cpi, ThreadData *const td,
+                         const TileInfo *const tile, aom_writer *w, int mi_row,
+                         int mi_col) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
   MODE_INFO *m;
   int bh, bw;
   xd->mi = cm->mi_grid_visible + (mi_row * cm->mi_stride + mi_col);
@@ -1411,7 +1410,7 @@ static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
   bh = mi_size_high[m->mbmi.sb_type];
   bw = mi_size_wide[m->mbmi.sb_type];
 
-  cpi->td.mb.mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
+  x->mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
 
   set_mi_row_col(xd, tile, mi_row, bh, mi_col, bw, cm->mi_rows, cm->mi_cols);
 
@@ -1421,7 +1420,7 @@ static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
                           ((mi_row & MAX_MIB_MASK) << TX_UNIT_HIGH_LOG2);
 
   if (frame_is_intra_only(cm)) {
-    write_mb_modes_kf(cpi, xd, cpi->td.mb.mbmi_ext, mi_row, mi_col, w);
+    write_mb_modes_kf(cpi, xd, x->mbmi_ext, mi_row, mi_col, w);
   } else {
     // has_subpel_mv_component needs the ref frame buffers set up to look
     // up if they are scaled. has_subpel_mv_component is in turn needed by
@@ -1429,10 +1428,10 @@ static void write_mbmi_b(AV1_COMP *cpi, const TileInfo *const tile,
     set_ref_ptrs(cm, xd, m->mbmi.ref_frame[0], m->mbmi.ref_frame[1]);
 
 #if ENC_MISMATCH_DEBUG
-    enc_dump_logs(cpi, mi_row, mi_col);
+    enc_dump_logs(cpi, x, mi_row, mi_col);
 #endif  // ENC_MISMATCH_DEBUG
 
-    pack_inter_mode_mvs(cpi, mi_row, mi_col, w);
+    pack_inter_mode_mvs(cpi, td, mi_row, mi_col, w);
   }
 }
 
@@ -1482,19 +1481,19 @@ static void write_inter_txb_coeff(AV1_COMMON *const cm, MACROBLOCK *const x,
   }
 }
 
-static void write_tokens_b(AV1_COMP *cpi, const TileInfo *const tile,
-                           aom_writer *w, const TOKENEXTRA **tok,
+static void write_tokens_b(AV1_COMP *cpi, MACROBLOCK *const x,
+                           const TileInfo *const tile, aom_writer *w,
+                           const TOKENEXTRA **tok,
                            const TOKENEXTRA *const tok_end, int mi_row,
                            int mi_col) {
   AV1_COMMON *const cm = &cpi->common;
   const int num_planes = av1_num_planes(cm);
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &x->e_mbd;
   const int mi_offset = mi_row * cm->mi_stride + mi_col;
   MODE_INFO *const m = *(cm->mi_grid_visible + mi_offset);
   MB_MODE_INFO *const mbmi = &m->mbmi;
   int plane;
   int bh, bw;
-  MACROBLOCK *const x = &cpi->td.mb;
   (void)tok;
   (void)tok_end;
   xd->mi = cm->mi_grid_visible + mi_offset;
@@ -1504,7 +1503,7 @@ static void write_tokens_b(AV1_COMP *cpi, const TileInfo *const tile,
 
   bh = mi_size_high[mbmi->sb_type];
   bw = mi_size_wide[mbmi->sb_type];
-  cpi->td.mb.mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
+  x->mbmi_ext = cpi->mbmi_ext_base + (mi_row * cm->mi_cols + mi_col);
 
   set_mi_row_col(xd, tile, mi_row, bh, mi_col, bw, cm->mi_rows, cm->mi_cols);
 
@@ -1557,14 +1556,16 @@ static void write_tokens_b(AV1_COMP *cpi, const TileInfo *const tile,
   }
 }
 
-static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
-                          aom_writer *w, const TOKENEXTRA **tok,
+static void write_modes_b(AV1_COMP *cpi, ThreadData *const td,
+                          const TileInfo *const tile, aom_writer *w,
+                          const TOKENEXTRA **tok,
                           const TOKENEXTRA *const tok_end, int mi_row,
                           int mi_col) {
-  write_mbmi_b(cpi, tile, w, mi_row, mi_col);
+  write_mbmi_b(cpi, td, tile, w, mi_row, mi_col);
 
   AV1_COMMON *cm = &cpi->common;
-  MACROBLOCKD *xd = &cpi->td.mb.e_mbd;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *xd = &x->e_mbd;
   MB_MODE_INFO *mbmi = &xd->mi[0]->mbmi;
   for (int plane = 0; plane < AOMMIN(2, av1_num_planes(cm)); ++plane) {
     const uint8_t palette_size_plane =
@@ -1606,7 +1607,7 @@ static void write_modes_b(AV1_COMP *cpi, const TileInfo *const tile,
                   skip && is_inter_block(mbmi), xd);
   }
 
-  write_tokens_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+  write_tokens_b(cpi, x, tile, w, tok, tok_end, mi_row, mi_col);
 }
 
 static void write_partition(const AV1_COMMON *const cm,
@@ -1646,12 +1647,14 @@ static void write_partition(const AV1_COMMON *const cm,
   }
 }
 
-static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
-                           aom_writer *const w, const TOKENEXTRA **tok,
+static void write_modes_sb(AV1_COMP *const cpi, ThreadData *const td,
+                           const TileInfo *const tile, aom_writer *const w,
+                           const TOKENEXTRA **tok,
                            const TOKENEXTRA *const tok_end, int mi_row,
                            int mi_col, BLOCK_SIZE bsize) {
   const AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
   const int hbs = mi_size_wide[bsize] / 2;
   const int quarter_step = mi_size_wide[bsize] / 4;
   int i;
@@ -1673,7 +1676,7 @@ static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
           const RestorationUnitInfo *rui =
               &cm->rst_info[plane].unit_info[runit_idx];
           loop_restoration_write_sb_coeffs(cm, xd, rui, w, plane,
-                                           cpi->td.counts);
+                                           td->counts);
         }
       }
     }
@@ -1682,51 +1685,53 @@ static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
   write_partition(cm, xd, hbs, mi_row, mi_col, partition, bsize, w);
   switch (partition) {
     case PARTITION_NONE:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
       break;
     case PARTITION_HORZ:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
       if (mi_row + hbs < cm->mi_rows)
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col);
       break;
     case PARTITION_VERT:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
       if (mi_col + hbs < cm->mi_cols)
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + hbs);
       break;
     case PARTITION_SPLIT:
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col, subsize);
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs, subsize);
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col, subsize);
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs,
+      write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row, mi_col, subsize);
+      write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + hbs,
+                     subsize);
+      write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col,
+                     subsize);
+      write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs,
                      subsize);
       break;
     case PARTITION_HORZ_A:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col);
       break;
     case PARTITION_HORZ_B:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs);
       break;
     case PARTITION_VERT_A:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + hbs);
       break;
     case PARTITION_VERT_B:
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row, mi_col + hbs);
-      write_modes_b(cpi, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, mi_col + hbs);
+      write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row + hbs, mi_col + hbs);
       break;
     case PARTITION_HORZ_4:
       for (i = 0; i < 4; ++i) {
         int this_mi_row = mi_row + i * quarter_step;
         if (i > 0 && this_mi_row >= cm->mi_rows) break;
 
-        write_modes_b(cpi, tile, w, tok, tok_end, this_mi_row, mi_col);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, this_mi_row, mi_col);
       }
       break;
     case PARTITION_VERT_4:
@@ -1734,7 +1739,7 @@ static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
         int this_mi_col = mi_col + i * quarter_step;
         if (i > 0 && this_mi_col >= cm->mi_cols) break;
 
-        write_modes_b(cpi, tile, w, tok, tok_end, mi_row, this_mi_col);
+        write_modes_b(cpi, td, tile, w, tok, tok_end, mi_row, this_mi_col);
       }
       break;
     default: assert(0);
@@ -1744,11 +1749,12 @@ static void write_modes_sb(AV1_COMP *const cpi, const TileInfo *const tile,
   update_ext_partition_context(xd, mi_row, mi_col, subsize, bsize, partition);
 }
 
-static void write_modes(AV1_COMP *const cpi, const TileInfo *const tile,
-                        aom_writer *const w, const TOKENEXTRA **tok,
+static void write_modes(AV1_COMP *const cpi, ThreadData *const td,
+                        const TileInfo *const tile, aom_writer *const w,
+                        const TOKENEXTRA **tok,
                         const TOKENEXTRA *const tok_end) {
   AV1_COMMON *const cm = &cpi->common;
-  MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  MACROBLOCKD *const xd = &td->mb.e_mbd;
   const int mi_row_start = tile->mi_row_start;
   const int mi_row_end = tile->mi_row_end;
   const int mi_col_start = tile->mi_col_start;
@@ -1775,7 +1781,7 @@ static void write_modes(AV1_COMP *const cpi, const TileInfo *const tile,
 
     for (mi_col = mi_col_start; mi_col < mi_col_end;
          mi_col += cm->seq_params.mib_size) {
-      write_modes_sb(cpi, tile, w, tok, tok_end, mi_row, mi_col,
+      write_modes_sb(cpi, td, tile, w, tok, tok_end, mi_row, mi_col,
                      cm->seq_params.sb_size);
     }
   }
@@ -3583,6 +3589,266 @@ typedef struct {
   size_t total_length;
 } FrameHeaderInfo;
 
+// A tile packed by a worker into its private buffer, when the tiles are packed
+// in parallel.
+typedef struct {
+  const ThreadData *td;
+  size_t offset;
+  uint32_t size;
+  int error;
+} PackedTile;
+
+typedef struct {
+  PackedTile *tiles;
+  int num_workers;
+} PackTilesData;
+
+static void reset_pack_stats(ThreadData *td) {
+  av1_zero(td->interp_filter_selected);
+  td->max_mv_magnitude = 0;
+}
+
+// Adds the statistics gathered by td while packing tiles to cpi.
+static void merge_pack_stats(AV1_COMP *cpi, const ThreadData *td) {
+  int i;
+  for (i = 0; i < SWITCHABLE; i++)
+    cpi->interp_filter_selected[0][i] += td->interp_filter_selected[i];
+  cpi->max_mv_magnitude = AOMMAX(cpi->max_mv_magnitude, td->max_mv_magnitude);
+}
+
+// Grows the tile packing buffer of td to at least size bytes, keeping the
+// first 'used' bytes. Returns 0 if out of memory.
+static int resize_tile_pack_buf(ThreadData *td, size_t used, size_t size) {
+  if (size > td->tile_pack_buf_size) {
+    const size_t new_size = AOMMAX(size, 2 * td->tile_pack_buf_size);
+    uint8_t *const buf = (uint8_t *)aom_malloc(new_size);
+    if (buf == NULL) return 0;
+    if (used > 0) memcpy(buf, td->tile_pack_buf, used);
+    aom_free(td->tile_pack_buf);
+    td->tile_pack_buf = buf;
+    td->tile_pack_buf_size = new_size;
+  }
+  return 1;
+}
+
+// Packs the tile columns start, start + num_workers, ... The tiles of a column
+// share the above context, so they are packed from top to bottom by the same
+// worker.
+static int pack_tiles_worker_hook(EncWorkerData *const thread_data,
+                                  void *data) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  ThreadData *const td = thread_data->td;
+  const PackTilesData *const pack = (const PackTilesData *)data;
+  const AV1_COMMON *const cm = &cpi->common;
+  const int num_planes = av1_num_planes(cm);
+  const int tile_cols = cm->tile_cols;
+  size_t used = 0;
+  int tile_row, tile_col;
+
+  reset_pack_stats(td);
+  // The counts of a worker other than the main thread start as a copy of the
+  // frame counts, and only what it adds to them is merged back.
+  if (td->counts != &cpi->common.counts) av1_zero(*td->counts);
+
+  for (tile_col = thread_data->start; tile_col < tile_cols;
+       tile_col += pack->num_workers) {
+    TileInfo tile_info;
+    av1_tile_set_col(&tile_info, cm, tile_col);
+
+    for (tile_row = 0; tile_row < cm->tile_rows; tile_row++) {
+      const int tile_idx = tile_row * tile_cols + tile_col;
+      PackedTile *const packed = &pack->tiles[tile_idx];
+      TileDataEnc *const this_tile = &cpi->tile_data[tile_idx];
+      const TOKENEXTRA *tok = cpi->tile_tok[tile_row][tile_col];
+      const TOKENEXTRA *tok_end = tok + cpi->tok_count[tile_row][tile_col];
+      const uint8_t *coded;
+      aom_writer mode_bc;
+
+      av1_tile_set_row(&tile_info, cm, tile_row);
+
+      // Initialise tile context from the frame context
+      this_tile->tctx = *cm->fc;
+      td->mb.e_mbd.tile_ctx = &this_tile->tctx;
+      mode_bc.allow_update_cdf = 1;
+#if CONFIG_CDF_UPDATE_MODE
+      mode_bc.allow_update_cdf =
+          mode_bc.allow_update_cdf && !cm->disable_cdf_update;
+#endif  // CONFIG_CDF_UPDATE_MODE
+      av1_reset_loop_restoration(&td->mb.e_mbd, num_planes);
+
+      // The coded tile is taken from the writer, not copied to a buffer.
+      aom_start_encode(&mode_bc, NULL);
+      write_modes(cpi, td, &tile_info, &mode_bc, &tok, tok_end);
+#if CONFIG_TRAILING_BITS
+      const int nb_bits = aom_finish_encode(&mode_bc, &coded);
+#else
+      aom_finish_encode(&mode_bc, &coded);
+#endif
+      packed->td = td;
+      packed->offset = used;
+      packed->size = mode_bc.pos;
+      // One more byte for the trailing bits.
+      packed->error = coded == NULL ||
+                      !resize_tile_pack_buf(td, used, used + packed->size + 1);
+      if (!packed->error) {
+        memcpy(td->tile_pack_buf + used, coded, packed->size);
+#if CONFIG_TRAILING_BITS
+        // Like the serial code, end the last tile with a 0b10000000 byte if
+        // the arithmetic encoder ended on a byte boundary.
+        if (tile_idx == tile_cols * cm->tile_rows - 1 && nb_bits % 8 == 0)
+          td->tile_pack_buf[used + packed->size++] = 0x80;
+#endif
+        used += packed->size;
+      }
+      aom_clear_encode(&mode_bc);
+    }
+  }
+  return 1;
+}
+
+// Packs the tiles in parallel, each worker into its own buffer, then writes
+// the tile groups. All the sizes are known by then, so the OBU size fields and
+// the tile size fields are written with their final length, and only the
+// headers of each OBU are moved up to make room for its size field. The
+// bitstream is the same as the one of the serial code.
+static uint32_t write_tiles_in_tg_obus_mt(AV1_COMP *const cpi,
+                                          uint8_t *const dst,
+                                          unsigned int *max_tile_size,
+                                          struct aom_write_bit_buffer *saved_wb,
+                                          uint8_t obu_extension_header,
+                                          const FrameHeaderInfo *fh_info,
+                                          int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  TileBufferEnc(*const tile_buffers)[MAX_TILE_COLS] = cpi->tile_buffers;
+  const int tile_cols = cm->tile_cols;
+  const int num_tiles = tile_cols * cm->tile_rows;
+  const int n_log2_tiles = cm->log2_tile_rows + cm->log2_tile_cols;
+  const int num_tg_hdrs = cm->num_tg;
+  const int tg_size = (num_tiles + num_tg_hdrs - 1) / num_tg_hdrs;
+#if CONFIG_OBU_FRAME
+  const OBU_TYPE obu_type = (num_tg_hdrs == 1) ? OBU_FRAME : OBU_TILE_GROUP;
+#else
+  const OBU_TYPE obu_type = OBU_TILE_GROUP;
+#endif
+  uint32_t frame_header_size = 0;
+  int tile_size_bytes = 4;
+  uint8_t *data = dst;
+  PackTilesData pack;
+  int tile_idx, tg_start;
+
+  // Writing the frame header may change the frame state the tiles are packed
+  // with, so it is written first, after its OBU header.
+#if CONFIG_OBU_FRAME
+  if (num_tg_hdrs == 1) {
+    const uint32_t obu_header_size =
+        write_obu_header(obu_type, obu_extension_header, dst);
+    frame_header_size =
+        write_frame_header_obu(cpi, saved_wb, dst + obu_header_size);
+  }
+#else
+  (void)saved_wb;
+#endif  // CONFIG_OBU_FRAME
+
+  CHECK_MEM_ERROR(cm, pack.tiles,
+                  (PackedTile *)aom_calloc(num_tiles, sizeof(*pack.tiles)));
+  pack.num_workers = num_workers;
+  av1_run_enc_workers(cpi, (AVxWorkerHook)pack_tiles_worker_hook, &pack,
+                      num_workers);
+
+  // Worker i packed the tile column i first, so the tiles of the first row
+  // give each worker once. The statistics of cpi->td are merged by the caller.
+  for (tile_idx = 0; tile_idx < num_workers; tile_idx++) {
+    const ThreadData *const td = pack.tiles[tile_idx].td;
+    if (td != &cpi->td) {
+      merge_pack_stats(cpi, td);
+      av1_accumulate_frame_counts(&cm->counts, td->counts);
+    }
+  }
+
+  cm->largest_tile_id = 0;
+  *max_tile_size = 0;
+  for (tile_idx = 0; tile_idx < num_tiles; tile_idx++) {
+    const uint32_t tile_size = pack.tiles[tile_idx].size;
+    if (pack.tiles[tile_idx].error) {
+      aom_free(pack.tiles);
+      aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                         "Failed to allocate tile packing buffer");
+    }
+    assert(tile_size >= AV1_MIN_TILE_SIZE_BYTES);
+    if (tile_size > *max_tile_size) cm->largest_tile_id = tile_idx;
+    if (tile_idx < num_tiles - 1)
+      *max_tile_size = AOMMAX(*max_tile_size, tile_size);
+  }
+
+  // With a single tile group, the tile size fields are as short as possible.
+  if (num_tg_hdrs == 1) {
+    tile_size_bytes = choose_size_bytes(*max_tile_size, 0);
+    assert(tile_size_bytes >= 1 && tile_size_bytes <= 4);
+    aom_wb_overwrite_literal(saved_wb, tile_size_bytes - 1, 2);
+  }
+
+  for (tg_start = 0; tg_start < num_tiles; tg_start += tg_size) {
+    const int tg_end = AOMMIN(tg_start + tg_size, num_tiles) - 1;
+    uint32_t obu_header_size;
+    uint32_t hdr_size = (tg_start == 0) ? frame_header_size : 0;
+    uint32_t obu_payload_size;
+    size_t length_field_size;
+
+    if (tg_start > 0 && cm->error_resilient_mode) {
+      // Insert a copy of the Frame Header OBU.
+      memcpy(data, fh_info->frame_header, fh_info->total_length);
+#if CONFIG_OBU_REDUNDANT_FRAME_HEADER
+      // Rewrite the OBU header to change the OBU type to Redundant Frame
+      // Header.
+      write_obu_header(OBU_REDUNDANT_FRAME_HEADER, obu_extension_header,
+                       &data[fh_info->obu_header_byte_offset]);
+#endif  // CONFIG_OBU_REDUNDANT_FRAME_HEADER
+      data += fh_info->total_length;
+    }
+
+    obu_header_size = write_obu_header(obu_type, obu_extension_header, data);
+    hdr_size += write_tile_group_header(data + obu_header_size + hdr_size,
+                                        tg_start, tg_end, n_log2_tiles,
+                                        cm->num_tg > 1);
+    obu_payload_size = hdr_size;
+    for (tile_idx = tg_start; tile_idx <= tg_end; tile_idx++) {
+      obu_payload_size += pack.tiles[tile_idx].size;
+      if (tile_idx < tg_end) obu_payload_size += tile_size_bytes;
+    }
+
+    length_field_size = aom_uleb_size_in_bytes(obu_payload_size);
+    memmove(data + obu_header_size + length_field_size,
+            data + obu_header_size, hdr_size);
+    if (write_uleb_obu_size(obu_header_size, obu_payload_size, data) !=
+        AOM_CODEC_OK) {
+      assert(0);
+    }
+#if CONFIG_OBU_FRAME
+    if (tg_start == 0) saved_wb->bit_buffer += length_field_size;
+#endif  // CONFIG_OBU_FRAME
+    data += obu_header_size + length_field_size + hdr_size;
+
+    for (tile_idx = tg_start; tile_idx <= tg_end; tile_idx++) {
+      const PackedTile *const packed = &pack.tiles[tile_idx];
+      TileBufferEnc *const buf =
+          &tile_buffers[tile_idx / tile_cols][tile_idx % tile_cols];
+      buf->data = data;
+      buf->size = packed->size;
+      // The last tile of the tile group does not have a header.
+      if (tile_idx < tg_end) {
+        mem_put_varsize(data, tile_size_bytes,
+                        packed->size - AV1_MIN_TILE_SIZE_BYTES);
+        data += tile_size_bytes;
+      }
+      memcpy(data, packed->td->tile_pack_buf + packed->offset, packed->size);
+      data += packed->size;
+    }
+  }
+
+  aom_free(pack.tiles);
+  return (uint32_t)(data - dst);
+}
+
 static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
                                        unsigned int *max_tile_size,
                                        unsigned int *max_tile_col_size,
@@ -3616,6 +3882,14 @@ static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
   *max_tile_size = 0;
   *max_tile_col_size = 0;
 
+  if (cm->all_lossless || (cm->allow_intrabc && NO_FILTER_FOR_IBC)) {
+    // Initialize to indicate no CDEF for safety.
+    cm->cdef_bits = 0;
+    cm->cdef_strengths[0] = 0;
+    cm->nb_cdef_strengths = 1;
+    cm->cdef_uv_strengths[0] = 0;
+  }
+
   if (cm->large_scale_tile) {
 #if CONFIG_OBU_FRAME
     // For large_scale_tile case, we always have only one tile group, so it can
@@ -3672,7 +3946,7 @@ static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
             mode_bc.allow_update_cdf && !cm->disable_cdf_update;
 #endif  // CONFIG_CDF_UPDATE_MODE
         aom_start_encode(&mode_bc, buf->data + data_offset);
-        write_modes(cpi, &tile_info, &mode_bc, &tok, tok_end);
+        write_modes(cpi, &cpi->td, &tile_info, &mode_bc, &tok, tok_end);
         assert(tok == tok_end);
         aom_stop_encode(&mode_bc);
         tile_size = mode_bc.pos;
@@ -3755,6 +4029,16 @@ static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
     return (uint32_t)total_size;
   }
 
+#if !CONFIG_BITSTREAM_DEBUG
+  // The tile columns are packed in parallel if there are threads for it.
+  if (AOMMIN(cpi->oxcf.max_threads, tile_cols) > 1) {
+    av1_create_workers(cpi, cpi->oxcf.max_threads);
+    return write_tiles_in_tg_obus_mt(cpi, dst, max_tile_size, saved_wb,
+                                     obu_extension_header, fh_info,
+                                     AOMMIN(cpi->num_workers, tile_cols));
+  }
+#endif  // !CONFIG_BITSTREAM_DEBUG
+
   uint32_t obu_header_size = 0;
   uint8_t *tile_data_start = dst + total_size;
   for (tile_row = 0; tile_row < tile_rows; tile_row++) {
@@ -3832,7 +4116,7 @@ static uint32_t write_tiles_in_tg_obus(AV1_COMP *const cpi, uint8_t *const dst,
       av1_reset_loop_restoration(&cpi->td.mb.e_mbd, num_planes);
 
       aom_start_encode(&mode_bc, dst + total_size);
-      write_modes(cpi, &tile_info, &mode_bc, &tok, tok_end);
+      write_modes(cpi, &cpi->td, &tile_info, &mode_bc, &tok, tok_end);
 #if CONFIG_TRAILING_BITS
       nb_bits = aom_stop_encode(&mode_bc);
 #else
@@ -4048,9 +4332,11 @@ int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size) {
   } else {
     //  Each tile group obu will be preceded by 4-byte size of the tile group
     //  obu
+    reset_pack_stats(&cpi->td);
     data_size =
         write_tiles_in_tg_obus(cpi, data, &max_tile_size, &max_tile_col_size,
                                &saved_wb, obu_extension_header, &fh_info);
+    merge_pack_stats(cpi, &cpi->td);
   }
   data += data_size;
   *size = data - dst;
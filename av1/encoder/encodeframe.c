@@ -3400,15 +3400,25 @@ BEGIN_PARTITION_SEARCH:
   }
 }
 
+// Encodes a superblock row of a tile. When row_mt_sync is not NULL, the rows
+// of the tile are encoded in parallel, and tile_data is the state of this
+// row only.
 static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
                              TileDataEnc *tile_data, int mi_row,
-                             TOKENEXTRA **tp) {
+                             TOKENEXTRA **tp, AV1RowMTSync *row_mt_sync,
+                             int tile_col) {
   AV1_COMMON *const cm = &cpi->common;
   const int num_planes = av1_num_planes(cm);
   const TileInfo *const tile_info = &tile_data->tile_info;
   MACROBLOCK *const x = &td->mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   SPEED_FEATURES *const sf = &cpi->sf;
+  const int mib_size_log2 = cm->seq_params.mib_size_log2;
+  const int frame_sb_row = mi_row >> mib_size_log2;
+  const int sb_cols_in_tile =
+      (tile_info->mi_col_end - tile_info->mi_col_start +
+       cm->seq_params.mib_size - 1) >>
+      mib_size_log2;
   int mi_col;
   const int leaf_nodes = 256;
 
@@ -3444,6 +3454,13 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
     MODE_INFO **mi = cm->mi_grid_visible + idx_str;
     PC_TREE *const pc_root =
         td->pc_root[cm->seq_params.mib_size_log2 - MIN_MIB_SIZE_LOG2];
+    const int sb_col_in_tile = (mi_col - tile_info->mi_col_start) >>
+                               mib_size_log2;
+
+    // Wait for the superblock to the top right to be encoded.
+    if (row_mt_sync && mi_row != tile_info->mi_row_start)
+      av1_row_mt_sync_read(row_mt_sync, tile_col, frame_sb_row,
+                           AOMMIN(sb_col_in_tile + 2, sb_cols_in_tile));
 
     av1_fill_coeff_costs(&td->mb, xd->tile_ctx, num_planes);
     av1_fill_mode_rates(cm, x, xd->tile_ctx);
@@ -3609,6 +3626,17 @@ static void encode_rd_sb_row(AV1_COMP *cpi, ThreadData *td,
                           pc_root, NULL);
       }
     }
+
+    if (row_mt_sync) {
+      // The next row of the tile starts from the CDFs and mode thresholds
+      // reached after the second superblock of this row, which is the last
+      // one it depends on.
+      if (mi_row + cm->seq_params.mib_size < tile_info->mi_row_end &&
+          sb_col_in_tile == AOMMIN(1, sb_cols_in_tile - 1))
+        row_mt_sync->row_state[tile_col * 2 + (frame_sb_row & 1)] = *tile_data;
+      av1_row_mt_sync_write(row_mt_sync, tile_col, frame_sb_row,
+                            sb_col_in_tile + 1);
+    }
   }
 }
 
@@ -3727,7 +3755,7 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
 
   for (mi_row = tile_info->mi_row_start; mi_row < tile_info->mi_row_end;
        mi_row += cm->seq_params.mib_size) {
-    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok);
+    encode_rd_sb_row(cpi, td, this_tile, mi_row, &tok, NULL, 0);
   }
 
   cpi->tok_count[tile_row][tile_col] =
@@ -3738,6 +3766,46 @@ void av1_encode_tile(AV1_COMP *cpi, ThreadData *td, int tile_row,
                           av1_num_planes(cm)));
 }
 
+void av1_encode_sb_row(AV1_COMP *cpi, ThreadData *td, TileDataEnc *row_data,
+                       int tile_row, int tile_col, int mi_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  const TileInfo *const tile_info = &row_data->tile_info;
+  const int num_planes = av1_num_planes(cm);
+  const int sb_row = mi_row >> cm->seq_params.mib_size_log2;
+  const int sb_row_in_tile = sb_row - cm->tile_row_start_sb[tile_row];
+  const int row_tokens = allocated_sb_row_tokens(
+      *tile_info, cm->seq_params.mib_size_log2 + MI_SIZE_LOG2, num_planes);
+  TOKENEXTRA *const tok_start =
+      cpi->tile_tok[tile_row][tile_col] + sb_row_in_tile * row_tokens;
+  TOKENEXTRA *tok = tok_start;
+
+  if (mi_row == tile_info->mi_row_start) {
+    // The tiles of a tile column share the above context, so the tile above
+    // must be finished before it is reset.
+    if (sb_row > 0) {
+      const int sb_cols_in_tile =
+          cm->tile_col_start_sb[tile_col + 1] - cm->tile_col_start_sb[tile_col];
+      av1_row_mt_sync_read(row_mt_sync, tile_col, sb_row, sb_cols_in_tile);
+    }
+    av1_zero_above_context(cm, tile_info->mi_col_start, tile_info->mi_col_end);
+  }
+
+  td->mb.m_search_count_ptr = &row_data->m_search_count;
+  td->mb.ex_search_count_ptr = &row_data->ex_search_count;
+  td->mb.e_mbd.tile_ctx = &row_data->tctx;
+
+  cfl_init(&td->mb.e_mbd.cfl, cm);
+
+  av1_crc_calculator_init(&td->mb.mb_rd_record.crc_calculator, 24, 0x5D6DCB);
+
+  encode_rd_sb_row(cpi, td, row_data, mi_row, &tok, row_mt_sync, tile_col);
+
+  row_mt_sync->tok_count[tile_col * row_mt_sync->sb_rows + sb_row] =
+      (unsigned int)(tok - tok_start);
+  assert(tok - tok_start <= row_tokens);
+}
+
 static void encode_tiles(AV1_COMP *cpi) {
   AV1_COMMON *const cm = &cpi->common;
   int tile_col, tile_row;
@@ -4027,6 +4095,113 @@ static int check_skip_mode_enabled(AV1_COMP *const cpi) {
   return 1;
 }
 
+#if CONFIG_HASH_ME
+typedef struct {
+  const YV12_BUFFER_CONFIG *picture;
+  // 2 for the 2x2 hashes, which are computed from the pixels.
+  int block_size;
+  uint32_t **src_hash;
+  uint32_t **dst_hash;
+  int8_t **src_same;
+  int8_t **dst_same;
+  int rows;
+  int num_workers;
+} BlockHashJob;
+
+static void hash_block_rows(const BlockHashJob *job, int y_start, int y_end) {
+  if (job->block_size == 2) {
+    av1_generate_block_2x2_hash_rows(job->picture, job->dst_hash,
+                                     job->dst_same, y_start, y_end);
+  } else {
+    av1_generate_block_hash_rows(job->picture, job->block_size, job->src_hash,
+                                 job->dst_hash, job->src_same, job->dst_same,
+                                 y_start, y_end);
+  }
+}
+
+// Hashes the thread_data->start-th of num_workers bands of rows.
+static int hash_block_rows_worker_hook(EncWorkerData *const thread_data,
+                                       void *data) {
+  const BlockHashJob *const job = (const BlockHashJob *)data;
+  const int band = thread_data->start;
+  hash_block_rows(job, job->rows * band / job->num_workers,
+                  job->rows * (band + 1) / job->num_workers);
+  return 1;
+}
+
+// Fills the hash table of the frame with the blocks of the source frame, from
+// 4x4 to 128x128. The hashes of a block size are computed from those of the
+// size below, so one size is done at a time, with its rows spread over the
+// workers.
+static void hash_source_frame(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const YV12_BUFFER_CONFIG *const source = cpi->source;
+  const int pic_width = source->y_crop_width;
+  const int pic_height = source->y_crop_height;
+  const int pic_size = pic_width * pic_height;
+  int max_workers = 1;
+  int hash_table_ok = 1;
+  int k, j, dst;
+  BlockHashJob job;
+
+  if (pic_size > cpi->block_hash_buf_size) {
+    cpi->block_hash_buf_size = 0;
+    for (k = 0; k < 2; k++) {
+      for (j = 0; j < 2; j++) {
+        aom_free(cpi->block_hash_values[k][j]);
+        CHECK_MEM_ERROR(cm, cpi->block_hash_values[k][j],
+                        aom_malloc(sizeof(uint32_t) * pic_size));
+      }
+
+      for (j = 0; j < 3; j++) {
+        aom_free(cpi->is_block_same[k][j]);
+        CHECK_MEM_ERROR(cm, cpi->is_block_same[k][j],
+                        aom_malloc(sizeof(int8_t) * pic_size));
+      }
+    }
+    cpi->block_hash_buf_size = pic_size;
+  }
+
+  if (!av1_hash_table_create(&cm->cur_frame->hash_table))
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate hash table");
+
+  if (cpi->oxcf.max_threads > 1) {
+    av1_create_workers(cpi, cpi->oxcf.max_threads);
+    max_workers = cpi->num_workers;
+  }
+
+  job.picture = source;
+  // The buffers of each block size are the source of the next one.
+  dst = 0;
+  for (job.block_size = 2; job.block_size <= 128; job.block_size *= 2) {
+    job.src_hash = cpi->block_hash_values[!dst];
+    job.src_same = cpi->is_block_same[!dst];
+    job.dst_hash = cpi->block_hash_values[dst];
+    job.dst_same = cpi->is_block_same[dst];
+    job.rows = pic_height - job.block_size + 1;
+    job.num_workers = AOMMIN(max_workers, job.rows);
+    if (job.num_workers > 1) {
+      av1_run_enc_workers(cpi, (AVxWorkerHook)hash_block_rows_worker_hook,
+                          &job, job.num_workers);
+    } else if (job.rows > 0) {
+      hash_block_rows(&job, 0, job.rows);
+    }
+
+    if (job.block_size >= 4) {
+      hash_table_ok &= av1_add_to_hash_map_by_row_with_precal_data(
+          &cm->cur_frame->hash_table, job.dst_hash, job.dst_same[2],
+          pic_width, pic_height, job.block_size);
+    }
+    dst = !dst;
+  }
+
+  if (!hash_table_ok)
+    aom_internal_error(&cm->error, AOM_CODEC_MEM_ERROR,
+                       "Failed to allocate hash table entries");
+}
+#endif  // CONFIG_HASH_ME
+
 static void encode_frame_internal(AV1_COMP *cpi) {
   ThreadData *const td = &cpi->td;
   MACROBLOCK *const x = &td->mb;
@@ -4073,77 +4248,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
   }
 
 #if CONFIG_HASH_ME
-  if (cpi->oxcf.pass != 1 && av1_use_hash_me(cm)) {
-    // add to hash table
-    const int pic_width = cpi->source->y_crop_width;
-    const int pic_height = cpi->source->y_crop_height;
-    uint32_t *block_hash_values[2][2];
-    int8_t *is_block_same[2][3];
-    int k, j;
-
-    for (k = 0; k < 2; k++) {
-      for (j = 0; j < 2; j++) {
-        CHECK_MEM_ERROR(cm, block_hash_values[k][j],
-                        aom_malloc(sizeof(uint32_t) * pic_width * pic_height));
-      }
-
-      for (j = 0; j < 3; j++) {
-        CHECK_MEM_ERROR(cm, is_block_same[k][j],
-                        aom_malloc(sizeof(int8_t) * pic_width * pic_height));
-      }
-    }
-
-    av1_hash_table_create(&cm->cur_frame->hash_table);
-    av1_generate_block_2x2_hash_value(cpi->source, block_hash_values[0],
-                                      is_block_same[0]);
-    av1_generate_block_hash_value(cpi->source, 4, block_hash_values[0],
-                                  block_hash_values[1], is_block_same[0],
-                                  is_block_same[1]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[1], is_block_same[1][2],
-        pic_width, pic_height, 4);
-    av1_generate_block_hash_value(cpi->source, 8, block_hash_values[1],
-                                  block_hash_values[0], is_block_same[1],
-                                  is_block_same[0]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[0], is_block_same[0][2],
-        pic_width, pic_height, 8);
-    av1_generate_block_hash_value(cpi->source, 16, block_hash_values[0],
-                                  block_hash_values[1], is_block_same[0],
-                                  is_block_same[1]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[1], is_block_same[1][2],
-        pic_width, pic_height, 16);
-    av1_generate_block_hash_value(cpi->source, 32, block_hash_values[1],
-                                  block_hash_values[0], is_block_same[1],
-                                  is_block_same[0]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[0], is_block_same[0][2],
-        pic_width, pic_height, 32);
-    av1_generate_block_hash_value(cpi->source, 64, block_hash_values[0],
-                                  block_hash_values[1], is_block_same[0],
-                                  is_block_same[1]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[1], is_block_same[1][2],
-        pic_width, pic_height, 64);
-
-    av1_generate_block_hash_value(cpi->source, 128, block_hash_values[1],
-                                  block_hash_values[0], is_block_same[1],
-                                  is_block_same[0]);
-    av1_add_to_hash_map_by_row_with_precal_data(
-        &cm->cur_frame->hash_table, block_hash_values[0], is_block_same[0][2],
-        pic_width, pic_height, 128);
-
-    for (k = 0; k < 2; k++) {
-      for (j = 0; j < 2; j++) {
-        aom_free(block_hash_values[k][j]);
-      }
-
-      for (j = 0; j < 3; j++) {
-        aom_free(is_block_same[k][j]);
-      }
-    }
-  }
+  if (cpi->oxcf.pass != 1 && av1_use_hash_me(cm)) hash_source_frame(cpi);
 #endif
 
   for (i = 0; i < MAX_SEGMENTS; ++i) {
@@ -4352,7 +4457,14 @@ static void encode_frame_internal(AV1_COMP *cpi) {
     // TODO(geza.lore): The multi-threaded encoder is not safe with more than
     // 1 tile rows, as it uses the single above_context et al arrays from
     // cpi->common
-    if (AOMMIN(cpi->oxcf.max_threads, cm->tile_cols) > 1 && cm->tile_rows == 1)
+    // Row-based multi-threading is used whatever the number of threads, so
+    // that the output does not depend on it. Intra block copy may refer to
+    // the whole area above and to the left of the block, which the wavefront
+    // does not wait for.
+    if (cpi->oxcf.row_mt && !cm->allow_intrabc)
+      av1_encode_tiles_row_mt(cpi);
+    else if (AOMMIN(cpi->oxcf.max_threads, cm->tile_cols) > 1 &&
+             cm->tile_rows == 1)
       av1_encode_tiles_mt(cpi);
     else
       encode_tiles(cpi);
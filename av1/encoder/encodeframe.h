@@ -24,6 +24,7 @@ struct macroblock;
 struct yv12_buffer_config;
 struct AV1_COMP;
 struct ThreadData;
+struct TileDataEnc;
 
 void av1_setup_src_planes(struct macroblock *x,
                           const struct yv12_buffer_config *src, int mi_row,
@@ -34,6 +35,11 @@ void av1_encode_frame(struct AV1_COMP *cpi);
 void av1_init_tile_data(struct AV1_COMP *cpi);
 void av1_encode_tile(struct AV1_COMP *cpi, struct ThreadData *td, int tile_row,
                      int tile_col);
+// Encodes superblock row mi_row of a tile, when the rows of the tiles are
+// encoded in parallel. row_data holds the adaptive state the row starts from.
+void av1_encode_sb_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                       struct TileDataEnc *row_data, int tile_row,
+                       int tile_col, int mi_row);
 
 void av1_update_tx_type_count(const struct AV1Common *cm, MACROBLOCKD *xd,
                               int blk_row, int blk_col, int plane,
@@ -541,6 +541,23 @@ static void dealloc_compressor_data(AV1_COMP *cpi) {
   av1_free_pc_tree(&cpi->td, num_planes);
 
   aom_free(cpi->td.mb.palette_buffer);
+  aom_free(cpi->td.tile_pack_buf);
+  cpi->td.tile_pack_buf = NULL;
+  cpi->td.tile_pack_buf_size = 0;
+
+#if CONFIG_HASH_ME
+  for (int k = 0; k < 2; k++) {
+    for (int j = 0; j < 2; j++) {
+      aom_free(cpi->block_hash_values[k][j]);
+      cpi->block_hash_values[k][j] = NULL;
+    }
+    for (int j = 0; j < 3; j++) {
+      aom_free(cpi->is_block_same[k][j]);
+      cpi->is_block_same[k][j] = NULL;
+    }
+  }
+  cpi->block_hash_buf_size = 0;
+#endif  // CONFIG_HASH_ME
 }
 
 static void save_coding_context(AV1_COMP *cpi) {
@@ -2893,12 +2910,18 @@ void av1_remove_compressor(AV1_COMP *cpi) {
       aom_free(thread_data->td->wsrc_buf);
       aom_free(thread_data->td->mask_buf);
       aom_free(thread_data->td->counts);
+      aom_free(thread_data->td->tile_pack_buf);
       av1_free_pc_tree(thread_data->td, num_planes);
       aom_free(thread_data->td);
     }
   }
   aom_free(cpi->tile_thr_data);
   aom_free(cpi->workers);
+  av1_loop_filter_dealloc(&cpi->lf_row_sync);
+  av1_cdef_sync_dealloc(&cpi->cdef_sync);
+  av1_loop_restoration_dealloc(&cpi->lr_row_sync);
+  av1_row_mt_sync_dealloc(&cpi->row_mt_sync);
+  av1_tile_job_queue_dealloc(&cpi->tile_job_queue);
 
   dealloc_compressor_data(cpi);
 
@@ -4107,13 +4130,28 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
   }
 
   if (lf->filter_level[0] || lf->filter_level[1]) {
-    av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level[0],
-                          lf->filter_level[1], 0, 0);
-    if (num_planes > 1) {
-      av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level_u,
-                            lf->filter_level_u, 1, 0);
-      av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level_v,
-                            lf->filter_level_v, 2, 0);
+    if (cpi->oxcf.max_threads > 1) {
+      av1_create_workers(cpi, cpi->oxcf.max_threads);
+      av1_loop_filter_frame_mt(cm->frame_to_show, cm, xd, lf->filter_level[0],
+                               lf->filter_level[1], 0, 0, cpi->workers,
+                               cpi->num_workers, &cpi->lf_row_sync);
+      if (num_planes > 1) {
+        av1_loop_filter_frame_mt(cm->frame_to_show, cm, xd, lf->filter_level_u,
+                                 lf->filter_level_u, 1, 0, cpi->workers,
+                                 cpi->num_workers, &cpi->lf_row_sync);
+        av1_loop_filter_frame_mt(cm->frame_to_show, cm, xd, lf->filter_level_v,
+                                 lf->filter_level_v, 2, 0, cpi->workers,
+                                 cpi->num_workers, &cpi->lf_row_sync);
+      }
+    } else {
+      av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level[0],
+                            lf->filter_level[1], 0, 0);
+      if (num_planes > 1) {
+        av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level_u,
+                              lf->filter_level_u, 1, 0);
+        av1_loop_filter_frame(cm->frame_to_show, cm, xd, lf->filter_level_v,
+                              lf->filter_level_v, 2, 0);
+      }
     }
   }
 
@@ -4131,7 +4169,13 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
                     cpi->sf.fast_cdef_search);
 
     // Apply the filter
-    av1_cdef_frame(cm->frame_to_show, cm, xd);
+    if (cpi->oxcf.max_threads > 1) {
+      av1_create_workers(cpi, cpi->oxcf.max_threads);
+      av1_cdef_frame_mt(cm->frame_to_show, cm, xd, cpi->workers,
+                        cpi->num_workers, &cpi->cdef_sync);
+    } else {
+      av1_cdef_frame(cm->frame_to_show, cm, xd);
+    }
   }
 
   superres_post_encode(cpi);
@@ -4146,7 +4190,18 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
-      av1_loop_restoration_filter_frame(cm->frame_to_show, cm);
+      const int lr_threads =
+          cpi->oxcf.lr_threads > 0
+              ? AOMMIN(cpi->oxcf.lr_threads, cpi->oxcf.max_threads)
+              : cpi->oxcf.max_threads;
+      if (lr_threads > 1) {
+        av1_create_workers(cpi, cpi->oxcf.max_threads);
+        av1_loop_restoration_filter_frame_mt(
+            cm->frame_to_show, cm, cpi->workers,
+            AOMMIN(lr_threads, cpi->num_workers), &cpi->lr_row_sync);
+      } else {
+        av1_loop_restoration_filter_frame(cm->frame_to_show, cm);
+      }
     }
   }
 }
@@ -256,6 +256,10 @@ typedef struct AV1EncoderConfig {
   int tile_heights[MAX_TILE_ROWS];
 
   int max_threads;
+  // Encode the superblock rows of a tile in parallel.
+  int row_mt;
+  // Threads of the loop restoration filter, 0 for max_threads.
+  int lr_threads;
 
   aom_fixed_buf_t two_pass_stats_in;
   struct aom_codec_pkt_list *output_pkt_list;
@@ -336,10 +340,58 @@ typedef struct ThreadData {
   uint8_t *left_pred_buf;
   PALETTE_BUFFER *palette_buffer;
   int intrabc_used_this_tile;
+  // Statistics of the tiles packed by this thread, merged into cpi once the
+  // frame is packed.
+  int interp_filter_selected[SWITCHABLE];
+  unsigned int max_mv_magnitude;
+  // Coded tiles of this thread when the tiles are packed in parallel.
+  uint8_t *tile_pack_buf;
+  size_t tile_pack_buf_size;
 } ThreadData;
 
 struct EncWorkerData;
 
+// Synchronization of the superblock rows of the tiles when they are encoded
+// in parallel. Each superblock waits for the superblock to the top right of
+// it, and the first row of a tile waits for the whole last row of the tile
+// above it, whose above context it resets.
+typedef struct AV1RowMTSync {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+  pthread_mutex_t *job_mutex;
+#endif
+  // Number of superblocks encoded and number of tokens written, for each tile
+  // column and superblock row of the frame.
+  int *num_finished_cols;
+  unsigned int *tok_count;
+  // Adaptive state a superblock row starts from: the state of the row above
+  // after its second superblock. The rows of a tile column use two slots in
+  // turn.
+  TileDataEnc *row_state;
+  // State of the row being encoded by each worker.
+  TileDataEnc *worker_state;
+  int sb_rows;
+  int tile_cols;
+  int num_workers;
+  int next_job;
+} AV1RowMTSync;
+
+// Queue of the tile columns to encode with tile based multi-threading. The
+// tiles of a column share the above context, so a column is the unit of work.
+// The workers take the columns from a shared counter, in decreasing order of
+// the time they took in the previous frame.
+typedef struct AV1TileJobQueue {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif
+  int job_order[MAX_TILE_COLS];
+  // Encoding time in microseconds of each tile column in the last frame.
+  int64_t col_time[MAX_TILE_COLS];
+  int tile_cols;
+  int next_job;
+} AV1TileJobQueue;
+
 typedef struct ActiveMap {
   int enabled;
   int update;
@@ -566,6 +618,11 @@ typedef struct AV1_COMP {
   int num_workers;
   AVxWorker *workers;
   struct EncWorkerData *tile_thr_data;
+  AV1LfSync lf_row_sync;
+  AV1CdefSync cdef_sync;
+  AV1LrSync lr_row_sync;
+  AV1RowMTSync row_mt_sync;
+  AV1TileJobQueue tile_job_queue;
   int refresh_frame_mask;
   int existing_fb_idx_to_show;
   int is_arf_filter_off[MAX_EXT_ARFS + 1];
@@ -583,6 +640,13 @@ typedef struct AV1_COMP {
   // TODO(huisu@google.com): we can update dv_joint_cost per SB.
   int dv_joint_cost[MV_JOINTS];
   int has_lossless_segment;
+#if CONFIG_HASH_ME
+  // The block hashes and same-colour flags of the source frame, for two block
+  // sizes at a time. Each array holds block_hash_buf_size entries.
+  uint32_t *block_hash_values[2][2];
+  int8_t *is_block_same[2][3];
+  int block_hash_buf_size;
+#endif  // CONFIG_HASH_ME
 } AV1_COMP;
 
 void av1_initialize_enc(void);
@@ -722,6 +786,17 @@ static INLINE unsigned int allocated_tokens(TileInfo tile, int sb_size_log2,
   return get_token_alloc(tile_mb_rows, tile_mb_cols, sb_size_log2, num_planes);
 }
 
+// Get the allocated token size for one superblock row of a tile. The tokens
+// of each row start at a multiple of it when the rows are encoded in parallel.
+static INLINE unsigned int allocated_sb_row_tokens(TileInfo tile,
+                                                   int sb_size_log2,
+                                                   int num_planes) {
+  int tile_mb_cols = (tile.mi_col_end - tile.mi_col_start + 2) >> 2;
+
+  return get_token_alloc(1 << (sb_size_log2 - 4), tile_mb_cols, sb_size_log2,
+                         num_planes);
+}
+
 void av1_set_temporal_mv_prediction(AV1_COMP *cpi, int allow_tempmv_prediction);
 
 void av1_apply_encoding_flags(AV1_COMP *cpi, aom_enc_frame_flags_t flags);
@@ -13,6 +13,7 @@
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/ethread.h"
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/aom_timer.h"
 
 static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
   for (int i = 0; i < REFERENCE_MODES; i++)
@@ -30,104 +31,125 @@ static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
 static int enc_worker_hook(EncWorkerData *const thread_data, void *unused) {
   AV1_COMP *const cpi = thread_data->cpi;
   const AV1_COMMON *const cm = &cpi->common;
+  AV1TileJobQueue *const queue = &cpi->tile_job_queue;
   const int tile_cols = cm->tile_cols;
   const int tile_rows = cm->tile_rows;
-  int t;
 
   (void)unused;
 
-  for (t = thread_data->start; t < tile_rows * tile_cols;
-       t += cpi->num_workers) {
-    int tile_row = t / tile_cols;
-    int tile_col = t % tile_cols;
-
-    av1_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+  for (;;) {
+    struct aom_usec_timer timer;
+    int job, tile_col, tile_row;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(queue->job_mutex);
+#endif
+    job = queue->next_job++;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(queue->job_mutex);
+#endif
+    if (job >= tile_cols) break;
+
+    tile_col = queue->job_order[job];
+    aom_usec_timer_start(&timer);
+    for (tile_row = 0; tile_row < tile_rows; ++tile_row)
+      av1_encode_tile(cpi, thread_data->td, tile_row, tile_col);
+    aom_usec_timer_mark(&timer);
+    queue->col_time[tile_col] = aom_usec_timer_elapsed(&timer);
   }
 
   return 0;
 }
 
-void av1_encode_tiles_mt(AV1_COMP *cpi) {
+void av1_create_workers(AV1_COMP *cpi, int num_workers) {
   AV1_COMMON *const cm = &cpi->common;
-  const int tile_cols = cm->tile_cols;
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
-  const int num_workers = AOMMIN(cpi->oxcf.max_threads, tile_cols);
   int i;
 
-  av1_init_tile_data(cpi);
-
   // Only run once to create threads and allocate thread data.
-  if (cpi->num_workers == 0) {
-    CHECK_MEM_ERROR(cm, cpi->workers,
-                    aom_malloc(num_workers * sizeof(*cpi->workers)));
-
-    CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
-                    aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
-
-    for (i = 0; i < num_workers; i++) {
-      AVxWorker *const worker = &cpi->workers[i];
-      EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
-
-      ++cpi->num_workers;
-      winterface->init(worker);
-
-      thread_data->cpi = cpi;
-
-      if (i < num_workers - 1) {
-        // Allocate thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td,
-                        aom_memalign(32, sizeof(*thread_data->td)));
-        av1_zero(*thread_data->td);
-
-        // Set up pc_tree.
-        thread_data->td->pc_tree = NULL;
-        av1_setup_pc_tree(cm, thread_data->td);
-
-        CHECK_MEM_ERROR(cm, thread_data->td->above_pred_buf,
-                        (uint8_t *)aom_memalign(
-                            16, MAX_MB_PLANE * MAX_SB_SQUARE *
-                                    sizeof(*thread_data->td->above_pred_buf)));
-        CHECK_MEM_ERROR(cm, thread_data->td->left_pred_buf,
-                        (uint8_t *)aom_memalign(
-                            16, MAX_MB_PLANE * MAX_SB_SQUARE *
-                                    sizeof(*thread_data->td->left_pred_buf)));
-
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->wsrc_buf,
-            (int32_t *)aom_memalign(
-                16, MAX_SB_SQUARE * sizeof(*thread_data->td->wsrc_buf)));
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->mask_buf,
-            (int32_t *)aom_memalign(
-                16, MAX_SB_SQUARE * sizeof(*thread_data->td->mask_buf)));
-        // Allocate frame counters in thread data.
-        CHECK_MEM_ERROR(cm, thread_data->td->counts,
-                        aom_calloc(1, sizeof(*thread_data->td->counts)));
-
-        // Allocate buffers used by palette coding mode.
-        CHECK_MEM_ERROR(
-            cm, thread_data->td->palette_buffer,
-            aom_memalign(16, sizeof(*thread_data->td->palette_buffer)));
-
-        // Create threads
-        if (!winterface->reset(worker))
-          aom_internal_error(&cm->error, AOM_CODEC_ERROR,
-                             "Tile encoder thread creation failed");
-      } else {
-        // Main thread acts as a worker and uses the thread data in cpi.
-        thread_data->td = &cpi->td;
-      }
+  if (cpi->num_workers != 0) return;
 
-      winterface->sync(worker);
+  CHECK_MEM_ERROR(cm, cpi->workers,
+                  aom_malloc(num_workers * sizeof(*cpi->workers)));
+
+  CHECK_MEM_ERROR(cm, cpi->tile_thr_data,
+                  aom_calloc(num_workers, sizeof(*cpi->tile_thr_data)));
+
+  for (i = 0; i < num_workers; i++) {
+    AVxWorker *const worker = &cpi->workers[i];
+    EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
+
+    ++cpi->num_workers;
+    winterface->init(worker);
+
+    thread_data->cpi = cpi;
+
+    if (i < num_workers - 1) {
+      // Allocate thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td,
+                      aom_memalign(32, sizeof(*thread_data->td)));
+      av1_zero(*thread_data->td);
+
+      // Set up pc_tree.
+      thread_data->td->pc_tree = NULL;
+      av1_setup_pc_tree(cm, thread_data->td);
+
+      CHECK_MEM_ERROR(cm, thread_data->td->above_pred_buf,
+                      (uint8_t *)aom_memalign(
+                          16, MAX_MB_PLANE * MAX_SB_SQUARE *
+                                  sizeof(*thread_data->td->above_pred_buf)));
+      CHECK_MEM_ERROR(cm, thread_data->td->left_pred_buf,
+                      (uint8_t *)aom_memalign(
+                          16, MAX_MB_PLANE * MAX_SB_SQUARE *
+                                  sizeof(*thread_data->td->left_pred_buf)));
+
+      CHECK_MEM_ERROR(
+          cm, thread_data->td->wsrc_buf,
+          (int32_t *)aom_memalign(
+              16, MAX_SB_SQUARE * sizeof(*thread_data->td->wsrc_buf)));
+      CHECK_MEM_ERROR(
+          cm, thread_data->td->mask_buf,
+          (int32_t *)aom_memalign(
+              16, MAX_SB_SQUARE * sizeof(*thread_data->td->mask_buf)));
+      // Allocate frame counters in thread data.
+      CHECK_MEM_ERROR(cm, thread_data->td->counts,
+                      aom_calloc(1, sizeof(*thread_data->td->counts)));
+
+      // Allocate buffers used by palette coding mode.
+      CHECK_MEM_ERROR(
+          cm, thread_data->td->palette_buffer,
+          aom_memalign(16, sizeof(*thread_data->td->palette_buffer)));
+
+      // Create threads
+      if (!winterface->reset(worker))
+        aom_internal_error(&cm->error, AOM_CODEC_ERROR,
+                           "Tile encoder thread creation failed");
+    } else {
+      // Main thread acts as a worker and uses the thread data in cpi.
+      thread_data->td = &cpi->td;
     }
+
+    winterface->sync(worker);
   }
+}
+
+// Maps the i-th of num_workers active workers onto the worker pool. The last
+// active worker is always the last one of the pool, which runs on the main
+// thread and uses cpi->td.
+static INLINE int get_worker_idx(const AV1_COMP *cpi, int i, int num_workers) {
+  return i < num_workers - 1 ? i : cpi->num_workers - 1;
+}
+
+static void prepare_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook,
+                                int num_workers) {
+  int i;
 
   for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
+    const int worker_idx = get_worker_idx(cpi, i, num_workers);
+    AVxWorker *const worker = &cpi->workers[worker_idx];
     EncWorkerData *thread_data;
 
-    worker->hook = (AVxWorkerHook)enc_worker_hook;
-    worker->data1 = &cpi->tile_thr_data[i];
+    worker->hook = hook;
+    worker->data1 = &cpi->tile_thr_data[worker_idx];
     worker->data2 = NULL;
     thread_data = (EncWorkerData *)worker->data1;
 
@@ -145,19 +167,25 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
              sizeof(cpi->common.counts));
     }
 
-    if (i < num_workers - 1)
+    if (thread_data->td != &cpi->td)
       thread_data->td->mb.palette_buffer = thread_data->td->palette_buffer;
   }
+}
+
+static void launch_enc_workers(AV1_COMP *cpi, int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
 
   // Encode a frame
   for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
+    AVxWorker *const worker =
+        &cpi->workers[get_worker_idx(cpi, i, num_workers)];
     EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
 
     // Set the starting tile for each thread.
     thread_data->start = i;
 
-    if (i == cpi->num_workers - 1)
+    if (i == num_workers - 1)
       winterface->execute(worker);
     else
       winterface->launch(worker);
@@ -165,19 +193,325 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
 
   // Encoding ends.
   for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
+    AVxWorker *const worker =
+        &cpi->workers[get_worker_idx(cpi, i, num_workers)];
     winterface->sync(worker);
   }
+}
+
+void av1_run_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook, void *data,
+                         int num_workers) {
+  int i;
+
+  assert(num_workers <= cpi->num_workers);
+  prepare_enc_workers(cpi, hook, num_workers);
+  for (i = 0; i < num_workers; i++)
+    cpi->workers[get_worker_idx(cpi, i, num_workers)].data2 = data;
+  launch_enc_workers(cpi, num_workers);
+}
+
+static void accumulate_counters_enc_workers(AV1_COMP *cpi, int num_workers) {
+  AV1_COMMON *const cm = &cpi->common;
+  int i;
 
   for (i = 0; i < num_workers; i++) {
-    AVxWorker *const worker = &cpi->workers[i];
+    AVxWorker *const worker =
+        &cpi->workers[get_worker_idx(cpi, i, num_workers)];
     EncWorkerData *const thread_data = (EncWorkerData *)worker->data1;
     cpi->intrabc_used |= thread_data->td->intrabc_used_this_tile;
     // Accumulate counters.
-    if (i < cpi->num_workers - 1) {
+    if (thread_data->td != &cpi->td) {
       av1_accumulate_frame_counts(&cm->counts, thread_data->td->counts);
       accumulate_rd_opt(&cpi->td, thread_data->td);
       cpi->td.mb.txb_split_count += thread_data->td->mb.txb_split_count;
     }
   }
 }
+
+// Orders the tile columns by decreasing encoding time in the last frame, so
+// that the longest columns are not left until the end. The timing is reset
+// when the tiling changes.
+static void setup_tile_job_queue(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1TileJobQueue *const queue = &cpi->tile_job_queue;
+  const int tile_cols = cm->tile_cols;
+  int i, j;
+
+#if CONFIG_MULTITHREAD
+  if (queue->job_mutex == NULL) {
+    CHECK_MEM_ERROR(cm, queue->job_mutex,
+                    aom_malloc(sizeof(*queue->job_mutex)));
+    pthread_mutex_init(queue->job_mutex, NULL);
+  }
+#endif
+  if (queue->tile_cols != tile_cols) {
+    memset(queue->col_time, 0, sizeof(queue->col_time));
+    queue->tile_cols = tile_cols;
+  }
+
+  for (i = 0; i < tile_cols; ++i) {
+    const int64_t time = queue->col_time[i];
+    for (j = i; j > 0 && queue->col_time[queue->job_order[j - 1]] < time; --j)
+      queue->job_order[j] = queue->job_order[j - 1];
+    queue->job_order[j] = i;
+  }
+  queue->next_job = 0;
+}
+
+void av1_tile_job_queue_dealloc(AV1TileJobQueue *queue) {
+#if CONFIG_MULTITHREAD
+  if (queue->job_mutex != NULL) {
+    pthread_mutex_destroy(queue->job_mutex);
+    aom_free(queue->job_mutex);
+    queue->job_mutex = NULL;
+  }
+#else
+  (void)queue;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_encode_tiles_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = cm->tile_cols;
+  int num_workers;
+
+  av1_init_tile_data(cpi);
+
+  av1_create_workers(cpi, cpi->oxcf.max_threads);
+  num_workers = AOMMIN(cpi->num_workers, tile_cols);
+  setup_tile_job_queue(cpi);
+
+  prepare_enc_workers(cpi, (AVxWorkerHook)enc_worker_hook, num_workers);
+  launch_enc_workers(cpi, num_workers);
+  accumulate_counters_enc_workers(cpi, num_workers);
+}
+
+void av1_row_mt_sync_read(AV1RowMTSync *row_mt_sync, int tile_col, int sb_row,
+                          int num_cols) {
+#if CONFIG_MULTITHREAD
+  const int idx = tile_col * row_mt_sync->sb_rows + sb_row - 1;
+  pthread_mutex_t *const mutex = &row_mt_sync->mutex_[idx];
+
+  pthread_mutex_lock(mutex);
+  while (row_mt_sync->num_finished_cols[idx] < num_cols)
+    pthread_cond_wait(&row_mt_sync->cond_[idx], mutex);
+  pthread_mutex_unlock(mutex);
+#else
+  // The rows are encoded in order.
+  (void)row_mt_sync;
+  (void)tile_col;
+  (void)sb_row;
+  (void)num_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+void av1_row_mt_sync_write(AV1RowMTSync *row_mt_sync, int tile_col,
+                           int sb_row, int num_cols) {
+  const int idx = tile_col * row_mt_sync->sb_rows + sb_row;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&row_mt_sync->mutex_[idx]);
+  row_mt_sync->num_finished_cols[idx] = num_cols;
+  pthread_cond_signal(&row_mt_sync->cond_[idx]);
+  pthread_mutex_unlock(&row_mt_sync->mutex_[idx]);
+#else
+  row_mt_sync->num_finished_cols[idx] = num_cols;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static void row_mt_sync_alloc(AV1RowMTSync *row_mt_sync, AV1_COMMON *cm,
+                              int sb_rows, int tile_cols, int num_workers) {
+  const int rows = sb_rows * tile_cols;
+
+  row_mt_sync->sb_rows = sb_rows;
+  row_mt_sync->tile_cols = tile_cols;
+  row_mt_sync->num_workers = num_workers;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->mutex_,
+                    aom_malloc(sizeof(*row_mt_sync->mutex_) * rows));
+    for (i = 0; i < rows; ++i) pthread_mutex_init(&row_mt_sync->mutex_[i], NULL);
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->cond_,
+                    aom_malloc(sizeof(*row_mt_sync->cond_) * rows));
+    for (i = 0; i < rows; ++i) pthread_cond_init(&row_mt_sync->cond_[i], NULL);
+
+    CHECK_MEM_ERROR(cm, row_mt_sync->job_mutex,
+                    aom_malloc(sizeof(*row_mt_sync->job_mutex)));
+    pthread_mutex_init(row_mt_sync->job_mutex, NULL);
+  }
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, row_mt_sync->num_finished_cols,
+                  aom_malloc(sizeof(*row_mt_sync->num_finished_cols) * rows));
+  CHECK_MEM_ERROR(cm, row_mt_sync->tok_count,
+                  aom_malloc(sizeof(*row_mt_sync->tok_count) * rows));
+  CHECK_MEM_ERROR(
+      cm, row_mt_sync->row_state,
+      aom_memalign(32, sizeof(*row_mt_sync->row_state) * 2 * tile_cols));
+  CHECK_MEM_ERROR(
+      cm, row_mt_sync->worker_state,
+      aom_memalign(32, sizeof(*row_mt_sync->worker_state) * num_workers));
+}
+
+void av1_row_mt_sync_dealloc(AV1RowMTSync *row_mt_sync) {
+  if (row_mt_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    const int rows = row_mt_sync->sb_rows * row_mt_sync->tile_cols;
+    int i;
+
+    if (row_mt_sync->mutex_ != NULL) {
+      for (i = 0; i < rows; ++i) pthread_mutex_destroy(&row_mt_sync->mutex_[i]);
+      aom_free(row_mt_sync->mutex_);
+    }
+    if (row_mt_sync->cond_ != NULL) {
+      for (i = 0; i < rows; ++i) pthread_cond_destroy(&row_mt_sync->cond_[i]);
+      aom_free(row_mt_sync->cond_);
+    }
+    if (row_mt_sync->job_mutex != NULL) {
+      pthread_mutex_destroy(row_mt_sync->job_mutex);
+      aom_free(row_mt_sync->job_mutex);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(row_mt_sync->num_finished_cols);
+    aom_free(row_mt_sync->tok_count);
+    aom_free(row_mt_sync->row_state);
+    aom_free(row_mt_sync->worker_state);
+
+    // clear the structure as the source of this call may be a resize in
+    // which case this call will be followed by an _alloc() which may fail.
+    av1_zero(*row_mt_sync);
+  }
+}
+
+void av1_row_mt_sync_prepare(AV1_COMP *cpi, int sb_rows, int tile_cols,
+                             int num_workers) {
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+
+  if (row_mt_sync->sb_rows != sb_rows || row_mt_sync->tile_cols != tile_cols ||
+      row_mt_sync->num_workers < num_workers) {
+    av1_row_mt_sync_dealloc(row_mt_sync);
+    row_mt_sync_alloc(row_mt_sync, &cpi->common, sb_rows, tile_cols,
+                      num_workers);
+  }
+  memset(row_mt_sync->num_finished_cols, 0,
+         sizeof(*row_mt_sync->num_finished_cols) * sb_rows * tile_cols);
+  row_mt_sync->next_job = 0;
+}
+
+static int enc_row_mt_worker_hook(EncWorkerData *const thread_data,
+                                  void *unused) {
+  AV1_COMP *const cpi = thread_data->cpi;
+  const AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  const int tile_cols = cm->tile_cols;
+  const int num_jobs = row_mt_sync->sb_rows * tile_cols;
+  TileDataEnc *const row_data = &row_mt_sync->worker_state[thread_data->start];
+
+  (void)unused;
+
+  thread_data->td->intrabc_used_this_tile = 0;
+
+  // The jobs are handed out in raster order of the superblock rows, so a row
+  // is always started after the row it depends on.
+  for (;;) {
+    int job;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(row_mt_sync->job_mutex);
+#endif
+    job = row_mt_sync->next_job++;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(row_mt_sync->job_mutex);
+#endif
+    if (job >= num_jobs) break;
+
+    {
+      const int sb_row = job / tile_cols;
+      const int tile_col = job % tile_cols;
+      const int mi_row = sb_row << cm->seq_params.mib_size_log2;
+      int tile_row = 0;
+      while (cm->tile_row_start_sb[tile_row + 1] <= sb_row) ++tile_row;
+      TileDataEnc *const this_tile =
+          &cpi->tile_data[tile_row * tile_cols + tile_col];
+      const TileInfo *const tile_info = &this_tile->tile_info;
+
+      if (mi_row == tile_info->mi_row_start) {
+        *row_data = *this_tile;
+        row_data->tctx = *cm->fc;
+        row_data->m_search_count = 0;
+        row_data->ex_search_count = 0;
+      } else {
+        const int sb_cols_in_tile = cm->tile_col_start_sb[tile_col + 1] -
+                                    cm->tile_col_start_sb[tile_col];
+        av1_row_mt_sync_read(row_mt_sync, tile_col, sb_row,
+                             AOMMIN(2, sb_cols_in_tile));
+        *row_data = row_mt_sync->row_state[tile_col * 2 + ((sb_row - 1) & 1)];
+      }
+
+      av1_encode_sb_row(cpi, thread_data->td, row_data, tile_row, tile_col,
+                        mi_row);
+
+      // The mode thresholds reached by the last row of the tile are carried
+      // over to the next frame.
+      if (mi_row + cm->seq_params.mib_size >= tile_info->mi_row_end) {
+        memcpy(this_tile->thresh_freq_fact, row_data->thresh_freq_fact,
+               sizeof(this_tile->thresh_freq_fact));
+        memcpy(this_tile->mode_map, row_data->mode_map,
+               sizeof(this_tile->mode_map));
+      }
+    }
+  }
+
+  return 1;
+}
+
+void av1_encode_tiles_row_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTSync *const row_mt_sync = &cpi->row_mt_sync;
+  const int num_planes = av1_num_planes(cm);
+  const int tile_cols = cm->tile_cols;
+  const int tile_rows = cm->tile_rows;
+  const int sb_rows = cm->tile_row_start_sb[tile_rows];
+  int num_workers;
+  int tile_row, tile_col;
+
+  av1_init_tile_data(cpi);
+
+  av1_create_workers(cpi, cpi->oxcf.max_threads);
+  num_workers = AOMMIN(cpi->num_workers, sb_rows * tile_cols);
+  av1_row_mt_sync_prepare(cpi, sb_rows, tile_cols, num_workers);
+
+  prepare_enc_workers(cpi, (AVxWorkerHook)enc_row_mt_worker_hook,
+                      num_workers);
+  launch_enc_workers(cpi, num_workers);
+  accumulate_counters_enc_workers(cpi, num_workers);
+
+  // Each superblock row wrote its tokens to its own part of the tile token
+  // buffer. Move them together for the bitstream packing.
+  for (tile_row = 0; tile_row < tile_rows; ++tile_row) {
+    for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
+      const TileInfo *const tile_info =
+          &cpi->tile_data[tile_row * tile_cols + tile_col].tile_info;
+      const int row_tokens = allocated_sb_row_tokens(
+          *tile_info, cm->seq_params.mib_size_log2 + MI_SIZE_LOG2, num_planes);
+      TOKENEXTRA *const tile_tok = cpi->tile_tok[tile_row][tile_col];
+      TOKENEXTRA *tok = tile_tok;
+      int sb_row;
+
+      for (sb_row = cm->tile_row_start_sb[tile_row];
+           sb_row < cm->tile_row_start_sb[tile_row + 1]; ++sb_row) {
+        const int sb_row_in_tile = sb_row - cm->tile_row_start_sb[tile_row];
+        const unsigned int count =
+            row_mt_sync->tok_count[tile_col * sb_rows + sb_row];
+        memmove(tok, tile_tok + sb_row_in_tile * row_tokens,
+                count * sizeof(*tok));
+        tok += count;
+      }
+      cpi->tok_count[tile_row][tile_col] = (unsigned int)(tok - tile_tok);
+      assert(cpi->tok_count[tile_row][tile_col] <=
+             allocated_tokens(*tile_info,
+                              cm->seq_params.mib_size_log2 + MI_SIZE_LOG2,
+                              num_planes));
+    }
+  }
+}
@@ -12,12 +12,16 @@
 #ifndef AV1_ENCODER_ETHREAD_H_
 #define AV1_ENCODER_ETHREAD_H_
 
+#include "aom_util/aom_thread.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct AV1_COMP;
 struct ThreadData;
+struct AV1RowMTSync;
+struct AV1TileJobQueue;
 
 typedef struct EncWorkerData {
   struct AV1_COMP *cpi;
@@ -25,7 +29,39 @@ typedef struct EncWorkerData {
   int start;
 } EncWorkerData;
 
+// Encodes the tile columns in parallel. The workers take the columns from a
+// shared queue, the most expensive ones of the previous frame first.
 void av1_encode_tiles_mt(struct AV1_COMP *cpi);
+void av1_tile_job_queue_dealloc(struct AV1TileJobQueue *queue);
+
+// Encodes the tiles with their superblock rows spread over the workers, in a
+// wavefront. The result does not depend on the number of workers.
+void av1_encode_tiles_row_mt(struct AV1_COMP *cpi);
+
+// Waits until superblock row sb_row - 1 of tile column tile_col has encoded
+// num_cols superblocks.
+void av1_row_mt_sync_read(struct AV1RowMTSync *row_mt_sync, int tile_col,
+                          int sb_row, int num_cols);
+// Records that superblock row sb_row of tile column tile_col has encoded
+// num_cols superblocks.
+void av1_row_mt_sync_write(struct AV1RowMTSync *row_mt_sync, int tile_col,
+                           int sb_row, int num_cols);
+void av1_row_mt_sync_dealloc(struct AV1RowMTSync *row_mt_sync);
+// Sets up cpi->row_mt_sync for sb_rows rows in each of tile_cols columns and
+// num_workers workers, with no row started and the job counter at 0.
+void av1_row_mt_sync_prepare(struct AV1_COMP *cpi, int sb_rows, int tile_cols,
+                             int num_workers);
+
+// Create the encoder worker pool (if not done yet). The last worker runs on
+// the calling thread and uses cpi->td.
+void av1_create_workers(struct AV1_COMP *cpi, int num_workers);
+
+// Runs hook(thread_data, data) on num_workers workers of the pool and waits
+// for them. thread_data->start is the index of the worker, from 0 to
+// num_workers - 1, and thread_data->td is set up from cpi->td as for encoding
+// a frame.
+void av1_run_enc_workers(struct AV1_COMP *cpi, AVxWorkerHook hook, void *data,
+                         int num_workers);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -1,4 +1,9 @@
 #include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 #include "av1/encoder/hash.h"
 #include "av1/encoder/hash_motion.h"
 #include "./av1_rtcd.h"
@@ -9,25 +14,12 @@ static CRC_CALCULATOR crc_calculator1;
 static CRC_CALCULATOR crc_calculator2;
 static int g_crc_initialized = 0;
 
-static void hash_table_clear_all(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table == NULL) {
-    return;
-  }
-  int max_addr = 1 << (crc_bits + block_size_bits);
-  for (int i = 0; i < max_addr; i++) {
-    if (p_hash_table->p_lookup_table[i] != NULL) {
-      aom_vector_destroy(p_hash_table->p_lookup_table[i]);
-      aom_free(p_hash_table->p_lookup_table[i]);
-      p_hash_table->p_lookup_table[i] = NULL;
-    }
-  }
-}
-
 // TODO(youzhou@microsoft.com): is higher than 8 bits screen content supported?
 // If yes, fix this function
-static void get_pixels_in_1D_char_array_by_block_2x2(uint8_t *y_src, int stride,
+static void get_pixels_in_1D_char_array_by_block_2x2(const uint8_t *y_src,
+                                                     int stride,
                                                      uint8_t *p_pixels_in1D) {
-  uint8_t *p_pel = y_src;
+  const uint8_t *p_pel = y_src;
   int index = 0;
   for (int i = 0; i < 2; i++) {
     for (int j = 0; j < 2; j++) {
@@ -37,10 +29,10 @@ static void get_pixels_in_1D_char_array_by_block_2x2(uint8_t *y_src, int stride,
   }
 }
 
-static void get_pixels_in_1D_short_array_by_block_2x2(uint16_t *y_src,
+static void get_pixels_in_1D_short_array_by_block_2x2(const uint16_t *y_src,
                                                       int stride,
                                                       uint16_t *p_pixels_in1D) {
-  uint16_t *p_pel = y_src;
+  const uint16_t *p_pel = y_src;
   int index = 0;
   for (int i = 0; i < 2; i++) {
     for (int j = 0; j < 2; j++) {
@@ -99,198 +91,228 @@ void av1_hash_table_init(hash_table *p_hash_table) {
     av1_crc_calculator_init(&crc_calculator2, 24, 0x864CFB);
     g_crc_initialized = 1;
   }
-  p_hash_table->p_lookup_table = NULL;
+  p_hash_table->p_bucket_start = NULL;
+  p_hash_table->p_bucket_count = NULL;
+  p_hash_table->p_entries = NULL;
+  p_hash_table->num_entries = 0;
+  p_hash_table->max_entries = 0;
 }
 
 void av1_hash_table_destroy(hash_table *p_hash_table) {
-  hash_table_clear_all(p_hash_table);
-  aom_free(p_hash_table->p_lookup_table);
-  p_hash_table->p_lookup_table = NULL;
+  aom_free(p_hash_table->p_bucket_start);
+  aom_free(p_hash_table->p_bucket_count);
+  aom_free(p_hash_table->p_entries);
+  av1_hash_table_init(p_hash_table);
 }
 
-void av1_hash_table_create(hash_table *p_hash_table) {
-  if (p_hash_table->p_lookup_table != NULL) {
-    hash_table_clear_all(p_hash_table);
-    return;
-  }
+int av1_hash_table_create(hash_table *p_hash_table) {
   const int max_addr = 1 << (crc_bits + block_size_bits);
-  p_hash_table->p_lookup_table =
-      (Vector **)aom_malloc(sizeof(p_hash_table->p_lookup_table[0]) * max_addr);
-  memset(p_hash_table->p_lookup_table, 0,
-         sizeof(p_hash_table->p_lookup_table[0]) * max_addr);
+  if (p_hash_table->p_bucket_count == NULL) {
+    p_hash_table->p_bucket_start = (uint32_t *)aom_malloc(
+        sizeof(p_hash_table->p_bucket_start[0]) * max_addr);
+    p_hash_table->p_bucket_count = (uint32_t *)aom_malloc(
+        sizeof(p_hash_table->p_bucket_count[0]) * max_addr);
+    if (p_hash_table->p_bucket_start == NULL ||
+        p_hash_table->p_bucket_count == NULL) {
+      av1_hash_table_destroy(p_hash_table);
+      return 0;
+    }
+  }
+  // The entry array is kept, so that later frames reuse its allocation.
+  memset(p_hash_table->p_bucket_count, 0,
+         sizeof(p_hash_table->p_bucket_count[0]) * max_addr);
+  p_hash_table->num_entries = 0;
+  return 1;
 }
 
-static void hash_table_add_to_table(hash_table *p_hash_table,
-                                    uint32_t hash_value,
-                                    block_hash *curr_block_hash) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    p_hash_table->p_lookup_table[hash_value] =
-        aom_malloc(sizeof(p_hash_table->p_lookup_table[0][0]));
-    aom_vector_setup(p_hash_table->p_lookup_table[hash_value], 10,
-                     sizeof(curr_block_hash[0]));
-    aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                         curr_block_hash);
-  } else {
-    aom_vector_push_back(p_hash_table->p_lookup_table[hash_value],
-                         curr_block_hash);
+static int hash_table_reserve(hash_table *p_hash_table, int num_entries) {
+  if (num_entries <= p_hash_table->max_entries) return 1;
+  // Grow geometrically, as the block sizes of a frame are added one by one.
+  const int max_entries = AOMMAX(
+      num_entries, p_hash_table->max_entries + p_hash_table->max_entries / 2);
+  block_hash *entries =
+      (block_hash *)aom_malloc(sizeof(*entries) * max_entries);
+  if (entries == NULL) return 0;
+  if (p_hash_table->num_entries > 0) {
+    memcpy(entries, p_hash_table->p_entries,
+           sizeof(*entries) * p_hash_table->num_entries);
   }
+  aom_free(p_hash_table->p_entries);
+  p_hash_table->p_entries = entries;
+  p_hash_table->max_entries = max_entries;
+  return 1;
 }
 
-int32_t av1_hash_table_count(hash_table *p_hash_table, uint32_t hash_value) {
-  if (p_hash_table->p_lookup_table[hash_value] == NULL) {
-    return 0;
-  } else {
-    return (int32_t)(p_hash_table->p_lookup_table[hash_value]->size);
-  }
+int32_t av1_hash_table_count(const hash_table *p_hash_table,
+                             uint32_t hash_value) {
+  return (int32_t)p_hash_table->p_bucket_count[hash_value];
 }
 
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value) {
+const block_hash *av1_hash_get_first_entry(const hash_table *p_hash_table,
+                                           uint32_t hash_value) {
   assert(av1_hash_table_count(p_hash_table, hash_value) > 0);
-  return aom_vector_begin(p_hash_table->p_lookup_table[hash_value]);
+  return &p_hash_table->p_entries[p_hash_table->p_bucket_start[hash_value]];
 }
 
-int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
-                            uint32_t hash_value2) {
-  if (p_hash_table->p_lookup_table[hash_value1] == NULL) {
+int32_t av1_has_exact_match(const hash_table *p_hash_table,
+                            uint32_t hash_value1, uint32_t hash_value2) {
+  const int32_t count = av1_hash_table_count(p_hash_table, hash_value1);
+  if (count == 0) {
     return 0;
   }
-  Iterator iterator =
-      aom_vector_begin(p_hash_table->p_lookup_table[hash_value1]);
-  Iterator last = aom_vector_end(p_hash_table->p_lookup_table[hash_value1]);
-  for (; !iterator_equals(&iterator, &last); iterator_increment(&iterator)) {
-    if ((*(block_hash *)iterator_get(&iterator)).hash_value2 == hash_value2) {
+  const block_hash *entry = av1_hash_get_first_entry(p_hash_table, hash_value1);
+  for (int32_t i = 0; i < count; i++) {
+    if (entry[i].hash_value2 == hash_value2) {
       return 1;
     }
   }
   return 0;
 }
 
-void av1_generate_block_2x2_hash_value(const YV12_BUFFER_CONFIG *picture,
-                                       uint32_t *pic_block_hash[2],
-                                       int8_t *pic_block_same_info[3]) {
-  const int width = 2;
-  const int height = 2;
-  const int x_end = picture->y_crop_width - width + 1;
-  const int y_end = picture->y_crop_height - height + 1;
-
-  const int length = width * 2;
-  if (picture->flags & YV12_FLAG_HIGHBITDEPTH) {
+void av1_generate_block_2x2_hash_row_c(const uint8_t *src, int stride,
+                                       int width, int use_highbitdepth,
+                                       uint32_t *hash1, uint32_t *hash2,
+                                       int8_t *row_same, int8_t *col_same) {
+  if (use_highbitdepth) {
     uint16_t p[4];
-    int pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
-        get_pixels_in_1D_short_array_by_block_2x2(
-            CONVERT_TO_SHORTPTR(picture->y_buffer) + y_pos * picture->y_stride +
-                x_pos,
-            picture->y_stride, p);
-        pic_block_same_info[0][pos] = is_block16_2x2_row_same_value(p);
-        pic_block_same_info[1][pos] = is_block16_2x2_col_same_value(p);
-
-        pic_block_hash[0][pos] = av1_get_crc_value(
-            &crc_calculator1, (uint8_t *)p, length * sizeof(p[0]));
-        pic_block_hash[1][pos] = av1_get_crc_value(
-            &crc_calculator2, (uint8_t *)p, length * sizeof(p[0]));
-        pos++;
-      }
-      pos += width - 1;
+    const int length = sizeof(p);
+    for (int x_pos = 0; x_pos < width; x_pos++) {
+      get_pixels_in_1D_short_array_by_block_2x2(
+          CONVERT_TO_SHORTPTR(src) + x_pos, stride, p);
+      row_same[x_pos] = is_block16_2x2_row_same_value(p);
+      col_same[x_pos] = is_block16_2x2_col_same_value(p);
+      hash1[x_pos] =
+          av1_get_crc_value_c(&crc_calculator1, (uint8_t *)p, length);
+      hash2[x_pos] =
+          av1_get_crc_value_c(&crc_calculator2, (uint8_t *)p, length);
     }
   } else {
     uint8_t p[4];
-    int pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
-        get_pixels_in_1D_char_array_by_block_2x2(
-            picture->y_buffer + y_pos * picture->y_stride + x_pos,
-            picture->y_stride, p);
-        pic_block_same_info[0][pos] = is_block_2x2_row_same_value(p);
-        pic_block_same_info[1][pos] = is_block_2x2_col_same_value(p);
-
-        pic_block_hash[0][pos] =
-            av1_get_crc_value(&crc_calculator1, p, length * sizeof(p[0]));
-        pic_block_hash[1][pos] =
-            av1_get_crc_value(&crc_calculator2, p, length * sizeof(p[0]));
-        pos++;
-      }
-      pos += width - 1;
+    const int length = sizeof(p);
+    for (int x_pos = 0; x_pos < width; x_pos++) {
+      get_pixels_in_1D_char_array_by_block_2x2(src + x_pos, stride, p);
+      row_same[x_pos] = is_block_2x2_row_same_value(p);
+      col_same[x_pos] = is_block_2x2_col_same_value(p);
+      hash1[x_pos] = av1_get_crc_value_c(&crc_calculator1, p, length);
+      hash2[x_pos] = av1_get_crc_value_c(&crc_calculator2, p, length);
     }
   }
 }
 
-void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
-                                   int block_size,
-                                   uint32_t *src_pic_block_hash[2],
-                                   uint32_t *dst_pic_block_hash[2],
+void av1_generate_block_hash_row_c(uint32_t *src_pic_block_hash[2],
                                    int8_t *src_pic_block_same_info[3],
-                                   int8_t *dst_pic_block_same_info[3]) {
-  const int pic_width = picture->y_crop_width;
-  const int x_end = picture->y_crop_width - block_size + 1;
-  const int y_end = picture->y_crop_height - block_size + 1;
-
+                                   uint32_t *dst_pic_block_hash[2],
+                                   int8_t *dst_pic_block_same_info[3],
+                                   int pic_width, int width, int block_size,
+                                   int y_pos) {
   const int src_size = block_size >> 1;
   const int quad_size = block_size >> 2;
+  const int size_minus1 = block_size - 1;
 
   uint32_t p[4];
   const int length = sizeof(p);
 
-  int pos = 0;
-  for (int y_pos = 0; y_pos < y_end; y_pos++) {
-    for (int x_pos = 0; x_pos < x_end; x_pos++) {
-      p[0] = src_pic_block_hash[0][pos];
-      p[1] = src_pic_block_hash[0][pos + src_size];
-      p[2] = src_pic_block_hash[0][pos + src_size * pic_width];
-      p[3] = src_pic_block_hash[0][pos + src_size * pic_width + src_size];
-      dst_pic_block_hash[0][pos] =
-          av1_get_crc_value(&crc_calculator1, (uint8_t *)p, length);
-
-      p[0] = src_pic_block_hash[1][pos];
-      p[1] = src_pic_block_hash[1][pos + src_size];
-      p[2] = src_pic_block_hash[1][pos + src_size * pic_width];
-      p[3] = src_pic_block_hash[1][pos + src_size * pic_width + src_size];
-      dst_pic_block_hash[1][pos] =
-          av1_get_crc_value(&crc_calculator2, (uint8_t *)p, length);
-
-      dst_pic_block_same_info[0][pos] =
-          src_pic_block_same_info[0][pos] &&
-          src_pic_block_same_info[0][pos + quad_size] &&
-          src_pic_block_same_info[0][pos + src_size] &&
-          src_pic_block_same_info[0][pos + src_size * pic_width] &&
-          src_pic_block_same_info[0][pos + src_size * pic_width + quad_size] &&
-          src_pic_block_same_info[0][pos + src_size * pic_width + src_size];
-
-      dst_pic_block_same_info[1][pos] =
-          src_pic_block_same_info[1][pos] &&
-          src_pic_block_same_info[1][pos + src_size] &&
-          src_pic_block_same_info[1][pos + quad_size * pic_width] &&
-          src_pic_block_same_info[1][pos + quad_size * pic_width + src_size] &&
-          src_pic_block_same_info[1][pos + src_size * pic_width] &&
-          src_pic_block_same_info[1][pos + src_size * pic_width + src_size];
-      pos++;
-    }
-    pos += block_size - 1;
+  for (int x_pos = 0; x_pos < width; x_pos++) {
+    const int pos = y_pos * pic_width + x_pos;
+    p[0] = src_pic_block_hash[0][pos];
+    p[1] = src_pic_block_hash[0][pos + src_size];
+    p[2] = src_pic_block_hash[0][pos + src_size * pic_width];
+    p[3] = src_pic_block_hash[0][pos + src_size * pic_width + src_size];
+    dst_pic_block_hash[0][pos] =
+        av1_get_crc_value_c(&crc_calculator1, (uint8_t *)p, length);
+
+    p[0] = src_pic_block_hash[1][pos];
+    p[1] = src_pic_block_hash[1][pos + src_size];
+    p[2] = src_pic_block_hash[1][pos + src_size * pic_width];
+    p[3] = src_pic_block_hash[1][pos + src_size * pic_width + src_size];
+    dst_pic_block_hash[1][pos] =
+        av1_get_crc_value_c(&crc_calculator2, (uint8_t *)p, length);
+
+    dst_pic_block_same_info[0][pos] =
+        src_pic_block_same_info[0][pos] &&
+        src_pic_block_same_info[0][pos + quad_size] &&
+        src_pic_block_same_info[0][pos + src_size] &&
+        src_pic_block_same_info[0][pos + src_size * pic_width] &&
+        src_pic_block_same_info[0][pos + src_size * pic_width + quad_size] &&
+        src_pic_block_same_info[0][pos + src_size * pic_width + src_size];
+
+    dst_pic_block_same_info[1][pos] =
+        src_pic_block_same_info[1][pos] &&
+        src_pic_block_same_info[1][pos + src_size] &&
+        src_pic_block_same_info[1][pos + quad_size * pic_width] &&
+        src_pic_block_same_info[1][pos + quad_size * pic_width + src_size] &&
+        src_pic_block_same_info[1][pos + src_size * pic_width] &&
+        src_pic_block_same_info[1][pos + src_size * pic_width + src_size];
+
+    dst_pic_block_same_info[2][pos] =
+        (!dst_pic_block_same_info[0][pos] &&
+         !dst_pic_block_same_info[1][pos]) ||
+        (((x_pos & size_minus1) == 0) && ((y_pos & size_minus1) == 0));
   }
+}
 
-  if (block_size >= 4) {
-    const int size_minus1 = block_size - 1;
-    pos = 0;
-    for (int y_pos = 0; y_pos < y_end; y_pos++) {
-      for (int x_pos = 0; x_pos < x_end; x_pos++) {
-        dst_pic_block_same_info[2][pos] =
-            (!dst_pic_block_same_info[0][pos] &&
-             !dst_pic_block_same_info[1][pos]) ||
-            (((x_pos & size_minus1) == 0) && ((y_pos & size_minus1) == 0));
-        pos++;
-      }
-      pos += block_size - 1;
-    }
+void av1_generate_block_2x2_hash_rows(const YV12_BUFFER_CONFIG *picture,
+                                      uint32_t *pic_block_hash[2],
+                                      int8_t *pic_block_same_info[3],
+                                      int y_start, int y_end) {
+  const int pic_width = picture->y_crop_width;
+  const int width = pic_width - 2 + 1;
+  const int use_highbitdepth = (picture->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
+  const int stride = picture->y_stride;
+
+  for (int y_pos = y_start; y_pos < y_end; y_pos++) {
+    const int pos = y_pos * pic_width;
+    av1_generate_block_2x2_hash_row(picture->y_buffer + y_pos * stride, stride,
+                                    width, use_highbitdepth,
+                                    pic_block_hash[0] + pos,
+                                    pic_block_hash[1] + pos,
+                                    pic_block_same_info[0] + pos,
+                                    pic_block_same_info[1] + pos);
   }
 }
 
-void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
-                                                 uint32_t *pic_hash[2],
-                                                 int8_t *pic_is_same,
-                                                 int pic_width, int pic_height,
-                                                 int block_size) {
+void av1_generate_block_hash_rows(const YV12_BUFFER_CONFIG *picture,
+                                  int block_size,
+                                  uint32_t *src_pic_block_hash[2],
+                                  uint32_t *dst_pic_block_hash[2],
+                                  int8_t *src_pic_block_same_info[3],
+                                  int8_t *dst_pic_block_same_info[3],
+                                  int y_start, int y_end) {
+  const int pic_width = picture->y_crop_width;
+  const int width = pic_width - block_size + 1;
+  assert(block_size >= 4);
+
+  for (int y_pos = y_start; y_pos < y_end; y_pos++) {
+    av1_generate_block_hash_row(src_pic_block_hash, src_pic_block_same_info,
+                                dst_pic_block_hash, dst_pic_block_same_info,
+                                pic_width, width, block_size, y_pos);
+  }
+}
+
+void av1_generate_block_2x2_hash_value(const YV12_BUFFER_CONFIG *picture,
+                                       uint32_t *pic_block_hash[2],
+                                       int8_t *pic_block_same_info[3]) {
+  av1_generate_block_2x2_hash_rows(picture, pic_block_hash, pic_block_same_info,
+                                   0, picture->y_crop_height - 2 + 1);
+}
+
+void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
+                                   int block_size,
+                                   uint32_t *src_pic_block_hash[2],
+                                   uint32_t *dst_pic_block_hash[2],
+                                   int8_t *src_pic_block_same_info[3],
+                                   int8_t *dst_pic_block_same_info[3]) {
+  av1_generate_block_hash_rows(picture, block_size, src_pic_block_hash,
+                               dst_pic_block_hash, src_pic_block_same_info,
+                               dst_pic_block_same_info, 0,
+                               picture->y_crop_height - block_size + 1);
+}
+
+int av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
+                                                uint32_t *pic_hash[2],
+                                                int8_t *pic_is_same,
+                                                int pic_width, int pic_height,
+                                                int block_size) {
   const int x_end = pic_width - block_size + 1;
   const int y_end = pic_height - block_size + 1;
 
@@ -301,23 +323,56 @@ void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
   assert(add_value >= 0);
   add_value <<= crc_bits;
   const int crc_mask = (1 << crc_bits) - 1;
+  uint32_t *const bucket_start = p_hash_table->p_bucket_start + add_value;
+  uint32_t *const bucket_count = p_hash_table->p_bucket_count + add_value;
+
+  // count the blocks of each bucket
+  int num_added = 0;
+  for (int y_pos = 0; y_pos < y_end; y_pos++) {
+    const int row = y_pos * pic_width;
+    for (int x_pos = 0; x_pos < x_end; x_pos++) {
+      if (src_is_added[row + x_pos]) {
+        bucket_count[src_hash[0][row + x_pos] & crc_mask]++;
+        num_added++;
+      }
+    }
+  }
+  if (num_added == 0) return 1;
+  if (num_added > INT_MAX - p_hash_table->num_entries ||
+      !hash_table_reserve(p_hash_table,
+                          p_hash_table->num_entries + num_added)) {
+    memset(bucket_count, 0, sizeof(*bucket_count) << crc_bits);
+    return 0;
+  }
 
+  // lay the buckets out one after another, and rewind the counts to use them
+  // as the insertion points
+  uint32_t start = (uint32_t)p_hash_table->num_entries;
+  for (int i = 0; i <= crc_mask; i++) {
+    bucket_start[i] = start;
+    start += bucket_count[i];
+    bucket_count[i] = 0;
+  }
+
+  // Fill the buckets in column order, which is the order in which the motion
+  // search visits the candidates of a bucket.
+  block_hash *const entries = p_hash_table->p_entries;
   for (int x_pos = 0; x_pos < x_end; x_pos++) {
     for (int y_pos = 0; y_pos < y_end; y_pos++) {
       const int pos = y_pos * pic_width + x_pos;
       // valid data
       if (src_is_added[pos]) {
-        block_hash curr_block_hash;
-        curr_block_hash.x = x_pos;
-        curr_block_hash.y = y_pos;
-
-        const uint32_t hash_value1 = (src_hash[0][pos] & crc_mask) + add_value;
-        curr_block_hash.hash_value2 = src_hash[1][pos];
-
-        hash_table_add_to_table(p_hash_table, hash_value1, &curr_block_hash);
+        const int crc = src_hash[0][pos] & crc_mask;
+        block_hash *curr_block_hash =
+            &entries[bucket_start[crc] + bucket_count[crc]++];
+        curr_block_hash->x = x_pos;
+        curr_block_hash->y = y_pos;
+        curr_block_hash->hash_value2 = src_hash[1][pos];
       }
     }
   }
+  p_hash_table->num_entries += num_added;
+  return 1;
 }
 
 int av1_hash_is_horizontal_perfect(const YV12_BUFFER_CONFIG *picture,
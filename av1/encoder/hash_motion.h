@@ -15,7 +15,6 @@
 #include "./aom_config.h"
 #include "aom/aom_integer.h"
 #include "aom_scale/yv12config.h"
-#include "third_party/vector/vector.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,18 +28,45 @@ typedef struct _block_hash {
   uint32_t hash_value2;
 } block_hash;
 
+// The entries of all buckets are packed in one array, grouped by bucket. Each
+// call to av1_add_to_hash_map_by_row_with_precal_data() fills the buckets of
+// one block size with a counting sort, so a block size may only be added once
+// per av1_hash_table_create().
 typedef struct _hash_table {
-  Vector **p_lookup_table;
+  // start of each bucket in p_entries, indexed by hash_value1
+  uint32_t *p_bucket_start;
+  // number of entries in each bucket
+  uint32_t *p_bucket_count;
+  block_hash *p_entries;
+  int num_entries;
+  int max_entries;
 } hash_table;
 
 void av1_hash_table_init(hash_table *p_hash_table);
 void av1_hash_table_destroy(hash_table *p_hash_table);
-void av1_hash_table_create(hash_table *p_hash_table);
-int32_t av1_hash_table_count(hash_table *p_hash_table, uint32_t hash_value);
-Iterator av1_hash_get_first_iterator(hash_table *p_hash_table,
-                                     uint32_t hash_value);
-int32_t av1_has_exact_match(hash_table *p_hash_table, uint32_t hash_value1,
-                            uint32_t hash_value2);
+// Returns 0 on allocation failure.
+int av1_hash_table_create(hash_table *p_hash_table);
+int32_t av1_hash_table_count(const hash_table *p_hash_table,
+                             uint32_t hash_value);
+// Returns the first of the av1_hash_table_count() entries of the bucket.
+const block_hash *av1_hash_get_first_entry(const hash_table *p_hash_table,
+                                           uint32_t hash_value);
+int32_t av1_has_exact_match(const hash_table *p_hash_table,
+                            uint32_t hash_value1, uint32_t hash_value2);
+// Compute the hashes and the same-colour flags of the blocks whose top row is
+// in [y_start, y_end). The rows of one block size are independent, so they may
+// be computed in parallel. A block size needs all the rows of the previous one.
+void av1_generate_block_2x2_hash_rows(const YV12_BUFFER_CONFIG *picture,
+                                      uint32_t *pic_block_hash[2],
+                                      int8_t *pic_block_same_info[3],
+                                      int y_start, int y_end);
+void av1_generate_block_hash_rows(const YV12_BUFFER_CONFIG *picture,
+                                  int block_size,
+                                  uint32_t *src_pic_block_hash[2],
+                                  uint32_t *dst_pic_block_hash[2],
+                                  int8_t *src_pic_block_same_info[3],
+                                  int8_t *dst_pic_block_same_info[3],
+                                  int y_start, int y_end);
 void av1_generate_block_2x2_hash_value(const YV12_BUFFER_CONFIG *picture,
                                        uint32_t *pic_block_hash[2],
                                        int8_t *pic_block_same_info[3]);
@@ -50,11 +76,12 @@ void av1_generate_block_hash_value(const YV12_BUFFER_CONFIG *picture,
                                    uint32_t *dst_pic_block_hash[2],
                                    int8_t *src_pic_block_same_info[3],
                                    int8_t *dst_pic_block_same_info[3]);
-void av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
-                                                 uint32_t *pic_hash[2],
-                                                 int8_t *pic_is_same,
-                                                 int pic_width, int pic_height,
-                                                 int block_size);
+// Returns 0 on allocation failure.
+int av1_add_to_hash_map_by_row_with_precal_data(hash_table *p_hash_table,
+                                                uint32_t *pic_hash[2],
+                                                int8_t *pic_is_same,
+                                                int pic_width, int pic_height,
+                                                int block_size);
 
 // check whether the block starts from (x_start, y_start) with the size of
 // block_size x block_size has the same color in all rows
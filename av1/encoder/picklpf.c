@@ -11,6 +11,7 @@
 
 #include <assert.h>
 #include <limits.h>
+#include <string.h>
 
 #include "./aom_scale_rtcd.h"
 
@@ -22,9 +23,11 @@
 #include "av1/common/av1_loopfilter.h"
 #include "av1/common/onyxc_int.h"
 #include "av1/common/quant_common.h"
+#include "av1/common/thread_common.h"
 
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/picklpf.h"
 
 static void yv12_copy_plane(const YV12_BUFFER_CONFIG *src_bc,
@@ -37,6 +40,119 @@ static void yv12_copy_plane(const YV12_BUFFER_CONFIG *src_bc,
   }
 }
 
+// Error of a filtered plane against the source, computed by bands of rows in
+// parallel. Each band is put back to the unfiltered plane once its error is
+// known.
+typedef struct {
+  const YV12_BUFFER_CONFIG *sd;
+  const YV12_BUFFER_CONFIG *unfiltered;
+  YV12_BUFFER_CONFIG *frame;
+  int plane;
+  int highbd;
+  int num_workers;
+  int64_t *band_err;
+} FilterErrorJob;
+
+static int64_t get_sse_plane_rows(const YV12_BUFFER_CONFIG *a,
+                                  const YV12_BUFFER_CONFIG *b, int plane,
+                                  int highbd, int vstart, int height) {
+  const int width = a->crop_widths[plane > 0];
+  if (highbd) {
+    switch (plane) {
+      case 0: return aom_highbd_get_y_sse_part(a, b, 0, width, vstart, height);
+      case 1: return aom_highbd_get_u_sse_part(a, b, 0, width, vstart, height);
+      case 2: return aom_highbd_get_v_sse_part(a, b, 0, width, vstart, height);
+      default: assert(plane >= 0 && plane <= 2); return 0;
+    }
+  }
+  switch (plane) {
+    case 0: return aom_get_y_sse_part(a, b, 0, width, vstart, height);
+    case 1: return aom_get_u_sse_part(a, b, 0, width, vstart, height);
+    case 2: return aom_get_v_sse_part(a, b, 0, width, vstart, height);
+    default: assert(plane >= 0 && plane <= 2); return 0;
+  }
+}
+
+// Copies the rows [row_start, row_end) of a plane, like yv12_copy_plane()
+// does for the whole plane.
+static void yv12_copy_plane_rows(const YV12_BUFFER_CONFIG *src_bc,
+                                 YV12_BUFFER_CONFIG *dst_bc, int plane,
+                                 int row_start, int row_end) {
+  const int is_uv = plane > 0;
+  const int src_stride = src_bc->strides[is_uv];
+  const int dst_stride = dst_bc->strides[is_uv];
+  int row;
+
+  if (src_bc->flags & YV12_FLAG_HIGHBITDEPTH) {
+    const uint16_t *src =
+        CONVERT_TO_SHORTPTR(src_bc->buffers[plane]) + row_start * src_stride;
+    uint16_t *dst =
+        CONVERT_TO_SHORTPTR(dst_bc->buffers[plane]) + row_start * dst_stride;
+    for (row = row_start; row < row_end; ++row) {
+      memcpy(dst, src, src_bc->widths[is_uv] * sizeof(uint16_t));
+      src += src_stride;
+      dst += dst_stride;
+    }
+  } else {
+    const uint8_t *src = src_bc->buffers[plane] + row_start * src_stride;
+    uint8_t *dst = dst_bc->buffers[plane] + row_start * dst_stride;
+    for (row = row_start; row < row_end; ++row) {
+      memcpy(dst, src, src_bc->widths[is_uv]);
+      src += src_stride;
+      dst += dst_stride;
+    }
+  }
+}
+
+// Computes the error of the thread_data->start-th of num_workers bands of
+// rows, then restores them.
+static int filter_error_worker_hook(EncWorkerData *const thread_data,
+                                    void *data) {
+  const FilterErrorJob *const job = (const FilterErrorJob *)data;
+  const int band = thread_data->start;
+  const int is_uv = job->plane > 0;
+  const int rows = job->frame->heights[is_uv];
+  const int row_start = rows * band / job->num_workers;
+  const int row_end = rows * (band + 1) / job->num_workers;
+  // The rows below the cropped frame are not part of the error.
+  const int err_end = AOMMIN(row_end, job->sd->crop_heights[is_uv]);
+
+  job->band_err[band] =
+      err_end > row_start
+          ? get_sse_plane_rows(job->sd, job->frame, job->plane, job->highbd,
+                               row_start, err_end - row_start)
+          : 0;
+  yv12_copy_plane_rows(job->unfiltered, job->frame, job->plane, row_start,
+                       row_end);
+  return 1;
+}
+
+// Returns the error of the filtered plane and re-instates the unfiltered one,
+// spreading both over the workers. The error is the same as the one of
+// aom_get_sse_plane().
+static int64_t get_filter_error_mt(const YV12_BUFFER_CONFIG *sd,
+                                   AV1_COMP *const cpi, int plane) {
+  AV1_COMMON *const cm = &cpi->common;
+  FilterErrorJob job;
+  int64_t filt_err = 0;
+  int i;
+
+  job.sd = sd;
+  job.unfiltered = &cpi->last_frame_uf;
+  job.frame = cm->frame_to_show;
+  job.plane = plane;
+  job.highbd = cm->use_highbitdepth;
+  job.num_workers =
+      AOMMIN(cpi->num_workers, cm->frame_to_show->heights[plane > 0]);
+  CHECK_MEM_ERROR(cm, job.band_err,
+                  aom_malloc(job.num_workers * sizeof(*job.band_err)));
+  av1_run_enc_workers(cpi, (AVxWorkerHook)filter_error_worker_hook, &job,
+                      job.num_workers);
+  for (i = 0; i < job.num_workers; i++) filt_err += job.band_err[i];
+  aom_free(job.band_err);
+  return filt_err;
+}
+
 int av1_get_max_filter_level(const AV1_COMP *cpi) {
   if (cpi->oxcf.pass == 2) {
     return cpi->twopass.section_intra_rating > 8 ? MAX_LOOP_FILTER * 3 / 4
@@ -57,6 +173,15 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   if (plane == 0 && dir == 0) filter_level[1] = cm->lf.filter_level[1];
   if (plane == 0 && dir == 1) filter_level[0] = cm->lf.filter_level[0];
 
+  if (cpi->oxcf.max_threads > 1) {
+    av1_create_workers(cpi, cpi->oxcf.max_threads);
+    av1_loop_filter_frame_mt(cm->frame_to_show, cm, &cpi->td.mb.e_mbd,
+                             filter_level[0], filter_level[1], plane,
+                             partial_frame, cpi->workers, cpi->num_workers,
+                             &cpi->lf_row_sync);
+    return get_filter_error_mt(sd, cpi, plane);
+  }
+
   av1_loop_filter_frame(cm->frame_to_show, cm, &cpi->td.mb.e_mbd,
                         filter_level[0], filter_level[1], plane, partial_frame);
 
@@ -71,8 +196,13 @@ static int64_t try_filter_frame(const YV12_BUFFER_CONFIG *sd,
   return filt_err;
 }
 
+// Searches the filter level of the given plane and direction (2 for both
+// luma directions). start_err is the error of the starting level when it is
+// already known, -1 otherwise. The error of the picked level is returned in
+// best_err_ret if it is not NULL.
 static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
                                int partial_frame, double *best_cost_ret,
+                               int64_t *best_err_ret, int64_t start_err,
                                int plane, int dir) {
   const AV1_COMMON *const cm = &cpi->common;
   const struct loopfilter *const lf = &cm->lf;
@@ -100,7 +230,10 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
   // Set each entry to -1
   memset(ss_err, 0xFF, sizeof(ss_err));
   yv12_copy_plane(cm->frame_to_show, &cpi->last_frame_uf, plane);
-  best_err = try_filter_frame(sd, cpi, filt_mid, partial_frame, plane, dir);
+  best_err = start_err >= 0
+                 ? start_err
+                 : try_filter_frame(sd, cpi, filt_mid, partial_frame, plane,
+                                    dir);
   filt_best = filt_mid;
   ss_err[filt_mid] = best_err;
 
@@ -162,6 +295,7 @@ static int search_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
   best_err = ss_err[filt_best];
 
   if (best_cost_ret) *best_cost_ret = RDCOST_DBL(x->rdmult, 0, best_err);
+  if (best_err_ret) *best_err_ret = best_err;
   return filt_best;
 }
 
@@ -215,18 +349,23 @@ void av1_pick_filter_level(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi,
     lf->filter_level_u = clamp(filt_guess, min_filter_level, max_filter_level);
     lf->filter_level_v = clamp(filt_guess, min_filter_level, max_filter_level);
   } else {
-    lf->filter_level[0] = lf->filter_level[1] = search_filter_level(
-        sd, cpi, method == LPF_PICK_FROM_SUBIMAGE, NULL, 0, 2);
-    lf->filter_level[0] = search_filter_level(
-        sd, cpi, method == LPF_PICK_FROM_SUBIMAGE, NULL, 0, 0);
-    lf->filter_level[1] = search_filter_level(
-        sd, cpi, method == LPF_PICK_FROM_SUBIMAGE, NULL, 0, 1);
+    const int partial_frame = method == LPF_PICK_FROM_SUBIMAGE;
+    int64_t err;
+
+    lf->filter_level[0] = lf->filter_level[1] =
+        search_filter_level(sd, cpi, partial_frame, NULL, &err, -1, 0, 2);
+    // The vertical search starts from the level just picked for both
+    // directions, whose error is already known.
+    lf->filter_level[0] =
+        search_filter_level(sd, cpi, partial_frame, NULL, NULL, err, 0, 0);
+    lf->filter_level[1] =
+        search_filter_level(sd, cpi, partial_frame, NULL, NULL, -1, 0, 1);
 
     if (num_planes > 1) {
-      lf->filter_level_u = search_filter_level(
-          sd, cpi, method == LPF_PICK_FROM_SUBIMAGE, NULL, 1, 0);
-      lf->filter_level_v = search_filter_level(
-          sd, cpi, method == LPF_PICK_FROM_SUBIMAGE, NULL, 2, 0);
+      lf->filter_level_u =
+          search_filter_level(sd, cpi, partial_frame, NULL, NULL, -1, 1, 0);
+      lf->filter_level_v =
+          search_filter_level(sd, cpi, partial_frame, NULL, NULL, -1, 2, 0);
     }
   }
 }
@@ -15,6 +15,7 @@
 #include <math.h>
 
 #include "./aom_scale_rtcd.h"
+#include "./av1_rtcd.h"
 
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_dsp/binary_codes_writer.h"
@@ -619,50 +620,37 @@ static void search_sgrproj(const RestorationTileLimits *limits,
   if (cost_sgr < cost_none) rsc->sgrproj = rusi->sgrproj;
 }
 
-static double find_average(const uint8_t *src, int h_start, int h_end,
-                           int v_start, int v_end, int stride) {
-  uint64_t sum = 0;
-  double avg = 0;
-  int i, j;
-  aom_clear_system_state();
-  for (i = v_start; i < v_end; i++)
-    for (j = h_start; j < h_end; j++) sum += src[i * stride + j];
-  avg = (double)sum / ((v_end - v_start) * (h_end - h_start));
-  return avg;
-}
-
-static void compute_stats(int wiener_win, const uint8_t *dgd,
-                          const uint8_t *src, int h_start, int h_end,
-                          int v_start, int v_end, int dgd_stride,
-                          int src_stride, double *M, double *H) {
+void av1_compute_stats_c(int wiener_win, const uint8_t *dgd, const uint8_t *src,
+                         int h_start, int h_end, int v_start, int v_end,
+                         int dgd_stride, int src_stride, int64_t *M,
+                         int64_t *H) {
   int i, j, k, l;
-  double Y[WIENER_WIN2];
+  int16_t Y[WIENER_WIN2];
   const int wiener_win2 = wiener_win * wiener_win;
   const int wiener_halfwin = (wiener_win >> 1);
-  const double avg =
+  const int16_t avg =
       find_average(dgd, h_start, h_end, v_start, v_end, dgd_stride);
 
   memset(M, 0, sizeof(*M) * wiener_win2);
   memset(H, 0, sizeof(*H) * wiener_win2 * wiener_win2);
   for (i = v_start; i < v_end; i++) {
     for (j = h_start; j < h_end; j++) {
-      const double X = (double)src[i * src_stride + j] - avg;
+      const int16_t X = (int16_t)src[i * src_stride + j] - avg;
       int idx = 0;
       for (k = -wiener_halfwin; k <= wiener_halfwin; k++) {
         for (l = -wiener_halfwin; l <= wiener_halfwin; l++) {
-          Y[idx] = (double)dgd[(i + l) * dgd_stride + (j + k)] - avg;
+          Y[idx] = (int16_t)dgd[(i + l) * dgd_stride + (j + k)] - avg;
           idx++;
         }
       }
       assert(idx == wiener_win2);
       for (k = 0; k < wiener_win2; ++k) {
-        M[k] += Y[k] * X;
-        H[k * wiener_win2 + k] += Y[k] * Y[k];
-        for (l = k + 1; l < wiener_win2; ++l) {
+        M[k] += (int32_t)Y[k] * X;
+        for (l = k; l < wiener_win2; ++l) {
           // H is a symmetric matrix, so we only need to fill out the upper
           // triangle here. We can copy it down to the lower triangle outside
           // the (i, j) loops.
-          H[k * wiener_win2 + l] += Y[k] * Y[l];
+          H[k * wiener_win2 + l] += (int32_t)Y[k] * Y[l];
         }
       }
     }
@@ -674,52 +662,41 @@ static void compute_stats(int wiener_win, const uint8_t *dgd,
   }
 }
 
-static double find_average_highbd(const uint16_t *src, int h_start, int h_end,
-                                  int v_start, int v_end, int stride) {
-  uint64_t sum = 0;
-  double avg = 0;
-  int i, j;
-  aom_clear_system_state();
-  for (i = v_start; i < v_end; i++)
-    for (j = h_start; j < h_end; j++) sum += src[i * stride + j];
-  avg = (double)sum / ((v_end - v_start) * (h_end - h_start));
-  return avg;
-}
-
-static void compute_stats_highbd(int wiener_win, const uint8_t *dgd8,
-                                 const uint8_t *src8, int h_start, int h_end,
-                                 int v_start, int v_end, int dgd_stride,
-                                 int src_stride, double *M, double *H) {
+void av1_compute_stats_highbd_c(int wiener_win, const uint8_t *dgd8,
+                                const uint8_t *src8, int h_start, int h_end,
+                                int v_start, int v_end, int dgd_stride,
+                                int src_stride, int64_t *M, int64_t *H,
+                                int bit_depth) {
   int i, j, k, l;
-  double Y[WIENER_WIN2];
+  int16_t Y[WIENER_WIN2];
   const int wiener_win2 = wiener_win * wiener_win;
   const int wiener_halfwin = (wiener_win >> 1);
   const uint16_t *src = CONVERT_TO_SHORTPTR(src8);
   const uint16_t *dgd = CONVERT_TO_SHORTPTR(dgd8);
-  const double avg =
+  const int16_t avg =
       find_average_highbd(dgd, h_start, h_end, v_start, v_end, dgd_stride);
+  (void)bit_depth;
 
   memset(M, 0, sizeof(*M) * wiener_win2);
   memset(H, 0, sizeof(*H) * wiener_win2 * wiener_win2);
   for (i = v_start; i < v_end; i++) {
     for (j = h_start; j < h_end; j++) {
-      const double X = (double)src[i * src_stride + j] - avg;
+      const int16_t X = (int16_t)src[i * src_stride + j] - avg;
       int idx = 0;
       for (k = -wiener_halfwin; k <= wiener_halfwin; k++) {
         for (l = -wiener_halfwin; l <= wiener_halfwin; l++) {
-          Y[idx] = (double)dgd[(i + l) * dgd_stride + (j + k)] - avg;
+          Y[idx] = (int16_t)dgd[(i + l) * dgd_stride + (j + k)] - avg;
           idx++;
         }
       }
       assert(idx == wiener_win2);
       for (k = 0; k < wiener_win2; ++k) {
-        M[k] += Y[k] * X;
-        H[k * wiener_win2 + k] += Y[k] * Y[k];
-        for (l = k + 1; l < wiener_win2; ++l) {
+        M[k] += (int32_t)Y[k] * X;
+        for (l = k; l < wiener_win2; ++l) {
           // H is a symmetric matrix, so we only need to fill out the upper
           // triangle here. We can copy it down to the lower triangle outside
           // the (i, j) loops.
-          H[k * wiener_win2 + l] += Y[k] * Y[l];
+          H[k * wiener_win2 + l] += (int32_t)Y[k] * Y[l];
         }
       }
     }
@@ -1089,19 +1066,29 @@ static void search_wiener(const RestorationTileLimits *limits,
   const int wiener_win =
       (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN : WIENER_WIN_CHROMA;
 
+  int64_t M_int[WIENER_WIN2];
+  int64_t H_int[WIENER_WIN2 * WIENER_WIN2];
   double M[WIENER_WIN2];
   double H[WIENER_WIN2 * WIENER_WIN2];
   double vfilterd[WIENER_WIN], hfilterd[WIENER_WIN];
+  const int wiener_win2 = wiener_win * wiener_win;
+  int i;
 
   const AV1_COMMON *const cm = rsc->cm;
   if (cm->use_highbitdepth)
-    compute_stats_highbd(wiener_win, rsc->dgd_buffer, rsc->src_buffer,
-                         limits->h_start, limits->h_end, limits->v_start,
-                         limits->v_end, rsc->dgd_stride, rsc->src_stride, M, H);
+    av1_compute_stats_highbd(wiener_win, rsc->dgd_buffer, rsc->src_buffer,
+                             limits->h_start, limits->h_end, limits->v_start,
+                             limits->v_end, rsc->dgd_stride, rsc->src_stride,
+                             M_int, H_int, cm->bit_depth);
   else
-    compute_stats(wiener_win, rsc->dgd_buffer, rsc->src_buffer, limits->h_start,
-                  limits->h_end, limits->v_start, limits->v_end,
-                  rsc->dgd_stride, rsc->src_stride, M, H);
+    av1_compute_stats(wiener_win, rsc->dgd_buffer, rsc->src_buffer,
+                      limits->h_start, limits->h_end, limits->v_start,
+                      limits->v_end, rsc->dgd_stride, rsc->src_stride, M_int,
+                      H_int);
+
+  aom_clear_system_state();
+  for (i = 0; i < wiener_win2; ++i) M[i] = (double)M_int[i];
+  for (i = 0; i < wiener_win2 * wiener_win2; ++i) H[i] = (double)H_int[i];
 
   const MACROBLOCK *const x = rsc->x;
   const int64_t bits_none = x->wiener_restore_cost[0];
@@ -20,6 +20,56 @@ extern "C" {
 struct yv12_buffer_config;
 struct AV1_COMP;
 
+// Rounded average of the pixels of a restoration unit, which the Wiener
+// statistics are taken relative to.
+static INLINE uint8_t find_average(const uint8_t *src, int h_start, int h_end,
+                                   int v_start, int v_end, int stride) {
+  uint64_t sum = 0;
+  const uint64_t num = (uint64_t)(v_end - v_start) * (h_end - h_start);
+  int i, j;
+  for (i = v_start; i < v_end; i++)
+    for (j = h_start; j < h_end; j++) sum += src[i * stride + j];
+  return (uint8_t)((sum + (num >> 1)) / num);
+}
+
+static INLINE uint16_t find_average_highbd(const uint16_t *src, int h_start,
+                                           int h_end, int v_start, int v_end,
+                                           int stride) {
+  uint64_t sum = 0;
+  const uint64_t num = (uint64_t)(v_end - v_start) * (h_end - h_start);
+  int i, j;
+  for (i = v_start; i < v_end; i++)
+    for (j = h_start; j < h_end; j++) sum += src[i * stride + j];
+  return (uint16_t)((sum + (num >> 1)) / num);
+}
+
+// The SIMD versions of av1_compute_stats() take two horizontally adjacent
+// pixels at a time, with the values of both packed in each 32-bit lane, and
+// sum their products in 32 bits for as many pixel pairs as cannot overflow.
+static INLINE int32_t wiener_stats_pack_pair(int a, int b) {
+  return (int32_t)((uint32_t)(uint16_t)a | ((uint32_t)(uint16_t)b << 16));
+}
+
+// Number of pixel pairs whose 32-bit sums of products cannot overflow.
+static INLINE int wiener_stats_max_pairs(int bit_depth) {
+  const int64_t max_val = (1 << bit_depth) - 1;
+  return (int)(INT32_MAX / (2 * max_val * max_val));
+}
+
+// Adds the 32-bit sums to the upper triangle of H and to M, and clears them.
+static INLINE void wiener_stats_flush(int wiener_win2, int stride32,
+                                      int32_t *M32, int32_t *H32, int64_t *M,
+                                      int64_t *H) {
+  int k, l;
+  for (k = 0; k < wiener_win2; ++k) {
+    M[k] += M32[k];
+    for (l = k; l < wiener_win2; ++l)
+      H[k * wiener_win2 + l] += H32[k * stride32 + l];
+  }
+  memset(M32, 0, sizeof(*M32) * stride32);
+  memset(H32, 0, sizeof(*H32) * wiener_win2 * stride32);
+}
+
 void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *sd, AV1_COMP *cpi);
 
 #ifdef __cplusplus
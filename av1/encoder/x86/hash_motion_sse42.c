@@ -0,0 +1,263 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <nmmintrin.h>
+
+#include "./av1_rtcd.h"
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+
+// The hashes are the CRC-32C of av1_get_crc_value_sse4_2(), which does not
+// depend on the CRC calculator: hash1 and hash2 of a 2x2 block are equal.
+
+static INLINE uint32_t crc32c_u64(uint32_t crc, uint64_t v) {
+#ifdef __x86_64__
+  return (uint32_t)_mm_crc32_u64(crc, v);
+#else
+  crc = _mm_crc32_u32(crc, (uint32_t)v);
+  return _mm_crc32_u32(crc, (uint32_t)(v >> 32));
+#endif
+}
+
+// The CRC of the 4 bytes of a 2x2 block, in raster order.
+static INLINE uint32_t hash_2x2_u32(uint32_t pixels) {
+  return ~_mm_crc32_u32(0xFFFFFFFF, pixels);
+}
+
+// The CRC of the 4 16-bit pixels of a 2x2 block, in raster order.
+static INLINE uint32_t hash_2x2_u64(uint64_t pixels) {
+  return ~crc32c_u64(0xFFFFFFFF, pixels);
+}
+
+// The CRC of the 4 hashes of the sub-blocks of a block, in raster order: a
+// holds the top two and b the bottom two.
+static INLINE uint32_t hash_quad(uint64_t a, uint64_t b) {
+  return ~crc32c_u64(crc32c_u64(0xFFFFFFFF, a), b);
+}
+
+static INLINE uint64_t pack_pair(uint32_t lo, uint32_t hi) {
+  return lo | ((uint64_t)hi << 32);
+}
+
+static void generate_2x2_hash_row_lowbd(const uint8_t *src, int stride,
+                                        int width, uint32_t *hash1,
+                                        uint32_t *hash2, int8_t *row_same,
+                                        int8_t *col_same) {
+  const uint8_t *below = src + stride;
+  const __m128i one = _mm_set1_epi8(1);
+  DECLARE_ALIGNED(16, uint32_t, pixels[16]);
+  int x = 0;
+
+  for (; x + 16 <= width; x += 16) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)(src + x));
+    const __m128i a1 = _mm_loadu_si128((const __m128i *)(src + x + 1));
+    const __m128i b = _mm_loadu_si128((const __m128i *)(below + x));
+    const __m128i b1 = _mm_loadu_si128((const __m128i *)(below + x + 1));
+    const __m128i row = _mm_and_si128(_mm_cmpeq_epi8(a, a1),
+                                      _mm_cmpeq_epi8(b, b1));
+    const __m128i col = _mm_and_si128(_mm_cmpeq_epi8(a, b),
+                                      _mm_cmpeq_epi8(a1, b1));
+    _mm_storeu_si128((__m128i *)(row_same + x), _mm_and_si128(row, one));
+    _mm_storeu_si128((__m128i *)(col_same + x), _mm_and_si128(col, one));
+
+    // Interleave the 4 pixels of each block into a 32-bit word.
+    const __m128i top_lo = _mm_unpacklo_epi8(a, a1);
+    const __m128i top_hi = _mm_unpackhi_epi8(a, a1);
+    const __m128i bot_lo = _mm_unpacklo_epi8(b, b1);
+    const __m128i bot_hi = _mm_unpackhi_epi8(b, b1);
+    __m128i *const out = (__m128i *)pixels;
+    _mm_store_si128(out + 0, _mm_unpacklo_epi16(top_lo, bot_lo));
+    _mm_store_si128(out + 1, _mm_unpackhi_epi16(top_lo, bot_lo));
+    _mm_store_si128(out + 2, _mm_unpacklo_epi16(top_hi, bot_hi));
+    _mm_store_si128(out + 3, _mm_unpackhi_epi16(top_hi, bot_hi));
+    for (int i = 0; i < 16; i++) {
+      hash1[x + i] = hash2[x + i] = hash_2x2_u32(pixels[i]);
+    }
+  }
+
+  for (; x < width; x++) {
+    const uint32_t p0 = src[x], p1 = src[x + 1];
+    const uint32_t p2 = below[x], p3 = below[x + 1];
+    row_same[x] = p0 == p1 && p2 == p3;
+    col_same[x] = p0 == p2 && p1 == p3;
+    hash1[x] = hash2[x] =
+        hash_2x2_u32(p0 | (p1 << 8) | (p2 << 16) | (p3 << 24));
+  }
+}
+
+static void generate_2x2_hash_row_highbd(const uint16_t *src, int stride,
+                                         int width, uint32_t *hash1,
+                                         uint32_t *hash2, int8_t *row_same,
+                                         int8_t *col_same) {
+  const uint16_t *below = src + stride;
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i zero = _mm_setzero_si128();
+  DECLARE_ALIGNED(16, uint64_t, pixels[8]);
+  int x = 0;
+
+  for (; x + 8 <= width; x += 8) {
+    const __m128i a = _mm_loadu_si128((const __m128i *)(src + x));
+    const __m128i a1 = _mm_loadu_si128((const __m128i *)(src + x + 1));
+    const __m128i b = _mm_loadu_si128((const __m128i *)(below + x));
+    const __m128i b1 = _mm_loadu_si128((const __m128i *)(below + x + 1));
+    const __m128i row = _mm_and_si128(_mm_cmpeq_epi16(a, a1),
+                                      _mm_cmpeq_epi16(b, b1));
+    const __m128i col = _mm_and_si128(_mm_cmpeq_epi16(a, b),
+                                      _mm_cmpeq_epi16(a1, b1));
+    _mm_storel_epi64((__m128i *)(row_same + x),
+                     _mm_and_si128(_mm_packs_epi16(row, zero), one));
+    _mm_storel_epi64((__m128i *)(col_same + x),
+                     _mm_and_si128(_mm_packs_epi16(col, zero), one));
+
+    // Interleave the 4 pixels of each block into a 64-bit word.
+    const __m128i top_lo = _mm_unpacklo_epi16(a, a1);
+    const __m128i top_hi = _mm_unpackhi_epi16(a, a1);
+    const __m128i bot_lo = _mm_unpacklo_epi16(b, b1);
+    const __m128i bot_hi = _mm_unpackhi_epi16(b, b1);
+    __m128i *const out = (__m128i *)pixels;
+    _mm_store_si128(out + 0, _mm_unpacklo_epi32(top_lo, bot_lo));
+    _mm_store_si128(out + 1, _mm_unpackhi_epi32(top_lo, bot_lo));
+    _mm_store_si128(out + 2, _mm_unpacklo_epi32(top_hi, bot_hi));
+    _mm_store_si128(out + 3, _mm_unpackhi_epi32(top_hi, bot_hi));
+    for (int i = 0; i < 8; i++) {
+      hash1[x + i] = hash2[x + i] = hash_2x2_u64(pixels[i]);
+    }
+  }
+
+  for (; x < width; x++) {
+    const uint64_t p0 = src[x], p1 = src[x + 1];
+    const uint64_t p2 = below[x], p3 = below[x + 1];
+    row_same[x] = p0 == p1 && p2 == p3;
+    col_same[x] = p0 == p2 && p1 == p3;
+    hash1[x] = hash2[x] =
+        hash_2x2_u64(p0 | (p1 << 16) | (p2 << 32) | (p3 << 48));
+  }
+}
+
+void av1_generate_block_2x2_hash_row_sse4_2(const uint8_t *src, int stride,
+                                            int width, int use_highbitdepth,
+                                            uint32_t *hash1, uint32_t *hash2,
+                                            int8_t *row_same,
+                                            int8_t *col_same) {
+  if (use_highbitdepth) {
+    generate_2x2_hash_row_highbd(CONVERT_TO_SHORTPTR(src), stride, width,
+                                 hash1, hash2, row_same, col_same);
+  } else {
+    generate_2x2_hash_row_lowbd(src, stride, width, hash1, hash2, row_same,
+                                col_same);
+  }
+}
+
+// Hashes the blocks x to x + 3 of one of the two hash planes. top and bottom
+// point to the sub-block hashes of the top and bottom halves of block x.
+static INLINE void hash_quad_x4(const uint32_t *top, const uint32_t *bottom,
+                                int src_size, uint32_t *dst) {
+  DECLARE_ALIGNED(16, uint64_t, tops[4]);
+  DECLARE_ALIGNED(16, uint64_t, bottoms[4]);
+  const __m128i tl = _mm_loadu_si128((const __m128i *)top);
+  const __m128i tr = _mm_loadu_si128((const __m128i *)(top + src_size));
+  const __m128i bl = _mm_loadu_si128((const __m128i *)bottom);
+  const __m128i br = _mm_loadu_si128((const __m128i *)(bottom + src_size));
+  _mm_store_si128((__m128i *)(tops + 0), _mm_unpacklo_epi32(tl, tr));
+  _mm_store_si128((__m128i *)(tops + 2), _mm_unpackhi_epi32(tl, tr));
+  _mm_store_si128((__m128i *)(bottoms + 0), _mm_unpacklo_epi32(bl, br));
+  _mm_store_si128((__m128i *)(bottoms + 2), _mm_unpackhi_epi32(bl, br));
+  dst[0] = hash_quad(tops[0], bottoms[0]);
+  dst[1] = hash_quad(tops[1], bottoms[1]);
+  dst[2] = hash_quad(tops[2], bottoms[2]);
+  dst[3] = hash_quad(tops[3], bottoms[3]);
+}
+
+void av1_generate_block_hash_row_sse4_2(uint32_t *src_pic_block_hash[2],
+                                        int8_t *src_pic_block_same_info[3],
+                                        uint32_t *dst_pic_block_hash[2],
+                                        int8_t *dst_pic_block_same_info[3],
+                                        int pic_width, int width,
+                                        int block_size, int y_pos) {
+  const int src_size = block_size >> 1;
+  const int quad_size = block_size >> 2;
+  const int size_minus1 = block_size - 1;
+  const int row = y_pos * pic_width;
+  const int half_down = src_size * pic_width;
+  const int quad_down = quad_size * pic_width;
+  int x;
+
+  for (int k = 0; k < 2; k++) {
+    const uint32_t *top = src_pic_block_hash[k] + row;
+    const uint32_t *bottom = top + half_down;
+    uint32_t *dst = dst_pic_block_hash[k] + row;
+    for (x = 0; x + 4 <= width; x += 4) {
+      hash_quad_x4(top + x, bottom + x, src_size, dst + x);
+    }
+    for (; x < width; x++) {
+      dst[x] = hash_quad(pack_pair(top[x], top[x + src_size]),
+                         pack_pair(bottom[x], bottom[x + src_size]));
+    }
+  }
+
+  // The same-colour flags are 0 or 1, so && is &.
+  const int8_t *rs = src_pic_block_same_info[0] + row;
+  const int8_t *cs = src_pic_block_same_info[1] + row;
+  int8_t *dst_rs = dst_pic_block_same_info[0] + row;
+  int8_t *dst_cs = dst_pic_block_same_info[1] + row;
+  int8_t *dst_added = dst_pic_block_same_info[2] + row;
+  const int y_aligned = (y_pos & size_minus1) == 0;
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i mask16 = _mm_set1_epi16(size_minus1);
+  const __m128i lane16 = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  const __m128i zero = _mm_setzero_si128();
+#define LOAD_SAME(p, offset) \
+  _mm_loadu_si128((const __m128i *)((p) + x + (offset)))
+  for (x = 0; x + 16 <= width; x += 16) {
+    const __m128i r = _mm_and_si128(
+        _mm_and_si128(_mm_and_si128(LOAD_SAME(rs, 0), LOAD_SAME(rs, quad_size)),
+                      LOAD_SAME(rs, src_size)),
+        _mm_and_si128(
+            _mm_and_si128(LOAD_SAME(rs, half_down),
+                          LOAD_SAME(rs, half_down + quad_size)),
+            LOAD_SAME(rs, half_down + src_size)));
+    const __m128i c = _mm_and_si128(
+        _mm_and_si128(_mm_and_si128(LOAD_SAME(cs, 0), LOAD_SAME(cs, src_size)),
+                      LOAD_SAME(cs, quad_down)),
+        _mm_and_si128(
+            _mm_and_si128(LOAD_SAME(cs, quad_down + src_size),
+                          LOAD_SAME(cs, half_down)),
+            LOAD_SAME(cs, half_down + src_size)));
+    _mm_storeu_si128((__m128i *)(dst_rs + x), r);
+    _mm_storeu_si128((__m128i *)(dst_cs + x), c);
+
+    __m128i added = _mm_xor_si128(_mm_or_si128(r, c), one);
+    if (y_aligned) {
+      const __m128i x_lo = _mm_add_epi16(_mm_set1_epi16(x), lane16);
+      const __m128i x_hi = _mm_add_epi16(x_lo, _mm_set1_epi16(8));
+      const __m128i aligned_lo =
+          _mm_cmpeq_epi16(_mm_and_si128(x_lo, mask16), zero);
+      const __m128i aligned_hi =
+          _mm_cmpeq_epi16(_mm_and_si128(x_hi, mask16), zero);
+      added = _mm_or_si128(
+          added,
+          _mm_and_si128(_mm_packs_epi16(aligned_lo, aligned_hi), one));
+    }
+    _mm_storeu_si128((__m128i *)(dst_added + x), added);
+  }
+#undef LOAD_SAME
+  for (; x < width; x++) {
+    dst_rs[x] = rs[x] & rs[x + quad_size] & rs[x + src_size] &
+                rs[x + half_down] & rs[x + half_down + quad_size] &
+                rs[x + half_down + src_size];
+    dst_cs[x] = cs[x] & cs[x + src_size] & cs[x + quad_down] &
+                cs[x + quad_down + src_size] & cs[x + half_down] &
+                cs[x + half_down + src_size];
+    dst_added[x] = (!dst_rs[x] && !dst_cs[x]) ||
+                   (((x & size_minus1) == 0) && y_aligned);
+  }
+}
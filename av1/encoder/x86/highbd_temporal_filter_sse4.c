@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <smmintrin.h>
+
+#include "./av1_rtcd.h"
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+
+// Largest block handled by the SIMD code. Larger blocks, and blocks whose
+// width is not a multiple of 4 or that are a single row high, use the C code.
+#define TF_MAX_BLOCK 32
+
+static INLINE __m128i load_pixels_sse4_1(const uint16_t *src) {
+  return _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i *)src));
+}
+
+// Returns x / 3 for any unsigned 32-bit x.
+static INLINE __m128i div3_epu32_sse4_1(__m128i x) {
+  const __m128i magic = _mm_set1_epi32((int)0xAAAAAAAB);
+  const __m128i even = _mm_srli_epi64(_mm_mul_epu32(x, magic), 33);
+  const __m128i odd =
+      _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(x, 32), magic), 33);
+  return _mm_blend_epi16(even, _mm_slli_epi64(odd, 32), 0xCC);
+}
+
+// See temporal_filter_apply_avx2() in temporal_filter_avx2.c. This is the same
+// algorithm on four pixels at a time.
+void av1_highbd_temporal_filter_apply_sse4_1(
+    uint8_t *frame1_8, unsigned int stride, uint8_t *frame2_8,
+    unsigned int block_width, unsigned int block_height, int strength,
+    int filter_weight, unsigned int *accumulator, uint16_t *count) {
+  if ((block_width & 3) != 0 || block_width > TF_MAX_BLOCK ||
+      block_height < 2 || block_height > TF_MAX_BLOCK) {
+    av1_highbd_temporal_filter_apply_c(frame1_8, stride, frame2_8, block_width,
+                                       block_height, strength, filter_weight,
+                                       accumulator, count);
+    return;
+  }
+
+  const uint16_t *frame1 = CONVERT_TO_SHORTPTR(frame1_8);
+  const uint16_t *frame2 = CONVERT_TO_SHORTPTR(frame2_8);
+  const int w = (int)block_width;
+  const int h = (int)block_height;
+  const int w4 = w >> 2;
+  const __m128i shift = _mm_cvtsi32_si128(strength);
+  const __m128i rounding =
+      _mm_set1_epi32(strength > 0 ? 1 << (strength - 1) : 0);
+  const __m128i sixteen = _mm_set1_epi32(16);
+  const __m128i weight = _mm_set1_epi32(filter_weight);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i lane = _mm_setr_epi32(0, 1, 2, 3);
+  // Horizontal 3-tap sums of the squared differences of each row.
+  __m128i row_sum[TF_MAX_BLOCK + 2][TF_MAX_BLOCK / 4];
+  uint32_t sq[TF_MAX_BLOCK + 2];
+  __m128i col_edge[TF_MAX_BLOCK / 4];
+  int i, j;
+
+  for (j = 0; j < w4; ++j) {
+    const __m128i col = _mm_add_epi32(_mm_set1_epi32(j * 4), lane);
+    col_edge[j] = _mm_or_si128(_mm_cmpeq_epi32(col, zero),
+                               _mm_cmpeq_epi32(col, _mm_set1_epi32(w - 1)));
+    row_sum[0][j] = zero;
+    row_sum[h + 1][j] = zero;
+  }
+
+  sq[0] = 0;
+  sq[w + 1] = 0;
+  for (i = 0; i < h; ++i) {
+    const uint16_t *src1 = frame1 + i * stride;
+    const uint16_t *src2 = frame2 + i * w;
+    for (j = 0; j < w4; ++j) {
+      const __m128i diff = _mm_sub_epi32(load_pixels_sse4_1(src1 + j * 4),
+                                         load_pixels_sse4_1(src2 + j * 4));
+      _mm_storeu_si128((__m128i *)(sq + 1 + j * 4),
+                       _mm_mullo_epi32(diff, diff));
+    }
+    for (j = 0; j < w4; ++j) {
+      const __m128i l = _mm_loadu_si128((const __m128i *)(sq + j * 4));
+      const __m128i c = _mm_loadu_si128((const __m128i *)(sq + j * 4 + 1));
+      const __m128i r = _mm_loadu_si128((const __m128i *)(sq + j * 4 + 2));
+      row_sum[i + 1][j] = _mm_add_epi32(_mm_add_epi32(l, c), r);
+    }
+  }
+
+  for (i = 0; i < h; ++i) {
+    const uint16_t *src2 = frame2 + i * w;
+    const int row_edge = i == 0 || i == h - 1;
+    for (j = 0; j < w4; ++j) {
+      const int k = i * w + j * 4;
+      const __m128i sum = _mm_add_epi32(
+          _mm_add_epi32(row_sum[i][j], row_sum[i + 1][j]), row_sum[i + 2][j]);
+      const __m128i half = _mm_srli_epi32(sum, 1);
+      __m128i modifier;
+      if (row_edge) {
+        const __m128i sum3 = _mm_add_epi32(sum, _mm_add_epi32(sum, sum));
+        const __m128i quarter3 = _mm_srli_epi32(sum3, 2);
+        modifier = _mm_blendv_epi8(half, quarter3, col_edge[j]);
+      } else {
+        modifier = _mm_blendv_epi8(div3_epu32_sse4_1(sum), half, col_edge[j]);
+      }
+      modifier = _mm_srl_epi32(_mm_add_epi32(modifier, rounding), shift);
+      modifier = _mm_min_epu32(modifier, sixteen);
+      modifier = _mm_sub_epi32(sixteen, modifier);
+      modifier = _mm_mullo_epi32(modifier, weight);
+
+      const __m128i pixel = load_pixels_sse4_1(src2 + j * 4);
+      const __m128i acc = _mm_loadu_si128((const __m128i *)(accumulator + k));
+      _mm_storeu_si128((__m128i *)(accumulator + k),
+                       _mm_add_epi32(acc, _mm_mullo_epi32(modifier, pixel)));
+
+      const __m128i cnt = _mm_loadl_epi64((const __m128i *)(count + k));
+      const __m128i mod16 = _mm_packus_epi32(modifier, modifier);
+      _mm_storel_epi64((__m128i *)(count + k), _mm_add_epi16(cnt, mod16));
+    }
+  }
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <smmintrin.h>
+
+#include "./av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+#include "av1/common/restoration.h"
+#include "av1/encoder/pickrst.h"
+
+#define WIENER_WIN2_ALIGN4 ALIGN_POWER_OF_TWO(WIENER_WIN2, 2)
+
+static INLINE void compute_stats_sse4_1(int wiener_win, const uint8_t *dgd8,
+                                        const uint8_t *src8, int h_start,
+                                        int h_end, int v_start, int v_end,
+                                        int dgd_stride, int src_stride,
+                                        int64_t *M, int64_t *H, int highbd,
+                                        int bit_depth) {
+  DECLARE_ALIGNED(16, int32_t, Y[WIENER_WIN2_ALIGN4]);
+  DECLARE_ALIGNED(16, int32_t, M32[WIENER_WIN2_ALIGN4]);
+  DECLARE_ALIGNED(16, int32_t, H32[WIENER_WIN2 * WIENER_WIN2_ALIGN4]);
+  const int wiener_win2 = wiener_win * wiener_win;
+  const int wiener_halfwin = (wiener_win >> 1);
+  const int num_vecs = (wiener_win2 + 3) >> 2;
+  const int max_pairs = wiener_stats_max_pairs(bit_depth);
+  const uint16_t *const dgd16 = highbd ? CONVERT_TO_SHORTPTR(dgd8) : NULL;
+  const uint16_t *const src16 = highbd ? CONVERT_TO_SHORTPTR(src8) : NULL;
+  const int avg =
+      highbd
+          ? find_average_highbd(dgd16, h_start, h_end, v_start, v_end,
+                                dgd_stride)
+          : find_average(dgd8, h_start, h_end, v_start, v_end, dgd_stride);
+  int num_pairs = 0;
+  int i, j, k, l;
+
+  memset(M, 0, sizeof(*M) * wiener_win2);
+  memset(H, 0, sizeof(*H) * wiener_win2 * wiener_win2);
+  memset(Y, 0, sizeof(Y));
+  memset(M32, 0, sizeof(M32));
+  memset(H32, 0, sizeof(H32));
+  for (i = v_start; i < v_end; i++) {
+    for (j = h_start; j < h_end; j += 2) {
+      // The second pixel of the last pair of an odd width row is zero.
+      const int has_next = j + 1 < h_end;
+      const int x_pos = i * src_stride + j;
+      const int xa = (highbd ? src16[x_pos] : src8[x_pos]) - avg;
+      const int xb =
+          has_next ? (highbd ? src16[x_pos + 1] : src8[x_pos + 1]) - avg : 0;
+      const __m128i x = _mm_set1_epi32(wiener_stats_pack_pair(xa, xb));
+      int idx = 0;
+
+      if (num_pairs == max_pairs) {
+        wiener_stats_flush(wiener_win2, WIENER_WIN2_ALIGN4, M32, H32, M, H);
+        num_pairs = 0;
+      }
+
+      for (k = -wiener_halfwin; k <= wiener_halfwin; k++) {
+        for (l = -wiener_halfwin; l <= wiener_halfwin; l++) {
+          const int pos = (i + l) * dgd_stride + (j + k);
+          const int ya = (highbd ? dgd16[pos] : dgd8[pos]) - avg;
+          const int yb =
+              has_next ? (highbd ? dgd16[pos + 1] : dgd8[pos + 1]) - avg : 0;
+          Y[idx++] = wiener_stats_pack_pair(ya, yb);
+        }
+      }
+
+      for (k = 0; k < num_vecs; ++k) {
+        const __m128i y = _mm_load_si128((const __m128i *)(Y + 4 * k));
+        __m128i *const m = (__m128i *)(M32 + 4 * k);
+        _mm_store_si128(m,
+                        _mm_add_epi32(_mm_load_si128(m), _mm_madd_epi16(y, x)));
+      }
+      // Only the upper triangle of H is needed. The lanes left of the
+      // diagonal in the first vector of each row are ignored by the flush.
+      for (k = 0; k < wiener_win2; ++k) {
+        const __m128i yk = _mm_set1_epi32(Y[k]);
+        int32_t *const h = H32 + k * WIENER_WIN2_ALIGN4;
+        for (l = k >> 2; l < num_vecs; ++l) {
+          const __m128i y = _mm_load_si128((const __m128i *)(Y + 4 * l));
+          __m128i *const hl = (__m128i *)(h + 4 * l);
+          _mm_store_si128(
+              hl, _mm_add_epi32(_mm_load_si128(hl), _mm_madd_epi16(y, yk)));
+        }
+      }
+      ++num_pairs;
+    }
+  }
+  wiener_stats_flush(wiener_win2, WIENER_WIN2_ALIGN4, M32, H32, M, H);
+
+  for (k = 0; k < wiener_win2; ++k) {
+    for (l = k + 1; l < wiener_win2; ++l) {
+      H[l * wiener_win2 + k] = H[k * wiener_win2 + l];
+    }
+  }
+}
+
+void av1_compute_stats_sse4_1(int wiener_win, const uint8_t *dgd,
+                              const uint8_t *src, int h_start, int h_end,
+                              int v_start, int v_end, int dgd_stride,
+                              int src_stride, int64_t *M, int64_t *H) {
+  compute_stats_sse4_1(wiener_win, dgd, src, h_start, h_end, v_start, v_end,
+                       dgd_stride, src_stride, M, H, 0, 8);
+}
+
+void av1_compute_stats_highbd_sse4_1(int wiener_win, const uint8_t *dgd8,
+                                     const uint8_t *src8, int h_start,
+                                     int h_end, int v_start, int v_end,
+                                     int dgd_stride, int src_stride,
+                                     int64_t *M, int64_t *H, int bit_depth) {
+  compute_stats_sse4_1(wiener_win, dgd8, src8, h_start, h_end, v_start, v_end,
+                       dgd_stride, src_stride, M, H, 1, bit_depth);
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "./av1_rtcd.h"
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+
+// Largest block handled by the SIMD code. Larger blocks, and blocks whose
+// width is not a multiple of 8 or that are a single row high, use the C code.
+#define TF_MAX_BLOCK 32
+
+static INLINE __m256i load_pixels_avx2(const void *src, int use_highbd) {
+  if (use_highbd) {
+    return _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)src));
+  }
+  return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)src));
+}
+
+// Returns x / 3 for any unsigned 32-bit x.
+static INLINE __m256i div3_epu32_avx2(__m256i x) {
+  const __m256i magic = _mm256_set1_epi32((int)0xAAAAAAAB);
+  const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, magic), 33);
+  const __m256i odd =
+      _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), magic), 33);
+  return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+}
+
+// Matches av1_temporal_filter_apply_c(). The filter strength of each pixel
+// comes from the sum of the squared differences in its 3x3 neighbourhood,
+// multiplied by 3 and divided by the number of neighbours inside the block.
+// That number is 9, 6 or 4, so the division is done as sum / 3, sum >> 1 and
+// (3 * sum) >> 2.
+static INLINE void temporal_filter_apply_avx2(
+    const void *frame1, unsigned int stride, const void *frame2,
+    unsigned int block_width, unsigned int block_height, int strength,
+    int filter_weight, unsigned int *accumulator, uint16_t *count,
+    int use_highbd) {
+  const int pixel_size = use_highbd ? 2 : 1;
+  const int w = (int)block_width;
+  const int h = (int)block_height;
+  const int w8 = w >> 3;
+  const __m128i shift = _mm_cvtsi32_si128(strength);
+  const __m256i rounding =
+      _mm256_set1_epi32(strength > 0 ? 1 << (strength - 1) : 0);
+  const __m256i sixteen = _mm256_set1_epi32(16);
+  const __m256i weight = _mm256_set1_epi32(filter_weight);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  // Horizontal 3-tap sums of the squared differences of each row.
+  __m256i row_sum[TF_MAX_BLOCK + 2][TF_MAX_BLOCK / 8];
+  DECLARE_ALIGNED(32, uint32_t, sq[TF_MAX_BLOCK + 2]);
+  __m256i col_edge[TF_MAX_BLOCK / 8];
+  int i, j;
+
+  for (j = 0; j < w8; ++j) {
+    const __m256i col = _mm256_add_epi32(_mm256_set1_epi32(j * 8), lane);
+    col_edge[j] =
+        _mm256_or_si256(_mm256_cmpeq_epi32(col, zero),
+                        _mm256_cmpeq_epi32(col, _mm256_set1_epi32(w - 1)));
+    row_sum[0][j] = zero;
+    row_sum[h + 1][j] = zero;
+  }
+
+  sq[0] = 0;
+  sq[w + 1] = 0;
+  for (i = 0; i < h; ++i) {
+    const uint8_t *src1 = (const uint8_t *)frame1 + i * stride * pixel_size;
+    const uint8_t *src2 = (const uint8_t *)frame2 + i * w * pixel_size;
+    for (j = 0; j < w8; ++j) {
+      const __m256i p1 =
+          load_pixels_avx2(src1 + j * 8 * pixel_size, use_highbd);
+      const __m256i p2 =
+          load_pixels_avx2(src2 + j * 8 * pixel_size, use_highbd);
+      const __m256i diff = _mm256_sub_epi32(p1, p2);
+      _mm256_storeu_si256((__m256i *)(sq + 1 + j * 8),
+                          _mm256_mullo_epi32(diff, diff));
+    }
+    for (j = 0; j < w8; ++j) {
+      const __m256i l = _mm256_loadu_si256((const __m256i *)(sq + j * 8));
+      const __m256i c = _mm256_loadu_si256((const __m256i *)(sq + j * 8 + 1));
+      const __m256i r = _mm256_loadu_si256((const __m256i *)(sq + j * 8 + 2));
+      row_sum[i + 1][j] = _mm256_add_epi32(_mm256_add_epi32(l, c), r);
+    }
+  }
+
+  for (i = 0; i < h; ++i) {
+    const uint8_t *src2 = (const uint8_t *)frame2 + i * w * pixel_size;
+    const int row_edge = i == 0 || i == h - 1;
+    for (j = 0; j < w8; ++j) {
+      const int k = i * w + j * 8;
+      const __m256i sum = _mm256_add_epi32(
+          _mm256_add_epi32(row_sum[i][j], row_sum[i + 1][j]),
+          row_sum[i + 2][j]);
+      const __m256i half = _mm256_srli_epi32(sum, 1);
+      __m256i modifier;
+      if (row_edge) {
+        const __m256i sum3 = _mm256_add_epi32(sum, _mm256_add_epi32(sum, sum));
+        const __m256i quarter3 = _mm256_srli_epi32(sum3, 2);
+        modifier = _mm256_blendv_epi8(half, quarter3, col_edge[j]);
+      } else {
+        modifier = _mm256_blendv_epi8(div3_epu32_avx2(sum), half, col_edge[j]);
+      }
+      modifier = _mm256_srl_epi32(_mm256_add_epi32(modifier, rounding), shift);
+      modifier = _mm256_min_epu32(modifier, sixteen);
+      modifier = _mm256_sub_epi32(sixteen, modifier);
+      modifier = _mm256_mullo_epi32(modifier, weight);
+
+      const __m256i pixel =
+          load_pixels_avx2(src2 + j * 8 * pixel_size, use_highbd);
+      const __m256i acc =
+          _mm256_loadu_si256((const __m256i *)(accumulator + k));
+      _mm256_storeu_si256(
+          (__m256i *)(accumulator + k),
+          _mm256_add_epi32(acc, _mm256_mullo_epi32(modifier, pixel)));
+
+      const __m128i cnt = _mm_loadu_si128((const __m128i *)(count + k));
+      const __m128i mod16 =
+          _mm_packus_epi32(_mm256_castsi256_si128(modifier),
+                           _mm256_extracti128_si256(modifier, 1));
+      _mm_storeu_si128((__m128i *)(count + k), _mm_add_epi16(cnt, mod16));
+    }
+  }
+}
+
+static INLINE int temporal_filter_use_simd(unsigned int block_width,
+                                           unsigned int block_height) {
+  return (block_width & 7) == 0 && block_width <= TF_MAX_BLOCK &&
+         block_height >= 2 && block_height <= TF_MAX_BLOCK;
+}
+
+void av1_temporal_filter_apply_avx2(uint8_t *frame1, unsigned int stride,
+                                    uint8_t *frame2, unsigned int block_width,
+                                    unsigned int block_height, int strength,
+                                    int filter_weight,
+                                    unsigned int *accumulator,
+                                    uint16_t *count) {
+  if (!temporal_filter_use_simd(block_width, block_height)) {
+    av1_temporal_filter_apply_c(frame1, stride, frame2, block_width,
+                                block_height, strength, filter_weight,
+                                accumulator, count);
+    return;
+  }
+  temporal_filter_apply_avx2(frame1, stride, frame2, block_width, block_height,
+                             strength, filter_weight, accumulator, count, 0);
+}
+
+void av1_highbd_temporal_filter_apply_avx2(
+    uint8_t *frame1, unsigned int stride, uint8_t *frame2,
+    unsigned int block_width, unsigned int block_height, int strength,
+    int filter_weight, unsigned int *accumulator, uint16_t *count) {
+  if (!temporal_filter_use_simd(block_width, block_height)) {
+    av1_highbd_temporal_filter_apply_c(frame1, stride, frame2, block_width,
+                                       block_height, strength, filter_weight,
+                                       accumulator, count);
+    return;
+  }
+  temporal_filter_apply_avx2(CONVERT_TO_SHORTPTR(frame1), stride,
+                             CONVERT_TO_SHORTPTR(frame2), block_width,
+                             block_height, strength, filter_weight,
+                             accumulator, count, 1);
+}
@@ -80,6 +80,7 @@ set(CONFIG_UNIT_TESTS 1 CACHE NUMBER "Enables unit tests.")
 set(CONFIG_ACCOUNTING 0 CACHE NUMBER "Enables bit accounting.")
 set(CONFIG_ANALYZER 0 CACHE NUMBER "Enables bit stream analyzer.")
 set(CONFIG_COEFFICIENT_RANGE_CHECKING 0 CACHE NUMBER "Coefficient range check.")
+set(CONFIG_EC_WINDOW64 0 CACHE NUMBER "64-bit entropy decoder window.")
 set(CONFIG_INSPECTION 0 CACHE NUMBER "Enables bitstream inspection.")
 set(CONFIG_INTERNAL_STATS 0 CACHE NUMBER "Codec stats.")
 set(CONFIG_LOWBITDEPTH 0 CACHE NUMBER "Enables 8-bit optimized pipeline.")
@@ -221,15 +221,21 @@ INSTANTIATE_TEST_CASE_P(SSE4_1, AV1HighbdInvHTNxN,
 #define PARAM_LIST_32X32                                   \
   &av1_fwd_txfm2d_32x32_c, &av1_inv_txfm2d_add_32x32_avx2, \
       &av1_inv_txfm2d_add_32x32_c, 1024
+#define PARAM_LIST_64X64_AVX2                              \
+  &av1_fwd_txfm2d_64x64_c, &av1_inv_txfm2d_add_64x64_avx2, \
+      &av1_inv_txfm2d_add_64x64_c, 4096
 
-const IHbdHtParam kArrayIhtParam32x32[] = {
+const IHbdHtParam kArrayIhtParamAvx2[] = {
   // 32x32
   make_tuple(PARAM_LIST_32X32, DCT_DCT, 10),
   make_tuple(PARAM_LIST_32X32, DCT_DCT, 12),
+  // 64x64
+  make_tuple(PARAM_LIST_64X64_AVX2, DCT_DCT, 10),
+  make_tuple(PARAM_LIST_64X64_AVX2, DCT_DCT, 12),
 };
 
 INSTANTIATE_TEST_CASE_P(AVX2, AV1HighbdInvHTNxN,
-                        ::testing::ValuesIn(kArrayIhtParam32x32));
+                        ::testing::ValuesIn(kArrayIhtParamAvx2));
 
 #endif  // HAVE_AVX2
 }  // namespace
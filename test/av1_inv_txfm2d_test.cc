@@ -347,4 +347,116 @@ INSTANTIATE_TEST_CASE_P(AVX2, AV1LbdInvTxfm2d,
                         ::testing::Values(av1_lowbd_inv_txfm2d_add_avx2));
 #endif  // HAVE_AVX2
 
+typedef void (*HbdInvTxfmAddFunc)(const tran_low_t *, uint8_t *, int,
+                                  const TxfmParam *);
+typedef std::tr1::tuple<HbdInvTxfmAddFunc> AV1HbdInvTxfmAddParam;
+
+// Checks a high bitdepth av1_highbd_inv_txfm_add() implementation against the
+// C 2D transforms for the sizes with a 64-point dimension, for every eob.
+class AV1HbdInvTxfmAdd
+    : public ::testing::TestWithParam<AV1HbdInvTxfmAddParam> {
+ public:
+  virtual void SetUp() { target_func_ = GET_PARAM(0); }
+
+  void RunCheck(TX_SIZE tx_size, int bd, int run_times);
+
+ private:
+  HbdInvTxfmAddFunc target_func_;
+};
+
+void AV1HbdInvTxfmAdd::RunCheck(TX_SIZE tx_size, int bd, int run_times) {
+  const TX_TYPE tx_type = DCT_DCT;
+  FwdTxfm2dFunc fwd_func = libaom_test::fwd_txfm_func_ls[tx_size];
+  InvTxfm2dFunc ref_func = libaom_test::inv_txfm_func_ls[tx_size];
+  const int BLK_WIDTH = 64;
+  const int BLK_SIZE = BLK_WIDTH * BLK_WIDTH;
+  DECLARE_ALIGNED(16, int16_t, input[BLK_SIZE]) = { 0 };
+  DECLARE_ALIGNED(32, int32_t, inv_input[BLK_SIZE]) = { 0 };
+  DECLARE_ALIGNED(32, uint16_t, output[BLK_SIZE]) = { 0 };
+  DECLARE_ALIGNED(32, uint16_t, ref_output[BLK_SIZE]) = { 0 };
+  const int stride = BLK_WIDTH;
+  const int rows = tx_size_high[tx_size];
+  const int cols = tx_size_wide[tx_size];
+  const int eobmax = AOMMIN(32, rows) * AOMMIN(32, cols);
+  const int16_t *scan = get_default_scan(tx_size, tx_type)->scan;
+  const int max_in = (1 << bd) - 1;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+
+  TxfmParam txfm_param;
+  txfm_param.tx_type = tx_type;
+  txfm_param.tx_size = tx_size;
+  txfm_param.lossless = 0;
+  txfm_param.bd = bd;
+  txfm_param.is_hbd = 1;
+  txfm_param.tx_set_type = EXT_TX_SET_DCTONLY;
+
+  run_times = AOMMAX(1, run_times / (rows * cols));
+  const int rand_times = run_times == 1 ? eobmax + 100 : 1;
+  for (int cnt = 0; cnt < rand_times; ++cnt) {
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < cols; ++c) {
+        const int residual = (cnt & 1) ? (rnd(2) ? max_in : -max_in)
+                                       : rnd(2 * max_in + 1) - max_in;
+        input[r * stride + c] = (cnt == 0) ? max_in : residual;
+        output[r * stride + c] = (cnt == 0) ? 0 : rnd.Rand16() & max_in;
+        ref_output[r * stride + c] = output[r * stride + c];
+      }
+    }
+    fwd_func(input, inv_input, stride, tx_type, bd);
+
+    // Zero the coefficients after eob in scan order.
+    const int eob = run_times == 1 ? AOMMIN(cnt + 1, eobmax) : eobmax;
+    for (int i = eob; i < eobmax; ++i) inv_input[scan[i]] = 0;
+    txfm_param.eob = eob;
+
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < run_times; ++i) {
+      ref_func(inv_input, ref_output, stride, tx_type, bd);
+    }
+    aom_usec_timer_mark(&timer);
+    const double time1 = static_cast<double>(aom_usec_timer_elapsed(&timer));
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < run_times; ++i) {
+      target_func_(inv_input, CONVERT_TO_BYTEPTR(output), stride, &txfm_param);
+    }
+    aom_usec_timer_mark(&timer);
+    const double time2 = static_cast<double>(aom_usec_timer_elapsed(&timer));
+    if (run_times > 1) {
+      printf("bd %2d %3dx%-3d eob %4d: %7.2f/%7.2fns (%3.2f)\n", bd, cols,
+             rows, eob, time1, time2, time1 / time2);
+    }
+    for (int r = 0; r < rows; ++r) {
+      for (int c = 0; c < cols; ++c) {
+        ASSERT_EQ(ref_output[r * stride + c], output[r * stride + c])
+            << "[" << r << "," << c << "] " << cnt
+            << " tx_size: " << static_cast<int>(tx_size) << " bd: " << bd
+            << " eob " << eob;
+      }
+    }
+  }
+}
+
+static const TX_SIZE kTxSize64[] = { TX_64X64, TX_32X64, TX_64X32, TX_16X64,
+                                     TX_64X16 };
+
+TEST_P(AV1HbdInvTxfmAdd, match) {
+  for (int bd = 8; bd <= 12; bd += 2) {
+    for (int i = 0; i < (int)(sizeof(kTxSize64) / sizeof(kTxSize64[0])); ++i) {
+      RunCheck(kTxSize64[i], bd, 1);
+    }
+  }
+}
+
+TEST_P(AV1HbdInvTxfmAdd, DISABLED_Speed) {
+  for (int i = 0; i < (int)(sizeof(kTxSize64) / sizeof(kTxSize64[0])); ++i) {
+    RunCheck(kTxSize64[i], 10, 10000000);
+  }
+}
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, AV1HbdInvTxfmAdd,
+                        ::testing::Values(av1_highbd_inv_txfm_add_avx2));
+#endif  // HAVE_AVX2
+
 }  // namespace
@@ -10,6 +10,7 @@
  */
 
 #include <math.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -19,11 +20,58 @@
 #include "aom/aom_integer.h"
 #include "aom_dsp/bitreader.h"
 #include "aom_dsp/bitwriter.h"
+#include "aom_ports/aom_timer.h"
 
 using libaom_test::ACMRandom;
 
 namespace {
 const int num_tests = 10;
+
+const int kNumSymbols = 16;
+
+// Fills cdf with a random inverse CDF of nsymbs symbols. With a small 'skew'
+// every symbol is about as likely, which costs about 4 bits per symbol with
+// kNumSymbols symbols.
+void RandomCdf(ACMRandom *rnd, int skew, int nsymbs, aom_cdf_prob *cdf) {
+  int weights[kNumSymbols];
+  int total = 0;
+  for (int i = 0; i < nsymbs; ++i) {
+    weights[i] = 64 + (*rnd)(1 + (i == 0 ? skew : 64));
+    total += weights[i];
+  }
+  int sum = 0;
+  for (int i = 0; i < nsymbs - 1; ++i) {
+    sum += weights[i];
+    cdf[i] = AOM_ICDF(sum * CDF_PROB_TOP / total);
+  }
+  cdf[nsymbs - 1] = AOM_ICDF(CDF_PROB_TOP);
+  cdf[nsymbs] = 0;
+}
+
+// Draws a symbol from the distribution of the inverse CDF cdf.
+int RandomSymbol(ACMRandom *rnd, const aom_cdf_prob *cdf) {
+  const int v = rnd->Rand16() >> 1;
+  int s = 0;
+  while (v >= CDF_PROB_TOP - cdf[s]) ++s;
+  return s;
+}
+
+// The scalar CDF adaptation of update_cdf().
+void UpdateCdfRef(aom_cdf_prob *cdf, int val, int nsymbs) {
+  static const int nsymbs2speed[17] = { 0, 0, 1, 1, 2, 2, 2, 2, 2,
+                                        2, 2, 2, 2, 2, 2, 2, 2 };
+  const int rate = 3 + (cdf[nsymbs] > 15) + (cdf[nsymbs] > 31) +
+                   nsymbs2speed[nsymbs];
+  for (int i = 0; i < nsymbs - 1; ++i) {
+    const int tmp = (i < val) ? AOM_ICDF(0) : 0;
+    if (tmp < cdf[i]) {
+      cdf[i] -= ((cdf[i] - tmp) >> rate);
+    } else {
+      cdf[i] += ((tmp - cdf[i]) >> rate);
+    }
+  }
+  cdf[nsymbs] += (cdf[nsymbs] < 32);
+}
 }  // namespace
 
 TEST(AV1, TestBitIO) {
@@ -132,3 +180,119 @@ TEST(AV1, TestTell) {
         << " frac_diff_total: " << frac_diff_total;
   }
 }
+
+// Streams of a few bytes only use the byte-wise refill of the decoder, longer
+// ones also the multi-byte one.
+TEST(AV1, TestSymbolIO) {
+  const int kMaxSymbols = 4096;
+  const int kBufferSize = kMaxSymbols;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int n = 1; n <= kMaxSymbols; n += (n < 64) ? 1 : n) {
+    for (int skew = 0; skew <= 8192; skew += 4096) {
+      aom_cdf_prob enc_cdf[kNumSymbols + 1];
+      aom_cdf_prob dec_cdf[kNumSymbols + 1];
+      int symbols[kMaxSymbols];
+      uint8_t bw_buffer[kBufferSize];
+      aom_writer bw;
+
+      RandomCdf(&rnd, skew, kNumSymbols, enc_cdf);
+      memcpy(dec_cdf, enc_cdf, sizeof(enc_cdf));
+      aom_start_encode(&bw, bw_buffer);
+      bw.allow_update_cdf = 1;
+      for (int i = 0; i < n; ++i) {
+        symbols[i] = RandomSymbol(&rnd, enc_cdf);
+        aom_write_symbol(&bw, symbols[i], enc_cdf, kNumSymbols);
+      }
+      aom_stop_encode(&bw);
+
+      aom_reader br;
+      aom_reader_init(&br, bw_buffer, bw.pos);
+      br.allow_update_cdf = 1;
+      for (int i = 0; i < n; ++i) {
+        GTEST_ASSERT_EQ(aom_read_symbol(&br, dec_cdf, kNumSymbols, NULL),
+                        symbols[i])
+            << "pos: " << i << " / " << n << " skew: " << skew;
+      }
+      EXPECT_EQ(0, aom_reader_has_error(&br));
+    }
+  }
+}
+
+// The decoder searches the CDF and update_cdf() adapts it several symbols at
+// a time, using overlapping loads for the symbol counts that are not a
+// multiple of the vector width.
+TEST(AV1, TestSymbolIOAllSizes) {
+  const int kSymbols = 2000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  for (int nsymbs = 2; nsymbs <= kNumSymbols; ++nsymbs) {
+    for (int skew = 0; skew <= 8192; skew += 8192) {
+      // Guard entries after the CDF catch writes past the counter.
+      aom_cdf_prob enc_cdf[kNumSymbols + 2];
+      aom_cdf_prob dec_cdf[kNumSymbols + 2];
+      aom_cdf_prob ref_cdf[kNumSymbols + 2];
+      int symbols[kSymbols];
+      uint8_t bw_buffer[kSymbols * 4];
+      aom_writer bw;
+
+      RandomCdf(&rnd, skew, nsymbs, enc_cdf);
+      for (int i = nsymbs + 1; i < kNumSymbols + 2; ++i) enc_cdf[i] = 0xdead;
+      memcpy(dec_cdf, enc_cdf, sizeof(enc_cdf));
+      memcpy(ref_cdf, enc_cdf, sizeof(enc_cdf));
+      aom_start_encode(&bw, bw_buffer);
+      bw.allow_update_cdf = 1;
+      for (int i = 0; i < kSymbols; ++i) {
+        symbols[i] = RandomSymbol(&rnd, enc_cdf);
+        aom_write_symbol(&bw, symbols[i], enc_cdf, nsymbs);
+        UpdateCdfRef(ref_cdf, symbols[i], nsymbs);
+        ASSERT_EQ(0, memcmp(enc_cdf, ref_cdf, sizeof(enc_cdf)))
+            << "pos: " << i << " nsymbs: " << nsymbs << " skew: " << skew;
+      }
+      aom_stop_encode(&bw);
+
+      aom_reader br;
+      aom_reader_init(&br, bw_buffer, bw.pos);
+      br.allow_update_cdf = 1;
+      for (int i = 0; i < kSymbols; ++i) {
+        GTEST_ASSERT_EQ(aom_read_symbol(&br, dec_cdf, nsymbs, NULL),
+                        symbols[i])
+            << "pos: " << i << " nsymbs: " << nsymbs << " skew: " << skew;
+      }
+      EXPECT_EQ(0, aom_reader_has_error(&br));
+      EXPECT_EQ(0, memcmp(dec_cdf, ref_cdf, sizeof(dec_cdf)));
+    }
+  }
+}
+
+TEST(AV1, DISABLED_SymbolDecodeSpeed) {
+  const int kSymbols = 1 << 20;
+  const int kRuns = 20;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  aom_cdf_prob cdf[kNumSymbols + 1];
+  uint8_t *const buffer = new uint8_t[kSymbols];
+  aom_writer bw;
+
+  RandomCdf(&rnd, 0, kNumSymbols, cdf);
+  aom_start_encode(&bw, buffer);
+  bw.allow_update_cdf = 0;
+  for (int i = 0; i < kSymbols; ++i)
+    aom_write_cdf(&bw, RandomSymbol(&rnd, cdf), cdf, kNumSymbols);
+  aom_stop_encode(&bw);
+
+  int checksum = 0;
+  aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  for (int run = 0; run < kRuns; ++run) {
+    aom_reader br;
+    aom_reader_init(&br, buffer, bw.pos);
+    br.allow_update_cdf = 0;
+    for (int i = 0; i < kSymbols; ++i)
+      checksum += aom_read_cdf(&br, cdf, kNumSymbols, NULL);
+  }
+  aom_usec_timer_mark(&timer);
+  const double elapsed = static_cast<double>(aom_usec_timer_elapsed(&timer));
+  printf("%d symbols in %u bytes, %d runs: %.2f ns/symbol, %.1f MB/s "
+         "(checksum %d)\n",
+         kSymbols, bw.pos, kRuns, elapsed * 1000 / (kSymbols * kRuns),
+         static_cast<double>(bw.pos) * kRuns / elapsed, checksum);
+  delete[] buffer;
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./av1_rtcd.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+#include "aom_ports/mem.h"
+#include "av1/common/blockd.h"
+#include "av1/common/common_data.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+
+typedef void (*DrPredZ1Func)(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                             const uint8_t *above, const uint8_t *left,
+                             int upsample_above, int dx, int dy);
+typedef void (*DrPredZ2Func)(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                             const uint8_t *above, const uint8_t *left,
+                             int upsample_above, int upsample_left, int dx,
+                             int dy);
+typedef void (*DrPredZ3Func)(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                             const uint8_t *above, const uint8_t *left,
+                             int upsample_left, int dx, int dy);
+
+typedef void (*HighbdDrPredZ1Func)(uint16_t *dst, ptrdiff_t stride, int bw,
+                                   int bh, const uint16_t *above,
+                                   const uint16_t *left, int upsample_above,
+                                   int dx, int dy, int bd);
+typedef void (*HighbdDrPredZ2Func)(uint16_t *dst, ptrdiff_t stride, int bw,
+                                   int bh, const uint16_t *above,
+                                   const uint16_t *left, int upsample_above,
+                                   int upsample_left, int dx, int dy, int bd);
+typedef void (*HighbdDrPredZ3Func)(uint16_t *dst, ptrdiff_t stride, int bw,
+                                   int bh, const uint16_t *above,
+                                   const uint16_t *left, int upsample_left,
+                                   int dx, int dy, int bd);
+
+struct DrPredFuncs {
+  DrPredZ1Func z1;
+  DrPredZ2Func z2;
+  DrPredZ3Func z3;
+};
+
+struct HighbdDrPredFuncs {
+  HighbdDrPredZ1Func z1;
+  HighbdDrPredZ2Func z2;
+  HighbdDrPredZ3Func z3;
+};
+
+template <typename Funcs>
+struct DrPredParam {
+  Funcs ref;
+  Funcs tst;
+  int bit_depth;
+};
+
+const int kDstStride = MAX_TX_SIZE;
+// The edges hold the above-left pixel, two upsampled edges of the largest
+// block and room for over-reads past max_base.
+const int kEdgeOffset = 16;
+const int kEdgeSize = kEdgeOffset + 4 * MAX_TX_SIZE + 16;
+// The number of random edges tried for a 16x16 block. Smaller blocks try more
+// and larger ones fewer, down to kMinNumTests.
+const int kNumTests = 32;
+const int kMinNumTests = 4;
+
+// The nominal angles of the directional modes, each used with the angle
+// deltas -3..3 in steps of 3 degrees.
+const int kBaseAngles[] = { 45, 67, 90, 113, 135, 157, 180, 203 };
+const int kNumAngles =
+    7 * static_cast<int>(sizeof(kBaseAngles) / sizeof(kBaseAngles[0]));
+
+int GetAngle(int i) { return kBaseAngles[i / 7] + 3 * (i % 7 - 3); }
+
+// Whether the above (or left) edge of a bw x bh block may be upsampled for a
+// prediction angle d degrees away from the vertical (or horizontal), see
+// use_intra_edge_upsample() in reconintra.c.
+int CanUpsample(int bw, int bh, int d) {
+  return bw + bh <= 16 && d > 0 && d < 40;
+}
+
+void DrPredict(const DrPredFuncs &funcs, uint8_t *dst, int bw, int bh,
+               const uint8_t *above, const uint8_t *left, int angle,
+               int upsample_above, int upsample_left, int bd) {
+  (void)bd;
+  if (angle < 90) {
+    funcs.z1(dst, kDstStride, bw, bh, above, left, upsample_above,
+             dr_intra_derivative[angle], 1);
+  } else if (angle < 180) {
+    funcs.z2(dst, kDstStride, bw, bh, above, left, upsample_above,
+             upsample_left, dr_intra_derivative[180 - angle],
+             dr_intra_derivative[angle - 90]);
+  } else {
+    funcs.z3(dst, kDstStride, bw, bh, above, left, upsample_left, 1,
+             dr_intra_derivative[270 - angle]);
+  }
+}
+
+void DrPredict(const HighbdDrPredFuncs &funcs, uint16_t *dst, int bw, int bh,
+               const uint16_t *above, const uint16_t *left, int angle,
+               int upsample_above, int upsample_left, int bd) {
+  if (angle < 90) {
+    funcs.z1(dst, kDstStride, bw, bh, above, left, upsample_above,
+             dr_intra_derivative[angle], 1, bd);
+  } else if (angle < 180) {
+    funcs.z2(dst, kDstStride, bw, bh, above, left, upsample_above,
+             upsample_left, dr_intra_derivative[180 - angle],
+             dr_intra_derivative[angle - 90], bd);
+  } else {
+    funcs.z3(dst, kDstStride, bw, bh, above, left, upsample_left, 1,
+             dr_intra_derivative[270 - angle], bd);
+  }
+}
+
+template <typename Pixel, typename Funcs>
+class DrPredTest : public ::testing::TestWithParam<DrPredParam<Funcs> > {
+ protected:
+  virtual void SetUp() {
+    params_ = this->GetParam();
+    mask_ = (1 << params_.bit_depth) - 1;
+    above_ = above_mem_ + kEdgeOffset;
+    left_ = left_mem_ + kEdgeOffset;
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+  // Compares the predictions of every transform size, angle and allowed
+  // upsampling of the edges for a number of random edges.
+  void RunTest() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    for (int tx_size = 0; tx_size < TX_SIZES_ALL; ++tx_size) {
+      const int bw = tx_size_wide[tx_size];
+      const int bh = tx_size_high[tx_size];
+      const int num_tests =
+          AOMMAX(kMinNumTests, kNumTests * 16 * 16 / (bw * bh));
+      for (int n = 0; n < num_tests; ++n) {
+        // Try first with saturated edges.
+        for (int i = 0; i < kEdgeSize; ++i) {
+          above_mem_[i] = n ? rnd.Rand16() & mask_ : mask_;
+          left_mem_[i] = n ? rnd.Rand16() & mask_ : mask_;
+        }
+        for (int i = 0; i < kNumAngles; ++i) {
+          const int angle = GetAngle(i);
+          if (angle == 90 || angle == 180) continue;
+          const int max_upsample_above =
+              angle < 180 && CanUpsample(bw, bh, abs(angle - 90));
+          const int max_upsample_left =
+              angle > 90 && CanUpsample(bw, bh, abs(angle - 180));
+          for (int upsample_above = 0; upsample_above <= max_upsample_above;
+               ++upsample_above) {
+            for (int upsample_left = 0; upsample_left <= max_upsample_left;
+                 ++upsample_left) {
+              CheckPrediction(tx_size, angle, upsample_above, upsample_left);
+              if (::testing::Test::HasFatalFailure()) return;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  void CheckPrediction(int tx_size, int angle, int upsample_above,
+                       int upsample_left) {
+    const int bw = tx_size_wide[tx_size];
+    const int bh = tx_size_high[tx_size];
+    memset(ref_dst_, 0, sizeof(ref_dst_));
+    memset(tst_dst_, 0, sizeof(tst_dst_));
+    DrPredict(params_.ref, ref_dst_, bw, bh, above_, left_, angle,
+              upsample_above, upsample_left, params_.bit_depth);
+    ASM_REGISTER_STATE_CHECK(DrPredict(params_.tst, tst_dst_, bw, bh, above_,
+                                       left_, angle, upsample_above,
+                                       upsample_left, params_.bit_depth));
+    for (int r = 0; r < bh; ++r) {
+      for (int c = 0; c < bw; ++c) {
+        ASSERT_EQ(ref_dst_[r * kDstStride + c], tst_dst_[r * kDstStride + c])
+            << bw << "x" << bh << " angle " << angle << " upsample "
+            << upsample_above << "/" << upsample_left << " at (" << r << ", "
+            << c << ")";
+      }
+    }
+  }
+
+  DECLARE_ALIGNED(16, Pixel, above_mem_[kEdgeSize]);
+  DECLARE_ALIGNED(16, Pixel, left_mem_[kEdgeSize]);
+  DECLARE_ALIGNED(16, Pixel, ref_dst_[MAX_TX_SQUARE]);
+  DECLARE_ALIGNED(16, Pixel, tst_dst_[MAX_TX_SQUARE]);
+  Pixel *above_;
+  Pixel *left_;
+  int mask_;
+
+  DrPredParam<Funcs> params_;
+};
+
+typedef DrPredTest<uint8_t, DrPredFuncs> LowbdDrPredTest;
+typedef DrPredTest<uint16_t, HighbdDrPredFuncs> HighbdDrPredTest;
+
+TEST_P(LowbdDrPredTest, MatchesC) { RunTest(); }
+
+TEST_P(HighbdDrPredTest, MatchesC) { RunTest(); }
+
+const DrPredFuncs kDrPredC = { av1_dr_prediction_z1_c, av1_dr_prediction_z2_c,
+                               av1_dr_prediction_z3_c };
+const HighbdDrPredFuncs kHighbdDrPredC = { av1_highbd_dr_prediction_z1_c,
+                                           av1_highbd_dr_prediction_z2_c,
+                                           av1_highbd_dr_prediction_z3_c };
+
+#if HAVE_SSE4_1
+const DrPredParam<DrPredFuncs> kDrPredSse4_1[] = {
+  { kDrPredC,
+    { av1_dr_prediction_z1_sse4_1, av1_dr_prediction_z2_sse4_1,
+      av1_dr_prediction_z3_sse4_1 },
+    8 },
+};
+
+INSTANTIATE_TEST_CASE_P(SSE4_1, LowbdDrPredTest,
+                        ::testing::ValuesIn(kDrPredSse4_1));
+
+const HighbdDrPredFuncs kHighbdDrPredSse4_1 = {
+  av1_highbd_dr_prediction_z1_sse4_1, av1_highbd_dr_prediction_z2_sse4_1,
+  av1_highbd_dr_prediction_z3_sse4_1
+};
+
+const DrPredParam<HighbdDrPredFuncs> kHighbdDrPredParamsSse4_1[] = {
+  { kHighbdDrPredC, kHighbdDrPredSse4_1, 8 },
+  { kHighbdDrPredC, kHighbdDrPredSse4_1, 10 },
+  { kHighbdDrPredC, kHighbdDrPredSse4_1, 12 },
+};
+
+INSTANTIATE_TEST_CASE_P(SSE4_1, HighbdDrPredTest,
+                        ::testing::ValuesIn(kHighbdDrPredParamsSse4_1));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+const DrPredParam<DrPredFuncs> kDrPredAvx2[] = {
+  { kDrPredC,
+    { av1_dr_prediction_z1_avx2, av1_dr_prediction_z2_avx2,
+      av1_dr_prediction_z3_avx2 },
+    8 },
+};
+
+INSTANTIATE_TEST_CASE_P(AVX2, LowbdDrPredTest,
+                        ::testing::ValuesIn(kDrPredAvx2));
+
+const HighbdDrPredFuncs kHighbdDrPredAvx2 = { av1_highbd_dr_prediction_z1_avx2,
+                                              av1_highbd_dr_prediction_z2_avx2,
+                                              av1_highbd_dr_prediction_z3_avx2 };
+
+const DrPredParam<HighbdDrPredFuncs> kHighbdDrPredParamsAvx2[] = {
+  { kHighbdDrPredC, kHighbdDrPredAvx2, 8 },
+  { kHighbdDrPredC, kHighbdDrPredAvx2, 10 },
+  { kHighbdDrPredC, kHighbdDrPredAvx2, 12 },
+};
+
+INSTANTIATE_TEST_CASE_P(AVX2, HighbdDrPredTest,
+                        ::testing::ValuesIn(kHighbdDrPredParamsAvx2));
+#endif  // HAVE_AVX2
+
+}  // namespace
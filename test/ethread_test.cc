@@ -190,6 +190,29 @@ AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadTestLarge,
                                             ::libaom_test::kOnePassGood),
                           ::testing::Range(0, 2));
 
+// Encodes a single tile column with the superblock rows in parallel. Two tile
+// rows check the hand over of the above context between tiles.
+class AVxEncoderThreadRowMTTest : public AVxEncoderThreadTest {
+  virtual void SetTileSize(libaom_test::Encoder *encoder) {
+    encoder->Control(AV1E_SET_TILE_COLUMNS, 0);
+    encoder->Control(AV1E_SET_TILE_ROWS, 1);
+    encoder->Control(AV1E_SET_ROW_MT, 1);
+  }
+};
+
+TEST_P(AVxEncoderThreadRowMTTest, EncoderResultTest) {
+#if CONFIG_AV1
+  cfg_.large_scale_tile = 0;
+  decoder_->Control(AV1_SET_TILE_MODE, 0);
+#endif  // CONFIG_AV1
+  DoTest();
+}
+
+AV1_INSTANTIATE_TEST_CASE(AVxEncoderThreadRowMTTest,
+                          ::testing::Values(::libaom_test::kTwoPassGood,
+                                            ::libaom_test::kOnePassGood),
+                          ::testing::Range(2, 4));
+
 #if CONFIG_AV1
 class AVxEncoderThreadLSTest : public AVxEncoderThreadTest {
   virtual void SetTileSize(libaom_test::Encoder *encoder) {
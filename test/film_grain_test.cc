@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_dsp_rtcd.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+
+#include "aom_dsp/grain_synthesis.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+using std::tr1::make_tuple;
+using std::tr1::tuple;
+
+typedef void (*AddNoiseLumaFunc)(uint8_t *luma, int luma_stride,
+                                 const int *grain, int grain_stride, int width,
+                                 int height,
+                                 const aom_grain_noise_params_t *params);
+typedef void (*AddNoiseChromaFunc)(uint8_t *chroma, int chroma_stride,
+                                   const uint8_t *luma, int luma_stride,
+                                   const int *grain, int grain_stride,
+                                   int width, int height, int plane,
+                                   const aom_grain_noise_params_t *params);
+typedef void (*HighbdAddNoiseLumaFunc)(uint16_t *luma, int luma_stride,
+                                       const int *grain, int grain_stride,
+                                       int width, int height,
+                                       const aom_grain_noise_params_t *params);
+typedef void (*HighbdAddNoiseChromaFunc)(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height, int plane,
+    const aom_grain_noise_params_t *params);
+typedef void (*ArSumAboveFunc)(int *wsum, const int *grain, int grain_stride,
+                               int width, const int *coeffs, int lag);
+
+// The kernels are called on blocks of up to 32x32 pixels.
+const int kMaxBlockSize = 32;
+const int kStride = 2 * kMaxBlockSize + 8;
+const int kBufSize = kStride * 2 * kMaxBlockSize;
+const int kIterations = 1000;
+
+// Random noise parameters for the given bit depth and chroma subsampling.
+// The scaling functions point to luts.
+void RandomNoiseParams(ACMRandom *rnd, int bit_depth, int subsamp_x,
+                       int subsamp_y, std::vector<int> *luts,
+                       aom_grain_noise_params_t *params) {
+  const int max_pixel = (1 << bit_depth) - 1;
+  for (int plane = 0; plane < 3; ++plane) {
+    luts[plane].resize(max_pixel + 1);
+    for (int i = 0; i <= max_pixel; ++i) luts[plane][i] = rnd->Rand8();
+    params->scaling_lut[plane] = &luts[plane][0];
+    params->luma_mult[plane] = plane ? rnd->Rand8() - 128 : 0;
+    params->mult[plane] = plane ? rnd->Rand8() - 128 : 0;
+    params->offset[plane] =
+        plane ? (rnd->PseudoUniform(512) << (bit_depth - 8)) - (1 << bit_depth)
+              : 0;
+    const bool restricted = rnd->Rand8() & 1;
+    params->min_val[plane] = restricted ? 16 << (bit_depth - 8) : 0;
+    params->max_val[plane] =
+        restricted ? (plane ? 240 : 235) << (bit_depth - 8) : max_pixel;
+  }
+  params->scaling_shift = 8 + rnd->PseudoUniform(4);
+  params->max_pixel = max_pixel;
+  params->chroma_subsamp_x = subsamp_x;
+  params->chroma_subsamp_y = subsamp_y;
+}
+
+// Grain values as generated for the given bit depth.
+void RandomGrain(ACMRandom *rnd, int bit_depth, int *grain) {
+  const int grain_center = 128 << (bit_depth - 8);
+  for (int i = 0; i < kBufSize; ++i)
+    grain[i] = rnd->PseudoUniform(2 * grain_center) - grain_center;
+}
+
+template <typename Pixel>
+void RandomPixels(ACMRandom *rnd, int bit_depth, Pixel *buf) {
+  for (int i = 0; i < kBufSize; ++i)
+    buf[i] = rnd->Rand16() & ((1 << bit_depth) - 1);
+}
+
+// Test parameter list:
+//  <luma_func, chroma_func>
+typedef tuple<AddNoiseLumaFunc, AddNoiseChromaFunc> AddNoiseParam;
+
+class AddNoiseTest : public ::testing::TestWithParam<AddNoiseParam> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const AddNoiseLumaFunc luma_func = GET_PARAM(0);
+    const AddNoiseChromaFunc chroma_func = GET_PARAM(1);
+    std::vector<int> luts[3];
+    aom_grain_noise_params_t params;
+    int grain[kBufSize];
+    uint8_t luma[kBufSize], ref[kBufSize], tst[kBufSize];
+
+    for (int iter = 0; iter < kIterations; ++iter) {
+      const int subsamp_x = rnd.Rand8() & 1;
+      const int subsamp_y = subsamp_x & rnd.Rand8();
+      const int width = 1 + rnd.PseudoUniform(kMaxBlockSize >> subsamp_x);
+      const int height = 1 + rnd.PseudoUniform(kMaxBlockSize >> subsamp_y);
+      const int plane = 1 + (rnd.Rand8() & 1);
+      RandomNoiseParams(&rnd, 8, subsamp_x, subsamp_y, luts, &params);
+      RandomGrain(&rnd, 8, grain);
+      RandomPixels(&rnd, 8, luma);
+      RandomPixels(&rnd, 8, ref);
+      memcpy(tst, ref, sizeof(tst));
+
+      aom_add_noise_chroma_c(ref, kStride, luma, kStride, grain, kStride,
+                             width, height, plane, &params);
+      ASM_REGISTER_STATE_CHECK(chroma_func(tst, kStride, luma, kStride, grain,
+                                           kStride, width, height, plane,
+                                           &params));
+      ASSERT_EQ(0, memcmp(ref, tst, sizeof(ref))) << "chroma, iter " << iter;
+
+      aom_add_noise_luma_c(ref, kStride, grain, kStride, width, height,
+                           &params);
+      ASM_REGISTER_STATE_CHECK(
+          luma_func(tst, kStride, grain, kStride, width, height, &params));
+      ASSERT_EQ(0, memcmp(ref, tst, sizeof(ref))) << "luma, iter " << iter;
+    }
+  }
+};
+
+TEST_P(AddNoiseTest, RandomValues) { RunCheckOutput(); }
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(SSE4_1, AddNoiseTest,
+                        ::testing::Values(make_tuple(
+                            aom_add_noise_luma_sse4_1,
+                            aom_add_noise_chroma_sse4_1)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, AddNoiseTest,
+                        ::testing::Values(make_tuple(
+                            aom_add_noise_luma_avx2,
+                            aom_add_noise_chroma_avx2)));
+#endif
+
+// Test parameter list:
+//  <luma_func, chroma_func, bit_depth>
+typedef tuple<HighbdAddNoiseLumaFunc, HighbdAddNoiseChromaFunc, int>
+    HighbdAddNoiseParam;
+
+class HighbdAddNoiseTest
+    : public ::testing::TestWithParam<HighbdAddNoiseParam> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const HighbdAddNoiseLumaFunc luma_func = GET_PARAM(0);
+    const HighbdAddNoiseChromaFunc chroma_func = GET_PARAM(1);
+    const int bit_depth = GET_PARAM(2);
+    std::vector<int> luts[3];
+    aom_grain_noise_params_t params;
+    int grain[kBufSize];
+    uint16_t luma[kBufSize], ref[kBufSize], tst[kBufSize];
+
+    for (int iter = 0; iter < kIterations; ++iter) {
+      const int subsamp_x = rnd.Rand8() & 1;
+      const int subsamp_y = subsamp_x & rnd.Rand8();
+      const int width = 1 + rnd.PseudoUniform(kMaxBlockSize >> subsamp_x);
+      const int height = 1 + rnd.PseudoUniform(kMaxBlockSize >> subsamp_y);
+      const int plane = 1 + (rnd.Rand8() & 1);
+      RandomNoiseParams(&rnd, bit_depth, subsamp_x, subsamp_y, luts, &params);
+      RandomGrain(&rnd, bit_depth, grain);
+      RandomPixels(&rnd, bit_depth, luma);
+      RandomPixels(&rnd, bit_depth, ref);
+      memcpy(tst, ref, sizeof(tst));
+
+      aom_highbd_add_noise_chroma_c(ref, kStride, luma, kStride, grain,
+                                    kStride, width, height, plane, &params);
+      ASM_REGISTER_STATE_CHECK(chroma_func(tst, kStride, luma, kStride, grain,
+                                           kStride, width, height, plane,
+                                           &params));
+      ASSERT_EQ(0, memcmp(ref, tst, sizeof(ref))) << "chroma, iter " << iter;
+
+      aom_highbd_add_noise_luma_c(ref, kStride, grain, kStride, width, height,
+                                  &params);
+      ASM_REGISTER_STATE_CHECK(
+          luma_func(tst, kStride, grain, kStride, width, height, &params));
+      ASSERT_EQ(0, memcmp(ref, tst, sizeof(ref))) << "luma, iter " << iter;
+    }
+  }
+};
+
+TEST_P(HighbdAddNoiseTest, RandomValues) { RunCheckOutput(); }
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, HighbdAddNoiseTest,
+    ::testing::Combine(::testing::Values(aom_highbd_add_noise_luma_sse4_1),
+                       ::testing::Values(aom_highbd_add_noise_chroma_sse4_1),
+                       ::testing::Values(10, 12)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, HighbdAddNoiseTest,
+    ::testing::Combine(::testing::Values(aom_highbd_add_noise_luma_avx2),
+                       ::testing::Values(aom_highbd_add_noise_chroma_avx2),
+                       ::testing::Values(10, 12)));
+#endif
+
+// The AR filter runs on rows of up to 76 samples, with up to 3 rows and
+// 3 columns of taps on each side.
+const int kArMaxLag = 3;
+const int kArMaxWidth = 76;
+const int kArStride = kArMaxWidth + 2 * kArMaxLag;
+
+class ArSumAboveTest : public ::testing::TestWithParam<ArSumAboveFunc> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const ArSumAboveFunc func = GetParam();
+    int grain[(kArMaxLag + 1) * kArStride];
+    int coeffs[kArMaxLag * (2 * kArMaxLag + 1)];
+    int ref[kArMaxWidth], tst[kArMaxWidth];
+    const int *const row = grain + kArMaxLag * kArStride + kArMaxLag;
+
+    for (int iter = 0; iter < kIterations; ++iter) {
+      const int lag = iter % (kArMaxLag + 1);
+      const int width = 1 + rnd.PseudoUniform(kArMaxWidth);
+      // 12-bit grain and the full range of the coefficients.
+      for (int i = 0; i < (kArMaxLag + 1) * kArStride; ++i)
+        grain[i] = rnd.PseudoUniform(4096) - 2048;
+      for (int i = 0; i < kArMaxLag * (2 * kArMaxLag + 1); ++i)
+        coeffs[i] = rnd.Rand8() - 128;
+      memset(ref, 0, sizeof(ref));
+      memset(tst, 0, sizeof(tst));
+
+      aom_grain_ar_sum_above_c(ref, row, kArStride, width, coeffs, lag);
+      ASM_REGISTER_STATE_CHECK(func(tst, row, kArStride, width, coeffs, lag));
+      ASSERT_EQ(0, memcmp(ref, tst, sizeof(ref)))
+          << "lag " << lag << ", width " << width << ", iter " << iter;
+    }
+  }
+};
+
+TEST_P(ArSumAboveTest, RandomValues) { RunCheckOutput(); }
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(SSE4_1, ArSumAboveTest,
+                        ::testing::Values(aom_grain_ar_sum_above_sse4_1));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, ArSumAboveTest,
+                        ::testing::Values(aom_grain_ar_sum_above_avx2));
+#endif
+
+// Grain parameters with luma grain and chroma scaled from luma.
+void SetGrainParams(ACMRandom *rnd, int bit_depth, aom_film_grain_t *params) {
+  memset(params, 0, sizeof(*params));
+  params->apply_grain = 1;
+  params->bit_depth = bit_depth;
+  params->num_y_points = 2;
+  params->scaling_points_y[0][0] = 0;
+  params->scaling_points_y[0][1] = 20;
+  params->scaling_points_y[1][0] = 255;
+  params->scaling_points_y[1][1] = 60;
+  params->chroma_scaling_from_luma = 1;
+  params->scaling_shift = 8;
+  params->ar_coeff_lag = 2;
+  for (int i = 0; i < 12; ++i) params->ar_coeffs_y[i] = rnd->Rand8() - 128;
+  params->ar_coeff_shift = 7;
+  params->overlap_flag = 1;
+}
+
+// The grain added with several threads must match the grain added by one.
+TEST(FilmGrainSynthTest, ThreadsMatchSingleThread) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const int kWidth = 352;
+  const int kHeight = 290;
+  aom_film_grain_t params;
+  SetGrainParams(&rnd, 8, &params);
+
+  std::vector<uint8_t> planes[2][3];
+  for (int i = 0; i < 3; ++i) {
+    planes[0][i].resize(kWidth * kHeight);
+    for (size_t j = 0; j < planes[0][i].size(); ++j)
+      planes[0][i][j] = rnd.Rand8();
+    planes[1][i] = planes[0][i];
+  }
+
+  aom_film_grain_synth_t *const synth1 = av1_film_grain_synth_alloc(1);
+  aom_film_grain_synth_t *const synth4 = av1_film_grain_synth_alloc(4);
+  ASSERT_TRUE(synth1 != NULL);
+  ASSERT_TRUE(synth4 != NULL);
+  for (int frame = 0; frame < 3; ++frame) {
+    params.random_seed += 3245;
+    ASSERT_EQ(0, av1_add_film_grain_run(synth1, &params, &planes[0][0][0],
+                                        &planes[0][1][0], &planes[0][2][0],
+                                        kHeight, kWidth, kWidth, kWidth / 2, 0,
+                                        1, 1));
+    ASSERT_EQ(0, av1_add_film_grain_run(synth4, &params, &planes[1][0][0],
+                                        &planes[1][1][0], &planes[1][2][0],
+                                        kHeight, kWidth, kWidth, kWidth / 2, 0,
+                                        1, 1));
+    for (int i = 0; i < 3; ++i)
+      ASSERT_TRUE(planes[0][i] == planes[1][i]) << "frame " << frame;
+  }
+  av1_film_grain_synth_free(synth1);
+  av1_film_grain_synth_free(synth4);
+}
+
+// Adding the grain in place must match adding it to a copy, including the
+// repeated last column and row of an odd sized image.
+TEST(FilmGrainSynthTest, InPlaceMatchesCopy) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const int kWidth = 171;
+  const int kHeight = 97;
+  aom_film_grain_t params;
+  SetGrainParams(&rnd, 10, &params);
+
+  aom_image_t *const src =
+      aom_img_alloc(NULL, AOM_IMG_FMT_I42016, kWidth + 1, kHeight + 1, 16);
+  aom_image_t *const dst =
+      aom_img_alloc(NULL, AOM_IMG_FMT_I42016, kWidth + 1, kHeight + 1, 16);
+  ASSERT_TRUE(src != NULL);
+  ASSERT_TRUE(dst != NULL);
+  ASSERT_EQ(0, aom_img_set_rect(src, 0, 0, kWidth, kHeight));
+  src->bit_depth = dst->bit_depth = 10;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int h = aom_img_plane_height(src, plane);
+    const int w = aom_img_plane_width(src, plane);
+    for (int y = 0; y < h; ++y) {
+      uint16_t *const row = reinterpret_cast<uint16_t *>(
+          src->planes[plane] + y * src->stride[plane]);
+      for (int x = 0; x < w; ++x) row[x] = rnd.Rand16() & 1023;
+    }
+  }
+
+  aom_film_grain_synth_t *const synth = av1_film_grain_synth_alloc(2);
+  ASSERT_TRUE(synth != NULL);
+  ASSERT_EQ(0, av1_add_film_grain(synth, &params, src, dst));
+  ASSERT_EQ(0, av1_add_film_grain(synth, &params, src, src));
+  for (int plane = 0; plane < 3; ++plane) {
+    const int h = aom_img_plane_height(src, plane);
+    const int w = aom_img_plane_width(src, plane);
+    for (int y = 0; y < h; ++y) {
+      ASSERT_EQ(0, memcmp(src->planes[plane] + y * src->stride[plane],
+                          dst->planes[plane] + y * dst->stride[plane],
+                          w * sizeof(uint16_t)))
+          << "plane " << plane << " row " << y;
+    }
+  }
+  av1_film_grain_synth_free(synth);
+  aom_img_free(src);
+  aom_img_free(dst);
+}
+
+}  // namespace
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string>
+#include <vector>
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+#include "test/codec_factory.h"
+#include "test/encode_test_driver.h"
+#include "test/i420_video_source.h"
+#include "test/md5_helper.h"
+#include "test/util.h"
+
+namespace {
+
+const int kNumFrames = 10;
+
+// Encodes a clip with hidden alt-ref frames and checks that decoding it with
+// frame parallel threads gives the same frames as the serial decoder.
+class FrameParallelTest
+    : public ::libaom_test::CodecTestWith2Params<int, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  FrameParallelTest()
+      : EncoderTest(GET_PARAM(0)), threads_(GET_PARAM(1)),
+        n_tile_cols_(GET_PARAM(2)) {}
+
+  virtual ~FrameParallelTest() {}
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libaom_test::kTwoPassGood);
+  }
+
+  virtual void PreEncodeFrameHook(libaom_test::VideoSource *video,
+                                  libaom_test::Encoder *encoder) {
+    if (video->frame() == 1) {
+      encoder->Control(AOME_SET_CPUUSED, 4);
+      encoder->Control(AOME_SET_ENABLEAUTOALTREF, 1);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, n_tile_cols_);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const uint8_t *buf = reinterpret_cast<const uint8_t *>(pkt->data.frame.buf);
+    frames_.push_back(std::string(buf, buf + pkt->data.frame.sz));
+  }
+
+  // Decodes all the encoded frames with dec, and returns the MD5 of each
+  // output frame in display order.
+  void DecodeAll(::libaom_test::Decoder *dec, std::vector<std::string> *md5s) {
+    for (size_t i = 0; i <= frames_.size(); ++i) {
+      // A final call with no data flushes the frames still being decoded.
+      const aom_codec_err_t res =
+          i < frames_.size()
+              ? dec->DecodeFrame(
+                    reinterpret_cast<const uint8_t *>(frames_[i].data()),
+                    frames_[i].size())
+              : dec->DecodeFrame(NULL, 0);
+      ASSERT_EQ(AOM_CODEC_OK, res) << dec->DecodeError();
+      ::libaom_test::DxDataIterator dec_iter = dec->GetDxData();
+      const aom_image_t *img;
+      while ((img = dec_iter.Next()) != NULL) {
+        ::libaom_test::MD5 md5;
+        md5.Add(img);
+        md5s->push_back(md5.Get());
+      }
+    }
+  }
+
+  void DoTest() {
+    const aom_rational timebase = { 33333333, 1000000000 };
+    cfg_.g_timebase = timebase;
+    cfg_.rc_target_bitrate = 500;
+    cfg_.g_lag_in_frames = 6;
+    cfg_.rc_end_usage = AOM_VBR;
+
+    libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       timebase.den, timebase.num, 0,
+                                       kNumFrames);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.allow_lowbitdepth = 1;
+    cfg.threads = 1;
+    ::libaom_test::Decoder *const serial_dec = codec_->CreateDecoder(cfg, 0);
+    cfg.threads = threads_;
+    ::libaom_test::Decoder *const fp_dec =
+        codec_->CreateDecoder(cfg, AOM_CODEC_USE_FRAME_THREADING);
+
+    std::vector<std::string> serial_md5s, fp_md5s;
+    DecodeAll(serial_dec, &serial_md5s);
+    DecodeAll(fp_dec, &fp_md5s);
+    delete serial_dec;
+    delete fp_dec;
+
+    ASSERT_EQ(static_cast<size_t>(kNumFrames), serial_md5s.size());
+    ASSERT_EQ(serial_md5s.size(), fp_md5s.size());
+    for (size_t i = 0; i < serial_md5s.size(); ++i)
+      EXPECT_EQ(serial_md5s[i], fp_md5s[i]) << "Mismatch at frame " << i;
+  }
+
+  std::vector<std::string> frames_;
+
+ private:
+  int threads_;
+  int n_tile_cols_;
+};
+
+TEST_P(FrameParallelTest, MD5Match) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_CASE(FrameParallelTest, ::testing::Values(2, 3),
+                          ::testing::Values(0, 1));
+
+}  // namespace
@@ -10,12 +10,16 @@
  */
 
 #include <cstdlib>
+#include <cstring>
 #include <new>
 
 #include "./aom_config.h"
 #include "./av1_rtcd.h"
+#include "aom_dsp/aom_dsp_common.h"
 #include "aom_ports/aom_timer.h"
+#include "aom_ports/mem.h"
 #include "av1/encoder/hash.h"
+#include "av1/encoder/hash_motion.h"
 #include "test/acm_random.h"
 #include "test/util.h"
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
@@ -189,4 +193,297 @@ INSTANTIATE_TEST_CASE_P(
                        ::testing::ValuesIn(kValidBlockSize)));
 #endif
 
+#if CONFIG_HASH_ME
+// Fills the frame with 8x8 areas of a flat colour, of horizontal or vertical
+// stripes and of noise.
+void FillHashTestFrame(libaom_test::ACMRandom *rnd, YV12_BUFFER_CONFIG *pic,
+                       int use_highbitdepth) {
+  const int mask = use_highbitdepth ? 1023 : 255;
+  for (int by = 0; by < pic->y_crop_height; by += 8) {
+    for (int bx = 0; bx < pic->y_crop_width; bx += 8) {
+      const int pattern = rnd->Rand8() % 4;
+      const int base = rnd->Rand16() & mask;
+      for (int y = by; y < AOMMIN(by + 8, pic->y_crop_height); ++y) {
+        for (int x = bx; x < AOMMIN(bx + 8, pic->y_crop_width); ++x) {
+          int v = base;
+          if (pattern == 1) v = (base + y) & mask;
+          if (pattern == 2) v = (base + x) & mask;
+          if (pattern == 3) v = rnd->Rand16() & mask;
+          if (use_highbitdepth) {
+            CONVERT_TO_SHORTPTR(pic->y_buffer)[y * pic->y_stride + x] = v;
+          } else {
+            pic->y_buffer[y * pic->y_stride + x] = v;
+          }
+        }
+      }
+    }
+  }
+}
+
+// The hashes of the blocks of a frame must match the ones the motion search
+// computes for a single block.
+void CheckFrameBlockHashes(int use_highbitdepth) {
+  // Not multiples of the SIMD widths, to test the ends of the rows.
+  const int kWidth = 157;
+  const int kHeight = 141;
+  const int kSize = kWidth * kHeight;
+  libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+  YV12_BUFFER_CONFIG pic;
+  memset(&pic, 0, sizeof(pic));
+  ASSERT_EQ(0, aom_alloc_frame_buffer(&pic, kWidth, kHeight, 1, 1,
+                                      use_highbitdepth, 32, 8));
+  FillHashTestFrame(&rnd, &pic, use_highbitdepth);
+
+  hash_table table;
+  av1_hash_table_init(&table);  // Sets up the CRC calculators.
+  uint32_t *hashes[2][2];
+  int8_t *same[2][3];
+  for (int k = 0; k < 2; ++k) {
+    for (int j = 0; j < 2; ++j) hashes[k][j] = new uint32_t[kSize];
+    for (int j = 0; j < 3; ++j) same[k][j] = new int8_t[kSize];
+  }
+
+  av1_generate_block_2x2_hash_value(&pic, hashes[0], same[0]);
+  int src = 0;
+  for (int block_size = 4, index = 0; block_size <= 128;
+       block_size *= 2, ++index) {
+    const int dst = !src;
+    av1_generate_block_hash_value(&pic, block_size, hashes[src], hashes[dst],
+                                  same[src], same[dst]);
+    const int step = block_size >= 32 ? 5 : 1;
+    for (int y = 0; y + block_size <= kHeight; y += step) {
+      for (int x = 0; x + block_size <= kWidth; x += step) {
+        const int pos = y * kWidth + x;
+        uint32_t hash1, hash2;
+        av1_get_block_hash_value(pic.y_buffer + y * pic.y_stride + x,
+                                 pic.y_stride, block_size, &hash1, &hash2,
+                                 use_highbitdepth);
+        ASSERT_EQ(hash1, (hashes[dst][0][pos] & 0xffff) + (index << 16))
+            << block_size << "x" << block_size << " at " << x << "," << y;
+        ASSERT_EQ(hash2, hashes[dst][1][pos])
+            << block_size << "x" << block_size << " at " << x << "," << y;
+        const int horizontal =
+            av1_hash_is_horizontal_perfect(&pic, block_size, x, y);
+        const int vertical =
+            av1_hash_is_vertical_perfect(&pic, block_size, x, y);
+        ASSERT_EQ(horizontal, same[dst][0][pos])
+            << block_size << "x" << block_size << " at " << x << "," << y;
+        ASSERT_EQ(vertical, same[dst][1][pos])
+            << block_size << "x" << block_size << " at " << x << "," << y;
+        const int aligned = x % block_size == 0 && y % block_size == 0;
+        ASSERT_EQ((!horizontal && !vertical) || aligned, same[dst][2][pos])
+            << block_size << "x" << block_size << " at " << x << "," << y;
+      }
+    }
+    src = dst;
+  }
+
+  for (int k = 0; k < 2; ++k) {
+    for (int j = 0; j < 2; ++j) delete[] hashes[k][j];
+    for (int j = 0; j < 3; ++j) delete[] same[k][j];
+  }
+  aom_free_frame_buffer(&pic);
+}
+
+TEST(AV1BlockHashTest, FrameMatchesBlock) { CheckFrameBlockHashes(0); }
+
+TEST(AV1BlockHashTest, FrameMatchesBlockHighbd) { CheckFrameBlockHashes(1); }
+
+typedef void (*block_2x2_hash_row_func)(const uint8_t *src, int stride,
+                                        int width, int use_highbitdepth,
+                                        uint32_t *hash1, uint32_t *hash2,
+                                        int8_t *row_same, int8_t *col_same);
+typedef void (*block_hash_row_func)(uint32_t *src_pic_block_hash[2],
+                                    int8_t *src_pic_block_same_info[3],
+                                    uint32_t *dst_pic_block_hash[2],
+                                    int8_t *dst_pic_block_same_info[3],
+                                    int pic_width, int width, int block_size,
+                                    int y_pos);
+
+// The row kernels to test, and the crc they must hash with.
+typedef std::tr1::tuple<block_2x2_hash_row_func, block_hash_row_func,
+                        get_crc_value_func>
+    BlockHashRowParam;
+
+class AV1BlockHashRowTest : public ::testing::TestWithParam<BlockHashRowParam> {
+ public:
+  void SetUp();
+
+ protected:
+  void Check2x2Row(int use_highbitdepth);
+  void CheckRow(int block_size);
+
+  // Not a multiple of the SIMD widths, to test the ends of the rows.
+  static const int kWidth = 157;
+
+  libaom_test::ACMRandom rnd_;
+  CRC_CALCULATOR calc_[2];
+};
+
+void AV1BlockHashRowTest::SetUp() {
+  rnd_.Reset(libaom_test::ACMRandom::DeterministicSeed());
+  hash_table table;
+  av1_hash_table_init(&table);  // Sets up the CRC calculators of the kernels.
+  av1_crc_calculator_init(&calc_[0], 24, 0x5D6DCB);
+  av1_crc_calculator_init(&calc_[1], 24, 0x864CFB);
+  Crc32cInitSw();
+}
+
+void AV1BlockHashRowTest::Check2x2Row(int use_highbitdepth) {
+  const block_2x2_hash_row_func test_impl = GET_PARAM(0);
+  const get_crc_value_func ref_crc = GET_PARAM(2);
+  const int width = kWidth - 1;
+  uint8_t src8[2 * kWidth];
+  uint16_t src16[2 * kWidth];
+  uint32_t hash[2][kWidth];
+  int8_t same[2][kWidth];
+
+  for (int iter = 0; iter < 100; ++iter) {
+    // Few distinct values, so that the rows and columns are often the same.
+    const int mask = iter & 1 ? 1 : (use_highbitdepth ? 1023 : 255);
+    for (int i = 0; i < 2 * kWidth; ++i) {
+      src8[i] = rnd_.Rand8() & mask;
+      src16[i] = rnd_.Rand16() & mask;
+    }
+    memset(hash, 0xa5, sizeof(hash));
+    memset(same, 0x5a, sizeof(same));
+    test_impl(use_highbitdepth ? CONVERT_TO_BYTEPTR(src16) : src8, kWidth,
+              width, use_highbitdepth, hash[0], hash[1], same[0], same[1]);
+
+    for (int x = 0; x < width; ++x) {
+      const int offsets[4] = { x, x + 1, x + kWidth, x + kWidth + 1 };
+      uint8_t p8[4];
+      uint16_t p16[4];
+      for (int i = 0; i < 4; ++i) {
+        p8[i] = src8[offsets[i]];
+        p16[i] = src16[offsets[i]];
+      }
+      uint8_t *const p = use_highbitdepth ? reinterpret_cast<uint8_t *>(p16)
+                                          : p8;
+      const int length = use_highbitdepth ? sizeof(p16) : sizeof(p8);
+      const int row_same = use_highbitdepth
+                               ? p16[0] == p16[1] && p16[2] == p16[3]
+                               : p8[0] == p8[1] && p8[2] == p8[3];
+      const int col_same = use_highbitdepth
+                               ? p16[0] == p16[2] && p16[1] == p16[3]
+                               : p8[0] == p8[2] && p8[1] == p8[3];
+      ASSERT_EQ(ref_crc(&calc_[0], p, length), hash[0][x]) << "x " << x;
+      ASSERT_EQ(ref_crc(&calc_[1], p, length), hash[1][x]) << "x " << x;
+      ASSERT_EQ(row_same, same[0][x]) << "x " << x;
+      ASSERT_EQ(col_same, same[1][x]) << "x " << x;
+    }
+    // Nothing is written past the end of the row.
+    ASSERT_EQ(0xa5a5a5a5, hash[0][width]);
+    ASSERT_EQ(0xa5a5a5a5, hash[1][width]);
+    ASSERT_EQ(0x5a, same[0][width]);
+    ASSERT_EQ(0x5a, same[1][width]);
+  }
+}
+
+void AV1BlockHashRowTest::CheckRow(int block_size) {
+  const block_hash_row_func test_impl = GET_PARAM(1);
+  const get_crc_value_func ref_crc = GET_PARAM(2);
+  const int height = 2 * block_size;
+  const int size = kWidth * height;
+  const int width = kWidth - block_size + 1;
+  const int src_size = block_size / 2;
+  const int quad_size = block_size / 4;
+  uint32_t *src_hash[2], *dst_hash[2];
+  int8_t *src_same[3], *dst_same[3];
+  for (int k = 0; k < 2; ++k) {
+    src_hash[k] = new uint32_t[size];
+    dst_hash[k] = new uint32_t[size];
+  }
+  for (int k = 0; k < 3; ++k) {
+    src_same[k] = new int8_t[size];
+    dst_same[k] = new int8_t[size];
+  }
+
+  for (int i = 0; i < size; ++i) {
+    src_hash[0][i] = rnd_.Rand31();
+    src_hash[1][i] = rnd_.Rand31();
+    // Mostly set, so that the blocks of the next size are sometimes the same.
+    src_same[0][i] = rnd_.Rand8() < 240;
+    src_same[1][i] = rnd_.Rand8() < 240;
+    src_same[2][i] = rnd_.Rand8() & 1;
+  }
+
+  // A row aligned on the block size, and one that is not.
+  for (int y = block_size; y <= block_size + 1; ++y) {
+    for (int k = 0; k < 2; ++k)
+      memset(dst_hash[k], 0xa5, size * sizeof(*dst_hash[k]));
+    for (int k = 0; k < 3; ++k) memset(dst_same[k], 0x5a, size);
+    test_impl(src_hash, src_same, dst_hash, dst_same, kWidth, width,
+              block_size, y);
+
+    for (int x = 0; x < width; ++x) {
+      const int pos = y * kWidth + x;
+      const int offsets[4] = { pos, pos + src_size, pos + src_size * kWidth,
+                               pos + src_size * kWidth + src_size };
+      for (int k = 0; k < 2; ++k) {
+        uint32_t p[4];
+        for (int i = 0; i < 4; ++i) p[i] = src_hash[k][offsets[i]];
+        ASSERT_EQ(ref_crc(&calc_[k], reinterpret_cast<uint8_t *>(p), sizeof(p)),
+                  dst_hash[k][pos])
+            << block_size << "x" << block_size << " at " << x << "," << y;
+      }
+      const int8_t *const rs = src_same[0] + pos;
+      const int8_t *const cs = src_same[1] + pos;
+      const int row_same = rs[0] && rs[quad_size] && rs[src_size] &&
+                           rs[src_size * kWidth] &&
+                           rs[src_size * kWidth + quad_size] &&
+                           rs[src_size * kWidth + src_size];
+      const int col_same = cs[0] && cs[src_size] && cs[quad_size * kWidth] &&
+                           cs[quad_size * kWidth + src_size] &&
+                           cs[src_size * kWidth] &&
+                           cs[src_size * kWidth + src_size];
+      const int aligned = x % block_size == 0 && y % block_size == 0;
+      ASSERT_EQ(row_same, dst_same[0][pos])
+          << block_size << "x" << block_size << " at " << x << "," << y;
+      ASSERT_EQ(col_same, dst_same[1][pos])
+          << block_size << "x" << block_size << " at " << x << "," << y;
+      ASSERT_EQ((!row_same && !col_same) || aligned, dst_same[2][pos])
+          << block_size << "x" << block_size << " at " << x << "," << y;
+    }
+    // Nothing is written past the end of the row.
+    const int end = y * kWidth + width;
+    ASSERT_EQ(0xa5a5a5a5, dst_hash[0][end]);
+    ASSERT_EQ(0xa5a5a5a5, dst_hash[1][end]);
+    for (int k = 0; k < 3; ++k) ASSERT_EQ(0x5a, dst_same[k][end]);
+  }
+
+  for (int k = 0; k < 2; ++k) {
+    delete[] src_hash[k];
+    delete[] dst_hash[k];
+  }
+  for (int k = 0; k < 3; ++k) {
+    delete[] src_same[k];
+    delete[] dst_same[k];
+  }
+}
+
+TEST_P(AV1BlockHashRowTest, Check2x2Row) { Check2x2Row(0); }
+
+TEST_P(AV1BlockHashRowTest, Check2x2RowHighbd) { Check2x2Row(1); }
+
+TEST_P(AV1BlockHashRowTest, CheckRow) {
+  for (int block_size = 4; block_size <= 128; block_size *= 2)
+    CheckRow(block_size);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    C, AV1BlockHashRowTest,
+    ::testing::Values(BlockHashRowParam(&av1_generate_block_2x2_hash_row_c,
+                                        &av1_generate_block_hash_row_c,
+                                        &av1_get_crc_value_c)));
+
+#if HAVE_SSE4_2
+INSTANTIATE_TEST_CASE_P(
+    SSE4_2, AV1BlockHashRowTest,
+    ::testing::Values(BlockHashRowParam(&av1_generate_block_2x2_hash_row_sse4_2,
+                                        &av1_generate_block_hash_row_sse4_2,
+                                        &GetCrc32cValueRef)));
+#endif
+#endif  // CONFIG_HASH_ME
+
 }  // namespace
@@ -54,7 +54,8 @@ template <typename FuncType, typename Pixel>
 class AV1IntraPredTest
     : public ::testing::TestWithParam<IntraPredFunc<FuncType> > {
  public:
-  void RunTest(Pixel *left_col, Pixel *above_data, Pixel *dst, Pixel *ref_dst) {
+  void RunTest(Pixel *left_col, Pixel *above_data, Pixel *dst, Pixel *ref_dst,
+               int num_tests) {
     ACMRandom rnd(ACMRandom::DeterministicSeed());
     const int block_width = params_.block_width;
     const int block_height = params_.block_height;
@@ -63,7 +64,7 @@ class AV1IntraPredTest
     dst_ = dst;
     ref_dst_ = ref_dst;
     int error_count = 0;
-    for (int i = 0; i < count_test_block; ++i) {
+    for (int i = 0; i < num_tests; ++i) {
       // Fill edges with random data, try first with saturated values.
       for (int x = -1; x <= block_width * 2; x++) {
         if (i == 0) {
@@ -140,14 +141,19 @@ class LowbdIntraPredTest : public AV1IntraPredTest<IntraPred, uint8_t> {
 };
 
 TEST_P(HighbdIntraPredTest, Bitexact) {
-  // max block size is 32
-  DECLARE_ALIGNED(16, uint16_t, left_col[2 * 32]);
-  DECLARE_ALIGNED(16, uint16_t, above_data[2 * 32 + 32]);
-  DECLARE_ALIGNED(16, uint16_t, dst[3 * 32 * 32]);
-  DECLARE_ALIGNED(16, uint16_t, ref_dst[3 * 32 * 32]);
+  // max block size is 64
+  DECLARE_ALIGNED(16, uint16_t, left_col[2 * 64]);
+  DECLARE_ALIGNED(16, uint16_t, above_data[2 * 64 + 32]);
+  DECLARE_ALIGNED(16, uint16_t, dst[3 * 64 * 64]);
+  DECLARE_ALIGNED(16, uint16_t, ref_dst[3 * 64 * 64]);
   memset(left_col, 0, sizeof(left_col));
   memset(above_data, 0, sizeof(above_data));
-  RunTest(left_col, above_data, dst, ref_dst);
+  // Keep the number of predicted pixels of the blocks larger than 32x32 to
+  // that of a 32x32 block.
+  const int num_tests = AOMMIN(
+      count_test_block, count_test_block * 32 * 32 /
+                            (params_.block_width * params_.block_height));
+  RunTest(left_col, above_data, dst, ref_dst, num_tests);
 }
 
 TEST_P(LowbdIntraPredTest, Bitexact) {
@@ -158,7 +164,7 @@ TEST_P(LowbdIntraPredTest, Bitexact) {
   DECLARE_ALIGNED(16, uint8_t, ref_dst[3 * 32 * 32]);
   memset(left_col, 0, sizeof(left_col));
   memset(above_data, 0, sizeof(above_data));
-  RunTest(left_col, above_data, dst, ref_dst);
+  RunTest(left_col, above_data, dst, ref_dst, count_test_block);
 }
 
 // -----------------------------------------------------------------------------
@@ -169,18 +175,89 @@ TEST_P(LowbdIntraPredTest, Bitexact) {
       &aom_highbd_##type##_predictor_##width##x##height##_c, width, height, \
       bd)
 
-#if 0
-#define highbd_intrapred(type, opt, bd)                                       \
-  highbd_entry(type, 4, 4, opt, bd), highbd_entry(type, 4, 8, opt, bd),       \
-      highbd_entry(type, 8, 4, opt, bd), highbd_entry(type, 8, 8, opt, bd),   \
-      highbd_entry(type, 8, 16, opt, bd), highbd_entry(type, 16, 8, opt, bd), \
+#define highbd_intrapred_wide(type, opt, bd)                                  \
+  highbd_entry(type, 16, 4, opt, bd), highbd_entry(type, 16, 8, opt, bd),     \
       highbd_entry(type, 16, 16, opt, bd),                                    \
       highbd_entry(type, 16, 32, opt, bd),                                    \
-      highbd_entry(type, 32, 16, opt, bd), highbd_entry(type, 32, 32, opt, bd)
-#endif
+      highbd_entry(type, 16, 64, opt, bd),                                    \
+      highbd_entry(type, 32, 8, opt, bd), highbd_entry(type, 32, 16, opt, bd), \
+      highbd_entry(type, 32, 32, opt, bd),                                    \
+      highbd_entry(type, 32, 64, opt, bd),                                    \
+      highbd_entry(type, 64, 16, opt, bd),                                    \
+      highbd_entry(type, 64, 32, opt, bd), highbd_entry(type, 64, 64, opt, bd)
+
+#define highbd_intrapred(type, opt, bd)                                       \
+  highbd_entry(type, 4, 4, opt, bd), highbd_entry(type, 4, 8, opt, bd),       \
+      highbd_entry(type, 4, 16, opt, bd), highbd_entry(type, 8, 4, opt, bd),  \
+      highbd_entry(type, 8, 8, opt, bd), highbd_entry(type, 8, 16, opt, bd),  \
+      highbd_entry(type, 8, 32, opt, bd), highbd_intrapred_wide(type, opt, bd)
+
+#if HAVE_SSE2
+const IntraPredFunc<HighbdIntraPred> HighbdIntraPredTestVector[] = {
+  highbd_entry(dc, 4, 16, sse2, 10), highbd_entry(dc, 8, 32, sse2, 10),
+  highbd_entry(dc_top, 4, 16, sse2, 10), highbd_entry(dc_top, 8, 32, sse2, 10),
+  highbd_entry(dc_left, 4, 16, sse2, 10),
+  highbd_entry(dc_left, 8, 32, sse2, 10), highbd_entry(dc_128, 4, 16, sse2, 10),
+  highbd_entry(dc_128, 8, 32, sse2, 10), highbd_entry(v, 4, 16, sse2, 10),
+  highbd_entry(v, 8, 32, sse2, 10), highbd_entry(dc, 4, 16, sse2, 12),
+  highbd_entry(dc, 8, 32, sse2, 12), highbd_entry(dc_top, 4, 16, sse2, 12),
+  highbd_entry(dc_top, 8, 32, sse2, 12), highbd_entry(dc_left, 4, 16, sse2, 12),
+  highbd_entry(dc_left, 8, 32, sse2, 12), highbd_entry(dc_128, 4, 16, sse2, 12),
+  highbd_entry(dc_128, 8, 32, sse2, 12), highbd_entry(v, 4, 16, sse2, 12),
+  highbd_entry(v, 8, 32, sse2, 12),
+};
+
+INSTANTIATE_TEST_CASE_P(SSE2, HighbdIntraPredTest,
+                        ::testing::ValuesIn(HighbdIntraPredTestVector));
+
+#endif  // HAVE_SSE2
 
-  // ---------------------------------------------------------------------------
-  // Low Bit Depth Tests
+#if HAVE_SSE4_1
+const IntraPredFunc<HighbdIntraPred> HighbdIntraPredTestVectorSse4_1[] = {
+  highbd_intrapred(paeth, sse4_1, 10),
+  highbd_intrapred(smooth, sse4_1, 10),
+  highbd_intrapred(smooth_v, sse4_1, 10),
+  highbd_intrapred(smooth_h, sse4_1, 10),
+  highbd_intrapred(paeth, sse4_1, 12),
+  highbd_intrapred(smooth, sse4_1, 12),
+  highbd_intrapred(smooth_v, sse4_1, 12),
+  highbd_intrapred(smooth_h, sse4_1, 12),
+};
+
+INSTANTIATE_TEST_CASE_P(SSE4_1, HighbdIntraPredTest,
+                        ::testing::ValuesIn(HighbdIntraPredTestVectorSse4_1));
+
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+const IntraPredFunc<HighbdIntraPred> HighbdIntraPredTestVectorAvx2[] = {
+  highbd_intrapred_wide(dc, avx2, 10),
+  highbd_intrapred_wide(dc_top, avx2, 10),
+  highbd_intrapred_wide(dc_left, avx2, 10),
+  highbd_intrapred_wide(dc_128, avx2, 10),
+  highbd_intrapred_wide(v, avx2, 10),
+  highbd_intrapred_wide(paeth, avx2, 10),
+  highbd_intrapred_wide(smooth, avx2, 10),
+  highbd_intrapred_wide(smooth_v, avx2, 10),
+  highbd_intrapred_wide(smooth_h, avx2, 10),
+  highbd_intrapred_wide(dc, avx2, 12),
+  highbd_intrapred_wide(dc_top, avx2, 12),
+  highbd_intrapred_wide(dc_left, avx2, 12),
+  highbd_intrapred_wide(dc_128, avx2, 12),
+  highbd_intrapred_wide(v, avx2, 12),
+  highbd_intrapred_wide(paeth, avx2, 12),
+  highbd_intrapred_wide(smooth, avx2, 12),
+  highbd_intrapred_wide(smooth_v, avx2, 12),
+  highbd_intrapred_wide(smooth_h, avx2, 12),
+};
+
+INSTANTIATE_TEST_CASE_P(AVX2, HighbdIntraPredTest,
+                        ::testing::ValuesIn(HighbdIntraPredTestVectorAvx2));
+
+#endif  // HAVE_AVX2
+
+// -----------------------------------------------------------------------------
+// Low Bit Depth Tests
 
 #define lowbd_entry(type, width, height, opt)                                  \
   IntraPredFunc<IntraPred>(&aom_##type##_predictor_##width##x##height##_##opt, \
@@ -448,6 +448,9 @@ const hbdloop_param_t kHbdLoop8Test6[] = {
   make_tuple(&aom_highbd_lpf_vertical_4_sse2, &aom_highbd_lpf_vertical_4_c, 8),
   make_tuple(&aom_highbd_lpf_horizontal_8_sse2, &aom_highbd_lpf_horizontal_8_c,
              8),
+  make_tuple(&aom_highbd_lpf_horizontal_6_sse2, &aom_highbd_lpf_horizontal_6_c,
+             8),
+  make_tuple(&aom_highbd_lpf_vertical_6_sse2, &aom_highbd_lpf_vertical_6_c, 8),
   make_tuple(&aom_highbd_lpf_horizontal_14_sse2,
              &aom_highbd_lpf_horizontal_14_c, 8),
   make_tuple(&aom_highbd_lpf_horizontal_14_dual_sse2,
@@ -460,6 +463,9 @@ const hbdloop_param_t kHbdLoop8Test6[] = {
   make_tuple(&aom_highbd_lpf_vertical_4_sse2, &aom_highbd_lpf_vertical_4_c, 10),
   make_tuple(&aom_highbd_lpf_horizontal_8_sse2, &aom_highbd_lpf_horizontal_8_c,
              10),
+  make_tuple(&aom_highbd_lpf_horizontal_6_sse2, &aom_highbd_lpf_horizontal_6_c,
+             10),
+  make_tuple(&aom_highbd_lpf_vertical_6_sse2, &aom_highbd_lpf_vertical_6_c, 10),
   make_tuple(&aom_highbd_lpf_horizontal_14_sse2,
              &aom_highbd_lpf_horizontal_14_c, 10),
   make_tuple(&aom_highbd_lpf_horizontal_14_dual_sse2,
@@ -472,6 +478,9 @@ const hbdloop_param_t kHbdLoop8Test6[] = {
   make_tuple(&aom_highbd_lpf_vertical_4_sse2, &aom_highbd_lpf_vertical_4_c, 12),
   make_tuple(&aom_highbd_lpf_horizontal_8_sse2, &aom_highbd_lpf_horizontal_8_c,
              12),
+  make_tuple(&aom_highbd_lpf_horizontal_6_sse2, &aom_highbd_lpf_horizontal_6_c,
+             12),
+  make_tuple(&aom_highbd_lpf_vertical_6_sse2, &aom_highbd_lpf_vertical_6_c, 12),
   make_tuple(&aom_highbd_lpf_horizontal_14_sse2,
              &aom_highbd_lpf_horizontal_14_c, 12),
   make_tuple(&aom_highbd_lpf_horizontal_14_dual_sse2,
@@ -501,7 +510,16 @@ const loop_param_t kLoop8Test6[] = {
   make_tuple(&aom_lpf_vertical_4_sse2, &aom_lpf_vertical_4_c, 8),
   make_tuple(&aom_lpf_vertical_8_sse2, &aom_lpf_vertical_8_c, 8),
   make_tuple(&aom_lpf_vertical_14_sse2, &aom_lpf_vertical_14_c, 8),
-  make_tuple(&aom_lpf_vertical_14_dual_sse2, &aom_lpf_vertical_14_dual_c, 8)
+  make_tuple(&aom_lpf_vertical_14_dual_sse2, &aom_lpf_vertical_14_dual_c, 8),
+  make_tuple(&aom_lpf_horizontal_4_quad_sse2, &aom_lpf_horizontal_4_quad_c, 8),
+  make_tuple(&aom_lpf_horizontal_6_quad_sse2, &aom_lpf_horizontal_6_quad_c, 8),
+  make_tuple(&aom_lpf_horizontal_8_quad_sse2, &aom_lpf_horizontal_8_quad_c, 8),
+  make_tuple(&aom_lpf_horizontal_14_quad_sse2, &aom_lpf_horizontal_14_quad_c,
+             8),
+  make_tuple(&aom_lpf_vertical_4_quad_sse2, &aom_lpf_vertical_4_quad_c, 8),
+  make_tuple(&aom_lpf_vertical_6_quad_sse2, &aom_lpf_vertical_6_quad_c, 8),
+  make_tuple(&aom_lpf_vertical_8_quad_sse2, &aom_lpf_vertical_8_quad_c, 8),
+  make_tuple(&aom_lpf_vertical_14_quad_sse2, &aom_lpf_vertical_14_quad_c, 8)
 };
 
 INSTANTIATE_TEST_CASE_P(SSE2, Loop8Test6Param_lbd,
@@ -515,6 +533,10 @@ const hbddual_loop_param_t kHbdLoop8Test9[] = {
              &aom_highbd_lpf_horizontal_4_dual_c, 8),
   make_tuple(&aom_highbd_lpf_horizontal_8_dual_sse2,
              &aom_highbd_lpf_horizontal_8_dual_c, 8),
+  make_tuple(&aom_highbd_lpf_horizontal_6_dual_sse2,
+             &aom_highbd_lpf_horizontal_6_dual_c, 8),
+  make_tuple(&aom_highbd_lpf_vertical_6_dual_sse2,
+             &aom_highbd_lpf_vertical_6_dual_c, 8),
   make_tuple(&aom_highbd_lpf_vertical_4_dual_sse2,
              &aom_highbd_lpf_vertical_4_dual_c, 8),
   make_tuple(&aom_highbd_lpf_vertical_8_dual_sse2,
@@ -523,6 +545,10 @@ const hbddual_loop_param_t kHbdLoop8Test9[] = {
              &aom_highbd_lpf_horizontal_4_dual_c, 10),
   make_tuple(&aom_highbd_lpf_horizontal_8_dual_sse2,
              &aom_highbd_lpf_horizontal_8_dual_c, 10),
+  make_tuple(&aom_highbd_lpf_horizontal_6_dual_sse2,
+             &aom_highbd_lpf_horizontal_6_dual_c, 10),
+  make_tuple(&aom_highbd_lpf_vertical_6_dual_sse2,
+             &aom_highbd_lpf_vertical_6_dual_c, 10),
   make_tuple(&aom_highbd_lpf_vertical_4_dual_sse2,
              &aom_highbd_lpf_vertical_4_dual_c, 10),
   make_tuple(&aom_highbd_lpf_vertical_8_dual_sse2,
@@ -531,6 +557,10 @@ const hbddual_loop_param_t kHbdLoop8Test9[] = {
              &aom_highbd_lpf_horizontal_4_dual_c, 12),
   make_tuple(&aom_highbd_lpf_horizontal_8_dual_sse2,
              &aom_highbd_lpf_horizontal_8_dual_c, 12),
+  make_tuple(&aom_highbd_lpf_horizontal_6_dual_sse2,
+             &aom_highbd_lpf_horizontal_6_dual_c, 12),
+  make_tuple(&aom_highbd_lpf_vertical_6_dual_sse2,
+             &aom_highbd_lpf_vertical_6_dual_c, 12),
   make_tuple(&aom_highbd_lpf_vertical_4_dual_sse2,
              &aom_highbd_lpf_vertical_4_dual_c, 12),
   make_tuple(&aom_highbd_lpf_vertical_8_dual_sse2,
@@ -572,5 +602,20 @@ const hbddual_loop_param_t kHbdLoop8Test9Avx2[] = {
 
 INSTANTIATE_TEST_CASE_P(AVX2, Loop8Test9Param_hbd,
                         ::testing::ValuesIn(kHbdLoop8Test9Avx2));
+
+const loop_param_t kLoop8Test6Avx2[] = {
+  make_tuple(&aom_lpf_horizontal_4_quad_avx2, &aom_lpf_horizontal_4_quad_c, 8),
+  make_tuple(&aom_lpf_horizontal_6_quad_avx2, &aom_lpf_horizontal_6_quad_c, 8),
+  make_tuple(&aom_lpf_horizontal_8_quad_avx2, &aom_lpf_horizontal_8_quad_c, 8),
+  make_tuple(&aom_lpf_horizontal_14_quad_avx2, &aom_lpf_horizontal_14_quad_c,
+             8),
+  make_tuple(&aom_lpf_vertical_4_quad_avx2, &aom_lpf_vertical_4_quad_c, 8),
+  make_tuple(&aom_lpf_vertical_6_quad_avx2, &aom_lpf_vertical_6_quad_c, 8),
+  make_tuple(&aom_lpf_vertical_8_quad_avx2, &aom_lpf_vertical_8_quad_c, 8),
+  make_tuple(&aom_lpf_vertical_14_quad_avx2, &aom_lpf_vertical_14_quad_c, 8)
+};
+
+INSTANTIATE_TEST_CASE_P(AVX2, Loop8Test6Param_lbd,
+                        ::testing::ValuesIn(kLoop8Test6Avx2));
 #endif
 }  // namespace
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./aom_config.h"
+#include "./av1_rtcd.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_ports/mem.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+
+using libaom_test::ACMRandom;
+using std::tr1::make_tuple;
+
+namespace {
+
+const int kMaxBlock = 32;
+const int kNumIterations = 1000;
+
+typedef void (*TemporalFilterFunc)(uint8_t *frame1, unsigned int stride,
+                                   uint8_t *frame2, unsigned int block_width,
+                                   unsigned int block_height, int strength,
+                                   int filter_weight,
+                                   unsigned int *accumulator, uint16_t *count);
+
+// <function to test, reference function, bit depth>
+typedef std::tr1::tuple<TemporalFilterFunc, TemporalFilterFunc, int>
+    TemporalFilterParam;
+
+// The block sizes used by the encoder, and a few that take the C fallback of
+// the SIMD versions.
+const int kBlockSizes[][2] = { { 16, 16 }, { 8, 8 },  { 16, 8 }, { 8, 16 },
+                               { 32, 32 }, { 4, 4 },  { 4, 8 },  { 24, 16 },
+                               { 12, 4 },  { 16, 1 }, { 40, 8 } };
+
+class TemporalFilterTest
+    : public ::testing::TestWithParam<TemporalFilterParam> {
+ public:
+  virtual ~TemporalFilterTest() {}
+  virtual void SetUp() {
+    tst_func_ = GET_PARAM(0);
+    ref_func_ = GET_PARAM(1);
+    bd_ = GET_PARAM(2);
+  }
+
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  // Fills the source block (with a stride of 'stride') and the predictor
+  // block (with a stride of the block width). If 'extreme' is set, the
+  // pixels are either 0 or the maximum value.
+  void FillBlocks(int width, int height, int stride, bool extreme) {
+    const int mask = (1 << bd_) - 1;
+    for (int i = 0; i < height; ++i) {
+      for (int j = 0; j < width; ++j) {
+        const int a = extreme ? (rnd_(2) ? mask : 0) : rnd_.Rand16() & mask;
+        const int b = extreme ? (rnd_(2) ? mask : 0) : rnd_.Rand16() & mask;
+        if (bd_ == 8) {
+          src8_[i * stride + j] = a;
+          pred8_[i * width + j] = b;
+        } else {
+          src16_[i * stride + j] = a;
+          pred16_[i * width + j] = b;
+        }
+      }
+    }
+  }
+
+  uint8_t *Src() { return bd_ == 8 ? src8_ : CONVERT_TO_BYTEPTR(src16_); }
+  uint8_t *Pred() { return bd_ == 8 ? pred8_ : CONVERT_TO_BYTEPTR(pred16_); }
+
+  void RunCheck(bool extreme);
+
+  TemporalFilterFunc tst_func_;
+  TemporalFilterFunc ref_func_;
+  int bd_;
+  ACMRandom rnd_;
+  DECLARE_ALIGNED(32, uint8_t, src8_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, uint8_t, pred8_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, uint16_t, src16_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, uint16_t, pred16_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, unsigned int, acc_ref_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, unsigned int, acc_tst_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, uint16_t, count_ref_[kMaxBlock * 2 * kMaxBlock * 2]);
+  DECLARE_ALIGNED(32, uint16_t, count_tst_[kMaxBlock * 2 * kMaxBlock * 2]);
+};
+
+void TemporalFilterTest::RunCheck(bool extreme) {
+  const int num_sizes = static_cast<int>(sizeof(kBlockSizes) /
+                                         sizeof(kBlockSizes[0]));
+  rnd_.Reset(ACMRandom::DeterministicSeed());
+  for (int iter = 0; iter < kNumIterations; ++iter) {
+    const int width = kBlockSizes[iter % num_sizes][0];
+    const int height = kBlockSizes[iter % num_sizes][1];
+    const int stride = width + rnd_(kMaxBlock);
+    // The encoder uses strengths up to 6, raised by 2 per bit above 8.
+    const int strength = rnd_(7) + 2 * (bd_ - 8);
+    const int filter_weight = rnd_(3);
+
+    FillBlocks(width, height, stride, extreme);
+    // Accumulate on top of earlier frames, as the encoder does.
+    for (int i = 0; i < width * height; ++i) {
+      acc_ref_[i] = acc_tst_[i] = rnd_.Rand16() * 16;
+      count_ref_[i] = count_tst_[i] = rnd_.Rand8();
+    }
+
+    ref_func_(Src(), stride, Pred(), width, height, strength, filter_weight,
+              acc_ref_, count_ref_);
+    ASM_REGISTER_STATE_CHECK(tst_func_(Src(), stride, Pred(), width, height,
+                                       strength, filter_weight, acc_tst_,
+                                       count_tst_));
+
+    for (int i = 0; i < width * height; ++i) {
+      ASSERT_EQ(acc_ref_[i], acc_tst_[i])
+          << "accumulator mismatch at " << i << " size " << width << "x"
+          << height << " strength " << strength << " weight "
+          << filter_weight;
+      ASSERT_EQ(count_ref_[i], count_tst_[i])
+          << "count mismatch at " << i << " size " << width << "x" << height
+          << " strength " << strength << " weight " << filter_weight;
+    }
+  }
+}
+
+TEST_P(TemporalFilterTest, CompareReferenceRandom) { RunCheck(false); }
+
+TEST_P(TemporalFilterTest, ExtremeValues) { RunCheck(true); }
+
+TEST_P(TemporalFilterTest, DISABLED_Speed) {
+  const int kNumRuns = 200000;
+  const int stride = 64;
+  const int strength = 6 + 2 * (bd_ - 8);
+  rnd_.Reset(ACMRandom::DeterministicSeed());
+  for (int s = 0; s < 2; ++s) {
+    const int size = 16 >> s;
+    FillBlocks(size, size, stride, false);
+    memset(acc_ref_, 0, sizeof(acc_ref_));
+    memset(count_ref_, 0, sizeof(count_ref_));
+
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < kNumRuns; ++i) {
+      ref_func_(Src(), stride, Pred(), size, size, strength, 2, acc_ref_,
+                count_ref_);
+    }
+    aom_usec_timer_mark(&timer);
+    const int ref_time = static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < kNumRuns; ++i) {
+      tst_func_(Src(), stride, Pred(), size, size, strength, 2, acc_tst_,
+                count_tst_);
+    }
+    aom_usec_timer_mark(&timer);
+    const int tst_time = static_cast<int>(aom_usec_timer_elapsed(&timer));
+
+    printf("bd %d %dx%d: ref %d us, simd %d us, speedup %.2f\n", bd_, size,
+           size, ref_time, tst_time,
+           static_cast<double>(ref_time) / static_cast<double>(tst_time));
+  }
+}
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, TemporalFilterTest,
+    ::testing::Values(
+        make_tuple(&av1_highbd_temporal_filter_apply_sse4_1,
+                   &av1_highbd_temporal_filter_apply_c, 10),
+        make_tuple(&av1_highbd_temporal_filter_apply_sse4_1,
+                   &av1_highbd_temporal_filter_apply_c, 12)));
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, TemporalFilterTest,
+    ::testing::Values(make_tuple(&av1_temporal_filter_apply_avx2,
+                                 &av1_temporal_filter_apply_c, 8),
+                      make_tuple(&av1_highbd_temporal_filter_apply_avx2,
+                                 &av1_highbd_temporal_filter_apply_c, 10),
+                      make_tuple(&av1_highbd_temporal_filter_apply_avx2,
+                                 &av1_highbd_temporal_filter_apply_c, 12)));
+#endif  // HAVE_AVX2
+
+}  // namespace
@@ -103,6 +103,10 @@ if (CONFIG_MONO_VIDEO)
 endif ()
 
 if (NOT BUILD_SHARED_LIBS)
+  set(AOM_UNIT_TEST_DECODER_SOURCES
+      ${AOM_UNIT_TEST_DECODER_SOURCES}
+      "${AOM_ROOT}/test/film_grain_test.cc")
+
   set(AOM_UNIT_TEST_ENCODER_SOURCES
       ${AOM_UNIT_TEST_ENCODER_SOURCES}
       "${AOM_ROOT}/test/dct32x32_test.cc"
@@ -136,6 +140,7 @@ if (NOT BUILD_SHARED_LIBS)
     if (HAVE_SSE4_1)
         set(AOM_UNIT_TEST_COMMON_SOURCES
             ${AOM_UNIT_TEST_COMMON_SOURCES}
+            "${AOM_ROOT}/test/dr_prediction_test.cc"
             "${AOM_ROOT}/test/filterintra_test.cc")
     endif ()
 
@@ -213,6 +218,7 @@ if (CONFIG_AV1_ENCODER)
         "${AOM_ROOT}/test/noise_model_test.cc"
         "${AOM_ROOT}/test/subtract_test.cc"
         "${AOM_ROOT}/test/sum_squares_test.cc"
+        "${AOM_ROOT}/test/temporal_filter_test.cc"
         "${AOM_ROOT}/test/variance_test.cc")
 
     if (HAVE_SSE2)
@@ -243,7 +249,8 @@ if (CONFIG_AV1_ENCODER)
     if (HAVE_SSE4_1)
       set(AOM_UNIT_TEST_ENCODER_SOURCES
           ${AOM_UNIT_TEST_ENCODER_SOURCES}
-          "${AOM_ROOT}/test/av1_horz_only_frame_superres_test.cc")
+          "${AOM_ROOT}/test/av1_horz_only_frame_superres_test.cc"
+          "${AOM_ROOT}/test/wiener_test.cc")
     endif ()
 
     if (HAVE_SSE4_2)
@@ -270,6 +277,7 @@ if (NOT BUILD_SHARED_LIBS)
         ${AOM_UNIT_TEST_COMMON_SOURCES}
         "${AOM_ROOT}/test/divu_small_test.cc"
         "${AOM_ROOT}/test/ethread_test.cc"
+        "${AOM_ROOT}/test/frame_parallel_test.cc"
 	"${AOM_ROOT}/test/film_grain_table_test.cc"
         "${AOM_ROOT}/test/coding_path_sync.cc"
         "${AOM_ROOT}/test/idct8x8_test.cc"
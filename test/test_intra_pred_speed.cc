@@ -17,12 +17,14 @@
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "./aom_dsp_rtcd.h"
+#include "./av1_rtcd.h"
 #include "test/acm_random.h"
 #include "test/clear_system_state.h"
 #include "test/md5_helper.h"
 #include "aom/aom_integer.h"
 #include "aom_ports/mem.h"
 #include "aom_ports/aom_timer.h"
+#include "av1/common/blockd.h"
 #include "av1/common/common_data.h"
 
 // -----------------------------------------------------------------------------
@@ -1178,6 +1180,33 @@ HIGHBD_INTRA_PRED_TEST(SSE2_2, TX_4X8, aom_highbd_dc_predictor_4x8_sse2,
                        aom_highbd_dc_128_predictor_4x8_sse2,
                        aom_highbd_v_predictor_4x8_sse2,
                        aom_highbd_h_predictor_4x8_sse2, NULL, NULL, NULL, NULL)
+
+HIGHBD_INTRA_PRED_TEST(SSE2_3, TX_4X16, aom_highbd_dc_predictor_4x16_sse2,
+                       aom_highbd_dc_left_predictor_4x16_sse2,
+                       aom_highbd_dc_top_predictor_4x16_sse2,
+                       aom_highbd_dc_128_predictor_4x16_sse2,
+                       aom_highbd_v_predictor_4x16_sse2, NULL, NULL, NULL, NULL,
+                       NULL)
+#endif
+
+#if HAVE_SSE4_1
+HIGHBD_INTRA_PRED_TEST(SSE4_1_1, TX_4X4, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_4x4_sse4_1,
+                       aom_highbd_smooth_predictor_4x4_sse4_1,
+                       aom_highbd_smooth_v_predictor_4x4_sse4_1,
+                       aom_highbd_smooth_h_predictor_4x4_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_2, TX_4X8, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_4x8_sse4_1,
+                       aom_highbd_smooth_predictor_4x8_sse4_1,
+                       aom_highbd_smooth_v_predictor_4x8_sse4_1,
+                       aom_highbd_smooth_h_predictor_4x8_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_3, TX_4X16, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_4x16_sse4_1,
+                       aom_highbd_smooth_predictor_4x16_sse4_1,
+                       aom_highbd_smooth_v_predictor_4x16_sse4_1,
+                       aom_highbd_smooth_h_predictor_4x16_sse4_1)
 #endif
 
 // -----------------------------------------------------------------------------
@@ -1234,11 +1263,38 @@ HIGHBD_INTRA_PRED_TEST(SSE2_3, TX_8X16, aom_highbd_dc_predictor_8x16_sse2,
                        aom_highbd_dc_128_predictor_8x16_sse2,
                        aom_highbd_v_predictor_8x16_sse2,
                        aom_highbd_h_predictor_8x16_sse2, NULL, NULL, NULL, NULL)
+HIGHBD_INTRA_PRED_TEST(SSE2_4, TX_8X32, aom_highbd_dc_predictor_8x32_sse2,
+                       aom_highbd_dc_left_predictor_8x32_sse2,
+                       aom_highbd_dc_top_predictor_8x32_sse2,
+                       aom_highbd_dc_128_predictor_8x32_sse2,
+                       aom_highbd_v_predictor_8x32_sse2, NULL, NULL, NULL, NULL,
+                       NULL)
 #endif
 
-#if HAVE_SSSE3
-HIGHBD_INTRA_PRED_TEST(SSSE3, TX_8X8, NULL, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL)
+#if HAVE_SSE4_1
+HIGHBD_INTRA_PRED_TEST(SSE4_1_1, TX_8X8, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_8x8_sse4_1,
+                       aom_highbd_smooth_predictor_8x8_sse4_1,
+                       aom_highbd_smooth_v_predictor_8x8_sse4_1,
+                       aom_highbd_smooth_h_predictor_8x8_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_2, TX_8X4, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_8x4_sse4_1,
+                       aom_highbd_smooth_predictor_8x4_sse4_1,
+                       aom_highbd_smooth_v_predictor_8x4_sse4_1,
+                       aom_highbd_smooth_h_predictor_8x4_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_3, TX_8X16, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_8x16_sse4_1,
+                       aom_highbd_smooth_predictor_8x16_sse4_1,
+                       aom_highbd_smooth_v_predictor_8x16_sse4_1,
+                       aom_highbd_smooth_h_predictor_8x16_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_4, TX_8X32, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_8x32_sse4_1,
+                       aom_highbd_smooth_predictor_8x32_sse4_1,
+                       aom_highbd_smooth_v_predictor_8x32_sse4_1,
+                       aom_highbd_smooth_h_predictor_8x32_sse4_1)
 #endif
 
 // -----------------------------------------------------------------------------
@@ -1307,20 +1363,88 @@ HIGHBD_INTRA_PRED_TEST(SSE2_3, TX_16X32, aom_highbd_dc_predictor_16x32_sse2,
                        NULL)
 #endif
 
-#if HAVE_SSSE3
-HIGHBD_INTRA_PRED_TEST(SSSE3_1, TX_16X16, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
+#if HAVE_SSE4_1
+HIGHBD_INTRA_PRED_TEST(SSE4_1_1, TX_16X16, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_16x16_sse4_1,
+                       aom_highbd_smooth_predictor_16x16_sse4_1,
+                       aom_highbd_smooth_v_predictor_16x16_sse4_1,
+                       aom_highbd_smooth_h_predictor_16x16_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_2, TX_16X8, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_16x8_sse4_1,
+                       aom_highbd_smooth_predictor_16x8_sse4_1,
+                       aom_highbd_smooth_v_predictor_16x8_sse4_1,
+                       aom_highbd_smooth_h_predictor_16x8_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_3, TX_16X32, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_16x32_sse4_1,
+                       aom_highbd_smooth_predictor_16x32_sse4_1,
+                       aom_highbd_smooth_v_predictor_16x32_sse4_1,
+                       aom_highbd_smooth_h_predictor_16x32_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_4, TX_16X4, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_16x4_sse4_1,
+                       aom_highbd_smooth_predictor_16x4_sse4_1,
+                       aom_highbd_smooth_v_predictor_16x4_sse4_1,
+                       aom_highbd_smooth_h_predictor_16x4_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_5, TX_16X64, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_16x64_sse4_1,
+                       aom_highbd_smooth_predictor_16x64_sse4_1,
+                       aom_highbd_smooth_v_predictor_16x64_sse4_1,
+                       aom_highbd_smooth_h_predictor_16x64_sse4_1)
 #endif
 
 #if HAVE_AVX2
-HIGHBD_INTRA_PRED_TEST(AVX2_1, TX_16X16, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
-
-HIGHBD_INTRA_PRED_TEST(AVX2_2, TX_16X8, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
-
-HIGHBD_INTRA_PRED_TEST(AVX2_3, TX_16X32, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
+HIGHBD_INTRA_PRED_TEST(AVX2_1, TX_16X16, aom_highbd_dc_predictor_16x16_avx2,
+                       aom_highbd_dc_left_predictor_16x16_avx2,
+                       aom_highbd_dc_top_predictor_16x16_avx2,
+                       aom_highbd_dc_128_predictor_16x16_avx2,
+                       aom_highbd_v_predictor_16x16_avx2, NULL,
+                       aom_highbd_paeth_predictor_16x16_avx2,
+                       aom_highbd_smooth_predictor_16x16_avx2,
+                       aom_highbd_smooth_v_predictor_16x16_avx2,
+                       aom_highbd_smooth_h_predictor_16x16_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_2, TX_16X8, aom_highbd_dc_predictor_16x8_avx2,
+                       aom_highbd_dc_left_predictor_16x8_avx2,
+                       aom_highbd_dc_top_predictor_16x8_avx2,
+                       aom_highbd_dc_128_predictor_16x8_avx2,
+                       aom_highbd_v_predictor_16x8_avx2, NULL,
+                       aom_highbd_paeth_predictor_16x8_avx2,
+                       aom_highbd_smooth_predictor_16x8_avx2,
+                       aom_highbd_smooth_v_predictor_16x8_avx2,
+                       aom_highbd_smooth_h_predictor_16x8_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_3, TX_16X32, aom_highbd_dc_predictor_16x32_avx2,
+                       aom_highbd_dc_left_predictor_16x32_avx2,
+                       aom_highbd_dc_top_predictor_16x32_avx2,
+                       aom_highbd_dc_128_predictor_16x32_avx2,
+                       aom_highbd_v_predictor_16x32_avx2, NULL,
+                       aom_highbd_paeth_predictor_16x32_avx2,
+                       aom_highbd_smooth_predictor_16x32_avx2,
+                       aom_highbd_smooth_v_predictor_16x32_avx2,
+                       aom_highbd_smooth_h_predictor_16x32_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_4, TX_16X4, aom_highbd_dc_predictor_16x4_avx2,
+                       aom_highbd_dc_left_predictor_16x4_avx2,
+                       aom_highbd_dc_top_predictor_16x4_avx2,
+                       aom_highbd_dc_128_predictor_16x4_avx2,
+                       aom_highbd_v_predictor_16x4_avx2, NULL,
+                       aom_highbd_paeth_predictor_16x4_avx2,
+                       aom_highbd_smooth_predictor_16x4_avx2,
+                       aom_highbd_smooth_v_predictor_16x4_avx2,
+                       aom_highbd_smooth_h_predictor_16x4_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_5, TX_16X64, aom_highbd_dc_predictor_16x64_avx2,
+                       aom_highbd_dc_left_predictor_16x64_avx2,
+                       aom_highbd_dc_top_predictor_16x64_avx2,
+                       aom_highbd_dc_128_predictor_16x64_avx2,
+                       aom_highbd_v_predictor_16x64_avx2, NULL,
+                       aom_highbd_paeth_predictor_16x64_avx2,
+                       aom_highbd_smooth_predictor_16x64_avx2,
+                       aom_highbd_smooth_v_predictor_16x64_avx2,
+                       aom_highbd_smooth_h_predictor_16x64_avx2)
 #endif
 
 // -----------------------------------------------------------------------------
@@ -1375,17 +1499,72 @@ HIGHBD_INTRA_PRED_TEST(SSE2_2, TX_32X16, aom_highbd_dc_predictor_32x16_sse2,
                        NULL)
 #endif
 
-#if HAVE_SSSE3
-HIGHBD_INTRA_PRED_TEST(SSSE3_1, TX_32X32, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
+#if HAVE_SSE4_1
+HIGHBD_INTRA_PRED_TEST(SSE4_1_1, TX_32X32, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_32x32_sse4_1,
+                       aom_highbd_smooth_predictor_32x32_sse4_1,
+                       aom_highbd_smooth_v_predictor_32x32_sse4_1,
+                       aom_highbd_smooth_h_predictor_32x32_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_2, TX_32X16, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_32x16_sse4_1,
+                       aom_highbd_smooth_predictor_32x16_sse4_1,
+                       aom_highbd_smooth_v_predictor_32x16_sse4_1,
+                       aom_highbd_smooth_h_predictor_32x16_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_3, TX_32X64, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_32x64_sse4_1,
+                       aom_highbd_smooth_predictor_32x64_sse4_1,
+                       aom_highbd_smooth_v_predictor_32x64_sse4_1,
+                       aom_highbd_smooth_h_predictor_32x64_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_4, TX_32X8, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_32x8_sse4_1,
+                       aom_highbd_smooth_predictor_32x8_sse4_1,
+                       aom_highbd_smooth_v_predictor_32x8_sse4_1,
+                       aom_highbd_smooth_h_predictor_32x8_sse4_1)
 #endif
 
 #if HAVE_AVX2
-HIGHBD_INTRA_PRED_TEST(AVX2_1, TX_32X32, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
-
-HIGHBD_INTRA_PRED_TEST(AVX2_2, TX_32X16, NULL, NULL, NULL, NULL, NULL, NULL,
-                       NULL, NULL, NULL, NULL)
+HIGHBD_INTRA_PRED_TEST(AVX2_1, TX_32X32, aom_highbd_dc_predictor_32x32_avx2,
+                       aom_highbd_dc_left_predictor_32x32_avx2,
+                       aom_highbd_dc_top_predictor_32x32_avx2,
+                       aom_highbd_dc_128_predictor_32x32_avx2,
+                       aom_highbd_v_predictor_32x32_avx2, NULL,
+                       aom_highbd_paeth_predictor_32x32_avx2,
+                       aom_highbd_smooth_predictor_32x32_avx2,
+                       aom_highbd_smooth_v_predictor_32x32_avx2,
+                       aom_highbd_smooth_h_predictor_32x32_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_2, TX_32X16, aom_highbd_dc_predictor_32x16_avx2,
+                       aom_highbd_dc_left_predictor_32x16_avx2,
+                       aom_highbd_dc_top_predictor_32x16_avx2,
+                       aom_highbd_dc_128_predictor_32x16_avx2,
+                       aom_highbd_v_predictor_32x16_avx2, NULL,
+                       aom_highbd_paeth_predictor_32x16_avx2,
+                       aom_highbd_smooth_predictor_32x16_avx2,
+                       aom_highbd_smooth_v_predictor_32x16_avx2,
+                       aom_highbd_smooth_h_predictor_32x16_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_3, TX_32X64, aom_highbd_dc_predictor_32x64_avx2,
+                       aom_highbd_dc_left_predictor_32x64_avx2,
+                       aom_highbd_dc_top_predictor_32x64_avx2,
+                       aom_highbd_dc_128_predictor_32x64_avx2,
+                       aom_highbd_v_predictor_32x64_avx2, NULL,
+                       aom_highbd_paeth_predictor_32x64_avx2,
+                       aom_highbd_smooth_predictor_32x64_avx2,
+                       aom_highbd_smooth_v_predictor_32x64_avx2,
+                       aom_highbd_smooth_h_predictor_32x64_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_4, TX_32X8, aom_highbd_dc_predictor_32x8_avx2,
+                       aom_highbd_dc_left_predictor_32x8_avx2,
+                       aom_highbd_dc_top_predictor_32x8_avx2,
+                       aom_highbd_dc_128_predictor_32x8_avx2,
+                       aom_highbd_v_predictor_32x8_avx2, NULL,
+                       aom_highbd_paeth_predictor_32x8_avx2,
+                       aom_highbd_smooth_predictor_32x8_avx2,
+                       aom_highbd_smooth_v_predictor_32x8_avx2,
+                       aom_highbd_smooth_h_predictor_32x8_avx2)
 #endif
 
 // -----------------------------------------------------------------------------
@@ -1415,6 +1594,237 @@ HIGHBD_INTRA_PRED_TEST(
     aom_highbd_smooth_predictor_64x16_c, aom_highbd_smooth_v_predictor_64x16_c,
     aom_highbd_smooth_h_predictor_64x16_c)
 
+#if HAVE_SSE4_1
+HIGHBD_INTRA_PRED_TEST(SSE4_1_1, TX_64X64, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_64x64_sse4_1,
+                       aom_highbd_smooth_predictor_64x64_sse4_1,
+                       aom_highbd_smooth_v_predictor_64x64_sse4_1,
+                       aom_highbd_smooth_h_predictor_64x64_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_2, TX_64X32, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_64x32_sse4_1,
+                       aom_highbd_smooth_predictor_64x32_sse4_1,
+                       aom_highbd_smooth_v_predictor_64x32_sse4_1,
+                       aom_highbd_smooth_h_predictor_64x32_sse4_1)
+
+HIGHBD_INTRA_PRED_TEST(SSE4_1_3, TX_64X16, NULL, NULL, NULL, NULL, NULL, NULL,
+                       aom_highbd_paeth_predictor_64x16_sse4_1,
+                       aom_highbd_smooth_predictor_64x16_sse4_1,
+                       aom_highbd_smooth_v_predictor_64x16_sse4_1,
+                       aom_highbd_smooth_h_predictor_64x16_sse4_1)
+#endif
+
+#if HAVE_AVX2
+HIGHBD_INTRA_PRED_TEST(AVX2_1, TX_64X64, aom_highbd_dc_predictor_64x64_avx2,
+                       aom_highbd_dc_left_predictor_64x64_avx2,
+                       aom_highbd_dc_top_predictor_64x64_avx2,
+                       aom_highbd_dc_128_predictor_64x64_avx2,
+                       aom_highbd_v_predictor_64x64_avx2, NULL,
+                       aom_highbd_paeth_predictor_64x64_avx2,
+                       aom_highbd_smooth_predictor_64x64_avx2,
+                       aom_highbd_smooth_v_predictor_64x64_avx2,
+                       aom_highbd_smooth_h_predictor_64x64_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_2, TX_64X32, aom_highbd_dc_predictor_64x32_avx2,
+                       aom_highbd_dc_left_predictor_64x32_avx2,
+                       aom_highbd_dc_top_predictor_64x32_avx2,
+                       aom_highbd_dc_128_predictor_64x32_avx2,
+                       aom_highbd_v_predictor_64x32_avx2, NULL,
+                       aom_highbd_paeth_predictor_64x32_avx2,
+                       aom_highbd_smooth_predictor_64x32_avx2,
+                       aom_highbd_smooth_v_predictor_64x32_avx2,
+                       aom_highbd_smooth_h_predictor_64x32_avx2)
+
+HIGHBD_INTRA_PRED_TEST(AVX2_3, TX_64X16, aom_highbd_dc_predictor_64x16_avx2,
+                       aom_highbd_dc_left_predictor_64x16_avx2,
+                       aom_highbd_dc_top_predictor_64x16_avx2,
+                       aom_highbd_dc_128_predictor_64x16_avx2,
+                       aom_highbd_v_predictor_64x16_avx2, NULL,
+                       aom_highbd_paeth_predictor_64x16_avx2,
+                       aom_highbd_smooth_predictor_64x16_avx2,
+                       aom_highbd_smooth_v_predictor_64x16_avx2,
+                       aom_highbd_smooth_h_predictor_64x16_avx2)
+#endif
+
+// -----------------------------------------------------------------------------
+// Directional prediction
+
+typedef void (*DrPredZ1Func)(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                             const uint8_t *above, const uint8_t *left,
+                             int upsample_above, int dx, int dy);
+typedef void (*DrPredZ2Func)(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                             const uint8_t *above, const uint8_t *left,
+                             int upsample_above, int upsample_left, int dx,
+                             int dy);
+typedef void (*DrPredZ3Func)(uint8_t *dst, ptrdiff_t stride, int bw, int bh,
+                             const uint8_t *above, const uint8_t *left,
+                             int upsample_left, int dx, int dy);
+
+typedef void (*HighbdDrPredZ1Func)(uint16_t *dst, ptrdiff_t stride, int bw,
+                                   int bh, const uint16_t *above,
+                                   const uint16_t *left, int upsample_above,
+                                   int dx, int dy, int bd);
+typedef void (*HighbdDrPredZ2Func)(uint16_t *dst, ptrdiff_t stride, int bw,
+                                   int bh, const uint16_t *above,
+                                   const uint16_t *left, int upsample_above,
+                                   int upsample_left, int dx, int dy, int bd);
+typedef void (*HighbdDrPredZ3Func)(uint16_t *dst, ptrdiff_t stride, int bw,
+                                   int bh, const uint16_t *above,
+                                   const uint16_t *left, int upsample_left,
+                                   int dx, int dy, int bd);
+
+struct DrPredFuncs {
+  DrPredZ1Func z1;
+  DrPredZ2Func z2;
+  DrPredZ3Func z3;
+};
+
+struct HighbdDrPredFuncs {
+  HighbdDrPredZ1Func z1;
+  HighbdDrPredZ2Func z2;
+  HighbdDrPredZ3Func z3;
+};
+
+// The nominal angles of the directional modes. Each is used with the angle
+// deltas -3..3 in steps of 3 degrees.
+const int kDrBaseAngles[] = { 45, 67, 90, 113, 135, 157, 180, 203 };
+const int kNumDrAngles = 7 * static_cast<int>(sizeof(kDrBaseAngles) /
+                                              sizeof(kDrBaseAngles[0]));
+// The edges hold the above-left pixel, two upsampled edges of the largest
+// block and room for over-reads of the reference code past max_base.
+const int kDrEdgeOffset = 16;
+const int kDrEdgeSize = kDrEdgeOffset + 4 * kBPS + 16;
+
+int DrAngle(int i) { return kDrBaseAngles[i / 7] + 3 * (i % 7 - 3); }
+
+// Mirrors dr_predictor() in reconintra.c, including the choice of
+// use_intra_edge_upsample() for the edges of luma blocks.
+void DrPredict(const DrPredFuncs &funcs, uint8_t *dst, ptrdiff_t stride,
+               int bw, int bh, const uint8_t *above, const uint8_t *left,
+               int angle, int bd) {
+  const int upsample_above =
+      bw + bh <= 16 && abs(angle - 90) > 0 && abs(angle - 90) < 40;
+  const int upsample_left =
+      bw + bh <= 16 && abs(angle - 180) > 0 && abs(angle - 180) < 40;
+  (void)bd;
+  if (angle < 90) {
+    funcs.z1(dst, stride, bw, bh, above, left, upsample_above,
+             dr_intra_derivative[angle], 1);
+  } else if (angle < 180) {
+    funcs.z2(dst, stride, bw, bh, above, left, upsample_above, upsample_left,
+             dr_intra_derivative[180 - angle], dr_intra_derivative[angle - 90]);
+  } else {
+    funcs.z3(dst, stride, bw, bh, above, left, upsample_left, 1,
+             dr_intra_derivative[270 - angle]);
+  }
+}
+
+void DrPredict(const HighbdDrPredFuncs &funcs, uint16_t *dst,
+               ptrdiff_t stride, int bw, int bh, const uint16_t *above,
+               const uint16_t *left, int angle, int bd) {
+  const int upsample_above =
+      bw + bh <= 16 && abs(angle - 90) > 0 && abs(angle - 90) < 40;
+  const int upsample_left =
+      bw + bh <= 16 && abs(angle - 180) > 0 && abs(angle - 180) < 40;
+  if (angle < 90) {
+    funcs.z1(dst, stride, bw, bh, above, left, upsample_above,
+             dr_intra_derivative[angle], 1, bd);
+  } else if (angle < 180) {
+    funcs.z2(dst, stride, bw, bh, above, left, upsample_above, upsample_left,
+             dr_intra_derivative[180 - angle], dr_intra_derivative[angle - 90],
+             bd);
+  } else {
+    funcs.z3(dst, stride, bw, bh, above, left, upsample_left, 1,
+             dr_intra_derivative[270 - angle], bd);
+  }
+}
+
+// Prints the time the C code and the directional predictors in tst_funcs take
+// for all angles of every transform size. dr_prediction_test.cc checks that
+// they match.
+template <typename Pixel, typename Funcs>
+void TestDrPred(const Funcs &ref_funcs, const Funcs &tst_funcs, int bd,
+                const char *name) {
+  DECLARE_ALIGNED(16, Pixel, above_mem[kDrEdgeSize]);
+  DECLARE_ALIGNED(16, Pixel, left_mem[kDrEdgeSize]);
+  DECLARE_ALIGNED(16, Pixel, ref_dst[kTotalPixels]);
+  DECLARE_ALIGNED(16, Pixel, tst_dst[kTotalPixels]);
+  Pixel *const above = above_mem + kDrEdgeOffset;
+  Pixel *const left = left_mem + kDrEdgeOffset;
+  libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+  const int mask = (1 << bd) - 1;
+
+  for (int i = 0; i < kDrEdgeSize; ++i) {
+    above_mem[i] = rnd.Rand16() & mask;
+    left_mem[i] = rnd.Rand16() & mask;
+  }
+
+  for (int tx_size = 0; tx_size < TX_SIZES_ALL; ++tx_size) {
+    const int bw = tx_size_wide[tx_size];
+    const int bh = tx_size_high[tx_size];
+    const int num_tests = static_cast<int>(2.e8 / (bw * bh * kNumDrAngles));
+    int elapsed_time[2];
+    for (int k = 0; k < 2; ++k) {
+      const Funcs &funcs = k ? tst_funcs : ref_funcs;
+      Pixel *const dst = k ? tst_dst : ref_dst;
+      aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
+      for (int n = 0; n < num_tests; ++n) {
+        for (int i = 0; i < kNumDrAngles; ++i) {
+          const int angle = DrAngle(i);
+          if (angle == 90 || angle == 180) continue;
+          DrPredict(funcs, dst, kBPS, bw, bh, above, left, angle, bd);
+        }
+      }
+      libaom_test::ClearSystemState();
+      aom_usec_timer_mark(&timer);
+      elapsed_time[k] = static_cast<int>(aom_usec_timer_elapsed(&timer) / 1000);
+    }
+    printf("%s[%5s]: c %5d ms, simd %5d ms\n", name, kTxSizeStrings[tx_size],
+           elapsed_time[0], elapsed_time[1]);
+  }
+}
+
+const DrPredFuncs kDrPredC = { av1_dr_prediction_z1_c, av1_dr_prediction_z2_c,
+                               av1_dr_prediction_z3_c };
+const HighbdDrPredFuncs kHighbdDrPredC = { av1_highbd_dr_prediction_z1_c,
+                                           av1_highbd_dr_prediction_z2_c,
+                                           av1_highbd_dr_prediction_z3_c };
+
+#if HAVE_SSE4_1
+TEST(SSE4_1, DISABLED_DrPred) {
+  const DrPredFuncs funcs = { av1_dr_prediction_z1_sse4_1,
+                              av1_dr_prediction_z2_sse4_1,
+                              av1_dr_prediction_z3_sse4_1 };
+  TestDrPred<uint8_t>(kDrPredC, funcs, 8, "DrPred");
+}
+
+TEST(SSE4_1, DISABLED_HighbdDrPred) {
+  const HighbdDrPredFuncs funcs = { av1_highbd_dr_prediction_z1_sse4_1,
+                                    av1_highbd_dr_prediction_z2_sse4_1,
+                                    av1_highbd_dr_prediction_z3_sse4_1 };
+  TestDrPred<uint16_t>(kHighbdDrPredC, funcs, 10, "Hbd DrPred 10");
+  TestDrPred<uint16_t>(kHighbdDrPredC, funcs, 12, "Hbd DrPred 12");
+}
+#endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+TEST(AVX2, DISABLED_DrPred) {
+  const DrPredFuncs funcs = { av1_dr_prediction_z1_avx2,
+                              av1_dr_prediction_z2_avx2,
+                              av1_dr_prediction_z3_avx2 };
+  TestDrPred<uint8_t>(kDrPredC, funcs, 8, "DrPred");
+}
+
+TEST(AVX2, DISABLED_HighbdDrPred) {
+  const HighbdDrPredFuncs funcs = { av1_highbd_dr_prediction_z1_avx2,
+                                    av1_highbd_dr_prediction_z2_avx2,
+                                    av1_highbd_dr_prediction_z3_avx2 };
+  TestDrPred<uint16_t>(kHighbdDrPredC, funcs, 10, "Hbd DrPred 10");
+  TestDrPred<uint16_t>(kHighbdDrPredC, funcs, 12, "Hbd DrPred 12");
+}
+#endif  // HAVE_AVX2
+
 // -----------------------------------------------------------------------------
 
 #include "test/test_libaom.cc"
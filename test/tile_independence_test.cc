@@ -27,7 +27,7 @@ class TileIndependenceTest
  protected:
   TileIndependenceTest()
       : EncoderTest(GET_PARAM(0)), md5_fw_order_(), md5_inv_order_(),
-        n_tile_cols_(GET_PARAM(1)), n_tile_rows_(GET_PARAM(2)) {
+        md5_mt_(), n_tile_cols_(GET_PARAM(1)), n_tile_rows_(GET_PARAM(2)) {
     init_flags_ = AOM_CODEC_USE_PSNR;
     aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
     cfg.w = 704;
@@ -37,6 +37,8 @@ class TileIndependenceTest
     fw_dec_ = codec_->CreateDecoder(cfg, 0);
     inv_dec_ = codec_->CreateDecoder(cfg, 0);
     inv_dec_->Control(AV1_INVERT_TILE_DECODE_ORDER, 1);
+    cfg.threads = 4;
+    mt_dec_ = codec_->CreateDecoder(cfg, 0);
 
 #if CONFIG_AV1
     if (fw_dec_->IsAV1() && inv_dec_->IsAV1()) {
@@ -44,6 +46,8 @@ class TileIndependenceTest
       fw_dec_->Control(AV1_SET_DECODE_TILE_COL, -1);
       inv_dec_->Control(AV1_SET_DECODE_TILE_ROW, -1);
       inv_dec_->Control(AV1_SET_DECODE_TILE_COL, -1);
+      mt_dec_->Control(AV1_SET_DECODE_TILE_ROW, -1);
+      mt_dec_->Control(AV1_SET_DECODE_TILE_COL, -1);
     }
 #endif
   }
@@ -51,6 +55,7 @@ class TileIndependenceTest
   virtual ~TileIndependenceTest() {
     delete fw_dec_;
     delete inv_dec_;
+    delete mt_dec_;
   }
 
   virtual void SetUp() {
@@ -87,6 +92,7 @@ class TileIndependenceTest
   virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
     UpdateMD5(fw_dec_, pkt, &md5_fw_order_);
     UpdateMD5(inv_dec_, pkt, &md5_inv_order_);
+    UpdateMD5(mt_dec_, pkt, &md5_mt_);
   }
 
   void DoTest() {
@@ -103,10 +109,12 @@ class TileIndependenceTest
     const char *md5_fw_str = md5_fw_order_.Get();
     const char *md5_inv_str = md5_inv_order_.Get();
     ASSERT_STREQ(md5_fw_str, md5_inv_str);
+    // Tiles decoded in parallel must match the single-threaded result.
+    ASSERT_STREQ(md5_fw_str, md5_mt_.Get());
   }
 
-  ::libaom_test::MD5 md5_fw_order_, md5_inv_order_;
-  ::libaom_test::Decoder *fw_dec_, *inv_dec_;
+  ::libaom_test::MD5 md5_fw_order_, md5_inv_order_, md5_mt_;
+  ::libaom_test::Decoder *fw_dec_, *inv_dec_, *mt_dec_;
 
  private:
   int n_tile_cols_;
@@ -120,6 +128,7 @@ TEST_P(TileIndependenceTest, MD5Match) {
   cfg_.large_scale_tile = 0;
   fw_dec_->Control(AV1_SET_TILE_MODE, 0);
   inv_dec_->Control(AV1_SET_TILE_MODE, 0);
+  mt_dec_->Control(AV1_SET_TILE_MODE, 0);
   DoTest();
 }
 
@@ -134,6 +143,7 @@ TEST_P(TileIndependenceTestLarge, MD5Match) {
   cfg_.large_scale_tile = 0;
   fw_dec_->Control(AV1_SET_TILE_MODE, 0);
   inv_dec_->Control(AV1_SET_TILE_MODE, 0);
+  mt_dec_->Control(AV1_SET_TILE_MODE, 0);
   DoTest();
 }
 
@@ -148,6 +158,7 @@ TEST_P(TileIndependenceLSTest, MD5Match) {
   cfg_.large_scale_tile = 1;
   fw_dec_->Control(AV1_SET_TILE_MODE, 1);
   inv_dec_->Control(AV1_SET_TILE_MODE, 1);
+  mt_dec_->Control(AV1_SET_TILE_MODE, 1);
   DoTest();
 }
 
@@ -157,6 +168,7 @@ TEST_P(TileIndependenceLSTestLarge, MD5Match) {
   cfg_.large_scale_tile = 1;
   fw_dec_->Control(AV1_SET_TILE_MODE, 1);
   inv_dec_->Control(AV1_SET_TILE_MODE, 1);
+  mt_dec_->Control(AV1_SET_TILE_MODE, 1);
   DoTest();
 }
 
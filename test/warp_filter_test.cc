@@ -34,5 +34,15 @@ INSTANTIATE_TEST_CASE_P(SSE4_1, AV1HighbdWarpFilterTest,
                             av1_highbd_warp_affine_sse4_1));
 
 #endif  // HAVE_SSE4_1
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, AV1WarpFilterTest,
+    libaom_test::AV1WarpFilter::BuildParams(av1_warp_affine_avx2));
+
+INSTANTIATE_TEST_CASE_P(AVX2, AV1HighbdWarpFilterTest,
+                        libaom_test::AV1HighbdWarpFilter::BuildParams(
+                            av1_highbd_warp_affine_avx2));
+#endif  // HAVE_AVX2
 }  // namespace
 #endif  // CONFIG_LOWPRECISION_BLEND
@@ -84,7 +84,8 @@ namespace AV1WarpFilter {
   const WarpTestParam params[] = {
     make_tuple(4, 4, 50000, filter),  make_tuple(8, 8, 50000, filter),
     make_tuple(64, 64, 1000, filter), make_tuple(4, 16, 20000, filter),
-    make_tuple(32, 8, 10000, filter),
+    make_tuple(32, 8, 10000, filter), make_tuple(16, 16, 20000, filter),
+    make_tuple(16, 8, 20000, filter),
   };
   return ::testing::ValuesIn(params);
 }
@@ -130,17 +131,21 @@ void AV1WarpFilterTest::RunSpeedTest(warp_affine_func test_impl) {
   conv_params = get_conv_params_no_round(0, do_average, 0, dsta, out_w, 1, bd);
   conv_params.use_jnt_comp_avg = 0;
 
-  const int num_loops = 1000000000 / (out_w + out_h);
-  aom_usec_timer timer;
-  aom_usec_timer_start(&timer);
-  for (int i = 0; i < num_loops; ++i)
-    test_impl(mat, input, w, h, stride, output, 32, 32, out_w, out_h, out_w,
-              sub_x, sub_y, &conv_params, alpha, beta, gamma, delta);
-
-  aom_usec_timer_mark(&timer);
-  const int elapsed_time = static_cast<int>(aom_usec_timer_elapsed(&timer));
-  printf("warp %3dx%-3d: %7.2f ns\n", out_w, out_h,
-         1000.0 * elapsed_time / num_loops);
+  // Time the C reference first, then the implementation under test.
+  const warp_affine_func funcs[2] = { av1_warp_affine_c, test_impl };
+  const int num_loops = 100000000 / (out_w * out_h);
+  double elapsed_ns[2];
+  for (int f = 0; f < 2; ++f) {
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < num_loops; ++i)
+      funcs[f](mat, input, w, h, stride, output, 32, 32, out_w, out_h, out_w,
+               sub_x, sub_y, &conv_params, alpha, beta, gamma, delta);
+    aom_usec_timer_mark(&timer);
+    elapsed_ns[f] = 1000.0 * aom_usec_timer_elapsed(&timer) / num_loops;
+  }
+  printf("warp %3dx%-3d: c %9.2f ns, simd %8.2f ns (%5.2fx)\n", out_w, out_h,
+         elapsed_ns[0], elapsed_ns[1], elapsed_ns[0] / elapsed_ns[1]);
 
   delete[] input_;
   delete[] output;
@@ -259,7 +264,8 @@ namespace AV1HighbdWarpFilter {
     make_tuple(4, 16, 100, 10, filter),  make_tuple(32, 8, 100, 10, filter),
     make_tuple(4, 4, 100, 12, filter),   make_tuple(8, 8, 100, 12, filter),
     make_tuple(64, 64, 100, 12, filter), make_tuple(4, 16, 100, 12, filter),
-    make_tuple(32, 8, 100, 12, filter),
+    make_tuple(32, 8, 100, 12, filter),  make_tuple(16, 16, 100, 8, filter),
+    make_tuple(16, 16, 100, 10, filter), make_tuple(16, 16, 100, 12, filter),
   };
   return ::testing::ValuesIn(params);
 }
@@ -308,18 +314,23 @@ void AV1HighbdWarpFilterTest::RunSpeedTest(highbd_warp_affine_func test_impl) {
   conv_params.use_jnt_comp_avg = 0;
   conv_params = get_conv_params_no_round(0, do_average, 0, dsta, out_w, 1, bd);
 
-  const int num_loops = 1000000000 / (out_w + out_h);
-  aom_usec_timer timer;
-  aom_usec_timer_start(&timer);
-
-  for (int i = 0; i < num_loops; ++i)
-    test_impl(mat, input, w, h, stride, output, 32, 32, out_w, out_h, out_w,
-              sub_x, sub_y, bd, &conv_params, alpha, beta, gamma, delta);
-
-  aom_usec_timer_mark(&timer);
-  const int elapsed_time = static_cast<int>(aom_usec_timer_elapsed(&timer));
-  printf("highbd warp %3dx%-3d: %7.2f ns\n", out_w, out_h,
-         1000.0 * elapsed_time / num_loops);
+  // Time the C reference first, then the implementation under test.
+  const highbd_warp_affine_func funcs[2] = { av1_highbd_warp_affine_c,
+                                             test_impl };
+  const int num_loops = 100000000 / (out_w * out_h);
+  double elapsed_ns[2];
+  for (int f = 0; f < 2; ++f) {
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < num_loops; ++i)
+      funcs[f](mat, input, w, h, stride, output, 32, 32, out_w, out_h, out_w,
+               sub_x, sub_y, bd, &conv_params, alpha, beta, gamma, delta);
+    aom_usec_timer_mark(&timer);
+    elapsed_ns[f] = 1000.0 * aom_usec_timer_elapsed(&timer) / num_loops;
+  }
+  printf("highbd warp %3dx%-3d bd %2d: c %9.2f ns, simd %8.2f ns (%5.2fx)\n",
+         out_w, out_h, bd, elapsed_ns[0], elapsed_ns[1],
+         elapsed_ns[0] / elapsed_ns[1]);
 
   delete[] input_;
   delete[] output;
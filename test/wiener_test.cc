@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2018, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "./av1_rtcd.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/register_state_check.h"
+#include "test/util.h"
+
+#include "aom_ports/aom_timer.h"
+#include "av1/common/restoration.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+using std::tr1::make_tuple;
+using std::tr1::tuple;
+
+typedef void (*ComputeStatsFunc)(int wiener_win, const uint8_t *dgd,
+                                 const uint8_t *src, int h_start, int h_end,
+                                 int v_start, int v_end, int dgd_stride,
+                                 int src_stride, int64_t *M, int64_t *H);
+
+typedef void (*HighbdComputeStatsFunc)(int wiener_win, const uint8_t *dgd8,
+                                       const uint8_t *src8, int h_start,
+                                       int h_end, int v_start, int v_end,
+                                       int dgd_stride, int src_stride,
+                                       int64_t *M, int64_t *H, int bit_depth);
+
+// The pixels of the restoration unit plus a border for the filter window.
+const int kBorder = WIENER_HALFWIN;
+const int kMaxUnitSize = RESTORATION_UNITSIZE_MAX * 3 / 2;
+const int kStride = kMaxUnitSize + 2 * kBorder;
+const int kBufSize = kStride * kStride;
+const int kIterations = 200;
+
+// Fills buf with random values of the given bit depth. When extreme is set,
+// only the smallest and largest values are used.
+template <typename Pixel>
+void FillRandom(ACMRandom *rnd, Pixel *buf, int bit_depth, bool extreme) {
+  const int max_val = (1 << bit_depth) - 1;
+  for (int i = 0; i < kBufSize; ++i) {
+    if (extreme)
+      buf[i] = (rnd->Rand8() & 1) ? max_val : 0;
+    else
+      buf[i] = rnd->Rand16() & max_val;
+  }
+}
+
+// Picks a random restoration unit inside the buffer, with a random size for
+// most iterations and the largest size for the first one.
+void RandomUnit(ACMRandom *rnd, int iter, int *h_start, int *h_end,
+                int *v_start, int *v_end) {
+  const int max_size = iter == 0 ? kMaxUnitSize : 64;
+  const int w = iter == 0 ? kMaxUnitSize : 1 + rnd->PseudoUniform(max_size);
+  const int h = iter == 0 ? kMaxUnitSize : 1 + rnd->PseudoUniform(max_size);
+  *h_start = kBorder + rnd->PseudoUniform(kMaxUnitSize - w + 1);
+  *v_start = kBorder + rnd->PseudoUniform(kMaxUnitSize - h + 1);
+  *h_end = *h_start + w;
+  *v_end = *v_start + h;
+}
+
+class WienerTest : public ::testing::TestWithParam<ComputeStatsFunc> {
+ public:
+  virtual void SetUp() {
+    dgd_.resize(kBufSize);
+    src_.resize(kBufSize);
+  }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput(bool extreme) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const ComputeStatsFunc tst_fun = GetParam();
+    int64_t M_ref[WIENER_WIN2], H_ref[WIENER_WIN2 * WIENER_WIN2];
+    int64_t M_tst[WIENER_WIN2], H_tst[WIENER_WIN2 * WIENER_WIN2];
+
+    for (int iter = 0; iter < kIterations; ++iter) {
+      const int wiener_win = (iter & 1) ? WIENER_WIN_CHROMA : WIENER_WIN;
+      const int wiener_win2 = wiener_win * wiener_win;
+      int h_start, h_end, v_start, v_end;
+      if (iter % 50 == 0) {
+        FillRandom(&rnd, &dgd_[0], 8, extreme);
+        FillRandom(&rnd, &src_[0], 8, extreme);
+      }
+      RandomUnit(&rnd, iter, &h_start, &h_end, &v_start, &v_end);
+
+      av1_compute_stats_c(wiener_win, &dgd_[0], &src_[0], h_start, h_end,
+                          v_start, v_end, kStride, kStride, M_ref, H_ref);
+      ASM_REGISTER_STATE_CHECK(tst_fun(wiener_win, &dgd_[0], &src_[0],
+                                       h_start, h_end, v_start, v_end, kStride,
+                                       kStride, M_tst, H_tst));
+
+      for (int i = 0; i < wiener_win2; ++i)
+        ASSERT_EQ(M_ref[i], M_tst[i]) << "M[" << i << "], iter " << iter;
+      for (int i = 0; i < wiener_win2 * wiener_win2; ++i)
+        ASSERT_EQ(H_ref[i], H_tst[i]) << "H[" << i << "], iter " << iter;
+    }
+  }
+
+  void RunSpeedTest() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const ComputeStatsFunc tst_fun = GetParam();
+    const int kNumRuns = 20;
+    const int h_start = kBorder, v_start = kBorder;
+    const int h_end = h_start + RESTORATION_UNITSIZE_MAX;
+    const int v_end = v_start + RESTORATION_UNITSIZE_MAX;
+    int64_t M[WIENER_WIN2], H[WIENER_WIN2 * WIENER_WIN2];
+    aom_usec_timer ref_timer, tst_timer;
+
+    FillRandom(&rnd, &dgd_[0], 8, false);
+    FillRandom(&rnd, &src_[0], 8, false);
+
+    aom_usec_timer_start(&ref_timer);
+    for (int i = 0; i < kNumRuns; ++i)
+      av1_compute_stats_c(WIENER_WIN, &dgd_[0], &src_[0], h_start, h_end,
+                          v_start, v_end, kStride, kStride, M, H);
+    aom_usec_timer_mark(&ref_timer);
+
+    aom_usec_timer_start(&tst_timer);
+    for (int i = 0; i < kNumRuns; ++i)
+      tst_fun(WIENER_WIN, &dgd_[0], &src_[0], h_start, h_end, v_start, v_end,
+              kStride, kStride, M, H);
+    aom_usec_timer_mark(&tst_timer);
+
+    const int ref_time = static_cast<int>(aom_usec_timer_elapsed(&ref_timer));
+    const int tst_time = static_cast<int>(aom_usec_timer_elapsed(&tst_timer));
+    printf("c_time = %d \t simd_time = %d \t Gain = %4.2f\n", ref_time,
+           tst_time, static_cast<double>(ref_time) / tst_time);
+  }
+
+  std::vector<uint8_t> dgd_;
+  std::vector<uint8_t> src_;
+};
+
+TEST_P(WienerTest, RandomValues) { RunCheckOutput(false); }
+TEST_P(WienerTest, ExtremeValues) { RunCheckOutput(true); }
+TEST_P(WienerTest, DISABLED_Speed) { RunSpeedTest(); }
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(SSE4_1, WienerTest,
+                        ::testing::Values(av1_compute_stats_sse4_1));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, WienerTest,
+                        ::testing::Values(av1_compute_stats_avx2));
+#endif
+
+// Test parameter list:
+//  <tst_fun, bit_depth>
+typedef tuple<HighbdComputeStatsFunc, int> HighbdWienerParam;
+
+class WienerTestHighbd : public ::testing::TestWithParam<HighbdWienerParam> {
+ public:
+  virtual void SetUp() {
+    dgd_.resize(kBufSize);
+    src_.resize(kBufSize);
+  }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  void RunCheckOutput(bool extreme) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const HighbdComputeStatsFunc tst_fun = GET_PARAM(0);
+    const int bit_depth = GET_PARAM(1);
+    const uint8_t *const dgd = CONVERT_TO_BYTEPTR(&dgd_[0]);
+    const uint8_t *const src = CONVERT_TO_BYTEPTR(&src_[0]);
+    int64_t M_ref[WIENER_WIN2], H_ref[WIENER_WIN2 * WIENER_WIN2];
+    int64_t M_tst[WIENER_WIN2], H_tst[WIENER_WIN2 * WIENER_WIN2];
+
+    for (int iter = 0; iter < kIterations; ++iter) {
+      const int wiener_win = (iter & 1) ? WIENER_WIN_CHROMA : WIENER_WIN;
+      const int wiener_win2 = wiener_win * wiener_win;
+      int h_start, h_end, v_start, v_end;
+      if (iter % 50 == 0) {
+        FillRandom(&rnd, &dgd_[0], bit_depth, extreme);
+        FillRandom(&rnd, &src_[0], bit_depth, extreme);
+      }
+      RandomUnit(&rnd, iter, &h_start, &h_end, &v_start, &v_end);
+
+      av1_compute_stats_highbd_c(wiener_win, dgd, src, h_start, h_end,
+                                 v_start, v_end, kStride, kStride, M_ref,
+                                 H_ref, bit_depth);
+      ASM_REGISTER_STATE_CHECK(tst_fun(wiener_win, dgd, src, h_start, h_end,
+                                       v_start, v_end, kStride, kStride,
+                                       M_tst, H_tst, bit_depth));
+
+      for (int i = 0; i < wiener_win2; ++i)
+        ASSERT_EQ(M_ref[i], M_tst[i]) << "M[" << i << "], iter " << iter;
+      for (int i = 0; i < wiener_win2 * wiener_win2; ++i)
+        ASSERT_EQ(H_ref[i], H_tst[i]) << "H[" << i << "], iter " << iter;
+    }
+  }
+
+  std::vector<uint16_t> dgd_;
+  std::vector<uint16_t> src_;
+};
+
+TEST_P(WienerTestHighbd, RandomValues) { RunCheckOutput(false); }
+TEST_P(WienerTestHighbd, ExtremeValues) { RunCheckOutput(true); }
+
+#if HAVE_SSE4_1
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, WienerTestHighbd,
+    ::testing::Combine(::testing::Values(av1_compute_stats_highbd_sse4_1),
+                       ::testing::Values(8, 10, 12)));
+#endif
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, WienerTestHighbd,
+    ::testing::Combine(::testing::Values(av1_compute_stats_highbd_avx2),
+                       ::testing::Values(8, 10, 12)));
+#endif
+
+}  // namespace